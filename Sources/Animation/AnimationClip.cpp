@@ -0,0 +1,231 @@
+#include "AnimationClip.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace {
+    constexpr float Sqrt2 = 1.41421356f;
+    constexpr float RotationSteps = 32767.0f; // 15 bits per component
+    constexpr float RangeSteps = 65535.0f;
+
+    uint16_t QuantizeUnit(float v, float steps) {
+        return uint16_t(std::clamp(v, 0.0f, 1.0f) * steps + 0.5f);
+    }
+
+    // Smallest three, see AnimationClip.
+    void EncodeRotation(const XMFLOAT4& rotation, uint16_t* key) {
+        XMFLOAT4 q;
+        XMStoreFloat4(&q, XMQuaternionNormalize(XMLoadFloat4(&rotation)));
+        float c[4] = { q.x, q.y, q.z, q.w };
+
+        uint32_t largest = 0;
+        for (uint32_t i = 1; i < 4; ++i)
+            if (std::fabs(c[i]) > std::fabs(c[largest]))
+                largest = i;
+        // q and -q are the same rotation: make the dropped one positive.
+        const float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+
+        uint16_t small[3];
+        for (uint32_t i = 0, n = 0; i < 4; ++i)
+            if (i != largest)
+                small[n++] = QuantizeUnit(c[i] * sign * Sqrt2 * 0.5f + 0.5f, RotationSteps);
+
+        key[0] = uint16_t(small[0] | ((largest & 1u) << 15));
+        key[1] = uint16_t(small[1] | ((largest >> 1) << 15));
+        key[2] = small[2];
+    }
+
+    bool Near(float a, float b, float tolerance) { return std::fabs(a - b) <= tolerance; }
+}
+
+bool AnimationClip::Compress(const RawAnimationClip& raw, const ClipCompressionSettings& settings)
+{
+    const uint32_t joints = raw.jointCount;
+    const uint32_t frames = raw.frameCount;
+    if (joints == 0 || frames == 0 || raw.poses.size() != size_t(joints) * frames || raw.sampleRate <= 0.0f)
+        return false;
+
+    m_sampleRate = raw.sampleRate;
+    m_duration = float(frames - 1) / raw.sampleRate;
+    m_jointCount = joints;
+    m_frameCount = frames;
+    m_tracks.assign(joints, Track{});
+
+    auto pose = [&](uint32_t f, uint32_t j) -> const JointPose& { return raw.poses[size_t(f) * joints + j]; };
+
+    // Pass 1: which tracks change, their ranges and where their keys go.
+    uint32_t stride = 0;
+    for (uint32_t j = 0; j < joints; ++j) {
+        Track& track = m_tracks[j];
+        const JointPose& first = pose(0, j);
+        track.constant = first;
+
+        bool rotationChanges = false;
+        XMFLOAT3 tMin = first.translation, tMax = first.translation;
+        float sMin = first.scale, sMax = first.scale;
+        for (uint32_t f = 1; f < frames; ++f) {
+            const JointPose& p = pose(f, j);
+            const float dot = p.rotation.x * first.rotation.x + p.rotation.y * first.rotation.y +
+                              p.rotation.z * first.rotation.z + p.rotation.w * first.rotation.w;
+            const float s = dot < 0.0f ? -1.0f : 1.0f;
+            const float tol = settings.rotationTolerance;
+            if (!Near(p.rotation.x * s, first.rotation.x, tol) || !Near(p.rotation.y * s, first.rotation.y, tol) ||
+                !Near(p.rotation.z * s, first.rotation.z, tol) || !Near(p.rotation.w * s, first.rotation.w, tol))
+                rotationChanges = true;
+
+            tMin = { std::min(tMin.x, p.translation.x), std::min(tMin.y, p.translation.y), std::min(tMin.z, p.translation.z) };
+            tMax = { std::max(tMax.x, p.translation.x), std::max(tMax.y, p.translation.y), std::max(tMax.z, p.translation.z) };
+            sMin = std::min(sMin, p.scale);
+            sMax = std::max(sMax, p.scale);
+        }
+
+        if (rotationChanges) {
+            track.rotationKey = uint16_t(stride);
+            stride += 3;
+        }
+        const float tt = settings.translationTolerance;
+        if (tMax.x - tMin.x > tt || tMax.y - tMin.y > tt || tMax.z - tMin.z > tt) {
+            track.translationKey = uint16_t(stride);
+            stride += 3;
+            track.translationMin = tMin;
+            track.translationRange = { (tMax.x - tMin.x) / RangeSteps, (tMax.y - tMin.y) / RangeSteps, (tMax.z - tMin.z) / RangeSteps };
+        }
+        if (sMax - sMin > settings.scaleTolerance) {
+            track.scaleKey = uint16_t(stride);
+            stride += 1;
+            track.scaleMin = sMin;
+            track.scaleRange = (sMax - sMin) / RangeSteps;
+        }
+    }
+
+    // Pass 2: the keys, frame by frame.
+    m_frameStride = stride;
+    m_keys.assign(size_t(stride) * frames, 0);
+    auto unit = [](float v, float min, float range) { return range > 0.0f ? (v - min) / (range * RangeSteps) : 0.0f; };
+    for (uint32_t f = 0; f < frames; ++f) {
+        uint16_t* frame = m_keys.data() + size_t(f) * stride;
+        for (uint32_t j = 0; j < joints; ++j) {
+            const Track& track = m_tracks[j];
+            const JointPose& p = pose(f, j);
+            if (track.rotationKey != Constant)
+                EncodeRotation(p.rotation, frame + track.rotationKey);
+            if (track.translationKey != Constant) {
+                uint16_t* k = frame + track.translationKey;
+                k[0] = QuantizeUnit(unit(p.translation.x, track.translationMin.x, track.translationRange.x), RangeSteps);
+                k[1] = QuantizeUnit(unit(p.translation.y, track.translationMin.y, track.translationRange.y), RangeSteps);
+                k[2] = QuantizeUnit(unit(p.translation.z, track.translationMin.z, track.translationRange.z), RangeSteps);
+            }
+            if (track.scaleKey != Constant)
+                frame[track.scaleKey] = QuantizeUnit(unit(p.scale, track.scaleMin, track.scaleRange), RangeSteps);
+        }
+    }
+    return true;
+}
+
+size_t AnimationClip::CompressedBytes() const
+{
+    return sizeof(*this) + m_tracks.size() * sizeof(Track) + m_keys.size() * sizeof(uint16_t);
+}
+
+void AnimationClip::FrameAt(float time, bool loop, uint32_t& f0, uint32_t& f1, float& t) const
+{
+    const uint32_t last = m_frameCount - 1;
+    if (last == 0) {
+        f0 = f1 = 0;
+        t = 0.0f;
+        return;
+    }
+    float f = time * m_sampleRate;
+    if (loop) {
+        f = std::fmod(f, float(last));
+        if (f < 0.0f) f += float(last);
+    }
+    f = std::clamp(f, 0.0f, float(last));
+    f0 = std::min(uint32_t(f), last);
+    f1 = std::min(f0 + 1, last);
+    t = f - float(f0);
+}
+
+XMVECTOR AnimationClip::DecodeRotation(const uint16_t* key) const
+{
+    const uint32_t largest = (key[0] >> 15) | ((key[1] >> 15) << 1);
+    const XMVECTOR q = XMVectorSet(float(key[0] & 0x7FFF), float(key[1] & 0x7FFF), float(key[2] & 0x7FFF), 0.0f);
+    // steps -> -1/sqrt(2)..1/sqrt(2)
+    const XMVECTOR small = XMVectorMultiplyAdd(q, XMVectorReplicate(Sqrt2 / RotationSteps), XMVectorReplicate(-1.0f / Sqrt2));
+    const float dropped = std::sqrt(std::max(0.0f, 1.0f - XMVectorGetX(XMVector3Dot(small, small))));
+
+    XMFLOAT4 s;
+    XMStoreFloat4(&s, small);
+    switch (largest) {
+    case 0:  return XMVectorSet(dropped, s.x, s.y, s.z);
+    case 1:  return XMVectorSet(s.x, dropped, s.y, s.z);
+    case 2:  return XMVectorSet(s.x, s.y, dropped, s.z);
+    default: return XMVectorSet(s.x, s.y, s.z, dropped);
+    }
+}
+
+void AnimationClip::Sample(float time, bool loop, JointPose* out) const
+{
+    if (m_frameCount == 0)
+        return;
+
+    uint32_t f0, f1;
+    float t;
+    FrameAt(time, loop, f0, f1, t);
+    const uint16_t* k0 = m_keys.data() + size_t(f0) * m_frameStride;
+    const uint16_t* k1 = m_keys.data() + size_t(f1) * m_frameStride;
+    const XMVECTOR tv = XMVectorReplicate(t);
+
+    for (uint32_t j = 0; j < m_jointCount; ++j) {
+        const Track& track = m_tracks[j];
+        JointPose& pose = out[j];
+        pose = track.constant;
+
+        if (track.rotationKey != Constant) {
+            const XMVECTOR q = QuaternionNlerp(DecodeRotation(k0 + track.rotationKey), DecodeRotation(k1 + track.rotationKey), tv);
+            XMStoreFloat4(&pose.rotation, q);
+        }
+        if (track.translationKey != Constant) {
+            const uint16_t* a = k0 + track.translationKey;
+            const uint16_t* b = k1 + track.translationKey;
+            const XMVECTOR va = XMVectorSet(float(a[0]), float(a[1]), float(a[2]), 0.0f);
+            const XMVECTOR vb = XMVectorSet(float(b[0]), float(b[1]), float(b[2]), 0.0f);
+            const XMVECTOR v = XMVectorMultiplyAdd(XMVectorLerpV(va, vb, tv),
+                XMLoadFloat3(&track.translationRange), XMLoadFloat3(&track.translationMin));
+            XMStoreFloat3(&pose.translation, v);
+        }
+        if (track.scaleKey != Constant) {
+            const float a = float(k0[track.scaleKey]);
+            const float b = float(k1[track.scaleKey]);
+            pose.scale = track.scaleMin + (a + (b - a) * t) * track.scaleRange;
+        }
+    }
+}
+
+void SampleRawClip(const RawAnimationClip& raw, float time, bool loop, JointPose* out)
+{
+    if (raw.frameCount == 0 || raw.jointCount == 0)
+        return;
+
+    const uint32_t last = raw.frameCount - 1;
+    float f = time * raw.sampleRate;
+    if (loop && last > 0) {
+        f = std::fmod(f, float(last));
+        if (f < 0.0f) f += float(last);
+    }
+    f = std::clamp(f, 0.0f, float(last));
+    const uint32_t f0 = std::min(uint32_t(f), last);
+    const uint32_t f1 = std::min(f0 + 1, last);
+    const XMVECTOR tv = XMVectorReplicate(f - float(f0));
+
+    for (uint32_t j = 0; j < raw.jointCount; ++j) {
+        const JointPose& a = raw.poses[size_t(f0) * raw.jointCount + j];
+        const JointPose& b = raw.poses[size_t(f1) * raw.jointCount + j];
+        XMStoreFloat4(&out[j].rotation, QuaternionNlerp(XMQuaternionNormalize(XMLoadFloat4(&a.rotation)),
+                                              XMQuaternionNormalize(XMLoadFloat4(&b.rotation)), tv));
+        XMStoreFloat3(&out[j].translation, XMVectorLerpV(XMLoadFloat3(&a.translation), XMLoadFloat3(&b.translation), tv));
+        out[j].scale = a.scale + (b.scale - a.scale) * XMVectorGetX(tv);
+    }
+}
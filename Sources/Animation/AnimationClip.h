@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Skeleton.h"
+
+// A clip as it comes out of an exporter: every joint at every frame.
+// poses[frame * jointCount + joint]
+struct RawAnimationClip {
+    float sampleRate = 30.0f; // frames per second
+    uint32_t jointCount = 0;
+    uint32_t frameCount = 0;
+    std::vector<JointPose> poses;
+};
+
+// How far a track may move and still count as "constant".
+struct ClipCompressionSettings {
+    float rotationTolerance = 1e-4f;    // per quaternion component
+    float translationTolerance = 1e-4f; // in skeleton units
+    float scaleTolerance = 1e-4f;
+};
+
+/*
+ * AnimationClip
+ * A compressed clip, sampled every frame for every character that plays it.
+ *
+ * Raw clips are big (32 bytes per joint per frame) and most of it is
+ * redundant, so Compress keeps:
+ *
+ *   - Constant tracks once. Most joints of most clips only rotate: their
+ *     translation and scale never change and cost nothing per frame.
+ *   - Rotations as "smallest three": a unit quaternion's largest component
+ *     follows from the other three, which are all within +-1/sqrt(2). Those
+ *     three are stored in 15 bits each, the index of the dropped one in the
+ *     spare top bits: 6 bytes per key instead of 16.
+ *   - Translations and scales as 16 bits inside the track's own min..max.
+ *
+ * The keys of one frame are stored next to each other, so sampling a frame
+ * reads two small contiguous blocks (the keys before and after `time`).
+ *
+ * The first and the last frame of a looping clip are expected to be the
+ * same pose; the clip is (frameCount - 1) / sampleRate seconds long.
+ */
+class AnimationClip {
+public:
+    // False if `raw` is empty or its sizes don't match.
+    bool Compress(const RawAnimationClip& raw, const ClipCompressionSettings& settings = {});
+
+    // Pose of every joint at `time` seconds; `out` needs JointCount() entries.
+    // `loop`: time wraps around, otherwise it is clamped to the clip.
+    void Sample(float time, bool loop, JointPose* out) const;
+
+    float Duration() const { return m_duration; }
+    uint32_t JointCount() const { return m_jointCount; }
+    uint32_t FrameCount() const { return m_frameCount; }
+    size_t CompressedBytes() const;
+    size_t RawBytes() const { return size_t(m_jointCount) * m_frameCount * sizeof(JointPose); }
+
+private:
+    static constexpr uint16_t Constant = 0xFFFF; // no keys, see Track
+
+    struct Track {
+        JointPose constant;          // the parts that never change
+        uint16_t rotationKey = Constant;    // word offset inside a frame
+        uint16_t translationKey = Constant;
+        uint16_t scaleKey = Constant;
+        DirectX::XMFLOAT3 translationMin{ 0.0f, 0.0f, 0.0f };
+        DirectX::XMFLOAT3 translationRange{ 0.0f, 0.0f, 0.0f }; // (max - min) / 65535
+        float scaleMin = 1.0f;
+        float scaleRange = 0.0f;
+    };
+
+    // Time -> two frames and how far between them.
+    void FrameAt(float time, bool loop, uint32_t& f0, uint32_t& f1, float& t) const;
+    DirectX::XMVECTOR DecodeRotation(const uint16_t* key) const;
+
+private:
+    float m_sampleRate = 30.0f;
+    float m_duration = 0.0f;
+    uint32_t m_jointCount = 0;
+    uint32_t m_frameCount = 0;
+    uint32_t m_frameStride = 0; // uint16_t words per frame
+    std::vector<Track> m_tracks;
+    std::vector<uint16_t> m_keys; // m_frameCount * m_frameStride
+};
+
+// Plain interpolation of the raw frames, like AnimationClip::Sample does on
+// the compressed ones. For tools and for checking the compression error.
+void SampleRawClip(const RawAnimationClip& raw, float time, bool loop, JointPose* out);
@@ -0,0 +1,91 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "Skeleton.h"
+#include "AnimationClip.h"
+#include "Memory/AllocTracker.h"
+
+using SkeletonHandle = uint32_t;
+using ClipHandle = uint32_t;
+constexpr SkeletonHandle InvalidSkeleton = 0;
+constexpr ClipHandle InvalidClip = 0;
+
+/*
+ * AnimationStorage
+ * Skeletons and clips, like MeshStorage is for meshes: added once at load
+ * time, then referenced by handle (1-based, 0 = none) from Animator
+ * components. Clips are compressed on the way in, the raw data isn't kept.
+ *
+ * std::deque: adding more assets never moves the ones already there, so
+ * pointers from Get stay valid.
+ */
+class AnimationStorage {
+public:
+    // InvalidSkeleton if the skeleton is broken (see Skeleton::Finalize).
+    SkeletonHandle AddSkeleton(const Skeleton& skeleton, const std::string& name = {}) {
+        AllocScope scope(AllocTag::Assets);
+        Skeleton s = skeleton;
+        if (!s.Finalize())
+            return InvalidSkeleton;
+        m_skeletons.push_back(std::move(s));
+        m_skeletonNames.push_back(name);
+        return static_cast<SkeletonHandle>(m_skeletons.size());
+    }
+
+    // InvalidClip if `raw` is empty or inconsistent.
+    ClipHandle AddClip(const RawAnimationClip& raw, const std::string& name = {},
+                       const ClipCompressionSettings& settings = {}) {
+        AllocScope scope(AllocTag::Assets);
+        AnimationClip clip;
+        if (!clip.Compress(raw, settings))
+            return InvalidClip;
+        m_clips.push_back(std::move(clip));
+        m_clipNames.push_back(name);
+        return static_cast<ClipHandle>(m_clips.size());
+    }
+
+    const Skeleton* GetSkeleton(SkeletonHandle h) const {
+        if (h == InvalidSkeleton) return nullptr;
+        assert(h <= m_skeletons.size());
+        return &m_skeletons[h - 1];
+    }
+
+    const AnimationClip* GetClip(ClipHandle h) const {
+        if (h == InvalidClip) return nullptr;
+        assert(h <= m_clips.size());
+        return &m_clips[h - 1];
+    }
+
+    // InvalidClip if no clip was added under that name.
+    ClipHandle FindClip(const std::string& name) const {
+        if (name.empty()) return InvalidClip;
+        for (size_t i = 0; i < m_clipNames.size(); ++i)
+            if (m_clipNames[i] == name)
+                return static_cast<ClipHandle>(i + 1);
+        return InvalidClip;
+    }
+
+    size_t SkeletonCount() const { return m_skeletons.size(); }
+    size_t ClipCount() const { return m_clips.size(); }
+
+    // Memory of every clip, compressed vs. what the raw clips took.
+    size_t ClipBytes() const {
+        size_t bytes = 0;
+        for (const AnimationClip& c : m_clips) bytes += c.CompressedBytes();
+        return bytes;
+    }
+    size_t RawClipBytes() const {
+        size_t bytes = 0;
+        for (const AnimationClip& c : m_clips) bytes += c.RawBytes();
+        return bytes;
+    }
+
+private:
+    std::deque<Skeleton> m_skeletons;
+    std::deque<AnimationClip> m_clips;
+    std::vector<std::string> m_skeletonNames;
+    std::vector<std::string> m_clipNames;
+};
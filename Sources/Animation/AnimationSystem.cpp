@@ -0,0 +1,286 @@
+#include "AnimationSystem.h"
+#include "Threading/JobSystem.h"
+#include "Math/Frustum.h"
+#include "Math/TransformUtils.h"
+#include "World/ECS/Component/Mesh.h"
+#include "World/ECS/System/LodSelector.h"
+#include "World/ECS/System/TransformHistory.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+// ---- Update: poses ----
+
+void AnimationSystem::Update(World& world, float dt)
+{
+    m_stats.characters = m_stats.joints = m_stats.blended = 0;
+    m_characters.clear();
+    if (!m_storage)
+        return;
+
+    ComponentPool<Animator>& pool = world.GetPool<Animator>();
+    EcsVector<Animator>& animators = pool.Data();
+    const EcsVector<Entity>& entities = pool.Entities();
+
+    // Serial: advance the clocks and lay out the joint arrays.
+    uint32_t joints = 0, maxJoints = 0;
+    for (size_t i = 0; i < animators.size(); ++i) {
+        Animator& a = animators[i];
+        const Skeleton* skeleton = m_storage->GetSkeleton(a.skeleton);
+        if (!skeleton)
+            continue;
+
+        const uint32_t count = skeleton->JointCount();
+        const AnimationClip* clip = m_storage->GetClip(a.clip);
+        const AnimationClip* blend = m_storage->GetClip(a.blendClip);
+        if (clip && clip->JointCount() != count) clip = nullptr;
+        if (blend && blend->JointCount() != count) blend = nullptr;
+
+        a.time += dt * a.speed;
+        // Keep looping clocks small, or float runs out of precision after a while.
+        const float duration = clip ? clip->Duration() : 0.0f;
+        if (a.loop && duration > 0.0f && (a.time >= duration || a.time < 0.0f)) {
+            a.time = std::fmod(a.time, duration);
+            if (a.time < 0.0f) a.time += duration;
+        }
+
+        Character c;
+        c.entity = entities[i];
+        c.skeleton = skeleton;
+        c.clip = clip;
+        c.blendClip = clip && blend && a.blendWeight > 0.0f ? blend : nullptr;
+        c.blendWeight = std::clamp(a.blendWeight, 0.0f, 1.0f);
+        c.time = a.time;
+        c.loop = a.loop;
+        c.firstJoint = joints;
+        c.jointCount = count;
+        c.boundsMin = c.boundsMax = { 0.0f, 0.0f, 0.0f };
+        m_characters.push_back(c);
+
+        joints += count;
+        maxJoints = std::max(maxJoints, count);
+        m_stats.blended += c.blendClip ? 1 : 0;
+    }
+    m_model.resize(joints);
+    m_skin.resize(joints);
+    m_stats.characters = CharacterCount();
+    m_stats.joints = joints;
+
+    // Parallel: every character on its own, with scratch poses per job.
+    const uint32_t n = CharacterCount();
+    const bool parallel = m_jobs && n >= m_settings.parallelThreshold;
+    const uint32_t grain = parallel ? std::max(m_settings.charactersPerJob, 1u) : std::max(n, 1u);
+    const uint32_t chunks = (n + grain - 1) / grain;
+    if (m_chunkPoses.size() < chunks)
+        m_chunkPoses.resize(chunks);
+    for (uint32_t c = 0; c < chunks; ++c)
+        if (m_chunkPoses[c].size() < size_t(maxJoints) * 2)
+            m_chunkPoses[c].resize(size_t(maxJoints) * 2);
+
+    if (parallel)
+        m_jobs->ParallelFor(n, grain, [this, grain](uint32_t begin, uint32_t end) {
+            PoseCharacters(begin, end, m_chunkPoses[begin / grain].data());
+        });
+    else if (n)
+        PoseCharacters(0, n, m_chunkPoses[0].data());
+}
+
+void AnimationSystem::PoseCharacters(uint32_t begin, uint32_t end, JointPose* scratch)
+{
+    for (uint32_t c = begin; c < end; ++c) {
+        Character& ch = m_characters[c];
+        const Skeleton& skeleton = *ch.skeleton;
+        const uint32_t count = ch.jointCount;
+        JointPose* pose = scratch;
+        JointPose* other = scratch + count;
+
+        // 1. Sample (and mix) the local pose of every joint.
+        if (ch.clip)
+            ch.clip->Sample(ch.time, ch.loop, pose);
+        else
+            std::copy(skeleton.bindPose.begin(), skeleton.bindPose.end(), pose);
+
+        if (ch.blendClip) {
+            ch.blendClip->Sample(ch.time, ch.loop, other);
+            const XMVECTOR w = XMVectorReplicate(ch.blendWeight);
+            for (uint32_t j = 0; j < count; ++j) {
+                XMStoreFloat4(&pose[j].rotation,
+                    QuaternionNlerp(XMLoadFloat4(&pose[j].rotation), XMLoadFloat4(&other[j].rotation), w));
+                XMStoreFloat3(&pose[j].translation,
+                    XMVectorLerpV(XMLoadFloat3(&pose[j].translation), XMLoadFloat3(&other[j].translation), w));
+                pose[j].scale += (other[j].scale - pose[j].scale) * ch.blendWeight;
+            }
+        }
+
+        // 2. Local -> model space, parents first; then the skinning matrices.
+        XMFLOAT4X4A* model = &m_model[ch.firstJoint];
+        XMFLOAT4X4A* skin = &m_skin[ch.firstJoint];
+        XMVECTOR mn = XMVectorReplicate(INFINITY);
+        XMVECTOR mx = XMVectorReplicate(-INFINITY);
+        for (uint32_t j = 0; j < count; ++j) {
+            XMMATRIX m = JointMatrix(pose[j]);
+            const int16_t parent = skeleton.parents[j];
+            if (parent >= 0)
+                m = XMMatrixMultiply(m, XMLoadFloat4x4A(&model[parent]));
+            XMStoreFloat4x4A(&model[j], m);
+            XMStoreFloat4x4A(&skin[j], XMMatrixMultiply(XMLoadFloat4x4(&skeleton.inverseBind[j]), m));
+            mn = XMVectorMin(mn, m.r[3]);
+            mx = XMVectorMax(mx, m.r[3]);
+        }
+        XMStoreFloat3(&ch.boundsMin, mn);
+        XMStoreFloat3(&ch.boundsMax, mx);
+    }
+}
+
+// ---- Skin: vertices ----
+
+void AnimationSystem::SkinVertices(const MeshData& mesh, const XMFLOAT4X4A* skin,
+                                   uint32_t begin, uint32_t end, XMFLOAT3* out)
+{
+    const XMFLOAT3* positions = mesh.positions.data();
+    const JointIndices* joints = mesh.jointIndices.data();
+    const XMFLOAT4* weights = mesh.jointWeights.data();
+
+    for (uint32_t i = begin; i < end; ++i) {
+        const XMVECTOR p = XMLoadFloat3(&positions[i]);
+        const XMVECTOR w = XMLoadFloat4(&weights[i]);
+        const uint8_t* j = joints[i].joint;
+
+        // Moving the point by each joint and mixing the results costs less
+        // than mixing the four matrices first (4 rows x 4 joints).
+        XMVECTOR r = XMVectorMultiply(XMVector3Transform(p, XMLoadFloat4x4A(&skin[j[0]])), XMVectorSplatX(w));
+        r = XMVectorMultiplyAdd(XMVector3Transform(p, XMLoadFloat4x4A(&skin[j[1]])), XMVectorSplatY(w), r);
+        r = XMVectorMultiplyAdd(XMVector3Transform(p, XMLoadFloat4x4A(&skin[j[2]])), XMVectorSplatZ(w), r);
+        r = XMVectorMultiplyAdd(XMVector3Transform(p, XMLoadFloat4x4A(&skin[j[3]])), XMVectorSplatW(w), r);
+        XMStoreFloat3(&out[i - begin], r);
+    }
+}
+
+float AnimationSystem::MeshReach(MeshHandle handle, const MeshData& mesh, const Skeleton& skeleton)
+{
+    if (handle >= m_meshReach.size())
+        m_meshReach.resize(size_t(handle) + 1);
+    MeshReachEntry& entry = m_meshReach[handle];
+
+    // Characters with different skeletons may share a mesh, so the joints
+    // it needs are checked against every skeleton, not just the first.
+    // SkinVertices reads all four matrices, weighted or not.
+    if (entry.joints == 0) {
+        for (const JointIndices& ji : mesh.jointIndices)
+            for (uint32_t k = 0; k < 4; ++k)
+                entry.joints = std::max(entry.joints, uint32_t(ji.joint[k]) + 1);
+    }
+    const uint32_t count = skeleton.JointCount();
+    if (entry.joints > count)
+        return -1.0f; // would read past the skinning matrices
+
+    // The reach is worked out the first time the mesh is skinned: a mesh is
+    // meant for one skeleton, every character drawing it shares the answer.
+    if (!std::isnan(entry.reach))
+        return entry.reach;
+
+    // Joint positions in the bind pose.
+    EcsVector<XMFLOAT3> bind(count);
+    for (uint32_t j = 0; j < count; ++j) {
+        const XMMATRIX m = XMMatrixInverse(nullptr, XMLoadFloat4x4(&skeleton.inverseBind[j]));
+        XMStoreFloat3(&bind[j], m.r[3]);
+    }
+
+    // A vertex turns around its joints, so it stays within this distance of
+    // them whatever the pose (scaled joints aside).
+    float reach = 0.0f;
+    for (size_t i = 0; i < mesh.positions.size(); ++i) {
+        const XMVECTOR p = XMLoadFloat3(&mesh.positions[i]);
+        const float w[4] = { mesh.jointWeights[i].x, mesh.jointWeights[i].y, mesh.jointWeights[i].z, mesh.jointWeights[i].w };
+        for (uint32_t k = 0; k < 4; ++k)
+            if (w[k] > 0.0f)
+                reach = std::max(reach, XMVectorGetX(XMVector3Length(XMVectorSubtract(p, XMLoadFloat3(&bind[mesh.jointIndices[i].joint[k]])))));
+    }
+    entry.reach = reach;
+    return reach;
+}
+
+void AnimationSystem::Skin(const World& world, const MeshStorage& meshes, RenderQueue& queue, const RenderView& view,
+                           LodSelector* lods, const TransformHistory* history, float alpha)
+{
+    m_stats.skinned = m_stats.culled = 0;
+    m_stats.skinnedVertices = 0;
+    m_skinJobs.clear();
+
+    const Frustum frustum = BuildFrustum(XMLoadFloat4x4(&view.viewProj));
+    const ComponentPool<Transform>* transforms = world.FindPool<Transform>();
+    const ComponentPool<Mesh>* meshPool = world.FindPool<Mesh>();
+    if (!transforms || !meshPool)
+        return;
+
+    // Serial: cull, pick the LOD, reserve the vertices and submit.
+    for (uint32_t c = 0; c < CharacterCount(); ++c) {
+        const Character& ch = m_characters[c];
+        const Transform* current = transforms->TryGet(ch.entity);
+        const Mesh* m = meshPool->TryGet(ch.entity);
+        if (!current || !m || m->handle == InvalidMesh)
+            continue;
+        const MeshData* data = meshes.Get(m->handle);
+        if (!data)
+            continue;
+
+        const Transform t = history ? history->Blend(ch.entity, *current, alpha) : *current;
+        const XMMATRIX wm = BuildWorldMatrix(t);
+        XMFLOAT4X4 worldMatrix;
+        XMStoreFloat4x4(&worldMatrix, wm);
+        const float scale = std::max({ std::fabs(t.scale.x), std::fabs(t.scale.y), std::fabs(t.scale.z) });
+        const uint64_t fullTriangles = data->indices.size() / 3;
+
+        const float reach = data->IsSkinned() ? MeshReach(m->handle, *data, *ch.skeleton) : -1.0f;
+        if (reach < 0.0f) {
+            // Nothing to skin: a rigid mesh carried by the entity.
+            XMFLOAT3 center;
+            XMStoreFloat3(&center, XMVector3Transform(XMLoadFloat3(&data->boundsCenter), wm));
+            if (!SphereInFrustum(frustum, center, data->boundsRadius * scale)) {
+                ++m_stats.culled;
+                continue;
+            }
+            const uint32_t lod = lods ? lods->Select(ch.entity, *data, center, scale) : 0;
+            queue.Submit(worldMatrix, m->handle, ch.entity, lod);
+            queue.AddTriangles(data->LodIndices(lod).size() / 3, fullTriangles);
+            continue;
+        }
+
+        const XMVECTOR mn = XMLoadFloat3(&ch.boundsMin);
+        const XMVECTOR mx = XMLoadFloat3(&ch.boundsMax);
+        XMFLOAT3 center;
+        XMStoreFloat3(&center, XMVector3Transform(XMVectorScale(XMVectorAdd(mn, mx), 0.5f), wm));
+        const float radius = (XMVectorGetX(XMVector3Length(XMVectorSubtract(mx, mn))) * 0.5f + reach) * scale;
+        if (!SphereInFrustum(frustum, center, radius)) {
+            ++m_stats.culled;
+            continue;
+        }
+
+        // LODs index the same vertices, so any of them can draw the skinned stream.
+        const uint32_t lod = lods ? lods->Select(ch.entity, *data, center, scale) : 0;
+        const uint32_t vertexCount = static_cast<uint32_t>(data->positions.size());
+        const uint32_t first = queue.AllocateVertices(vertexCount);
+        queue.SubmitSkinned(worldMatrix, m->handle, ch.entity, first, vertexCount, lod);
+        queue.AddTriangles(data->LodIndices(lod).size() / 3, fullTriangles);
+        m_skinJobs.push_back({ data, c, first });
+        ++m_stats.skinned;
+        m_stats.skinnedVertices += vertexCount;
+    }
+
+    // Parallel: the vertices. Every job writes its own part of the stream.
+    XMFLOAT3* vertices = queue.VertexData();
+    auto skin = [this, vertices](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            const SkinJob& job = m_skinJobs[i];
+            const uint32_t count = static_cast<uint32_t>(job.mesh->positions.size());
+            SkinVertices(*job.mesh, GetSkinMatrices(job.character), 0, count, vertices + job.firstVertex);
+        }
+    };
+    const uint32_t n = static_cast<uint32_t>(m_skinJobs.size());
+    if (m_jobs && n >= m_settings.parallelThreshold)
+        m_jobs->ParallelFor(n, std::max(m_settings.charactersPerJob, 1u), skin);
+    else
+        skin(0, n);
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <DirectXMath.h>
+#include "World/ECS/World.h"
+#include "World/ECS/Component/Animator.h"
+#include "Renderer/MeshStorage.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/Camera.h"
+
+class JobSystem;
+class LodSelector;
+class TransformHistory;
+
+struct AnimationSettings {
+    uint32_t parallelThreshold = 16; // fewer characters: that stage stays on this thread
+    uint32_t charactersPerJob = 8;
+};
+
+struct AnimationStats {
+    uint32_t characters = 0;        // posed by the last Update
+    uint32_t joints = 0;            // over all characters
+    uint32_t blended = 0;           // characters that mixed two clips
+    uint32_t skinned = 0;           // characters skinned by the last Skin
+    uint32_t culled = 0;            // outside the view, not skinned
+    uint64_t skinnedVertices = 0;
+};
+
+/*
+ * AnimationSystem
+ * Plays the Animators: poses every character's skeleton, then deforms
+ * ("skins") its mesh on the CPU into the frame's vertex stream.
+ *
+ * Update(world, dt)          once per simulation tick
+ *   Advances Animator::time, samples the clip (and the blend clip), mixes
+ *   the two poses, walks the hierarchy to get every joint's model matrix and
+ *   multiplies in the inverse bind matrix: the "skinning matrices" of the
+ *   character. Characters don't depend on each other, so they are split
+ *   over the JobSystem. Each joint is a few XMVECTOR operations (decode,
+ *   nlerp, one matrix build and multiply).
+ *
+ * Skin(world, meshes, queue, view, ...)    once per drawn frame
+ *   Characters outside the view are skipped: their bounds are the box
+ *   around the joints, grown by how far the mesh reaches from its joints.
+ *   Every visible one gets room in RenderQueue's vertex stream and an item
+ *   pointing at it, then the vertices are written in parallel:
+ *
+ *     skinned = sum over 4 joints of weight * (position * skin[joint])
+ *
+ *   in the character's model space; the item keeps the entity's world
+ *   matrix, so the renderer draws it like any other mesh, only from the
+ *   frame's vertex buffer.
+ *
+ * Entities with an Animator are drawn by Skin, BuildRenderQueue leaves them
+ * out. A mesh without skin weights is drawn rigid.
+ */
+class AnimationSystem {
+public:
+    void SetSettings(const AnimationSettings& settings) { m_settings = settings; }
+    const AnimationSettings& GetSettings() const { return m_settings; }
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+    void SetStorage(const AnimationStorage* storage) { m_storage = storage; }
+
+    void Update(World& world, float dt);
+
+    // `lods` (optional) picks a LOD per character, `history` + `alpha` as in
+    // BuildRenderQueue. Call after BuildRenderQueue (it clears the queue).
+    void Skin(const World& world, const MeshStorage& meshes, RenderQueue& queue, const RenderView& view,
+              LodSelector* lods = nullptr, const TransformHistory* history = nullptr, float alpha = 1.0f);
+
+    // Results of the last Update, in the order of the Animator pool.
+    uint32_t CharacterCount() const { return static_cast<uint32_t>(m_characters.size()); }
+    Entity GetEntity(uint32_t c) const { return m_characters[c].entity; }
+    uint32_t GetJointCount(uint32_t c) const { return m_characters[c].jointCount; }
+    const DirectX::XMFLOAT4X4A* GetJointMatrices(uint32_t c) const { return &m_model[m_characters[c].firstJoint]; } // model space
+    const DirectX::XMFLOAT4X4A* GetSkinMatrices(uint32_t c) const { return &m_skin[m_characters[c].firstJoint]; }
+    const AnimationStats& GetStats() const { return m_stats; }
+
+    // Vertices [begin, end) of a skinned mesh, what Skin runs per character.
+    static void SkinVertices(const MeshData& mesh, const DirectX::XMFLOAT4X4A* skin,
+                             uint32_t begin, uint32_t end, DirectX::XMFLOAT3* out);
+
+private:
+    struct Character {
+        Entity entity;
+        const Skeleton* skeleton;
+        const AnimationClip* clip;      // nullptr: bind pose
+        const AnimationClip* blendClip; // nullptr: no blending
+        float blendWeight;
+        float time;
+        bool loop;
+        uint32_t firstJoint; // in m_model / m_skin
+        uint32_t jointCount;
+        DirectX::XMFLOAT3 boundsMin, boundsMax; // joint positions, model space
+    };
+
+    struct SkinJob {
+        const MeshData* mesh;
+        uint32_t character;
+        uint32_t firstVertex; // in the RenderQueue
+    };
+
+    void PoseCharacters(uint32_t begin, uint32_t end, JointPose* scratch);
+    // How far a vertex of `mesh` is from its joints, at most; < 0 if the
+    // mesh can't be skinned by `skeleton` (joint index out of range).
+    float MeshReach(MeshHandle handle, const MeshData& mesh, const Skeleton& skeleton);
+
+private:
+    AnimationSettings m_settings;
+    JobSystem* m_jobs = nullptr;                 // optional
+    const AnimationStorage* m_storage = nullptr; // injected
+
+    EcsVector<Character> m_characters;
+    EcsVector<DirectX::XMFLOAT4X4A> m_model; // every character's joints, back to back
+    EcsVector<DirectX::XMFLOAT4X4A> m_skin;  // inverseBind * model
+    EcsVector<EcsVector<JointPose>> m_chunkPoses; // per job: two poses of the biggest skeleton
+    EcsVector<SkinJob> m_skinJobs;
+    struct MeshReachEntry {
+        float reach = NAN;   // NAN = not computed yet
+        uint32_t joints = 0; // highest joint index the mesh uses + 1; 0 = not scanned yet
+    };
+    EcsVector<MeshReachEntry> m_meshReach; // by MeshHandle, see MeshReach
+
+    AnimationStats m_stats;
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <DirectXMath.h>
+
+// Local transform of one joint, relative to its parent.
+// Scale is uniform: enough for characters, and it keeps blending simple.
+struct JointPose {
+    DirectX::XMFLOAT4 rotation{ 0.0f, 0.0f, 0.0f, 1.0f }; // quaternion
+    DirectX::XMFLOAT3 translation{ 0.0f, 0.0f, 0.0f };
+    float scale = 1.0f;
+};
+
+inline DirectX::XMMATRIX JointMatrix(const JointPose& p) {
+    using namespace DirectX;
+    return XMMatrixAffineTransformation(XMVectorReplicate(p.scale), XMVectorZero(),
+        XMLoadFloat4(&p.rotation), XMLoadFloat3(&p.translation));
+}
+
+// Rotation between a and b, normalized ("nlerp"). Takes the short way
+// round (q and -q are the same rotation). Much cheaper than slerp and close
+// enough for the small steps between two keys and for pose blending.
+inline DirectX::XMVECTOR QuaternionNlerp(DirectX::FXMVECTOR a, DirectX::FXMVECTOR b, DirectX::FXMVECTOR t) {
+    using namespace DirectX;
+    const XMVECTOR flip = XMVectorLess(XMVector4Dot(a, b), XMVectorZero());
+    const XMVECTOR b2 = XMVectorSelect(b, XMVectorNegate(b), flip);
+    return XMQuaternionNormalize(XMVectorLerpV(a, b2, t));
+}
+
+/*
+ * Skeleton
+ * The joint hierarchy a skinned mesh is bound to.
+ *
+ * Joints are stored parents first: parents[j] < j for every joint except
+ * the roots (-1). Building the pose is then one pass front to back, every
+ * parent's matrix is ready when its children need it.
+ *
+ * bindPose is the pose the mesh was modelled in. A vertex that belongs to
+ * joint j is moved by inverseBind[j] * pose[j]: first back into the joint's
+ * own space, then to wherever the joint is now.
+ *
+ * Meshes store joint indices as uint8_t, so a skeleton has at most 256 joints.
+ */
+struct Skeleton {
+    static constexpr uint32_t MaxJoints = 256;
+
+    std::vector<int16_t> parents;
+    std::vector<JointPose> bindPose;
+    std::vector<std::string> names; // optional
+
+    // Filled by Finalize.
+    std::vector<DirectX::XMFLOAT4X4> inverseBind;
+
+    uint32_t JointCount() const { return static_cast<uint32_t>(parents.size()); }
+
+    // Checks the joint order and computes inverseBind.
+    // False if the skeleton can't be used (parent after child, too many joints).
+    bool Finalize() {
+        using namespace DirectX;
+        const uint32_t count = JointCount();
+        if (count == 0 || count > MaxJoints || bindPose.size() != count)
+            return false;
+        for (uint32_t j = 0; j < count; ++j)
+            if (parents[j] >= int32_t(j) || parents[j] < -1)
+                return false;
+
+        std::vector<XMFLOAT4X4> model(count);
+        inverseBind.resize(count);
+        for (uint32_t j = 0; j < count; ++j) {
+            XMMATRIX m = JointMatrix(bindPose[j]);
+            if (parents[j] >= 0)
+                m = m * XMLoadFloat4x4(&model[parents[j]]);
+            XMStoreFloat4x4(&model[j], m);
+            XMStoreFloat4x4(&inverseBind[j], XMMatrixInverse(nullptr, m));
+        }
+        return true;
+    }
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cmath>
+#include <string>
+#include <DirectXMath.h>
+#include "Skeleton.h"
+#include "AnimationClip.h"
+
+// A chain of `joints` joints up the Y axis, `height` long in total.
+// Matches CreateTestTube (Renderer/StaticMeshes.h).
+inline Skeleton CreateTestChain(uint32_t joints, float height)
+{
+    Skeleton s;
+    for (uint32_t j = 0; j < joints; ++j) {
+        JointPose p;
+        p.translation = { 0.0f, j == 0 ? 0.0f : height / float(joints), 0.0f };
+        s.parents.push_back(int16_t(int32_t(j) - 1));
+        s.bindPose.push_back(p);
+        s.names.push_back("joint" + std::to_string(j));
+    }
+    return s;
+}
+
+// One loop of every joint of the chain swinging around `axis`, each one a
+// bit later than its parent (a wave up the chain). The root also bobs up
+// and down; the other joints only rotate, so their translation and scale
+// tracks compress to constants.
+inline RawAnimationClip CreateTestSway(const Skeleton& skeleton, DirectX::XMFLOAT3 axis, float amplitude,
+                                       float seconds, float sampleRate = 30.0f)
+{
+    using namespace DirectX;
+    RawAnimationClip clip;
+    clip.sampleRate = sampleRate;
+    clip.jointCount = skeleton.JointCount();
+    clip.frameCount = uint32_t(seconds * sampleRate) + 1; // last frame = first frame
+    clip.poses.resize(size_t(clip.frameCount) * clip.jointCount);
+
+    const float twoPi = 6.28318531f;
+    const XMVECTOR a = XMVector3Normalize(XMLoadFloat3(&axis));
+    for (uint32_t f = 0; f < clip.frameCount; ++f) {
+        const float phase = float(f) / float(clip.frameCount - 1) * twoPi;
+        for (uint32_t j = 0; j < clip.jointCount; ++j) {
+            JointPose p = skeleton.bindPose[j];
+            const float angle = amplitude * std::sin(phase - 0.6f * float(j));
+            XMStoreFloat4(&p.rotation, XMQuaternionRotationAxis(a, angle));
+            if (j == 0)
+                p.translation.y += 0.1f * std::sin(2.0f * phase);
+            clip.poses[size_t(f) * clip.jointCount + j] = p;
+        }
+    }
+    return clip;
+}
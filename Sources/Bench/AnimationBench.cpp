@@ -0,0 +1,97 @@
+#include "AnimationBench.h"
+#include "AnimationFixture.h"
+#include "BenchUtil.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+using namespace AnimationFixture;
+
+bool ParseAnimationBenchArgs(const char* cmdLine, AnimationBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-animation");
+    options.Add("--characters", s.characters);
+    options.Add("--joints",     s.joints);
+    options.Add("--rings",      s.rings);
+    options.Add("--frames",     s.frames);
+    options.Add("--seed",       s.seed);
+    options.Add("--out",        s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.characters == 0 || s.frames == 0 || s.rings == 0 || s.joints == 0 || s.joints > Skeleton::MaxJoints) {
+        error = "--characters, --frames and --rings must be positive, --joints in [1, 256]";
+        return false;
+    }
+    return true;
+}
+
+int RunAnimationBench(const AnimationBenchSettings& settings)
+{
+    JobSystem jobs;
+    Scene scene;
+    BuildScene(scene, settings.characters, settings.joints, settings.rings, settings.seed);
+
+    // How far the compressed clips are off the raw ones; AnimationTests
+    // holds them to a tolerance, here it is only reported.
+    const ClipError sway = CompareClip(scene.sway, *scene.animations.GetClip(scene.swayClip));
+    const ClipError twist = CompareClip(scene.twist, *scene.animations.GetClip(scene.twistClip));
+    ClipError clipError;
+    clipError.rotation = std::max(sway.rotation, twist.rotation);
+    clipError.translation = std::max(sway.translation, twist.translation);
+    scene.system.SetJobSystem(&jobs);
+    const uint32_t vertices = uint32_t(scene.meshes.Get(1)->positions.size());
+
+    std::vector<double> updateMs, skinMs, totalMs;
+    uint64_t skinned = 0, culled = 0;
+    const float dt = 1.0f / 60.0f;
+    for (uint32_t frame = 0; frame < settings.frames; ++frame) {
+        const Clock::Ticks t0 = Clock::NowTicks();
+        scene.system.Update(scene.world, dt);
+        const Clock::Ticks t1 = Clock::NowTicks();
+        scene.queue.Clear();
+        scene.system.Skin(scene.world, scene.meshes, scene.queue, scene.view);
+        const Clock::Ticks t2 = Clock::NowTicks();
+
+        updateMs.push_back(Clock::ToMilliseconds(t1 - t0));
+        skinMs.push_back(Clock::ToMilliseconds(t2 - t1));
+        totalMs.push_back(Clock::ToMilliseconds(t2 - t0));
+        skinned += scene.system.GetStats().skinned;
+        culled += scene.system.GetStats().culled;
+    }
+
+    // ---- JSON ----
+    const double frames = double(settings.frames);
+    const double perFrameSkinned = double(skinned) / frames;
+    std::string json = "{\n  \"benchmark\": \"animation\",\n";
+    Bench::Append(json, "  \"config\": { \"characters\": %u, \"joints\": %u, \"vertices_per_character\": %u, \"frames\": %u, \"workers\": %u, \"seed\": %u },\n",
+        settings.characters, settings.joints, vertices, settings.frames, jobs.WorkerCount(), settings.seed);
+
+    // Update runs for every character, Skin only for the visible ones.
+    json += "  \"per_frame\": {\n";
+    struct Row { const char* name; std::vector<double>* ms; double characters; };
+    const Row rows[] = {
+        { "update", &updateMs, double(settings.characters) },
+        { "skin", &skinMs, perFrameSkinned },
+        { "total", &totalMs, double(settings.characters) }
+    };
+    for (size_t i = 0; i < std::size(rows); ++i) {
+        const FrameTimeSummary s = SummarizeTimes(*rows[i].ms);
+        Bench::Append(json, "    \"%s\": { \"mean_ms\": %.4f, \"p99_ms\": %.4f, \"us_per_character\": %.3f }%s\n",
+            rows[i].name, s.averageMs, s.p99Ms, rows[i].characters > 0.0 ? s.averageMs * 1000.0 / rows[i].characters : 0.0,
+            i + 1 < std::size(rows) ? "," : "");
+    }
+    json += "  },\n";
+
+    Bench::Append(json, "  \"skinned_per_frame\": %.1f,\n  \"culled_per_frame\": %.1f,\n  \"skinned_vertices_per_frame\": %.0f,\n",
+        perFrameSkinned, double(culled) / frames, perFrameSkinned * vertices);
+    const size_t raw = scene.animations.RawClipBytes();
+    const size_t packed = scene.animations.ClipBytes();
+    Bench::Append(json, "  \"clips\": { \"raw_bytes\": %zu, \"compressed_bytes\": %zu, \"ratio\": %.2f, \"max_rotation_error_rad\": %.6f, \"max_translation_error\": %.6f }\n",
+        raw, packed, packed ? double(raw) / double(packed) : 0.0, clipError.rotation, clipError.translation);
+    json += "}\n";
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * AnimationBench
+ * `characters` skinned tubes on a grid, each playing the test sway clip
+ * (every second one blended with a second clip), for `frames` fixed 60 Hz
+ * frames: AnimationSystem::Update (sample, blend, build the skinning
+ * matrices) then Skin (cull, CPU skinning into a RenderQueue). Reports both
+ * per frame and per character, and the clip compression ratio and error.
+ * The scene is Bench/AnimationFixture.h; Tests/AnimationTests.cpp checks
+ * the skinning and the jobs on the same crowd.
+ *
+ *     Dreivy.exe --bench-animation --characters=500 --joints=32 --out=AnimationBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct AnimationBenchSettings {
+    uint32_t characters = 500;
+    uint32_t joints = 32;
+    uint32_t rings = 64;      // mesh size: (rings + 1) * 17 vertices
+    uint32_t frames = 240;
+    uint32_t seed = 1;
+    std::string output = "AnimationBench.json";
+};
+
+bool ParseAnimationBenchArgs(const char* cmdLine, AnimationBenchSettings& settings, std::string& error);
+int RunAnimationBench(const AnimationBenchSettings& settings);
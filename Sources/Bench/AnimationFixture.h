@@ -0,0 +1,98 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Animation/AnimationSystem.h"
+#include "Animation/TestRig.h"
+#include "Bench/BenchUtil.h"
+#include "Renderer/StaticMeshes.h"
+#include "World/ECS/Component/Mesh.h"
+#include "World/ECS/Component/Transform.h"
+
+// A grid of tubes skinned to one joint chain. Every other one blends a second
+// clip on top, so sampling runs both with and without a blend.
+namespace AnimationFixture {
+
+    constexpr float TubeHeight = 2.0f;
+    constexpr float Spacing = 1.5f;
+
+    // Everything one crowd needs; AnimationSystem keeps a pointer to the storage,
+    // so a Scene stays where it was made.
+    struct Scene {
+        World world;
+        MeshStorage meshes;
+        AnimationStorage animations;
+        AnimationSystem system;
+        RenderQueue queue;
+        RenderView view;
+        RawAnimationClip sway, twist;
+        ClipHandle swayClip = InvalidClip, twistClip = InvalidClip;
+    };
+
+    inline void BuildScene(Scene& s, uint32_t characters, uint32_t joints, uint32_t rings, uint32_t seed) {
+        uint32_t rng = seed ? seed : 1;
+        const Skeleton skeleton = CreateTestChain(joints, TubeHeight);
+        const SkeletonHandle sh = s.animations.AddSkeleton(skeleton, "chain");
+        s.sway = CreateTestSway(skeleton, { 0.0f, 0.0f, 1.0f }, 0.35f, 2.0f);
+        s.twist = CreateTestSway(skeleton, { 1.0f, 0.0f, 0.0f }, 0.25f, 1.5f);
+        s.swayClip = s.animations.AddClip(s.sway, "sway");
+        s.twistClip = s.animations.AddClip(s.twist, "twist");
+        s.system.SetStorage(&s.animations);
+
+        const MeshHandle tube = s.meshes.Add(CreateTestTube(16, rings, TubeHeight, 0.15f, joints), "tube");
+
+        // A square grid around the origin, seen from above and behind.
+        const uint32_t side = uint32_t(std::ceil(std::sqrt(double(characters))));
+        const float half = float(side) * Spacing * 0.5f;
+        for (uint32_t i = 0; i < characters; ++i) {
+            const Entity e = s.world.CreateEntity();
+            Transform t;
+            t.position = { float(i % side) * Spacing - half, 0.0f, float(i / side) * Spacing - half };
+            t.rotation = { 0.0f, Bench::RandomFloat(rng) * 6.28f, 0.0f };
+            s.world.AddComponent<Transform>(e, t);
+            s.world.AddComponent<Mesh>(e, Mesh{ tube });
+
+            Animator a;
+            a.skeleton = sh;
+            a.clip = s.swayClip;
+            a.time = Bench::RandomFloat(rng) * 2.0f;
+            a.speed = 0.75f + Bench::RandomFloat(rng) * 0.5f;
+            if (i % 2) {
+                a.blendClip = s.twistClip;
+                a.blendWeight = Bench::RandomFloat(rng);
+            }
+            s.world.AddComponent<Animator>(e, a);
+        }
+
+        Camera camera;
+        camera.position = { 0.0f, half * 1.5f + 5.0f, -half * 1.5f - 5.0f };
+        camera.target = { 0.0f, 0.0f, 0.0f };
+        s.view = BuildRenderView(camera, 1280.0f, 720.0f);
+    }
+
+    struct ClipError {
+        float rotation = 0.0f;    // radians
+        float translation = 0.0f;
+    };
+
+    // Compressed samples against interpolating the raw frames.
+    inline ClipError CompareClip(const RawAnimationClip& raw, const AnimationClip& clip) {
+        ClipError err;
+        std::vector<JointPose> a(raw.jointCount), b(raw.jointCount);
+        for (float t = 0.0f; t <= clip.Duration(); t += 1.0f / 97.0f) {
+            clip.Sample(t, true, a.data());
+            SampleRawClip(raw, t, true, b.data());
+            for (uint32_t j = 0; j < raw.jointCount; ++j) {
+                const float dot = std::fabs(a[j].rotation.x * b[j].rotation.x + a[j].rotation.y * b[j].rotation.y +
+                                            a[j].rotation.z * b[j].rotation.z + a[j].rotation.w * b[j].rotation.w);
+                err.rotation = std::max(err.rotation, 2.0f * std::acos(std::min(dot, 1.0f)));
+                err.translation = std::max({ err.translation, std::fabs(a[j].translation.x - b[j].translation.x),
+                    std::fabs(a[j].translation.y - b[j].translation.y), std::fabs(a[j].translation.z - b[j].translation.z),
+                    std::fabs(a[j].scale - b[j].scale) });
+            }
+        }
+        return err;
+    }
+
+} // namespace AnimationFixture
@@ -0,0 +1,158 @@
+#pragma once
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "Timing/Clock.h"
+#include "Timing/TimeWindow.h"
+
+// Small helpers shared by the benchmarks in this folder.
+namespace Bench {
+
+    // xorshift32: the same sequence on every machine and compiler.
+    inline uint32_t NextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // 0..1
+    inline float RandomFloat(uint32_t& state) {
+        return float(NextRandom(state) & 0xFFFFFF) / float(0x1000000);
+    }
+
+    // "--bench --frames=600 --fixed" -> { "--bench", "" }, { "--frames", "600" }, { "--fixed", "" }
+    inline std::vector<std::pair<std::string, std::string>> SplitArgs(const char* cmdLine) {
+        std::vector<std::pair<std::string, std::string>> args;
+        const char* p = cmdLine ? cmdLine : "";
+        for (;;) {
+            while (*p == ' ' || *p == '\t') ++p;
+            const char* start = p;
+            while (*p && *p != ' ' && *p != '\t') ++p;
+            if (p == start) break;
+
+            const std::string arg(start, p);
+            const size_t eq = arg.find('=');
+            if (eq == std::string::npos) args.push_back({ arg, std::string() });
+            else args.push_back({ arg.substr(0, eq), arg.substr(eq + 1) });
+        }
+        return args;
+    }
+
+    // The "--key=value" options of one benchmark, each bound to a field of
+    // its settings; a key without "=value" is a flag and sets a bool. Parse
+    // skips the benchmark's own flag and fails on unknown keys and on
+    // values that aren't numbers where a number is expected, so a typo
+    // doesn't silently run the defaults.
+    class Options {
+    public:
+        explicit Options(const char* mode) : m_mode(mode) {}
+
+        Options& Add(const char* key, uint32_t& target)    { m_options.push_back({ key, &target }); return *this; }
+        Options& Add(const char* key, float& target)       { m_options.push_back({ key, &target }); return *this; }
+        Options& Add(const char* key, double& target)      { m_options.push_back({ key, &target }); return *this; }
+        Options& Add(const char* key, std::string& target) { m_options.push_back({ key, &target }); return *this; }
+        Options& Add(const char* key, bool& flag)          { m_options.push_back({ key, &flag }); return *this; }
+
+        bool Parse(const char* cmdLine, std::string& error) const {
+            for (const auto& [key, value] : SplitArgs(cmdLine)) {
+                if (key == m_mode) continue;
+                const Option* option = Find(key);
+                if (!option) {
+                    error = "unknown option " + key;
+                    return false;
+                }
+                if (!Assign(option->target, value)) {
+                    error = "bad value for " + key + ": \"" + value + "\"";
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        using Target = std::variant<uint32_t*, float*, double*, std::string*, bool*>;
+        struct Option {
+            const char* key;
+            Target target;
+        };
+
+        const Option* Find(const std::string& key) const {
+            for (const Option& o : m_options)
+                if (key == o.key) return &o;
+            return nullptr;
+        }
+
+        static bool Assign(const Target& target, const std::string& value) {
+            if (std::string* const* s = std::get_if<std::string*>(&target)) {
+                **s = value;
+                return true;
+            }
+            if (bool* const* flag = std::get_if<bool*>(&target)) {
+                **flag = true;
+                return value.empty();
+            }
+            if (value.empty()) return false;
+            const char* v = value.c_str();
+            char* end = nullptr;
+            if (uint32_t* const* n = std::get_if<uint32_t*>(&target)) {
+                if (value[0] == '-') return false;
+                const unsigned long long parsed = std::strtoull(v, &end, 10);
+                if (*end || parsed > UINT32_MAX) return false;
+                **n = uint32_t(parsed);
+                return true;
+            }
+            const double parsed = std::strtod(v, &end);
+            if (*end) return false;
+            if (float* const* f = std::get_if<float*>(&target)) **f = float(parsed);
+            else **std::get_if<double*>(&target) = parsed;
+            return true;
+        }
+
+        const char* m_mode;
+        std::vector<Option> m_options;
+    };
+
+    // Runs `kernel` `iterations` times and summarizes how long each run took.
+    template <typename F>
+    FrameTimeSummary Time(uint32_t iterations, F&& kernel) {
+        std::vector<double> ms;
+        ms.reserve(iterations);
+        for (uint32_t i = 0; i < iterations; ++i) {
+            const Clock::Ticks t0 = Clock::NowTicks();
+            kernel();
+            ms.push_back(Clock::ToMilliseconds(Clock::NowTicks() - t0));
+        }
+        return SummarizeTimes(ms);
+    }
+
+    // printf into a std::string, for building JSON by hand.
+    inline void Append(std::string& out, const char* format, ...) {
+        char line[512];
+        va_list args;
+        va_start(args, format);
+        std::vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        out += line;
+    }
+
+    // Writes `text` to `path` and to stdout. False if the file couldn't be written.
+    inline bool WriteResult(const std::string& path, const std::string& text) {
+        std::fputs(text.c_str(), stdout);
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) {
+            std::fprintf(stderr, "can't write %s\n", path.c_str());
+            return false;
+        }
+        std::fwrite(text.data(), 1, text.size(), f);
+        std::fclose(f);
+        return true;
+    }
+
+} // namespace Bench
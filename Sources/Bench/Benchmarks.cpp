@@ -0,0 +1,93 @@
+#include "Bench/Benchmarks.h"
+#include <cstdio>
+#include <string>
+
+#include "Bench/BenchUtil.h"
+#include "Bench/AnimationBench.h"
+#include "Bench/CommandBench.h"
+#include "Bench/EventBench.h"
+#include "Bench/InputBench.h"
+#include "Bench/MathBench.h"
+#include "Bench/ParticleBench.h"
+#include "Bench/PhysicsBench.h"
+#include "Bench/QueryBench.h"
+#include "Bench/RenderGraphBench.h"
+#include "Bench/SceneBench.h"
+#include "Bench/SnapshotBench.h"
+#include "Bench/SpatialBench.h"
+#include "Bench/StaticBatchBench.h"
+#include "Bench/StreamingBench.h"
+#include "Bench/UploadBench.h"
+
+namespace {
+
+    // Every benchmark has a settings struct, a Parse and a Run with the
+    // same shape; this turns them into a row's `run`.
+    template <typename Settings,
+              bool (*Parse)(const char*, Settings&, std::string&),
+              int (*Run)(const Settings&)>
+    int ParseAndRun(const char* cmdLine)
+    {
+        Settings settings;
+        std::string error;
+        if (!Parse(cmdLine, settings, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 2;
+        }
+        return Run(settings);
+    }
+
+    const Benchmark Benchmarks[] = {
+        { "--bench",           "headless scene frames against a baseline, see Bench/SceneBench.h",
+          ParseAndRun<SceneBenchSettings, ParseSceneBenchArgs, RunSceneBench> },
+        { "--bench-spatial",   "SpatialGrid queries, see Bench/SpatialBench.h",
+          ParseAndRun<SpatialBenchSettings, ParseSpatialBenchArgs, RunSpatialBench> },
+        { "--bench-physics",   "PhysicsWorld steps, see Bench/PhysicsBench.h",
+          ParseAndRun<PhysicsBenchSettings, ParsePhysicsBenchArgs, RunPhysicsBench> },
+        { "--bench-animation", "pose sampling and CPU skinning, see Bench/AnimationBench.h",
+          ParseAndRun<AnimationBenchSettings, ParseAnimationBenchArgs, RunAnimationBench> },
+        { "--bench-particles", "particle update and instancing, see Bench/ParticleBench.h",
+          ParseAndRun<ParticleBenchSettings, ParseParticleBenchArgs, RunParticleBench> },
+        { "--bench-commands",  "deferred entity changes from jobs, see Bench/CommandBench.h",
+          ParseAndRun<CommandBenchSettings, ParseCommandBenchArgs, RunCommandBench> },
+        { "--bench-events",    "typed event channels, see Bench/EventBench.h",
+          ParseAndRun<EventBenchSettings, ParseEventBenchArgs, RunEventBench> },
+        { "--bench-streaming", "cells loaded around a moving camera, see Bench/StreamingBench.h",
+          ParseAndRun<StreamingBenchSettings, ParseStreamingBenchArgs, RunStreamingBench> },
+        { "--bench-static",    "static batching at level load, see Bench/StaticBatchBench.h",
+          ParseAndRun<StaticBatchBenchSettings, ParseStaticBatchBenchArgs, RunStaticBatchBench> },
+        { "--bench-math",      "batched matrix and box kernels, see Bench/MathBench.h",
+          ParseAndRun<MathBenchSettings, ParseMathBenchArgs, RunMathBench> },
+        { "--bench-upload",    "budgeted mesh uploads, see Bench/UploadBench.h",
+          ParseAndRun<UploadBenchSettings, ParseUploadBenchArgs, RunUploadBench> },
+        { "--bench-graph",     "render graph compile, culling and aliasing, see Bench/RenderGraphBench.h",
+          ParseAndRun<RenderGraphBenchSettings, ParseRenderGraphBenchArgs, RunRenderGraphBench> },
+        { "--bench-query",     "signature queries and tags, see Bench/QueryBench.h",
+          ParseAndRun<QueryBenchSettings, ParseQueryBenchArgs, RunQueryBench> },
+        { "--bench-snapshot",  "world snapshot save and load, see Bench/SnapshotBench.h",
+          ParseAndRun<SnapshotBenchSettings, ParseSnapshotBenchArgs, RunSnapshotBench> },
+        { "--bench-input",     "input events from a producer thread, see Bench/InputBench.h",
+          ParseAndRun<InputBenchSettings, ParseInputBenchArgs, RunInputBench> },
+    };
+
+} // namespace
+
+const Benchmark* FindBenchmark(const char* cmdLine)
+{
+    // Whole tokens only: "--bench-math" must not pick "--bench".
+    for (const auto& [key, value] : Bench::SplitArgs(cmdLine))
+        for (const Benchmark& b : Benchmarks)
+            if (key == b.flag) return &b;
+    return nullptr;
+}
+
+int RunBenchmark(const char* cmdLine)
+{
+    if (const Benchmark* b = FindBenchmark(cmdLine))
+        return b->run(cmdLine);
+
+    std::fprintf(stderr, "unknown benchmark, one of:\n");
+    for (const Benchmark& b : Benchmarks)
+        std::fprintf(stderr, "  %-18s %s\n", b.flag, b.description);
+    return 2;
+}
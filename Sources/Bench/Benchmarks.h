@@ -0,0 +1,27 @@
+#pragma once
+
+/*
+ * Benchmarks
+ * Every benchmark Dreivy.exe can run instead of the game, one row per
+ * command line flag (see Benchmarks.cpp). A row parses its own options
+ * with Bench::Options and runs; main only looks the flag up here.
+ *
+ * Benchmarks measure. What must hold (same results from the SIMD and
+ * scalar paths, from jobs and serial, before and after a rebuild) is
+ * checked by Dreivy.Tests, which needs no window and no device.
+ *
+ *     Dreivy.exe --bench-spatial --agents=100000
+ * Exit code: the benchmark's, 2 for an unknown --bench-* flag or bad arguments.
+ */
+struct Benchmark {
+    const char* flag;           // "--bench-spatial"
+    const char* description;
+    int (*run)(const char* cmdLine);
+};
+
+// The benchmark whose flag is on `cmdLine`, nullptr if none is.
+const Benchmark* FindBenchmark(const char* cmdLine);
+
+// Runs the benchmark named on `cmdLine` and returns its exit code;
+// lists the benchmarks and returns 2 if the flag is unknown.
+int RunBenchmark(const char* cmdLine);
@@ -0,0 +1,81 @@
+#include "CommandBench.h"
+#include "CommandFixture.h"
+#include "BenchUtil.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+
+#include <iterator>
+#include <vector>
+
+using namespace CommandFixture;
+
+bool ParseCommandBenchArgs(const char* cmdLine, CommandBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-commands");
+    options.Add("--entities", s.entities);
+    options.Add("--spawn",    s.spawn);
+    options.Add("--frames",   s.frames);
+    options.Add("--seed",     s.seed);
+    options.Add("--out",      s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.frames == 0 || s.entities + s.spawn == 0) {
+        error = "--frames must be positive, and --entities or --spawn too";
+        return false;
+    }
+    return true;
+}
+
+int RunCommandBench(const CommandBenchSettings& settings)
+{
+    JobSystem jobs;
+    Storm storm, direct;
+    storm.seed = direct.seed = settings.seed;
+    storm.jobs = &jobs;
+    storm.commands.SetJobSystem(&jobs);
+    Populate(storm, settings.entities);
+    Populate(direct, settings.entities);
+
+    std::vector<double> recordMs, playbackMs, totalMs, directMs;
+    uint64_t creates = 0, destroys = 0, adds = 0;
+    EcsVector<Entity> dead;
+    for (uint32_t frame = 0; frame < settings.frames; ++frame) {
+        const Clock::Ticks t0 = Clock::NowTicks();
+        Record(storm, settings.spawn);
+        const Clock::Ticks t1 = Clock::NowTicks();
+        storm.commands.Playback(storm.world);
+        const Clock::Ticks t2 = Clock::NowTicks();
+        Direct(direct, settings.spawn, dead);
+        const Clock::Ticks t3 = Clock::NowTicks();
+
+        recordMs.push_back(Clock::ToMilliseconds(t1 - t0));
+        playbackMs.push_back(Clock::ToMilliseconds(t2 - t1));
+        totalMs.push_back(Clock::ToMilliseconds(t2 - t0));
+        directMs.push_back(Clock::ToMilliseconds(t3 - t2));
+        const EntityCommandStats& st = storm.commands.GetStats();
+        creates += st.creates;
+        destroys += st.destroys;
+        adds += st.adds;
+    }
+
+    // ---- JSON ----
+    const double frames = double(settings.frames);
+    std::string json = "{\n  \"benchmark\": \"commands\",\n";
+    Bench::Append(json, "  \"config\": { \"entities\": %u, \"spawn\": %u, \"frames\": %u, \"workers\": %u, \"seed\": %u },\n",
+        settings.entities, settings.spawn, settings.frames, jobs.WorkerCount(), settings.seed);
+
+    json += "  \"per_frame\": {\n";
+    struct Row { const char* name; std::vector<double>* ms; };
+    const Row rows[] = { { "record", &recordMs }, { "playback", &playbackMs }, { "total", &totalMs }, { "direct_serial", &directMs } };
+    for (size_t i = 0; i < std::size(rows); ++i) {
+        const FrameTimeSummary s = SummarizeTimes(*rows[i].ms);
+        Bench::Append(json, "    \"%s\": { \"mean_ms\": %.4f, \"p99_ms\": %.4f }%s\n",
+            rows[i].name, s.averageMs, s.p99Ms, i + 1 < std::size(rows) ? "," : "");
+    }
+    json += "  },\n";
+
+    Bench::Append(json, "  \"creates_per_frame\": %.1f,\n  \"destroys_per_frame\": %.1f,\n  \"adds_per_frame\": %.1f,\n  \"alive_at_end\": %zu\n}\n",
+        double(creates) / frames, double(destroys) / frames, double(adds) / frames, storm.world.GetPool<Projectile>().Size());
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
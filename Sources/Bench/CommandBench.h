@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * CommandBench
+ * A projectile storm: `entities` projectiles fly up, and every frame jobs
+ * walk them, destroy the ones that left the arena and fire `spawn` new ones
+ * through EntityCommands, then Playback applies it all. Reports the
+ * recording (parallel) and the playback per frame, next to doing the same
+ * changes straight on the World from one thread.
+ *
+ * The storm is Bench/CommandFixture.h; Tests/CommandTests.cpp checks that
+ * the jobs end with exactly the world one thread gives, and the rules of
+ * Playback.
+ *
+ *     Dreivy.exe --bench-commands --entities=100000 --spawn=5000 --out=CommandBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct CommandBenchSettings {
+    uint32_t entities = 100000;  // alive at the start
+    uint32_t spawn = 5000;       // fired per frame
+    uint32_t frames = 240;
+    uint32_t seed = 1;
+    std::string output = "CommandBench.json";
+};
+
+bool ParseCommandBenchArgs(const char* cmdLine, CommandBenchSettings& settings, std::string& error);
+int RunCommandBench(const CommandBenchSettings& settings);
@@ -0,0 +1,140 @@
+#pragma once
+#include <algorithm>
+
+#include "Bench/BenchUtil.h"
+#include "Threading/JobSystem.h"
+#include "World/ECS/Component/Mesh.h"
+#include "World/ECS/Component/Transform.h"
+#include "World/ECS/EntityCommands.h"
+
+// Projectiles moved from jobs: each frame destroys the ones that left the
+// arena and fires new ones, all through per-thread command buffers.
+namespace CommandFixture {
+
+    constexpr float Dt = 1.0f / 60.0f;
+    constexpr float ArenaHeight = 100.0f;
+    constexpr uint32_t Grain = 2048;
+
+    struct Projectile {
+        XMFLOAT3 velocity;
+        float age;
+    };
+
+    // Random but fixed per (seed, frame, shot): any thread fires the same shot.
+    inline float ShotRandom(uint32_t seed, uint32_t frame, uint32_t shot, uint32_t k) {
+        uint32_t state = (seed * 0x9E3779B9u) ^ (frame * 0x85EBCA6Bu) ^ (shot * 0xC2B2AE35u) ^ (k * 0x27D4EB2Fu);
+        state = state ? state : 1;
+        Bench::NextRandom(state);
+        return Bench::RandomFloat(state);
+    }
+
+    inline void Fire(uint32_t seed, uint32_t frame, uint32_t shot, Transform& t, Projectile& p) {
+        t = Transform{};
+        t.position = { ShotRandom(seed, frame, shot, 0) * 200.0f - 100.0f, 0.0f, ShotRandom(seed, frame, shot, 1) * 200.0f - 100.0f };
+        p.velocity = { ShotRandom(seed, frame, shot, 2) - 0.5f, 20.0f + ShotRandom(seed, frame, shot, 3) * 40.0f, ShotRandom(seed, frame, shot, 4) - 0.5f };
+        p.age = 0.0f;
+    }
+
+    struct Storm {
+        World world;
+        EntityCommands commands;
+        JobSystem* jobs = nullptr;
+        uint32_t seed = 1;
+        uint32_t frame = 0;
+    };
+
+    inline void Populate(Storm& s, uint32_t entities) {
+        for (uint32_t i = 0; i < entities; ++i) {
+            Transform t;
+            Projectile p;
+            Fire(s.seed, ~0u, i, t, p);
+            t.position.y = ShotRandom(s.seed, ~0u, i, 5) * ArenaHeight; // already on their way
+            const Entity e = s.world.CreateEntity();
+            s.world.AddComponent<Transform>(e, t);
+            s.world.AddComponent<Projectile>(e, p);
+            s.world.AddComponent<Mesh>(e, Mesh{ 1 });
+        }
+    }
+
+    // Moves every projectile, destroys the ones out of the arena and fires
+    // `spawn` new ones, all recorded from jobs (or this thread without jobs).
+    inline void Record(Storm& s, uint32_t spawn) {
+        ComponentPool<Projectile>& projectiles = s.world.GetPool<Projectile>();
+        ComponentPool<Transform>& transforms = s.world.GetPool<Transform>();
+        const uint32_t frame = s.frame;
+
+        auto move = [&](uint32_t begin, uint32_t end) {
+            EntityCommandBuffer& cmd = s.commands.ForThisThread();
+            cmd.SetSortKey(begin);
+            const EcsVector<Entity>& entities = projectiles.Entities();
+            EcsVector<Projectile>& data = projectiles.Data();
+            for (uint32_t i = begin; i < end; ++i) {
+                Projectile& p = data[i];
+                Transform* t = transforms.TryGet(entities[i]);
+                if (!t) continue;
+                p.age += Dt;
+                t->position.x += p.velocity.x * Dt;
+                t->position.y += p.velocity.y * Dt;
+                t->position.z += p.velocity.z * Dt;
+                if (t->position.y > ArenaHeight)
+                    cmd.DestroyEntity(entities[i]);
+            }
+        };
+        // Keys after every index of `move`, so the shots come last.
+        const uint32_t count = static_cast<uint32_t>(projectiles.Size());
+        auto fire = [&](uint32_t begin, uint32_t end) {
+            EntityCommandBuffer& cmd = s.commands.ForThisThread();
+            cmd.SetSortKey(count + begin);
+            for (uint32_t i = begin; i < end; ++i) {
+                Transform t;
+                Projectile p;
+                Fire(s.seed, frame, i, t, p);
+                const Entity e = cmd.CreateEntity();
+                cmd.AddComponent(e, t);
+                cmd.AddComponent(e, p);
+                cmd.AddComponent(e, Mesh{ 1 });
+            }
+        };
+
+        if (s.jobs) {
+            s.jobs->ParallelFor(count, Grain, move);
+            s.jobs->ParallelFor(spawn, Grain, fire);
+        }
+        else {
+            for (uint32_t b = 0; b < count; b += Grain) move(b, std::min(b + Grain, count));
+            for (uint32_t b = 0; b < spawn; b += Grain) fire(b, std::min(b + Grain, spawn));
+        }
+        ++s.frame;
+    }
+
+    // The same frame without commands: one thread, straight on the World.
+    inline void Direct(Storm& s, uint32_t spawn, EcsVector<Entity>& dead) {
+        ComponentPool<Projectile>& projectiles = s.world.GetPool<Projectile>();
+        ComponentPool<Transform>& transforms = s.world.GetPool<Transform>();
+        dead.clear();
+        for (size_t i = 0; i < projectiles.Size(); ++i) {
+            Projectile& p = projectiles.Data()[i];
+            Transform* t = transforms.TryGet(projectiles.Entities()[i]);
+            if (!t) continue;
+            p.age += Dt;
+            t->position.x += p.velocity.x * Dt;
+            t->position.y += p.velocity.y * Dt;
+            t->position.z += p.velocity.z * Dt;
+            if (t->position.y > ArenaHeight)
+                dead.push_back(projectiles.Entities()[i]);
+        }
+        for (Entity e : dead)
+            s.world.DestroyEntity(e);
+        for (uint32_t i = 0; i < spawn; ++i) {
+            Transform t;
+            Projectile p;
+            Fire(s.seed, s.frame, i, t, p);
+            const Entity e = s.world.CreateEntity();
+            s.world.AddComponent<Transform>(e, t);
+            s.world.AddComponent<Projectile>(e, p);
+            s.world.AddComponent<Mesh>(e, Mesh{ 1 });
+        }
+        ++s.frame;
+    }
+
+} // namespace CommandFixture
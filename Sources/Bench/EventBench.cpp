@@ -0,0 +1,90 @@
+#include "EventBench.h"
+#include "EventFixture.h"
+#include "BenchUtil.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+
+#include <iterator>
+#include <vector>
+
+using namespace EventFixture;
+
+bool ParseEventBenchArgs(const char* cmdLine, EventBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-events");
+    options.Add("--events",  s.events);
+    options.Add("--readers", s.readers);
+    options.Add("--frames",  s.frames);
+    options.Add("--seed",    s.seed);
+    options.Add("--out",     s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.events == 0 || s.frames == 0) {
+        error = "--events and --frames must be positive";
+        return false;
+    }
+    return true;
+}
+
+int RunEventBench(const EventBenchSettings& settings)
+{
+    JobSystem jobs;
+
+    EventBus bus;
+    EventChannel<CollisionEvent>& channel = bus.Register<CollisionEvent>(settings.events);
+    std::vector<EventReader> readers(settings.readers, channel.NewReader());
+
+    std::vector<double> updateMs, writeMs, readMs;
+    uint64_t written = 0, read = 0, dropped = 0;
+    double checksum = 0.0;
+    const uint64_t allocsBefore = AllocTracker::GetStats(AllocTag::ECS).totalCount;
+    for (uint32_t frame = 0; frame < settings.frames; ++frame) {
+        const Clock::Ticks t0 = Clock::NowTicks();
+        bus.Update();
+        const Clock::Ticks t1 = Clock::NowTicks();
+        WriteTick(channel, &jobs, settings.seed, frame, settings.events);
+        const Clock::Ticks t2 = Clock::NowTicks();
+        for (EventReader& r : readers) {
+            const EventBatch<CollisionEvent> batch = channel.Read(r);
+            float sum = 0.0f;
+            batch.ForEach([&](const CollisionEvent& e) { sum += e.impulse; });
+            checksum += sum;
+            read += batch.Size();
+        }
+        const Clock::Ticks t3 = Clock::NowTicks();
+
+        updateMs.push_back(Clock::ToMilliseconds(t1 - t0));
+        writeMs.push_back(Clock::ToMilliseconds(t2 - t1));
+        readMs.push_back(Clock::ToMilliseconds(t3 - t2));
+        written += channel.CurrentCount();
+        dropped += frame ? channel.GetStats().dropped : 0;
+    }
+    const uint64_t allocs = AllocTracker::GetStats(AllocTag::ECS).totalCount - allocsBefore;
+
+    // ---- JSON ----
+    const double frames = double(settings.frames);
+    const double perFrame = double(written) / frames;
+    std::string json = "{\n  \"benchmark\": \"events\",\n";
+    Bench::Append(json, "  \"config\": { \"events\": %u, \"readers\": %u, \"frames\": %u, \"workers\": %u, \"seed\": %u },\n",
+        settings.events, settings.readers, settings.frames, jobs.WorkerCount(), settings.seed);
+
+    json += "  \"per_frame\": {\n";
+    struct Row { const char* name; std::vector<double>* ms; double events; };
+    const Row rows[] = {
+        { "update", &updateMs, perFrame },
+        { "write", &writeMs, perFrame },
+        { "read", &readMs, double(read) / frames }
+    };
+    for (size_t i = 0; i < std::size(rows); ++i) {
+        const FrameTimeSummary s = SummarizeTimes(*rows[i].ms);
+        Bench::Append(json, "    \"%s\": { \"mean_ms\": %.4f, \"p99_ms\": %.4f, \"ns_per_event\": %.3f }%s\n",
+            rows[i].name, s.averageMs, s.p99Ms, rows[i].events > 0.0 ? s.averageMs * 1e6 / rows[i].events : 0.0,
+            i + 1 < std::size(rows) ? "," : "");
+    }
+    json += "  },\n";
+
+    Bench::Append(json, "  \"written_per_frame\": %.0f,\n  \"dropped\": %llu,\n  \"steady_allocations\": %llu,\n  \"alloc_tracking\": %s,\n  \"checksum\": %.1f\n}\n",
+        perFrame, (unsigned long long)dropped, (unsigned long long)allocs, AllocTracker::Enabled ? "true" : "false", checksum);
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
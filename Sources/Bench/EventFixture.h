@@ -0,0 +1,55 @@
+#pragma once
+#include "Bench/BenchUtil.h"
+#include "Events/EventBus.h"
+#include "Threading/JobSystem.h"
+
+// Collision events that depend only on (seed, tick, index), so any thread
+// can write any of them and a reader can tell what it should have got.
+namespace EventFixture {
+
+    constexpr uint32_t Grain = 1024;
+    constexpr uint32_t BatchSize = 64;
+
+    struct CollisionEvent {
+        Entity a, b;
+        float impulse;
+        uint32_t id; // index within its tick
+    };
+
+    inline CollisionEvent MakeEvent(uint32_t seed, uint32_t tick, uint32_t i) {
+        uint32_t state = (seed * 0x9E3779B9u) ^ (tick * 0x85EBCA6Bu) ^ (i * 0xC2B2AE35u);
+        state = state ? state : 1;
+        CollisionEvent e;
+        e.a = Bench::NextRandom(state) % 100000 + 1;
+        e.b = Bench::NextRandom(state) % 100000 + 1;
+        e.impulse = Bench::RandomFloat(state) * 10.0f;
+        e.id = i;
+        return e;
+    }
+
+    // `count` events from jobs: the first half of every chunk one by one,
+    // the rest in batches, the way a contact solver would hand them over.
+    inline void WriteTick(EventChannel<CollisionEvent>& channel, JobSystem* jobs, uint32_t seed, uint32_t tick, uint32_t count) {
+        auto write = [&](uint32_t begin, uint32_t end) {
+            const uint32_t mid = begin + (end - begin) / 2;
+            for (uint32_t i = begin; i < mid; ++i)
+                channel.Write(MakeEvent(seed, tick, i));
+
+            CollisionEvent local[BatchSize];
+            uint32_t n = 0;
+            for (uint32_t i = mid; i < end; ++i) {
+                local[n++] = MakeEvent(seed, tick, i);
+                if (n == BatchSize) {
+                    channel.WriteBatch(local, n);
+                    n = 0;
+                }
+            }
+            channel.WriteBatch(local, n);
+        };
+        if (jobs)
+            jobs->ParallelFor(count, Grain, write);
+        else
+            write(0, count);
+    }
+
+} // namespace EventFixture
@@ -0,0 +1,100 @@
+#include "InputBench.h"
+#include "BenchUtil.h"
+#include "Input/InputState.h"
+#include "Input/SyntheticInput.h"
+#include "Timing/Clock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+bool ParseInputBenchArgs(const char* cmdLine, InputBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-input");
+    options.Add("--events", s.events);
+    options.Add("--seed",   s.seed);
+    options.Add("--out",    s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.events == 0) {
+        error = "--events must be positive";
+        return false;
+    }
+    return true;
+}
+
+int RunInputBench(const InputBenchSettings& settings)
+{
+    const uint32_t n = settings.events;
+    auto queue = std::make_unique<InputQueue>();
+    InputState state;
+    uint64_t checksum = 0;
+
+    // One thread: emit a batch, consume it.
+    uint64_t single = 0;
+    Clock::Ticks t0 = Clock::NowTicks();
+    {
+        SyntheticInput source(settings.seed);
+        for (uint32_t sent = 0; sent < n;) {
+            sent += source.Emit(*queue, std::min(16u, n - sent), sent);
+            single += state.Consume(*queue, sent);
+            checksum += uint64_t(state.MouseX());
+        }
+    }
+    const double singleMs = Clock::ToMilliseconds(Clock::NowTicks() - t0);
+
+    // The queue alone.
+    const InputEvent e{};
+    InputEvent out;
+    t0 = Clock::NowTicks();
+    for (uint32_t i = 0; i < n; ++i) {
+        queue->Push(e);
+        queue->TryPop(out);
+        checksum += uint64_t(out.time);
+    }
+    const double pushPopMs = Clock::ToMilliseconds(Clock::NowTicks() - t0);
+
+    // A producer thread and a consumer.
+    const uint64_t droppedBefore = queue->Dropped();
+    std::atomic<bool> done{ false };
+    uint64_t threaded = 0;
+    t0 = Clock::NowTicks();
+    std::thread producer([&] {
+        SyntheticInput source(settings.seed);
+        for (uint32_t sent = 0; sent < n;) {
+            const uint32_t pushed = source.Emit(*queue, std::min(16u, n - sent), sent);
+            sent += pushed;
+            if (pushed == 0)
+                std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+    for (;;) {
+        const bool last = done.load(std::memory_order_acquire);
+        const uint32_t consumed = state.Consume(*queue, n);
+        threaded += consumed;
+        checksum += uint64_t(state.MouseY());
+        if (last && queue->SizeApprox() == 0)
+            break;
+        if (consumed == 0)
+            std::this_thread::yield();
+    }
+    producer.join();
+    const double threadedMs = Clock::ToMilliseconds(Clock::NowTicks() - t0);
+
+    auto perSecond = [](uint64_t count, double ms) { return ms > 0.0 ? double(count) * 1000.0 / ms : 0.0; };
+
+    // ---- JSON ----
+    std::string json = "{\n  \"benchmark\": \"input\",\n";
+    Bench::Append(json, "  \"config\": { \"events\": %u, \"seed\": %u },\n", n, settings.seed);
+    Bench::Append(json, "  \"single_thread\": { \"events\": %llu, \"ms\": %.2f, \"events_per_s\": %.0f },\n",
+        (unsigned long long)single, singleMs, perSecond(single, singleMs));
+    Bench::Append(json, "  \"push_pop\": { \"ns\": %.2f },\n", pushPopMs * 1e6 / double(n));
+    Bench::Append(json, "  \"threaded\": { \"events\": %llu, \"ms\": %.2f, \"events_per_s\": %.0f, \"refused_pushes\": %llu },\n",
+        (unsigned long long)threaded, threadedMs, perSecond(threaded, threadedMs),
+        (unsigned long long)(queue->Dropped() - droppedBefore));
+    Bench::Append(json, "  \"checksum\": %llu\n}\n", (unsigned long long)checksum);
+
+    Bench::WriteResult(settings.output, json);
+    return single == n && threaded == n ? 0 : 1;
+}
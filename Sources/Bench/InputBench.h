@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * InputBench
+ * `events` SyntheticInput events through an InputQueue into InputState,
+ * three ways: emitted and consumed on one thread in batches of 16, a bare
+ * Push + TryPop pair on one thread, and a producer thread emitting while
+ * the consumer ticks, as the window and the game do. Reports events per
+ * second, nanoseconds per push + pop, and how many pushes the full queue
+ * refused (the producer retries them, so none is lost).
+ *
+ * Tests/InputTests.cpp checks that nothing is lost or reordered, also
+ * across a full queue and between threads.
+ *
+ *     Dreivy.exe --bench-input --events=20000000 --out=InputBench.json
+ * Exit code: 0 ok, 1 events lost, 2 bad arguments.
+ */
+struct InputBenchSettings {
+    uint32_t events = 20000000;
+    uint32_t seed = 1;
+    std::string output = "InputBench.json";
+};
+
+bool ParseInputBenchArgs(const char* cmdLine, InputBenchSettings& settings, std::string& error);
+int RunInputBench(const InputBenchSettings& settings);
@@ -0,0 +1,86 @@
+#include "MathBench.h"
+#include "MathFixture.h"
+#include "BenchUtil.h"
+
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+using namespace DirectX;
+using namespace MathFixture;
+
+bool ParseMathBenchArgs(const char* cmdLine, MathBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-math");
+    options.Add("--count",      s.count);
+    options.Add("--iterations", s.iterations);
+    options.Add("--seed",       s.seed);
+    options.Add("--out",        s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.count == 0 || s.iterations == 0) {
+        error = "--count and --iterations must be positive";
+        return false;
+    }
+    return true;
+}
+
+int RunMathBench(const MathBenchSettings& settings)
+{
+    uint32_t rng = settings.seed ? settings.seed : 1;
+    const uint32_t n = settings.count;
+    const std::vector<Mat4> worlds = RandomWorlds(n, rng);
+    const std::vector<Aabb> boxes = RandomBoxes(n, rng);
+    const Mat4 vp = ViewProj();
+    std::vector<Mat4> mvps(n);
+    std::vector<Aabb> worldBoxes(n);
+    float checksum = 0.0f;
+
+    // What Renderer::Draw did per item before: load, multiply, store.
+    auto directXMath = [&] {
+        XMFLOAT4X4 vpf;
+        std::memcpy(&vpf, &vp, sizeof(vpf));
+        const XMMATRIX viewProj = XMLoadFloat4x4(&vpf);
+        for (uint32_t i = 0; i < n; ++i)
+            XMStoreFloat4x4(reinterpret_cast<XMFLOAT4X4*>(&mvps[i]),
+                XMLoadFloat4x4(reinterpret_cast<const XMFLOAT4X4*>(&worlds[i])) * viewProj);
+        checksum += mvps[n / 2].m[3][0];
+    };
+
+    struct Row { const char* name; FrameTimeSummary simd; FrameTimeSummary scalar; FrameTimeSummary baseline; bool hasBaseline; };
+    Row rows[] = {
+        { "concat_world_viewproj",
+          Bench::Time(settings.iterations, [&] { Simd::MultiplyMatrices(worlds.data(), vp, mvps.data(), n); checksum += mvps[n / 2].m[3][0]; }),
+          Bench::Time(settings.iterations, [&] { Simd::Scalar::MultiplyMatrices(worlds.data(), vp, mvps.data(), n); checksum += mvps[n / 2].m[3][0]; }),
+          Bench::Time(settings.iterations, directXMath), true },
+        { "aabb_per_matrix",
+          Bench::Time(settings.iterations, [&] { Simd::TransformAabbs(boxes.data(), worlds.data(), worldBoxes.data(), n); checksum += worldBoxes[n / 2].max[0]; }),
+          Bench::Time(settings.iterations, [&] { Simd::Scalar::TransformAabbs(boxes.data(), worlds.data(), worldBoxes.data(), n); checksum += worldBoxes[n / 2].max[0]; }),
+          {}, false },
+        { "aabb_one_matrix",
+          Bench::Time(settings.iterations, [&] { Simd::TransformAabbs(boxes.data(), worlds[0], worldBoxes.data(), n); checksum += worldBoxes[n / 2].max[0]; }),
+          Bench::Time(settings.iterations, [&] { Simd::Scalar::TransformAabbs(boxes.data(), worlds[0], worldBoxes.data(), n); checksum += worldBoxes[n / 2].max[0]; }),
+          {}, false },
+    };
+
+    // ---- JSON ----
+    std::string json = "{\n  \"benchmark\": \"math\",\n";
+    Bench::Append(json, "  \"config\": { \"backend\": \"%s\", \"count\": %u, \"iterations\": %u, \"seed\": %u },\n",
+        Simd::BackendName(), settings.count, settings.iterations, settings.seed);
+    json += "  \"kernels\": {\n";
+    for (size_t i = 0; i < std::size(rows); ++i) {
+        const Row& r = rows[i];
+        const double perItem = 1e6 / double(n); // ms per call -> ns per item
+        Bench::Append(json, "    \"%s\": { \"mean_ms\": %.4f, \"p99_ms\": %.4f, \"ns_per_item\": %.2f, \"scalar_ns_per_item\": %.2f, \"speedup_vs_scalar\": %.2f",
+            r.name, r.simd.averageMs, r.simd.p99Ms, r.simd.averageMs * perItem, r.scalar.averageMs * perItem,
+            r.simd.averageMs > 0.0 ? r.scalar.averageMs / r.simd.averageMs : 0.0);
+        if (r.hasBaseline)
+            Bench::Append(json, ", \"directxmath_ns_per_item\": %.2f, \"speedup_vs_directxmath\": %.2f",
+                r.baseline.averageMs * perItem, r.simd.averageMs > 0.0 ? r.baseline.averageMs / r.simd.averageMs : 0.0);
+        Bench::Append(json, " }%s\n", i + 1 < std::size(rows) ? "," : "");
+    }
+    json += "  },\n";
+    Bench::Append(json, "  \"checksum\": %.3f\n}\n", checksum);
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
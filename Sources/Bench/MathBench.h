@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * MathBench
+ * The batched kernels of Math/SimdMath.h on `count` random matrices and
+ * boxes, `iterations` times each: world * viewProj for every matrix, and
+ * local boxes to world boxes (one matrix per box, and one for all). Every
+ * kernel is timed on the backend this build selected, on the scalar
+ * reference, and (for the matrices) as the one-at-a-time DirectXMath loop
+ * the renderer used before.
+ *
+ * The inputs are Bench/MathFixture.h; Tests/MathTests.cpp checks the
+ * selected backend against the scalar one on the same kind of data.
+ *
+ *     Dreivy.exe --bench-math --count=20000 --iterations=200 --out=MathBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct MathBenchSettings {
+    uint32_t count = 20000;     // matrices / boxes per call
+    uint32_t iterations = 200;  // calls per kernel
+    uint32_t seed = 1;
+    std::string output = "MathBench.json";
+};
+
+bool ParseMathBenchArgs(const char* cmdLine, MathBenchSettings& settings, std::string& error);
+int RunMathBench(const MathBenchSettings& settings);
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstring>
+#include <vector>
+
+#include "Bench/BenchUtil.h"
+#include "Math/SimdMath.h"
+#include "Math/TransformUtils.h"
+#include "Renderer/Camera.h"
+#include "World/ECS/Component/Transform.h"
+
+// Random world matrices and boxes shaped like a scene's, and one camera, as
+// the Mat4/Aabb inputs of the batched kernels.
+namespace MathFixture {
+
+    using Simd::Aabb;
+    using Simd::Mat4;
+
+    inline Mat4 ToMat4(FXMMATRIX m) {
+        XMFLOAT4X4 f;
+        XMStoreFloat4x4(&f, m);
+        Mat4 out;
+        std::memcpy(&out, &f, sizeof(out));
+        return out;
+    }
+
+    // World matrices like a scene has: anywhere in 200 m, any rotation,
+    // scaled 0.5..2, some of them mirrored.
+    inline std::vector<Mat4> RandomWorlds(uint32_t count, uint32_t& rng) {
+        std::vector<Mat4> out(count);
+        for (Mat4& m : out) {
+            Transform t;
+            t.position = { Bench::RandomFloat(rng) * 200.0f - 100.0f, Bench::RandomFloat(rng) * 20.0f, Bench::RandomFloat(rng) * 200.0f - 100.0f };
+            t.rotation = { Bench::RandomFloat(rng) * 6.28f, Bench::RandomFloat(rng) * 6.28f, Bench::RandomFloat(rng) * 6.28f };
+            const float s = 0.5f + Bench::RandomFloat(rng) * 1.5f;
+            t.scale = { Bench::NextRandom(rng) % 8 == 0 ? -s : s, s * (0.5f + Bench::RandomFloat(rng)), s };
+            m = ToMat4(BuildWorldMatrix(t));
+        }
+        return out;
+    }
+
+    inline std::vector<Aabb> RandomBoxes(uint32_t count, uint32_t& rng) {
+        std::vector<Aabb> out(count);
+        for (Aabb& b : out) {
+            for (int k = 0; k < 3; ++k) {
+                b.min[k] = Bench::RandomFloat(rng) * 4.0f - 2.0f;
+                b.max[k] = b.min[k] + Bench::RandomFloat(rng) * 3.0f;
+            }
+            b.min[3] = b.max[3] = 0.0f;
+        }
+        return out;
+    }
+
+    inline Mat4 ViewProj() {
+        Camera camera;
+        camera.position = { 0.0f, 30.0f, -120.0f };
+        return ToMat4(BuildViewMatrix(camera) * BuildProjectionMatrix(camera, 16.0f / 9.0f));
+    }
+
+} // namespace MathFixture
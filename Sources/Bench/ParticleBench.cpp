@@ -0,0 +1,77 @@
+#include "ParticleBench.h"
+#include "ParticleFixture.h"
+#include "BenchUtil.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+
+#include <iterator>
+#include <vector>
+
+using namespace ParticleFixture;
+
+bool ParseParticleBenchArgs(const char* cmdLine, ParticleBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-particles");
+    options.Add("--particles", s.particles);
+    options.Add("--emitters",  s.emitters);
+    options.Add("--frames",    s.frames);
+    options.Add("--seed",      s.seed);
+    options.Add("--out",       s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.particles == 0 || s.emitters == 0 || s.frames == 0 || s.emitters > s.particles) {
+        error = "--particles, --emitters and --frames must be positive, --emitters at most --particles";
+        return false;
+    }
+    return true;
+}
+
+int RunParticleBench(const ParticleBenchSettings& settings)
+{
+    JobSystem jobs;
+    Scene scene;
+    BuildScene(scene, settings.emitters, settings.particles / settings.emitters, settings.seed);
+    scene.system.SetJobSystem(&jobs);
+
+    std::vector<double> updateMs, submitMs, totalMs;
+    uint64_t live = 0, spawned = 0, batches = 0;
+    for (uint32_t frame = 0; frame < settings.frames; ++frame) {
+        const Clock::Ticks t0 = Clock::NowTicks();
+        scene.system.Update(Dt);
+        const Clock::Ticks t1 = Clock::NowTicks();
+        scene.queue.Clear();
+        scene.system.Submit(scene.meshes, scene.queue, scene.view);
+        const Clock::Ticks t2 = Clock::NowTicks();
+
+        updateMs.push_back(Clock::ToMilliseconds(t1 - t0));
+        submitMs.push_back(Clock::ToMilliseconds(t2 - t1));
+        totalMs.push_back(Clock::ToMilliseconds(t2 - t0));
+        const ParticleStats& st = scene.system.GetStats();
+        live += st.live;
+        spawned += st.spawned;
+        batches += st.batches;
+    }
+
+    // ---- JSON ----
+    const double frames = double(settings.frames);
+    const double perFrameLive = double(live) / frames;
+    std::string json = "{\n  \"benchmark\": \"particles\",\n";
+    Bench::Append(json, "  \"config\": { \"particles\": %u, \"emitters\": %u, \"frames\": %u, \"workers\": %u, \"seed\": %u },\n",
+        settings.particles, settings.emitters, settings.frames, jobs.WorkerCount(), settings.seed);
+
+    json += "  \"per_frame\": {\n";
+    struct Row { const char* name; std::vector<double>* ms; };
+    const Row rows[] = { { "update", &updateMs }, { "submit", &submitMs }, { "total", &totalMs } };
+    for (size_t i = 0; i < std::size(rows); ++i) {
+        const FrameTimeSummary s = SummarizeTimes(*rows[i].ms);
+        Bench::Append(json, "    \"%s\": { \"mean_ms\": %.4f, \"p99_ms\": %.4f, \"ns_per_particle\": %.3f }%s\n",
+            rows[i].name, s.averageMs, s.p99Ms, perFrameLive > 0.0 ? s.averageMs * 1e6 / perFrameLive : 0.0,
+            i + 1 < std::size(rows) ? "," : "");
+    }
+    json += "  },\n";
+
+    Bench::Append(json, "  \"live_per_frame\": %.0f,\n  \"spawned_per_frame\": %.0f,\n  \"batches_per_frame\": %.1f\n}\n",
+        perFrameLive, double(spawned) / frames, double(batches) / frames);
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
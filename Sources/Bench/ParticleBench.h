@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * ParticleBench
+ * `particles` particles spread over `emitters` emitters on a grid, kept
+ * near full (a burst to fill them, then a rate that replaces the dead),
+ * for `frames` fixed 60 Hz frames: ParticleSystem::Update (integrate, find
+ * and fill the holes, spawn) then Submit (cull, write the instances into a
+ * RenderQueue). Reports both per frame and per particle.
+ *
+ * The fountains are Bench/ParticleFixture.h; Tests/ParticleTests.cpp checks
+ * the SIMD update, the compaction, the jobs and the instance data on small
+ * emitters.
+ *
+ *     Dreivy.exe --bench-particles --particles=1000000 --emitters=64 --out=ParticleBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct ParticleBenchSettings {
+    uint32_t particles = 1000000;
+    uint32_t emitters = 64;
+    uint32_t frames = 240;
+    uint32_t seed = 1;
+    std::string output = "ParticleBench.json";
+};
+
+bool ParseParticleBenchArgs(const char* cmdLine, ParticleBenchSettings& settings, std::string& error);
+int RunParticleBench(const ParticleBenchSettings& settings);
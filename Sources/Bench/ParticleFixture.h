@@ -0,0 +1,65 @@
+#pragma once
+#include <cmath>
+#include <vector>
+
+#include "Bench/BenchUtil.h"
+#include "Particles/ParticleSystem.h"
+#include "Renderer/MeshStorage.h"
+#include "Renderer/StaticMeshes.h"
+
+// A grid of fountains that emit a little faster than their particles die,
+// so every emitter stays near capacity and spawns and kills each frame.
+namespace ParticleFixture {
+
+    constexpr float Spacing = 20.0f;
+    constexpr float Dt = 1.0f / 60.0f;
+
+    // Everything one run needs.
+    struct Scene {
+        MeshStorage meshes;
+        ParticleSystem system;
+        RenderQueue queue;
+        RenderView view;
+        std::vector<EmitterHandle> emitters;
+    };
+
+    // `emitters` fountains on a square grid, `perEmitter` particles each,
+    // seen from above so all of them are inside the view.
+    inline void BuildScene(Scene& s, uint32_t emitters, uint32_t perEmitter, uint32_t seed) {
+        uint32_t rng = seed ? seed : 1;
+        const MeshHandle cube = s.meshes.Add(CreateTestCube(), "cube");
+
+        const uint32_t side = uint32_t(std::ceil(std::sqrt(double(emitters))));
+        const float half = float(side) * Spacing * 0.5f;
+        for (uint32_t i = 0; i < emitters; ++i) {
+            ParticleEmitterDesc d;
+            d.position = { float(i % side) * Spacing - half, 0.0f, float(i / side) * Spacing - half };
+            d.velocity = { 0.0f, 6.0f + Bench::RandomFloat(rng) * 2.0f, 0.0f };
+            d.velocitySpread = 2.0f;
+            d.drag = 0.1f;
+            d.lifetimeMin = 1.0f;
+            d.lifetimeMax = 2.0f;
+            d.rate = float(perEmitter) / 1.5f * 1.25f; // a bit more than dies: stays near capacity
+            d.startSize = 0.05f;
+            d.endSize = 0.01f;
+            d.capacity = perEmitter;
+            d.mesh = cube;
+            d.seed = Bench::NextRandom(rng);
+            const EmitterHandle h = s.system.AddEmitter(d);
+            s.system.Burst(h, perEmitter);
+            s.emitters.push_back(h);
+        }
+
+        Camera camera;
+        camera.position = { 0.0f, half * 2.0f + 20.0f, -half * 1.5f - 10.0f };
+        camera.target = { 0.0f, 0.0f, 0.0f };
+        s.view = BuildRenderView(camera, 1280.0f, 720.0f);
+    }
+
+    inline void Frame(Scene& s) {
+        s.system.Update(Dt);
+        s.queue.Clear();
+        s.system.Submit(s.meshes, s.queue, s.view);
+    }
+
+} // namespace ParticleFixture
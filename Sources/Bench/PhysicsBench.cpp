@@ -0,0 +1,94 @@
+#include "PhysicsBench.h"
+#include "PhysicsFixture.h"
+#include "BenchUtil.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+
+#include <iterator>
+#include <vector>
+
+using namespace PhysicsFixture;
+
+bool ParsePhysicsBenchArgs(const char* cmdLine, PhysicsBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-physics");
+    options.Add("--bodies", s.bodies);
+    options.Add("--frames", s.frames);
+    options.Add("--radius", s.radius);
+    options.Add("--fill",   s.fill);
+    options.Add("--seed",   s.seed);
+    options.Add("--out",    s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.bodies == 0 || s.frames == 0 || s.radius <= 0.0f || s.fill <= 0.0f || s.fill > 0.5f) {
+        error = "--bodies, --frames and --radius must be positive, --fill in (0, 0.5]";
+        return false;
+    }
+    return true;
+}
+
+int RunPhysicsBench(const PhysicsBenchSettings& settings)
+{
+    JobSystem jobs;
+    World world;
+    PhysicsWorld physics;
+    physics.SetJobSystem(&jobs);
+    uint32_t rng = settings.seed ? settings.seed : 1;
+    FillWorld(world, physics, settings.bodies, settings.radius, settings.fill, rng);
+    const uint32_t n = physics.Size();
+
+    std::vector<double> integrateMs, pairsMs, contactsMs, solveMs, writeMs, stepMs;
+    uint64_t pairs = 0, contacts = 0, shifts = 0;
+    const float dt = 1.0f / 60.0f;
+    for (uint32_t frame = 0; frame < settings.frames; ++frame) {
+        const Clock::Ticks t0 = Clock::NowTicks();
+        physics.Integrate(dt);
+        const Clock::Ticks t1 = Clock::NowTicks();
+        physics.FindPairs();
+        const Clock::Ticks t2 = Clock::NowTicks();
+        physics.FindContacts();
+        const Clock::Ticks t3 = Clock::NowTicks();
+        physics.SolveContacts();
+        const Clock::Ticks t4 = Clock::NowTicks();
+        physics.WriteTransforms(world);
+        const Clock::Ticks t5 = Clock::NowTicks();
+
+        integrateMs.push_back(Clock::ToMilliseconds(t1 - t0));
+        pairsMs.push_back(Clock::ToMilliseconds(t2 - t1));
+        contactsMs.push_back(Clock::ToMilliseconds(t3 - t2));
+        solveMs.push_back(Clock::ToMilliseconds(t4 - t3));
+        writeMs.push_back(Clock::ToMilliseconds(t5 - t4));
+        stepMs.push_back(Clock::ToMilliseconds(t5 - t0));
+
+        const PhysicsStats& stats = physics.GetStats();
+        pairs += stats.pairs;
+        contacts += stats.contacts;
+        shifts += stats.sortShifts;
+    }
+
+    // ---- JSON ----
+    const PhysicsStats& stats = physics.GetStats();
+    std::string json = "{\n  \"benchmark\": \"physics\",\n";
+    Bench::Append(json, "  \"config\": { \"bodies\": %u, \"frames\": %u, \"radius\": %.3f, \"fill\": %.3f, \"workers\": %u, \"seed\": %u },\n",
+        n, settings.frames, settings.radius, settings.fill, jobs.WorkerCount(), settings.seed);
+
+    json += "  \"per_frame\": {\n";
+    struct Row { const char* name; std::vector<double>* ms; };
+    const Row rows[] = {
+        { "integrate", &integrateMs }, { "broadphase", &pairsMs }, { "narrowphase", &contactsMs },
+        { "solve", &solveMs }, { "write_transforms", &writeMs }, { "step", &stepMs }
+    };
+    for (size_t i = 0; i < std::size(rows); ++i) {
+        const FrameTimeSummary s = SummarizeTimes(*rows[i].ms);
+        Bench::Append(json, "    \"%s\": { \"mean_ms\": %.4f, \"p99_ms\": %.4f, \"bodies_per_ms\": %.0f }%s\n",
+            rows[i].name, s.averageMs, s.p99Ms, s.averageMs > 0.0 ? double(n) / s.averageMs : 0.0,
+            i + 1 < std::size(rows) ? "," : "");
+    }
+    json += "  },\n";
+
+    const double frames = double(settings.frames);
+    Bench::Append(json, "  \"pairs_per_frame\": %.0f,\n  \"contacts_per_frame\": %.0f,\n  \"sort_shifts_per_frame\": %.0f,\n  \"full_sorts\": %llu\n}\n",
+        double(pairs) / frames, double(contacts) / frames, double(shifts) / frames, static_cast<unsigned long long>(stats.fullSorts));
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
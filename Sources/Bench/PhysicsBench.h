@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * PhysicsBench
+ * `bodies` spheres fall and bounce in a closed box (the PhysicsWorld
+ * bounds), a fixed 60 Hz step per frame. Reports each stage of the step
+ * (integrate, broadphase, narrowphase, solve, writing the Transforms) and
+ * the throughput in bodies per millisecond.
+ *
+ * The world is Bench/PhysicsFixture.h; Tests/PhysicsTests.cpp checks the
+ * SIMD integrator, the broadphase pairs and the parallel narrowphase on a
+ * small one.
+ *
+ *     Dreivy.exe --bench-physics --bodies=100000 --frames=120 --out=PhysicsBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct PhysicsBenchSettings {
+    uint32_t bodies = 100000;
+    uint32_t frames = 120;
+    float radius = 0.5f;
+    float fill = 0.1f;   // part of the box volume taken by the spheres
+    uint32_t seed = 1;
+    std::string output = "PhysicsBench.json";
+};
+
+bool ParsePhysicsBenchArgs(const char* cmdLine, PhysicsBenchSettings& settings, std::string& error);
+int RunPhysicsBench(const PhysicsBenchSettings& settings);
@@ -0,0 +1,49 @@
+#pragma once
+#include <cmath>
+#include <vector>
+
+#include "Bench/BenchUtil.h"
+#include "Physics/PhysicsWorld.h"
+#include "World/ECS/Component/Transform.h"
+
+// Spheres of mixed size thrown around a closed box, one in twenty static, so
+// the broadphase sees moving-moving and moving-static pairs.
+namespace PhysicsFixture {
+
+    using Pair = PhysicsWorld::Pair;
+
+    // Random spheres in a box sized so they fill `fill` of it; every 20th is static.
+    // `descs` (optional) gets what each entity's body was made from.
+    inline void FillWorld(World& world, PhysicsWorld& physics, uint32_t count, float radius, float fill, uint32_t& rng,
+                          std::vector<RigidBodyDesc>* descs = nullptr) {
+        const float volume = float(count) * 4.18879f * radius * radius * radius / fill;
+        const float half = std::cbrt(volume) * 0.5f;
+
+        PhysicsSettings s = physics.GetSettings();
+        s.bounds = true;
+        s.boundsMin = { -half, 0.0f, -half };
+        s.boundsMax = { half, 2.0f * half, half };
+        physics.SetSettings(s);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            Entity e = world.CreateEntity();
+            Transform t;
+            t.position = { (Bench::RandomFloat(rng) * 2.0f - 1.0f) * (half - radius),
+                           radius + Bench::RandomFloat(rng) * (2.0f * half - 2.0f * radius),
+                           (Bench::RandomFloat(rng) * 2.0f - 1.0f) * (half - radius) };
+            world.AddComponent<Transform>(e, t);
+
+            RigidBodyDesc desc;
+            desc.radius = radius * (0.75f + Bench::RandomFloat(rng) * 0.5f);
+            desc.mass = i % 20 == 0 ? 0.0f : 0.5f + Bench::RandomFloat(rng);
+            desc.velocity = { Bench::RandomFloat(rng) * 4.0f - 2.0f, Bench::RandomFloat(rng) * 4.0f - 2.0f,
+                              Bench::RandomFloat(rng) * 4.0f - 2.0f };
+            physics.AddBody(e, t.position, desc);
+            if (descs) {
+                descs->resize(size_t(e) + 1);
+                (*descs)[e] = desc;
+            }
+        }
+    }
+
+} // namespace PhysicsFixture
@@ -0,0 +1,94 @@
+#include "QueryBench.h"
+#include "QueryFixture.h"
+#include "BenchUtil.h"
+#include "Math/SimdMath.h"
+
+#include <vector>
+
+using namespace QueryFixture;
+
+bool ParseQueryBenchArgs(const char* cmdLine, QueryBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-query");
+    options.Add("--entities",   s.entities);
+    options.Add("--iterations", s.iterations);
+    options.Add("--seed",       s.seed);
+    options.Add("--out",        s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.entities == 0 || s.iterations == 0) {
+        error = "--entities and --iterations must be positive";
+        return false;
+    }
+    return true;
+}
+
+int RunQueryBench(const QueryBenchSettings& settings)
+{
+    uint32_t rng = settings.seed ? settings.seed : 1;
+    World world;
+    HashWorld hash;
+    Populate(world, hash, settings.entities, rng);
+
+    const EcsVector<ComponentMask>& signatures = world.Signatures();
+    const size_t n = settings.entities;
+    const double perEntity = 1e6 / double(n); // ms per query -> ns per entity
+    EcsVector<Entity> found;
+    std::vector<uint32_t> scalarOut(n);
+    std::vector<Entity> hashOut;
+    hashOut.reserve(n);
+    uint64_t checksum = 0;
+
+    struct Row { QuerySpec spec; size_t matches; FrameTimeSummary simd; FrameTimeSummary scalar; FrameTimeSummary hash; };
+    std::vector<Row> rows;
+    for (const QuerySpec& q : Queries()) {
+        Row r{ q, 0, {}, {}, {} };
+        r.simd = Bench::Time(settings.iterations, [&] { checksum += world.Query(q.query, found); });
+        r.matches = found.size();
+        size_t scalarFound = 0;
+        r.scalar = Bench::Time(settings.iterations, [&] {
+            scalarFound = Simd::Scalar::MatchMasks(signatures.data() + 1, n, q.query.all, q.query.none, 1, scalarOut.data());
+            checksum += scalarFound;
+        });
+        r.hash = Bench::Time(settings.iterations, [&] {
+            hashOut.clear();
+            for (Entity e = 1; e <= n; ++e)
+                if (HashMatches(hash, e, q))
+                    hashOut.push_back(e);
+            checksum += hashOut.size();
+        });
+        rows.push_back(r);
+    }
+
+    // What each way keeps for the three tags.
+    size_t hashBytes = 0;
+    for (int k = KindStatic; k <= KindSelected; ++k) {
+        const auto& map = hash.byKind[k];
+        // A node (next pointer, key, value, cached hash) plus a bucket pointer each.
+        hashBytes += map.size() * (sizeof(void*) + sizeof(Entity) + sizeof(char) + sizeof(size_t)) +
+                     map.bucket_count() * sizeof(void*);
+    }
+    const size_t signatureBytes = signatures.size() * sizeof(ComponentMask);
+
+    // ---- JSON ----
+    std::string json = "{\n  \"benchmark\": \"query\",\n";
+    Bench::Append(json, "  \"config\": { \"backend\": \"%s\", \"entities\": %u, \"iterations\": %u, \"seed\": %u },\n",
+        Simd::BackendName(), settings.entities, settings.iterations, settings.seed);
+    json += "  \"queries\": {\n";
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const Row& r = rows[i];
+        Bench::Append(json, "    \"%s\": { \"matches\": %zu, \"mean_ms\": %.4f, \"p99_ms\": %.4f, \"ns_per_entity\": %.3f, "
+                            "\"scalar_ns_per_entity\": %.3f, \"hash_ns_per_entity\": %.3f, \"speedup_vs_scalar\": %.2f, \"speedup_vs_hash\": %.2f }%s\n",
+            r.spec.name, r.matches, r.simd.averageMs, r.simd.p99Ms, r.simd.averageMs * perEntity,
+            r.scalar.averageMs * perEntity, r.hash.averageMs * perEntity,
+            r.simd.averageMs > 0.0 ? r.scalar.averageMs / r.simd.averageMs : 0.0,
+            r.simd.averageMs > 0.0 ? r.hash.averageMs / r.simd.averageMs : 0.0,
+            i + 1 < rows.size() ? "," : "");
+    }
+    json += "  },\n";
+    Bench::Append(json, "  \"memory\": { \"signature_bytes\": %zu, \"tag_pool_bytes\": 0, \"hash_tag_bytes_estimate\": %zu },\n",
+        signatureBytes, hashBytes);
+    Bench::Append(json, "  \"checksum\": %llu\n}\n", (unsigned long long)checksum);
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
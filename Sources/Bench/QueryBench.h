@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * QueryBench
+ * `entities` entities with random tags (Static, Hidden, Selected: empty
+ * structs, so only bits in their signatures) and a data component, queried
+ * `iterations` times per query. Each query is timed three ways: the SIMD
+ * sweep World::Query does, the same sweep on the scalar kernel, and one
+ * hash lookup per entity and component in std::unordered_maps, which is
+ * what looking tags up by entity cost without signatures.
+ *
+ * The entities are Bench/QueryFixture.h; Tests/QueryTests.cpp checks that
+ * Query, HasComponent and the hash maps agree after random changes and a
+ * merge, and the selected MatchMasks backend against the scalar one.
+ *
+ *     Dreivy.exe --bench-query --entities=1000000 --iterations=50 --out=QueryBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct QueryBenchSettings {
+    uint32_t entities = 1000000;
+    uint32_t iterations = 50;   // runs per query and way
+    uint32_t seed = 1;
+    std::string output = "QueryBench.json";
+};
+
+bool ParseQueryBenchArgs(const char* cmdLine, QueryBenchSettings& settings, std::string& error);
+int RunQueryBench(const QueryBenchSettings& settings);
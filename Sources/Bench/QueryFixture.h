@@ -0,0 +1,85 @@
+#pragma once
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "Bench/BenchUtil.h"
+#include "World/ECS/World.h"
+
+// Three tags and one data component in random mixes, plus the same data as
+// one hash map per type to compare the signature queries with.
+namespace QueryFixture {
+
+    struct Static {};
+    struct Hidden {};
+    struct Selected {};
+    struct Velocity { float x = 0.0f, y = 0.0f, z = 0.0f; };
+
+    static_assert(IsTagComponent<Static> && !IsTagComponent<Velocity>);
+
+    // The four components by index, for code that picks one at random.
+    enum Kind { KindStatic, KindHidden, KindSelected, KindVelocity, KindCount };
+
+    template<typename F>
+    void WithKind(int kind, F&& f) {
+        switch (kind) {
+        case KindStatic:   f(Static{});   break;
+        case KindHidden:   f(Hidden{});   break;
+        case KindSelected: f(Selected{}); break;
+        default:           f(Velocity{}); break;
+        }
+    }
+
+    // The same components kept the way a lookup by entity needs without
+    // signatures: one hash map per type.
+    struct HashWorld {
+        std::unordered_map<Entity, char> byKind[KindCount];
+
+        bool Has(Entity e, int kind) const { return byKind[kind].count(e) != 0; }
+    };
+
+    struct QuerySpec {
+        const char* name;
+        ComponentQuery query;
+        uint32_t with;     // 1 << Kind
+        uint32_t without;
+    };
+
+    inline std::vector<QuerySpec> Queries() {
+        return {
+            { "static_visible",  ComponentQuery().With<Static>().Without<Hidden>(),  1u << KindStatic, 1u << KindHidden },
+            { "selected_moving", ComponentQuery().With<Selected, Velocity>(),         1u << KindSelected | 1u << KindVelocity, 0 },
+            { "dynamic_visible", ComponentQuery().With<Velocity>().Without<Static, Hidden>(), 1u << KindVelocity, 1u << KindStatic | 1u << KindHidden },
+        };
+    }
+
+    inline bool HashMatches(const HashWorld& hash, Entity e, const QuerySpec& q) {
+        for (int k = 0; k < KindCount; ++k) {
+            const uint32_t bit = 1u << k;
+            if ((q.with & bit) && !hash.Has(e, k))
+                return false;
+            if ((q.without & bit) && hash.Has(e, k))
+                return false;
+        }
+        return true;
+    }
+
+    // How often each kind is added: most of a level is static, a few
+    // things are hidden, very few selected.
+    constexpr uint32_t KindPercent[KindCount] = { 60, 10, 2, 30 };
+
+    inline void Populate(World& world, HashWorld& hash, uint32_t count, uint32_t& rng) {
+        const Entity first = world.CreateEntities(count);
+        for (Entity e = first; e < first + count; ++e)
+            for (int k = 0; k < KindCount; ++k)
+                if (Bench::NextRandom(rng) % 100 < KindPercent[k]) {
+                    WithKind(k, [&](auto c) {
+                        if constexpr (std::is_same_v<decltype(c), Velocity>)
+                            c.x = float(e);
+                        world.AddComponent(e, c);
+                    });
+                    hash.byKind[k].emplace(e, 0);
+                }
+    }
+
+} // namespace QueryFixture
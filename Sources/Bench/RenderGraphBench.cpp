@@ -0,0 +1,115 @@
+#include "RenderGraphBench.h"
+#include "RenderGraphFixture.h"
+#include "BenchUtil.h"
+#include "Memory/AllocTracker.h"
+#include "Timing/Clock.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace RenderGraphFixture;
+
+namespace {
+
+    bool WriteText(const std::string& path, const std::string& text) {
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f)
+            return false;
+        std::fwrite(text.data(), 1, text.size(), f);
+        std::fclose(f);
+        return true;
+    }
+
+} // namespace
+
+bool ParseRenderGraphBenchArgs(const char* cmdLine, RenderGraphBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-graph");
+    options.Add("--width",  s.width);
+    options.Add("--height", s.height);
+    options.Add("--frames", s.frames);
+    options.Add("--graphs", s.graphs);
+    options.Add("--seed",   s.seed);
+    options.Add("--dump",   s.dump);
+    options.Add("--out",    s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.width < 32 || s.height < 32 || s.frames == 0) {
+        error = "--width and --height must be at least 32, --frames positive";
+        return false;
+    }
+    return true;
+}
+
+int RunRenderGraphBench(const RenderGraphBenchSettings& settings)
+{
+    RenderGraph graph;
+    RecordingTarget target;
+
+    // What culling and aliasing do on random graphs (RenderGraphTests
+    // checks them against the rules; here they are only counted).
+    uint32_t rng = settings.seed ? settings.seed : 1;
+    uint64_t randomPasses = 0, randomCulled = 0, randomTransient = 0, randomPhysical = 0;
+    for (uint32_t i = 0; i < settings.graphs; ++i) {
+        target.Clear();
+        BuildRandomGraph(graph, rng, target);
+        if (!graph.Compile())
+            continue;
+        randomPasses += graph.GetStats().passes;
+        randomCulled += graph.GetStats().culled;
+        randomTransient += graph.GetStats().transientBytes;
+        randomPhysical += graph.GetStats().physicalBytes;
+    }
+
+    // Timing: the whole frame graph, built, compiled and run every frame.
+    std::vector<double> buildMs, compileMs, executeMs;
+    buildMs.reserve(settings.frames);
+    compileMs.reserve(settings.frames);
+    executeMs.reserve(settings.frames);
+    uint64_t allocs = 0;
+    {
+        AllocScope scope(AllocTag::Render);
+        uint64_t allocsBefore = 0;
+        for (uint32_t f = 0; f < settings.frames + 4; ++f) {
+            if (f == 4)
+                allocsBefore = AllocTracker::GetStats(AllocTag::Render).totalCount;
+            target.Clear();
+            const Clock::Ticks start = Clock::NowTicks();
+            BuildReferenceFrame(graph, settings.width, settings.height, target);
+            const double build = Clock::ToMilliseconds(Clock::NowTicks() - start);
+            graph.Compile();
+            graph.Execute(target);
+            if (f < 4)
+                continue;
+            buildMs.push_back(build);
+            compileMs.push_back(graph.GetStats().compileMs);
+            executeMs.push_back(graph.GetStats().executeMs);
+        }
+        allocs = AllocTracker::GetStats(AllocTag::Render).totalCount - allocsBefore;
+    }
+
+    const RenderGraphStats st = graph.GetStats();
+    if (!settings.dump.empty() && !WriteText(settings.dump, graph.Dump()))
+        std::fprintf(stderr, "can't write %s\n", settings.dump.c_str());
+
+    const FrameTimeSummary build = SummarizeTimes(buildMs);
+    const FrameTimeSummary compile = SummarizeTimes(compileMs);
+    const FrameTimeSummary execute = SummarizeTimes(executeMs);
+    const double mb = 1.0 / (1024.0 * 1024.0);
+
+    std::string json = "{\n  \"benchmark\": \"render_graph\",\n";
+    Bench::Append(json, "  \"config\": { \"width\": %u, \"height\": %u, \"frames\": %u, \"graphs\": %u, \"seed\": %u },\n",
+        settings.width, settings.height, settings.frames, settings.graphs, settings.seed);
+    Bench::Append(json, "  \"frame\": { \"passes\": %u, \"culled\": %u, \"barriers\": %u, \"transients\": %u, \"physical\": %u, \"transient_mb\": %.2f, \"physical_mb\": %.2f, \"saved_percent\": %.1f },\n",
+        st.passes, st.culled, st.barriers, st.transients, st.physical, double(st.transientBytes) * mb, double(st.physicalBytes) * mb,
+        st.transientBytes ? 100.0 * double(st.transientBytes - st.physicalBytes) / double(st.transientBytes) : 0.0);
+    Bench::Append(json, "  \"ms\": { \"build\": %.4f, \"compile\": %.4f, \"compile_p99\": %.4f, \"execute\": %.4f },\n",
+        build.averageMs, compile.averageMs, compile.p99Ms, execute.averageMs);
+    Bench::Append(json, "  \"random\": { \"graphs\": %u, \"passes\": %llu, \"culled\": %llu, \"saved_percent\": %.1f },\n",
+        settings.graphs, (unsigned long long)randomPasses, (unsigned long long)randomCulled,
+        randomTransient ? 100.0 * double(randomTransient - randomPhysical) / double(randomTransient) : 0.0);
+    Bench::Append(json, "  \"allocations\": %llu,\n  \"alloc_tracking\": %s\n}\n", (unsigned long long)allocs, AllocTracker::Enabled ? "true" : "false");
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * RenderGraphBench
+ * Compiles a full deferred frame at `width` x `height` through RenderGraph
+ * (shadow cascades, depth prepass, G-buffer, light culling, SSAO, lighting,
+ * a bloom chain, tonemapping, FXAA, a readback, and two passes nobody
+ * reads) `frames` times, with a backend that does nothing, and reports
+ * what compiling and running the graph costs, how many passes were culled,
+ * how many barriers it placed and how much memory aliasing saved. The
+ * graph of the last frame is written to `dump` as RenderGraph::Dump(), and
+ * `graphs` random graphs show what culling and aliasing save on average.
+ *
+ * The graphs are Bench/RenderGraphFixture.h; Tests/RenderGraphTests.cpp
+ * checks them against the rules, worked out again separately.
+ *
+ *     Dreivy.exe --bench-graph --width=1920 --height=1080 --frames=2000 --out=RenderGraphBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct RenderGraphBenchSettings {
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t frames = 2000;
+    uint32_t graphs = 500;      // random graphs compiled
+    uint32_t seed = 1;
+    std::string dump = "RenderGraph.txt";
+    std::string output = "RenderGraphBench.json";
+};
+
+bool ParseRenderGraphBenchArgs(const char* cmdLine, RenderGraphBenchSettings& settings, std::string& error);
+int RunRenderGraphBench(const RenderGraphBenchSettings& settings);
@@ -0,0 +1,185 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "Bench/BenchUtil.h"
+#include "Renderer/RenderGraph.h"
+
+// A deferred frame and random valid graphs, with a target that records what
+// the graph asked of it instead of touching a device.
+namespace RenderGraphFixture {
+
+    // DXGI values, though any numbers would do for the graph.
+    constexpr uint32_t RGBA8 = 28;
+    constexpr uint32_t RGBA16F = 10;
+    constexpr uint32_t R8 = 61;
+    constexpr uint32_t D32 = 40;
+
+    // A backend that only writes down what the graph asked of it.
+    class RecordingTarget : public IRenderGraphTarget {
+    public:
+        struct FirstUse {
+            uint32_t pass;
+            GraphResource resource;
+            bool first;
+        };
+
+        std::vector<GraphResourceDesc> prepared;
+        std::vector<GraphBarrier> barriers;
+        std::vector<uint32_t> passes;     // in the order they ran
+        std::vector<FirstUse> firstUses;  // what RenderPassContext::FirstUse said
+
+        void Clear() {
+            prepared.clear();
+            barriers.clear();
+            passes.clear();
+            firstUses.clear();
+        }
+
+        bool PreparePhysical(uint32_t index, const GraphResourceDesc& desc) override {
+            if (prepared.size() <= index)
+                prepared.resize(size_t(index) + 1);
+            prepared[index] = desc;
+            return true;
+        }
+
+        void Barrier(const GraphBarrier& barrier, uint32_t) override {
+            barriers.push_back(barrier);
+        }
+
+        // What every pass of the bench runs.
+        void Run(const RenderPassContext& ctx) {
+            passes.push_back(ctx.pass);
+            const RenderGraph::Pass& p = ctx.graph.GetPasses()[ctx.pass];
+            for (uint32_t u = p.firstUse; u < p.firstUse + p.useCount; ++u) {
+                const GraphResource r = ctx.graph.GetUses()[u].resource;
+                firstUses.push_back({ ctx.pass, r, ctx.FirstUse(r) });
+            }
+        }
+    };
+
+    inline RenderGraph::ExecuteFn Record(RecordingTarget& target) {
+        return [&target](const RenderPassContext& ctx) { target.Run(ctx); };
+    }
+
+    inline GraphResourceDesc Tex(uint32_t w, uint32_t h, uint32_t format) {
+        const uint32_t bpp = format == RGBA16F ? 8 : format == R8 ? 1 : 4;
+        return GraphResourceDesc::Texture(std::max(w, 1u), std::max(h, 1u), format, bpp);
+    }
+
+    const char* const BloomDown[] = { "BloomDown0", "BloomDown1", "BloomDown2", "BloomDown3", "BloomDown4" };
+    const char* const BloomUp[] = { "BloomUp0", "BloomUp1", "BloomUp2", "BloomUp3" };
+    const char* const Shadow[] = { "Shadow0", "Shadow1", "Shadow2", "Shadow3" };
+
+    // A deferred frame. SSR and DebugHeatmap write what nobody reads.
+    inline void BuildReferenceFrame(RenderGraph& g, uint32_t w, uint32_t h, RecordingTarget& t) {
+        using S = ResourceState;
+        g.Reset();
+        const GraphResource backBuffer = g.Import("BackBuffer", Tex(w, h, RGBA8), S::Present, S::Present);
+
+        GraphResource shadows[4];
+        for (int i = 0; i < 4; ++i) {
+            shadows[i] = g.CreateTexture(Shadow[i], Tex(2048, 2048, D32));
+            g.AddPass(Shadow[i], Record(t)).Write(shadows[i], S::DepthWrite);
+        }
+
+        const GraphResource depth = g.CreateTexture("Depth", Tex(w, h, D32));
+        const GraphResource albedo = g.CreateTexture("Albedo", Tex(w, h, RGBA8));
+        const GraphResource normals = g.CreateTexture("Normals", Tex(w, h, RGBA8));
+        const GraphResource lights = g.CreateBuffer("LightList", uint64_t(w / 16 + 1) * (h / 16 + 1) * 256 * 4);
+        const GraphResource ao = g.CreateTexture("AO", Tex(w, h, R8));
+        const GraphResource aoTemp = g.CreateTexture("AOTemp", Tex(w, h, R8));
+        const GraphResource aoBlur = g.CreateTexture("AOBlur", Tex(w, h, R8));
+        const GraphResource hdr = g.CreateTexture("HDR", Tex(w, h, RGBA16F));
+        const GraphResource reflections = g.CreateTexture("Reflections", Tex(w, h, RGBA16F));
+        const GraphResource histogram = g.CreateBuffer("Histogram", 256 * 4);
+        const GraphResource ldr = g.CreateTexture("LDR", Tex(w, h, RGBA8));
+        const GraphResource heatmap = g.CreateTexture("Heatmap", Tex(w, h, RGBA8));
+
+        g.AddPass("DepthPrepass", Record(t)).Write(depth, S::DepthWrite);
+        g.AddPass("GBuffer", Record(t)).Write(depth, S::DepthWrite).Write(albedo).Write(normals);
+        g.AddPass("LightCulling", Record(t)).Read(depth).Write(lights, S::UnorderedAccess);
+        g.AddPass("SSAO", Record(t)).Read(depth).Read(normals).Write(ao);
+        g.AddPass("SSAOBlurH", Record(t)).Read(ao).Write(aoTemp);
+        g.AddPass("SSAOBlurV", Record(t)).Read(aoTemp).Write(aoBlur);
+        {
+            auto lighting = g.AddPass("Lighting", Record(t));
+            lighting.Read(albedo).Read(normals).Read(aoBlur).Read(depth).Read(lights).Write(hdr);
+            for (GraphResource s : shadows)
+                lighting.Read(s);
+        }
+        g.AddPass("SSR", Record(t)).Read(hdr).Read(depth).Write(reflections);
+
+        GraphResource down[5];
+        GraphResource source = hdr;
+        for (uint32_t i = 0; i < 5; ++i) {
+            down[i] = g.CreateTexture(BloomDown[i], Tex(w >> (i + 1), h >> (i + 1), RGBA16F));
+            g.AddPass(BloomDown[i], Record(t)).Read(source).Write(down[i]);
+            source = down[i];
+        }
+        for (uint32_t i = 4; i-- > 0;) {
+            const GraphResource up = g.CreateTexture(BloomUp[i], Tex(w >> (i + 1), h >> (i + 1), RGBA16F));
+            g.AddPass(BloomUp[i], Record(t)).Read(down[i]).Read(source).Write(up);
+            source = up;
+        }
+
+        g.AddPass("Histogram", Record(t)).Read(hdr).Write(histogram, S::UnorderedAccess);
+        g.AddPass("Tonemap", Record(t)).Read(hdr).Read(source).Read(histogram).Write(ldr);
+        g.AddPass("FXAA", Record(t)).Read(ldr).Write(backBuffer);
+        g.AddPass("DebugHeatmap", Record(t)).Read(depth).Write(heatmap);
+        g.AddPass("LuminanceReadback", Record(t)).Read(down[4], S::CopySource).SideEffect();
+    }
+
+    // Random passes over random resources; every read is of something an
+    // earlier pass wrote (or an import), so the graph is valid.
+    inline void BuildRandomGraph(RenderGraph& g, uint32_t& rng, RecordingTarget& t) {
+        using S = ResourceState;
+        static const ResourceState ReadStates[] = { S::ShaderRead, S::DepthRead, S::CopySource };
+        static const ResourceState WriteStates[] = { S::RenderTarget, S::DepthWrite, S::UnorderedAccess, S::CopyDest };
+        static const GraphResourceDesc Descs[] = { Tex(512, 512, RGBA8), Tex(512, 512, RGBA16F), Tex(256, 256, R8) };
+        static const char* const Names[] = { "R0", "R1", "R2", "R3", "R4", "R5", "R6", "R7", "R8", "R9",
+            "R10", "R11", "R12", "R13", "R14", "R15", "R16", "R17", "R18", "R19" };
+
+        g.Reset();
+        const uint32_t resources = 4 + Bench::NextRandom(rng) % 17;
+        const uint32_t imports = 1 + Bench::NextRandom(rng) % 2;
+        for (uint32_t r = 0; r < resources; ++r) {
+            if (r < imports)
+                g.Import(Names[r], Descs[0], S::Present, Bench::NextRandom(rng) % 2 ? S::Present : S::ShaderRead);
+            else if (Bench::NextRandom(rng) % 4 == 0)
+                g.CreateBuffer(Names[r], 1024 * (1 + Bench::NextRandom(rng) % 64));
+            else
+                g.CreateTexture(Names[r], Descs[Bench::NextRandom(rng) % 3]);
+        }
+
+        std::vector<uint8_t> written(resources, 0);
+        for (uint32_t r = 0; r < imports; ++r)
+            written[r] = 1;
+        const uint32_t passCount = 2 + Bench::NextRandom(rng) % 24;
+        std::vector<GraphResource> picked;
+        for (uint32_t i = 0; i < passCount; ++i) {
+            auto pass = g.AddPass("Pass", Record(t));
+            picked.clear();
+            const uint32_t reads = Bench::NextRandom(rng) % 4;
+            for (uint32_t k = 0; k < reads; ++k) {
+                const GraphResource r = 1 + Bench::NextRandom(rng) % resources;
+                if (!written[r - 1] || std::find(picked.begin(), picked.end(), r) != picked.end())
+                    continue;
+                picked.push_back(r);
+                pass.Read(r, ReadStates[Bench::NextRandom(rng) % 3]);
+            }
+            const uint32_t writes = 1 + Bench::NextRandom(rng) % 2;
+            for (uint32_t k = 0; k < writes; ++k) {
+                const GraphResource r = 1 + Bench::NextRandom(rng) % resources;
+                if (std::find(picked.begin(), picked.end(), r) != picked.end())
+                    continue;
+                picked.push_back(r);
+                pass.Write(r, WriteStates[Bench::NextRandom(rng) % 4]);
+                written[r - 1] = 1;
+            }
+            if (Bench::NextRandom(rng) % 10 == 0)
+                pass.SideEffect();
+        }
+    }
+
+} // namespace RenderGraphFixture
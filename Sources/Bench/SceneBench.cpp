@@ -0,0 +1,254 @@
+#include "SceneBench.h"
+#include "BenchUtil.h"
+#include "Core.h"
+#include "Renderer/StaticMeshes.h"
+#include "World/ECS/Component/Mesh.h"
+#include "World/ECS/Component/Transform.h"
+#include "Math/Time.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+    // The entities moved every update, with what they need to move.
+    struct MovingEntity {
+        Entity entity;
+        float baseY;
+        float phase;
+    };
+
+    struct BenchScene {
+        std::vector<MovingEntity> moving;
+    };
+
+    void BuildScene(Core& core, const SceneBenchSettings& settings, BenchScene& scene) {
+        World& world = *core.getWorld();
+        MeshStorage& meshes = *core.getMeshStorage();
+
+        // Spheres from ~100 to ~2000 triangles, so LOD selection has something to do.
+        std::vector<MeshHandle> handles;
+        for (uint32_t i = 0; i < settings.meshes; ++i) {
+            const uint32_t detail = i % 8;
+            handles.push_back(meshes.Add(CreateTestSphere(8 + detail * 4, 6 + detail * 3), "BenchSphere" + std::to_string(i)));
+        }
+
+        // A square grid in the XZ plane, the camera looks at it from above one edge:
+        // near objects are big, far ones small or culled.
+        const uint32_t side = uint32_t(std::ceil(std::sqrt(double(settings.entities))));
+        const float spacing = 3.0f;
+        const float half = float(side) * spacing * 0.5f;
+
+        uint32_t rng = settings.seed ? settings.seed : 1;
+        scene.moving.reserve(size_t(double(settings.entities) * settings.moving) + 1);
+        for (uint32_t i = 0; i < settings.entities; ++i) {
+            Entity e = world.CreateEntity();
+            world.AddComponent<Transform>(e);
+            world.AddComponent<Mesh>(e);
+
+            Transform& t = world.GetComponent<Transform>(e);
+            t.position = { float(i % side) * spacing - half, 0.0f, float(i / side) * spacing - half };
+            t.rotation = { 0.0f, float(Bench::NextRandom(rng) % 628) * 0.01f, 0.0f };
+            world.GetComponent<Mesh>(e).handle = handles.empty() ? InvalidMesh : handles[Bench::NextRandom(rng) % handles.size()];
+
+            if (float(Bench::NextRandom(rng) % 10000) < settings.moving * 10000.0f)
+                scene.moving.push_back({ e, t.position.y, float(Bench::NextRandom(rng) % 628) * 0.01f });
+        }
+
+        Camera& camera = core.getCamera();
+        camera.position = { 0.0f, half * 0.5f + 10.0f, -half - 10.0f };
+        camera.target = { 0.0f, 0.0f, 0.0f };
+    }
+
+    void MoveEntities(Core& core, BenchScene& scene) {
+        World& world = *core.getWorld();
+        const float time = float(Time::time);
+        const float dt = Time::deltaTime;
+        for (const MovingEntity& m : scene.moving) {
+            Transform& t = world.GetComponent<Transform>(m.entity);
+            t.position.y = m.baseY + std::sin(time * 2.0f + m.phase);
+            t.rotation.y += dt;
+        }
+    }
+
+    // ---- baseline file: a result JSON written by an earlier run ----
+
+    bool ReadFile(const std::string& path, std::string& out) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        char buffer[4096];
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), f)) > 0)
+            out.append(buffer, n);
+        std::fclose(f);
+        return true;
+    }
+
+    // Finds `"key": <number>` after `from`. Good enough for the files we write
+    // ourselves, not a general JSON reader.
+    bool FindNumber(const std::string& json, size_t from, const char* key, double& value, size_t* at = nullptr) {
+        const std::string quoted = std::string("\"") + key + "\"";
+        size_t pos = json.find(quoted, from);
+        if (pos == std::string::npos) return false;
+        pos = json.find(':', pos + quoted.size());
+        if (pos == std::string::npos) return false;
+        char* end = nullptr;
+        value = std::strtod(json.c_str() + pos + 1, &end);
+        if (end == json.c_str() + pos + 1) return false;
+        if (at) *at = pos;
+        return true;
+    }
+
+    bool FindStage(const std::string& json, const char* stage, double& meanMs, double& p99Ms) {
+        const size_t stages = json.find("\"stages\"");
+        if (stages == std::string::npos) return false;
+        const size_t pos = json.find(std::string("\"") + stage + "\"", stages);
+        if (pos == std::string::npos) return false;
+        return FindNumber(json, pos, "mean_ms", meanMs) && FindNumber(json, pos, "p99_ms", p99Ms);
+    }
+
+    // A baseline that can't be compared against is an error, not a pass: a
+    // wrong path or a file from another scene must not turn the check green.
+    bool LoadBaseline(const SceneBenchSettings& settings, std::string& baseline, std::string& error) {
+        if (!ReadFile(settings.baseline, baseline)) {
+            error = "can't read baseline " + settings.baseline;
+            return false;
+        }
+        double entities = 0.0;
+        if (!FindNumber(baseline, 0, "entities", entities)) {
+            error = "baseline " + settings.baseline + " has no entity count";
+            return false;
+        }
+        if (entities != double(settings.entities)) {
+            error = "baseline was measured with " + std::to_string(uint64_t(entities)) +
+                " entities, this run has " + std::to_string(settings.entities);
+            return false;
+        }
+        for (size_t i = 0; i < size_t(FrameStage::Count); ++i) {
+            double meanMs = 0.0, p99Ms = 0.0;
+            if (!FindStage(baseline, StageTimes::Name(FrameStage(i)), meanMs, p99Ms)) {
+                error = std::string("baseline has no stage ") + StageTimes::Name(FrameStage(i));
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace
+
+bool ParseSceneBenchArgs(const char* cmdLine, SceneBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench");
+    options.Add("--fixed",    s.fixedTimestep);
+    options.Add("--entities", s.entities);
+    options.Add("--meshes",   s.meshes);
+    options.Add("--moving",   s.moving);
+    options.Add("--warmup",   s.warmup);
+    options.Add("--frames",   s.frames);
+    options.Add("--seed",     s.seed);
+    options.Add("--out",      s.output);
+    options.Add("--baseline", s.baseline);
+    options.Add("--margin",   s.margin);
+    options.Add("--slack-ms", s.slackMs);
+    if (!options.Parse(cmdLine, error)) return false;
+
+    if (s.frames == 0 || s.meshes == 0) {
+        error = "--frames and --meshes must be at least 1";
+        return false;
+    }
+    if (s.moving < 0.0f || s.moving > 1.0f) {
+        error = "--moving is a share between 0 and 1";
+        return false;
+    }
+    return true;
+}
+
+int RunSceneBench(const SceneBenchSettings& settings)
+{
+    // Checked before the run: no point measuring what can't be compared.
+    std::string baseline, error;
+    const bool haveBaseline = !settings.baseline.empty();
+    if (haveBaseline && !LoadBaseline(settings, baseline, error)) {
+        std::fprintf(stderr, "SceneBench: %s\n", error.c_str());
+        return 2;
+    }
+
+    BenchScene scene;
+
+    LoopSettings loop;
+    loop.fixedTimestep = settings.fixedTimestep;
+    loop.timestep.ticksPerSecond = 60.0;
+    loop.maxFps = 0.0; // as fast as possible
+
+    Core core;
+    core.setHeadless(true)
+        .setLoopSettings(loop)
+        .setFrameLimit(uint64_t(settings.warmup) + settings.frames)
+        .addInitFunc([&](Core& c) { BuildScene(c, settings, scene); }, "BuildBenchScene")
+        .addFunc([&](Core& c) { MoveEntities(c, scene); }, "MoveEntities");
+
+    // Only the last `frames` frames stay in the window: the warmup drops out.
+    core.getStageTimes().SetWindow(settings.frames);
+
+    core.Init();
+    if (!core.getWorld() || core.getWorld()->EntityCount() != settings.entities) {
+        std::fprintf(stderr, "SceneBench: initialization failed\n");
+        return 2;
+    }
+    core.Run();
+
+    // ---- compare with the baseline ----
+    std::string regressions;
+    auto check = [&](FrameStage stage, const char* what, double value, double base) {
+        const double limit = base * (1.0 + settings.margin) + settings.slackMs;
+        if (value <= limit) return;
+        Bench::Append(regressions, "%s    \"%s.%s %.4f ms > %.4f ms (baseline %.4f ms)\"",
+            regressions.empty() ? "" : ",\n", StageTimes::Name(stage), what, value, limit, base);
+    };
+
+    // ---- JSON ----
+    StageTimes& stages = core.getStageTimes();
+    FrameStats& stats = core.getFrameStats();
+
+    std::string json = "{\n  \"benchmark\": \"scene\",\n";
+    Bench::Append(json, "  \"config\": { \"entities\": %u, \"meshes\": %u, \"moving\": %.3f, \"warmup\": %u, \"frames\": %u, "
+        "\"fixed_timestep\": %s, \"workers\": %u, \"seed\": %u },\n",
+        settings.entities, settings.meshes, settings.moving, settings.warmup, settings.frames,
+        settings.fixedTimestep ? "true" : "false", core.getJobs() ? core.getJobs()->WorkerCount() : 0u, settings.seed);
+
+    json += "  \"stages\": {\n";
+    for (size_t i = 0; i < size_t(FrameStage::Count); ++i) {
+        const FrameStage stage = FrameStage(i);
+        const FrameTimeSummary s = stages.GetSummary(stage);
+        Bench::Append(json, "    \"%s\": { \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f }%s\n",
+            StageTimes::Name(stage), s.averageMs, s.p50Ms, s.p99Ms, s.maxMs,
+            i + 1 < size_t(FrameStage::Count) ? "," : "");
+
+        double baseMean = 0.0, baseP99 = 0.0;
+        if (haveBaseline && FindStage(baseline, StageTimes::Name(stage), baseMean, baseP99)) { // see LoadBaseline
+            check(stage, "mean_ms", s.averageMs, baseMean);
+            check(stage, "p99_ms", s.p99Ms, baseP99);
+        }
+    }
+    json += "  },\n";
+
+    // What the last frame did, so a faster run that simply drew less stands out.
+    json += "  \"last_frame\": {";
+    const char* counters[] = { "items_submitted", "triangles", "draws", "bytes_uploaded",
+                               "binds_issued", "binds_skipped" };
+    for (size_t i = 0; i < std::size(counters); ++i)
+        Bench::Append(json, "%s \"%s\": %llu", i ? "," : "", counters[i],
+            static_cast<unsigned long long>(stats.GetCounter(stats.RegisterCounter(counters[i]))));
+    json += " },\n";
+
+    const bool failed = !regressions.empty();
+    json += "  \"regressions\": [" + (failed ? "\n" + regressions + "\n  " : std::string()) + "],\n";
+    Bench::Append(json, "  \"result\": \"%s\"\n}\n", failed ? "fail" : (haveBaseline ? "pass" : "no_baseline"));
+
+    Bench::WriteResult(settings.output, json);
+    return failed ? 1 : 0;
+}
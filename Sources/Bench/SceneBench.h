@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * SceneBench
+ * Measures the whole Core frame (tasks, update callbacks, BuildRenderQueue,
+ * backend submission, present) on a synthetic scene, headless: no window,
+ * no GPU, NullRenderer as backend (see Core::setHeadless).
+ *
+ * The scene is `entities` objects on a grid in front of the camera, using
+ * `meshes` different spheres (so LODs and the mesh lookups vary), of which
+ * `moving` (0..1) are moved by an addFunc callback every update.
+ *
+ * After `warmup` frames, `frames` frames are measured; the result is JSON
+ * with mean / p50 / p99 / max per stage (StageTimes) and the last frame's
+ * counters (draws, state binds issued and skipped as redundant, see
+ * StateTracker). With a baseline (an earlier result file) every stage's
+ * mean and p99 must stay within baseline * (1 + margin) + slackMs,
+ * otherwise the run fails. A baseline that can't be read, lacks a stage or
+ * was measured with another entity count fails the run before it starts.
+ *
+ * SceneBenchBaseline.json, next to this file, is a reference result for
+ * the default settings. Timings depend on the machine: record your own
+ * (run without --baseline, keep the --out file) before comparing.
+ *
+ * From the command line:
+ *     Dreivy.exe --bench --entities=20000 --meshes=16 --moving=0.25
+ *                --frames=600 --out=SceneBench.json
+ *     Dreivy.exe --bench --baseline=Sources/Bench/SceneBenchBaseline.json --margin=0.1
+ * Exit code: 0 ok (or no baseline given), 1 a stage got slower,
+ * 2 bad arguments / unusable baseline / init failed.
+ */
+struct SceneBenchSettings {
+    uint32_t entities = 10000;
+    uint32_t meshes = 8;        // mesh variety
+    float moving = 0.25f;       // share of entities moved every update
+    uint32_t warmup = 120;      // frames, not measured
+    uint32_t frames = 600;      // frames measured
+    bool fixedTimestep = false; // true: updates at 60 Hz like the game
+    uint32_t seed = 1;
+
+    std::string output = "SceneBench.json";
+    std::string baseline;       // empty = no comparison
+    double margin = 0.10;       // allowed slowdown, 0.10 = 10%
+    double slackMs = 0.05;      // absolute allowance, so ~0 ms stages don't flap
+};
+
+// Reads "--key=value" options (see above) from a command line.
+// Unknown options are an error; `error` says which.
+bool ParseSceneBenchArgs(const char* cmdLine, SceneBenchSettings& settings, std::string& error);
+
+// Runs the benchmark, writes the JSON and returns the exit code.
+int RunSceneBench(const SceneBenchSettings& settings);
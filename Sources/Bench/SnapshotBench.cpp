@@ -0,0 +1,76 @@
+#include "SnapshotBench.h"
+#include "BenchUtil.h"
+#include "World/ECS/WorldSnapshot.h"
+#include "World/ECS/Component/Transform.h"
+#include "Timing/Clock.h"
+
+#include <cstdio>
+#include <filesystem>
+
+bool ParseSnapshotBenchArgs(const char* cmdLine, SnapshotBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-snapshot");
+    options.Add("--entities",   s.entities);
+    options.Add("--iterations", s.iterations);
+    options.Add("--seed",       s.seed);
+    options.Add("--file",       s.file);
+    options.Add("--out",        s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.entities == 0 || s.iterations == 0 || s.file.empty()) {
+        error = "--entities and --iterations must be positive, --file not empty";
+        return false;
+    }
+    return true;
+}
+
+int RunSnapshotBench(const SnapshotBenchSettings& settings)
+{
+    World world;
+    uint32_t rng = settings.seed ? settings.seed : 1;
+    for (uint32_t i = 0; i < settings.entities; ++i) {
+        const Entity e = world.CreateEntity();
+        Transform t;
+        t.position = { Bench::RandomFloat(rng) * 1000.0f, Bench::RandomFloat(rng) * 10.0f, Bench::RandomFloat(rng) * 1000.0f };
+        world.AddComponent<Transform>(e, t);
+        if (i % 3 != 0)
+            world.AddComponent<Mesh>(e, Mesh{ MeshHandle(1 + Bench::NextRandom(rng) % 16) });
+    }
+
+    WorldSnapshot snapshot;
+    snapshot.RegisterComponent<Transform>("Transform");
+    snapshot.RegisterComponent<Mesh>("Mesh", RemapMeshHandles);
+
+    const Clock::Ticks saveStart = Clock::NowTicks();
+    const bool saved = snapshot.Save(world, settings.file);
+    const double saveMs = Clock::ToMilliseconds(Clock::NowTicks() - saveStart);
+    const uint64_t bytes = snapshot.GetStats().bytes;
+    if (!saved) {
+        std::fprintf(stderr, "%s\n", snapshot.GetError().c_str());
+        return 1;
+    }
+
+    World loaded;
+    bool ok = true;
+    const FrameTimeSummary load = Bench::Time(settings.iterations, [&] { ok = snapshot.Load(loaded, settings.file) && ok; });
+    std::error_code ec;
+    std::filesystem::remove(settings.file, ec);
+    if (!ok) {
+        std::fprintf(stderr, "%s\n", snapshot.GetError().c_str());
+        return 1;
+    }
+    const SnapshotStats& st = snapshot.GetStats();
+
+    // ---- JSON ----
+    std::string json = "{\n  \"benchmark\": \"world_snapshot\",\n";
+    Bench::Append(json, "  \"config\": { \"entities\": %u, \"iterations\": %u, \"seed\": %u },\n",
+        settings.entities, settings.iterations, settings.seed);
+    Bench::Append(json, "  \"file_mb\": %.2f,\n  \"components\": %llu,\n  \"save_ms\": %.3f,\n",
+        double(bytes) / (1024.0 * 1024.0), (unsigned long long)st.components, saveMs);
+    Bench::Append(json, "  \"load\": { \"mean_ms\": %.3f, \"p50_ms\": %.3f, \"p99_ms\": %.3f, \"max_ms\": %.3f },\n",
+        load.averageMs, load.p50Ms, load.p99Ms, load.maxMs);
+    Bench::Append(json, "  \"load_ms_per_million_entities\": %.3f\n}\n",
+        load.averageMs * 1e6 / double(settings.entities));
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
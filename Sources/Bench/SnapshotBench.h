@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * SnapshotBench
+ * A world of `entities` entities, every one with a Transform and two in
+ * three with a Mesh, saved once with WorldSnapshot and loaded back
+ * `iterations` times. Reports save and load time, the file size and the
+ * load time per million entities (the load is mostly the ID checks and
+ * one memcpy per pool, so it should grow linearly).
+ *
+ * Tests/SnapshotTests.cpp checks round trips and damaged files.
+ *
+ *     Dreivy.exe --bench-snapshot --entities=1000000 --iterations=20 --out=SnapshotBench.json
+ * Exit code: 0 ok, 1 the snapshot didn't save or load, 2 bad arguments.
+ */
+struct SnapshotBenchSettings {
+    uint32_t entities = 1000000;
+    uint32_t iterations = 20;   // loads
+    uint32_t seed = 1;
+    std::string file = "SnapshotBench.dws"; // removed afterwards
+    std::string output = "SnapshotBench.json";
+};
+
+bool ParseSnapshotBenchArgs(const char* cmdLine, SnapshotBenchSettings& settings, std::string& error);
+int RunSnapshotBench(const SnapshotBenchSettings& settings);
@@ -0,0 +1,128 @@
+#include "SpatialBench.h"
+#include "SpatialFixture.h"
+#include "BenchUtil.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+#include "World/ECS/System/SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+using namespace SpatialFixture;
+
+bool ParseSpatialBenchArgs(const char* cmdLine, SpatialBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-spatial");
+    options.Add("--agents",  s.agents);
+    options.Add("--frames",  s.frames);
+    options.Add("--density", s.density);
+    options.Add("--radius",  s.radius);
+    options.Add("--k",       s.k);
+    options.Add("--seed",    s.seed);
+    options.Add("--out",     s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.agents == 0 || s.frames == 0 || s.k == 0 || s.density <= 0.0f || s.radius <= 0.0f) {
+        error = "--agents, --frames, --k, --density and --radius must be positive";
+        return false;
+    }
+    return true;
+}
+
+int RunSpatialBench(const SpatialBenchSettings& settings)
+{
+    const uint32_t n = settings.agents;
+    const float half = std::sqrt(float(n) / settings.density) * 0.5f;
+
+    JobSystem jobs;
+    World world;
+    std::vector<Agent> agents;
+    uint32_t rng = settings.seed ? settings.seed : 1;
+    PlaceAgents(world, agents, n, half, rng);
+
+    SpatialGrid::Settings gridSettings;
+    gridSettings.cellSize = settings.radius;
+    SpatialGrid grid(gridSettings);
+    grid.SetJobSystem(&jobs);
+    grid.Update(world);
+
+    // ---- timing ----
+    const uint32_t stride = 64; // results kept per radius / box query
+    std::vector<XMFLOAT3> centers(n), mins(n), maxs(n);
+    std::vector<Entity> results(size_t(n) * std::max(stride, settings.k));
+    std::vector<float> distances(size_t(n) * settings.k);
+    std::vector<uint32_t> counts(n);
+    std::vector<double> updateMs, radiusMs, boxMs, nearestMs, radiusSerialMs;
+    uint64_t neighbours = 0, truncated = 0;
+
+    const float dt = 1.0f / 60.0f;
+    for (uint32_t frame = 0; frame < settings.frames; ++frame) {
+        MoveAgents(jobs, world, agents, half, dt);
+
+        Clock::Ticks t0 = Clock::NowTicks();
+        grid.Update(world);
+        updateMs.push_back(Clock::ToMilliseconds(Clock::NowTicks() - t0));
+
+        const Transform* transforms = world.GetPool<Transform>().Data().data();
+        for (uint32_t i = 0; i < n; ++i) {
+            const XMFLOAT3& p = transforms[i].position;
+            centers[i] = p;
+            mins[i] = { p.x - settings.radius, p.y - settings.radius, p.z - settings.radius };
+            maxs[i] = { p.x + settings.radius, p.y + settings.radius, p.z + settings.radius };
+        }
+
+        t0 = Clock::NowTicks();
+        grid.QueryRadiusBatch(centers.data(), n, settings.radius, results.data(), stride, counts.data());
+        radiusMs.push_back(Clock::ToMilliseconds(Clock::NowTicks() - t0));
+        for (uint32_t c : counts) {
+            neighbours += c;
+            truncated += c > stride ? 1 : 0;
+        }
+
+        t0 = Clock::NowTicks();
+        grid.QueryBoxBatch(mins.data(), maxs.data(), n, results.data(), stride, counts.data());
+        boxMs.push_back(Clock::ToMilliseconds(Clock::NowTicks() - t0));
+
+        t0 = Clock::NowTicks();
+        grid.QueryNearestBatch(centers.data(), n, settings.k, settings.radius * 2.0f, results.data(), distances.data(), counts.data());
+        nearestMs.push_back(Clock::ToMilliseconds(Clock::NowTicks() - t0));
+
+        // The same radius batch on this thread only, every 8th frame (it's slow).
+        if (frame % 8 == 0) {
+            grid.SetJobSystem(nullptr);
+            t0 = Clock::NowTicks();
+            grid.QueryRadiusBatch(centers.data(), n, settings.radius, results.data(), stride, counts.data());
+            radiusSerialMs.push_back(Clock::ToMilliseconds(Clock::NowTicks() - t0));
+            grid.SetJobSystem(&jobs);
+        }
+    }
+
+    // ---- JSON ----
+    const SpatialGridStats& stats = grid.GetStats();
+    std::string json = "{\n  \"benchmark\": \"spatial\",\n";
+    Bench::Append(json, "  \"config\": { \"agents\": %u, \"frames\": %u, \"density\": %.3f, \"radius\": %.2f, \"k\": %u, \"workers\": %u, \"seed\": %u },\n",
+        n, settings.frames, settings.density, settings.radius, settings.k, jobs.WorkerCount(), settings.seed);
+
+    json += "  \"per_frame\": {\n";
+    struct Row { const char* name; std::vector<double>* ms; };
+    const Row rows[] = {
+        { "update", &updateMs }, { "radius_batch", &radiusMs }, { "box_batch", &boxMs },
+        { "nearest_batch", &nearestMs }, { "radius_batch_1_thread", &radiusSerialMs }
+    };
+    for (size_t i = 0; i < std::size(rows); ++i) {
+        const FrameTimeSummary s = SummarizeTimes(*rows[i].ms);
+        Bench::Append(json, "    \"%s\": { \"mean_ms\": %.4f, \"p99_ms\": %.4f, \"queries_per_ms\": %.0f }%s\n",
+            rows[i].name, s.averageMs, s.p99Ms, i == 0 || s.averageMs <= 0.0 ? 0.0 : double(n) / s.averageMs,
+            i + 1 < std::size(rows) ? "," : "");
+    }
+    json += "  },\n";
+
+    Bench::Append(json, "  \"grid\": { \"buckets\": %u, \"rebuilds\": %llu, \"refreshes\": %llu, \"cell_changes_last\": %u },\n",
+        stats.buckets, static_cast<unsigned long long>(stats.rebuilds), static_cast<unsigned long long>(stats.refreshes), stats.cellChanges);
+    Bench::Append(json, "  \"neighbours_per_agent\": %.2f,\n  \"truncated_queries\": %llu\n}\n",
+        double(neighbours) / (double(n) * settings.frames), static_cast<unsigned long long>(truncated));
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * SpatialBench
+ * `agents` entities wander on a plane; every tick the SpatialGrid is updated
+ * and each agent asks for its neighbours (radius, box and k-nearest, as
+ * batches over the JobSystem), the way AI perception would.
+ *
+ * Reports per tick: grid update, each batch, and the radius batch again on
+ * one thread to show what the workers add. The agents are
+ * Bench/SpatialFixture.h; Tests/SpatialTests.cpp checks the queries
+ * against a brute-force scan.
+ *
+ *     Dreivy.exe --bench-spatial --agents=100000 --frames=120 --out=SpatialBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct SpatialBenchSettings {
+    uint32_t agents = 100000;
+    uint32_t frames = 120;
+    float density = 0.25f;  // agents per square unit
+    float radius = 4.0f;    // perception radius, also the cell size
+    uint32_t k = 8;         // nearest neighbours per agent
+    uint32_t seed = 1;
+    std::string output = "SpatialBench.json";
+};
+
+bool ParseSpatialBenchArgs(const char* cmdLine, SpatialBenchSettings& settings, std::string& error);
+int RunSpatialBench(const SpatialBenchSettings& settings);
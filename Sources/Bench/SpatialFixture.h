@@ -0,0 +1,48 @@
+#pragma once
+#include <cmath>
+#include <vector>
+
+#include "Bench/BenchUtil.h"
+#include "Threading/JobSystem.h"
+#include "World/ECS/Component/Transform.h"
+#include "World/ECS/World.h"
+
+// Agents wandering over a square plane at 1-3 units per second: fast enough
+// that some change cell every tick, so the grid re-sorts as well as copies.
+namespace SpatialFixture {
+
+    struct Agent {
+        float vx, vz; // units per second
+    };
+
+    // Random walk on the plane, bouncing off the edges.
+    inline void MoveAgents(JobSystem& jobs, World& world, std::vector<Agent>& agents, float half, float dt) {
+        Transform* transforms = world.GetPool<Transform>().Data().data();
+        jobs.ParallelFor(uint32_t(agents.size()), 4096, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                XMFLOAT3& p = transforms[i].position;
+                Agent& a = agents[i];
+                p.x += a.vx * dt;
+                p.z += a.vz * dt;
+                if (p.x < -half || p.x > half) a.vx = -a.vx;
+                if (p.z < -half || p.z > half) a.vz = -a.vz;
+            }
+        });
+    }
+
+    // `count` agents spread evenly over a square of side 2 * half, each with
+    // its own speed and direction.
+    inline void PlaceAgents(World& world, std::vector<Agent>& agents, uint32_t count, float half, uint32_t& rng) {
+        agents.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            Entity e = world.CreateEntity();
+            Transform t;
+            t.position = { (Bench::RandomFloat(rng) * 2.0f - 1.0f) * half, 0.0f, (Bench::RandomFloat(rng) * 2.0f - 1.0f) * half };
+            world.AddComponent<Transform>(e, t);
+            const float angle = Bench::RandomFloat(rng) * 6.2831853f;
+            const float speed = 1.0f + Bench::RandomFloat(rng) * 2.0f;
+            agents[i] = { std::cos(angle) * speed, std::sin(angle) * speed };
+        }
+    }
+
+} // namespace SpatialFixture
@@ -0,0 +1,110 @@
+#include "StaticBatchBench.h"
+#include "StaticBatchFixture.h"
+#include "BenchUtil.h"
+#include "Timing/Clock.h"
+
+#include <string>
+#include <vector>
+
+using namespace StaticBatchFixture;
+
+namespace {
+
+    struct Measure {
+        uint32_t items = 0;
+        uint32_t draws = 0;
+        uint64_t triangles = 0;
+        FrameTimeSummary build;
+        FrameTimeSummary draw;
+    };
+
+    Measure Run(Scene& s, const RenderView& view, bool batched, uint32_t frames) {
+        std::vector<double> buildMs, drawMs;
+        Measure m;
+        for (uint32_t f = 0; f < frames; ++f) {
+            const Clock::Ticks t0 = Clock::NowTicks();
+            BuildRenderQueue(s.world, s.queue, s.meshes, view, s.lods, s.clusters);
+            if (batched)
+                s.batcher.Submit(s.world, s.queue, view);
+            const Clock::Ticks t1 = Clock::NowTicks();
+            s.renderer.SetCamera(view.camera);
+            s.renderer.BeginFrame(0.0f, 0.0f, 0.0f, 1.0f);
+            s.renderer.Draw(s.queue);
+            const Clock::Ticks t2 = Clock::NowTicks();
+            buildMs.push_back(Clock::ToMilliseconds(t1 - t0));
+            drawMs.push_back(Clock::ToMilliseconds(t2 - t1));
+        }
+        m.items = s.queue.GetStats().items;
+        m.triangles = s.queue.GetStats().triangles;
+        m.draws = s.renderer.GetStats().draws;
+        m.build = SummarizeTimes(buildMs);
+        m.draw = SummarizeTimes(drawMs);
+        return m;
+    }
+
+} // namespace
+
+bool ParseStaticBatchBenchArgs(const char* cmdLine, StaticBatchBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-static");
+    options.Add("--entities", s.entities);
+    options.Add("--meshes",   s.meshes);
+    options.Add("--cell",     s.cellSize);
+    options.Add("--frames",   s.frames);
+    options.Add("--seed",     s.seed);
+    options.Add("--out",      s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.entities == 0 || s.meshes == 0 || s.frames == 0 || !(s.cellSize > 0.0f)) {
+        error = "--entities, --meshes, --cell and --frames must be positive";
+        return false;
+    }
+    return true;
+}
+
+int RunStaticBatchBench(const StaticBatchBenchSettings& settings)
+{
+    Scene scene;
+    BuildScene(scene, settings.entities, settings.meshes, settings.seed);
+    const std::vector<View> views = MakeViews(scene.half);
+
+    // Before: one draw per entity.
+    std::vector<Measure> before;
+    for (const View& v : views)
+        before.push_back(Run(scene, v.view, false, settings.frames));
+
+    StaticBatcher::Settings batchSettings;
+    batchSettings.cellSize = settings.cellSize;
+    scene.batcher.SetSettings(batchSettings);
+    const Clock::Ticks buildStart = Clock::NowTicks();
+    scene.batcher.Build(scene.world, scene.meshes);
+    const double buildMs = Clock::ToMilliseconds(Clock::NowTicks() - buildStart);
+
+    std::vector<Measure> after;
+    for (const View& v : views)
+        after.push_back(Run(scene, v.view, true, settings.frames));
+
+    // ---- JSON ----
+    const StaticBatchStats& st = scene.batcher.GetStats();
+    std::string json = "{\n  \"benchmark\": \"static_batching\",\n";
+    Bench::Append(json, "  \"config\": { \"entities\": %u, \"meshes\": %u, \"cell_size\": %.1f, \"frames\": %u, \"seed\": %u },\n",
+        settings.entities, settings.meshes, settings.cellSize, settings.frames, settings.seed);
+    Bench::Append(json, "  \"build\": { \"ms\": %.3f, \"entities\": %u, \"left_alone\": %u, \"batches\": %u, \"vertices\": %llu, \"indices\": %llu },\n",
+        buildMs, st.entities, st.leftAlone, st.batches, (unsigned long long)st.vertices, (unsigned long long)st.indices);
+
+    json += "  \"views\": {\n";
+    for (size_t i = 0; i < views.size(); ++i) {
+        Bench::Append(json, "    \"%s\": {\n", views[i].name);
+        const Measure* rows[2] = { &before[i], &after[i] };
+        for (int r = 0; r < 2; ++r) {
+            const Measure& m = *rows[r];
+            Bench::Append(json, "      \"%s\": { \"items\": %u, \"draws\": %u, \"triangles\": %llu, \"build_queue_ms\": %.4f, \"draw_ms\": %.4f }%s\n",
+                r ? "after" : "before", m.items, m.draws, (unsigned long long)m.triangles, m.build.averageMs, m.draw.averageMs,
+                r ? "" : ",");
+        }
+        Bench::Append(json, "    }%s\n", i + 1 < views.size() ? "," : "");
+    }
+    json += "  }\n}\n";
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
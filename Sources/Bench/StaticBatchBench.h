@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * StaticBatchBench
+ * A reference scene: `entities` props on a square grid, each one of
+ * `meshes` small meshes (half of them with normals, so two vertex
+ * layouts), some mirrored, most of them static. It is drawn from three
+ * cameras (everything in view, a street-level view along a diagonal, a
+ * view from the middle) through BuildRenderQueue and the NullRenderer,
+ * first one draw per entity, then after StaticBatcher::Build. Reports
+ * items, draws and triangles before and after, and what building the
+ * queue and "drawing" it cost on the CPU.
+ *
+ * The scene is Bench/StaticBatchFixture.h; Tests/StaticBatchTests.cpp
+ * checks the batches against it, and that every entity drawn before is
+ * still drawn after.
+ *
+ *     Dreivy.exe --bench-static --entities=20000 --meshes=16 --cell=32 --out=StaticBatchBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct StaticBatchBenchSettings {
+    uint32_t entities = 20000;
+    uint32_t meshes = 16;
+    float cellSize = 32.0f;
+    uint32_t frames = 60;   // per camera, before and after
+    uint32_t seed = 1;
+    std::string output = "StaticBatchBench.json";
+};
+
+bool ParseStaticBatchBenchArgs(const char* cmdLine, StaticBatchBenchSettings& settings, std::string& error);
+int RunStaticBatchBench(const StaticBatchBenchSettings& settings);
@@ -0,0 +1,106 @@
+#pragma once
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "Bench/BenchUtil.h"
+#include "Renderer/MeshStorage.h"
+#include "Renderer/NullRenderer.h"
+#include "Renderer/StaticMeshes.h"
+#include "World/ECS/Component/Mesh.h"
+#include "World/ECS/Component/StaticMesh.h"
+#include "World/ECS/Component/Transform.h"
+#include "World/ECS/System/RendererBuilder.h"
+#include "World/ECS/System/StaticBatcher.h"
+
+// A square grid of small props in a few vertex layouts, some mirrored. Nine
+// in ten are StaticMesh; the rest could move and are drawn on their own.
+namespace StaticBatchFixture {
+
+    constexpr float Spacing = 3.0f;
+    constexpr float Width = 1280.0f;
+    constexpr float Height = 720.0f;
+
+    struct Scene {
+        World world;
+        MeshStorage meshes;
+        RenderQueue queue;
+        LodSelector lods;
+        ClusterCuller clusters;
+        NullRenderer renderer;
+        StaticBatcher batcher;
+        float half = 0.0f; // of the grid
+    };
+
+    inline void BuildScene(Scene& s, uint32_t entities, uint32_t meshes, uint32_t seed) {
+        // Small props: low-poly spheres of four sizes and a box. Every
+        // other sphere has normals, which gives it another vertex layout.
+        std::vector<MeshHandle> handles;
+        for (uint32_t i = 0; i < meshes; ++i) {
+            const uint32_t detail = i % 4;
+            MeshData mesh = i % 8 == 7 ? CreateTestCube() : CreateTestSphere(6 + detail * 2, 4 + detail);
+            if (i % 2 == 0)
+                mesh.normals = mesh.positions; // unit sphere: the position is the normal
+            handles.push_back(s.meshes.Add(mesh, "Prop" + std::to_string(i)));
+        }
+
+        const uint32_t side = uint32_t(std::ceil(std::sqrt(double(entities))));
+        s.half = float(side) * Spacing * 0.5f;
+        uint32_t rng = seed ? seed : 1;
+        for (uint32_t i = 0; i < entities; ++i) {
+            const Entity e = s.world.CreateEntity();
+            Transform t;
+            t.position = { float(i % side) * Spacing - s.half, 0.0f, float(i / side) * Spacing - s.half };
+            t.rotation = { 0.0f, Bench::RandomFloat(rng) * 6.28f, 0.0f };
+            const float scale = 0.5f + Bench::RandomFloat(rng);
+            t.scale = { Bench::NextRandom(rng) % 10 == 0 ? -scale : scale, scale, scale }; // some mirrored
+            s.world.AddComponent<Transform>(e, t);
+            s.world.AddComponent<Mesh>(e, Mesh{ handles[Bench::NextRandom(rng) % handles.size()] });
+            if (Bench::NextRandom(rng) % 10 != 0) // the rest could move: drawn on their own
+                s.world.AddComponent<StaticMesh>(e);
+        }
+        s.renderer.SetMeshStorage(&s.meshes);
+        s.renderer.Resize(uint32_t(Width), uint32_t(Height));
+
+        // Every mesh goes up when first drawn, the merged ones too: draw
+        // counts are about batching, not about the upload budget.
+        UploadQueue::Settings uploads;
+        uploads.bytesPerFrame = 0;
+        uploads.msPerFrame = 0.0;
+        uploads.stagingBytes = 64ull << 20;
+        s.renderer.GetUploads().SetSettings(uploads);
+    }
+
+    struct View {
+        const char* name;
+        RenderView view;
+    };
+
+    inline std::vector<View> MakeViews(float half) {
+        Camera above;
+        above.position = { 0.0f, half * 3.0f, -1.0f };
+        above.farZ = half * 8.0f;
+
+        Camera street;
+        street.position = { -half, 2.0f, -half };
+        street.target = { 0.0f, 2.0f, 0.0f };
+
+        Camera middle;
+        middle.position = { 0.0f, 6.0f, 0.0f };
+        middle.target = { half, 2.0f, half * 0.3f };
+
+        return { { "overview", BuildRenderView(above, Width, Height) },
+                 { "street", BuildRenderView(street, Width, Height) },
+                 { "middle", BuildRenderView(middle, Width, Height) } };
+    }
+
+    inline void DrawFrame(Scene& s, const RenderView& view, bool batched) {
+        BuildRenderQueue(s.world, s.queue, s.meshes, view, s.lods, s.clusters);
+        if (batched)
+            s.batcher.Submit(s.world, s.queue, view);
+        s.renderer.SetCamera(view.camera);
+        s.renderer.BeginFrame(0.0f, 0.0f, 0.0f, 1.0f);
+        s.renderer.Draw(s.queue);
+    }
+
+} // namespace StaticBatchFixture
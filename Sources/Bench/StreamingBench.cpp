@@ -0,0 +1,82 @@
+#include "StreamingBench.h"
+#include "StreamingFixture.h"
+#include "BenchUtil.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+
+#include <iterator>
+#include <vector>
+
+using namespace StreamingFixture;
+
+bool ParseStreamingBenchArgs(const char* cmdLine, StreamingBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-streaming");
+    options.Add("--entities", s.entities);
+    options.Add("--frames",   s.frames);
+    options.Add("--speed",    s.speed);
+    options.Add("--frame-ms", s.frameMs);
+    options.Add("--merge-kb", s.mergeKb);
+    options.Add("--hitch-ms", s.hitchMs);
+    options.Add("--seed",     s.seed);
+    options.Add("--out",      s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.entities == 0 || s.frames == 0 || s.mergeKb == 0 || !(s.speed > 0.0f)) {
+        error = "--entities, --frames, --merge-kb and --speed must be positive";
+        return false;
+    }
+    return true;
+}
+
+int RunStreamingBench(const StreamingBenchSettings& settings)
+{
+    JobSystem jobs;
+    World world;
+    CellStreamer streamer;
+    streamer.SetSettings(StreamSettings(settings.mergeKb, settings.hitchMs));
+    streamer.SetJobSystem(&jobs);
+    streamer.SetBuilder([&settings](CellCoord c, World& out) { BuildCell(settings.seed, settings.entities, c, out); });
+
+    std::vector<double> updateMs, mergeMs, unloadMs;
+    double residentCells = 0.0, residentBytes = 0.0;
+    uint64_t mergedBytes = 0;
+    for (uint32_t frame = 0; frame < settings.frames; ++frame) {
+        const Clock::Ticks start = Clock::NowTicks();
+        streamer.Update(world, CameraAt(frame, settings.speed));
+        const CellStreamerStats& st = streamer.GetStats();
+        updateMs.push_back(st.updateMs);
+        mergeMs.push_back(st.mergeMs);
+        unloadMs.push_back(st.unloadMs);
+        residentCells += st.resident;
+        residentBytes += double(st.residentBytes);
+        mergedBytes += st.mergedBytes;
+        Pace(start, settings.frameMs);
+    }
+    const CellStreamerStats& st = streamer.GetStats();
+
+    // ---- JSON ----
+    const double frames = double(settings.frames);
+    std::string json = "{\n  \"benchmark\": \"streaming\",\n";
+    Bench::Append(json, "  \"config\": { \"entities_per_cell\": %u, \"frames\": %u, \"speed\": %.2f, \"frame_ms\": %.2f, \"merge_kb\": %u, \"hitch_ms\": %.2f, \"workers\": %u, \"seed\": %u },\n",
+        settings.entities, settings.frames, settings.speed, settings.frameMs, settings.mergeKb, settings.hitchMs, jobs.WorkerCount(), settings.seed);
+
+    json += "  \"per_frame\": {\n";
+    struct Row { const char* name; std::vector<double>* ms; };
+    const Row rows[] = { { "update", &updateMs }, { "merge", &mergeMs }, { "unload", &unloadMs } };
+    for (size_t i = 0; i < std::size(rows); ++i) {
+        const FrameTimeSummary s = SummarizeTimes(*rows[i].ms);
+        Bench::Append(json, "    \"%s\": { \"mean_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f }%s\n",
+            rows[i].name, s.averageMs, s.p99Ms, rows[i].ms->empty() ? 0.0 : rows[i].ms->back(),
+            i + 1 < std::size(rows) ? "," : "");
+    }
+    json += "  },\n";
+
+    Bench::Append(json, "  \"hitches\": %llu,\n  \"cells_loaded\": %llu,\n  \"cells_unloaded\": %llu,\n  \"builds_cancelled\": %llu,\n",
+        (unsigned long long)st.hitches, (unsigned long long)st.cellsLoaded, (unsigned long long)st.cellsUnloaded,
+        (unsigned long long)st.buildsCancelled);
+    Bench::Append(json, "  \"resident_cells_avg\": %.1f,\n  \"resident_kb_avg\": %.1f,\n  \"merged_kb_per_frame\": %.1f,\n  \"entity_ids_used\": %u\n}\n",
+        residentCells / frames, residentBytes / frames / 1024.0, double(mergedBytes) / frames / 1024.0, st.idsUsed);
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * StreamingBench
+ * A camera flies over an endless grid of procedural cells (about
+ * `entities` per cell, each with a Transform and one or two more
+ * components) while a CellStreamer loads the cells around it on the
+ * JobSystem and merges them into the live World under a per-frame byte
+ * budget. Frames are paced to `--frame-ms` (the rest of a game frame),
+ * so workers get about the time they would get in a game. Reports what
+ * Update cost the main thread per frame (mean, p99, max, hitches over
+ * `--hitch-ms`), merge / unload time, and how many cells and bytes were
+ * resident.
+ *
+ * The cells are Bench/StreamingFixture.h; Tests/StreamingTests.cpp checks,
+ * with and without workers, that every resident cell holds exactly what
+ * its builder made under its own entity IDs, that unloaded cells leave
+ * nothing behind, that no Update merged or unloaded more than its budget,
+ * that unloaded ID blocks are reused, and that cells dropped while still
+ * building or merging are cancelled cleanly.
+ *
+ *     Dreivy.exe --bench-streaming --entities=2000 --frames=600 --frame-ms=4 --merge-kb=256 --out=StreamingBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct StreamingBenchSettings {
+    uint32_t entities = 2000;   // per cell, on average
+    uint32_t frames = 600;
+    float speed = 4.0f;         // camera units per frame
+    double frameMs = 4.0;       // frame period, Update included
+    uint32_t mergeKb = 256;     // merge budget per frame
+    double hitchMs = 2.0;
+    uint32_t seed = 1;
+    std::string output = "StreamingBench.json";
+};
+
+bool ParseStreamingBenchArgs(const char* cmdLine, StreamingBenchSettings& settings, std::string& error);
+int RunStreamingBench(const StreamingBenchSettings& settings);
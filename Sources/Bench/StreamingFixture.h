@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "Bench/BenchUtil.h"
+#include "World/Streaming/CellStreamer.h"
+#include "World/ECS/Component/Transform.h"
+#include "Timing/Clock.h"
+
+// An endless procedural grid of cells: a cell always builds the same
+// entities, so a cell loaded twice can be compared with its first load.
+namespace StreamingFixture {
+
+    constexpr float CellSize = 64.0f;
+
+    // Which cell an entity came from and which one of it it is.
+    struct CellMarker {
+        int32_t x, z;
+        uint32_t index;
+    };
+
+    // Only on every other entity, so pools differ in size.
+    struct Prop {
+        float mass;
+        uint32_t kind;
+    };
+
+    inline uint32_t CellSeed(uint32_t seed, CellCoord c) {
+        uint32_t state = (seed * 0x9E3779B9u) ^ (uint32_t(c.x) * 0x85EBCA6Bu) ^ (uint32_t(c.z) * 0xC2B2AE35u);
+        return state ? state : 1;
+    }
+
+    // The procedural content: the same cell always gets the same entities.
+    inline void BuildCell(uint32_t seed, uint32_t entities, CellCoord c, World& out) {
+        uint32_t state = CellSeed(seed, c);
+        const uint32_t count = entities / 2 + Bench::NextRandom(state) % (entities + 1);
+        for (uint32_t i = 0; i < count; ++i) {
+            const Entity e = out.CreateEntity();
+            Transform t;
+            t.position = { (float(c.x) + Bench::RandomFloat(state)) * CellSize, Bench::RandomFloat(state) * 10.0f,
+                           (float(c.z) + Bench::RandomFloat(state)) * CellSize };
+            t.rotation = { 0.0f, Bench::RandomFloat(state) * 6.28f, 0.0f };
+            out.AddComponent<Transform>(e, t);
+            out.AddComponent<CellMarker>(e, CellMarker{ c.x, c.z, i });
+            if (i % 2 == 0)
+                out.AddComponent<Prop>(e, Prop{ 1.0f + Bench::RandomFloat(state), Bench::NextRandom(state) % 8 });
+        }
+    }
+
+    inline XMFLOAT3 CameraAt(uint32_t frame, float speed) {
+        const float t = float(frame);
+        return XMFLOAT3(t * speed, 20.0f, std::sin(t * 0.01f) * 200.0f);
+    }
+
+    inline CellStreamer::Settings StreamSettings(uint32_t mergeKb, double hitchMs) {
+        CellStreamer::Settings st;
+        st.cellSize = CellSize;
+        st.loadRadius = 192.0f;
+        st.unloadRadius = 256.0f;
+        st.mergeBytesPerFrame = uint64_t(mergeKb) * 1024;
+        st.hitchMs = hitchMs;
+        return st;
+    }
+
+    // Sleeps until `frameMs` after `start`: the rest of the frame.
+    inline void Pace(Clock::Ticks start, double frameMs) {
+        const Clock::Ticks end = start + Clock::Ticks(frameMs * 1e6);
+        const Clock::Ticks now = Clock::NowTicks();
+        if (now < end)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(end - now));
+    }
+
+    inline bool Busy(const CellStreamerStats& st) {
+        return st.building + st.waiting + st.merging + st.unloading > 0;
+    }
+
+    // Updates in place until nothing is in flight anymore.
+    inline bool Settle(CellStreamer& streamer, World& world, const XMFLOAT3& camera) {
+        for (uint32_t i = 0; i < 100000; ++i) {
+            streamer.Update(world, camera);
+            if (!Busy(streamer.GetStats()))
+                return true;
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+} // namespace StreamingFixture
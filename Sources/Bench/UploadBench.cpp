@@ -0,0 +1,109 @@
+#include "UploadBench.h"
+#include "UploadFixture.h"
+#include "BenchUtil.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace UploadFixture;
+
+namespace {
+
+    struct Measure {
+        FrameTimeSummary uploadMs;
+        double meanBytes = 0.0;
+        uint64_t maxBytes = 0;
+        uint32_t maxPending = 0;
+        uint64_t maxPendingBytes = 0;
+        uint32_t notReady = 0;          // items skipped over all frames
+        uint32_t framesNotReady = 0;    // frames that skipped any
+        uint32_t ringFull = 0;
+        uint32_t ringGrowths = 0;
+        uint64_t totalBytes = 0;
+    };
+
+    Measure Run(const Road& road, const UploadQueue::Settings& us) {
+        Measure m;
+        std::vector<double> uploadMs;
+        double bytes = 0.0;
+        UploadStats last;
+        DriveRoad(road, us, [&](NullRenderer& renderer, const RenderQueue&) {
+            const UploadStats& st = renderer.GetUploads().GetStats();
+            const RendererStats& rs = renderer.GetStats();
+            uploadMs.push_back(st.milliseconds);
+            bytes += double(st.bytes);
+            m.maxBytes = std::max(m.maxBytes, st.bytes);
+            m.maxPending = std::max(m.maxPending, st.pending);
+            m.maxPendingBytes = std::max(m.maxPendingBytes, st.pendingBytes);
+            m.notReady += rs.notReady;
+            m.framesNotReady += rs.notReady ? 1 : 0;
+            last = st;
+        });
+
+        m.uploadMs = SummarizeTimes(uploadMs);
+        m.meanBytes = bytes / double(road.frames);
+        m.ringFull = last.ringFull;
+        m.ringGrowths = last.ringGrowths;
+        m.totalBytes = last.totalBytes;
+        return m;
+    }
+
+    void AppendMeasure(std::string& json, const char* name, const Measure& m, bool last) {
+        Bench::Append(json, "    \"%s\": { \"upload_ms\": { \"mean\": %.4f, \"p99\": %.4f, \"max\": %.4f },",
+            name, m.uploadMs.averageMs, m.uploadMs.p99Ms, m.uploadMs.maxMs);
+        Bench::Append(json, " \"bytes_per_frame\": { \"mean\": %.0f, \"max\": %llu },",
+            m.meanBytes, (unsigned long long)m.maxBytes);
+        Bench::Append(json, " \"max_pending\": %u, \"max_pending_bytes\": %llu,",
+            m.maxPending, (unsigned long long)m.maxPendingBytes);
+        Bench::Append(json, " \"items_not_ready\": %u, \"frames_not_ready\": %u, \"ring_full\": %u, \"ring_growths\": %u, \"total_bytes\": %llu }%s\n",
+            m.notReady, m.framesNotReady, m.ringFull, m.ringGrowths, (unsigned long long)m.totalBytes, last ? "" : ",");
+    }
+
+} // namespace
+
+bool ParseUploadBenchArgs(const char* cmdLine, UploadBenchSettings& s, std::string& error)
+{
+    Bench::Options options("--bench-upload");
+    options.Add("--meshes",     s.meshes);
+    options.Add("--frames",     s.frames);
+    options.Add("--budget-kb",  s.budgetKb);
+    options.Add("--budget-ms",  s.budgetMs);
+    options.Add("--staging-kb", s.stagingKb);
+    options.Add("--seed",       s.seed);
+    options.Add("--out",        s.output);
+    if (!options.Parse(cmdLine, error)) return false;
+    if (s.meshes < 8 || s.frames < 4 || s.budgetKb == 0 || s.stagingKb == 0 || s.budgetMs < 0.0) {
+        error = "--meshes must be at least 8, --frames at least 4, --budget-kb and --staging-kb positive";
+        return false;
+    }
+    return true;
+}
+
+int RunUploadBench(const UploadBenchSettings& settings)
+{
+    const Road road = MakeRoad(settings.meshes, settings.frames, settings.seed);
+
+    UploadQueue::Settings budgeted;
+    budgeted.bytesPerFrame = uint64_t(settings.budgetKb) << 10;
+    budgeted.msPerFrame = settings.budgetMs;
+    budgeted.stagingBytes = uint64_t(settings.stagingKb) << 10;
+    UploadQueue::Settings unlimited = budgeted;
+    unlimited.bytesPerFrame = 0;
+    unlimited.msPerFrame = 0.0;
+    unlimited.stagingBytes = 32ull << 20; // never the limit either
+
+    const Measure withBudget = Run(road, budgeted);
+    const Measure noBudget = Run(road, unlimited);
+
+    std::string json = "{\n  \"benchmark\": \"mesh_uploads\",\n";
+    Bench::Append(json, "  \"config\": { \"meshes\": %u, \"frames\": %u, \"budget_kb\": %u, \"budget_ms\": %.2f, \"staging_kb\": %u, \"seed\": %u },\n",
+        settings.meshes, settings.frames, settings.budgetKb, settings.budgetMs, settings.stagingKb, settings.seed);
+    json += "  \"runs\": {\n";
+    AppendMeasure(json, "budgeted", withBudget, false);
+    AppendMeasure(json, "unlimited", noBudget, true);
+    json += "  }\n}\n";
+
+    Bench::WriteResult(settings.output, json);
+    return 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * UploadBench
+ * A camera drives down a road lined with `meshes` rocks (spheres of random
+ * detail, one of them far bigger than the rest). Rocks are added to
+ * MeshStorage a little before they come into view, like streamed cells,
+ * and halfway the camera jumps ahead, past everything already added. Each
+ * frame is drawn through the NullRenderer twice over: once with the upload
+ * budget, once without (like creating every mesh when it is first drawn).
+ * Reports what uploading cost per frame, how many bytes went up, how deep
+ * the queue got and how many draws had to wait.
+ *
+ * The road is Bench/UploadFixture.h; Tests/UploadTests.cpp replays it
+ * against a checking upload target with a small staging ring: every frame
+ * stays in budget (unless one mesh alone is bigger), visible meshes go
+ * before prefetched ones and nearer before farther, staged bytes equal the
+ * mesh and stay untouched while their frame is in flight, the big rock
+ * grows the ring, a changed mesh is drawn with its old buffers until it
+ * goes up again, and in the end everything is resident.
+ *
+ *     Dreivy.exe --bench-upload --meshes=400 --frames=600 --budget-kb=256 --out=UploadBench.json
+ * Exit code: 0 ok, 2 bad arguments.
+ */
+struct UploadBenchSettings {
+    uint32_t meshes = 400;
+    uint32_t frames = 600;
+    uint32_t budgetKb = 256;    // per frame, budgeted run
+    double budgetMs = 2.0;      // per frame, budgeted run
+    uint32_t stagingKb = 2048;  // the ring
+    uint32_t seed = 1;
+    std::string output = "UploadBench.json";
+};
+
+bool ParseUploadBenchArgs(const char* cmdLine, UploadBenchSettings& settings, std::string& error);
+int RunUploadBench(const UploadBenchSettings& settings);
@@ -0,0 +1,108 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Bench/BenchUtil.h"
+#include "Renderer/MeshStorage.h"
+#include "Renderer/NullRenderer.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/StaticMeshes.h"
+#include "Renderer/UploadQueue.h"
+
+// A road lined with rocks of very different sizes. The camera drives down it
+// and jumps ahead halfway, so a burst of new meshes is due at once.
+namespace UploadFixture {
+
+    constexpr float Spacing = 1.5f;    // between rocks along the road
+    constexpr float AddAhead = 150.0f; // rocks are added this far ahead of the camera
+    constexpr float ViewAhead = 100.0f;
+    constexpr float ViewBehind = 10.0f;
+    constexpr float Jump = 150.0f;     // halfway, past everything added so far
+
+    struct Road {
+        std::vector<MeshData> rocks;
+        std::vector<XMFLOAT3> positions;
+        uint32_t frames = 0;
+        float speed = 0.0f;
+    };
+
+    inline Road MakeRoad(uint32_t meshes, uint32_t frames, uint32_t seed) {
+        Road road;
+        uint32_t rng = seed ? seed : 1;
+        for (uint32_t i = 0; i < meshes; ++i) {
+            // A few KB up to ~100 KB each; one big rock in the middle, bigger
+            // than the check's staging ring.
+            const uint32_t segments = i == meshes / 2 ? 192 : 8 + Bench::NextRandom(rng) % 57;
+            road.rocks.push_back(CreateTestSphere(segments, std::max(segments / 2, 4u)));
+            road.positions.push_back({ Bench::RandomFloat(rng) * 40.0f - 20.0f, 0.0f, float(i) * Spacing });
+        }
+        road.frames = frames;
+        road.speed = std::max(float(meshes) * Spacing - Jump, 0.0f) / float(frames);
+        return road;
+    }
+
+    inline float CameraZ(const Road& road, uint32_t frame) {
+        return float(frame) * road.speed + (frame >= road.frames / 2 ? Jump : 0.0f);
+    }
+
+    // Adds the rocks coming up, fills the queue with the ones in view and
+    // returns the camera. `handles` holds what was added so far.
+    inline Camera StepRoad(const Road& road, uint32_t frame, MeshStorage& meshes, std::vector<MeshHandle>& handles, RenderQueue& queue) {
+        const float z = CameraZ(road, frame);
+        while (handles.size() < road.rocks.size() && road.positions[handles.size()].z <= z + AddAhead)
+            handles.push_back(meshes.Add(road.rocks[handles.size()], "Rock" + std::to_string(handles.size())));
+
+        queue.Clear();
+        for (size_t i = 0; i < handles.size(); ++i) {
+            const XMFLOAT3& p = road.positions[i];
+            if (p.z < z - ViewBehind || p.z > z + ViewAhead)
+                continue;
+            XMFLOAT4X4 world;
+            XMStoreFloat4x4(&world, XMMatrixTranslation(p.x, p.y, p.z));
+            queue.Submit(world, handles[i], Entity(i + 1));
+        }
+
+        Camera camera;
+        camera.position = { 0.0f, 2.0f, z };
+        camera.target = { 0.0f, 2.0f, z + 1.0f };
+        return camera;
+    }
+
+    // What the backends request with: squared distance to the camera.
+    inline float Distance(const RenderItem& item, const Camera& camera) {
+        const float dx = item.world.m[3][0] - camera.position.x;
+        const float dy = item.world.m[3][1] - camera.position.y;
+        const float dz = item.world.m[3][2] - camera.position.z;
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    inline uint64_t UploadSize(const MeshData& mesh) {
+        uint64_t indices = 0;
+        for (uint32_t lod = 0; lod < mesh.LodCount(); ++lod)
+            indices += mesh.LodIndices(lod).size();
+        return mesh.vertexStream.bytes.size() + indices * sizeof(uint32_t);
+    }
+
+    // Drives the road through a NullRenderer with upload settings `us`;
+    // `frameDone(renderer, queue)` runs after each frame is drawn.
+    template<typename F>
+    void DriveRoad(const Road& road, const UploadQueue::Settings& us, F&& frameDone) {
+        MeshStorage meshes;
+        RenderQueue queue;
+        NullRenderer renderer;
+        renderer.SetMeshStorage(&meshes);
+        renderer.Resize(1280, 720);
+        renderer.GetUploads().SetSettings(us);
+
+        std::vector<MeshHandle> handles;
+        for (uint32_t frame = 0; frame < road.frames; ++frame) {
+            renderer.SetCamera(StepRoad(road, frame, meshes, handles, queue));
+            renderer.BeginFrame(0.0f, 0.0f, 0.0f, 1.0f);
+            renderer.Draw(queue);
+            renderer.EndFrame();
+            frameDone(renderer, queue);
+        }
+    }
+
+} // namespace UploadFixture
@@ -1,7 +1,21 @@
 #include "Core.h"
 #include <windows.h>
 #include <stdexcept>
+#include <cstdio>
 #include "Math/Time.h"
+#include "Timing/Clock.h"
+#include "Renderer/NullRenderer.h"
+
+namespace {
+    // Adds the time until the end of the scope to one stage of the frame.
+    struct StageScope {
+        StageTimes& times;
+        FrameStage stage;
+        Clock::Ticks start = Clock::NowTicks();
+        ~StageScope() { times.Add(stage, Clock::ToMilliseconds(Clock::NowTicks() - start)); }
+    };
+}
+
 Core::~Core() {
     Shutdown();
 }
@@ -9,25 +23,77 @@ Core::~Core() {
 
 Core& Core::Init() {
     try {
-        InitWindow();
+        Profiler::SetThreadName("Main");
+        if (!m_headless)
+            InitWindow();
+
+        // Before the renderer: it compiles shaders on the job system.
+        m_jobs = std::make_unique<JobSystem>();
 
         if (!InitSystem())
             throw std::runtime_error("InitSystem failed");
 
-        SetupCallbacks();
+        if (m_window)
+            SetupCallbacks();
+
+        m_counterEntities    = m_frameStats.RegisterCounter("entities", CounterKind::Gauge);
+        m_counterItems       = m_frameStats.RegisterCounter("items_submitted");
+        m_counterTriangles   = m_frameStats.RegisterCounter("triangles");
+        m_counterSkinnedVertices = m_frameStats.RegisterCounter("skinned_vertices");
+        m_counterParticles   = m_frameStats.RegisterCounter("particles", CounterKind::Gauge);
+        m_counterEvents      = m_frameStats.RegisterCounter("events");
+        m_counterCells       = m_frameStats.RegisterCounter("cells_resident", CounterKind::Gauge);
+        m_counterStreamBytes = m_frameStats.RegisterCounter("bytes_streamed");
+        m_counterDraws       = m_frameStats.RegisterCounter("draws");
+        m_counterUploadBytes = m_frameStats.RegisterCounter("bytes_uploaded");
+        m_counterUploadsPending = m_frameStats.RegisterCounter("uploads_pending", CounterKind::Gauge);
+        m_counterNotReady    = m_frameStats.RegisterCounter("items_not_ready");
+        m_counterPasses      = m_frameStats.RegisterCounter("render_passes", CounterKind::Gauge);
+        m_counterBarriers    = m_frameStats.RegisterCounter("barriers");
+        m_counterBindsIssued = m_frameStats.RegisterCounter("binds_issued");
+        m_counterBindsSkipped = m_frameStats.RegisterCounter("binds_skipped");
+        m_counterLatency     = m_frameStats.RegisterCounter("input_latency_us", CounterKind::Gauge);
+        m_counterTasks       = m_frameStats.RegisterCounter("tasks_running", CounterKind::Gauge);
+        m_counterInputEvents = m_frameStats.RegisterCounter("input_events");
+        for (size_t t = 0; t < size_t(AllocTag::Count); ++t) {
+            const std::string tag = AllocTracker::TagName(AllocTag(t));
+            m_counterAllocs[t]     = m_frameStats.RegisterCounter("allocs_" + tag);
+            m_counterAllocBytes[t] = m_frameStats.RegisterCounter("alloc_bytes_" + tag);
+        }
+        m_clusterCuller.SetJobSystem(m_jobs.get());
+        m_tasks.SetJobSystem(m_jobs.get());
+        m_spatialGrid.SetJobSystem(m_jobs.get());
+        m_physics.SetJobSystem(m_jobs.get());
+        m_animationSystem.SetJobSystem(m_jobs.get());
+        m_animationSystem.SetStorage(&m_animations);
+        m_particles.SetJobSystem(m_jobs.get());
+        m_commands.SetJobSystem(m_jobs.get());
+        m_streamer.SetJobSystem(m_jobs.get());
         m_world = std::make_unique<World>();
         m_meshStorage = std::make_unique<MeshStorage>();
         m_renderQueue = std::make_unique<RenderQueue>();
         m_renderer->SetMeshStorage(m_meshStorage.get());
+
+        // Component types that snapshots know about. The names end up in the file.
+        m_snapshot.SetMeshStorage(m_meshStorage.get());
+        m_snapshot.RegisterComponent<Transform>("Transform");
+        m_snapshot.RegisterComponent<Mesh>("Mesh", RemapMeshHandles);
 		// Call every function registered via addInitFunc ( only once)
         for (auto& f : m_initFuncs) {
-            try { f(*this); }
+            PROFILE_SCOPE(f.name);
+            AllocScope allocScope(AllocTag::User);
+            try { f.func(*this); }
             catch (...) { /* try to catch a error)) */ }
         }
+        ReportMeshMemory();
 
     }
     catch (...) {
-        MessageBoxW(nullptr, L"Core initialization failed", L"Error", MB_ICONERROR);
+        // Headless runs (benchmarks, CI) have nobody to close a message box.
+        if (m_headless)
+            std::fputs("Core initialization failed\n", stderr);
+        else
+            MessageBoxW(nullptr, L"Core initialization failed", L"Error", MB_ICONERROR);
         m_running = false;
         return *this;
     }
@@ -38,10 +104,82 @@ Core& Core::Init() {
 
 
 Core& Core::Run() {
-    while (m_running && m_window && m_window->ProcessMessages()) {
-		Time::Update();
-        Update();
-        Draw();
+    double last = Clock::Now();
+    bool firstFrame = true;
+    AllocTracker::EndFrame(); // what Init allocated is not part of frame 1
+    m_allocCheck.start = last;
+
+    while (m_running) {
+        PROFILE_FRAME();
+        if (m_window) {
+            PROFILE_SCOPE("ProcessMessages");
+            if (!m_window->ProcessMessages())
+                break;
+        }
+        {
+            PROFILE_SCOPE("Time::Update");
+            Time::Update();
+        }
+        HandleResize();
+
+        const Clock::Ticks nowTicks = Clock::NowTicks();
+        double now = Clock::ToSeconds(nowTicks);
+        double frameSeconds = now - last;
+        last = now;
+
+        // One frame = from here to here, including the limiter's wait.
+        if (!firstFrame) {
+            EndAllocationFrame();
+            m_frameStats.EndFrame(frameSeconds * 1000.0);
+            m_stageTimes.Add(FrameStage::Frame, frameSeconds * 1000.0);
+            m_stageTimes.EndFrame();
+            if (m_frameLimit && ++m_framesDone >= m_frameLimit)
+                break;
+        }
+        firstFrame = false;
+        m_frameMemory.BeginFrame();
+
+        // Tasks waiting for this frame (NextFrame, Delay, main thread) run
+        // before the functions from addFunc, once per frame even with a fixed timestep.
+        {
+            AllocScope allocScope(AllocTag::User);
+            StageScope stage{ m_stageTimes, FrameStage::Tasks };
+            m_tasks.Pump(now);
+        }
+
+        if (m_loop.fixedTimestep) {
+            // Catch up on simulation time in whole ticks, see FixedTimestep.h.
+            const uint32_t steps = m_timestep.Advance(frameSeconds);
+            const double step = m_timestep.StepSeconds();
+            for (uint32_t i = 0; i < steps; ++i) {
+                PROFILE_SCOPE("FixedTick");
+                StageScope stage{ m_stageTimes, FrameStage::Update };
+                // Each tick sees the input up to its own end, so the input of a
+                // frame that runs several ticks is spread over them in order.
+                const double secondsBehind = double(steps - 1 - i) * step;
+                ConsumeInput(nowTicks - Clock::Ticks(secondsBehind * 1e9));
+                m_history.Capture(*m_world);
+                Time::deltaTime = float(step);
+                Time::time = m_timestep.SimulationTime() - secondsBehind;
+                Update();
+            }
+            Draw(m_loop.interpolate ? &m_history : nullptr, m_timestep.Alpha());
+        }
+        else {
+            {
+                StageScope stage{ m_stageTimes, FrameStage::Update };
+                ConsumeInput(nowTicks);
+                Update();
+            }
+            Draw(nullptr, 1.0f);
+        }
+
+        m_latency.MarkPresent(Clock::Now());
+        UpdateFrameCounters();
+        {
+            PROFILE_SCOPE("FrameLimiter::Wait");
+            m_limiter.Wait();
+        }
     }
     return *this;
 }
@@ -53,23 +191,171 @@ Core& Core::Shutdown() {
     }
 
     m_window.reset();
+    m_jobs.reset();
+    // After the workers stopped: no task can be running anymore.
+    m_tasks.Shutdown();
     m_running = false;
 
     return *this;
 }
 
 
-Core& Core::addFunc(const std::function<void(Core&)>& func) {
-    m_funcs.push_back(func);
+Core& Core::addFunc(const std::function<void(Core&)>& func, const char* name) {
+    std::string zone = name ? name : "addFunc #" + std::to_string(m_funcs.size() + 1);
+    m_funcs.push_back({ func, Profiler::InternName(zone) });
+    return *this;
+}
+
+Core& Core::addInitFunc(const std::function<void(Core&)>& func, const char* name) {
+    std::string zone = name ? name : "addInitFunc #" + std::to_string(m_initFuncs.size() + 1);
+    m_initFuncs.push_back({ func, Profiler::InternName(zone) });
+    return *this;
+}
+
+Core& Core::enableAllocationCheck(double warmupSeconds, uint32_t checkedFrames) {
+    m_allocCheck = {};
+    m_allocCheck.enabled = true;
+    m_allocCheck.warmupSeconds = warmupSeconds;
+    m_allocCheck.checkedFrames = checkedFrames ? checkedFrames : 1;
+    return *this;
+}
+
+Core& Core::setHeadless(bool headless) {
+    m_headless = headless;
+    return *this;
+}
+
+Core& Core::setFrameLimit(uint64_t frames) {
+    m_frameLimit = frames;
+    m_framesDone = 0;
+    return *this;
+}
+
+Core& Core::setMeshMemoryReport(bool perMesh) {
+    m_meshReportPerMesh = perMesh;
+    return *this;
+}
+
+Core& Core::enableSpatialGrid(const SpatialGrid::Settings& settings) {
+    m_spatialGrid.SetSettings(settings);
+    m_spatialGridEnabled = true;
+    return *this;
+}
+
+Core& Core::enablePhysics(const PhysicsSettings& settings) {
+    m_physics.SetSettings(settings);
+    m_physicsEnabled = true;
+    return *this;
+}
+
+Core& Core::enableStreaming(const CellStreamer::Settings& settings, CellBuilder builder) {
+    m_streamer.SetSettings(settings);
+    m_streamer.SetBuilder(std::move(builder));
+    m_streamingEnabled = true;
     return *this;
 }
 
-Core& Core::addInitFunc(const std::function<void(Core&)>& func) {
-    m_initFuncs.push_back(func);
+Core& Core::setLoopSettings(const LoopSettings& settings) {
+    m_loop = settings;
+    m_timestep.SetSettings(settings.timestep);
+    m_limiter.SetTargetFps(settings.maxFps);
     return *this;
 }
 
 
+// Prints what vertex compression saved for every mesh (see VertexFormat.h).
+// Every draw of the mesh fetches the same ratio less data, so the
+// percentage is also the bandwidth saving.
+void Core::ReportMeshMemory() {
+    size_t rawTotal = 0, packedTotal = 0;
+    char line[160];
+
+    for (MeshHandle h = 1; h <= m_meshStorage->Count(); ++h) {
+        const VertexStreamStats& st = m_meshStorage->Get(h)->vertexStream.stats;
+        rawTotal += st.RawBytes();
+        packedTotal += st.PackedBytes();
+        if (!m_meshReportPerMesh)
+            continue;
+
+        snprintf(line, sizeof(line), "Mesh %u: %u verts, %u -> %u bytes/vertex, %zu -> %zu bytes (%.0f%% saved)\n",
+            h, st.vertexCount, st.rawStride, st.packedStride, st.RawBytes(), st.PackedBytes(), st.Savings() * 100.0f);
+        OutputDebugStringA(line);
+    }
+
+    snprintf(line, sizeof(line), "Vertex memory total: %zu meshes, %zu -> %zu bytes\n",
+        m_meshStorage->Count(), rawTotal, packedTotal);
+    OutputDebugStringA(line);
+}
+
+void Core::UpdateFrameCounters() {
+    const RenderStats& rs = m_renderQueue->GetStats();
+    const RendererStats& gpu = m_renderer->GetStats();
+
+    m_frameStats.Set(m_counterEntities, m_world->EntityCount());
+    m_frameStats.Add(m_counterItems, rs.items);
+    m_frameStats.Add(m_counterTriangles, rs.triangles);
+    m_frameStats.Add(m_counterSkinnedVertices, rs.skinnedVertices);
+    m_frameStats.Set(m_counterParticles, m_particles.GetStats().live);
+    m_frameStats.Set(m_counterCells, m_streamer.GetStats().resident);
+    m_frameStats.Add(m_counterDraws, gpu.draws);
+    m_frameStats.Add(m_counterUploadBytes, gpu.bytesUploaded);
+    m_frameStats.Set(m_counterUploadsPending, gpu.uploadsPending);
+    m_frameStats.Add(m_counterNotReady, gpu.notReady);
+    m_frameStats.Set(m_counterPasses, gpu.passes);
+    m_frameStats.Add(m_counterBarriers, gpu.barriers);
+    m_frameStats.Add(m_counterBindsIssued, gpu.bindsIssued);
+    m_frameStats.Add(m_counterBindsSkipped, gpu.bindsSkipped);
+    if (m_latency.Samples())
+        m_frameStats.Set(m_counterLatency, uint64_t(m_latency.LastMs() * 1000.0));
+    m_frameStats.Set(m_counterTasks, m_tasks.GetStats().running);
+}
+
+// Closes the allocation counts of the frame that just ended, publishes them
+// as counters and runs the zero-allocation check (enableAllocationCheck).
+void Core::EndAllocationFrame() {
+    AllocTracker::EndFrame();
+    for (size_t t = 0; t < size_t(AllocTag::Count); ++t) {
+        const AllocTagStats s = AllocTracker::GetStats(AllocTag(t));
+        m_frameStats.Add(m_counterAllocs[t], s.frameCount);
+        m_frameStats.Add(m_counterAllocBytes[t], s.frameBytes);
+    }
+
+    AllocationCheck& check = m_allocCheck;
+    if (!check.enabled || Clock::Now() - check.start < check.warmupSeconds)
+        return;
+
+    // No std::string here: the report must not allocate itself.
+    char line[256];
+    if (!AllocTracker::Enabled || AllocTracker::FrameAllocations() > 0) {
+        check.failed = true;
+        if (!AllocTracker::Enabled)
+            snprintf(line, sizeof(line), "Allocation check FAILED: tracking is compiled out (define DREIVY_ALLOC_TRACKING=1)\n");
+        else
+            snprintf(line, sizeof(line), "Allocation check FAILED after %u clean frames: %llu allocations this frame\n",
+                check.cleanFrames, static_cast<unsigned long long>(AllocTracker::FrameAllocations()));
+        OutputDebugStringA(line);
+        std::fputs(line, stderr);
+        for (size_t t = 0; t < size_t(AllocTag::Count); ++t) {
+            const AllocTagStats s = AllocTracker::GetStats(AllocTag(t));
+            if (s.frameCount == 0) continue;
+            snprintf(line, sizeof(line), "  %-8s %llu allocations, %llu bytes\n", AllocTracker::TagName(AllocTag(t)),
+                static_cast<unsigned long long>(s.frameCount), static_cast<unsigned long long>(s.frameBytes));
+            OutputDebugStringA(line);
+            std::fputs(line, stderr);
+        }
+    }
+    else if (++check.cleanFrames >= check.checkedFrames) {
+        snprintf(line, sizeof(line), "Allocation check passed: %u frames without a heap allocation\n", check.cleanFrames);
+        OutputDebugStringA(line);
+        std::fputs(line, stderr);
+    }
+    else {
+        return;
+    }
+    check.enabled = false;
+    m_running = false;
+}
+
 void Core::InitWindow() {
     WindowManager::Config cfg;
     cfg.title = L"Dreivy!";
@@ -83,9 +369,18 @@ void Core::InitWindow() {
 }
 
 bool Core::InitSystem() {
-    m_renderer = std::make_unique<Renderer>();
-    if (!m_renderer->Init(m_window->GetHWND(), m_window->GetWidth(), m_window->GetHeight()))
+    if (m_headless) {
+        auto renderer = std::make_unique<NullRenderer>();
+        renderer->Resize(HeadlessWidth, HeadlessHeight);
+        m_renderer = std::move(renderer);
+        return true;
+    }
+
+    auto renderer = std::make_unique<Renderer>();
+    renderer->SetJobSystem(m_jobs.get());
+    if (!renderer->Init(m_window->GetHWND(), m_window->GetWidth(), m_window->GetHeight()))
         return false;
+    m_renderer = std::move(renderer);
     return true;
 }
 
@@ -110,45 +405,143 @@ void Core::SetupCallbacks() {
         }
     );
 
-    // Keyboard
-    m_window->SetKeyCallback(
-        [](uint32_t key, bool pressed) {
-            if (key == VK_ESCAPE && pressed)
-                PostQuitMessage(0);
-        }
-    );
-
-    // Mouse move
-    m_window->SetMouseMoveCallback(
-        [](int x, int y, int dx, int dy) {
-            
-        }
-    );
+    // Keyboard and mouse are not callbacks anymore: see ConsumeInput.
 }
 
 
-void Core::Update() {
+void Core::HandleResize() {
     //if resize is needed we call renderer to resize.
 	if (Resize_t.IsNeedResize && m_renderer) {
         m_renderer->Resize(Resize_t.width, Resize_t.height);
         Resize_t.IsNeedResize = false;
     }
+}
+
+
+// Applies the queued input up to `until` (see Input/InputState.h) and
+// handles the engine's own keys.
+void Core::ConsumeInput(Clock::Ticks until) {
+    PROFILE_SCOPE("ConsumeInput");
+    if (!m_window)
+        return; // headless: nothing produces input
+    const uint32_t count = m_input.Consume(m_window->GetInputQueue(), until);
+    if (count == 0)
+        return;
+    m_frameStats.Add(m_counterInputEvents, count);
+
+    // The oldest event has waited the longest, see LatencyTracker.h
+    m_latency.MarkInput(Clock::ToSeconds(m_input.Events()[0].time));
+
+    if (m_input.IsKeyPressed(VK_ESCAPE))
+        PostQuitMessage(0);
+    // F9: last frame's render graph, its passes, barriers and memory saved
+    if (m_input.IsKeyPressed(VK_F9)) {
+        const std::string dump = m_renderer->GetGraph().Dump();
+        OutputDebugStringA(dump.c_str());
+        std::fputs(dump.c_str(), stderr);
+    }
+#if DREIVY_PROFILER
+    // F11: the next 120 frames, open in chrome://tracing or ui.perfetto.dev
+    if (m_input.IsKeyPressed(VK_F11))
+        Profiler::CaptureFrames("Trace.json", 120);
+#endif
+}
+
+
+void Core::Update() {
+    PROFILE_SCOPE("Update");
+    {
+        // A new tick: last tick's events become the older half.
+        PROFILE_SCOPE("Events::Update");
+        m_events.Update();
+        m_frameStats.Add(m_counterEvents, m_events.WrittenLastTick());
+    }
+    // Before anything reads the world this tick, so the grid sees new cells.
+    if (m_streamingEnabled) {
+        PROFILE_SCOPE("Streaming");
+        AllocScope allocScope(AllocTag::ECS);
+        m_streamer.Update(*m_world, m_camera.position);
+        m_frameStats.Add(m_counterStreamBytes, m_streamer.GetStats().mergedBytes);
+    }
+    if (m_spatialGridEnabled) {
+        PROFILE_SCOPE("SpatialGrid::Update");
+        AllocScope allocScope(AllocTag::ECS);
+        m_spatialGrid.Update(*m_world);
+    }
 	// Call every function registered via addFunc
     for (auto& f : m_funcs) {
-        try { f(*this); }
+        PROFILE_SCOPE(f.name);
+        AllocScope allocScope(AllocTag::User);
+        try { f.func(*this); }
         catch (...) {  }
     }
+    // Sync point: what the callbacks' jobs recorded becomes real before the systems run.
+    if (!m_commands.Empty()) {
+        PROFILE_SCOPE("EntityCommands::Playback");
+        AllocScope allocScope(AllocTag::ECS);
+        m_commands.Playback(*m_world);
+    }
+    if (m_physicsEnabled) {
+        PROFILE_SCOPE("Physics");
+        AllocScope allocScope(AllocTag::ECS);
+        m_physics.Step(Time::deltaTime);
+        m_physics.WriteTransforms(*m_world);
+    }
+    {
+        PROFILE_SCOPE("Animation");
+        AllocScope allocScope(AllocTag::ECS);
+        m_animationSystem.Update(*m_world, Time::deltaTime);
+    }
+    {
+        PROFILE_SCOPE("Particles");
+        AllocScope allocScope(AllocTag::ECS);
+        m_particles.Update(Time::deltaTime);
+    }
     // TODO  game logic
 }
 
 
-void Core::Draw() {
+void Core::Draw(const TransformHistory* history, float alpha) {
     if (!m_renderer) return;
+    PROFILE_SCOPE("Draw");
+    AllocScope allocScope(AllocTag::Render);
     m_renderQueue->Clear();
-    BuildRenderQueue(*m_world, *m_renderQueue);
+    const float width = float(m_window ? m_window->GetWidth() : HeadlessWidth);
+    const float height = float(m_window ? m_window->GetHeight() : HeadlessHeight);
+    RenderView view = BuildRenderView(m_camera, width, height);
+    {
+        PROFILE_SCOPE("BuildRenderQueue");
+        StageScope stage{ m_stageTimes, FrameStage::BuildQueue };
+        BuildRenderQueue(*m_world, *m_renderQueue, *m_meshStorage, view, m_lodSelector, m_clusterCuller, history, alpha);
+    }
+    {
+        PROFILE_SCOPE("StaticBatches::Submit");
+        StageScope stage{ m_stageTimes, FrameStage::BuildQueue };
+        m_staticBatches.Submit(*m_world, *m_renderQueue, view);
+    }
+    {
+        PROFILE_SCOPE("Animation::Skin");
+        StageScope stage{ m_stageTimes, FrameStage::BuildQueue };
+        m_animationSystem.Skin(*m_world, *m_meshStorage, *m_renderQueue, view, &m_lodSelector, history, alpha);
+    }
+    {
+        PROFILE_SCOPE("Particles::Submit");
+        StageScope stage{ m_stageTimes, FrameStage::BuildQueue };
+        m_particles.Submit(*m_meshStorage, *m_renderQueue, view);
+    }
+
+    m_renderer->SetCamera(m_camera);
    
 
-    m_renderer->BeginFrame(0.1f, 0.1f, 0.15f, 1.0f);
-    m_renderer->Draw(*m_renderQueue);
-    m_renderer->EndFrame();
+    {
+        PROFILE_SCOPE("Renderer::Draw");
+        StageScope stage{ m_stageTimes, FrameStage::Draw };
+        m_renderer->BeginFrame(0.1f, 0.1f, 0.15f, 1.0f);
+        m_renderer->Draw(*m_renderQueue);
+    }
+    {
+        PROFILE_SCOPE("EndFrame/Present");
+        StageScope stage{ m_stageTimes, FrameStage::Present };
+        m_renderer->EndFrame();
+    }
 }
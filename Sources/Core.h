@@ -5,16 +5,54 @@
 #include <functional>
 #include "WindowManager/WindowManager.h"
 #include "Renderer/Renderer.h"
+#include "Renderer/RenderBackend.h"
 #include "Renderer/RenderQueue.h"
 #include "World/ECS/World.h"
+#include "World/ECS/WorldSnapshot.h"
+#include "World/ECS/EntityCommands.h"
+#include "Events/EventBus.h"
 #include "World/ECS/System/RendererBuilder.h"
+#include "World/ECS/System/LodSelector.h"
+#include "World/ECS/System/TransformHistory.h"
+#include "World/ECS/System/SpatialGrid.h"
+#include "World/ECS/System/StaticBatcher.h"
+#include "World/Streaming/CellStreamer.h"
+#include "Physics/PhysicsWorld.h"
+#include "Animation/AnimationSystem.h"
+#include "Particles/ParticleSystem.h"
 #include "Renderer/MeshStorage.h"
+#include "Renderer/Camera.h"
+#include "Renderer/ClusterCulling.h"
+#include "Threading/JobSystem.h"
+#include "Timing/FixedTimestep.h"
+#include "Timing/FrameLimiter.h"
+#include "Timing/LatencyTracker.h"
+#include "Timing/FrameStats.h"
+#include "Timing/StageTimes.h"
+#include "Profiling/Profiler.h"
+#include "Tasks/TaskScheduler.h"
+#include "Input/InputState.h"
+#include "Memory/AllocTracker.h"
+#include "Memory/LinearAllocator.h"
 
 struct RendererResizeEvent {
     uint32_t width;
     uint32_t height;
 	bool IsNeedResize = false;
 };
+// How Run() paces Update and Draw.
+struct LoopSettings {
+    // false: one Update per Draw with a variable Time::deltaTime.
+    // true : functions from addFunc run at timestep.ticksPerSecond with a fixed
+    //        Time::deltaTime (0..maxStepsPerFrame times per frame), and frames
+    //        draw transforms interpolated between the last two ticks.
+    bool fixedTimestep = false;
+    FixedTimestepSettings timestep;
+    bool interpolate = true;
+
+    double maxFps = 0.0; // 0 = no limit, see FrameLimiter
+};
+
 class Core {
 public:
     Core() = default;
@@ -26,31 +64,157 @@ public:
     Core& Shutdown();
 
     
-	Core& addFunc(const std::function<void(Core&)>& func);       // For Update(every frame)
-	Core& addInitFunc(const std::function<void(Core&)>& func);   // For Init(only once after Init)
+	// `name` is the profiler zone of the function (default "addFunc #N")
+	Core& addFunc(const std::function<void(Core&)>& func, const char* name = nullptr);       // For Update(every frame)
+	Core& addInitFunc(const std::function<void(Core&)>& func, const char* name = nullptr);   // For Init(only once after Init)
+    Core& setLoopSettings(const LoopSettings& settings);
+
+    // Test mode: after `warmupSeconds`, every frame must make zero heap
+    // allocations (see Memory/AllocTracker.h). The first frame that allocates
+    // stops Run() and reports per tag; after `checkedFrames` clean frames
+    // Run() stops too. Needs allocation tracking compiled in (debug builds).
+    Core& enableAllocationCheck(double warmupSeconds = 5.0, uint32_t checkedFrames = 600);
+    bool allocationCheckFailed() const { return m_allocCheck.failed; }
+
+    // Before Init: no window and no GPU. The frame loop runs as usual with a
+    // NullRenderer as backend and a 1280x720 view; there is no input.
+    Core& setHeadless(bool headless);
+    // Run() returns after this many frames (0 = until the window closes).
+    Core& setFrameLimit(uint64_t frames);
+    // After the init functions, Init prints the packed vertex memory of all
+    // meshes; `perMesh` adds one line per mesh (long with many meshes).
+    Core& setMeshMemoryReport(bool perMesh);
+
+    // Keeps getSpatialGrid() up to date with the Transforms: updated before
+    // the functions from addFunc, every tick.
+    Core& enableSpatialGrid(const SpatialGrid::Settings& settings = {});
+    // Steps getPhysics() after the functions from addFunc, every tick, and
+    // writes the body positions into their Transforms.
+    Core& enablePhysics(const PhysicsSettings& settings = {});
+    // Loads the cells around getCamera() into getWorld() and drops the far
+    // ones, at the start of every tick; `builder` fills a cell on a worker.
+    Core& enableStreaming(const CellStreamer::Settings& settings, CellBuilder builder);
 
     WindowManager* getWindow() { return m_window.get(); }
-    Renderer* getRenderer() { return m_renderer.get(); }
+    RenderBackend* getRenderer() { return m_renderer.get(); }
     World* getWorld() { return m_world.get(); }
     const World* getWorld() const { return m_world.get(); }
     MeshStorage* getMeshStorage() { return m_meshStorage.get(); }
     const MeshStorage* getMeshStorage() const { return m_meshStorage.get(); }
+    Camera& getCamera() { return m_camera; }
+    LodSelector& getLodSelector() { return m_lodSelector; }
+    ClusterCuller& getClusterCuller() { return m_clusterCuller; }
+    const SpatialGrid& getSpatialGrid() const { return m_spatialGrid; } // empty unless enableSpatialGrid
+    PhysicsWorld& getPhysics() { return m_physics; } // add bodies here, see enablePhysics
+    const CellStreamer& getStreamer() const { return m_streamer; } // cells and hitch stats, see enableStreaming
+    AnimationStorage& getAnimations() { return m_animations; } // skeletons and clips for Animator components
+    AnimationSystem& getAnimationSystem() { return m_animationSystem; } // poses after addFunc, skins while drawing
+    ParticleSystem& getParticles() { return m_particles; } // emitters, one instanced draw each
+    StaticBatcher& getStaticBatches() { return m_staticBatches; } // Build once after loading the level
+    JobSystem* getJobs() { return m_jobs.get(); }
+    EntityCommands& getCommands() { return m_commands; } // create / destroy from jobs, applied after addFunc
+    EventBus& getEvents() { return m_events; } // typed events between systems, swapped every tick
+    WorldSnapshot& getSnapshot() { return m_snapshot; } // Save/Load of getWorld()
+    const FixedTimestep& getTimestep() const { return m_timestep; }
+    const LatencyTracker& getLatency() const { return m_latency; } // input -> Present
+    FrameStats& getFrameStats() { return m_frameStats; }
+    StageTimes& getStageTimes() { return m_stageTimes; } // per stage of the frame, see FrameStage
+    TaskScheduler& getTasks() { return m_tasks; } // coroutines, see Tasks/Task.h
+    const InputState& getInput() const { return m_input; } // keyboard / mouse as of this tick
+    FrameAllocator& getFrameAllocator() { return m_frameMemory; } // scratch memory for this (and the next) frame
+    const RenderQueue* getRenderQueue() const { return m_renderQueue.get(); } // stats of the last frame
 private:
+    struct Callback {
+        std::function<void(Core&)> func;
+        const char* name; // interned, see Profiler::InternName
+    };
+
     void InitWindow();
     bool InitSystem();
     void SetupCallbacks();
+    void ReportMeshMemory();
+    void UpdateFrameCounters();
+    void EndAllocationFrame();
 
+    void HandleResize();
+    void ConsumeInput(Clock::Ticks until);
     void Update();
-    void Draw();
+    void Draw(const TransformHistory* history, float alpha);
 
 private:
     std::unique_ptr<WindowManager> m_window;
-    std::unique_ptr<Renderer>      m_renderer;
+    std::unique_ptr<RenderBackend> m_renderer;
 	std::unique_ptr< RenderQueue> m_renderQueue;
     std::unique_ptr<MeshStorage>   m_meshStorage;
+    std::unique_ptr<JobSystem>     m_jobs;
+    Camera m_camera;
+    LodSelector m_lodSelector;
+    ClusterCuller m_clusterCuller;
+    SpatialGrid m_spatialGrid;
+    bool m_spatialGridEnabled = false;
+    PhysicsWorld m_physics;
+    bool m_physicsEnabled = false;
+    CellStreamer m_streamer;
+    bool m_streamingEnabled = false;
+    bool m_meshReportPerMesh = false;
+    AnimationStorage m_animations;
+    AnimationSystem m_animationSystem;
+    ParticleSystem m_particles;
+    StaticBatcher m_staticBatches;
+    WorldSnapshot m_snapshot;
+    EntityCommands m_commands;
+    EventBus m_events;
+    LoopSettings m_loop;
+    FixedTimestep m_timestep;
+    TransformHistory m_history;
+    FrameLimiter m_limiter;
+    LatencyTracker m_latency;
+    FrameStats m_frameStats;
+    StageTimes m_stageTimes;
+    TaskScheduler m_tasks;
+    InputState m_input;
+    FrameAllocator m_frameMemory{ 256 * 1024, AllocTag::User };
+
+    struct AllocationCheck {
+        bool enabled = false;
+        double warmupSeconds = 0.0;
+        uint32_t checkedFrames = 0;
+        uint32_t cleanFrames = 0;
+        double start = 0.0;
+        bool failed = false;
+    };
+    AllocationCheck m_allocCheck;
+
+    // Built-in counters, see UpdateFrameCounters
+    CounterId m_counterEntities = 0;
+    CounterId m_counterItems = 0;
+    CounterId m_counterTriangles = 0;
+    CounterId m_counterSkinnedVertices = 0;
+    CounterId m_counterParticles = 0;
+    CounterId m_counterEvents = 0;
+    CounterId m_counterCells = 0;
+    CounterId m_counterStreamBytes = 0;
+    CounterId m_counterDraws = 0;
+    CounterId m_counterUploadBytes = 0;
+    CounterId m_counterUploadsPending = 0;
+    CounterId m_counterNotReady = 0;
+    CounterId m_counterPasses = 0;
+    CounterId m_counterBarriers = 0;
+    CounterId m_counterBindsIssued = 0;
+    CounterId m_counterBindsSkipped = 0;
+    CounterId m_counterLatency = 0;
+    CounterId m_counterTasks = 0;
+    CounterId m_counterInputEvents = 0;
+    CounterId m_counterAllocs[size_t(AllocTag::Count)]{};
+    CounterId m_counterAllocBytes[size_t(AllocTag::Count)]{};
     bool m_running = false;
+    bool m_headless = false;
+    uint64_t m_frameLimit = 0;
+    uint64_t m_framesDone = 0;
+    static constexpr uint32_t HeadlessWidth = 1280;
+    static constexpr uint32_t HeadlessHeight = 720;
     RendererResizeEvent Resize_t;
     std::unique_ptr<World> m_world;
-	std::vector<std::function<void(Core&)>> m_funcs;      //  being called every frame in Run
-	std::vector<std::function<void(Core&)>> m_initFuncs;  // called once at Init, after systems are initialized
+	std::vector<Callback> m_funcs;      //  being called every frame in Run
+	std::vector<Callback> m_initFuncs;  // called once at Init, after systems are initialized
 };
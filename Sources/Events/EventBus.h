@@ -0,0 +1,110 @@
+#pragma once
+#include <cassert>
+#include <memory>
+#include "EventChannel.h"
+
+// A small number per event type, like ComponentTypeId.
+inline uint32_t NextEventTypeId() {
+    static std::atomic<uint32_t> next{ 0 };
+    return next++;
+}
+
+template<typename T>
+uint32_t EventTypeId() {
+    static const uint32_t id = NextEventTypeId();
+    return id;
+}
+
+/*
+ * EventBus
+ * One EventChannel per event type, so systems can tell each other things
+ * ("these two collided", "spawn this here") without globals or knowing
+ * about each other:
+ *
+ *   struct DamageEvent { Entity target; float amount; };
+ *   core.getEvents().Register<DamageEvent>(16384);     // at init
+ *
+ *   // any system, any thread
+ *   events.Write(DamageEvent{ e, 10.0f });
+ *
+ *   // the health system keeps its reader between ticks
+ *   EventReader m_damage = events.Channel<DamageEvent>().NewReader();
+ *   events.Read<DamageEvent>(m_damage).ForEach([&](const DamageEvent& d) { ... });
+ *
+ * Only Register creates channels, and it allocates: register every type
+ * at init, before any job writes. Channel, Write and Read never add one
+ * (so no thread grows the table while another looks a channel up); on a
+ * type that wasn't registered they assert, and in release Write drops
+ * the event and Read returns nothing.
+ * Core calls Update() at the start of every tick.
+ */
+class EventBus {
+public:
+    template<typename T>
+    EventChannel<T>& Register(uint32_t capacity = 1024) {
+        const uint32_t id = EventTypeId<T>();
+        AllocScope scope(AllocTag::ECS);
+        if (id >= m_channels.size())
+            m_channels.resize(size_t(id) + 1);
+        if (!m_channels[id])
+            m_channels[id] = std::make_unique<EventChannel<T>>(capacity);
+        return static_cast<EventChannel<T>&>(*m_channels[id]);
+    }
+
+    // T must have been registered.
+    template<typename T>
+    EventChannel<T>& Channel() {
+        EventChannel<T>* channel = Find<T>();
+        assert(channel && "event type used before Register");
+        return *channel;
+    }
+
+    // nullptr if T was never registered.
+    template<typename T>
+    const EventChannel<T>* FindChannel() const {
+        return const_cast<EventBus*>(this)->Find<T>();
+    }
+
+    template<typename T>
+    bool Write(const T& e) {
+        EventChannel<T>* channel = Find<T>();
+        assert(channel && "event type written before Register");
+        return channel && channel->Write(e);
+    }
+
+    template<typename T>
+    EventBatch<T> Read(EventReader& reader) {
+        EventChannel<T>* channel = Find<T>();
+        assert(channel && "event type read before Register");
+        return channel ? channel->Read(reader) : EventBatch<T>{};
+    }
+
+    // Swaps every channel: the start of a new tick.
+    void Update() {
+        m_written = m_dropped = 0;
+        for (auto& channel : m_channels) {
+            if (!channel) continue;
+            channel->Update();
+            m_written += channel->GetStats().written;
+            m_dropped += channel->GetStats().dropped;
+        }
+    }
+
+    // Over all channels, in the tick before the last Update.
+    uint64_t WrittenLastTick() const { return m_written; }
+    uint64_t DroppedLastTick() const { return m_dropped; }
+
+private:
+    template<typename T>
+    EventChannel<T>* Find() {
+        const uint32_t id = EventTypeId<T>();
+        if (id >= m_channels.size() || !m_channels[id])
+            return nullptr;
+        return static_cast<EventChannel<T>*>(m_channels[id].get());
+    }
+
+private:
+    EcsVector<std::unique_ptr<IEventChannel>> m_channels; // indexed by EventTypeId<T>()
+    uint64_t m_written = 0;
+    uint64_t m_dropped = 0;
+};
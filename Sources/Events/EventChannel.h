@@ -0,0 +1,180 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include "World/ECS/ComponentPool.h"
+
+struct EventChannelStats {
+    uint32_t written = 0;   // during the last tick
+    uint32_t dropped = 0;   // during the last tick, because the buffer was full
+    uint32_t capacity = 0;  // per tick, grows after a tick that dropped events
+    uint32_t peak = 0;      // most events asked for in one tick
+};
+
+// Where one reader is in one channel: the sequence number of the next event
+// it hasn't seen. Get one from EventChannel::NewReader().
+struct EventReader {
+    uint64_t cursor = 0;
+    uint64_t missed = 0; // events that were gone before this reader came back
+};
+
+// What one Read returned: the rest of the last tick, then this tick so far.
+template<typename T>
+struct EventBatch {
+    const T* data[2] = { nullptr, nullptr };
+    uint32_t count[2] = { 0, 0 };
+
+    uint32_t Size() const { return count[0] + count[1]; }
+    bool Empty() const { return Size() == 0; }
+    const T& operator[](uint32_t i) const { return i < count[0] ? data[0][i] : data[1][i - count[0]]; }
+
+    template<typename Fn>
+    void ForEach(Fn&& fn) const {
+        for (int s = 0; s < 2; ++s)
+            for (uint32_t i = 0; i < count[s]; ++i)
+                fn(data[s][i]);
+    }
+};
+
+class IEventChannel {
+public:
+    virtual ~IEventChannel() = default;
+    virtual void Update() = 0;
+    virtual const EventChannelStats& GetStats() const = 0;
+};
+
+/*
+ * EventChannel<T>
+ * Events of one type, e.g. every collision of this tick, from any thread.
+ *
+ * Two arrays: the events of the current tick and those of the last tick.
+ * Update() (once per tick, see EventBus) drops the older array and starts
+ * writing into it again, so an event lives for two ticks and a system can
+ * read what was written after it ran in the last tick.
+ *
+ * Writing takes one atomic add to claim a slot (or a whole block of slots
+ * for WriteBatch), then a plain copy: no locks, any number of threads.
+ * The array is never resized while writing. When it is full the event is
+ * dropped and counted, and Update() makes the next tick's array big enough
+ * for what was asked for. After a few ticks nothing allocates anymore.
+ *
+ * Every event has a sequence number (written events counted from the
+ * start), and every reader keeps its own cursor, so any number of systems
+ * read the same events independently, each exactly once.
+ *
+ * Reading doesn't wait for writers: don't read a channel while a job may
+ * still write to it (e.g. read after the ParallelFor that writes returned).
+ *
+ * T must be trivially copyable; keep it small.
+ */
+template<typename T>
+class EventChannel : public IEventChannel {
+    static_assert(std::is_trivially_copyable_v<T>, "events are copied around as raw bytes");
+
+public:
+    explicit EventChannel(uint32_t capacity = 1024) {
+        m_stats.capacity = std::max(capacity, 1u);
+        m_buffers[0].resize(m_stats.capacity);
+        m_buffers[1].resize(m_stats.capacity);
+        m_writeCapacity = m_stats.capacity;
+    }
+
+    // ---- writers, any thread ----
+
+    // False if this tick's array is full; the event is lost.
+    bool Write(const T& e) {
+        const uint32_t i = m_count.fetch_add(1, std::memory_order_relaxed);
+        if (i >= m_writeCapacity)
+            return false;
+        m_buffers[m_current][i] = e;
+        return true;
+    }
+
+    // `count` events with one atomic add. Returns how many fit.
+    uint32_t WriteBatch(const T* events, uint32_t count) {
+        if (count == 0)
+            return 0;
+        const uint32_t first = m_count.fetch_add(count, std::memory_order_relaxed);
+        if (first >= m_writeCapacity)
+            return 0;
+        const uint32_t n = std::min(count, m_writeCapacity - first);
+        std::copy(events, events + n, m_buffers[m_current].data() + first);
+        return n;
+    }
+
+    // ---- readers, while nobody writes ----
+
+    // Starts at the oldest event still kept.
+    EventReader NewReader() const { return EventReader{ m_previousStart, 0 }; }
+    // Starts after everything written so far.
+    EventReader NewReaderAtEnd() const { return EventReader{ End(), 0 }; }
+
+    // Everything `reader` hasn't seen yet; moves its cursor to the end.
+    EventBatch<T> Read(EventReader& reader) const {
+        EventBatch<T> batch;
+        if (reader.cursor < m_previousStart) {
+            reader.missed += m_previousStart - reader.cursor;
+            reader.cursor = m_previousStart;
+        }
+        if (reader.cursor < m_currentStart) {
+            batch.data[0] = m_buffers[m_current ^ 1].data() + (reader.cursor - m_previousStart);
+            batch.count[0] = static_cast<uint32_t>(m_currentStart - reader.cursor);
+            reader.cursor = m_currentStart;
+        }
+        const uint64_t end = End();
+        if (reader.cursor < end) {
+            batch.data[1] = m_buffers[m_current].data() + (reader.cursor - m_currentStart);
+            batch.count[1] = static_cast<uint32_t>(end - reader.cursor);
+            reader.cursor = end;
+        }
+        return batch;
+    }
+
+    // Events of this tick so far / of the last tick, without a reader.
+    uint32_t CurrentCount() const { return std::min(m_count.load(std::memory_order_relaxed), m_writeCapacity); }
+    const T* CurrentData() const { return m_buffers[m_current].data(); }
+    uint32_t PreviousCount() const { return static_cast<uint32_t>(m_currentStart - m_previousStart); }
+    const T* PreviousData() const { return m_buffers[m_current ^ 1].data(); }
+
+    // ---- once per tick, while nobody writes or reads ----
+
+    void Update() override {
+        const uint32_t asked = m_count.load(std::memory_order_relaxed);
+        const uint32_t written = std::min(asked, m_writeCapacity);
+        m_stats.written = written;
+        m_stats.dropped = asked - written;
+        m_stats.peak = std::max(m_stats.peak, asked);
+
+        // The current tick becomes the last one, the older array is reused.
+        m_previousStart = m_currentStart;
+        m_currentStart += written;
+        m_current ^= 1;
+        m_count.store(0, std::memory_order_relaxed);
+
+        // Too small last tick: make room for at least that much (and some),
+        // so the same load doesn't drop again.
+        if (asked > m_stats.capacity)
+            m_stats.capacity = std::max(asked + asked / 2, m_stats.capacity * 2);
+        if (m_buffers[m_current].size() < m_stats.capacity) {
+            AllocScope scope(AllocTag::ECS);
+            m_buffers[m_current].resize(m_stats.capacity);
+        }
+        m_writeCapacity = static_cast<uint32_t>(m_buffers[m_current].size());
+    }
+
+    const EventChannelStats& GetStats() const override { return m_stats; }
+
+private:
+    uint64_t End() const { return m_currentStart + CurrentCount(); }
+
+private:
+    EcsVector<T> m_buffers[2];
+    uint32_t m_current = 0;         // the array written this tick
+    uint32_t m_writeCapacity = 0;   // its size
+    uint64_t m_currentStart = 0;    // sequence number of its first event
+    uint64_t m_previousStart = 0;   // same for the other array
+
+    alignas(64) std::atomic<uint32_t> m_count{ 0 }; // slots claimed this tick, may exceed the capacity
+    alignas(64) EventChannelStats m_stats;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include "Threading/SpscQueue.h"
+#include "Timing/Clock.h"
+
+/*
+ * InputEvent
+ * One keyboard / mouse event as the window received it, 16 bytes.
+ * The window procedure only fills these in and pushes them into an
+ * InputQueue; all game-side handling happens later, per simulation tick
+ * (see InputState.h). So a 1000 Hz mouse costs the message pump a few
+ * stores per message and never runs game code.
+ */
+enum class InputEventType : uint8_t {
+    KeyDown,     // code = virtual key (VK_*); repeats while held
+    KeyUp,
+    MouseDown,   // code = button: 0 left, 1 right, 2 middle
+    MouseUp,
+    MouseMove,   // x, y = cursor position in client pixels
+    MouseWheel,  // wheel = delta, 120 per notch
+    FocusLost    // the window was deactivated: every key / button counts as released
+};
+
+struct InputEvent {
+    Clock::Ticks time = 0; // Clock::NowTicks() when the window got it
+    InputEventType type = InputEventType::KeyDown;
+    uint8_t code = 0;
+    int16_t wheel = 0;
+    int16_t x = 0;         // cursor position at the time of the event
+    int16_t y = 0;
+};
+static_assert(sizeof(InputEvent) == 16, "InputEvent should stay compact");
+
+// Window (producer) -> simulation (consumer). 4096 events is over a second
+// of an 8 kHz mouse, far more than one frame can produce.
+using InputQueue = SpscQueue<InputEvent, 4096>;
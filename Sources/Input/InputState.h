@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+#include "InputEvent.h"
+
+/*
+ * InputState
+ * What the game reads: keys, mouse buttons, cursor, wheel, as of the current
+ * simulation tick. Only changes inside Consume(), so it can't change halfway
+ * through a tick even if the events are produced on another thread.
+ *
+ * Consume(queue, until) starts a new tick and applies every queued event that
+ * happened up to `until`. With a fixed timestep Core calls it once per tick
+ * with the tick's end time, so when a frame runs 3 ticks, a key pressed during
+ * the frame lands in the tick it belongs to, not all in the first one.
+ *
+ * Pressed / Released are "happened during this tick", so a tap shorter than a
+ * tick still shows up as both Pressed and Released.
+ */
+class InputState {
+public:
+    static constexpr uint32_t KeyCount = 256;
+    static constexpr uint32_t MouseButtonCount = 3;
+
+    InputState() { m_events.reserve(256); }
+
+    // Returns the number of events applied.
+    uint32_t Consume(InputQueue& queue, Clock::Ticks until) {
+        BeginTick();
+        while (const InputEvent* e = queue.Peek()) {
+            if (e->time > until)
+                break; // belongs to a later tick
+            Apply(*e);
+            m_events.push_back(*e);
+            queue.Pop();
+        }
+        return uint32_t(m_events.size());
+    }
+
+    // This tick's events in the order they happened (text input, combos, ...).
+    std::span<const InputEvent> Events() const { return m_events; }
+
+    bool IsKeyDown(uint32_t key) const { return key < KeyCount && m_keys[key]; }
+    bool IsKeyPressed(uint32_t key) const { return key < KeyCount && m_keyPressed[key]; }
+    bool IsKeyReleased(uint32_t key) const { return key < KeyCount && m_keyReleased[key]; }
+
+    bool IsMouseButtonDown(uint32_t b) const { return b < MouseButtonCount && m_buttons[b]; }
+    bool IsMouseButtonPressed(uint32_t b) const { return b < MouseButtonCount && m_buttonPressed[b]; }
+    bool IsMouseButtonReleased(uint32_t b) const { return b < MouseButtonCount && m_buttonReleased[b]; }
+
+    int32_t MouseX() const { return m_mouseX; }
+    int32_t MouseY() const { return m_mouseY; }
+    int32_t MouseDeltaX() const { return m_deltaX; } // this tick
+    int32_t MouseDeltaY() const { return m_deltaY; }
+    int32_t Wheel() const { return m_wheel; }        // this tick, 120 per notch
+
+private:
+    void BeginTick() {
+        m_events.clear();
+        std::memset(m_keyPressed, 0, sizeof(m_keyPressed));
+        std::memset(m_keyReleased, 0, sizeof(m_keyReleased));
+        std::memset(m_buttonPressed, 0, sizeof(m_buttonPressed));
+        std::memset(m_buttonReleased, 0, sizeof(m_buttonReleased));
+        m_deltaX = m_deltaY = 0;
+        m_wheel = 0;
+    }
+
+    void Apply(const InputEvent& e) {
+        switch (e.type) {
+        case InputEventType::KeyDown:
+            if (!m_keys[e.code]) m_keyPressed[e.code] = true; // not for auto-repeat
+            m_keys[e.code] = true;
+            break;
+        case InputEventType::KeyUp:
+            if (m_keys[e.code]) m_keyReleased[e.code] = true;
+            m_keys[e.code] = false;
+            break;
+        case InputEventType::MouseDown:
+            if (e.code >= MouseButtonCount) break;
+            if (!m_buttons[e.code]) m_buttonPressed[e.code] = true;
+            m_buttons[e.code] = true;
+            break;
+        case InputEventType::MouseUp:
+            if (e.code >= MouseButtonCount) break;
+            if (m_buttons[e.code]) m_buttonReleased[e.code] = true;
+            m_buttons[e.code] = false;
+            break;
+        case InputEventType::MouseMove:
+            // The first position is where the cursor is, not a movement.
+            if (m_hasMouse) {
+                m_deltaX += e.x - m_mouseX;
+                m_deltaY += e.y - m_mouseY;
+            }
+            m_mouseX = e.x;
+            m_mouseY = e.y;
+            m_hasMouse = true;
+            break;
+        case InputEventType::MouseWheel:
+            m_wheel += e.wheel;
+            break;
+        case InputEventType::FocusLost:
+            // The window won't see the key-ups of keys released while inactive.
+            for (uint32_t k = 0; k < KeyCount; ++k)
+                if (m_keys[k]) { m_keys[k] = false; m_keyReleased[k] = true; }
+            for (uint32_t b = 0; b < MouseButtonCount; ++b)
+                if (m_buttons[b]) { m_buttons[b] = false; m_buttonReleased[b] = true; }
+            break;
+        }
+    }
+
+private:
+    bool m_keys[KeyCount]{};
+    bool m_keyPressed[KeyCount]{};
+    bool m_keyReleased[KeyCount]{};
+    bool m_buttons[MouseButtonCount]{};
+    bool m_buttonPressed[MouseButtonCount]{};
+    bool m_buttonReleased[MouseButtonCount]{};
+
+    int32_t m_mouseX = 0, m_mouseY = 0;
+    int32_t m_deltaX = 0, m_deltaY = 0;
+    int32_t m_wheel = 0;
+    bool m_hasMouse = false;
+
+    std::vector<InputEvent> m_events; // this tick; keeps its capacity
+};
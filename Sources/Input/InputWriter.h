@@ -0,0 +1,57 @@
+#pragma once
+#include "InputEvent.h"
+
+/*
+ * InputWriter
+ * The window's side of an InputQueue. A full queue drops events rather
+ * than block the message pump, which is harmless for a mouse move but not
+ * for a KeyUp or MouseUp: the key would stay down until pressed again.
+ *
+ * So a release that does not fit is remembered, and the next time there
+ * is room a FocusLost goes in ahead of anything else. That releases every
+ * key and button, the lost one included; a key that really is still held
+ * comes back with its next auto-repeat KeyDown.
+ *
+ * Producer thread only, like InputQueue::Push.
+ */
+class InputWriter {
+public:
+    explicit InputWriter(InputQueue& queue) : m_queue(queue) {}
+
+    // False if `e` was dropped (the queue counts it).
+    bool Push(const InputEvent& e) {
+        if (m_releasePending && !PushFocusLost(e.time))
+            return false; // the failed FocusLost push counted this event's drop
+        if (m_queue.Push(e))
+            return true;
+        if (IsRelease(e.type))
+            m_releasePending = true;
+        return false;
+    }
+
+    // Retries a pending release with no new event to carry it, e.g. once per
+    // frame: input may stop arriving right after the drop.
+    void Flush(Clock::Ticks now) {
+        if (m_releasePending)
+            PushFocusLost(now);
+    }
+
+    bool ReleasePending() const { return m_releasePending; }
+
+private:
+    static bool IsRelease(InputEventType type) {
+        return type == InputEventType::KeyUp || type == InputEventType::MouseUp || type == InputEventType::FocusLost;
+    }
+
+    bool PushFocusLost(Clock::Ticks time) {
+        InputEvent lost;
+        lost.time = time;
+        lost.type = InputEventType::FocusLost;
+        m_releasePending = !m_queue.Push(lost);
+        return !m_releasePending;
+    }
+
+private:
+    InputQueue& m_queue;
+    bool m_releasePending = false;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include "InputEvent.h"
+
+/*
+ * SyntheticInput
+ * Produces believable input without a window: mostly mouse motion, with key
+ * taps, button clicks and wheel notches mixed in, and every key / button that
+ * goes down also comes up again. Deterministic for a given seed.
+ *
+ * Lets the input path (InputQueue -> InputState) be tested and benchmarked
+ * on any platform (Tests/InputTests.cpp, Bench/InputBench.h), e.g. a
+ * producer thread pushing at 8 kHz while the consumer ticks at 60 Hz:
+ *
+ *     SyntheticInput source(42);
+ *     source.Emit(queue, 16, Clock::NowTicks());
+ */
+class SyntheticInput {
+public:
+    explicit SyntheticInput(uint32_t seed = 1) : m_rng(seed ? seed : 1) {}
+
+    // The next event, stamped with `time`.
+    InputEvent Next(Clock::Ticks time) {
+        InputEvent e;
+        e.time = time;
+
+        // Release what is held before pressing something else, so the
+        // stream stays balanced like real input.
+        if (m_heldKey) {
+            e.type = InputEventType::KeyUp;
+            e.code = m_heldKey;
+            m_heldKey = 0;
+        }
+        else if (m_heldButton) {
+            e.type = InputEventType::MouseUp;
+            e.code = uint8_t(m_heldButton - 1);
+            m_heldButton = 0;
+        }
+        else {
+            const uint32_t r = Random() % 100;
+            if (r < 80) {
+                e.type = InputEventType::MouseMove;
+                m_mouseX = Clamp(m_mouseX + int32_t(Random() % 17) - 8, 0, 1919);
+                m_mouseY = Clamp(m_mouseY + int32_t(Random() % 17) - 8, 0, 1079);
+            }
+            else if (r < 90) {
+                e.type = InputEventType::KeyDown;
+                m_heldKey = uint8_t('A' + Random() % 26);
+                e.code = m_heldKey;
+            }
+            else if (r < 96) {
+                e.type = InputEventType::MouseDown;
+                m_heldButton = uint8_t(1 + Random() % 3);
+                e.code = uint8_t(m_heldButton - 1);
+            }
+            else {
+                e.type = InputEventType::MouseWheel;
+                e.wheel = (Random() & 1) ? 120 : -120;
+            }
+        }
+        e.x = int16_t(m_mouseX);
+        e.y = int16_t(m_mouseY);
+        return e;
+    }
+
+    // Pushes up to `count` events; returns how many went in. Stops at the
+    // first one that doesn't fit and takes it back, what it held or
+    // released included, so the next Emit produces it again: a dropped
+    // KeyUp can't leave a key held forever.
+    uint32_t Emit(InputQueue& queue, uint32_t count, Clock::Ticks time) {
+        for (uint32_t i = 0; i < count; ++i) {
+            const SyntheticInput before = *this;
+            if (!queue.Push(Next(time))) {
+                *this = before;
+                return i;
+            }
+        }
+        return count;
+    }
+
+    // A key or button is down (its up event is the next one).
+    bool Holding() const { return m_heldKey != 0 || m_heldButton != 0; }
+
+private:
+    uint32_t Random() {
+        // xorshift32
+        m_rng ^= m_rng << 13;
+        m_rng ^= m_rng >> 17;
+        m_rng ^= m_rng << 5;
+        return m_rng;
+    }
+
+    static int32_t Clamp(int32_t v, int32_t lo, int32_t hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+private:
+    uint32_t m_rng;
+    int32_t m_mouseX = 960;
+    int32_t m_mouseY = 540;
+    uint8_t m_heldKey = 0;
+    uint8_t m_heldButton = 0; // button + 1, 0 = none
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cmath>
+#include <DirectXMath.h>
+using namespace DirectX;
+
+/*
+ * Frustum
+ * Six planes (xyz = normal pointing inside, w = distance),
+ * extracted from a view-projection matrix.
+ *
+ * If you pass view * proj you get the planes in world space,
+ * if you pass world * view * proj you get them in object space.
+ */
+struct Frustum {
+    XMFLOAT4 planes[6]; // left, right, bottom, top, near, far
+};
+
+inline Frustum BuildFrustum(const XMMATRIX& viewProj) {
+    // Row vectors (v * M): clip = x * col0 + ..., so the planes are
+    // sums/differences of the matrix columns (Gribb & Hartmann).
+    XMFLOAT4X4 m;
+    XMStoreFloat4x4(&m, viewProj);
+
+    auto column = [&m](int c) { return XMFLOAT4{ m.m[0][c], m.m[1][c], m.m[2][c], m.m[3][c] }; };
+    XMFLOAT4 c0 = column(0), c1 = column(1), c2 = column(2), c3 = column(3);
+
+    Frustum f;
+    f.planes[0] = { c3.x + c0.x, c3.y + c0.y, c3.z + c0.z, c3.w + c0.w }; // left
+    f.planes[1] = { c3.x - c0.x, c3.y - c0.y, c3.z - c0.z, c3.w - c0.w }; // right
+    f.planes[2] = { c3.x + c1.x, c3.y + c1.y, c3.z + c1.z, c3.w + c1.w }; // bottom
+    f.planes[3] = { c3.x - c1.x, c3.y - c1.y, c3.z - c1.z, c3.w - c1.w }; // top
+    f.planes[4] = { c2.x, c2.y, c2.z, c2.w };                             // near (D3D: z >= 0)
+    f.planes[5] = { c3.x - c2.x, c3.y - c2.y, c3.z - c2.z, c3.w - c2.w }; // far
+
+    for (auto& p : f.planes) {
+        float len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+        if (len > 0.0f) {
+            p.x /= len; p.y /= len; p.z /= len; p.w /= len;
+        }
+    }
+    return f;
+}
+
+// True if the sphere is at least partly inside.
+inline bool SphereInFrustum(const Frustum& f, const XMFLOAT3& c, float radius) {
+    for (const auto& p : f.planes) {
+        if (p.x * c.x + p.y * c.y + p.z * c.z + p.w < -radius)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/*
+ * GridKey
+ * Integer cell coordinates packed into one 64-bit key, 21 bits per axis:
+ * what SpatialGrid hashes its cells by and what PhysicsWorld sorts its
+ * columns by (with x = 0). Keys compare like (x, y, z) tuples, so sorting
+ * by key sorts by cell. Coordinates are clamped to +-GridLimit, so
+ * anything farther out shares the edge cells instead of wrapping around.
+ */
+constexpr int32_t GridLimit = (1 << 20) - 1;
+
+// The cell `v` falls into, for cells 1 / invCellSize wide.
+inline int32_t GridCoord(float v, float invCellSize) {
+    const float c = std::floor(v * invCellSize);
+    return int32_t(std::clamp(c, -float(GridLimit), float(GridLimit)));
+}
+
+inline uint64_t GridKey(int32_t x, int32_t y, int32_t z) {
+    return (uint64_t(x + GridLimit + 1) << 42) | (uint64_t(y + GridLimit + 1) << 21) | uint64_t(z + GridLimit + 1);
+}
+
+// One coordinate back out of a key: axis 0 = x, 1 = y, 2 = z.
+inline int32_t GridKeyAxis(uint64_t key, int axis) {
+    return int32_t((key >> (42 - 21 * axis)) & ((1u << 21) - 1)) - (GridLimit + 1);
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "SimdMath.h"
+
+#if DREIVY_SIMD == DREIVY_SIMD_SSE || DREIVY_SIMD == DREIVY_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+/*
+ * SimdLanes
+ * For structure-of-arrays loops that go 4 floats at a time, like
+ * PhysicsWorld's integration and ParticleSystem's update: too specific to
+ * be a SimdMath kernel, but they all pad their arrays, load lanes and
+ * select between them the same way.
+ *
+ * Float4 is 4 lanes on the backend SimdMath picked (DREIVY_SIMD): an SSE
+ * register, or 4 plain floats in the scalar build. Kernels are written
+ * once against it; DREIVY_SIMD=0 runs them on the plain floats.
+ *
+ * Comparisons give masks, every bit of a lane set where they hold, for
+ * Select and Mask.
+ *
+ * Arrays are sized RoundUp4(count), so the last step never reads past
+ * the end. What the padding lanes hold is up to the owner.
+ */
+namespace Simd {
+
+    constexpr uint32_t RoundUp4(uint32_t n) { return (n + 3) & ~3u; }
+
+#if DREIVY_SIMD == DREIVY_SIMD_SSE || DREIVY_SIMD == DREIVY_SIMD_AVX2
+
+    using Float4 = __m128;
+
+    // Four consecutive floats; no alignment needed.
+    inline Float4 Load4(const float* p) { return _mm_loadu_ps(p); }
+    inline void Store4(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+
+    inline Float4 Splat(float f) { return _mm_set1_ps(f); }
+    inline Float4 Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+
+    inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+    inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+    inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+    inline Float4 Negate(Float4 v) { return _mm_sub_ps(_mm_setzero_ps(), v); }
+    inline Float4 Abs(Float4 v) { return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF))); }
+
+    // a * b + c; one rounding where the build has FMA.
+    inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) {
+#if DREIVY_SIMD == DREIVY_SIMD_AVX2 && (defined(__FMA__) || defined(_MSC_VER))
+        return _mm_fmadd_ps(a, b, c);
+#else
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+    }
+
+    inline Float4 Less(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+    inline Float4 Greater(Float4 a, Float4 b) { return _mm_cmpgt_ps(a, b); }
+    inline Float4 GreaterOrEqual(Float4 a, Float4 b) { return _mm_cmpge_ps(a, b); }
+
+    // mask ? b : a, lane by lane.
+    inline Float4 Select(Float4 a, Float4 b, Float4 mask) { return _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b)); }
+
+    // Bit k set where lane k of the mask is.
+    inline int Mask(Float4 mask) { return _mm_movemask_ps(mask); }
+
+    // Rows to columns: 4 particles as x, y, z, w rows become 4 (x, y, z, w).
+    inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+
+#else
+
+    struct Float4 {
+        float v[4];
+    };
+
+    namespace LaneDetail {
+        inline uint32_t Bits(float f) { uint32_t u; std::memcpy(&u, &f, 4); return u; }
+        inline float Float(uint32_t u) { float f; std::memcpy(&f, &u, 4); return f; }
+        inline float Flag(bool b) { return Float(b ? ~0u : 0u); }
+
+        template<typename Op>
+        inline Float4 Each(Float4 a, Float4 b, Op op) {
+            return { { op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]), op(a.v[3], b.v[3]) } };
+        }
+    }
+
+    inline Float4 Load4(const float* p) { Float4 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+    inline void Store4(float* p, Float4 v) { std::memcpy(p, v.v, sizeof(v.v)); }
+
+    inline Float4 Splat(float f) { return { { f, f, f, f } }; }
+    inline Float4 Set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+
+    inline Float4 Add(Float4 a, Float4 b) { return LaneDetail::Each(a, b, [](float x, float y) { return x + y; }); }
+    inline Float4 Sub(Float4 a, Float4 b) { return LaneDetail::Each(a, b, [](float x, float y) { return x - y; }); }
+    inline Float4 Mul(Float4 a, Float4 b) { return LaneDetail::Each(a, b, [](float x, float y) { return x * y; }); }
+    // Same operand order as minps / maxps: b when either is NaN.
+    inline Float4 Min(Float4 a, Float4 b) { return LaneDetail::Each(a, b, [](float x, float y) { return x < y ? x : y; }); }
+    inline Float4 Max(Float4 a, Float4 b) { return LaneDetail::Each(a, b, [](float x, float y) { return x > y ? x : y; }); }
+    inline Float4 Negate(Float4 v) { return Sub(Splat(0.0f), v); }
+    inline Float4 Abs(Float4 v) {
+        return LaneDetail::Each(v, v, [](float x, float) { return LaneDetail::Float(LaneDetail::Bits(x) & 0x7FFFFFFFu); });
+    }
+
+    inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return Add(Mul(a, b), c); }
+
+    inline Float4 Less(Float4 a, Float4 b) { return LaneDetail::Each(a, b, [](float x, float y) { return LaneDetail::Flag(x < y); }); }
+    inline Float4 Greater(Float4 a, Float4 b) { return LaneDetail::Each(a, b, [](float x, float y) { return LaneDetail::Flag(x > y); }); }
+    inline Float4 GreaterOrEqual(Float4 a, Float4 b) { return LaneDetail::Each(a, b, [](float x, float y) { return LaneDetail::Flag(x >= y); }); }
+
+    inline Float4 Select(Float4 a, Float4 b, Float4 mask) {
+        Float4 r;
+        for (int k = 0; k < 4; ++k) {
+            const uint32_t m = LaneDetail::Bits(mask.v[k]);
+            r.v[k] = LaneDetail::Float((LaneDetail::Bits(a.v[k]) & ~m) | (LaneDetail::Bits(b.v[k]) & m));
+        }
+        return r;
+    }
+
+    inline int Mask(Float4 mask) {
+        int bits = 0;
+        for (int k = 0; k < 4; ++k)
+            bits |= int(LaneDetail::Bits(mask.v[k]) >> 31) << k;
+        return bits;
+    }
+
+    inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) {
+        const Float4 c0 = { { r0.v[0], r1.v[0], r2.v[0], r3.v[0] } };
+        const Float4 c1 = { { r0.v[1], r1.v[1], r2.v[1], r3.v[1] } };
+        const Float4 c2 = { { r0.v[2], r1.v[2], r2.v[2], r3.v[2] } };
+        const Float4 c3 = { { r0.v[3], r1.v[3], r2.v[3], r3.v[3] } };
+        r0 = c0; r1 = c1; r2 = c2; r3 = c3;
+    }
+
+#endif
+
+} // namespace Simd
@@ -0,0 +1,344 @@
+#include "SimdMath.h"
+#include <cmath>
+
+#if DREIVY_SIMD == DREIVY_SIMD_SSE || DREIVY_SIMD == DREIVY_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+namespace Simd {
+
+    // ---- Scalar reference ----
+    // Written the way the math reads, no tricks: the other backends must
+    // match it (up to rounding, FMA rounds once where this rounds twice).
+
+    namespace Scalar {
+
+        void MultiplyMatrices(const Mat4* a, const Mat4& b, Mat4* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                const Mat4 row = a[i]; // out may be a
+                for (int r = 0; r < 4; ++r)
+                    for (int c = 0; c < 4; ++c)
+                        out[i].m[r][c] = row.m[r][0] * b.m[0][c] + row.m[r][1] * b.m[1][c] +
+                                         row.m[r][2] * b.m[2][c] + row.m[r][3] * b.m[3][c];
+            }
+        }
+
+        // Center and half size: the center moves like a point, the half
+        // size grows by the absolute values of the rotation/scale part
+        // (Arvo, "Transforming Axis-Aligned Bounding Boxes").
+        static Aabb TransformAabb(const Aabb& box, const Mat4& m) {
+            float c[3], e[3];
+            for (int k = 0; k < 3; ++k) {
+                c[k] = (box.min[k] + box.max[k]) * 0.5f;
+                e[k] = (box.max[k] - box.min[k]) * 0.5f;
+            }
+            Aabb out;
+            for (int j = 0; j < 3; ++j) {
+                const float center = c[0] * m.m[0][j] + c[1] * m.m[1][j] + c[2] * m.m[2][j] + m.m[3][j];
+                const float extent = e[0] * std::fabs(m.m[0][j]) + e[1] * std::fabs(m.m[1][j]) + e[2] * std::fabs(m.m[2][j]);
+                out.min[j] = center - extent;
+                out.max[j] = center + extent;
+            }
+            out.min[3] = out.max[3] = 0.0f;
+            return out;
+        }
+
+        void TransformAabbs(const Aabb* boxes, const Mat4* matrices, Aabb* out, size_t count) {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = TransformAabb(boxes[i], matrices[i]);
+        }
+
+        void TransformAabbs(const Aabb* boxes, const Mat4& matrix, Aabb* out, size_t count) {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = TransformAabb(boxes[i], matrix);
+        }
+
+        size_t MatchMasks(const uint64_t* masks, size_t count, uint64_t all, uint64_t none,
+                          uint32_t first, uint32_t* out) {
+            size_t n = 0;
+            for (size_t i = 0; i < count; ++i)
+                if ((masks[i] & all) == all && (masks[i] & none) == 0)
+                    out[n++] = first + uint32_t(i);
+            return n;
+        }
+
+    } // namespace Scalar
+
+#if DREIVY_SIMD == DREIVY_SIMD_SSE || DREIVY_SIMD == DREIVY_SIMD_AVX2
+
+    // ---- SSE: one matrix row (or one box corner) per register ----
+    // Also the tail of the AVX2 loops.
+
+    namespace {
+
+        template <int k>
+        inline __m128 Splat(__m128 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(k, k, k, k)); }
+
+        // row * B, B given as its four rows
+        inline __m128 RowTimes(__m128 row, __m128 b0, __m128 b1, __m128 b2, __m128 b3) {
+            __m128 r = _mm_mul_ps(Splat<0>(row), b0);
+            r = _mm_add_ps(r, _mm_mul_ps(Splat<1>(row), b1));
+            r = _mm_add_ps(r, _mm_mul_ps(Splat<2>(row), b2));
+            return _mm_add_ps(r, _mm_mul_ps(Splat<3>(row), b3));
+        }
+
+        inline void MultiplyOne(const Mat4& a, __m128 b0, __m128 b1, __m128 b2, __m128 b3, Mat4& out) {
+            const __m128 a0 = _mm_load_ps(a.m[0]);
+            const __m128 a1 = _mm_load_ps(a.m[1]);
+            const __m128 a2 = _mm_load_ps(a.m[2]);
+            const __m128 a3 = _mm_load_ps(a.m[3]);
+            _mm_store_ps(out.m[0], RowTimes(a0, b0, b1, b2, b3));
+            _mm_store_ps(out.m[1], RowTimes(a1, b0, b1, b2, b3));
+            _mm_store_ps(out.m[2], RowTimes(a2, b0, b1, b2, b3));
+            _mm_store_ps(out.m[3], RowTimes(a3, b0, b1, b2, b3));
+        }
+
+        inline void TransformOne(const Aabb& box, const Mat4& m, Aabb& out) {
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 abs = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+            const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+            const __m128 mn = _mm_load_ps(box.min);
+            const __m128 mx = _mm_load_ps(box.max);
+            const __m128 c = _mm_mul_ps(_mm_add_ps(mn, mx), half);
+            const __m128 e = _mm_mul_ps(_mm_sub_ps(mx, mn), half);
+            const __m128 r0 = _mm_load_ps(m.m[0]);
+            const __m128 r1 = _mm_load_ps(m.m[1]);
+            const __m128 r2 = _mm_load_ps(m.m[2]);
+
+            __m128 center = _mm_add_ps(_mm_mul_ps(Splat<0>(c), r0), _mm_mul_ps(Splat<1>(c), r1));
+            center = _mm_add_ps(center, _mm_mul_ps(Splat<2>(c), r2));
+            center = _mm_add_ps(center, _mm_load_ps(m.m[3]));
+            __m128 extent = _mm_add_ps(_mm_mul_ps(Splat<0>(e), _mm_and_ps(r0, abs)), _mm_mul_ps(Splat<1>(e), _mm_and_ps(r1, abs)));
+            extent = _mm_add_ps(extent, _mm_mul_ps(Splat<2>(e), _mm_and_ps(r2, abs)));
+
+            _mm_store_ps(out.min, _mm_and_ps(_mm_sub_ps(center, extent), xyz));
+            _mm_store_ps(out.max, _mm_and_ps(_mm_add_ps(center, extent), xyz));
+        }
+
+        // index .. index + 7 where `matched` has a bit, appended at out[n].
+        // Always written, only kept (n moves on) if it matched: no branch to mispredict.
+        inline size_t Compact8(int matched, uint32_t index, uint32_t* out, size_t n) {
+            for (uint32_t k = 0; k < 8; ++k) {
+                out[n] = index + k;
+                n += (matched >> k) & 1;
+            }
+            return n;
+        }
+
+        // Bit 0 / 1 set if masks[0] / masks[1] match.
+        inline int MatchTwo(const uint64_t* masks, __m128i all, __m128i none) {
+            const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks));
+            // Zero exactly where it matches: no bit of `all` missing, no bit of `none` set.
+            const __m128i miss = _mm_or_si128(_mm_andnot_si128(m, all), _mm_and_si128(m, none));
+            // SSE2 can't compare 64-bit lanes: both 32-bit halves must be zero,
+            // so each half is and-ed with the other one before the sign bits are read.
+            const __m128i zero = _mm_cmpeq_epi32(miss, _mm_setzero_si128());
+            const __m128i both = _mm_and_si128(zero, _mm_shuffle_epi32(zero, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_movemask_pd(_mm_castsi128_pd(both));
+        }
+
+    } // namespace
+
+#endif
+
+#if DREIVY_SIMD == DREIVY_SIMD_AVX2
+
+    // ---- AVX2: two rows (or two boxes) per register ----
+    // Each 128-bit half is handled like the SSE code; _mm256_permute_ps
+    // broadcasts within each half, so no lane crossing is needed.
+
+    namespace {
+
+        inline __m256 Madd(__m256 a, __m256 b, __m256 c) {
+#if defined(__FMA__) || defined(_MSC_VER)
+            return _mm256_fmadd_ps(a, b, c);
+#else
+            return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+        }
+
+        template <int k>
+        inline __m256 Splat8(__m256 v) { return _mm256_permute_ps(v, _MM_SHUFFLE(k, k, k, k)); }
+
+        inline __m256 RowsTimes(__m256 rows, __m256 b0, __m256 b1, __m256 b2, __m256 b3) {
+            __m256 r = _mm256_mul_ps(Splat8<0>(rows), b0);
+            r = Madd(Splat8<1>(rows), b1, r);
+            r = Madd(Splat8<2>(rows), b2, r);
+            return Madd(Splat8<3>(rows), b3, r);
+        }
+
+        inline __m256 Pair(const float* lo, const float* hi) {
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(lo)), _mm_load_ps(hi), 1);
+        }
+
+        // Two boxes, each with its matrix rows already paired up.
+        inline void TransformTwo(const Aabb& b0, const Aabb& b1, __m256 r0, __m256 r1, __m256 r2, __m256 r3,
+                                 Aabb& out0, Aabb& out1) {
+            const __m256 half = _mm256_set1_ps(0.5f);
+            const __m256 abs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+            const __m256 xyz = _mm256_castsi256_ps(_mm256_set_epi32(0, -1, -1, -1, 0, -1, -1, -1));
+            const __m256 mn = Pair(b0.min, b1.min);
+            const __m256 mx = Pair(b0.max, b1.max);
+            const __m256 c = _mm256_mul_ps(_mm256_add_ps(mn, mx), half);
+            const __m256 e = _mm256_mul_ps(_mm256_sub_ps(mx, mn), half);
+
+            __m256 center = Madd(Splat8<0>(c), r0, r3);
+            center = Madd(Splat8<1>(c), r1, center);
+            center = Madd(Splat8<2>(c), r2, center);
+            __m256 extent = _mm256_mul_ps(Splat8<0>(e), _mm256_and_ps(r0, abs));
+            extent = Madd(Splat8<1>(e), _mm256_and_ps(r1, abs), extent);
+            extent = Madd(Splat8<2>(e), _mm256_and_ps(r2, abs), extent);
+
+            const __m256 lo = _mm256_and_ps(_mm256_sub_ps(center, extent), xyz);
+            const __m256 hi = _mm256_and_ps(_mm256_add_ps(center, extent), xyz);
+            _mm_store_ps(out0.min, _mm256_castps256_ps128(lo));
+            _mm_store_ps(out0.max, _mm256_castps256_ps128(hi));
+            _mm_store_ps(out1.min, _mm256_extractf128_ps(lo, 1));
+            _mm_store_ps(out1.max, _mm256_extractf128_ps(hi, 1));
+        }
+
+    } // namespace
+
+    const char* BackendName() { return "avx2"; }
+
+    size_t MatchMasks(const uint64_t* masks, size_t count, uint64_t all, uint64_t none,
+                      uint32_t first, uint32_t* out) {
+        const __m256i vAll = _mm256_set1_epi64x(int64_t(all));
+        const __m256i vNone = _mm256_set1_epi64x(int64_t(none));
+        auto matchFour = [&](const uint64_t* m4) {
+            const __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m4));
+            const __m256i miss = _mm256_or_si256(_mm256_andnot_si256(m, vAll), _mm256_and_si256(m, vNone));
+            return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(miss, _mm256_setzero_si256())));
+        };
+        size_t n = 0, i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const int matched = matchFour(masks + i) | matchFour(masks + i + 4) << 4;
+            // Rare queries (Selected) see mostly empty blocks.
+            if (!matched)
+                continue;
+            n = Compact8(matched, first + uint32_t(i), out, n);
+        }
+        if (i + 4 <= count) {
+            const int matched = matchFour(masks + i);
+            const uint32_t index = first + uint32_t(i);
+            out[n] = index;     n += matched & 1;
+            out[n] = index + 1; n += (matched >> 1) & 1;
+            out[n] = index + 2; n += (matched >> 2) & 1;
+            out[n] = index + 3; n += (matched >> 3) & 1;
+            i += 4;
+        }
+        if (i + 2 <= count) {
+            const int matched = MatchTwo(masks + i, _mm256_castsi256_si128(vAll), _mm256_castsi256_si128(vNone));
+            out[n] = first + uint32_t(i);     n += matched & 1;
+            out[n] = first + uint32_t(i) + 1; n += matched >> 1;
+            i += 2;
+        }
+        return n + Scalar::MatchMasks(masks + i, count - i, all, none, first + uint32_t(i), out + n);
+    }
+
+    void MultiplyMatrices(const Mat4* a, const Mat4& b, Mat4* out, size_t count) {
+        const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.m[0]));
+        const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.m[1]));
+        const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.m[2]));
+        const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b.m[3]));
+        for (size_t i = 0; i < count; ++i) {
+            const __m256 rows01 = _mm256_loadu_ps(a[i].m[0]); // Mat4 is only 16-byte aligned
+            const __m256 rows23 = _mm256_loadu_ps(a[i].m[2]);
+            _mm256_storeu_ps(out[i].m[0], RowsTimes(rows01, b0, b1, b2, b3));
+            _mm256_storeu_ps(out[i].m[2], RowsTimes(rows23, b0, b1, b2, b3));
+        }
+    }
+
+    void TransformAabbs(const Aabb* boxes, const Mat4* matrices, Aabb* out, size_t count) {
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            const Mat4& m0 = matrices[i];
+            const Mat4& m1 = matrices[i + 1];
+            TransformTwo(boxes[i], boxes[i + 1],
+                Pair(m0.m[0], m1.m[0]), Pair(m0.m[1], m1.m[1]), Pair(m0.m[2], m1.m[2]), Pair(m0.m[3], m1.m[3]),
+                out[i], out[i + 1]);
+        }
+        if (i < count)
+            TransformOne(boxes[i], matrices[i], out[i]);
+    }
+
+    void TransformAabbs(const Aabb* boxes, const Mat4& matrix, Aabb* out, size_t count) {
+        const __m256 r0 = Pair(matrix.m[0], matrix.m[0]);
+        const __m256 r1 = Pair(matrix.m[1], matrix.m[1]);
+        const __m256 r2 = Pair(matrix.m[2], matrix.m[2]);
+        const __m256 r3 = Pair(matrix.m[3], matrix.m[3]);
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+            TransformTwo(boxes[i], boxes[i + 1], r0, r1, r2, r3, out[i], out[i + 1]);
+        if (i < count)
+            TransformOne(boxes[i], matrix, out[i]);
+    }
+
+#elif DREIVY_SIMD == DREIVY_SIMD_SSE
+
+    const char* BackendName() { return "sse"; }
+
+    size_t MatchMasks(const uint64_t* masks, size_t count, uint64_t all, uint64_t none,
+                      uint32_t first, uint32_t* out) {
+        const __m128i vAll = _mm_set1_epi64x(int64_t(all));
+        const __m128i vNone = _mm_set1_epi64x(int64_t(none));
+        size_t n = 0, i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const int matched = MatchTwo(masks + i, vAll, vNone) | MatchTwo(masks + i + 2, vAll, vNone) << 2 |
+                                MatchTwo(masks + i + 4, vAll, vNone) << 4 | MatchTwo(masks + i + 6, vAll, vNone) << 6;
+            // Rare queries (Selected) see mostly empty blocks.
+            if (!matched)
+                continue;
+            n = Compact8(matched, first + uint32_t(i), out, n);
+        }
+        for (; i + 2 <= count; i += 2) {
+            const int matched = MatchTwo(masks + i, vAll, vNone);
+            out[n] = first + uint32_t(i);     n += matched & 1;
+            out[n] = first + uint32_t(i) + 1; n += matched >> 1;
+        }
+        return n + Scalar::MatchMasks(masks + i, count - i, all, none, first + uint32_t(i), out + n);
+    }
+
+    void MultiplyMatrices(const Mat4* a, const Mat4& b, Mat4* out, size_t count) {
+        const __m128 b0 = _mm_load_ps(b.m[0]);
+        const __m128 b1 = _mm_load_ps(b.m[1]);
+        const __m128 b2 = _mm_load_ps(b.m[2]);
+        const __m128 b3 = _mm_load_ps(b.m[3]);
+        for (size_t i = 0; i < count; ++i)
+            MultiplyOne(a[i], b0, b1, b2, b3, out[i]);
+    }
+
+    void TransformAabbs(const Aabb* boxes, const Mat4* matrices, Aabb* out, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+            TransformOne(boxes[i], matrices[i], out[i]);
+    }
+
+    void TransformAabbs(const Aabb* boxes, const Mat4& matrix, Aabb* out, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+            TransformOne(boxes[i], matrix, out[i]);
+    }
+
+#else
+
+    const char* BackendName() { return "scalar"; }
+
+    void MultiplyMatrices(const Mat4* a, const Mat4& b, Mat4* out, size_t count) {
+        Scalar::MultiplyMatrices(a, b, out, count);
+    }
+
+    void TransformAabbs(const Aabb* boxes, const Mat4* matrices, Aabb* out, size_t count) {
+        Scalar::TransformAabbs(boxes, matrices, out, count);
+    }
+
+    void TransformAabbs(const Aabb* boxes, const Mat4& matrix, Aabb* out, size_t count) {
+        Scalar::TransformAabbs(boxes, matrix, out, count);
+    }
+
+    size_t MatchMasks(const uint64_t* masks, size_t count, uint64_t all, uint64_t none,
+                      uint32_t first, uint32_t* out) {
+        return Scalar::MatchMasks(masks, count, all, none, first, out);
+    }
+
+#endif
+
+} // namespace Simd
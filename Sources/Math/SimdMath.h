@@ -0,0 +1,100 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * SimdMath
+ * Batched math kernels: the same operation on many matrices or boxes at
+ * once. DirectXMath works on one matrix per call, so "world * viewProj for
+ * every draw" pays a call, loads and stores per draw and only ever uses 4
+ * lanes. Here one call walks whole arrays, and the loop is written once
+ * per instruction set. (MatchMasks isn't math, but a sweep over bit masks
+ * gains from wide registers the same way.)
+ *
+ *   DREIVY_SIMD_SCALAR  plain C++, also the reference the others are checked against
+ *   DREIVY_SIMD_SSE     4 lanes; any x64 build (the kernels need nothing past SSE2,
+ *                       so SSE4 machines and /arch:SSE2 builds take the same path)
+ *   DREIVY_SIMD_AVX2    8 lanes with FMA, two rows (or two boxes) per instruction;
+ *                       builds with /arch:AVX2 (-mavx2 -mfma)
+ *
+ * There is no ARM backend: no configuration of the project targets ARM, and
+ * a path that is never built or tested is worse than none. ARM builds get
+ * the scalar one.
+ *
+ * The backend is chosen at compile time from what the compiler may emit;
+ * define DREIVY_SIMD to one of the values above to force one (e.g.
+ * DREIVY_SIMD=0 to run everything on the scalar reference).
+ *
+ * Conventions are the engine's (and DirectXMath's): row vectors, v' = v * M,
+ * row-major storage, the translation in row 3. Mat4 has XMFLOAT4X4's layout,
+ * so a world matrix can be copied in and out with memcpy. This header doesn't
+ * include DirectXMath, so code that only needs the kernels doesn't either.
+ *
+ * Only the batched work goes through here: the renderers' per-draw MVPs,
+ * box transforms, signature queries, and the SoA loops on SimdLanes.h.
+ * Transform, RenderItem and TransformUtils deliberately stay on
+ * DirectXMath (XMFLOAT3, XMFLOAT4X4, XMMATRIX), one matrix at a time, and
+ * meet the kernels at that memcpy. Moving them would touch every system
+ * and the D3D11 renderer for no speed: DirectXMath is header only and
+ * already has SSE, NEON and scalar paths of its own.
+ *
+ * Tests/MathTests.cpp checks the backend of the build against the scalar
+ * one (Dreivy.Tests); Bench/MathBench times both.
+ */
+#define DREIVY_SIMD_SCALAR 0
+#define DREIVY_SIMD_SSE 1
+#define DREIVY_SIMD_AVX2 2
+
+#ifndef DREIVY_SIMD
+#if defined(__AVX2__)
+#define DREIVY_SIMD DREIVY_SIMD_AVX2
+#elif defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DREIVY_SIMD DREIVY_SIMD_SSE
+#else
+#define DREIVY_SIMD DREIVY_SIMD_SCALAR
+#endif
+#endif
+
+namespace Simd {
+
+    struct alignas(16) Mat4 {
+        float m[4][4];
+    };
+
+    // Axis-aligned box. w is padding: each corner is one 16-byte load.
+    struct alignas(16) Aabb {
+        float min[4];
+        float max[4];
+    };
+
+    // "scalar", "sse" or "avx2": what this build uses.
+    const char* BackendName();
+
+    // out[i] = a[i] * b for every i < count, e.g. world matrices times one
+    // view-projection. out may be a (in place), but must not overlap b.
+    void MultiplyMatrices(const Mat4* a, const Mat4& b, Mat4* out, size_t count);
+
+    // out[i] = the box around boxes[i] moved by matrices[i] (affine: row 3 is
+    // the translation, the last column is ignored), e.g. local bounds to
+    // world bounds. out may be boxes.
+    void TransformAabbs(const Aabb* boxes, const Mat4* matrices, Aabb* out, size_t count);
+
+    // The same, one matrix for every box.
+    void TransformAabbs(const Aabb* boxes, const Mat4& matrix, Aabb* out, size_t count);
+
+    // Writes first + i for every i < count with all bits of `all` set in
+    // masks[i] and none of `none`, in order; returns how many. out needs
+    // room for count. E.g. ECS queries over component signatures.
+    size_t MatchMasks(const uint64_t* masks, size_t count, uint64_t all, uint64_t none,
+                      uint32_t first, uint32_t* out);
+
+    // The scalar reference, built in every configuration.
+    namespace Scalar {
+        void MultiplyMatrices(const Mat4* a, const Mat4& b, Mat4* out, size_t count);
+        void TransformAabbs(const Aabb* boxes, const Mat4* matrices, Aabb* out, size_t count);
+        void TransformAabbs(const Aabb* boxes, const Mat4& matrix, Aabb* out, size_t count);
+        size_t MatchMasks(const uint64_t* masks, size_t count, uint64_t all, uint64_t none,
+                          uint32_t first, uint32_t* out);
+    }
+
+} // namespace Simd
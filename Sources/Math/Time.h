@@ -1,5 +1,5 @@
 #pragma once
-#include <windows.h>
+#include "Timing/Clock.h"
 
 /*
  * Namespace Time
@@ -10,36 +10,36 @@
  * Use Time::deltaTime and Time::time in game logic to make it
  * frame-rate independent, so physics and animations behave
  * the same on machines with different performance.
+ *
+ * `time` is a double: as a float it would lose millisecond precision
+ * after a few hours (see Timing/Clock.h).
  */
 
 namespace Time {
 
     inline float deltaTime = 0.0f;   // seconds between frames
-    inline float time = 0.0f;   // seconds since start
+    inline double time = 0.0;        // seconds since start
 
-    inline LARGE_INTEGER frequency{};
-    inline LARGE_INTEGER startCounter{};
-    inline LARGE_INTEGER lastCounter{};
+    inline bool started = false;
+    inline double startTime = 0.0;
+    inline double lastTime = 0.0;
 
     // Call this ONCE at the beginning of loop (like in Core::Update the very first line)
     inline void Update()
     {
+        double now = Clock::Now();
+
         // First call initialization
-        if (frequency.QuadPart == 0) {
-            QueryPerformanceFrequency(&frequency);
-            QueryPerformanceCounter(&startCounter);
-            lastCounter = startCounter;
+        if (!started) {
+            started = true;
+            startTime = now;
+            lastTime = now;
             deltaTime = 0.0f;
-            time = 0.0f;
+            time = 0.0;
             return;
         }
 
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
-
-        deltaTime =
-            float(now.QuadPart - lastCounter.QuadPart) /
-            float(frequency.QuadPart);
+        deltaTime = float(now - lastTime);
 
         // If game was paused or something caused a big delay
         // we don't want to have a huge deltaTime...
@@ -47,11 +47,9 @@ namespace Time {
         if (deltaTime > 0.1f)
             deltaTime = 0.1f;
 
-        time =
-            float(now.QuadPart - startCounter.QuadPart) /
-            float(frequency.QuadPart);
+        time = now - startTime;
 
-        lastCounter = now;
+        lastTime = now;
     }
 
 } // namespace Time
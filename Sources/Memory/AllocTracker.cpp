@@ -0,0 +1,171 @@
+#include "AllocTracker.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+
+    constexpr size_t TagCount = size_t(AllocTag::Count);
+
+    const char* const TagNames[TagCount] = { "general", "ecs", "render", "assets", "particles", "user" };
+
+    // Plain globals with constant initialization: operator new can be called
+    // before any constructor of ours ran, even before main().
+    struct TagCounters {
+        std::atomic<uint64_t> frameCount{ 0 };
+        std::atomic<uint64_t> frameBytes{ 0 };
+        std::atomic<uint64_t> totalCount{ 0 };
+        std::atomic<uint64_t> totalBytes{ 0 };
+        std::atomic<int64_t> liveBytes{ 0 };
+        std::atomic<uint64_t> lastFrameCount{ 0 };
+        std::atomic<uint64_t> lastFrameBytes{ 0 };
+    };
+    TagCounters g_counters[TagCount];
+
+    thread_local AllocTag t_tag = AllocTag::General;
+
+#if DREIVY_ALLOC_TRACKING
+    // Stored right in front of every tracked block, so Free knows its size
+    // and tag without a lookup.
+    struct Header {
+        void* base;   // what malloc returned
+        size_t size;
+        AllocTag tag;
+    };
+
+    void* AllocateTracked(size_t size, size_t alignment, AllocTag tag) {
+        if (alignment < __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+        void* base = std::malloc(size + sizeof(Header) + alignment - 1);
+        if (!base)
+            return nullptr;
+
+        uintptr_t user = (uintptr_t(base) + sizeof(Header) + alignment - 1) & ~uintptr_t(alignment - 1);
+        Header* h = reinterpret_cast<Header*>(user) - 1;
+        h->base = base;
+        h->size = size;
+        h->tag = tag;
+
+        TagCounters& c = g_counters[size_t(tag)];
+        c.frameCount.fetch_add(1, std::memory_order_relaxed);
+        c.frameBytes.fetch_add(size, std::memory_order_relaxed);
+        c.totalCount.fetch_add(1, std::memory_order_relaxed);
+        c.totalBytes.fetch_add(size, std::memory_order_relaxed);
+        c.liveBytes.fetch_add(int64_t(size), std::memory_order_relaxed);
+        return reinterpret_cast<void*>(user);
+    }
+
+    void FreeTracked(void* p) {
+        if (!p) return;
+        Header* h = static_cast<Header*>(p) - 1;
+        g_counters[size_t(h->tag)].liveBytes.fetch_sub(int64_t(h->size), std::memory_order_relaxed);
+        std::free(h->base);
+    }
+#endif
+
+} // namespace
+
+const char* AllocTracker::TagName(AllocTag tag)
+{
+    return size_t(tag) < TagCount ? TagNames[size_t(tag)] : "?";
+}
+
+void* AllocTracker::Allocate(size_t size, size_t alignment, AllocTag tag)
+{
+#if DREIVY_ALLOC_TRACKING
+    return AllocateTracked(size, alignment, tag);
+#else
+    (void)tag;
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        return ::operator new(size, std::align_val_t(alignment), std::nothrow);
+    return ::operator new(size, std::nothrow);
+#endif
+}
+
+void AllocTracker::Free(void* p, size_t alignment)
+{
+#if DREIVY_ALLOC_TRACKING
+    (void)alignment;
+    FreeTracked(p);
+#else
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        ::operator delete(p, std::align_val_t(alignment));
+    else
+        ::operator delete(p);
+#endif
+}
+
+AllocTag AllocTracker::CurrentTag()
+{
+    return t_tag;
+}
+
+void AllocTracker::SetCurrentTag(AllocTag tag)
+{
+    t_tag = tag;
+}
+
+void AllocTracker::EndFrame()
+{
+    for (TagCounters& c : g_counters) {
+        c.lastFrameCount.store(c.frameCount.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        c.lastFrameBytes.store(c.frameBytes.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+AllocTagStats AllocTracker::GetStats(AllocTag tag)
+{
+    const TagCounters& c = g_counters[size_t(tag)];
+    AllocTagStats s;
+    s.frameCount = c.lastFrameCount.load(std::memory_order_relaxed);
+    s.frameBytes = c.lastFrameBytes.load(std::memory_order_relaxed);
+    s.totalCount = c.totalCount.load(std::memory_order_relaxed);
+    s.totalBytes = c.totalBytes.load(std::memory_order_relaxed);
+    s.liveBytes = c.liveBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+uint64_t AllocTracker::FrameAllocations()
+{
+    uint64_t total = 0;
+    for (const TagCounters& c : g_counters)
+        total += c.lastFrameCount.load(std::memory_order_relaxed);
+    return total;
+}
+
+#if DREIVY_ALLOC_TRACKING
+// ---- the global operators, every `new` of the program lands here ----
+
+namespace {
+    void* NewOrThrow(size_t size, size_t alignment) {
+        if (void* p = AllocateTracked(size ? size : 1, alignment, t_tag))
+            return p;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(size_t size) { return NewOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size) { return NewOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t al) { return NewOrThrow(size, size_t(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return NewOrThrow(size, size_t(al)); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return AllocateTracked(size ? size : 1, __STDCPP_DEFAULT_NEW_ALIGNMENT__, t_tag); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return AllocateTracked(size ? size : 1, __STDCPP_DEFAULT_NEW_ALIGNMENT__, t_tag); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return AllocateTracked(size ? size : 1, size_t(al), t_tag); }
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return AllocateTracked(size ? size : 1, size_t(al), t_tag); }
+
+void operator delete(void* p) noexcept { FreeTracked(p); }
+void operator delete[](void* p) noexcept { FreeTracked(p); }
+void operator delete(void* p, size_t) noexcept { FreeTracked(p); }
+void operator delete[](void* p, size_t) noexcept { FreeTracked(p); }
+void operator delete(void* p, std::align_val_t) noexcept { FreeTracked(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { FreeTracked(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { FreeTracked(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { FreeTracked(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { FreeTracked(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { FreeTracked(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { FreeTracked(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { FreeTracked(p); }
+#endif
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/*
+ * AllocTracker
+ * Counts every heap allocation (operator new) per subsystem and per frame,
+ * so "this frame allocated 37 times in Render" is a number, not a guess.
+ *
+ * Tags
+ *   Every allocation is charged to a tag:
+ *     - the tag of the thread's innermost AllocScope:
+ *           AllocScope scope(AllocTag::Render);   // until the end of the block
+ *     - or a fixed tag, for containers using TaggedAllocator<T, Tag>
+ *       (ECS pools, the render queue), wherever they are touched from.
+ *   Without either it is General.
+ *
+ * Frames
+ *   EndFrame() (called by Core once per frame) closes the per-frame counts;
+ *   GetStats(tag).frameCount is "allocations during the last frame". A game
+ *   that has warmed up should stay at 0: see Core::enableAllocationCheck.
+ *
+ * In release builds (NDEBUG) operator new is not replaced and all counts stay
+ * 0, unless DREIVY_ALLOC_TRACKING=1 is defined (same rule as the profiler).
+ */
+#ifndef DREIVY_ALLOC_TRACKING
+#ifdef NDEBUG
+#define DREIVY_ALLOC_TRACKING 0
+#else
+#define DREIVY_ALLOC_TRACKING 1
+#endif
+#endif
+
+enum class AllocTag : uint8_t {
+    General,
+    ECS,
+    Render,
+    Assets,
+    Particles,
+    User,
+    Count
+};
+
+struct AllocTagStats {
+    uint64_t frameCount = 0; // during the last finished frame
+    uint64_t frameBytes = 0;
+    uint64_t totalCount = 0; // since start
+    uint64_t totalBytes = 0;
+    int64_t liveBytes = 0;   // allocated and not freed yet
+};
+
+namespace AllocTracker {
+
+    constexpr bool Enabled = DREIVY_ALLOC_TRACKING != 0;
+
+    const char* TagName(AllocTag tag); // "general", "ecs", ...
+
+    // What operator new and TaggedAllocator go through. Returns nullptr on failure.
+    // Free takes the same alignment that was passed to Allocate.
+    void* Allocate(size_t size, size_t alignment, AllocTag tag);
+    void Free(void* p, size_t alignment);
+
+    AllocTag CurrentTag();
+    void SetCurrentTag(AllocTag tag); // prefer AllocScope
+
+    void EndFrame();
+    AllocTagStats GetStats(AllocTag tag);
+    uint64_t FrameAllocations(); // every tag, last finished frame
+
+} // namespace AllocTracker
+
+// Charges this thread's allocations to `tag` until the end of the scope.
+class AllocScope {
+public:
+    explicit AllocScope(AllocTag tag) : m_previous(AllocTracker::CurrentTag()) { AllocTracker::SetCurrentTag(tag); }
+    ~AllocScope() { AllocTracker::SetCurrentTag(m_previous); }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    AllocTag m_previous;
+};
+
+// A std allocator that always charges `Tag`:
+//     std::vector<Entity, TaggedAllocator<Entity, AllocTag::ECS>> entities;
+template<typename T, AllocTag Tag>
+struct TaggedAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind { using other = TaggedAllocator<U, Tag>; };
+
+    TaggedAllocator() noexcept = default;
+    template<typename U>
+    TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t n) {
+        void* p = AllocTracker::Allocate(n * sizeof(T), alignof(T), Tag);
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) noexcept { AllocTracker::Free(p, alignof(T)); }
+
+    template<typename U>
+    bool operator==(const TaggedAllocator<U, Tag>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const TaggedAllocator<U, Tag>&) const noexcept { return false; }
+};
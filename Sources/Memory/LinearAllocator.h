@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "AllocTracker.h"
+
+/*
+ * LinearAllocator
+ * A "bump" allocator for data that only lives for a short, known time
+ * (one frame, one function): allocating is moving a pointer forward,
+ * and Reset() frees everything at once. No destructors are run, so it only
+ * holds trivially destructible data.
+ *
+ * When a block is full a new one is taken from the heap. On Reset() all
+ * blocks are merged into one block big enough for everything that was used,
+ * so after a frame or two a linear allocator stops touching the heap.
+ *
+ * FrameAllocator
+ * Two linear allocators, swapped every frame (BeginFrame). Memory handed out
+ * during frame N stays valid through frame N + 1, which is enough for data
+ * built on one frame and consumed on the next.
+ *
+ * ArenaAllocator<T>
+ * Lets std containers use a LinearAllocator for a temporary:
+ *     ArenaVector<uint32_t> tmp{ ArenaAllocator<uint32_t>(arena) };
+ */
+class LinearAllocator {
+public:
+    explicit LinearAllocator(size_t blockSize = 64 * 1024, AllocTag tag = AllocTag::General)
+        : m_blockSize(blockSize ? blockSize : 1), m_tag(tag) {}
+
+    ~LinearAllocator() { ReleaseBlocks(); }
+
+    LinearAllocator(const LinearAllocator&) = delete;
+    LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        uintptr_t p = (m_cursor + alignment - 1) & ~uintptr_t(alignment - 1);
+        if (!m_cursor || p + size > m_end) {
+            NewBlock(size + alignment);
+            p = (m_cursor + alignment - 1) & ~uintptr_t(alignment - 1);
+        }
+        m_cursor = p + size;
+        m_used += size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    template<typename T>
+    T* AllocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "LinearAllocator never runs destructors");
+        return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Frees everything. Keeps (at most) one block, sized for the peak so far.
+    void Reset() {
+        if (m_blocks.size() > 1) {
+            ReleaseBlocks();
+            NewBlock(m_peak);
+        }
+        if (!m_blocks.empty()) {
+            m_cursor = uintptr_t(m_blocks[0].memory);
+            m_end = m_cursor + m_blocks[0].size;
+        }
+        m_used = 0;
+    }
+
+    size_t Used() const { return m_used; }             // since the last Reset
+    size_t Capacity() const { return m_capacity; }
+    size_t BlockCount() const { return m_blocks.size(); }
+
+private:
+    struct Block {
+        void* memory;
+        size_t size;
+    };
+
+    void NewBlock(size_t minSize) {
+        size_t size = m_blockSize;
+        while (size < minSize) size *= 2;
+
+        // The block list itself must not count as a per-frame allocation.
+        if (m_blocks.size() == m_blocks.capacity())
+            m_blocks.reserve(m_blocks.empty() ? 8 : m_blocks.size() * 2);
+
+        void* memory = AllocTracker::Allocate(size, alignof(std::max_align_t), m_tag);
+        if (!memory) throw std::bad_alloc();
+        m_blocks.push_back({ memory, size });
+        m_capacity += size;
+        m_peak = std::max(m_peak, m_capacity);
+        m_cursor = uintptr_t(memory);
+        m_end = m_cursor + size;
+    }
+
+    void ReleaseBlocks() {
+        for (const Block& b : m_blocks)
+            AllocTracker::Free(b.memory, alignof(std::max_align_t));
+        m_blocks.clear();
+        m_capacity = 0;
+        m_cursor = m_end = 0;
+    }
+
+private:
+    size_t m_blockSize;
+    AllocTag m_tag;
+    std::vector<Block> m_blocks;
+    uintptr_t m_cursor = 0;
+    uintptr_t m_end = 0;
+    size_t m_used = 0;
+    size_t m_capacity = 0; // all blocks together
+    size_t m_peak = 0;     // largest m_capacity so far
+};
+
+class FrameAllocator {
+public:
+    explicit FrameAllocator(size_t blockSize = 256 * 1024, AllocTag tag = AllocTag::General)
+        : m_arenas{ LinearAllocator(blockSize, tag), LinearAllocator(blockSize, tag) } {}
+
+    // Start of a frame: what was allocated two frames ago is gone.
+    void BeginFrame() {
+        m_current ^= 1;
+        m_arenas[m_current].Reset();
+    }
+
+    LinearAllocator& Current() { return m_arenas[m_current]; }
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) { return Current().Allocate(size, alignment); }
+
+    template<typename T>
+    T* AllocateArray(size_t count) { return Current().AllocateArray<T>(count); }
+
+private:
+    LinearAllocator m_arenas[2];
+    uint32_t m_current = 0;
+};
+
+template<typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    explicit ArenaAllocator(LinearAllocator& arena) noexcept : arena(&arena) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) noexcept {} // freed by Reset()
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+
+    LinearAllocator* arena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
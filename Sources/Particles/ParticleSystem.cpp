@@ -0,0 +1,405 @@
+#include "ParticleSystem.h"
+#include "Threading/JobSystem.h"
+#include "Math/Frustum.h"
+#include "Math/SimdLanes.h"
+#include "Renderer/MeshStorage.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+using namespace Simd;
+
+namespace {
+    // xorshift32, one state per emitter
+    float Random(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return float(state & 0xFFFFFF) / float(0x1000000);
+    }
+
+    float HorizontalMin(Float4 v) {
+        float f[4];
+        Store4(f, v);
+        return std::min(std::min(f[0], f[1]), std::min(f[2], f[3]));
+    }
+
+    float HorizontalMax(Float4 v) {
+        float f[4];
+        Store4(f, v);
+        return std::max(std::max(f[0], f[1]), std::max(f[2], f[3]));
+    }
+
+    // How many jobs (or emitters) go into one ParallelFor chunk, so a chunk
+    // holds about `perJob` particles even when the pieces are small.
+    uint32_t Grain(uint32_t pieces, uint64_t particles, uint32_t perJob) {
+        if (particles == 0) return 1;
+        return std::max<uint32_t>(1, uint32_t(uint64_t(perJob) * pieces / particles));
+    }
+}
+
+// ---- Emitters ----
+
+EmitterHandle ParticleSystem::AddEmitter(const ParticleEmitterDesc& desc)
+{
+    AllocScope scope(AllocTag::Particles);
+    size_t slot = 0;
+    while (slot < m_emitters.size() && m_emitters[slot].active)
+        ++slot;
+    if (slot == m_emitters.size())
+        m_emitters.emplace_back();
+
+    Emitter& e = m_emitters[slot];
+    e = Emitter{};
+    e.desc = desc;
+    e.active = true;
+    e.rng = desc.seed ? desc.seed : 1;
+    return static_cast<EmitterHandle>(slot + 1);
+}
+
+void ParticleSystem::RemoveEmitter(EmitterHandle h)
+{
+    if (Emitter* e = Find(h))
+        *e = Emitter{}; // frees its arrays, the slot is reused by AddEmitter
+}
+
+void ParticleSystem::Clear()
+{
+    m_emitters.clear();
+    m_stats = {};
+}
+
+ParticleSystem::Emitter* ParticleSystem::Find(EmitterHandle h)
+{
+    if (h == InvalidEmitter || h > m_emitters.size() || !m_emitters[h - 1].active)
+        return nullptr;
+    return &m_emitters[h - 1];
+}
+
+const ParticleSystem::Emitter* ParticleSystem::Find(EmitterHandle h) const
+{
+    if (h == InvalidEmitter || h > m_emitters.size() || !m_emitters[h - 1].active)
+        return nullptr;
+    return &m_emitters[h - 1];
+}
+
+ParticleEmitterDesc* ParticleSystem::GetDesc(EmitterHandle h)
+{
+    Emitter* e = Find(h);
+    return e ? &e->desc : nullptr;
+}
+
+const ParticleEmitterDesc* ParticleSystem::GetDesc(EmitterHandle h) const
+{
+    const Emitter* e = Find(h);
+    return e ? &e->desc : nullptr;
+}
+
+void ParticleSystem::SetPosition(EmitterHandle h, const XMFLOAT3& position)
+{
+    if (Emitter* e = Find(h))
+        e->desc.position = position;
+}
+
+void ParticleSystem::Burst(EmitterHandle h, uint32_t count)
+{
+    if (Emitter* e = Find(h))
+        e->burst += count;
+}
+
+uint32_t ParticleSystem::LiveCount(EmitterHandle h) const
+{
+    const Emitter* e = Find(h);
+    return e ? e->count : 0;
+}
+
+XMFLOAT3 ParticleSystem::GetParticlePosition(EmitterHandle h, uint32_t i) const
+{
+    const Emitter* e = Find(h);
+    if (!e || i >= e->count) return { 0.0f, 0.0f, 0.0f };
+    return { e->px[i], e->py[i], e->pz[i] };
+}
+
+float ParticleSystem::GetParticleAge(EmitterHandle h, uint32_t i) const
+{
+    const Emitter* e = Find(h);
+    return e && i < e->count ? e->age[i] : 0.0f;
+}
+
+void ParticleSystem::Reserve(Emitter& e, uint32_t count)
+{
+    if (e.px.size() >= RoundUp4(count))
+        return;
+    // Double up to the capacity: a filling emitter stops allocating quickly.
+    const size_t size = std::min<size_t>(RoundUp4(std::max(e.desc.capacity, count)),
+                                         std::max<size_t>(RoundUp4(count), e.px.size() * 2));
+    // Spare lanes start at zero; invLife = 0 keeps them from dying.
+    for (ParticleVector<float>* a : { &e.px, &e.py, &e.pz, &e.vx, &e.vy, &e.vz, &e.age, &e.invLife })
+        a->resize(size, 0.0f);
+}
+
+// ---- Update ----
+
+void ParticleSystem::Update(float dt)
+{
+    const uint32_t grain = RoundUp4(std::max(m_settings.particlesPerJob, 4u));
+    m_stats.emitters = m_stats.live = m_stats.spawned = m_stats.died = 0;
+
+    // Cut every emitter into jobs of at most `grain` particles.
+    m_jobList.clear();
+    uint64_t live = 0;
+    uint32_t emitters = 0;
+    for (uint32_t i = 0; i < m_emitters.size(); ++i) {
+        Emitter& e = m_emitters[i];
+        if (!e.active)
+            continue;
+        ++emitters;
+        e.firstJob = static_cast<uint32_t>(m_jobList.size());
+        for (uint32_t begin = 0; begin < e.count; begin += grain)
+            m_jobList.push_back({ i, begin, std::min(begin + grain, e.count), {}, {} });
+        e.jobCount = static_cast<uint32_t>(m_jobList.size()) - e.firstJob;
+        live += e.count;
+    }
+    const uint32_t jobs = static_cast<uint32_t>(m_jobList.size());
+    if (m_jobDead.size() < jobs)
+        m_jobDead.resize(jobs);
+
+    const bool parallel = m_jobs && live >= m_settings.parallelThreshold;
+
+    // 1. Move and age every particle, note the ones that died.
+    auto integrate = [this, dt](uint32_t begin, uint32_t end) {
+        for (uint32_t j = begin; j < end; ++j)
+            Integrate(m_jobList[j], dt);
+    };
+    if (parallel)
+        m_jobs->ParallelFor(jobs, Grain(jobs, live, m_settings.particlesPerJob), integrate);
+    else
+        integrate(0, jobs);
+
+    // 2. Per emitter: fill the holes, spawn new particles.
+    auto finish = [this, dt](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            Emitter& e = m_emitters[i];
+            if (!e.active)
+                continue;
+            Compact(e);
+            Spawn(e, dt);
+        }
+    };
+    const uint32_t slots = static_cast<uint32_t>(m_emitters.size());
+    if (parallel)
+        m_jobs->ParallelFor(slots, Grain(slots, live, m_settings.particlesPerJob), finish);
+    else
+        finish(0, slots);
+
+    m_stats.emitters = emitters;
+    for (const Emitter& e : m_emitters) {
+        if (!e.active) continue;
+        m_stats.live += e.count;
+        m_stats.spawned += e.spawned;
+        m_stats.died += e.died;
+    }
+}
+
+void ParticleSystem::Integrate(Job& job, float dt)
+{
+    Emitter& e = m_emitters[job.emitter];
+    const ParticleEmitterDesc& d = e.desc;
+    ParticleVector<uint32_t>& dead = m_jobDead[&job - m_jobList.data()];
+    dead.clear();
+
+    const Float4 dtv = Splat(dt);
+    const Float4 damping = Splat(1.0f / (1.0f + d.drag * dt));
+    const Float4 gx = Splat(d.gravity.x * dt);
+    const Float4 gy = Splat(d.gravity.y * dt);
+    const Float4 gz = Splat(d.gravity.z * dt);
+    const Float4 one = Splat(1.0f);
+    const Float4 lanes = Set(0.0f, 1.0f, 2.0f, 3.0f);
+
+    Float4 minX = Splat(INFINITY), minY = minX, minZ = minX;
+    Float4 maxX = Splat(-INFINITY), maxY = maxX, maxZ = maxX;
+
+    for (uint32_t i = job.begin; i < job.end; i += 4) {
+        const Float4 vx = Mul(Add(Load4(&e.vx[i]), gx), damping);
+        const Float4 vy = Mul(Add(Load4(&e.vy[i]), gy), damping);
+        const Float4 vz = Mul(Add(Load4(&e.vz[i]), gz), damping);
+        const Float4 px = MulAdd(vx, dtv, Load4(&e.px[i]));
+        const Float4 py = MulAdd(vy, dtv, Load4(&e.py[i]));
+        const Float4 pz = MulAdd(vz, dtv, Load4(&e.pz[i]));
+        const Float4 age = Add(Load4(&e.age[i]), dtv);
+        Store4(&e.vx[i], vx); Store4(&e.vy[i], vy); Store4(&e.vz[i], vz);
+        Store4(&e.px[i], px); Store4(&e.py[i], py); Store4(&e.pz[i], pz);
+        Store4(&e.age[i], age);
+
+        // The last group may run into the padding: leave those lanes out.
+        const Float4 valid = Less(lanes, Splat(float(job.end - i)));
+        minX = Select(minX, Min(minX, px), valid);
+        minY = Select(minY, Min(minY, py), valid);
+        minZ = Select(minZ, Min(minZ, pz), valid);
+        maxX = Select(maxX, Max(maxX, px), valid);
+        maxY = Select(maxY, Max(maxY, py), valid);
+        maxZ = Select(maxZ, Max(maxZ, pz), valid);
+
+        // One compare for 4 particles; mostly none of them died.
+        const int died = Mask(GreaterOrEqual(Mul(age, Load4(&e.invLife[i])), one));
+        if (died) {
+            for (uint32_t k = 0; k < 4 && i + k < job.end; ++k)
+                if (died & (1 << k))
+                    dead.push_back(i + k);
+        }
+    }
+
+    job.boundsMin = { HorizontalMin(minX), HorizontalMin(minY), HorizontalMin(minZ) };
+    job.boundsMax = { HorizontalMax(maxX), HorizontalMax(maxY), HorizontalMax(maxZ) };
+}
+
+void ParticleSystem::Compact(Emitter& e)
+{
+    XMVECTOR mn = XMVectorReplicate(INFINITY);
+    XMVECTOR mx = XMVectorReplicate(-INFINITY);
+    uint32_t died = 0;
+
+    // Highest hole first: everything after it is alive by then, so the
+    // particle moved into the hole is always a live one.
+    for (uint32_t j = e.firstJob + e.jobCount; j-- > e.firstJob;) {
+        const Job& job = m_jobList[j];
+        mn = XMVectorMin(mn, XMLoadFloat3(&job.boundsMin));
+        mx = XMVectorMax(mx, XMLoadFloat3(&job.boundsMax));
+
+        const ParticleVector<uint32_t>& dead = m_jobDead[j];
+        for (size_t k = dead.size(); k-- > 0;) {
+            const uint32_t hole = dead[k];
+            const uint32_t last = --e.count;
+            ++died;
+            if (hole == last)
+                continue;
+            e.px[hole] = e.px[last]; e.py[hole] = e.py[last]; e.pz[hole] = e.pz[last];
+            e.vx[hole] = e.vx[last]; e.vy[hole] = e.vy[last]; e.vz[hole] = e.vz[last];
+            e.age[hole] = e.age[last];
+            e.invLife[hole] = e.invLife[last];
+        }
+    }
+    e.died = died;
+    XMStoreFloat3(&e.boundsMin, mn);
+    XMStoreFloat3(&e.boundsMax, mx);
+}
+
+void ParticleSystem::Spawn(Emitter& e, float dt)
+{
+    const ParticleEmitterDesc& d = e.desc;
+    const float wanted = std::max(d.rate, 0.0f) * dt + e.carry;
+    uint32_t n = uint32_t(wanted);
+    e.carry = wanted - float(n);
+    n += e.burst;
+    e.burst = 0;
+    n = std::min(n, d.capacity > e.count ? d.capacity - e.count : 0u);
+    e.spawned = n;
+    if (n == 0)
+        return;
+
+    Reserve(e, e.count + n);
+    const float lifeRange = std::max(d.lifetimeMax - d.lifetimeMin, 0.0f);
+    for (uint32_t k = 0; k < n; ++k) {
+        const uint32_t i = e.count++;
+        e.px[i] = d.position.x;
+        e.py[i] = d.position.y;
+        e.pz[i] = d.position.z;
+        e.vx[i] = d.velocity.x + (Random(e.rng) * 2.0f - 1.0f) * d.velocitySpread;
+        e.vy[i] = d.velocity.y + (Random(e.rng) * 2.0f - 1.0f) * d.velocitySpread;
+        e.vz[i] = d.velocity.z + (Random(e.rng) * 2.0f - 1.0f) * d.velocitySpread;
+        e.age[i] = 0.0f;
+        e.invLife[i] = 1.0f / std::max(d.lifetimeMin + Random(e.rng) * lifeRange, 1e-4f);
+    }
+
+    const XMVECTOR p = XMLoadFloat3(&d.position);
+    XMStoreFloat3(&e.boundsMin, XMVectorMin(XMLoadFloat3(&e.boundsMin), p));
+    XMStoreFloat3(&e.boundsMax, XMVectorMax(XMLoadFloat3(&e.boundsMax), p));
+}
+
+// ---- Submit ----
+
+void ParticleSystem::Submit(const MeshStorage& meshes, RenderQueue& queue, const RenderView& view)
+{
+    m_stats.batches = m_stats.culled = 0;
+    m_stats.instances = 0;
+    m_jobList.clear();
+
+    const Frustum frustum = BuildFrustum(XMLoadFloat4x4(&view.viewProj));
+    XMFLOAT4X4 identity;
+    XMStoreFloat4x4(&identity, XMMatrixIdentity());
+    const uint32_t grain = RoundUp4(std::max(m_settings.particlesPerJob, 4u));
+
+    // Serial: cull, reserve the instances, one item per emitter.
+    uint64_t instances = 0;
+    for (uint32_t i = 0; i < m_emitters.size(); ++i) {
+        Emitter& e = m_emitters[i];
+        const MeshData* mesh = meshes.Get(e.desc.mesh);
+        if (!e.active || e.count == 0 || !mesh)
+            continue;
+
+        const XMVECTOR mn = XMLoadFloat3(&e.boundsMin);
+        const XMVECTOR mx = XMLoadFloat3(&e.boundsMax);
+        XMFLOAT3 center;
+        XMStoreFloat3(&center, XMVectorScale(XMVectorAdd(mn, mx), 0.5f));
+        const float size = std::max(std::fabs(e.desc.startSize), std::fabs(e.desc.endSize));
+        const float radius = XMVectorGetX(XMVector3Length(XMVectorSubtract(mx, mn))) * 0.5f +
+                             (std::sqrt(mesh->boundsCenter.x * mesh->boundsCenter.x + mesh->boundsCenter.y * mesh->boundsCenter.y +
+                                        mesh->boundsCenter.z * mesh->boundsCenter.z) + mesh->boundsRadius) * size;
+        if (!SphereInFrustum(frustum, center, radius)) {
+            ++m_stats.culled;
+            continue;
+        }
+
+        e.firstInstance = queue.AllocateInstances(e.count);
+        queue.SubmitInstanced(identity, e.desc.mesh, 0, e.firstInstance, e.count); // 0: no entity
+        const uint64_t triangles = uint64_t(mesh->indices.size() / 3) * e.count;
+        queue.AddTriangles(triangles, triangles);
+        for (uint32_t begin = 0; begin < e.count; begin += grain)
+            m_jobList.push_back({ i, begin, std::min(begin + grain, e.count), {}, {} });
+        ++m_stats.batches;
+        m_stats.instances += e.count;
+        instances += e.count;
+    }
+
+    // Parallel: the instance data, every job its own range of one emitter.
+    RenderInstance* out = queue.InstanceData();
+    auto write = [this, out](uint32_t begin, uint32_t end) {
+        for (uint32_t j = begin; j < end; ++j) {
+            const Job& job = m_jobList[j];
+            const Emitter& e = m_emitters[job.emitter];
+            WriteInstances(e, job.begin, job.end, out + e.firstInstance);
+        }
+    };
+    const uint32_t jobs = static_cast<uint32_t>(m_jobList.size());
+    if (m_jobs && instances >= m_settings.parallelThreshold)
+        m_jobs->ParallelFor(jobs, Grain(jobs, instances, m_settings.particlesPerJob), write);
+    else
+        write(0, jobs);
+}
+
+void ParticleSystem::WriteInstances(const Emitter& e, uint32_t begin, uint32_t end, RenderInstance* out) const
+{
+    const Float4 startSize = Splat(e.desc.startSize);
+    const Float4 sizeChange = Splat(e.desc.endSize - e.desc.startSize);
+    const Float4 one = Splat(1.0f);
+
+    // 4 particles as 4 rows (x, y, z, size); transposed they are 4 instances.
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const Float4 t = Min(Mul(Load4(&e.age[i]), Load4(&e.invLife[i])), one);
+        Float4 x = Load4(&e.px[i]);
+        Float4 y = Load4(&e.py[i]);
+        Float4 z = Load4(&e.pz[i]);
+        Float4 size = MulAdd(t, sizeChange, startSize);
+        Transpose(x, y, z, size);
+        Store4(&out[i].x, x);
+        Store4(&out[i + 1].x, y);
+        Store4(&out[i + 2].x, z);
+        Store4(&out[i + 3].x, size);
+    }
+    for (; i < end; ++i) {
+        const float t = std::min(e.age[i] * e.invLife[i], 1.0f);
+        out[i] = { e.px[i], e.py[i], e.pz[i], e.desc.startSize + t * (e.desc.endSize - e.desc.startSize) };
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include "Renderer/MeshHandle.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/Camera.h"
+#include "Memory/AllocTracker.h"
+
+class JobSystem;
+class MeshStorage;
+
+// Particle arrays are charged to AllocTag::Particles, see Memory/AllocTracker.h
+template<typename T>
+using ParticleVector = std::vector<T, TaggedAllocator<T, AllocTag::Particles>>;
+
+using EmitterHandle = uint32_t;
+constexpr EmitterHandle InvalidEmitter = 0;
+
+struct ParticleEmitterDesc {
+    DirectX::XMFLOAT3 position{ 0.0f, 0.0f, 0.0f };
+    DirectX::XMFLOAT3 velocity{ 0.0f, 4.0f, 0.0f }; // at birth, plus a random part:
+    float velocitySpread = 1.0f;                    // +- this much on every axis
+    DirectX::XMFLOAT3 gravity{ 0.0f, -9.81f, 0.0f };
+    float drag = 0.0f;                              // air drag: velocity decays about e^-drag per second
+
+    float rate = 100.0f;        // particles per second (0 = only Burst)
+    float lifetimeMin = 1.0f;   // seconds, random in [min, max]
+    float lifetimeMax = 2.0f;
+    float startSize = 0.1f;     // scale of `mesh`, shrinking or growing over the lifetime
+    float endSize = 0.0f;
+
+    uint32_t capacity = 4096;   // most particles alive at once; the rest isn't spawned
+    MeshHandle mesh = InvalidMesh;
+    uint32_t seed = 1;          // same seed, same particles
+};
+
+struct ParticleSettings {
+    uint32_t parallelThreshold = 16384; // fewer live particles: Update stays on this thread
+    uint32_t particlesPerJob = 16384;   // big emitters are split, small ones share a job
+};
+
+struct ParticleStats {
+    uint32_t emitters = 0;
+    uint32_t live = 0;       // after the last Update
+    uint32_t spawned = 0;    // in the last Update
+    uint32_t died = 0;
+    uint32_t batches = 0;    // instanced draws from the last Submit
+    uint32_t culled = 0;     // emitters outside the view
+    uint64_t instances = 0;
+};
+
+/*
+ * ParticleSystem
+ * Sparks, smoke, debris: many small short-lived things that only fly and
+ * fade. As entities each would need a Transform, a Mesh and a draw call;
+ * here a particle is 32 bytes in its emitter's arrays and every emitter is
+ * one instanced draw.
+ *
+ * Each emitter stores its particles "structure of arrays" (all x together,
+ * all y together, ...), padded to a multiple of 4, so Update handles 4
+ * particles per Simd::Float4 operation (Math/SimdLanes.h):
+ *
+ *   v = (v + gravity * dt) / (1 + drag * dt);  p += v * dt;  age += dt
+ *
+ * A particle dies when age * (1 / lifetime) reaches 1. Dead particles are
+ * found while integrating (one compare per 4), then each hole is filled
+ * with the last live particle: no search, no shifting, the order of the
+ * particles just doesn't matter. New ones go at the end.
+ *
+ * Update splits the work into jobs of about `particlesPerJob` particles:
+ * a big emitter spreads over several, small emitters are grouped.
+ * Compaction and spawning then run per emitter, also in parallel. Every
+ * emitter has its own random generator, so results don't depend on the
+ * number of threads.
+ *
+ * Submit skips emitters whose particles are outside the view and writes
+ * one RenderInstance per particle (position, size) into the RenderQueue,
+ * again in parallel, and submits one instanced item per emitter.
+ */
+class ParticleSystem {
+public:
+    void SetSettings(const ParticleSettings& settings) { m_settings = settings; }
+    const ParticleSettings& GetSettings() const { return m_settings; }
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+
+    EmitterHandle AddEmitter(const ParticleEmitterDesc& desc);
+    void RemoveEmitter(EmitterHandle h);
+    // nullptr if `h` was removed. Changes apply from the next Update
+    // (capacity: only growing, and only for the next particles spawned).
+    ParticleEmitterDesc* GetDesc(EmitterHandle h);
+    const ParticleEmitterDesc* GetDesc(EmitterHandle h) const;
+    void SetPosition(EmitterHandle h, const DirectX::XMFLOAT3& position);
+    // `count` extra particles on the next Update, on top of `rate`.
+    void Burst(EmitterHandle h, uint32_t count);
+    void Clear();
+
+    void Update(float dt);
+    // Call after BuildRenderQueue (it clears the queue).
+    void Submit(const MeshStorage& meshes, RenderQueue& queue, const RenderView& view);
+
+    uint32_t LiveCount(EmitterHandle h) const;
+    const ParticleStats& GetStats() const { return m_stats; }
+
+    // Particle i of an emitter, for tools and checks.
+    DirectX::XMFLOAT3 GetParticlePosition(EmitterHandle h, uint32_t i) const;
+    float GetParticleAge(EmitterHandle h, uint32_t i) const;
+
+private:
+    struct Emitter {
+        ParticleEmitterDesc desc;
+        bool active = false;
+        uint32_t count = 0;
+        uint32_t rng = 1;
+        float carry = 0.0f;    // fraction of a particle left over from the last spawn
+        uint32_t burst = 0;
+        uint32_t spawned = 0, died = 0;
+        uint32_t firstJob = 0, jobCount = 0; // of the last Update
+        DirectX::XMFLOAT3 boundsMin{ 0.0f, 0.0f, 0.0f }, boundsMax{ 0.0f, 0.0f, 0.0f };
+        uint32_t firstInstance = 0;          // of the last Submit
+
+        // Per particle, padded to a multiple of 4
+        ParticleVector<float> px, py, pz;
+        ParticleVector<float> vx, vy, vz;
+        ParticleVector<float> age;
+        ParticleVector<float> invLife; // 1 / lifetime
+    };
+
+    // A piece of one emitter for Update.
+    struct Job {
+        uint32_t emitter;
+        uint32_t begin, end;
+        DirectX::XMFLOAT3 boundsMin, boundsMax;
+    };
+
+    Emitter* Find(EmitterHandle h);
+    const Emitter* Find(EmitterHandle h) const;
+    void Reserve(Emitter& e, uint32_t count);
+    void Integrate(Job& job, float dt);
+    void Compact(Emitter& e);
+    void Spawn(Emitter& e, float dt);
+    // Particles [begin, end) of `e` into out[begin, end).
+    void WriteInstances(const Emitter& e, uint32_t begin, uint32_t end, RenderInstance* out) const;
+
+private:
+    ParticleSettings m_settings;
+    JobSystem* m_jobs = nullptr; // optional
+
+    std::vector<Emitter> m_emitters; // m_emitters[h - 1]
+    ParticleVector<Job> m_jobList;                 // scratch of Update, then of Submit
+    ParticleVector<ParticleVector<uint32_t>> m_jobDead; // per job: dead particles, ascending
+
+    ParticleStats m_stats;
+};
@@ -0,0 +1,510 @@
+#include "PhysicsWorld.h"
+#include "Math/GridKey.h"
+#include "Math/SimdLanes.h"
+#include "Threading/JobSystem.h"
+#include "World/ECS/Component/Transform.h"
+#include "World/ECS/Entity/Entity.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+using namespace Simd;
+
+namespace {
+    // Overlap pushed out per Solve; the rest stays so resting bodies don't jitter.
+    constexpr float PenetrationSlop = 0.005f;
+    constexpr float PenetrationFix = 0.8f;
+
+    // One axis of 4 bodies: semi-implicit Euler, then the bounds on that axis.
+    // Static and padding bodies (dynamic = false) keep their values.
+    void IntegrateAxis(float* pos, float* vel, Float4 gravityDt, Float4 damping, Float4 dt,
+                       Float4 dynamic, Float4 radius, Float4 restitution,
+                       const float* lo, const float* hi)
+    {
+        const Float4 p0 = Load4(pos);
+        const Float4 v0 = Load4(vel);
+        Float4 v = Mul(Add(v0, gravityDt), damping);
+        Float4 p = MulAdd(v, dt, p0);
+
+        if (lo) {
+            const Float4 min = Add(Splat(*lo), radius);
+            const Float4 max = Sub(Splat(*hi), radius);
+            const Float4 bounce = Mul(Abs(v), restitution);
+            v = Select(v, bounce, Less(p, min));
+            v = Select(v, Negate(bounce), Greater(p, max));
+            p = Max(Min(p, max), min);
+        }
+
+        Store4(pos, Select(p0, p, dynamic));
+        Store4(vel, Select(v0, v, dynamic));
+    }
+}
+
+// ---- Bodies ----
+
+void PhysicsWorld::Resize(uint32_t count)
+{
+    // New padding lanes are zero: no mass, no velocity, they never move.
+    const size_t padded = RoundUp4(count);
+    for (EcsVector<float>* a : { &m_px, &m_py, &m_pz, &m_vx, &m_vy, &m_vz, &m_invMass, &m_radius, &m_restitution })
+        a->resize(padded, 0.0f);
+    m_entity.resize(padded, InvalidEntity);
+    m_transformIndex.resize(padded, 0);
+    m_count = count;
+    m_stats.bodies = count;
+}
+
+bool PhysicsWorld::AddBody(Entity e, const XMFLOAT3& position, const RigidBodyDesc& desc)
+{
+    if (HasBody(e))
+        return false;
+
+    const uint32_t i = m_count;
+    Resize(m_count + 1);
+    m_px[i] = position.x;
+    m_py[i] = position.y;
+    m_pz[i] = position.z;
+    m_vx[i] = desc.velocity.x;
+    m_vy[i] = desc.velocity.y;
+    m_vz[i] = desc.velocity.z;
+    m_invMass[i] = desc.mass > 0.0f ? 1.0f / desc.mass : 0.0f;
+    m_radius[i] = desc.radius;
+    m_restitution[i] = desc.restitution;
+    m_entity[i] = e;
+
+    if (e >= m_bodyOf.size())
+        m_bodyOf.resize(size_t(e) + 1, NoBody);
+    m_bodyOf[e] = i;
+
+    m_maxRadius = std::max(m_maxRadius, desc.radius);
+
+    // The insertion sort of the next FindPairs moves it to its place.
+    m_order.push_back({ 0, 0.0f, i });
+    return true;
+}
+
+bool PhysicsWorld::RemoveBody(Entity e)
+{
+    const uint32_t i = BodyOf(e);
+    if (i == NoBody)
+        return false;
+
+    // The last body takes the free index.
+    const uint32_t last = m_count - 1;
+    m_px[i] = m_px[last];
+    m_py[i] = m_py[last];
+    m_pz[i] = m_pz[last];
+    m_vx[i] = m_vx[last];
+    m_vy[i] = m_vy[last];
+    m_vz[i] = m_vz[last];
+    m_invMass[i] = m_invMass[last];
+    m_radius[i] = m_radius[last];
+    m_restitution[i] = m_restitution[last];
+    m_entity[i] = m_entity[last];
+    m_transformIndex[i] = m_transformIndex[last];
+    m_bodyOf[m_entity[i]] = i;
+    m_bodyOf[e] = NoBody;
+
+    // `last` is padding now.
+    m_vx[last] = m_vy[last] = m_vz[last] = 0.0f;
+    m_invMass[last] = 0.0f;
+    m_entity[last] = InvalidEntity;
+    Resize(last);
+
+    // Same order for everybody else; `last` is now called `i`.
+    uint32_t kept = 0;
+    for (SortEntry s : m_order) {
+        if (s.body == i) continue;
+        if (s.body == last) s.body = i;
+        m_order[kept++] = s;
+    }
+    m_order.resize(kept);
+    m_pairs.clear();
+    m_contacts.clear();
+    return true;
+}
+
+void PhysicsWorld::Clear()
+{
+    Resize(0);
+    m_bodyOf.clear();
+    m_order.clear();
+    m_pairs.clear();
+    m_contacts.clear();
+    m_orderValid = false;
+    m_maxRadius = 0.0f;
+}
+
+XMFLOAT3 PhysicsWorld::GetPosition(Entity e) const
+{
+    const uint32_t i = BodyOf(e);
+    return i == NoBody ? XMFLOAT3{ 0, 0, 0 } : XMFLOAT3{ m_px[i], m_py[i], m_pz[i] };
+}
+
+XMFLOAT3 PhysicsWorld::GetVelocity(Entity e) const
+{
+    const uint32_t i = BodyOf(e);
+    return i == NoBody ? XMFLOAT3{ 0, 0, 0 } : XMFLOAT3{ m_vx[i], m_vy[i], m_vz[i] };
+}
+
+void PhysicsWorld::SetPosition(Entity e, const XMFLOAT3& p)
+{
+    const uint32_t i = BodyOf(e);
+    if (i == NoBody) return;
+    m_px[i] = p.x;
+    m_py[i] = p.y;
+    m_pz[i] = p.z;
+}
+
+void PhysicsWorld::SetVelocity(Entity e, const XMFLOAT3& v)
+{
+    const uint32_t i = BodyOf(e);
+    if (i == NoBody) return;
+    m_vx[i] = v.x;
+    m_vy[i] = v.y;
+    m_vz[i] = v.z;
+}
+
+void PhysicsWorld::ApplyImpulse(Entity e, const XMFLOAT3& impulse)
+{
+    const uint32_t i = BodyOf(e);
+    if (i == NoBody) return;
+    m_vx[i] += impulse.x * m_invMass[i];
+    m_vy[i] += impulse.y * m_invMass[i];
+    m_vz[i] += impulse.z * m_invMass[i];
+}
+
+// ---- Step ----
+
+void PhysicsWorld::Step(float dt)
+{
+    Integrate(dt);
+    FindPairs();
+    FindContacts();
+    SolveContacts();
+}
+
+void PhysicsWorld::Integrate(float dt)
+{
+    const PhysicsSettings& s = m_settings;
+    const Float4 dtv = Splat(dt);
+    const Float4 damping = Splat(1.0f / (1.0f + s.linearDamping * dt));
+    const Float4 gx = Splat(s.gravity.x * dt);
+    const Float4 gy = Splat(s.gravity.y * dt);
+    const Float4 gz = Splat(s.gravity.z * dt);
+    const Float4 zero = Splat(0.0f);
+    const bool bounds = s.bounds;
+
+    auto integrate = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i += 4) {
+            const Float4 dynamic = Greater(Load4(&m_invMass[i]), zero);
+            const Float4 radius = Load4(&m_radius[i]);
+            const Float4 restitution = Load4(&m_restitution[i]);
+            IntegrateAxis(&m_px[i], &m_vx[i], gx, damping, dtv, dynamic, radius, restitution,
+                          bounds ? &s.boundsMin.x : nullptr, &s.boundsMax.x);
+            IntegrateAxis(&m_py[i], &m_vy[i], gy, damping, dtv, dynamic, radius, restitution,
+                          bounds ? &s.boundsMin.y : nullptr, &s.boundsMax.y);
+            IntegrateAxis(&m_pz[i], &m_vz[i], gz, damping, dtv, dynamic, radius, restitution,
+                          bounds ? &s.boundsMin.z : nullptr, &s.boundsMax.z);
+        }
+    };
+
+    const uint32_t padded = RoundUp4(m_count);
+    if (m_jobs && m_count >= s.parallelThreshold)
+        m_jobs->ParallelFor(padded, RoundUp4(std::max(s.bodiesPerJob, 4u)), integrate);
+    else
+        integrate(0, padded);
+}
+
+uint64_t PhysicsWorld::ColumnKey(float y, float z) const
+{
+    return GridKey(0, GridCoord(y, m_invColumnSize), GridCoord(z, m_invColumnSize));
+}
+
+// Brings m_order back into order of (column, minimum x) and gathers the boxes in that order.
+void PhysicsWorld::SortBodies()
+{
+    const uint32_t n = m_count;
+
+    // Columns at least as wide as the biggest box: touching bodies are
+    // then always in the same or in neighbouring columns.
+    float columnSize = std::max(m_settings.columnSize, 2.0f * m_maxRadius);
+    if (columnSize <= 0.0f) columnSize = 1.0f;
+    if (columnSize != m_columnSize) {
+        m_columnSize = columnSize;
+        m_invColumnSize = 1.0f / columnSize;
+        m_orderValid = false;
+    }
+
+    // Bodies that changed column would travel far in the order, so they
+    // are taken out, sorted on their own and merged back in later.
+    m_moved.clear();
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        SortEntry s = m_order[i];
+        const uint64_t column = ColumnKey(m_py[s.body], m_pz[s.body]);
+        s.minX = m_px[s.body] - m_radius[s.body];
+        if (column != s.column) {
+            s.column = column;
+            m_moved.push_back(s);
+        }
+        else {
+            m_order[kept++] = s;
+        }
+    }
+    m_order.resize(kept);
+
+    // The rest only moved a little along x inside their column: insertion
+    // sort, cheap when almost sorted. If bodies moved a lot it gives up and
+    // sorts from scratch.
+    bool sorted = m_orderValid && m_moved.size() <= n / 4;
+    uint64_t shifts = 0;
+    if (sorted) {
+        const uint64_t budget = uint64_t(n) * 8 + 64;
+        for (uint32_t i = 1; i < kept && sorted; ++i) {
+            const SortEntry s = m_order[i];
+            uint32_t j = i;
+            while (j > 0 && s < m_order[j - 1]) {
+                m_order[j] = m_order[j - 1];
+                --j;
+                if (++shifts > budget) { sorted = false; break; }
+            }
+            m_order[j] = s;
+        }
+    }
+    if (sorted) {
+        std::sort(m_moved.begin(), m_moved.end());
+        m_merged.resize(n);
+        std::merge(m_order.begin(), m_order.end(), m_moved.begin(), m_moved.end(), m_merged.begin());
+        m_order.swap(m_merged);
+    }
+    else {
+        m_order.insert(m_order.end(), m_moved.begin(), m_moved.end());
+        std::sort(m_order.begin(), m_order.end());
+        ++m_stats.fullSorts;
+    }
+    m_stats.columnChanges = uint32_t(m_moved.size());
+    ReorderBodies();
+    m_orderValid = true;
+    m_stats.sortShifts = uint32_t(std::min<uint64_t>(shifts, UINT32_MAX));
+
+    // The sweep reads these front to back instead of jumping around the bodies.
+    m_minX.resize(n); m_maxX.resize(n); m_minY.resize(n); m_maxY.resize(n); m_minZ.resize(n); m_maxZ.resize(n);
+    m_static.resize(n);
+    m_columns.clear();
+    for (uint32_t i = 0; i < n; ++i) {
+        const SortEntry& s = m_order[i];
+        const float r = m_radius[i];
+        m_minX[i] = s.minX;
+        m_maxX[i] = m_px[i] + r;
+        m_minY[i] = m_py[i] - r;
+        m_maxY[i] = m_py[i] + r;
+        m_minZ[i] = m_pz[i] - r;
+        m_maxZ[i] = m_pz[i] + r;
+        m_static[i] = m_invMass[i] == 0.0f;
+
+        if (m_columns.empty() || m_columns.back().key != s.column)
+            m_columns.push_back({ s.column, i, i });
+        m_columns.back().end = i + 1;
+    }
+}
+
+// Moves the bodies into the sorted order, so body i is m_order[i]. Bodies
+// close in space are then close in memory: the sweep, the narrowphase and
+// the solver read them almost in order instead of all over the place.
+// Next tick the order is nearly the same, so this is mostly a plain copy.
+void PhysicsWorld::ReorderBodies()
+{
+    const uint32_t n = m_count;
+    uint32_t first = 0;
+    while (first < n && m_order[first].body == first)
+        ++first;
+    if (first == n)
+        return;
+
+    auto permute = [&](auto& field, auto& scratch) {
+        scratch.resize(field.size());
+        std::copy(field.begin(), field.begin() + first, scratch.begin());
+        for (uint32_t i = first; i < n; ++i)
+            scratch[i] = field[m_order[i].body];
+        std::copy(field.begin() + n, field.end(), scratch.begin() + n); // padding
+        field.swap(scratch);
+    };
+    for (EcsVector<float>* f : { &m_px, &m_py, &m_pz, &m_vx, &m_vy, &m_vz, &m_invMass, &m_radius, &m_restitution })
+        permute(*f, m_scratchFloat);
+    permute(m_entity, m_scratchIndex);
+    permute(m_transformIndex, m_scratchIndex);
+
+    for (uint32_t i = first; i < n; ++i) {
+        if (m_order[i].body != i)
+            m_bodyOf[m_entity[i]] = i;
+        m_order[i].body = i;
+    }
+}
+
+// Boxes i and j (sorted order) overlap on x already.
+void PhysicsWorld::TestBoxes(uint32_t i, uint32_t j, EcsVector<Pair>& out) const
+{
+    // One branch instead of five: most boxes here don't overlap, and the
+    // CPU can't guess which.
+    const bool overlap = (m_minY[j] <= m_maxY[i]) & (m_maxY[j] >= m_minY[i]) &
+                         (m_minZ[j] <= m_maxZ[i]) & (m_maxZ[j] >= m_minZ[i]) & !(m_static[i] & m_static[j]);
+    if (!overlap) return;
+    out.push_back(i < j ? Pair{ i, j } : Pair{ j, i });
+}
+
+// Every column against itself and against the neighbours in front of it
+// (the ones behind did this column already).
+void PhysicsWorld::SweepColumns(uint32_t begin, uint32_t end, EcsVector<Pair>& out) const
+{
+    static const int32_t Neighbours[4][2] = { { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 } };
+
+    for (uint32_t c = begin; c < end; ++c) {
+        const Column& a = m_columns[c];
+        for (uint32_t i = a.begin; i < a.end; ++i)
+            for (uint32_t j = i + 1; j < a.end && m_minX[j] <= m_maxX[i]; ++j)
+                TestBoxes(i, j, out);
+
+        const int32_t y = GridKeyAxis(a.key, 1), z = GridKeyAxis(a.key, 2);
+        for (const auto& d : Neighbours) {
+            if (y + d[0] > GridLimit || z + d[1] > GridLimit) continue; // edge of the packed range
+            const uint64_t key = GridKey(0, y + d[0], z + d[1]);
+            const auto it = std::lower_bound(m_columns.begin() + c + 1, m_columns.end(), key,
+                [](const Column& col, uint64_t k) { return col.key < k; });
+            if (it == m_columns.end() || it->key != key) continue;
+
+            // Two sorted lists: whichever box starts first checks the
+            // other list until the boxes there start after it ends.
+            uint32_t i = a.begin, j = it->begin;
+            while (i < a.end && j < it->end) {
+                if (m_minX[i] <= m_minX[j]) {
+                    for (uint32_t k = j; k < it->end && m_minX[k] <= m_maxX[i]; ++k)
+                        TestBoxes(i, k, out);
+                    ++i;
+                }
+                else {
+                    for (uint32_t k = i; k < a.end && m_minX[k] <= m_maxX[j]; ++k)
+                        TestBoxes(j, k, out);
+                    ++j;
+                }
+            }
+        }
+    }
+}
+
+void PhysicsWorld::FindPairs()
+{
+    m_pairs.clear();
+    if (m_order.size() != m_count)
+        m_orderValid = false;
+    SortBodies();
+
+    const uint32_t columns = uint32_t(m_columns.size());
+    if (m_jobs && m_count >= m_settings.parallelThreshold) {
+        // Each job fills its own list; joined in order, so the pairs come
+        // out the same however the jobs were scheduled.
+        const uint32_t grain = std::max(m_settings.columnsPerJob, 1u);
+        const uint32_t chunks = (columns + grain - 1) / grain;
+        if (m_chunkPairs.size() < chunks)
+            m_chunkPairs.resize(chunks);
+        m_jobs->ParallelFor(columns, grain, [&](uint32_t begin, uint32_t end) {
+            EcsVector<Pair>& out = m_chunkPairs[begin / grain];
+            out.clear();
+            SweepColumns(begin, end, out);
+        });
+        for (uint32_t c = 0; c < chunks; ++c)
+            m_pairs.insert(m_pairs.end(), m_chunkPairs[c].begin(), m_chunkPairs[c].end());
+    }
+    else {
+        SweepColumns(0, columns, m_pairs);
+    }
+    m_stats.pairs = uint32_t(m_pairs.size());
+}
+
+void PhysicsWorld::TestPairs(uint32_t begin, uint32_t end)
+{
+    for (uint32_t p = begin; p < end; ++p) {
+        const uint32_t a = m_pairs[p].a, b = m_pairs[p].b;
+        const float dx = m_px[b] - m_px[a], dy = m_py[b] - m_py[a], dz = m_pz[b] - m_pz[a];
+        const float r = m_radius[a] + m_radius[b];
+        m_touching[p] = dx * dx + dy * dy + dz * dz < r * r;
+    }
+}
+
+void PhysicsWorld::FindContacts()
+{
+    const uint32_t n = uint32_t(m_pairs.size());
+    m_touching.resize(n);
+    if (m_jobs && n >= m_settings.parallelThreshold)
+        m_jobs->ParallelFor(n, std::max(m_settings.pairsPerJob, 1u),
+            [this](uint32_t begin, uint32_t end) { TestPairs(begin, end); });
+    else
+        TestPairs(0, n);
+
+    m_contacts.clear();
+    for (uint32_t p = 0; p < n; ++p)
+        if (m_touching[p])
+            m_contacts.push_back(m_pairs[p]);
+    m_stats.contacts = uint32_t(m_contacts.size());
+}
+
+// One pass over the contacts, in order: push apart, then bounce if they approach.
+void PhysicsWorld::SolveContacts()
+{
+    for (const Pair& c : m_contacts) {
+        const uint32_t a = c.a, b = c.b;
+        const float wa = m_invMass[a], wb = m_invMass[b];
+        const float w = wa + wb;
+        if (w == 0.0f) continue;
+
+        float nx = m_px[b] - m_px[a], ny = m_py[b] - m_py[a], nz = m_pz[b] - m_pz[a];
+        const float dist = std::sqrt(nx * nx + ny * ny + nz * nz);
+        const float depth = m_radius[a] + m_radius[b] - dist;
+        if (depth <= 0.0f) continue; // an earlier contact already separated them
+        if (dist > 1e-6f) { nx /= dist; ny /= dist; nz /= dist; }
+        else { nx = 0.0f; ny = 1.0f; nz = 0.0f; }
+
+        const float push = std::max(depth - PenetrationSlop, 0.0f) * PenetrationFix / w;
+        m_px[a] -= nx * push * wa; m_py[a] -= ny * push * wa; m_pz[a] -= nz * push * wa;
+        m_px[b] += nx * push * wb; m_py[b] += ny * push * wb; m_pz[b] += nz * push * wb;
+
+        const float vn = (m_vx[b] - m_vx[a]) * nx + (m_vy[b] - m_vy[a]) * ny + (m_vz[b] - m_vz[a]) * nz;
+        if (vn >= 0.0f) continue;
+        const float e = std::min(m_restitution[a], m_restitution[b]);
+        const float j = -(1.0f + e) * vn / w;
+        m_vx[a] -= nx * j * wa; m_vy[a] -= ny * j * wa; m_vz[a] -= nz * j * wa;
+        m_vx[b] += nx * j * wb; m_vy[b] += ny * j * wb; m_vz[b] += nz * j * wb;
+    }
+}
+
+// ---- Transforms ----
+
+void PhysicsWorld::WriteTransforms(World& world)
+{
+    ComponentPool<Transform>& pool = world.GetPool<Transform>();
+    const EcsVector<Entity>& entities = pool.Entities();
+    Transform* data = pool.Data().data();
+    const uint32_t size = uint32_t(entities.size());
+
+    // m_transformIndex remembers where each body's Transform was last time,
+    // so the usual case is one compare instead of a lookup.
+    auto write = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            const Entity e = m_entity[i];
+            uint32_t index = m_transformIndex[i];
+            if (index >= size || entities[index] != e) {
+                const Transform* t = pool.TryGet(e);
+                if (!t) continue;
+                index = uint32_t(t - data);
+                m_transformIndex[i] = index;
+            }
+            data[index].position = { m_px[i], m_py[i], m_pz[i] };
+        }
+    };
+
+    if (m_jobs && m_count >= m_settings.parallelThreshold)
+        m_jobs->ParallelFor(m_count, std::max(m_settings.bodiesPerJob, 1u), write);
+    else
+        write(0, m_count);
+}
@@ -0,0 +1,177 @@
+#pragma once
+#include <cstdint>
+#include <DirectXMath.h>
+#include "World/ECS/World.h"
+
+class JobSystem;
+
+struct RigidBodyDesc {
+    DirectX::XMFLOAT3 velocity{ 0, 0, 0 };
+    float mass = 1.0f;        // 0 = static: never moves, other bodies bounce off it
+    float radius = 0.5f;      // bodies collide as spheres
+    float restitution = 0.5f; // 0 = no bounce, 1 = fully elastic
+};
+
+struct PhysicsSettings {
+    DirectX::XMFLOAT3 gravity{ 0.0f, -9.81f, 0.0f };
+    float linearDamping = 0.0f; // per second: each step scales velocity by 1 / (1 + linearDamping * dt)
+
+    // Optional box the bodies bounce off (walls, floor, ceiling).
+    bool bounds = false;
+    DirectX::XMFLOAT3 boundsMin{ -100.0f, 0.0f, -100.0f };
+    DirectX::XMFLOAT3 boundsMax{ 100.0f, 100.0f, 100.0f };
+
+    // Broadphase columns on y/z; never smaller than the largest body diameter.
+    float columnSize = 0.0f;
+
+    uint32_t parallelThreshold = 4096; // fewer bodies / pairs: that stage stays on this thread
+    uint32_t bodiesPerJob = 4096;
+    uint32_t columnsPerJob = 64;
+    uint32_t pairsPerJob = 2048;
+};
+
+struct PhysicsStats {
+    uint32_t bodies = 0;
+    uint32_t pairs = 0;       // overlapping boxes from the broadphase
+    uint32_t contacts = 0;    // pairs whose spheres really touch
+    uint32_t columnChanges = 0; // bodies that left their broadphase column
+    uint32_t sortShifts = 0;  // insertion sort moves in the last broadphase
+    uint64_t fullSorts = 0;   // broadphases that had to sort from scratch
+};
+
+/*
+ * PhysicsWorld
+ * Rigid bodies (spheres) with velocity, gravity and bouncing contacts.
+ * Gameplay sets velocities or applies impulses; Step moves the bodies and
+ * WriteTransforms puts the new positions into the entities' Transforms.
+ *
+ * Bodies are stored "structure of arrays": all x positions together, all
+ * y positions together, ... That way the integrator loads 4 bodies at a
+ * time into one Simd::Float4 per field (Math/SimdLanes.h) and updates
+ * them with a handful of SIMD instructions, instead of one body and one
+ * field at a time. The arrays are padded to a multiple of 4 with bodies
+ * that never move, so the loop has no leftover case.
+ *
+ * Step runs these stages (each also callable alone, e.g. to time them):
+ *
+ *   Integrate     v += gravity * dt, p += v * dt, bounce off the bounds
+ *   FindPairs     sweep and prune: bodies sorted by the left edge of their
+ *                 box on x; each body only checks the bodies after it until
+ *                 their left edge is past its right edge. Bodies move a
+ *                 little per tick, so last tick's order is almost sorted
+ *                 and an insertion sort fixes it in ~O(N).
+ *                 One sorted list for the whole world would compare every
+ *                 body with all bodies in its slice of x, so the world is
+ *                 first cut into columns along x (a grid on y/z): a body
+ *                 is sorted into the column of its centre and swept
+ *                 against its own column and the neighbouring ones.
+ *                 The few bodies that changed column are sorted apart
+ *                 and merged in.
+ *                 Columns are independent, so they are swept in parallel.
+ *   FindContacts  narrowphase: the exact sphere test for every pair, in
+ *                 parallel over the JobSystem (each pair writes its own
+ *                 slot, collected in order afterwards: deterministic).
+ *   SolveContacts pushes touching bodies apart and bounces them, on this
+ *                 thread, in pair order.
+ *
+ * Body indices change all the time (FindPairs keeps the bodies in
+ * broadphase order, so neighbours in space are neighbours in memory, and a
+ * removed body's place goes to the last one), so the API takes entities.
+ */
+class PhysicsWorld {
+public:
+    void SetSettings(const PhysicsSettings& settings) { m_settings = settings; }
+    const PhysicsSettings& GetSettings() const { return m_settings; }
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+
+    // false if `e` already has a body.
+    bool AddBody(Entity e, const DirectX::XMFLOAT3& position, const RigidBodyDesc& desc = {});
+    bool RemoveBody(Entity e);
+    bool HasBody(Entity e) const { return BodyOf(e) != NoBody; }
+    void Clear();
+
+    DirectX::XMFLOAT3 GetPosition(Entity e) const;
+    DirectX::XMFLOAT3 GetVelocity(Entity e) const;
+    void SetPosition(Entity e, const DirectX::XMFLOAT3& position); // teleport
+    void SetVelocity(Entity e, const DirectX::XMFLOAT3& velocity);
+    void ApplyImpulse(Entity e, const DirectX::XMFLOAT3& impulse); // velocity += impulse / mass
+
+    void Step(float dt);
+    void Integrate(float dt);
+    void FindPairs();
+    void FindContacts();
+    void SolveContacts();
+
+    // Copies body positions into the Transforms of their entities.
+    void WriteTransforms(World& world);
+
+    struct Pair { uint32_t a, b; }; // body indices, a < b
+    const EcsVector<Pair>& GetPairs() const { return m_pairs; }
+    const EcsVector<Pair>& GetContacts() const { return m_contacts; }
+
+    uint32_t Size() const { return m_count; }
+    Entity GetEntity(uint32_t body) const { return m_entity[body]; }
+    const PhysicsStats& GetStats() const { return m_stats; }
+
+private:
+    static constexpr uint32_t NoBody = ~0u;
+
+    struct SortEntry {
+        uint64_t column; // packed y/z column
+        float minX;
+        uint32_t body;
+        bool operator<(const SortEntry& o) const {
+            return column != o.column ? column < o.column : minX != o.minX ? minX < o.minX : body < o.body;
+        }
+    };
+
+    struct Column {
+        uint64_t key;
+        uint32_t begin, end; // range of the sorted order
+    };
+
+    uint32_t BodyOf(Entity e) const { return e < m_bodyOf.size() ? m_bodyOf[e] : NoBody; }
+    void Resize(uint32_t count);
+    uint64_t ColumnKey(float y, float z) const;
+    void SortBodies();
+    void ReorderBodies();
+    void SweepColumns(uint32_t begin, uint32_t end, EcsVector<Pair>& out) const;
+    void TestBoxes(uint32_t i, uint32_t j, EcsVector<Pair>& out) const;
+    void TestPairs(uint32_t begin, uint32_t end);
+
+private:
+    PhysicsSettings m_settings;
+    JobSystem* m_jobs = nullptr; // optional
+
+    uint32_t m_count = 0;
+    EcsVector<uint32_t> m_bodyOf; // indexed by entity
+
+    // Per body, padded to a multiple of 4
+    EcsVector<float> m_px, m_py, m_pz;
+    EcsVector<float> m_vx, m_vy, m_vz;
+    EcsVector<float> m_invMass;
+    EcsVector<float> m_radius;
+    EcsVector<float> m_restitution;
+    EcsVector<Entity> m_entity;
+    EcsVector<uint32_t> m_transformIndex; // guess for WriteTransforms
+
+    // Broadphase: bodies by column and minimum x, and their boxes in that order
+    EcsVector<SortEntry> m_order;
+    EcsVector<SortEntry> m_moved, m_merged; // scratch for SortBodies
+    EcsVector<float> m_scratchFloat;        // scratch for ReorderBodies
+    EcsVector<uint32_t> m_scratchIndex;
+    EcsVector<float> m_minX, m_maxX, m_minY, m_maxY, m_minZ, m_maxZ;
+    EcsVector<uint8_t> m_static;
+    EcsVector<Column> m_columns;
+    EcsVector<EcsVector<Pair>> m_chunkPairs; // per job, see FindPairs
+    float m_maxRadius = 0.0f;
+    float m_columnSize = 0.0f;
+    float m_invColumnSize = 1.0f;
+    bool m_orderValid = false;
+
+    EcsVector<Pair> m_pairs;
+    EcsVector<uint8_t> m_touching; // per pair, written by FindContacts
+    EcsVector<Pair> m_contacts;
+
+    PhysicsStats m_stats;
+};
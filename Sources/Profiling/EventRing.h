@@ -0,0 +1,57 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Profiler.h"
+
+namespace Profiler {
+
+    /*
+     * EventRing
+     * The per-thread buffer behind the profiler. Written by exactly one
+     * thread (its owner), read by whoever writes a trace. `head` counts
+     * every event ever pushed; event i lives in events[i % Capacity], so
+     * when the ring is full the oldest events are overwritten.
+     *
+     * The reader takes no lock: it copies, then drops whatever the owner
+     * may have overwritten meanwhile (see CopyTo).
+     */
+    template<uint64_t Capacity>
+    class EventRing {
+    public:
+        void Push(const Event& e) {
+            const uint64_t h = m_head.load(std::memory_order_relaxed);
+            m_events[h % Capacity] = e;
+            m_head.store(h + 1, std::memory_order_release); // publishes the event to readers
+        }
+
+        // Appends what is still valid, oldest first.
+        void CopyTo(std::vector<Event>& out) const {
+            const uint64_t before = m_head.load(std::memory_order_acquire);
+            const uint64_t first = before > Capacity ? before - Capacity : 0;
+
+            const size_t base = out.size();
+            for (uint64_t i = first; i < before; ++i)
+                out.push_back(m_events[i % Capacity]);
+
+            // The copies above must not move past the second read of `head`.
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // Anything the owner lapped while we copied is garbage: drop it.
+            // While writing event `after` it overwrites slot `after - Capacity`.
+            const uint64_t after = m_head.load(std::memory_order_relaxed);
+            const uint64_t safe = after + 1 > Capacity ? after + 1 - Capacity : 0;
+            if (safe > first) {
+                const size_t drop = size_t(std::min(safe, before) - first);
+                out.erase(out.begin() + base, out.begin() + base + drop);
+            }
+        }
+
+    private:
+        std::unique_ptr<Event[]> m_events{ new Event[Capacity] };
+        std::atomic<uint64_t> m_head{ 0 };
+    };
+
+} // namespace Profiler
@@ -0,0 +1,225 @@
+#include "Profiler.h"
+#include "EventRing.h"
+#include "Timing/Clock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Profiler {
+namespace {
+
+    // 64k events * 32 bytes = 2 MB per thread, a few seconds of a busy frame.
+    constexpr uint64_t RingCapacity = 1u << 16;
+
+    struct ThreadBuffer {
+        EventRing<RingCapacity> ring;
+        uint32_t tid = 0;
+        std::string name; // guarded by State::mutex
+    };
+
+    // What a trace file is written from, copied out under the mutex.
+    struct ThreadEvents {
+        uint32_t tid = 0;
+        std::string name;
+        std::vector<Event> events;
+    };
+
+    struct State {
+        std::mutex mutex; // only for registering threads, names and copying traces out
+        std::vector<std::unique_ptr<ThreadBuffer>> threads;
+        std::deque<std::string> internedNames; // deque: elements never move
+
+        std::atomic<uint64_t> frameIndex{ 0 };
+
+        // CaptureFrames: waiting -> running -> written.
+        // `captureActive` is the only part read without the mutex.
+        std::atomic<bool> captureActive{ false };
+        std::string capturePath;
+        uint32_t captureFrames = 0;
+        bool captureRunning = false;
+        int64_t captureStart = 0;
+        uint64_t captureEndFrame = 0;
+    };
+
+    State& GetState() {
+        static State state;
+        return state;
+    }
+
+    thread_local ThreadBuffer* t_buffer = nullptr;
+    thread_local uint32_t t_depth = 0;
+
+    ThreadBuffer& GetThreadBuffer() {
+        if (!t_buffer) {
+            State& s = GetState();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.threads.push_back(std::make_unique<ThreadBuffer>());
+            t_buffer = s.threads.back().get();
+            t_buffer->tid = uint32_t(s.threads.size());
+            t_buffer->name = "Thread " + std::to_string(t_buffer->tid);
+        }
+        return *t_buffer;
+    }
+
+    void Push(const Event& e) {
+        GetThreadBuffer().ring.Push(e);
+    }
+
+    // Caller holds State::mutex. Only events that start inside [from, to] are kept.
+    std::vector<ThreadEvents> CopyThreads(const State& s, int64_t from, int64_t to) {
+        std::vector<ThreadEvents> threads(s.threads.size());
+        for (size_t i = 0; i < s.threads.size(); ++i) {
+            threads[i].tid = s.threads[i]->tid;
+            threads[i].name = s.threads[i]->name;
+            std::vector<Event>& events = threads[i].events;
+            s.threads[i]->ring.CopyTo(events);
+            events.erase(std::remove_if(events.begin(), events.end(), [&](const Event& e) {
+                return e.start < from || e.start > to;
+            }), events.end());
+        }
+        return threads;
+    }
+
+    void WriteEscaped(std::FILE* f, const char* s) {
+        for (; *s; ++s) {
+            if (*s == '"' || *s == '\\') std::fputc('\\', f);
+            if (uint8_t(*s) < 0x20) continue;
+            std::fputc(*s, f);
+        }
+    }
+
+    // No lock needed: `threads` is a copy.
+    bool WriteTraceFile(const std::string& path, const std::vector<ThreadEvents>& threads) {
+        std::FILE* f = std::fopen(path.c_str(), "w");
+        if (!f) return false;
+
+        std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        auto separator = [&]() { if (!first) std::fprintf(f, ",\n"); first = false; };
+
+        for (const ThreadEvents& t : threads) {
+            separator();
+            std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", t.tid);
+            WriteEscaped(f, t.name.c_str());
+            std::fprintf(f, "\"}}");
+
+            for (const Event& e : t.events) {
+                separator();
+                // Chrome wants microseconds.
+                double ts = double(e.start) / 1000.0;
+                if (!e.name) {
+                    std::fprintf(f, "{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}", t.tid, ts);
+                    continue;
+                }
+                std::fprintf(f, "{\"name\":\"");
+                WriteEscaped(f, e.name);
+                std::fprintf(f, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%u}}",
+                    t.tid, ts, double(e.end - e.start) / 1000.0, e.depth);
+            }
+        }
+
+        std::fprintf(f, "\n]}\n");
+        std::fclose(f);
+        return true;
+    }
+
+} // namespace
+
+int64_t BeginZone()
+{
+    ++t_depth;
+    return Clock::NowTicks();
+}
+
+void EndZone(const char* name, int64_t start)
+{
+    int64_t end = Clock::NowTicks();
+    --t_depth;
+    Push({ name, start, end, t_depth });
+}
+
+void MarkFrame()
+{
+    int64_t now = Clock::NowTicks();
+    Push({ nullptr, now, now, 0 });
+
+    State& s = GetState();
+    uint64_t frame = s.frameIndex.fetch_add(1) + 1;
+    if (!s.captureActive.load(std::memory_order_acquire))
+        return;
+
+    // The file is written after the mutex is released: other threads
+    // naming themselves or interning names must not wait on the disk.
+    std::vector<ThreadEvents> captured;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.captureRunning && s.captureFrames) {
+            s.captureRunning = true;
+            s.captureStart = now;
+            s.captureEndFrame = frame + s.captureFrames;
+            s.captureFrames = 0;
+        }
+        else if (s.captureRunning && frame >= s.captureEndFrame) {
+            captured = CopyThreads(s, s.captureStart, now);
+            path = s.capturePath;
+            s.captureRunning = false;
+            s.captureActive.store(false, std::memory_order_release);
+        }
+    }
+    if (!path.empty())
+        WriteTraceFile(path, captured);
+}
+
+void SetThreadName(const std::string& name)
+{
+    ThreadBuffer& b = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(GetState().mutex);
+    b.name = name;
+}
+
+const char* InternName(const std::string& name)
+{
+    State& s = GetState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (const std::string& n : s.internedNames)
+        if (n == name)
+            return n.c_str();
+    s.internedNames.push_back(name);
+    return s.internedNames.back().c_str();
+}
+
+bool WriteTrace(const std::string& path)
+{
+    State& s = GetState();
+    std::vector<ThreadEvents> threads;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        threads = CopyThreads(s, INT64_MIN, INT64_MAX);
+    }
+    return WriteTraceFile(path, threads);
+}
+
+void CaptureFrames(const std::string& path, uint32_t frames)
+{
+    State& s = GetState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (s.captureRunning)
+        return; // one capture at a time
+    s.capturePath = path;
+    s.captureFrames = frames ? frames : 1;
+    s.captureActive.store(true, std::memory_order_release);
+}
+
+uint64_t FrameIndex()
+{
+    return GetState().frameIndex.load(std::memory_order_relaxed);
+}
+
+} // namespace Profiler
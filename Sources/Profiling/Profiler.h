@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/*
+ * Profiler
+ * Scoped CPU zones that show where frame time goes, viewable in
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ *     void Physics() {
+ *         PROFILE_SCOPE("Physics");   // measured until the end of the block
+ *         ...
+ *     }
+ *
+ *     PROFILE_FRAME();                // once per frame, in Core::Run
+ *
+ * Zones nest, so a trace shows Frame > Update > <your addFunc> > ...
+ *
+ * How it stays cheap:
+ *   Every thread writes into its own ring buffer, so recording a zone is
+ *   two clock reads and one array write, no lock and no allocation. When the
+ *   ring is full the oldest events are overwritten, so it always holds the
+ *   last few seconds. Only writing a trace (WriteTrace / CaptureFrames)
+ *   reads the buffers of all threads.
+ *
+ * In release builds (NDEBUG) the macros expand to nothing unless
+ * DREIVY_PROFILER=1 is defined, so zones cost exactly zero there.
+ *
+ * Zone names must stay valid until the trace is written: use string
+ * literals, or InternName() for names built at runtime.
+ */
+#ifndef DREIVY_PROFILER
+#ifdef NDEBUG
+#define DREIVY_PROFILER 0
+#else
+#define DREIVY_PROFILER 1
+#endif
+#endif
+
+namespace Profiler {
+
+    // One finished zone (or a frame marker when end == start and name == nullptr).
+    struct Event {
+        const char* name;
+        int64_t start; // Clock::NowTicks()
+        int64_t end;
+        uint32_t depth;
+    };
+
+    // Recording. BeginZone returns the start time to pass to EndZone.
+    int64_t BeginZone();
+    void EndZone(const char* name, int64_t start);
+    void MarkFrame();
+
+    // Shown as the thread's name in the trace ("Main", "Worker 3", ...).
+    void SetThreadName(const std::string& name);
+
+    // Copies `name` into storage that lives as long as the program,
+    // for zone names that are not string literals.
+    const char* InternName(const std::string& name);
+
+    // Writes everything still in the ring buffers as Chrome trace JSON.
+    bool WriteTrace(const std::string& path);
+
+    // Records the next `frames` frames and writes them to `path` once done.
+    void CaptureFrames(const std::string& path, uint32_t frames);
+
+    uint64_t FrameIndex();
+
+    // RAII helper behind PROFILE_SCOPE.
+    class Zone {
+    public:
+        explicit Zone(const char* name) : m_name(name), m_start(BeginZone()) {}
+        ~Zone() { EndZone(m_name, m_start); }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* m_name;
+        int64_t m_start;
+    };
+
+} // namespace Profiler
+
+#if DREIVY_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ::Profiler::Zone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+#define PROFILE_FRAME() ::Profiler::MarkFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+#include <DirectXMath.h>
+using namespace DirectX;
+
+/*
+ * Camera
+ * Plain data describing where we look from.
+ *
+ * The renderer uses it to build view/projection matrices,
+ * and CPU systems (LOD selection, culling) use the same values,
+ * so what the CPU decides always matches what ends up on screen.
+ */
+struct Camera {
+    XMFLOAT3 position{ 0.0f, 0.0f, -5.0f };
+    XMFLOAT3 target{ 0.0f, 0.0f, 0.0f };
+    XMFLOAT3 up{ 0.0f, 1.0f, 0.0f };
+
+    float fovY = XM_PIDIV4; // vertical field of view (radians)
+    float nearZ = 0.1f;
+    float farZ = 1000.0f;
+};
+
+inline XMMATRIX BuildViewMatrix(const Camera& c) {
+    return XMMatrixLookAtLH(
+        XMVectorSet(c.position.x, c.position.y, c.position.z, 1.0f),
+        XMVectorSet(c.target.x, c.target.y, c.target.z, 1.0f),
+        XMVectorSet(c.up.x, c.up.y, c.up.z, 0.0f)
+    );
+}
+
+inline XMMATRIX BuildProjectionMatrix(const Camera& c, float aspect) {
+    return XMMatrixPerspectiveFovLH(c.fovY, aspect, c.nearZ, c.farZ);
+}
+
+/*
+ * RenderView
+ * Camera + viewport for one frame, with the matrices already built.
+ * Everything that decides what to draw (LODs, culling) reads from here.
+ */
+struct RenderView {
+    Camera camera;
+    float width = 1.0f;  // viewport, pixels
+    float height = 1.0f;
+    XMFLOAT4X4 view;
+    XMFLOAT4X4 proj;
+    XMFLOAT4X4 viewProj;
+};
+
+inline RenderView BuildRenderView(const Camera& camera, float width, float height) {
+    RenderView v;
+    v.camera = camera;
+    v.width = width > 0.0f ? width : 1.0f;
+    v.height = height > 0.0f ? height : 1.0f;
+
+    XMMATRIX view = BuildViewMatrix(camera);
+    XMMATRIX proj = BuildProjectionMatrix(camera, v.width / v.height);
+    XMStoreFloat4x4(&v.view, view);
+    XMStoreFloat4x4(&v.proj, proj);
+    XMStoreFloat4x4(&v.viewProj, view * proj);
+    return v;
+}
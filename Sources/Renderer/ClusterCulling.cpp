@@ -0,0 +1,101 @@
+#include "ClusterCulling.h"
+#include "MeshData.h"
+#include "Threading/JobSystem.h"
+#include "Profiling/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+ClusterCullResult ClusterCuller::Cull(const MeshData& mesh, const XMMATRIX& world,
+                                      const Frustum& frustum, const XMFLOAT3& cameraPos)
+{
+    PROFILE_SCOPE("ClusterCull");
+    ClusterCullResult result;
+    m_ranges.clear();
+    const uint32_t count = uint32_t(mesh.meshlets.size());
+    result.tested = count;
+    if (count == 0) return result;
+
+    XMFLOAT4X4 w;
+    XMStoreFloat4x4(&w, world);
+
+    auto rowLength = [&w](int r) {
+        return std::sqrt(w.m[r][0] * w.m[r][0] + w.m[r][1] * w.m[r][1] + w.m[r][2] * w.m[r][2]);
+    };
+    const float sx = rowLength(0), sy = rowLength(1), sz = rowLength(2);
+    const float maxScale = std::max({ sx, sy, sz });
+    const float minScale = std::min({ sx, sy, sz });
+
+    // Non-uniform scale bends the normal cone, so the cone test would lie.
+    const bool backface = m_settings.backface && minScale > 0.0f && (maxScale - minScale) <= maxScale * 1e-3f;
+    const bool frustumTest = m_settings.frustum;
+    const OcclusionTester* occlusion = m_settings.occlusion;
+
+    m_visible.resize(count);
+    uint8_t* visible = m_visible.data();
+    const Meshlet* meshlets = mesh.meshlets.data();
+
+    auto test = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            const Meshlet& m = meshlets[i];
+
+            XMFLOAT3 c{
+                m.center.x * w.m[0][0] + m.center.y * w.m[1][0] + m.center.z * w.m[2][0] + w.m[3][0],
+                m.center.x * w.m[0][1] + m.center.y * w.m[1][1] + m.center.z * w.m[2][1] + w.m[3][1],
+                m.center.x * w.m[0][2] + m.center.y * w.m[1][2] + m.center.z * w.m[2][2] + w.m[3][2]
+            };
+            const float r = m.radius * maxScale;
+
+            bool vis = true;
+
+            if (frustumTest && !SphereInFrustum(frustum, c, r))
+                vis = false;
+
+            // Backface: the camera is behind every triangle plane of the meshlet
+            // if, for the worst normal in the cone and the worst point in the sphere,
+            // dot(point - camera, normal) is still positive:
+            //     |v| * cos(angle(v, axis) + coneAngle) >= radius,  v = center - camera
+            // Only meaningful for cones narrower than 90 degrees.
+            if (vis && backface && m.coneCos > 0.0f) {
+                XMFLOAT3 a{
+                    (m.coneAxis.x * w.m[0][0] + m.coneAxis.y * w.m[1][0] + m.coneAxis.z * w.m[2][0]) / maxScale,
+                    (m.coneAxis.x * w.m[0][1] + m.coneAxis.y * w.m[1][1] + m.coneAxis.z * w.m[2][1]) / maxScale,
+                    (m.coneAxis.x * w.m[0][2] + m.coneAxis.y * w.m[1][2] + m.coneAxis.z * w.m[2][2]) / maxScale
+                };
+                float vx = c.x - cameraPos.x, vy = c.y - cameraPos.y, vz = c.z - cameraPos.z;
+                float d2 = vx * vx + vy * vy + vz * vz;
+                float along = vx * a.x + vy * a.y + vz * a.z;
+                float across = std::sqrt(std::max(0.0f, d2 - along * along));
+                if (along * m.coneCos - across * m.coneSin >= r)
+                    vis = false;
+            }
+
+            if (vis && occlusion && occlusion->IsOccluded(c, r))
+                vis = false;
+
+            visible[i] = vis ? 1 : 0;
+        }
+    };
+
+    if (m_jobs && count >= m_settings.parallelThreshold)
+        m_jobs->ParallelFor(count, m_settings.meshletsPerJob, test);
+    else
+        test(0, count);
+
+    // Collect in meshlet order, merging neighbours into one range.
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!visible[i]) continue;
+        const Meshlet& m = meshlets[i];
+        ++result.visible;
+        result.visibleTriangles += m.triangleCount;
+
+        const uint32_t indexCount = m.triangleCount * 3;
+        if (!m_ranges.empty() && m_ranges.back().firstIndex + m_ranges.back().indexCount == m.firstIndex)
+            m_ranges.back().indexCount += indexCount;
+        else
+            m_ranges.push_back({ m.firstIndex, indexCount });
+    }
+    return result;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include "Math/Frustum.h"
+#include "Meshlets.h"
+
+struct MeshData;
+class JobSystem;
+
+// Optional occlusion test, e.g. against last frame's depth.
+// Gets a world-space sphere, returns true if it is fully hidden.
+class OcclusionTester {
+public:
+    virtual ~OcclusionTester() = default;
+    virtual bool IsOccluded(const DirectX::XMFLOAT3& center, float radius) const = 0;
+};
+
+struct ClusterCullSettings {
+    bool frustum = true;
+    // Only correct when the rasterizer culls back faces. The debug
+    // wireframe state (D3D11_CULL_NONE) shows back faces, so it's off by default.
+    bool backface = false;
+    const OcclusionTester* occlusion = nullptr;
+    uint32_t parallelThreshold = 256; // meshlets; smaller meshes are culled on the calling thread
+    uint32_t meshletsPerJob = 128;
+};
+
+struct ClusterCullResult {
+    uint32_t tested = 0;
+    uint32_t visible = 0;
+    uint32_t visibleTriangles = 0;
+};
+
+/*
+ * ClusterCuller
+ * Tests every meshlet of one mesh instance and returns the visible ones
+ * as index ranges (neighbouring visible meshlets are merged into one
+ * range, so a fully visible mesh is still a single draw).
+ *
+ * Large meshes are split across the JobSystem: each job writes
+ * visibility flags for its own meshlets, then the ranges are
+ * collected in order on the calling thread, so the output is deterministic.
+ */
+class ClusterCuller {
+public:
+    void SetSettings(const ClusterCullSettings& s) { m_settings = s; }
+    const ClusterCullSettings& GetSettings() const { return m_settings; }
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+
+    // `frustum` is in world space, `world` is the instance transform.
+    // The visible ranges stay in GetRanges() until the next call.
+    ClusterCullResult Cull(const MeshData& mesh, const DirectX::XMMATRIX& world,
+                           const Frustum& frustum, const DirectX::XMFLOAT3& cameraPos);
+
+    const std::vector<IndexRange>& GetRanges() const { return m_ranges; }
+
+private:
+    ClusterCullSettings m_settings;
+    JobSystem* m_jobs = nullptr;
+    std::vector<uint8_t> m_visible; // scratch, one flag per meshlet
+    std::vector<IndexRange> m_ranges;
+};
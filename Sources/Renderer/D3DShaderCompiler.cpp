@@ -0,0 +1,55 @@
+#include "D3DShaderCompiler.h"
+
+#include <wrl/client.h>
+#include <d3dcompiler.h>
+#include <string>
+
+namespace {
+    constexpr UINT CompileFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+}
+
+std::string D3DShaderCompiler::Identity() const
+{
+    // D3D_COMPILER_VERSION bumps with every d3dcompiler DLL we build against.
+    return "d3dcompiler " + std::to_string(D3D_COMPILER_VERSION) + " flags " + std::to_string(CompileFlags);
+}
+
+bool D3DShaderCompiler::Compile(const ShaderDesc& desc, std::vector<uint8_t>& bytecode, std::string& errors)
+{
+    // D3D wants a null-terminated array of macros.
+    std::vector<D3D_SHADER_MACRO> macros;
+    macros.reserve(desc.defines.size() + 1);
+    for (const ShaderDefine& d : desc.defines)
+        macros.push_back({ d.name.c_str(), d.value.c_str() });
+    macros.push_back({ nullptr, nullptr });
+
+    std::wstring path(desc.file.begin(), desc.file.end());
+
+    Microsoft::WRL::ComPtr<ID3DBlob> blob;
+    Microsoft::WRL::ComPtr<ID3DBlob> error;
+
+    HRESULT hr = D3DCompileFromFile(
+        path.c_str(),
+        macros.data(),
+        D3D_COMPILE_STANDARD_FILE_INCLUDE,
+        desc.entry.c_str(),
+        desc.profile.c_str(),
+        CompileFlags,
+        0,
+        &blob,
+        &error
+    );
+
+    if (FAILED(hr)) {
+        errors = desc.file + " (" + desc.entry + "): ";
+        if (error)
+            errors.append(static_cast<const char*>(error->GetBufferPointer()), error->GetBufferSize());
+        else
+            errors += "D3DCompileFromFile failed";
+        return false;
+    }
+
+    const uint8_t* p = static_cast<const uint8_t*>(blob->GetBufferPointer());
+    bytecode.assign(p, p + blob->GetBufferSize());
+    return true;
+}
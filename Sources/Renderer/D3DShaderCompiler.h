@@ -0,0 +1,10 @@
+#pragma once
+#include "ShaderCompiler.h"
+
+// IShaderCompiler on top of D3DCompileFromFile (d3dcompiler_47, thread-safe).
+// Includes are resolved relative to the including file.
+class D3DShaderCompiler : public IShaderCompiler {
+public:
+    std::string Identity() const override;
+    bool Compile(const ShaderDesc& desc, std::vector<uint8_t>& bytecode, std::string& errors) override;
+};
@@ -1,8 +1,60 @@
 #pragma once
 #include <vector>
 #include <DirectXMath.h>
+#include "VertexFormat.h"
+#include "Meshlets.h"
+
+// A simplified version of a mesh.
+// It reuses MeshData::positions, only the index list is different,
+// so every LOD of a mesh can live in one vertex buffer.
+struct MeshLod {
+    std::vector<uint32_t> indices;
+    float error = 0.0f; // how far (in mesh units) this LOD may deviate from the original
+};
+
+// Joints of the skeleton that move one vertex.
+struct JointIndices {
+    uint8_t joint[4]{ 0, 0, 0, 0 };
+};
 
 struct MeshData {
     std::vector<DirectX::XMFLOAT3> positions;
     std::vector<uint32_t> indices;
+
+    // Optional attributes. Leave empty if the mesh doesn't have them,
+    // otherwise they must have one entry per position.
+    std::vector<DirectX::XMFLOAT3> normals;
+    std::vector<DirectX::XMFLOAT4> tangents; // w = handedness (+1 / -1)
+    std::vector<DirectX::XMFLOAT2> uvs;
+
+    // Optional skin (see Animation/AnimationSystem.h): up to 4 joints per
+    // vertex and how much each one pulls. Weights should add up to 1;
+    // unused slots have weight 0.
+    std::vector<JointIndices> jointIndices;
+    std::vector<DirectX::XMFLOAT4> jointWeights;
+
+    // Filled by MeshStorage::Add, you don't need to set these by hand.
+    // lods[0] is the first *simplified* level, the full mesh is always `indices`.
+    std::vector<MeshLod> lods;
+    VertexStream vertexStream; // what gets uploaded to the GPU
+    std::vector<Meshlet> meshlets; // clusters of `indices` (LOD 0 only)
+    DirectX::XMFLOAT3 boundsCenter{ 0.0f, 0.0f, 0.0f };
+    float boundsRadius = 0.0f;
+
+    uint32_t LodCount() const {
+        return 1 + static_cast<uint32_t>(lods.size());
+    }
+
+    const std::vector<uint32_t>& LodIndices(uint32_t lod) const {
+        return lod == 0 ? indices : lods[lod - 1].indices;
+    }
+
+    bool IsSkinned() const {
+        return !jointIndices.empty() && jointIndices.size() == positions.size() &&
+               jointWeights.size() == positions.size();
+    }
+
+    float LodError(uint32_t lod) const {
+        return lod == 0 ? 0.0f : lods[lod - 1].error;
+    }
 };
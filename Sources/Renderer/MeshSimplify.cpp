@@ -0,0 +1,382 @@
+#include "MeshSimplify.h"
+
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+#include <array>
+
+using namespace DirectX;
+
+namespace {
+
+    // Symmetric 4x4 matrix stored as its 10 unique values.
+    // `weight` is the surface area that contributed to it,
+    // we use it to turn the summed error back into a distance.
+    struct Quadric {
+        double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+        double a11 = 0, a12 = 0, a13 = 0;
+        double a22 = 0, a23 = 0;
+        double a33 = 0;
+        double weight = 0;
+
+        void AddPlane(double a, double b, double c, double d, double w) {
+            a00 += w * a * a; a01 += w * a * b; a02 += w * a * c; a03 += w * a * d;
+            a11 += w * b * b; a12 += w * b * c; a13 += w * b * d;
+            a22 += w * c * c; a23 += w * c * d;
+            a33 += w * d * d;
+        }
+
+        void Add(const Quadric& o) {
+            a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+            a11 += o.a11; a12 += o.a12; a13 += o.a13;
+            a22 += o.a22; a23 += o.a23;
+            a33 += o.a33;
+            weight += o.weight;
+        }
+
+        // Sum of weighted squared distances from p to all planes.
+        double Evaluate(const XMFLOAT3& p) const {
+            double x = p.x, y = p.y, z = p.z;
+            double r = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+                     + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+                     + a22 * z * z + 2 * a23 * z
+                     + a33;
+            return r > 0 ? r : 0; // tiny negative values are rounding noise
+        }
+    };
+
+    struct Vec3d { double x, y, z; };
+
+    Vec3d Sub(const XMFLOAT3& a, const XMFLOAT3& b) { return { double(a.x) - b.x, double(a.y) - b.y, double(a.z) - b.z }; }
+    Vec3d Cross(const Vec3d& a, const Vec3d& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    double Dot(const Vec3d& a, const Vec3d& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    double Length(const Vec3d& a) { return std::sqrt(Dot(a, a)); }
+
+    uint64_t EdgeKey(uint32_t a, uint32_t b) {
+        if (a > b) std::swap(a, b);
+        return (uint64_t(a) << 32) | b;
+    }
+
+    class Simplifier {
+    public:
+        Simplifier(const std::vector<XMFLOAT3>& positions, const std::vector<uint32_t>& indices)
+            : m_positions(positions), m_tris(indices) {
+            const size_t vertexCount = positions.size();
+            const size_t triCount = indices.size() / 3;
+            m_tris.resize(triCount * 3);
+
+            m_quadrics.resize(vertexCount);
+            m_vertexTris.resize(vertexCount);
+            m_version.assign(vertexCount, 0);
+            m_dead.assign(vertexCount, 0);
+            m_locked.assign(vertexCount, 0);
+            m_visited.assign(vertexCount, 0);
+            m_weld.resize(vertexCount);
+            m_borderLinks.resize(vertexCount);
+            m_borderCount.assign(vertexCount, 0);
+            m_triAlive.assign(triCount, 1);
+            m_liveTriangles = triCount;
+
+            LockSeams();
+
+            // Face planes -> vertex quadrics (area weighted).
+            std::unordered_map<uint64_t, uint32_t> edgeUse;
+            edgeUse.reserve(triCount * 3);
+
+            for (size_t t = 0; t < triCount; ++t) {
+                const uint32_t* c = &m_tris[t * 3];
+                Vec3d n = Cross(Sub(P(c[1]), P(c[0])), Sub(P(c[2]), P(c[0])));
+                double len = Length(n);
+                if (len > 0) {
+                    n = { n.x / len, n.y / len, n.z / len };
+                    double d = -Dot(n, { P(c[0]).x, P(c[0]).y, P(c[0]).z });
+                    double area = len * 0.5;
+                    for (int k = 0; k < 3; ++k) {
+                        m_quadrics[c[k]].AddPlane(n.x, n.y, n.z, d, area);
+                        m_quadrics[c[k]].weight += area;
+                    }
+                }
+                for (int k = 0; k < 3; ++k) {
+                    m_vertexTris[c[k]].push_back(uint32_t(t));
+                    ++edgeUse[EdgeKey(c[k], c[(k + 1) % 3])];
+                }
+            }
+
+            LockBorders(edgeUse);
+
+            for (const auto& [key, uses] : edgeUse)
+                PushEdge(uint32_t(key >> 32), uint32_t(key & 0xffffffffu));
+        }
+
+        void Run(size_t targetTriangles) {
+            while (m_liveTriangles > targetTriangles && !m_heap.empty()) {
+                Candidate c = m_heap.top();
+                m_heap.pop();
+
+                // Stale entry: one of the vertices changed since it was pushed.
+                if (m_dead[c.from] || m_dead[c.to]) continue;
+                if (m_version[c.from] != c.fromVersion || m_version[c.to] != c.toVersion) continue;
+                if (Flips(c.from, c.to)) continue;
+
+                Collapse(c.from, c.to);
+                m_maxError = std::max(m_maxError, double(c.error));
+            }
+        }
+
+        std::vector<uint32_t> Indices() const {
+            std::vector<uint32_t> out;
+            out.reserve(m_liveTriangles * 3);
+            for (size_t t = 0; t < m_triAlive.size(); ++t) {
+                if (!m_triAlive[t]) continue;
+                out.insert(out.end(), &m_tris[t * 3], &m_tris[t * 3] + 3);
+            }
+            return out;
+        }
+
+        size_t TriangleCount() const { return m_liveTriangles; }
+        float Error() const { return float(std::sqrt(m_maxError)); }
+
+    private:
+        struct Candidate {
+            float cost;    // what the heap sorts by
+            float error;   // mean squared distance, used for reporting
+            uint32_t from, to;
+            uint32_t fromVersion, toVersion;
+
+            bool operator>(const Candidate& o) const { return cost > o.cost; }
+        };
+
+        const XMFLOAT3& P(uint32_t v) const { return m_positions[v]; }
+
+        // Vertices that share a position with another vertex sit on a seam
+        // (normals/UVs differ). Moving only one side would tear the mesh open.
+        // m_weld maps each of them to the first vertex at that position, so
+        // the seam does not look like an open border further down.
+        void LockSeams() {
+            struct Key {
+                uint32_t x, y, z;
+                bool operator==(const Key& o) const { return x == o.x && y == o.y && z == o.z; }
+            };
+            struct KeyHash {
+                size_t operator()(const Key& k) const {
+                    return size_t(k.x) * 73856093u ^ size_t(k.y) * 19349663u ^ size_t(k.z) * 83492791u;
+                }
+            };
+
+            std::unordered_map<Key, uint32_t, KeyHash> firstAt;
+            firstAt.reserve(m_positions.size());
+            for (uint32_t v = 0; v < m_positions.size(); ++v) {
+                // + 0.0f turns -0 into +0, which compare equal but differ in bits.
+                const XMFLOAT3 p = { m_positions[v].x + 0.0f, m_positions[v].y + 0.0f, m_positions[v].z + 0.0f };
+                Key k;
+                std::memcpy(&k.x, &p.x, 4);
+                std::memcpy(&k.y, &p.y, 4);
+                std::memcpy(&k.z, &p.z, 4);
+                auto [it, inserted] = firstAt.emplace(k, v);
+                m_weld[v] = it->second;
+                if (!inserted) {
+                    m_locked[v] = 1;
+                    m_locked[it->second] = 1;
+                }
+            }
+        }
+
+        // Open edges only have a triangle on one side, so nothing in the face
+        // quadrics stops them from sliding inward. Border vertices where the
+        // outline bends (or where more than two open edges meet) never move;
+        // the rest sit on a straight stretch and may only slide along it onto
+        // a border neighbour, which leaves the outline exactly where it was.
+        void LockBorders(const std::unordered_map<uint64_t, uint32_t>& edgeUse) {
+            // Count uses on welded vertices: both sides of a seam are one edge.
+            std::unordered_map<uint64_t, uint32_t> weldedUse;
+            weldedUse.reserve(edgeUse.size());
+            for (const auto& [key, uses] : edgeUse)
+                weldedUse[EdgeKey(m_weld[key >> 32], m_weld[key & 0xffffffffu])] += uses;
+
+            for (const auto& [key, uses] : weldedUse) {
+                const uint32_t a = uint32_t(key >> 32), b = uint32_t(key & 0xffffffffu);
+                if (uses != 1 || a == b) continue;
+                Link(a, b);
+                Link(b, a);
+            }
+
+            for (uint32_t v = 0; v < m_borderCount.size(); ++v) {
+                if (m_borderCount[v] == 0) continue;
+                if (m_borderCount[v] != 2) { m_locked[v] = 1; continue; }
+
+                const Vec3d e0 = Sub(P(m_borderLinks[v][0]), P(v));
+                const Vec3d e1 = Sub(P(m_borderLinks[v][1]), P(v));
+                const bool straight = Dot(e0, e1) < 0
+                    && Length(Cross(e0, e1)) <= 1e-6 * Length(e0) * Length(e1);
+                if (!straight) m_locked[v] = 1;
+            }
+        }
+
+        void Link(uint32_t v, uint32_t neighbour) {
+            if (m_borderCount[v] < 2) m_borderLinks[v][m_borderCount[v]] = neighbour;
+            if (m_borderCount[v] < 255) ++m_borderCount[v];
+        }
+
+        // Interior vertices may go anywhere; border ones only along the border.
+        bool CanMove(uint32_t from, uint32_t to) const {
+            if (m_locked[from]) return false;
+            return m_borderCount[from] == 0 || m_borderLinks[from][0] == m_weld[to] || m_borderLinks[from][1] == m_weld[to];
+        }
+
+        void PushEdge(uint32_t a, uint32_t b) {
+            Quadric q = m_quadrics[a];
+            q.Add(m_quadrics[b]);
+
+            // Try both directions, keep the cheaper one.
+            bool canAB = CanMove(a, b);
+            bool canBA = CanMove(b, a);
+            if (!canAB && !canBA) return;
+
+            double costAB = canAB ? q.Evaluate(P(b)) : 0;
+            double costBA = canBA ? q.Evaluate(P(a)) : 0;
+
+            Candidate c;
+            if (canAB && (!canBA || costAB <= costBA)) {
+                c.cost = float(costAB); c.from = a; c.to = b;
+            }
+            else {
+                c.cost = float(costBA); c.from = b; c.to = a;
+            }
+            c.error = q.weight > 0 ? float(c.cost / q.weight) : 0.0f;
+            c.fromVersion = m_version[c.from];
+            c.toVersion = m_version[c.to];
+            m_heap.push(c);
+        }
+
+        // Would moving `from` onto `to` turn any remaining triangle inside out?
+        bool Flips(uint32_t from, uint32_t to) const {
+            for (uint32_t t : m_vertexTris[from]) {
+                if (!m_triAlive[t]) continue;
+                const uint32_t* c = &m_tris[t * 3];
+                if (c[0] == to || c[1] == to || c[2] == to) continue; // this one disappears
+
+                const XMFLOAT3* before[3] = { &P(c[0]), &P(c[1]), &P(c[2]) };
+                const XMFLOAT3* after[3] = { before[0], before[1], before[2] };
+                for (int k = 0; k < 3; ++k)
+                    if (c[k] == from) after[k] = &P(to);
+
+                Vec3d n0 = Cross(Sub(*before[1], *before[0]), Sub(*before[2], *before[0]));
+                Vec3d n1 = Cross(Sub(*after[1], *after[0]), Sub(*after[2], *after[0]));
+                if (Dot(n0, n1) <= 0) return true;
+            }
+            return false;
+        }
+
+        void Collapse(uint32_t from, uint32_t to) {
+            m_quadrics[to].Add(m_quadrics[from]);
+
+            // `from` leaves the border: `to` now links to its other neighbour.
+            if (m_borderCount[from]) {
+                const uint32_t other = m_borderLinks[from][0] == to ? m_borderLinks[from][1] : m_borderLinks[from][0];
+                for (uint32_t& n : m_borderLinks[m_weld[to]]) if (n == from) n = other;
+                for (uint32_t& n : m_borderLinks[other]) if (n == from) n = m_weld[to];
+            }
+
+            for (uint32_t t : m_vertexTris[from]) {
+                if (!m_triAlive[t]) continue;
+                uint32_t* c = &m_tris[t * 3];
+
+                if (c[0] == to || c[1] == to || c[2] == to) {
+                    m_triAlive[t] = 0;
+                    --m_liveTriangles;
+                    continue;
+                }
+                for (int k = 0; k < 3; ++k)
+                    if (c[k] == from) c[k] = to;
+                m_vertexTris[to].push_back(t);
+            }
+
+            m_vertexTris[from].clear();
+            m_vertexTris[from].shrink_to_fit();
+            m_dead[from] = 1;
+            ++m_version[to];
+
+            // Drop dead triangles from the list so it doesn't grow forever.
+            auto& tris = m_vertexTris[to];
+            tris.erase(std::remove_if(tris.begin(), tris.end(),
+                [this](uint32_t t) { return !m_triAlive[t]; }), tris.end());
+
+            // Everything around `to` has a new cost now.
+            // Each neighbour shows up in two triangles, push its edge only once.
+            ++m_visitStamp;
+            for (uint32_t t : tris) {
+                const uint32_t* c = &m_tris[t * 3];
+                for (int k = 0; k < 3; ++k) {
+                    if (c[k] == to || m_visited[c[k]] == m_visitStamp) continue;
+                    m_visited[c[k]] = m_visitStamp;
+                    PushEdge(to, c[k]);
+                }
+            }
+        }
+
+    private:
+        const std::vector<XMFLOAT3>& m_positions;
+        std::vector<uint32_t> m_tris;
+        std::vector<uint8_t> m_triAlive;
+        size_t m_liveTriangles = 0;
+
+        std::vector<Quadric> m_quadrics;
+        std::vector<std::vector<uint32_t>> m_vertexTris;
+        std::vector<uint32_t> m_version;
+        std::vector<uint8_t> m_dead;
+        std::vector<uint8_t> m_locked;
+        std::vector<uint32_t> m_weld;
+        std::vector<std::array<uint32_t, 2>> m_borderLinks;
+        std::vector<uint8_t> m_borderCount; // open edges at each vertex
+        std::vector<uint32_t> m_visited;
+        uint32_t m_visitStamp = 0;
+
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> m_heap;
+        double m_maxError = 0;
+    };
+
+} // namespace
+
+
+std::vector<uint32_t> SimplifyMesh(
+    const std::vector<XMFLOAT3>& positions,
+    const std::vector<uint32_t>& indices,
+    size_t targetIndexCount,
+    float* outError)
+{
+    Simplifier s(positions, indices);
+    s.Run(targetIndexCount / 3);
+    if (outError) *outError = s.Error();
+    return s.Indices();
+}
+
+void GenerateLods(MeshData& mesh, const LodSettings& settings)
+{
+    mesh.lods.clear();
+
+    size_t prevTriangles = mesh.indices.size() / 3;
+    if (prevTriangles < size_t(settings.minTriangles) * 2)
+        return;
+
+    // One simplifier for the whole chain: each LOD continues where the
+    // previous one stopped, so the error keeps growing monotonically.
+    Simplifier s(mesh.positions, mesh.indices);
+
+    for (uint32_t level = 0; level < settings.maxLods; ++level) {
+        size_t target = size_t(prevTriangles * settings.reductionPerLod);
+        if (target < settings.minTriangles)
+            break;
+
+        s.Run(target);
+
+        // Locked seams and corners ran out of collapses before the target,
+        // or there was barely anything to remove: not worth a separate LOD.
+        if (s.TriangleCount() > target || s.TriangleCount() > prevTriangles * 9 / 10)
+            break;
+
+        mesh.lods.push_back({ s.Indices(), s.Error() });
+        prevTriangles = s.TriangleCount();
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "MeshData.h"
+
+/*
+ * Mesh simplification (quadric error metric, Garland & Heckbert).
+ *
+ * Every vertex remembers the planes of the triangles around it.
+ * Collapsing an edge moves one vertex onto the other, and the cost of
+ * that move is the squared distance to those planes. We always collapse
+ * the cheapest edge first, so flat areas disappear long before silhouettes.
+ *
+ * Vertices are never moved to new positions, they collapse onto an existing
+ * neighbour. That is what lets all LODs share one vertex buffer.
+ * Seam vertices and the corners of open borders never move, so every LOD
+ * keeps the outline and UV seams of the original.
+ */
+
+struct LodSettings {
+    uint32_t maxLods = 4;          // simplified levels, not counting LOD 0
+    float reductionPerLod = 0.5f;  // each LOD keeps about this share of the previous triangles
+    uint32_t minTriangles = 16;    // don't build LODs smaller than this
+};
+
+// Simplifies `indices` down to roughly `targetIndexCount` indices.
+// `outError` receives the approximate deviation of the result (mesh units).
+std::vector<uint32_t> SimplifyMesh(
+    const std::vector<DirectX::XMFLOAT3>& positions,
+    const std::vector<uint32_t>& indices,
+    size_t targetIndexCount,
+    float* outError = nullptr);
+
+// Fills mesh.lods with a chain of simplified index lists (coarser each level).
+// Stops early when a level cannot reach its target or would not remove a
+// meaningful amount of triangles.
+void GenerateLods(MeshData& mesh, const LodSettings& settings = {});
@@ -1,16 +1,45 @@
 #pragma once
 #include <vector>
 #include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <string>
 #include "MeshData.h"
 #include "MeshHandle.h"
+#include "MeshSimplify.h"
+#include "Memory/AllocTracker.h"
 
 class MeshStorage {
 public:
-    MeshHandle Add(const MeshData& data) {
+    // Import point for every mesh: bounds, meshlets and the LOD chain are built here,
+    // once, so nothing has to be computed while rendering.
+    // `name` is optional; it lets saved worlds find the mesh again (see WorldSnapshot.h).
+    MeshHandle Add(const MeshData& data, const std::string& name = {}) {
+        AllocScope scope(AllocTag::Assets);
         m_meshes.push_back(data);
+        m_names.push_back(name);
+        MeshData& mesh = m_meshes.back();
+        ComputeBounds(mesh);
+        BuildMeshlets(mesh);
+        GenerateLods(mesh, m_lodSettings);
+        BuildVertexStream(mesh, m_compressVertices);
         return static_cast<MeshHandle>(m_meshes.size()); // 1-based
     }
 
+    // For meshes whose index order means something to the caller, like the
+    // per-entity ranges of a StaticBatcher batch: bounds and vertex stream
+    // only. No meshlets (they reorder the indices) and no LODs.
+    MeshHandle AddMerged(const MeshData& data, const std::string& name = {}) {
+        AllocScope scope(AllocTag::Assets);
+        m_meshes.push_back(data);
+        m_names.push_back(name);
+        MeshData& mesh = m_meshes.back();
+        ComputeBounds(mesh);
+        BuildVertexStream(mesh, m_compressVertices);
+        return static_cast<MeshHandle>(m_meshes.size());
+    }
+
     const MeshData* Get(MeshHandle h) const {
         if (h == InvalidMesh) return nullptr;
         size_t idx = h - 1;
@@ -18,6 +47,122 @@ public:
         return &m_meshes[idx];
     }
 
+    const std::string& GetName(MeshHandle h) const {
+        static const std::string none;
+        if (h == InvalidMesh || h > m_names.size()) return none;
+        return m_names[h - 1];
+    }
+
+    // InvalidMesh if no mesh was added under that name.
+    MeshHandle Find(const std::string& name) const {
+        if (name.empty()) return InvalidMesh;
+        for (size_t i = 0; i < m_names.size(); ++i)
+            if (m_names[i] == name)
+                return static_cast<MeshHandle>(i + 1);
+        return InvalidMesh;
+    }
+
+    // Affects meshes added after the call.
+    void SetLodSettings(const LodSettings& settings) { m_lodSettings = settings; }
+    void SetVertexCompression(bool enabled) { m_compressVertices = enabled; }
+
+    size_t Count() const { return m_meshes.size(); }
+
+private:
+    static void ComputeBounds(MeshData& mesh) {
+        if (mesh.positions.empty()) return;
+
+        DirectX::XMFLOAT3 mn = mesh.positions[0];
+        DirectX::XMFLOAT3 mx = mesh.positions[0];
+        for (const auto& p : mesh.positions) {
+            mn = { std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z) };
+            mx = { std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z) };
+        }
+        mesh.boundsCenter = { (mn.x + mx.x) * 0.5f, (mn.y + mx.y) * 0.5f, (mn.z + mx.z) * 0.5f };
+
+        float r2 = 0.0f;
+        for (const auto& p : mesh.positions) {
+            float dx = p.x - mesh.boundsCenter.x;
+            float dy = p.y - mesh.boundsCenter.y;
+            float dz = p.z - mesh.boundsCenter.z;
+            r2 = std::max(r2, dx * dx + dy * dy + dz * dz);
+        }
+        mesh.boundsRadius = std::sqrt(r2);
+    }
+
+    // Converts the float attributes into the GPU layout (see VertexFormat.h).
+    static void BuildVertexStream(MeshData& mesh, bool compress) {
+        using namespace VertexPacking;
+
+        const size_t count = mesh.positions.size();
+        const bool hasNormals = mesh.normals.size() == count && count > 0;
+        const bool hasTangents = mesh.tangents.size() == count && count > 0;
+        const bool hasUvs = mesh.uvs.size() == count && count > 0;
+        const bool hasAttributes = hasNormals || hasTangents || hasUvs;
+
+        VertexStream& vs = mesh.vertexStream;
+        vs = {};
+        vs.stats.vertexCount = uint32_t(count);
+        vs.stats.rawStride = RawStride(hasNormals, hasTangents, hasUvs);
+
+        if (!compress) {
+            // Attributes are dropped here: only the packed layout carries them.
+            vs.format = VertexFormat::Float3;
+            vs.stride = sizeof(DirectX::XMFLOAT3);
+            vs.bytes.resize(count * vs.stride);
+            if (count) std::memcpy(vs.bytes.data(), mesh.positions.data(), vs.bytes.size());
+            vs.stats.packedStride = vs.stride;
+            return;
+        }
+
+        ComputeQuantization(mesh.positions, vs.positionOffset, vs.positionScale);
+        const auto& o = vs.positionOffset;
+        const auto& s = vs.positionScale;
+
+        if (!hasAttributes) {
+            vs.format = VertexFormat::Quantized;
+            vs.stride = sizeof(QuantizedVertex);
+            vs.bytes.resize(count * vs.stride);
+            auto* out = reinterpret_cast<QuantizedVertex*>(vs.bytes.data());
+            for (size_t i = 0; i < count; ++i) {
+                const auto& p = mesh.positions[i];
+                out[i] = { { QuantizeUnorm16(p.x, o.x, s.x), QuantizeUnorm16(p.y, o.y, s.y), QuantizeUnorm16(p.z, o.z, s.z), 0 } };
+            }
+            vs.stats.packedStride = vs.stride;
+            return;
+        }
+
+        vs.format = VertexFormat::Packed;
+        vs.stride = sizeof(PackedVertex);
+        vs.bytes.resize(count * vs.stride);
+        auto* out = reinterpret_cast<PackedVertex*>(vs.bytes.data());
+        for (size_t i = 0; i < count; ++i) {
+            const auto& p = mesh.positions[i];
+            PackedVertex v{};
+            v.position[0] = QuantizeUnorm16(p.x, o.x, s.x);
+            v.position[1] = QuantizeUnorm16(p.y, o.y, s.y);
+            v.position[2] = QuantizeUnorm16(p.z, o.z, s.z);
+            v.position[3] = 65535;
+
+            if (hasNormals)
+                EncodeOctahedral(mesh.normals[i], v.normal);
+            if (hasTangents) {
+                const auto& t = mesh.tangents[i];
+                EncodeOctahedral({ t.x, t.y, t.z }, v.tangent);
+                v.position[3] = t.w < 0.0f ? 0 : 65535;
+            }
+            if (hasUvs) {
+                v.uv[0] = DirectX::PackedVector::XMConvertFloatToHalf(mesh.uvs[i].x);
+                v.uv[1] = DirectX::PackedVector::XMConvertFloatToHalf(mesh.uvs[i].y);
+            }
+            out[i] = v;
+        }
+        vs.stats.packedStride = vs.stride;
+    }
+
 private:
     std::vector<MeshData> m_meshes;
+    std::vector<std::string> m_names; // m_names[h - 1], may be empty
+    LodSettings m_lodSettings;
+    bool m_compressVertices = true;
 };
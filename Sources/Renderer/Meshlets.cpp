@@ -0,0 +1,160 @@
+#include "Meshlets.h"
+#include "MeshData.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace {
+
+    XMFLOAT3 TriangleNormal(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c) {
+        float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+        float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+        XMFLOAT3 n{ uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx };
+        float len = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+        if (len <= 0.0f) return { 0, 0, 0 };
+        return { n.x / len, n.y / len, n.z / len };
+    }
+
+    void ComputeMeshletBounds(const MeshData& mesh, Meshlet& m) {
+        const uint32_t* idx = mesh.indices.data() + m.firstIndex;
+        const uint32_t indexCount = m.triangleCount * 3;
+
+        // Sphere: center of the AABB, radius to the farthest vertex.
+        XMFLOAT3 mn = mesh.positions[idx[0]], mx = mn;
+        for (uint32_t i = 0; i < indexCount; ++i) {
+            const XMFLOAT3& p = mesh.positions[idx[i]];
+            mn = { std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z) };
+            mx = { std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z) };
+        }
+        m.center = { (mn.x + mx.x) * 0.5f, (mn.y + mx.y) * 0.5f, (mn.z + mx.z) * 0.5f };
+        float r2 = 0.0f;
+        for (uint32_t i = 0; i < indexCount; ++i) {
+            const XMFLOAT3& p = mesh.positions[idx[i]];
+            float dx = p.x - m.center.x, dy = p.y - m.center.y, dz = p.z - m.center.z;
+            r2 = std::max(r2, dx * dx + dy * dy + dz * dz);
+        }
+        m.radius = std::sqrt(r2);
+
+        // Normal cone: average direction, then the widest deviation from it.
+        XMFLOAT3 sum{ 0, 0, 0 };
+        for (uint32_t t = 0; t < m.triangleCount; ++t) {
+            XMFLOAT3 n = TriangleNormal(mesh.positions[idx[t * 3]], mesh.positions[idx[t * 3 + 1]], mesh.positions[idx[t * 3 + 2]]);
+            sum = { sum.x + n.x, sum.y + n.y, sum.z + n.z };
+        }
+        float len = std::sqrt(sum.x * sum.x + sum.y * sum.y + sum.z * sum.z);
+        if (len < 1e-6f) {
+            m.coneCos = -1.0f;
+            m.coneSin = 0.0f;
+            return;
+        }
+        m.coneAxis = { sum.x / len, sum.y / len, sum.z / len };
+
+        float minDot = 1.0f;
+        for (uint32_t t = 0; t < m.triangleCount; ++t) {
+            XMFLOAT3 n = TriangleNormal(mesh.positions[idx[t * 3]], mesh.positions[idx[t * 3 + 1]], mesh.positions[idx[t * 3 + 2]]);
+            if (n.x == 0 && n.y == 0 && n.z == 0) continue; // degenerate, invisible anyway
+            minDot = std::min(minDot, n.x * m.coneAxis.x + n.y * m.coneAxis.y + n.z * m.coneAxis.z);
+        }
+        m.coneCos = minDot;
+        m.coneSin = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+    }
+
+} // namespace
+
+
+void BuildMeshlets(MeshData& mesh)
+{
+    mesh.meshlets.clear();
+
+    const uint32_t triCount = uint32_t(mesh.indices.size() / 3);
+    const uint32_t vertexCount = uint32_t(mesh.positions.size());
+    if (triCount == 0) return;
+
+    // vertex -> triangles that use it (compressed: offsets + one flat list)
+    std::vector<uint32_t> adjOffset(vertexCount + 1, 0);
+    for (uint32_t i = 0; i < triCount * 3; ++i)
+        ++adjOffset[mesh.indices[i] + 1];
+    for (uint32_t v = 0; v < vertexCount; ++v)
+        adjOffset[v + 1] += adjOffset[v];
+    std::vector<uint32_t> adjTris(triCount * 3);
+    {
+        std::vector<uint32_t> fill(adjOffset.begin(), adjOffset.end() - 1);
+        for (uint32_t i = 0; i < triCount * 3; ++i)
+            adjTris[fill[mesh.indices[i]]++] = i / 3;
+    }
+
+    std::vector<uint8_t> used(triCount, 0);
+    std::vector<uint32_t> vertexMeshlet(vertexCount, ~0u); // which meshlet last took this vertex
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> reordered;
+    reordered.reserve(mesh.indices.size());
+
+    uint32_t seed = 0;
+    uint32_t emitted = 0;
+
+    while (emitted < triCount) {
+        while (used[seed]) ++seed;
+
+        const uint32_t id = uint32_t(mesh.meshlets.size());
+        Meshlet m;
+        m.firstIndex = uint32_t(reordered.size());
+        candidates.clear();
+
+        auto newVertices = [&](uint32_t t) {
+            uint32_t n = 0;
+            for (int k = 0; k < 3; ++k)
+                n += vertexMeshlet[mesh.indices[t * 3 + k]] != id;
+            return n;
+        };
+
+        auto addTriangle = [&](uint32_t t) {
+            used[t] = 1;
+            ++emitted;
+            ++m.triangleCount;
+            for (int k = 0; k < 3; ++k) {
+                uint32_t v = mesh.indices[t * 3 + k];
+                reordered.push_back(v);
+                if (vertexMeshlet[v] == id) continue;
+
+                vertexMeshlet[v] = id;
+                ++m.vertexCount;
+                // Neighbours of a new vertex are the next best candidates.
+                for (uint32_t a = adjOffset[v]; a < adjOffset[v + 1]; ++a)
+                    if (!used[adjTris[a]]) candidates.push_back(adjTris[a]);
+            }
+        };
+
+        addTriangle(seed);
+
+        // Grow: always take the neighbour that adds the fewest new vertices,
+        // that keeps meshlets compact (small spheres, narrow cones).
+        while (m.triangleCount < MeshletMaxTriangles) {
+            uint32_t best = ~0u, bestScore = 4;
+            size_t write = 0;
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                uint32_t t = candidates[i];
+                if (used[t]) continue;
+                candidates[write++] = t;
+                uint32_t score = newVertices(t);
+                if (score < bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+            candidates.resize(write);
+
+            if (best == ~0u) break;                                       // no connected triangles left
+            if (m.vertexCount + bestScore > MeshletMaxVertices) break;    // meshlet is full
+            addTriangle(best);
+        }
+
+        mesh.meshlets.push_back(m);
+    }
+
+    mesh.indices.swap(reordered);
+
+    for (Meshlet& m : mesh.meshlets)
+        ComputeMeshletBounds(mesh, m);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <DirectXMath.h>
+
+struct MeshData;
+
+/*
+ * Meshlets (clusters)
+ * A big mesh is split into small groups of neighbouring triangles.
+ * Each group has its own bounding sphere and normal cone, so the CPU
+ * can throw away the parts of a mesh that are off-screen or facing away,
+ * instead of drawing all of it because one corner is visible.
+ *
+ * BuildMeshlets reorders MeshData::indices so that every meshlet is one
+ * contiguous index range. Drawing a meshlet is just DrawIndexed(range).
+ */
+constexpr uint32_t MeshletMaxVertices = 64;
+constexpr uint32_t MeshletMaxTriangles = 124;
+
+struct Meshlet {
+    uint32_t firstIndex = 0;    // into MeshData::indices
+    uint32_t triangleCount = 0;
+    uint32_t vertexCount = 0;   // unique vertices used (<= MeshletMaxVertices)
+
+    DirectX::XMFLOAT3 center{ 0, 0, 0 }; // bounding sphere, mesh space
+    float radius = 0.0f;
+
+    // Every triangle normal is within the cone around `coneAxis`:
+    // dot(normal, coneAxis) >= coneCos. coneSin = sqrt(1 - coneCos^2).
+    DirectX::XMFLOAT3 coneAxis{ 0, 0, 1 };
+    float coneCos = -1.0f; // -1 = normals go everywhere, never backface-culled
+    float coneSin = 0.0f;
+};
+
+// A piece of MeshData::indices to draw.
+struct IndexRange {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+
+// Fills mesh.meshlets and reorders mesh.indices (same triangles, new order).
+void BuildMeshlets(MeshData& mesh);
@@ -0,0 +1,204 @@
+#include "NullRenderer.h"
+#include "RenderQueue.h"
+#include "MeshStorage.h"
+#include <cstring>
+
+using namespace DirectX;
+
+namespace {
+
+    // DXGI_FORMAT_R8G8B8A8_UNORM and DXGI_FORMAT_D24_UNORM_S8_UINT, as in Renderer.
+    constexpr uint32_t BackBufferFormat = 28;
+    constexpr uint32_t DepthFormat = 45;
+
+    // Buffer keys for the StateTracker: meshes are their handle, the
+    // frame's vertex and instance streams can't be one.
+    constexpr uint64_t FrameVertices = ~0ull - 1;
+    constexpr uint64_t FrameInstances = ~0ull - 2;
+    constexpr uint64_t ConstantBuffer = 1;
+    constexpr uint64_t BackBufferTarget = 1;
+
+} // namespace
+
+void NullRenderer::Resize(uint32_t width, uint32_t height)
+{
+    m_width = width;
+    m_height = height;
+    m_state.InvalidateAll();
+}
+
+void NullRenderer::BeginFrame(float, float, float, float)
+{
+    m_stats = {};
+    m_state.ResetStats();
+
+    // The same frame graph as Renderer::BeginFrame.
+    m_graph.Reset();
+    m_backBuffer = m_graph.Import("BackBuffer", GraphResourceDesc::Texture(m_width, m_height, BackBufferFormat, 4),
+        ResourceState::Present, ResourceState::Present);
+    m_depth = m_graph.CreateTexture("Depth", GraphResourceDesc::Texture(m_width, m_height, DepthFormat, 4));
+    m_graph.AddPass("Clear", nullptr)
+        .Write(m_backBuffer, ResourceState::RenderTarget)
+        .Write(m_depth, ResourceState::DepthWrite);
+}
+
+void NullRenderer::RunGraph()
+{
+    if (m_graph.IsCompiled())
+        return; // already ran this frame
+    if (m_graph.Compile())
+        m_graph.Execute(*this);
+    const RenderGraphStats& gs = m_graph.GetStats();
+    m_stats.passes = gs.passes - gs.culled;
+    m_stats.barriers = gs.barriers;
+    m_stats.bindsIssued = m_state.GetStats().issued;
+    m_stats.bindsSkipped = m_state.GetStats().skipped;
+}
+
+void NullRenderer::Barrier(const GraphBarrier& barrier, uint32_t)
+{
+    switch (barrier.before) {
+    case ResourceState::RenderTarget:
+    case ResourceState::DepthWrite:
+    case ResourceState::DepthRead:
+    case ResourceState::UnorderedAccess:
+        m_state.Bind(BindSlot::RenderTargets, 0);
+        break;
+    case ResourceState::ShaderRead:
+        m_state.Bind(BindSlot::ShaderResources, 0);
+        break;
+    default:
+        break;
+    }
+}
+
+void NullRenderer::EndFrame()
+{
+    RunGraph();
+}
+
+void NullRenderer::Draw(const RenderQueue& queue)
+{
+    if (!m_meshStorage)
+        return;
+
+    XMFLOAT4X4 viewProj;
+    XMStoreFloat4x4(&viewProj, BuildViewMatrix(m_camera) *
+        BuildProjectionMatrix(m_camera, float(m_width) / float(m_height ? m_height : 1)));
+
+    // All world * viewProj at once, like Renderer::Draw.
+    const auto& items = queue.GetItems();
+    m_mvps.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+        std::memcpy(&m_mvps[i], &items[i].world, sizeof(Simd::Mat4));
+    Simd::Mat4 vp;
+    std::memcpy(&vp, &viewProj, sizeof(vp));
+    Simd::MultiplyMatrices(m_mvps.data(), vp, m_mvps.data(), items.size());
+
+    // Uploads as in Renderer::Draw: needed meshes first, within the budget.
+    for (const RenderItem& item : items) {
+        const float dx = item.world.m[3][0] - m_camera.position.x;
+        const float dy = item.world.m[3][1] - m_camera.position.y;
+        const float dz = item.world.m[3][2] - m_camera.position.z;
+        m_uploads.Request(item.mesh, dx * dx + dy * dy + dz * dz);
+    }
+    m_uploads.Update(*m_meshStorage);
+    m_stats.uploadsPending = m_uploads.GetStats().pending;
+
+    // Skinned vertices and instances go up once per frame, like Renderer::UploadDynamic.
+    m_stats.bytesUploaded += queue.GetVertices().size() * sizeof(XMFLOAT3);
+    m_stats.bytesUploaded += queue.GetInstances().size() * sizeof(RenderInstance);
+
+    m_graph.AddPass("Scene", [this, &queue](const RenderPassContext& ctx) {
+            m_state.Bind(BindSlot::RenderTargets, StateTracker::HashKey(BackBufferTarget, ctx.Physical(m_depth)));
+            DrawItems(queue);
+        })
+        .Write(m_backBuffer, ResourceState::RenderTarget)
+        .Write(m_depth, ResourceState::DepthWrite);
+    RunGraph();
+}
+
+void NullRenderer::DrawItems(const RenderQueue& queue)
+{
+    // Without frame vertices (or instances) those items have nothing to
+    // read, and Renderer::DrawItems skips them: so does this.
+    const bool verticesReady = !queue.GetVertices().empty();
+    const bool instancesReady = !queue.GetInstances().empty();
+
+    const auto& items = queue.GetItems();
+    float checksum = 0.0f;
+    for (size_t i = 0; i < items.size(); ++i) {
+        const RenderItem& item = items[i];
+        const MeshData* mesh = m_meshStorage->Get(item.mesh);
+        if (!mesh)
+            continue;
+        if (item.firstVertex != RenderItem::NoVertices && !verticesReady)
+            continue;
+        if (!m_uploads.IsResident(item.mesh)) {
+            ++m_stats.notReady;
+            continue;
+        }
+        if (item.instanceCount && !instancesReady)
+            continue;
+
+        const VertexStream& stream = mesh->vertexStream;
+        const bool skinned = item.firstVertex != RenderItem::NoVertices;
+        DrawConstants cb;
+        std::memcpy(&cb.mvp, &m_mvps[i], sizeof(cb.mvp));
+        if (skinned) {
+            cb.positionScale = { 1.0f, 1.0f, 1.0f, 0.0f };
+            cb.positionOffset = { 0.0f, 0.0f, 0.0f, 0.0f };
+        }
+        else {
+            cb.positionScale = { stream.positionScale.x, stream.positionScale.y, stream.positionScale.z, 0.0f };
+            cb.positionOffset = { stream.positionOffset.x, stream.positionOffset.y, stream.positionOffset.z, 0.0f };
+        }
+        m_stats.bytesUploaded += sizeof(cb);
+        checksum += cb.mvp.m[3][0] + cb.mvp.m[3][1] + cb.mvp.m[3][2];
+
+        // The binds of Renderer::DrawMesh / DrawInstances, in the same order.
+        const bool instanced = item.instanceCount != 0;
+        m_state.Bind(BindSlot::VSConstants, ConstantBuffer);
+        if (instanced)
+            m_state.Bind(BindSlot::VertexBuffers, StateTracker::HashKey(item.mesh, stream.stride, FrameInstances));
+        else
+            m_state.Bind(BindSlot::VertexBuffers, skinned
+                ? StateTracker::HashKey(FrameVertices, sizeof(XMFLOAT3))
+                : StateTracker::HashKey(item.mesh, stream.stride));
+        m_state.Bind(BindSlot::IndexBuffer, item.mesh);
+        const PipelineDesc desc = PipelineDesc::ForMesh(stream.format, skinned, instanced);
+        m_state.BindPipeline(m_pipelines.Get(desc), desc);
+
+        // Meshlet ranges are one draw each, like in Renderer::DrawMesh;
+        // an instanced item is one draw however many copies it has.
+        m_stats.draws += item.rangeCount ? item.rangeCount : 1;
+    }
+    m_checksum += checksum;
+}
+
+void NullRenderer::Shutdown()
+{
+    m_graph.Reset();
+    m_pipelines.Clear();
+    m_state.InvalidateAll();
+    m_uploads.Clear();
+    m_staging = {};
+    m_stats = {};
+}
+
+uint8_t* NullRenderer::MapStaging(uint64_t capacity)
+{
+    if (m_staging.size() != capacity)
+        m_staging.assign(size_t(capacity), 0);
+    return m_staging.data();
+}
+
+// Renderer creates the buffers and copies them out of the ring: count the same bytes.
+bool NullRenderer::CreateMesh(MeshHandle, const MeshData& mesh, uint64_t, uint64_t)
+{
+    size_t indices = 0;
+    for (uint32_t lod = 0; lod < mesh.LodCount(); ++lod)
+        indices += mesh.LodIndices(lod).size();
+    m_stats.bytesUploaded += mesh.vertexStream.bytes.size() + indices * sizeof(uint32_t);
+    return true;
+}
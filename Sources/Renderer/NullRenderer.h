@@ -0,0 +1,81 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include "RenderBackend.h"
+#include "MeshHandle.h"
+#include "Math/SimdMath.h"
+#include "PipelineState.h"
+
+/*
+ * NullRenderer
+ * A backend without a GPU. It consumes the RenderQueue like Renderer does:
+ * resolves every mesh and LOD, builds the per-draw constants (world * view *
+ * proj), counts draws, and runs the same UploadQueue, whose staging ring is
+ * a plain array here, and builds the same RenderGraph each frame (its
+ * physical resources and barriers cost nothing). Binds go through the same
+ * PipelineCache and StateTracker, keyed by mesh instead of D3D object, so
+ * binds issued / skipped match too. Only the D3D calls are missing.
+ *
+ * So a headless frame (see Core::setHeadless) still pays the CPU cost of
+ * submission, and its RendererStats match what the real backend would report.
+ */
+class NullRenderer : public RenderBackend, private IUploadTarget, private IRenderGraphTarget {
+public:
+    void SetMeshStorage(MeshStorage* storage) override { m_meshStorage = storage; }
+    void SetCamera(const Camera& camera) override { m_camera = camera; }
+    void Resize(uint32_t width, uint32_t height) override;
+
+    void BeginFrame(float r, float g, float b, float a) override;
+    void Draw(const RenderQueue& queue) override;
+    void EndFrame() override;
+    void Shutdown() override;
+
+    const RendererStats& GetStats() const override { return m_stats; }
+    UploadQueue& GetUploads() override { return m_uploads; }
+    const RenderGraph& GetGraph() const override { return m_graph; }
+
+    // Sum over every constant built; keeps the compiler from dropping the work
+    // and lets two runs of the same scene be compared.
+    float GetChecksum() const { return m_checksum; }
+
+    // Every pipeline the draws asked for so far, one per distinct PipelineDesc.
+    const PipelineCache& GetPipelines() const { return m_pipelines; }
+
+private:
+    // Same layout as Renderer's constant buffer.
+    struct alignas(16) DrawConstants {
+        DirectX::XMFLOAT4X4 mvp;
+        DirectX::XMFLOAT4 positionScale;
+        DirectX::XMFLOAT4 positionOffset;
+    };
+
+    // IUploadTarget: "creating" a mesh counts its bytes.
+    uint8_t* MapStaging(uint64_t capacity) override;
+    void UnmapStaging() override {}
+    bool CreateMesh(MeshHandle handle, const MeshData& mesh, uint64_t vertexOffset, uint64_t indexOffset) override;
+
+    // IRenderGraphTarget: nothing to create; barriers unbind like Renderer's.
+    bool PreparePhysical(uint32_t, const GraphResourceDesc&) override { return true; }
+    void Barrier(const GraphBarrier& barrier, uint32_t physical) override;
+
+    // The scene pass.
+    void DrawItems(const RenderQueue& queue);
+    // Compiles and runs the frame's graph, once.
+    void RunGraph();
+
+private:
+    MeshStorage* m_meshStorage = nullptr; // injected
+    Camera m_camera;
+    RendererStats m_stats;
+    uint32_t m_width = 1280;
+    uint32_t m_height = 720;
+    UploadQueue m_uploads{ *this };
+    std::vector<uint8_t> m_staging; // the ring
+    std::vector<Simd::Mat4> m_mvps; // Draw scratch, one per item
+    RenderGraph m_graph;
+    PipelineCache m_pipelines;
+    StateTracker m_state;
+    GraphResource m_backBuffer = InvalidGraphResource;
+    GraphResource m_depth = InvalidGraphResource;
+    float m_checksum = 0.0f;
+};
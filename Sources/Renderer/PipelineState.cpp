@@ -0,0 +1,115 @@
+#include "PipelineState.h"
+
+// ---- PipelineDesc ----
+
+PipelineDesc PipelineDesc::ForMesh(VertexFormat format, bool skinned, bool instanced)
+{
+    PipelineDesc d;
+    if (instanced) {
+        // Only the position is read, and it sits at the start of every format.
+        d.layout = format == VertexFormat::Float3 ? InputLayoutId::Instanced : InputLayoutId::InstancedUnorm;
+        d.vertexShader = VertexShaderId::Instanced;
+        return d;
+    }
+    switch (skinned ? VertexFormat::Float3 : format) {
+    case VertexFormat::Float3:
+        d.layout = InputLayoutId::Float3;
+        break;
+    case VertexFormat::Quantized:
+        d.layout = InputLayoutId::Quantized;
+        break;
+    case VertexFormat::Packed:
+        d.layout = InputLayoutId::Packed;
+        d.vertexShader = VertexShaderId::Packed;
+        break;
+    }
+    return d;
+}
+
+// ---- PipelineCache ----
+
+PipelineHandle PipelineCache::Get(const PipelineDesc& desc, bool* created)
+{
+    const uint64_t key = desc.Key();
+    auto it = m_byKey.find(key);
+    if (created)
+        *created = it == m_byKey.end();
+    if (it != m_byKey.end())
+        return it->second;
+
+    m_descs.push_back(desc);
+    const PipelineHandle handle = PipelineHandle(m_descs.size());
+    m_byKey.emplace(key, handle);
+    return handle;
+}
+
+void PipelineCache::Clear()
+{
+    m_byKey.clear();
+    m_descs.clear();
+}
+
+// ---- StateTracker ----
+
+bool StateTracker::Bind(BindSlot slot, uint64_t key)
+{
+    uint64_t& bound = m_bound[size_t(slot)];
+    if (bound == key) {
+        ++m_stats.skipped;
+        return false;
+    }
+    bound = key;
+    ++m_stats.issued;
+    return true;
+}
+
+uint32_t StateTracker::BindPipeline(PipelineHandle pipeline, const PipelineDesc& desc)
+{
+    if (pipeline == m_pipeline) {
+        m_stats.skipped += PipelineSlots;
+        return 0;
+    }
+    m_pipeline = pipeline;
+
+    // A different pipeline often differs in one part only (the layout, say):
+    // the others are still filtered one by one.
+    uint32_t mask = 0;
+    if (Bind(BindSlot::InputLayout, uint64_t(desc.layout)))
+        mask |= 1u << uint32_t(BindSlot::InputLayout);
+    if (Bind(BindSlot::VertexShader, uint64_t(desc.vertexShader)))
+        mask |= 1u << uint32_t(BindSlot::VertexShader);
+    if (Bind(BindSlot::PixelShader, uint64_t(desc.pixelShader)))
+        mask |= 1u << uint32_t(BindSlot::PixelShader);
+    if (Bind(BindSlot::Topology, uint64_t(desc.topology)))
+        mask |= 1u << uint32_t(BindSlot::Topology);
+    if (Bind(BindSlot::RasterState, uint64_t(desc.raster)))
+        mask |= 1u << uint32_t(BindSlot::RasterState);
+    return mask;
+}
+
+void StateTracker::Invalidate(BindSlot slot)
+{
+    m_bound[size_t(slot)] = Unknown;
+    if (uint32_t(slot) < PipelineSlots)
+        m_pipeline = InvalidPipeline;
+}
+
+void StateTracker::InvalidateAll()
+{
+    for (uint64_t& bound : m_bound)
+        bound = Unknown;
+    m_pipeline = InvalidPipeline;
+}
+
+uint64_t StateTracker::HashKey(uint64_t a, uint64_t b, uint64_t c)
+{
+    // splitmix64's finalizer over each value: pointers differ in few bits.
+    auto mix = [](uint64_t x) {
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27; x *= 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    };
+    uint64_t h = mix(a);
+    h = mix(h ^ (b + 0x9e3779b97f4a7c15ull));
+    return mix(h ^ (c + 0x9e3779b97f4a7c15ull));
+}
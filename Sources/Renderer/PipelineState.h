@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "VertexFormat.h"
+
+// The parts a draw's pipeline is built from. Backends map each id to their
+// own object (Renderer: a D3D11 input layout, shader, rasterizer state).
+enum class InputLayoutId : uint8_t {
+    Float3,
+    Quantized,
+    Packed,
+    Instanced,       // Float3 + RenderInstance
+    InstancedUnorm,  // Quantized / Packed + RenderInstance
+};
+
+enum class VertexShaderId : uint8_t { Basic, Packed, Instanced };
+enum class PixelShaderId : uint8_t { Basic };
+enum class PrimitiveTopology : uint8_t { TriangleList };
+enum class RasterStateId : uint8_t { Solid };
+
+struct PipelineDesc {
+    InputLayoutId layout = InputLayoutId::Float3;
+    VertexShaderId vertexShader = VertexShaderId::Basic;
+    PixelShaderId pixelShader = PixelShaderId::Basic;
+    PrimitiveTopology topology = PrimitiveTopology::TriangleList;
+    RasterStateId raster = RasterStateId::Solid;
+
+    // Every field in one number: two descs are the same pipeline if their keys are.
+    uint64_t Key() const {
+        return uint64_t(layout) | uint64_t(vertexShader) << 8 | uint64_t(pixelShader) << 16 |
+               uint64_t(topology) << 24 | uint64_t(raster) << 32;
+    }
+
+    // What DrawMesh / DrawInstances need for a mesh stored as `format`.
+    // Skinned vertices are plain floats whatever the mesh's format.
+    static PipelineDesc ForMesh(VertexFormat format, bool skinned, bool instanced);
+};
+
+using PipelineHandle = uint32_t;
+constexpr PipelineHandle InvalidPipeline = 0;
+
+/*
+ * PipelineCache
+ * Pipelines are created once per distinct PipelineDesc and never change
+ * afterwards, like the pipeline state objects of newer APIs: a draw asks
+ * for its desc and gets a handle back, found by the desc's key.
+ *
+ * The backend keeps whatever it builds for a pipeline (Renderer: pointers
+ * to the D3D11 objects) in its own array, indexed by handle - 1; `created`
+ * says when a handle is new and that entry has to be filled in.
+ */
+class PipelineCache {
+public:
+    PipelineHandle Get(const PipelineDesc& desc, bool* created = nullptr);
+
+    const PipelineDesc& GetDesc(PipelineHandle pipeline) const { return m_descs[pipeline - 1]; }
+    uint32_t Count() const { return uint32_t(m_descs.size()); }
+    void Clear();
+
+private:
+    std::unordered_map<uint64_t, PipelineHandle> m_byKey;
+    std::vector<PipelineDesc> m_descs;
+};
+
+// Each kind of state a draw binds. A pipeline is the first five.
+enum class BindSlot : uint8_t {
+    InputLayout,
+    VertexShader,
+    PixelShader,
+    Topology,
+    RasterState,
+    VertexBuffers,
+    IndexBuffer,
+    VSConstants,
+    RenderTargets,
+    ShaderResources,
+    Count
+};
+
+constexpr uint32_t PipelineSlots = 5;
+
+struct StateStats {
+    uint32_t issued = 0;   // binds that reached the API
+    uint32_t skipped = 0;  // binds of what was already bound
+};
+
+/*
+ * StateTracker
+ * Remembers what is bound in every BindSlot, as a key (an id, a pointer,
+ * or a hash of several), so a bind of the same thing again is skipped
+ * instead of going to the driver: most draws use the same shaders, layout
+ * and constant buffer as the one before.
+ *
+ *   if (m_state.Bind(BindSlot::IndexBuffer, key))
+ *       context->IASetIndexBuffer(...);
+ *
+ * Whatever changes the API's state without going through the tracker
+ * (a resize, another library) has to Invalidate() it. issued + skipped is
+ * what the frame would have cost the driver without it.
+ */
+class StateTracker {
+public:
+    StateTracker() { InvalidateAll(); }
+
+    // True: `key` is not what is bound in `slot`, the caller issues the bind.
+    bool Bind(BindSlot slot, uint64_t key);
+
+    // Which parts of the pipeline have to be bound, a mask of
+    // 1 << BindSlot. 0 if `pipeline` is the one already bound.
+    uint32_t BindPipeline(PipelineHandle pipeline, const PipelineDesc& desc);
+
+    void Invalidate(BindSlot slot);
+    void InvalidateAll();
+
+    const StateStats& GetStats() const { return m_stats; }
+    void ResetStats() { m_stats = {}; }
+
+    // Several values (buffer, stride, offset) as one key.
+    static uint64_t HashKey(uint64_t a, uint64_t b, uint64_t c = 0);
+
+private:
+    static constexpr uint64_t Unknown = ~0ull;
+
+    uint64_t m_bound[size_t(BindSlot::Count)];
+    PipelineHandle m_pipeline = InvalidPipeline;
+    StateStats m_stats;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include "Camera.h"
+#include "UploadQueue.h"
+#include "RenderGraph.h"
+
+class RenderQueue;
+class MeshStorage;
+
+// What the GPU was asked to do this frame (reset by BeginFrame).
+struct RendererStats {
+    uint32_t draws = 0;         // DrawIndexed calls
+    uint64_t bytesUploaded = 0; // buffers created + constant buffer updates
+    uint32_t notReady = 0;      // items skipped: their mesh isn't uploaded yet
+    uint32_t uploadsPending = 0; // meshes still in the upload queue
+    uint32_t passes = 0;        // render graph passes run (culled ones not)
+    uint32_t barriers = 0;      // resource state changes between them
+    uint32_t bindsIssued = 0;   // state binds sent to the API (shaders, buffers, targets)
+    uint32_t bindsSkipped = 0;  // binds dropped: the same state was already bound
+};
+
+/*
+ * RenderBackend
+ * The part of a renderer that Core talks to every frame: take the camera,
+ * consume a RenderQueue, present.
+ *
+ * A frame is a RenderGraph: BeginFrame starts it (back buffer, depth, the
+ * clear), Draw adds the scene pass and runs the graph, EndFrame presents.
+ *
+ * Renderer (D3D11) is the real one. NullRenderer does the same CPU work
+ * without a device, so the frame loop can run headless: benchmarks, CI,
+ * machines without a GPU. Creating the backend (window, device) is not part
+ * of the interface, every backend has its own Init.
+ */
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    virtual void SetMeshStorage(MeshStorage* storage) = 0;
+    virtual void SetCamera(const Camera& camera) = 0;
+    virtual void Resize(uint32_t width, uint32_t height) = 0;
+
+    virtual void BeginFrame(float r, float g, float b, float a) = 0;
+    virtual void Draw(const RenderQueue& queue) = 0;
+    virtual void EndFrame() = 0; // Present
+    virtual void Shutdown() = 0;
+
+    virtual const RendererStats& GetStats() const = 0;
+
+    // Mesh uploads: budget, priorities, queue depth. See UploadQueue.h.
+    virtual UploadQueue& GetUploads() = 0;
+
+    // The frame's passes, compiled and run by Draw (or EndFrame if nothing
+    // was drawn). Its Dump() tells what each pass cost and what aliasing saved.
+    virtual const RenderGraph& GetGraph() const = 0;
+};
@@ -0,0 +1,365 @@
+#include "RenderGraph.h"
+#include "Timing/Clock.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+    // For `need` bytes: the smallest buffer that is big enough, else the
+    // biggest one (it grows).
+    bool BetterBuffer(uint64_t candidate, uint64_t current, uint64_t need) {
+        if (candidate >= need)
+            return current < need || candidate < current;
+        return current < need && candidate > current;
+    }
+
+} // namespace
+
+const char* ResourceStateName(ResourceState state)
+{
+    switch (state) {
+    case ResourceState::Undefined:       return "Undefined";
+    case ResourceState::RenderTarget:    return "RenderTarget";
+    case ResourceState::DepthWrite:      return "DepthWrite";
+    case ResourceState::DepthRead:       return "DepthRead";
+    case ResourceState::ShaderRead:      return "ShaderRead";
+    case ResourceState::UnorderedAccess: return "UnorderedAccess";
+    case ResourceState::CopySource:      return "CopySource";
+    case ResourceState::CopyDest:        return "CopyDest";
+    case ResourceState::Present:         return "Present";
+    }
+    return "?";
+}
+
+// ---- RenderPassContext ----
+
+uint32_t RenderPassContext::Physical(GraphResource resource) const
+{
+    return graph.GetResource(resource).physical;
+}
+
+bool RenderPassContext::FirstUse(GraphResource resource) const
+{
+    const RenderGraph::Resource& r = graph.GetResource(resource);
+    return !r.imported && r.firstPass == pass;
+}
+
+// ---- PassBuilder ----
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Use(GraphResource resource, ResourceState state, bool write)
+{
+    // Uses of a pass are kept together: only the last pass can take more.
+    // A builder kept past the next AddPass can't; Compile reports it.
+    if (m_pass + 1 == m_graph.m_passes.size()) {
+        m_graph.m_uses.push_back({ resource, state, write });
+        ++m_graph.m_passes[m_pass].useCount;
+    }
+    else if (!m_graph.m_lateUse) {
+        m_graph.m_lateUse = m_graph.m_passes[m_pass].name;
+    }
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(GraphResource resource, ResourceState state)
+{
+    return Use(resource, state, false);
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(GraphResource resource, ResourceState state)
+{
+    return Use(resource, state, true);
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::SideEffect()
+{
+    m_graph.m_passes[m_pass].sideEffect = true;
+    return *this;
+}
+
+// ---- RenderGraph ----
+
+void RenderGraph::Reset()
+{
+    m_passes.clear();
+    m_uses.clear();
+    m_resources.clear();
+    m_barriers.clear();
+    m_physical.clear();
+    m_finalBarriers = 0;
+    m_compiled = false;
+    m_stats = {};
+    m_error.clear();
+    m_lateUse = nullptr;
+}
+
+GraphResource RenderGraph::CreateTexture(const char* name, const GraphResourceDesc& desc)
+{
+    Resource r;
+    r.name = name;
+    r.desc = desc;
+    m_resources.push_back(r);
+    return static_cast<GraphResource>(m_resources.size());
+}
+
+GraphResource RenderGraph::CreateBuffer(const char* name, uint64_t bytes)
+{
+    return CreateTexture(name, GraphResourceDesc::Buffer(bytes));
+}
+
+GraphResource RenderGraph::Import(const char* name, const GraphResourceDesc& desc, ResourceState initial, ResourceState final)
+{
+    Resource r;
+    r.name = name;
+    r.desc = desc;
+    r.imported = true;
+    r.initial = initial;
+    r.final = final;
+    m_resources.push_back(r);
+    return static_cast<GraphResource>(m_resources.size());
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(const char* name, ExecuteFn execute)
+{
+    Pass p;
+    p.name = name;
+    p.execute = std::move(execute);
+    p.firstUse = static_cast<uint32_t>(m_uses.size());
+    m_passes.push_back(std::move(p));
+    m_compiled = false;
+    return PassBuilder(*this, static_cast<uint32_t>(m_passes.size() - 1));
+}
+
+bool RenderGraph::Fail(const char* pass, const char* what, const char* resource)
+{
+    m_error = std::string(pass) + ": " + what + (resource ? std::string(" ") + resource : std::string());
+    return false;
+}
+
+bool RenderGraph::Compile()
+{
+    const Clock::Ticks start = Clock::NowTicks();
+    m_compiled = false;
+    m_barriers.clear();
+    m_physical.clear();
+    m_error.clear();
+    m_stats = {};
+    const uint32_t passCount = static_cast<uint32_t>(m_passes.size());
+
+    if (m_lateUse)
+        return Fail(m_lateUse, "declared a use after the next AddPass", nullptr);
+    for (const Pass& p : m_passes)
+        for (uint32_t u = p.firstUse; u < p.firstUse + p.useCount; ++u)
+            if (m_uses[u].resource == InvalidGraphResource || m_uses[u].resource > m_resources.size())
+                return Fail(p.name, "uses a resource that doesn't exist", nullptr);
+
+    // Culling, from the last pass back: a pass is needed if it writes
+    // something needed, and then what it reads is needed too.
+    m_needed.assign(m_resources.size(), 0);
+    for (size_t r = 0; r < m_resources.size(); ++r)
+        m_needed[r] = m_resources[r].imported ? 1 : 0;
+    for (uint32_t i = passCount; i-- > 0;) {
+        Pass& p = m_passes[i];
+        bool needed = p.sideEffect;
+        for (uint32_t u = p.firstUse; u < p.firstUse + p.useCount && !needed; ++u)
+            needed = m_uses[u].write && m_needed[m_uses[u].resource - 1];
+        p.culled = !needed;
+        p.milliseconds = 0.0;
+        if (p.culled) {
+            ++m_stats.culled;
+            continue;
+        }
+        for (uint32_t u = p.firstUse; u < p.firstUse + p.useCount; ++u)
+            if (!m_uses[u].write)
+                m_needed[m_uses[u].resource - 1] = 1;
+    }
+
+    // Lifetimes and barriers, in pass order.
+    m_state.resize(m_resources.size());
+    for (size_t r = 0; r < m_resources.size(); ++r) {
+        Resource& res = m_resources[r];
+        res.firstPass = ~0u;
+        res.lastPass = 0;
+        res.physical = ~0u;
+        m_state[r] = res.imported ? res.initial : ResourceState::Undefined;
+    }
+    for (uint32_t i = 0; i < passCount; ++i) {
+        Pass& p = m_passes[i];
+        p.firstBarrier = static_cast<uint32_t>(m_barriers.size());
+        p.barrierCount = 0;
+        if (p.culled)
+            continue;
+        for (uint32_t u = p.firstUse; u < p.firstUse + p.useCount; ++u) {
+            const Use& use = m_uses[u];
+            Resource& res = m_resources[use.resource - 1];
+            ResourceState& state = m_state[use.resource - 1];
+            if (res.firstPass == i) {
+                if (state != use.state)
+                    return Fail(p.name, "uses a resource in two states:", res.name);
+                continue; // listed twice, same state
+            }
+            if (res.firstPass == ~0u) {
+                if (!use.write && !res.imported)
+                    return Fail(p.name, "reads a resource no pass wrote before:", res.name);
+                res.firstPass = i;
+            }
+            else if (res.lastPass == i) {
+                if (state != use.state)
+                    return Fail(p.name, "uses a resource in two states:", res.name);
+                continue;
+            }
+            res.lastPass = i;
+            if (state != use.state) {
+                m_barriers.push_back({ use.resource, state, use.state });
+                state = use.state;
+            }
+        }
+        p.barrierCount = static_cast<uint32_t>(m_barriers.size()) - p.firstBarrier;
+    }
+    const uint32_t finalStart = static_cast<uint32_t>(m_barriers.size());
+    for (size_t r = 0; r < m_resources.size(); ++r)
+        if (m_resources[r].imported && m_state[r] != m_resources[r].final)
+            m_barriers.push_back({ static_cast<GraphResource>(r + 1), m_state[r], m_resources[r].final });
+    m_finalBarriers = static_cast<uint32_t>(m_barriers.size()) - finalStart;
+
+    Alias();
+
+    m_stats.passes = passCount;
+    m_stats.barriers = static_cast<uint32_t>(m_barriers.size());
+    m_stats.physical = static_cast<uint32_t>(m_physical.size());
+    for (const GraphResourceDesc& d : m_physical)
+        m_stats.physicalBytes += d.Size();
+    m_stats.compileMs = Clock::ToMilliseconds(Clock::NowTicks() - start);
+    m_compiled = true;
+    return true;
+}
+
+// Greedy, by first use: each transient takes the first physical resource
+// that fits and whose last user is done, or a new one.
+void RenderGraph::Alias()
+{
+    m_order.clear();
+    for (size_t r = 0; r < m_resources.size(); ++r) {
+        const Resource& res = m_resources[r];
+        if (res.imported || res.firstPass == ~0u)
+            continue;
+        m_order.push_back(static_cast<GraphResource>(r + 1));
+        ++m_stats.transients;
+        m_stats.transientBytes += res.desc.Size();
+    }
+    std::sort(m_order.begin(), m_order.end(), [this](GraphResource a, GraphResource b) {
+        const uint32_t fa = m_resources[a - 1].firstPass;
+        const uint32_t fb = m_resources[b - 1].firstPass;
+        return fa != fb ? fa < fb : a < b;
+    });
+
+    m_physicalLast.clear();
+    for (GraphResource id : m_order) {
+        Resource& res = m_resources[id - 1];
+        const GraphResourceDesc& d = res.desc;
+        uint32_t best = ~0u;
+        for (uint32_t p = 0; p < m_physical.size(); ++p) {
+            const GraphResourceDesc& pd = m_physical[p];
+            if (m_physicalLast[p] >= res.firstPass || pd.kind != d.kind)
+                continue;
+            if (d.kind == GraphResourceDesc::Kind::Texture) {
+                if (pd.width == d.width && pd.height == d.height && pd.format == d.format && pd.bytesPerPixel == d.bytesPerPixel) {
+                    best = p;
+                    break;
+                }
+            }
+            else if (best == ~0u || BetterBuffer(pd.bytes, m_physical[best].bytes, d.bytes)) {
+                best = p;
+            }
+        }
+        if (best == ~0u) {
+            best = static_cast<uint32_t>(m_physical.size());
+            m_physical.push_back(d);
+            m_physicalLast.push_back(0);
+        }
+        if (d.kind == GraphResourceDesc::Kind::Buffer)
+            m_physical[best].bytes = std::max(m_physical[best].bytes, d.bytes);
+        m_physicalLast[best] = res.lastPass;
+        res.physical = best;
+    }
+}
+
+void RenderGraph::Execute(IRenderGraphTarget& target)
+{
+    if (!m_compiled)
+        return;
+    const Clock::Ticks start = Clock::NowTicks();
+
+    for (uint32_t p = 0; p < m_physical.size(); ++p)
+        target.PreparePhysical(p, m_physical[p]);
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i) {
+        Pass& p = m_passes[i];
+        if (p.culled)
+            continue;
+        for (uint32_t b = p.firstBarrier; b < p.firstBarrier + p.barrierCount; ++b)
+            target.Barrier(m_barriers[b], m_resources[m_barriers[b].resource - 1].physical);
+        const Clock::Ticks passStart = Clock::NowTicks();
+        if (p.execute)
+            p.execute(RenderPassContext{ *this, i });
+        p.milliseconds = Clock::ToMilliseconds(Clock::NowTicks() - passStart);
+    }
+    for (size_t b = m_barriers.size() - m_finalBarriers; b < m_barriers.size(); ++b)
+        target.Barrier(m_barriers[b], ~0u);
+
+    m_stats.executeMs = Clock::ToMilliseconds(Clock::NowTicks() - start);
+}
+
+std::string RenderGraph::Dump() const
+{
+    std::string out;
+    char line[256];
+    const double mb = 1.0 / (1024.0 * 1024.0);
+    const uint64_t saved = m_stats.transientBytes - std::min(m_stats.physicalBytes, m_stats.transientBytes);
+    std::snprintf(line, sizeof(line), "RenderGraph: %u passes (%u culled), %u barriers, compile %.3f ms, execute %.3f ms\n",
+        m_stats.passes, m_stats.culled, m_stats.barriers, m_stats.compileMs, m_stats.executeMs);
+    out += line;
+    std::snprintf(line, sizeof(line), "Transients: %u in %u physical, %.2f MB -> %.2f MB (%.0f%% saved)\n",
+        m_stats.transients, m_stats.physical, double(m_stats.transientBytes) * mb, double(m_stats.physicalBytes) * mb,
+        m_stats.transientBytes ? 100.0 * double(saved) / double(m_stats.transientBytes) : 0.0);
+    out += line;
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i) {
+        const Pass& p = m_passes[i];
+        if (p.culled)
+            std::snprintf(line, sizeof(line), "  %2u %-20s culled\n", i, p.name);
+        else
+            std::snprintf(line, sizeof(line), "  %2u %-20s %8.3f ms\n", i, p.name, p.milliseconds);
+        out += line;
+        for (uint32_t b = p.firstBarrier; b < p.firstBarrier + p.barrierCount; ++b) {
+            const GraphBarrier& br = m_barriers[b];
+            std::snprintf(line, sizeof(line), "       barrier %s: %s -> %s\n", GetResource(br.resource).name,
+                ResourceStateName(br.before), ResourceStateName(br.after));
+            out += line;
+        }
+    }
+    for (size_t b = m_barriers.size() - m_finalBarriers; b < m_barriers.size(); ++b) {
+        const GraphBarrier& br = m_barriers[b];
+        std::snprintf(line, sizeof(line), "     end barrier %s: %s -> %s\n", GetResource(br.resource).name,
+            ResourceStateName(br.before), ResourceStateName(br.after));
+        out += line;
+    }
+
+    for (const Resource& r : m_resources) {
+        char desc[64];
+        if (r.desc.kind == GraphResourceDesc::Kind::Texture)
+            std::snprintf(desc, sizeof(desc), "%ux%u fmt %u", r.desc.width, r.desc.height, r.desc.format);
+        else
+            std::snprintf(desc, sizeof(desc), "buffer");
+        std::snprintf(line, sizeof(line), "  %-20s %-20s %8.2f MB", r.name, desc, double(r.desc.Size()) * mb);
+        out += line;
+        if (r.imported)
+            std::snprintf(line, sizeof(line), "  imported\n");
+        else if (r.firstPass == ~0u)
+            std::snprintf(line, sizeof(line), "  unused\n");
+        else
+            std::snprintf(line, sizeof(line), "  passes %u..%u, physical %u\n", r.firstPass, r.lastPass, r.physical);
+        out += line;
+    }
+    return out;
+}
@@ -0,0 +1,247 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+using GraphResource = uint32_t;
+constexpr GraphResource InvalidGraphResource = 0;
+
+// What a pass does with a resource. When it changes between two passes,
+// the graph puts a barrier in between.
+enum class ResourceState : uint8_t {
+    Undefined,       // a transient before its first pass: contents are garbage
+    RenderTarget,
+    DepthWrite,
+    DepthRead,
+    ShaderRead,
+    UnorderedAccess,
+    CopySource,
+    CopyDest,
+    Present,
+};
+
+const char* ResourceStateName(ResourceState state);
+
+struct GraphResourceDesc {
+    enum class Kind : uint8_t { Texture, Buffer };
+
+    Kind kind = Kind::Texture;
+    uint32_t width = 0;         // texture
+    uint32_t height = 0;
+    uint32_t format = 0;        // the backend's format (a DXGI_FORMAT on D3D11)
+    uint32_t bytesPerPixel = 4;
+    uint64_t bytes = 0;         // buffer
+
+    static GraphResourceDesc Texture(uint32_t width, uint32_t height, uint32_t format, uint32_t bytesPerPixel) {
+        GraphResourceDesc d;
+        d.width = width;
+        d.height = height;
+        d.format = format;
+        d.bytesPerPixel = bytesPerPixel;
+        return d;
+    }
+    static GraphResourceDesc Buffer(uint64_t bytes) {
+        GraphResourceDesc d;
+        d.kind = Kind::Buffer;
+        d.bytesPerPixel = 0;
+        d.bytes = bytes;
+        return d;
+    }
+
+    uint64_t Size() const {
+        return kind == Kind::Buffer ? bytes : uint64_t(width) * height * bytesPerPixel;
+    }
+};
+
+struct GraphBarrier {
+    GraphResource resource = InvalidGraphResource;
+    ResourceState before = ResourceState::Undefined;
+    ResourceState after = ResourceState::Undefined;
+};
+
+/*
+ * IRenderGraphTarget
+ * The backend side of a RenderGraph: it owns the real textures and buffers
+ * (numbered "physical" resources, kept from frame to frame) and turns
+ * barriers into whatever its API needs. Renderer does this with D3D11
+ * textures, NullRenderer just counts, so a frame compiles and runs
+ * without a GPU.
+ */
+class IRenderGraphTarget {
+public:
+    virtual ~IRenderGraphTarget() = default;
+
+    // Physical resource `index` must be `desc` this frame; keep it if it
+    // already is. Called for every one before the first pass runs.
+    virtual bool PreparePhysical(uint32_t index, const GraphResourceDesc& desc) = 0;
+
+    // Before the pass that needs it. `physical` is ~0u for imported resources.
+    virtual void Barrier(const GraphBarrier& barrier, uint32_t physical) = 0;
+};
+
+class RenderGraph;
+
+// What a pass gets while it runs.
+struct RenderPassContext {
+    const RenderGraph& graph;
+    uint32_t pass;
+
+    // The backend's resource behind `resource`, ~0u if it is imported.
+    uint32_t Physical(GraphResource resource) const;
+    // This pass is the first to touch it this frame: clear or overwrite it all.
+    bool FirstUse(GraphResource resource) const;
+};
+
+struct RenderGraphStats {
+    uint32_t passes = 0;
+    uint32_t culled = 0;         // passes nobody needed the output of
+    uint32_t barriers = 0;
+    uint32_t transients = 0;     // transient resources used by the passes left
+    uint32_t physical = 0;       // what they were packed into
+    uint64_t transientBytes = 0; // with one allocation each
+    uint64_t physicalBytes = 0;  // after aliasing
+    double compileMs = 0.0;
+    double executeMs = 0.0;
+};
+
+/*
+ * RenderGraph
+ * The frame as a list of passes that say which resources they read and
+ * write, instead of one hard-coded clear-draw-present. Every frame:
+ *
+ *   graph.Reset();
+ *   GraphResource backBuffer = graph.Import("BackBuffer", desc, ResourceState::Present, ResourceState::Present);
+ *   GraphResource depth = graph.CreateTexture("Depth", desc);
+ *   graph.AddPass("Scene", [this](const RenderPassContext& ctx) { ... })
+ *       .Write(backBuffer, ResourceState::RenderTarget)
+ *       .Write(depth, ResourceState::DepthWrite);
+ *   if (graph.Compile())
+ *       graph.Execute(backend);
+ *
+ * Compile():
+ * - Culls passes whose output nobody uses. Imported resources (the back
+ *   buffer, anything the backend owns) are the frame's outputs; a pass is
+ *   kept if it writes one, writes something a kept later pass reads, or
+ *   was marked SideEffect(). Passes run in the order they were added.
+ * - Puts a barrier before a pass wherever a resource's state changes, and
+ *   one after the last pass to take imported resources to their final state.
+ * - Aliases transient resources: two whose passes don't overlap share one
+ *   physical resource. D3D11 can't place two textures in the same memory,
+ *   so sharing means the same texture object, which needs the same size
+ *   and format; buffers share with the biggest of them.
+ *
+ * Execute() runs the passes that are left and times each one on the CPU.
+ * Dump() lists passes, barriers, lifetimes and the memory aliasing saved.
+ *
+ * Nothing is allocated once the vectors have grown, as long as the pass
+ * functions capture no more than two pointers (std::function keeps those
+ * inline). Names are not copied: pass string literals.
+ */
+class RenderGraph {
+public:
+    using ExecuteFn = std::function<void(const RenderPassContext&)>;
+
+    class PassBuilder {
+    public:
+        PassBuilder& Read(GraphResource resource, ResourceState state = ResourceState::ShaderRead);
+        PassBuilder& Write(GraphResource resource, ResourceState state = ResourceState::RenderTarget);
+        // Never culled: it does something the graph can't see (readback, queries).
+        PassBuilder& SideEffect();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, uint32_t pass) : m_graph(graph), m_pass(pass) {}
+        PassBuilder& Use(GraphResource resource, ResourceState state, bool write);
+
+        RenderGraph& m_graph;
+        uint32_t m_pass;
+    };
+
+    struct Use {
+        GraphResource resource;
+        ResourceState state;
+        bool write;
+    };
+
+    struct Pass {
+        const char* name = "";
+        ExecuteFn execute;
+        uint32_t firstUse = 0;      // into GetUses()
+        uint32_t useCount = 0;
+        bool sideEffect = false;
+        // Compile
+        bool culled = false;
+        uint32_t firstBarrier = 0;  // into GetBarriers(), run before the pass
+        uint32_t barrierCount = 0;
+        // Execute
+        double milliseconds = 0.0;
+    };
+
+    struct Resource {
+        const char* name = "";
+        GraphResourceDesc desc;
+        bool imported = false;
+        ResourceState initial = ResourceState::Undefined; // imported: before and after the frame
+        ResourceState final = ResourceState::Undefined;
+        // Compile
+        uint32_t firstPass = ~0u;   // lifetime, in passes kept
+        uint32_t lastPass = 0;
+        uint32_t physical = ~0u;    // ~0u: imported, or not used
+    };
+
+    // A new frame: no passes and no resources. Keeps the memory.
+    void Reset();
+
+    GraphResource CreateTexture(const char* name, const GraphResourceDesc& desc);
+    GraphResource CreateBuffer(const char* name, uint64_t bytes);
+    GraphResource Import(const char* name, const GraphResourceDesc& desc, ResourceState initial, ResourceState final);
+
+    // Declare what it reads and writes on the builder, before the next AddPass
+    // (a Read or Write after it is an error in Compile).
+    PassBuilder AddPass(const char* name, ExecuteFn execute);
+
+    // False if a pass uses a resource that doesn't exist, or in two states
+    // at once, or reads a transient no earlier pass wrote, or declared a use
+    // too late. See GetError().
+    bool Compile();
+    void Execute(IRenderGraphTarget& target);
+    bool IsCompiled() const { return m_compiled; }
+
+    const std::vector<Pass>& GetPasses() const { return m_passes; }
+    const std::vector<Use>& GetUses() const { return m_uses; }
+    const std::vector<GraphBarrier>& GetBarriers() const { return m_barriers; }
+    const std::vector<GraphResourceDesc>& GetPhysical() const { return m_physical; }
+    const Resource& GetResource(GraphResource resource) const { return m_resources[resource - 1]; }
+    size_t ResourceCount() const { return m_resources.size(); }
+    // After the last pass: imported resources back to their final state.
+    uint32_t FinalBarriers() const { return m_finalBarriers; }
+
+    const RenderGraphStats& GetStats() const { return m_stats; }
+    const std::string& GetError() const { return m_error; }
+
+    // Passes with their barriers and CPU times, resources with their
+    // lifetimes, and how much memory aliasing saved. For logs.
+    std::string Dump() const;
+
+private:
+    bool Fail(const char* pass, const char* what, const char* resource);
+    void Alias();
+
+private:
+    std::vector<Pass> m_passes;
+    std::vector<Use> m_uses;
+    std::vector<Resource> m_resources;
+    std::vector<GraphBarrier> m_barriers;
+    std::vector<GraphResourceDesc> m_physical;
+    std::vector<uint32_t> m_physicalLast;   // last pass of what is in each physical resource
+    std::vector<uint8_t> m_needed;          // by resource, while culling
+    std::vector<ResourceState> m_state;     // by resource, while placing barriers
+    std::vector<GraphResource> m_order;     // transients by first pass, while aliasing
+    uint32_t m_finalBarriers = 0;
+    const char* m_lateUse = nullptr;        // a pass that declared a use after the next AddPass
+    bool m_compiled = false;
+    RenderGraphStats m_stats;
+    std::string m_error;
+};
@@ -3,35 +3,165 @@
 #include <string_view>
 #include <DirectXMath.h>
 #include "Renderer/MeshHandle.h"
+#include "Renderer/Meshlets.h"
+#include "Memory/AllocTracker.h"
 using namespace DirectX;
 using Entity = uint32_t;
 
+// Render arrays are charged to AllocTag::Render, see Memory/AllocTracker.h
+template<typename T>
+using RenderVector = std::vector<T, TaggedAllocator<T, AllocTag::Render>>;
+
 
 struct RenderItem {
+    static constexpr uint32_t NoVertices = ~0u;
+
     DirectX::XMFLOAT4X4 world;
     MeshHandle mesh;
     Entity id;
+    uint32_t lod = 0; // which LOD of `mesh` to draw (0 = full detail)
+
+    // Only the visible meshlets, see ClusterCulling.h.
+    // rangeCount == 0 means "draw the whole LOD".
+    uint32_t firstRange = 0;
+    uint32_t rangeCount = 0;
+
+    // Skinned meshes: their vertices for this frame start here in
+    // RenderQueue::GetVertices(), instead of the mesh's own vertex buffer.
+    uint32_t firstVertex = NoVertices;
+
+    // Instanced meshes (e.g. particles): instanceCount copies of the mesh, one
+    // per RenderQueue::GetInstances() entry from firstInstance on.
+    uint32_t firstInstance = 0;
+    uint32_t instanceCount = 0; // 0 = not instanced
 };
 
+// Per instance: where (xyz, added after `world`) and how big (w, uniform scale).
+using RenderInstance = DirectX::XMFLOAT4;
+
+// Filled while the queue is built, so the cost of a frame
+// can be checked without a GPU.
+struct RenderStats {
+    uint32_t items = 0;
+    uint64_t triangles = 0;           // what we actually submit
+    uint64_t fullDetailTriangles = 0; // what we would submit without LODs and culling
+    uint32_t clustersTested = 0;
+    uint32_t clustersVisible = 0;
+    uint32_t skinnedItems = 0;
+    uint64_t skinnedVertices = 0;
+    uint32_t instancedItems = 0;
+    uint64_t instances = 0;
+};
 
 
 class RenderQueue {
 public:
-    void Submit(const XMFLOAT4X4& world, MeshHandle mesh, Entity id) {
-        items.push_back({ world, mesh, id });
+    void Submit(const XMFLOAT4X4& world, MeshHandle mesh, Entity id, uint32_t lod = 0) {
+        items.push_back({ world, mesh, id, lod });
+        ++stats.items;
+    }
+
+    // Same as Submit, but only the given pieces of the index buffer are drawn.
+    void SubmitRanges(const XMFLOAT4X4& world, MeshHandle mesh, Entity id, const IndexRange* r, uint32_t count) {
+        RenderItem item{ world, mesh, id, 0 };
+        item.firstRange = static_cast<uint32_t>(ranges.size());
+        item.rangeCount = count;
+        ranges.insert(ranges.end(), r, r + count);
+        items.push_back(item);
+        ++stats.items;
+    }
+
+    // Room for `count` vertices of this frame; returns where they start.
+    // Fill them (e.g. from several jobs) before the queue is drawn.
+    uint32_t AllocateVertices(uint32_t count) {
+        const uint32_t first = static_cast<uint32_t>(vertices.size());
+        vertices.resize(vertices.size() + count);
+        return first;
+    }
+
+    // A mesh whose vertices were written into AllocateVertices' space.
+    void SubmitSkinned(const XMFLOAT4X4& world, MeshHandle mesh, Entity id, uint32_t firstVertex,
+                       uint32_t vertexCount, uint32_t lod = 0) {
+        RenderItem item{ world, mesh, id, lod };
+        item.firstVertex = firstVertex;
+        items.push_back(item);
+        ++stats.items;
+        ++stats.skinnedItems;
+        stats.skinnedVertices += vertexCount;
     }
 
+    // Room for `count` instances of this frame, like AllocateVertices.
+    uint32_t AllocateInstances(uint32_t count) {
+        const uint32_t first = static_cast<uint32_t>(instances.size());
+        instances.resize(instances.size() + count);
+        return first;
+    }
 
+    // One draw for `instanceCount` copies of `mesh`, see RenderInstance.
+    void SubmitInstanced(const XMFLOAT4X4& world, MeshHandle mesh, Entity id, uint32_t firstInstance,
+                         uint32_t instanceCount, uint32_t lod = 0) {
+        RenderItem item{ world, mesh, id, lod };
+        item.firstInstance = firstInstance;
+        item.instanceCount = instanceCount;
+        items.push_back(item);
+        ++stats.items;
+        ++stats.instancedItems;
+        stats.instances += instanceCount;
+    }
 
+    void AddClusters(uint32_t tested, uint32_t visible) {
+        stats.clustersTested += tested;
+        stats.clustersVisible += visible;
+    }
 
-    const std::vector<RenderItem>& GetItems() const {
+    void AddTriangles(uint64_t submitted, uint64_t fullDetail) {
+        stats.triangles += submitted;
+        stats.fullDetailTriangles += fullDetail;
+    }
+
+
+    const RenderVector<RenderItem>& GetItems() const {
         return items;
     }
 
+    const RenderVector<IndexRange>& GetRanges() const {
+        return ranges;
+    }
+
+    const RenderVector<XMFLOAT3>& GetVertices() const {
+        return vertices;
+    }
+
+    XMFLOAT3* VertexData() {
+        return vertices.data();
+    }
+
+    const RenderVector<RenderInstance>& GetInstances() const {
+        return instances;
+    }
+
+    RenderInstance* InstanceData() {
+        return instances.data();
+    }
+
+    const RenderStats& GetStats() const {
+        return stats;
+    }
+
     void Clear() {
         items.clear();
+        ranges.clear();
+        vertices.clear();
+        instances.clear();
+        stats = {};
     }
 
 private:
-    std::vector<RenderItem> items;
+    // Clear() keeps the capacity: once the scene stopped growing,
+    // building the queue doesn't allocate anymore.
+    RenderVector<RenderItem> items;
+    RenderVector<IndexRange> ranges;
+    RenderVector<XMFLOAT3> vertices; // skinned meshes, in their model space
+    RenderVector<RenderInstance> instances;
+    RenderStats stats;
 };
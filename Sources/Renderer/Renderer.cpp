@@ -5,6 +5,9 @@
 #include <dxgi.h>
 #include <d3dcompiler.h>
 #include <string>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
 using namespace DirectX;
 
 Renderer::~Renderer() { Shutdown(); }
@@ -15,7 +18,6 @@ bool Renderer::Init(HWND hwnd, uint32_t width, uint32_t height) {
 
     if (!CreateDeviceAndSwapChain(hwnd, width, height)) goto fail;
     if (!CreateRenderTarget()) goto fail;
-    if (!CreateDepthBuffer()) goto fail;
     if (!CreateShaders()) goto fail;
     if (!CreateConstantBuffer()) goto fail;
     if (!CreateRasterizerState()) goto fail;
@@ -25,54 +27,88 @@ fail:
 	MessageBoxA(hwnd, "Failed to initialize renderer.", "Initialization Error", MB_OK | MB_ICONERROR);
     return false;
 }
-GpuMesh& Renderer::GetOrCreateGpuMesh(MeshHandle handle)
+const GpuMesh* Renderer::FindGpuMesh(MeshHandle handle) const
 {
     auto it = m_gpuMeshes.find(handle);
-    if (it != m_gpuMeshes.end())
-        return it->second;
+    return it != m_gpuMeshes.end() ? &it->second : nullptr;
+}
 
-    const MeshData* cpu = m_meshStorage->Get(handle);
-    assert(cpu && "Invalid MeshHandle");
+uint8_t* Renderer::MapStaging(uint64_t capacity)
+{
+    if (capacity != m_stagingBytes) {
+        // The ring only grows when nothing in it is in flight anymore.
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DYNAMIC;
+        bd.ByteWidth = UINT(capacity);
+        bd.BindFlags = D3D11_BIND_VERTEX_BUFFER; // NO_OVERWRITE needs vertex/index binding on D3D 11.0
+        bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        m_staging.Reset();
+        m_stagingBytes = 0;
+        if (FAILED(m_device->CreateBuffer(&bd, nullptr, &m_staging)))
+            return nullptr;
+        m_stagingBytes = capacity;
+        m_stagingFresh = true;
+    }
 
-    GpuMesh gpu = CreateGpuMesh(*cpu);
-    return m_gpuMeshes.emplace(handle, std::move(gpu)).first->second;
+    // NO_OVERWRITE: the GPU may still copy out of other parts of the ring,
+    // the UploadQueue never hands those out. A new buffer is mapped once with
+    // DISCARD, as D3D asks for.
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    const D3D11_MAP mode = m_stagingFresh ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+    if (FAILED(m_context->Map(m_staging.Get(), 0, mode, 0, &mapped)))
+        return nullptr;
+    m_stagingFresh = false;
+    return static_cast<uint8_t*>(mapped.pData);
 }
 
-GpuMesh Renderer::CreateGpuMesh(const MeshData& cpu)
+void Renderer::UnmapStaging()
+{
+    m_context->Unmap(m_staging.Get(), 0);
+}
+
+bool Renderer::CreateMesh(MeshHandle handle, const MeshData& cpu, uint64_t vertexOffset, uint64_t indexOffset)
 {
     GpuMesh mesh;
     mesh.indexCount = static_cast<UINT>(cpu.indices.size());
 
-    // --- Vertex buffer ---
-    std::vector<Vertex> vertices;
-    vertices.reserve(cpu.positions.size());
-
-    for (const auto& p : cpu.positions) {
-        vertices.push_back({ p });
+    // The vertex stream was converted to the GPU layout at import
+    // (MeshStorage::Add), the staged bytes are used as they are.
+    const VertexStream& stream = cpu.vertexStream;
+    mesh.format = stream.format;
+    mesh.stride = stream.stride;
+    mesh.positionScale = stream.positionScale;
+    mesh.positionOffset = stream.positionOffset;
+
+    // Every LOD back to back in one index buffer.
+    UINT totalIndices = 0;
+    mesh.lods.reserve(cpu.LodCount());
+    for (uint32_t lod = 0; lod < cpu.LodCount(); ++lod) {
+        const UINT count = UINT(cpu.LodIndices(lod).size());
+        mesh.lods.push_back({ totalIndices, count });
+        totalIndices += count;
     }
 
     D3D11_BUFFER_DESC vbd{};
     vbd.Usage = D3D11_USAGE_DEFAULT;
-    vbd.ByteWidth = UINT(vertices.size() * sizeof(Vertex));
+    vbd.ByteWidth = UINT(stream.bytes.size());
     vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-
-    D3D11_SUBRESOURCE_DATA vinit{};
-    vinit.pSysMem = vertices.data();
-
-    m_device->CreateBuffer(&vbd, &vinit, &mesh.vb);
-
-    
     D3D11_BUFFER_DESC ibd{};
     ibd.Usage = D3D11_USAGE_DEFAULT;
-    ibd.ByteWidth = UINT(cpu.indices.size() * sizeof(uint32_t));
+    ibd.ByteWidth = totalIndices * UINT(sizeof(uint32_t));
     ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+    if (FAILED(m_device->CreateBuffer(&vbd, nullptr, &mesh.vb)) ||
+        FAILED(m_device->CreateBuffer(&ibd, nullptr, &mesh.ib)))
+        return false;
 
-    D3D11_SUBRESOURCE_DATA iinit{};
-    iinit.pSysMem = cpu.indices.data();
-
-    m_device->CreateBuffer(&ibd, &iinit, &mesh.ib);
+    // GPU-side copies out of the ring: no CPU wait, no second CPU copy.
+    const D3D11_BOX vbox{ UINT(vertexOffset), 0, 0, UINT(vertexOffset) + vbd.ByteWidth, 1, 1 };
+    const D3D11_BOX ibox{ UINT(indexOffset), 0, 0, UINT(indexOffset) + ibd.ByteWidth, 1, 1 };
+    m_context->CopySubresourceRegion(mesh.vb.Get(), 0, 0, 0, 0, m_staging.Get(), 0, &vbox);
+    m_context->CopySubresourceRegion(mesh.ib.Get(), 0, 0, 0, 0, m_staging.Get(), 0, &ibox);
+    m_stats.bytesUploaded += vbd.ByteWidth + ibd.ByteWidth;
 
-    return mesh;
+    m_gpuMeshes[handle] = std::move(mesh); // a changed mesh: the old buffers go now
+    return true;
 }
 
 bool Renderer::CreateDeviceAndSwapChain(HWND hwnd, uint32_t w, uint32_t h) {
@@ -103,100 +139,205 @@ bool Renderer::CreateRenderTarget() {
     return SUCCEEDED(m_device->CreateRenderTargetView(bb.Get(), nullptr, &m_rtv));
 }
 
-bool Renderer::CreateDepthBuffer() {
+bool Renderer::PreparePhysical(uint32_t index, const GraphResourceDesc& desc)
+{
+    if (index >= m_graphPool.size())
+        m_graphPool.resize(index + 1);
+    GraphTexture& gt = m_graphPool[index];
+    const GraphResourceDesc& old = gt.desc;
+    if ((gt.texture || gt.buffer) && old.kind == desc.kind && old.width == desc.width &&
+        old.height == desc.height && old.format == desc.format && old.bytes == desc.bytes)
+        return true; // same as last frame: keep it
+
+    gt = {};
+    gt.desc = desc;
+    if (desc.kind == GraphResourceDesc::Kind::Buffer) {
+        D3D11_BUFFER_DESC bd{};
+        bd.ByteWidth = UINT((desc.bytes + 3) & ~uint64_t(3));
+        bd.Usage = D3D11_USAGE_DEFAULT;
+        bd.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+        bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+        return SUCCEEDED(m_device->CreateBuffer(&bd, nullptr, &gt.buffer));
+    }
+
+    const DXGI_FORMAT format = DXGI_FORMAT(desc.format);
+    const bool depth = format == DXGI_FORMAT_D24_UNORM_S8_UINT || format == DXGI_FORMAT_D32_FLOAT ||
+                       format == DXGI_FORMAT_D16_UNORM || format == DXGI_FORMAT_D32_FLOAT_S8X24_UINT;
     D3D11_TEXTURE2D_DESC d{};
-    d.Width = m_width;
-    d.Height = m_height;
+    d.Width = desc.width;
+    d.Height = desc.height;
     d.MipLevels = 1;
     d.ArraySize = 1;
-    d.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    d.Format = format;
     d.SampleDesc.Count = 1;
-    d.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+    // Depth formats can't be read by shaders without a typeless format;
+    // none of our passes does, so they only get a depth-stencil view.
+    d.BindFlags = depth ? D3D11_BIND_DEPTH_STENCIL : D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    if (FAILED(m_device->CreateTexture2D(&d, nullptr, &gt.texture)))
+        return false;
+    if (depth)
+        return SUCCEEDED(m_device->CreateDepthStencilView(gt.texture.Get(), nullptr, &gt.dsv));
+    return SUCCEEDED(m_device->CreateRenderTargetView(gt.texture.Get(), nullptr, &gt.rtv)) &&
+           SUCCEEDED(m_device->CreateShaderResourceView(gt.texture.Get(), nullptr, &gt.srv));
+}
 
-    Microsoft::WRL::ComPtr<ID3D11Texture2D> tex;
-    if (FAILED(m_device->CreateTexture2D(&d, nullptr, &tex))) return false;
-    return SUCCEEDED(m_device->CreateDepthStencilView(tex.Get(), nullptr, &m_dsv));
+void Renderer::Barrier(const GraphBarrier& barrier, uint32_t)
+{
+    // D3D11 inserts the GPU's own barriers; what it won't do is let a
+    // resource be bound as an output and an input at once.
+    switch (barrier.before) {
+    case ResourceState::RenderTarget:
+    case ResourceState::DepthWrite:
+    case ResourceState::DepthRead:
+    case ResourceState::UnorderedAccess:
+        if (m_state.Bind(BindSlot::RenderTargets, 0))
+            m_context->OMSetRenderTargets(0, nullptr, nullptr);
+        break;
+    case ResourceState::ShaderRead:
+        if (m_state.Bind(BindSlot::ShaderResources, 0)) {
+            ID3D11ShaderResourceView* none[8] = {};
+            m_context->PSSetShaderResources(0, 8, none);
+        }
+        break;
+    default:
+        break;
+    }
 }
 
 bool Renderer::CreateShaders()
 {
-    Microsoft::WRL::ComPtr<ID3DBlob> vsBlob;
-    Microsoft::WRL::ComPtr<ID3DBlob> psBlob;
-    Microsoft::WRL::ComPtr<ID3DBlob> error;
-
-    
-    HRESULT hr = D3DCompileFromFile(
-        L"Simple.hlsl",
-        nullptr,
-        nullptr,
-        "VSMain",
-        "vs_5_0",
-        D3DCOMPILE_ENABLE_STRICTNESS,
-        0,
-        &vsBlob,
-        &error
-    );
-
-    if (FAILED(hr))
-    {
-        if (error)
-            MessageBoxA(nullptr, (char*)error->GetBufferPointer(),
-                "Vertex Shader Compile Error", MB_OK | MB_ICONERROR);
+    // Every shader the renderer needs, loaded in one go so the ones
+    // missing from the cache compile in parallel (see ShaderCache.h).
+    enum { VS, VSPacked, VSInstanced, PS, ShaderCount };
+    std::vector<ShaderDesc> descs(ShaderCount);
+    descs[VS]       = { "Simple.hlsl", "VSMain",       "vs_5_0", {} };
+    descs[VSPacked] = { "Simple.hlsl", "VSMainPacked", "vs_5_0", {} };
+    descs[VSInstanced] = { "Simple.hlsl", "VSMainInstanced", "vs_5_0", {} };
+    descs[PS]       = { "Simple.hlsl", "PSMain",       "ps_5_0", {} };
+
+    std::vector<ShaderBytecode> code;
+    if (!m_shaderCache.Load(descs, code)) {
+        MessageBoxA(nullptr, m_shaderCache.GetErrors().c_str(),
+            "Shader Compile Error", MB_OK | MB_ICONERROR);
         return false;
     }
 
+    const ShaderCacheStats& st = m_shaderCache.GetStats();
+    char line[160];
+    snprintf(line, sizeof(line), "Shaders: %u requested, %u from cache, %u compiled, %.1f ms\n",
+        st.requested, st.hits, st.compiled, st.milliseconds);
+    OutputDebugStringA(line);
+
+    const ShaderBytecode& vsBlob = code[VS];
+    const ShaderBytecode& vsPackedBlob = code[VSPacked];
+    const ShaderBytecode& vsInstancedBlob = code[VSInstanced];
+    const ShaderBytecode& psBlob = code[PS];
+
     if (FAILED(m_device->CreateVertexShader(
-        vsBlob->GetBufferPointer(),
-        vsBlob->GetBufferSize(),
+        vsBlob.Data(),
+        vsBlob.Size(),
         nullptr,
         &m_vs)))
         return false;
 
-    
-    error.Reset();
-
-    hr = D3DCompileFromFile(
-        L"Simple.hlsl",
-        nullptr,
+    if (FAILED(m_device->CreateVertexShader(
+        vsPackedBlob.Data(),
+        vsPackedBlob.Size(),
         nullptr,
-        "PSMain",
-        "ps_5_0",
-        D3DCOMPILE_ENABLE_STRICTNESS,
-        0,
-        &psBlob,
-        &error
-    );
+        &m_vsPacked)))
+        return false;
 
-    if (FAILED(hr))
-    {
-        if (error)
-            MessageBoxA(nullptr, (char*)error->GetBufferPointer(),
-                "Pixel Shader Compile Error", MB_OK | MB_ICONERROR);
+    if (FAILED(m_device->CreateVertexShader(
+        vsInstancedBlob.Data(),
+        vsInstancedBlob.Size(),
+        nullptr,
+        &m_vsInstanced)))
         return false;
-    }
 
     if (FAILED(m_device->CreatePixelShader(
-        psBlob->GetBufferPointer(),
-        psBlob->GetBufferSize(),
+        psBlob.Data(),
+        psBlob.Size(),
         nullptr,
         &m_ps)))
         return false;
 
-   
+    // One input layout per VertexFormat (see VertexFormat.h).
+    // Float3 and Quantized both feed VSMain: UNORM positions arrive as 0..1
+    // and the shader scales them back with positionScale / positionOffset.
     D3D11_INPUT_ELEMENT_DESC layout[] =
     {
         { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,
           D3D11_INPUT_PER_VERTEX_DATA, 0 }
     };
 
+    D3D11_INPUT_ELEMENT_DESC layoutQuantized[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0,
+          D3D11_INPUT_PER_VERTEX_DATA, 0 }
+    };
+
+    D3D11_INPUT_ELEMENT_DESC layoutPacked[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "NORMAL",   0, DXGI_FORMAT_R16G16_SNORM,       0, 8,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TANGENT",  0, DXGI_FORMAT_R16G16_SNORM,       0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT,       0, 16, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+    };
+
+    // Instanced draws: the mesh position from slot 0 (float or UNORM; Packed
+    // starts with the same UNORM position), one RenderInstance per copy from slot 1.
+    D3D11_INPUT_ELEMENT_DESC layoutInstanced[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0, 0, D3D11_INPUT_PER_VERTEX_DATA,   0 },
+        { "INSTANCE", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+    };
+
+    D3D11_INPUT_ELEMENT_DESC layoutInstancedUnorm[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D11_INPUT_PER_VERTEX_DATA,   0 },
+        { "INSTANCE", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+    };
+
     if (FAILED(m_device->CreateInputLayout(
         layout,
-        1,
-        vsBlob->GetBufferPointer(),
-        vsBlob->GetBufferSize(),
+        _countof(layout),
+        vsBlob.Data(),
+        vsBlob.Size(),
         &m_inputLayout)))
         return false;
 
+    if (FAILED(m_device->CreateInputLayout(
+        layoutQuantized,
+        _countof(layoutQuantized),
+        vsBlob.Data(),
+        vsBlob.Size(),
+        &m_inputLayoutQuantized)))
+        return false;
+
+    if (FAILED(m_device->CreateInputLayout(
+        layoutPacked,
+        _countof(layoutPacked),
+        vsPackedBlob.Data(),
+        vsPackedBlob.Size(),
+        &m_inputLayoutPacked)))
+        return false;
+
+    if (FAILED(m_device->CreateInputLayout(
+        layoutInstanced,
+        _countof(layoutInstanced),
+        vsInstancedBlob.Data(),
+        vsInstancedBlob.Size(),
+        &m_inputLayoutInstanced)))
+        return false;
+
+    if (FAILED(m_device->CreateInputLayout(
+        layoutInstancedUnorm,
+        _countof(layoutInstancedUnorm),
+        vsInstancedBlob.Data(),
+        vsInstancedBlob.Size(),
+        &m_inputLayoutInstancedUnorm)))
+        return false;
+
     return true;
 }
 
@@ -250,95 +391,333 @@ bool Renderer::CreateRasterizerState() {
 }
 
 void Renderer::BeginFrame(float r, float g, float b, float a) {
-    float c[4]{ r,g,b,a };
-    m_context->OMSetRenderTargets(1, m_rtv.GetAddressOf(), m_dsv.Get());
-    m_context->ClearRenderTargetView(m_rtv.Get(), c);
-    m_context->ClearDepthStencilView(m_dsv.Get(), D3D11_CLEAR_DEPTH, 1, 0);
-    m_context->RSSetState(m_rasterState.Get());
+    m_stats = {};
+    m_scratch.Reset();
+
+    m_state.ResetStats();
+    m_clearColor[0] = r; m_clearColor[1] = g; m_clearColor[2] = b; m_clearColor[3] = a;
 
     D3D11_VIEWPORT vp{ 0,0,(float)m_width,(float)m_height,0,1 };
     m_context->RSSetViewports(1, &vp);
+
+    // The frame's graph: the swap chain's back buffer (owned outside the
+    // graph), a transient depth buffer, and the clear. Draw adds the scene.
+    m_graph.Reset();
+    m_backBuffer = m_graph.Import("BackBuffer",
+        GraphResourceDesc::Texture(m_width, m_height, DXGI_FORMAT_R8G8B8A8_UNORM, 4),
+        ResourceState::Present, ResourceState::Present);
+    m_depth = m_graph.CreateTexture("Depth",
+        GraphResourceDesc::Texture(m_width, m_height, DXGI_FORMAT_D24_UNORM_S8_UINT, 4));
+    m_graph.AddPass("Clear", [this](const RenderPassContext& ctx) {
+            m_context->ClearRenderTargetView(m_rtv.Get(), m_clearColor);
+            // No view if the texture couldn't be created (out of memory).
+            if (ID3D11DepthStencilView* dsv = m_graphPool[ctx.Physical(m_depth)].dsv.Get())
+                m_context->ClearDepthStencilView(dsv, D3D11_CLEAR_DEPTH, 1, 0);
+        })
+        .Write(m_backBuffer, ResourceState::RenderTarget)
+        .Write(m_depth, ResourceState::DepthWrite);
+}
+
+void Renderer::RunGraph()
+{
+    if (m_graph.IsCompiled())
+        return; // already ran this frame
+    if (m_graph.Compile())
+        m_graph.Execute(*this);
+    else
+        OutputDebugStringA(("RenderGraph: " + m_graph.GetError() + "\n").c_str());
+    const RenderGraphStats& gs = m_graph.GetStats();
+    m_stats.passes = gs.passes - gs.culled;
+    m_stats.barriers = gs.barriers;
+    m_stats.bindsIssued = m_state.GetStats().issued;
+    m_stats.bindsSkipped = m_state.GetStats().skipped;
+}
+
+void Renderer::BindPipeline(const PipelineDesc& desc)
+{
+    bool created = false;
+    const PipelineHandle handle = m_pipelines.Get(desc, &created);
+    if (created) {
+        GpuPipeline p;
+        switch (desc.layout) {
+        case InputLayoutId::Float3:         p.layout = m_inputLayout.Get(); break;
+        case InputLayoutId::Quantized:      p.layout = m_inputLayoutQuantized.Get(); break;
+        case InputLayoutId::Packed:         p.layout = m_inputLayoutPacked.Get(); break;
+        case InputLayoutId::Instanced:      p.layout = m_inputLayoutInstanced.Get(); break;
+        case InputLayoutId::InstancedUnorm: p.layout = m_inputLayoutInstancedUnorm.Get(); break;
+        }
+        switch (desc.vertexShader) {
+        case VertexShaderId::Basic:     p.vs = m_vs.Get(); break;
+        case VertexShaderId::Packed:    p.vs = m_vsPacked.Get(); break;
+        case VertexShaderId::Instanced: p.vs = m_vsInstanced.Get(); break;
+        }
+        p.ps = m_ps.Get(); // PixelShaderId::Basic
+        p.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        p.raster = m_rasterState.Get();
+        m_gpuPipelines.push_back(p);
+    }
+
+    const GpuPipeline& p = m_gpuPipelines[handle - 1];
+    const uint32_t changed = m_state.BindPipeline(handle, desc);
+    if (changed & (1u << uint32_t(BindSlot::InputLayout)))
+        m_context->IASetInputLayout(p.layout);
+    if (changed & (1u << uint32_t(BindSlot::VertexShader)))
+        m_context->VSSetShader(p.vs, nullptr, 0);
+    if (changed & (1u << uint32_t(BindSlot::PixelShader)))
+        m_context->PSSetShader(p.ps, nullptr, 0);
+    if (changed & (1u << uint32_t(BindSlot::Topology)))
+        m_context->IASetPrimitiveTopology(p.topology);
+    if (changed & (1u << uint32_t(BindSlot::RasterState)))
+        m_context->RSSetState(p.raster);
+}
+
+bool Renderer::UploadDynamic(Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer, UINT& capacity,
+                             const void* data, size_t bytes)
+{
+    if (bytes == 0)
+        return true;
+
+    if (bytes > capacity) {
+        // Grow by half again, so a slowly growing crowd doesn't recreate it every frame.
+        const UINT size = std::max(UINT(bytes), capacity + capacity / 2);
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DYNAMIC;
+        bd.ByteWidth = size;
+        bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        buffer.Reset();
+        capacity = 0;
+        if (FAILED(m_device->CreateBuffer(&bd, nullptr, &buffer)))
+            return false;
+        capacity = size;
+    }
+
+    // WRITE_DISCARD: the GPU may still read last frame's copy, we get a fresh one.
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    if (FAILED(m_context->Map(buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+        return false;
+    std::memcpy(mapped.pData, data, bytes);
+    m_context->Unmap(buffer.Get(), 0);
+    m_stats.bytesUploaded += bytes;
+    return true;
 }
 
 void Renderer::Draw(const RenderQueue& q)
 {
-    for (const auto& item : q.GetItems()) {
-        DirectX::XMMATRIX world =
-            DirectX::XMLoadFloat4x4(&item.world);
+    // Empty: there is no buffer of this frame for skinned / instanced items to read.
+    m_frameVerticesReady = !q.GetVertices().empty() && UploadDynamic(m_frameVertices, m_frameVertexBytes,
+        q.GetVertices().data(), q.GetVertices().size() * sizeof(XMFLOAT3));
+    m_frameInstancesReady = !q.GetInstances().empty() && UploadDynamic(m_frameInstances, m_frameInstanceBytes,
+        q.GetInstances().data(), q.GetInstances().size() * sizeof(RenderInstance));
+
+    // Every item's world * view * proj in one batched call, instead of two
+    // matrix products per draw (see Math/SimdMath.h).
+    const auto& items = q.GetItems();
+    Simd::Mat4* mvps = m_scratch.AllocateArray<Simd::Mat4>(items.size());
+    static_assert(sizeof(Simd::Mat4) == sizeof(XMFLOAT4X4), "Mat4 has XMFLOAT4X4's layout");
+    for (size_t i = 0; i < items.size(); ++i)
+        std::memcpy(&mvps[i], &items[i].world, sizeof(Simd::Mat4));
+    XMFLOAT4X4 viewProj;
+    XMStoreFloat4x4(&viewProj, BuildViewMatrix(m_camera) * BuildProjectionMatrix(m_camera, float(m_width) / m_height));
+    Simd::Mat4 vp;
+    std::memcpy(&vp, &viewProj, sizeof(vp));
+    Simd::MultiplyMatrices(mvps, vp, mvps, items.size());
+
+    // Meshes this frame needs go first in the upload queue, nearest first.
+    // What isn't uploaded after the budget is spent is skipped this frame.
+    for (const RenderItem& item : items) {
+        const float dx = item.world.m[3][0] - m_camera.position.x;
+        const float dy = item.world.m[3][1] - m_camera.position.y;
+        const float dz = item.world.m[3][2] - m_camera.position.z;
+        m_uploads.Request(item.mesh, dx * dx + dy * dy + dz * dz);
+    }
+    m_uploads.Update(*m_meshStorage);
+    m_stats.uploadsPending = m_uploads.GetStats().pending;
+    m_frameMvps = mvps;
+
+    m_graph.AddPass("Scene", [this, &q](const RenderPassContext& ctx) {
+            ID3D11DepthStencilView* dsv = m_graphPool[ctx.Physical(m_depth)].dsv.Get();
+            if (m_state.Bind(BindSlot::RenderTargets, StateTracker::HashKey(uintptr_t(m_rtv.Get()), uintptr_t(dsv))))
+                m_context->OMSetRenderTargets(1, m_rtv.GetAddressOf(), dsv);
+            DrawItems(q);
+        })
+        .Write(m_backBuffer, ResourceState::RenderTarget)
+        .Write(m_depth, ResourceState::DepthWrite);
+    RunGraph();
+}
 
-        DrawMesh(item.mesh, world);
+void Renderer::DrawItems(const RenderQueue& q)
+{
+    const IndexRange* ranges = q.GetRanges().data();
+    const auto& items = q.GetItems();
+    for (size_t i = 0; i < items.size(); ++i) {
+        const RenderItem& item = items[i];
+        if (item.firstVertex != RenderItem::NoVertices && !m_frameVerticesReady)
+            continue;
+        if (!m_uploads.IsResident(item.mesh) || !FindGpuMesh(item.mesh)) {
+            ++m_stats.notReady;
+            continue;
+        }
+
+        XMFLOAT4X4 mvp;
+        std::memcpy(&mvp, &m_frameMvps[i], sizeof(mvp));
+
+        if (item.instanceCount) {
+            if (m_frameInstancesReady)
+                DrawInstances(item.mesh, mvp, item.lod, item.firstInstance, item.instanceCount);
+            continue;
+        }
+
+        DrawMesh(item.mesh, mvp, item.lod,
+            item.rangeCount ? ranges + item.firstRange : nullptr, item.rangeCount, item.firstVertex);
     }
 }
-void Renderer::DrawMesh(MeshHandle mesh, DirectX::XMMATRIX world)
+
+void Renderer::DrawMesh(MeshHandle mesh, const DirectX::XMFLOAT4X4& mvp, uint32_t lod,
+                        const IndexRange* ranges, uint32_t rangeCount, uint32_t firstVertex)
 {
     using namespace DirectX;
 
-    GpuMesh& gm = GetOrCreateGpuMesh(mesh);
+    const GpuMesh* found = FindGpuMesh(mesh);
+    if (!found)
+        return;
+    const GpuMesh& gm = *found;
+    const GpuLodRange& range = gm.lods[lod < gm.lods.size() ? lod : gm.lods.size() - 1];
 
-    XMMATRIX view = XMMatrixLookAtLH(
-        XMVectorSet(0, 0, -5, 1),
-        XMVectorSet(0, 0, 0, 1),
-        XMVectorSet(0, 1, 0, 0)
-    );
-
-    XMMATRIX proj = XMMatrixPerspectiveFovLH(
-        XM_PIDIV4,
-        float(m_width) / m_height,
-        0.1f,
-        1000.0f
-    );
+    // Skinned vertices are plain floats, written this frame: nothing to dequantize.
+    const bool skinned = firstVertex != RenderItem::NoVertices;
+    const VertexFormat format = skinned ? VertexFormat::Float3 : gm.format;
 
     CB_Matrices cb;
-    XMStoreFloat4x4(&cb.mvp, world * view * proj);
+    cb.mvp = mvp;
+    if (skinned) {
+        cb.positionScale = { 1.0f, 1.0f, 1.0f, 0.0f };
+        cb.positionOffset = { 0.0f, 0.0f, 0.0f, 0.0f };
+    }
+    else {
+        cb.positionScale = { gm.positionScale.x, gm.positionScale.y, gm.positionScale.z, 0.0f };
+        cb.positionOffset = { gm.positionOffset.x, gm.positionOffset.y, gm.positionOffset.z, 0.0f };
+    }
 
     m_context->UpdateSubresource(
         m_cbMatrices.Get(), 0, nullptr, &cb, 0, 0
     );
+    m_stats.bytesUploaded += sizeof(cb);
 
-    m_context->VSSetConstantBuffers(0, 1, m_cbMatrices.GetAddressOf());
+    // Every bind below goes through m_state: only what differs from the
+    // previous draw reaches the driver.
+    if (m_state.Bind(BindSlot::VSConstants, uintptr_t(m_cbMatrices.Get())))
+        m_context->VSSetConstantBuffers(0, 1, m_cbMatrices.GetAddressOf());
 
-    UINT stride = sizeof(Vertex);
+    UINT stride = skinned ? UINT(sizeof(XMFLOAT3)) : gm.stride;
     UINT offset = 0;
+    // The character's vertices start at firstVertex in the frame stream:
+    // passed as base vertex, so the mesh's index buffer is used as it is.
+    const INT baseVertex = skinned ? INT(firstVertex) : 0;
 
-    m_context->IASetVertexBuffers(
-        0, 1, gm.vb.GetAddressOf(), &stride, &offset
-    );
+    ID3D11Buffer* vb = skinned ? m_frameVertices.Get() : gm.vb.Get();
+    if (m_state.Bind(BindSlot::VertexBuffers, StateTracker::HashKey(uintptr_t(vb), stride)))
+        m_context->IASetVertexBuffers(0, 1, &vb, &stride, &offset);
 
-    m_context->IASetIndexBuffer(
-        gm.ib.Get(), DXGI_FORMAT_R32_UINT, 0
-    );
+    if (m_state.Bind(BindSlot::IndexBuffer, uintptr_t(gm.ib.Get())))
+        m_context->IASetIndexBuffer(gm.ib.Get(), DXGI_FORMAT_R32_UINT, 0);
+
+    BindPipeline(PipelineDesc::ForMesh(format, skinned, false));
 
-    m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    m_context->IASetInputLayout(m_inputLayout.Get());
-    m_context->VSSetShader(m_vs.Get(), nullptr, 0);
-    m_context->PSSetShader(m_ps.Get(), nullptr, 0);
+    if (ranges && rangeCount) {
+        // LOD 0 starts at index 0 of the buffer, so meshlet ranges can be used as they are.
+        for (uint32_t i = 0; i < rangeCount; ++i)
+            m_context->DrawIndexed(ranges[i].indexCount, ranges[i].firstIndex, baseVertex);
+        m_stats.draws += rangeCount;
+        return;
+    }
 
-    m_context->DrawIndexed(gm.indexCount, 0, 0);
+    m_context->DrawIndexed(range.indexCount, range.firstIndex, baseVertex);
+    ++m_stats.draws;
 }
 
+void Renderer::DrawInstances(MeshHandle mesh, const DirectX::XMFLOAT4X4& mvp, uint32_t lod,
+                             uint32_t firstInstance, uint32_t instanceCount)
+{
+    using namespace DirectX;
 
+    const GpuMesh* found = FindGpuMesh(mesh);
+    if (!found)
+        return;
+    const GpuMesh& gm = *found;
+    const GpuLodRange& range = gm.lods[lod < gm.lods.size() ? lod : gm.lods.size() - 1];
 
-void Renderer::EndFrame() { m_swapChain->Present(0, 0); }
+    CB_Matrices cb;
+    cb.mvp = mvp;
+    cb.positionScale = { gm.positionScale.x, gm.positionScale.y, gm.positionScale.z, 0.0f };
+    cb.positionOffset = { gm.positionOffset.x, gm.positionOffset.y, gm.positionOffset.z, 0.0f };
+    m_context->UpdateSubresource(m_cbMatrices.Get(), 0, nullptr, &cb, 0, 0);
+    m_stats.bytesUploaded += sizeof(cb);
+    if (m_state.Bind(BindSlot::VSConstants, uintptr_t(m_cbMatrices.Get())))
+        m_context->VSSetConstantBuffers(0, 1, m_cbMatrices.GetAddressOf());
+
+    // Slot 0: the mesh, slot 1: one RenderInstance per copy.
+    ID3D11Buffer* buffers[2] = { gm.vb.Get(), m_frameInstances.Get() };
+    UINT strides[2] = { gm.stride, UINT(sizeof(RenderInstance)) };
+    UINT offsets[2] = { 0, 0 };
+    if (m_state.Bind(BindSlot::VertexBuffers, StateTracker::HashKey(uintptr_t(buffers[0]), strides[0], uintptr_t(buffers[1]))))
+        m_context->IASetVertexBuffers(0, 2, buffers, strides, offsets);
+    if (m_state.Bind(BindSlot::IndexBuffer, uintptr_t(gm.ib.Get())))
+        m_context->IASetIndexBuffer(gm.ib.Get(), DXGI_FORMAT_R32_UINT, 0);
+
+    BindPipeline(PipelineDesc::ForMesh(gm.format, false, true));
+
+    m_context->DrawIndexedInstanced(range.indexCount, instanceCount, range.firstIndex, 0, firstInstance);
+    ++m_stats.draws;
+}
+
+
+
+void Renderer::EndFrame()
+{
+    RunGraph(); // a frame without Draw still clears
+    m_swapChain->Present(0, 0);
+}
 
 void Renderer::Resize(uint32_t w, uint32_t h) {
     if (!m_swapChain) return;
     m_context->OMSetRenderTargets(0, nullptr, nullptr);
-    m_rtv.Reset(); m_dsv.Reset();
+    m_state.InvalidateAll();
+    m_rtv.Reset();
     m_swapChain->ResizeBuffers(0, w, h, DXGI_FORMAT_UNKNOWN, 0);
     m_width = w; m_height = h;
     CreateRenderTarget();
-    CreateDepthBuffer();
+    // The graph's textures are recreated at the new size by the next frame.
+    m_graphPool.clear();
 }
 
 void Renderer::Shutdown() {
     m_vertexBuffer.Reset();
     m_indexBuffer.Reset();
     m_cbMatrices.Reset();
+    m_frameVertices.Reset();
+    m_frameVertexBytes = 0;
+    m_frameInstances.Reset();
+    m_frameInstanceBytes = 0;
+    m_gpuMeshes.clear();
+    m_uploads.Clear();
+    m_staging.Reset();
+    m_stagingBytes = 0;
     m_inputLayout.Reset();
+    m_inputLayoutQuantized.Reset();
+    m_inputLayoutPacked.Reset();
+    m_inputLayoutInstanced.Reset();
+    m_inputLayoutInstancedUnorm.Reset();
     m_vs.Reset();
+    m_vsPacked.Reset();
+    m_vsInstanced.Reset();
     m_ps.Reset();
     m_rasterState.Reset();
-    m_dsv.Reset();
+    m_graph.Reset();
+    m_graphPool.clear();
+    m_pipelines.Clear();
+    m_gpuPipelines.clear();
+    m_state.InvalidateAll();
     m_rtv.Reset();
     m_swapChain.Reset();
     m_context.Reset();
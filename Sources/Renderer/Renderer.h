@@ -1,35 +1,83 @@
 #pragma once
 #include <wrl/client.h>
 #include <d3d11.h>
+#include <d3dcommon.h>
 #include <DirectXMath.h>
 #include <string_view>
 #include "MeshStorage.h"
+#include "RenderQueue.h"
+#include "Camera.h"
+#include "RenderBackend.h"
+#include "ShaderCache.h"
+#include "D3DShaderCompiler.h"
+#include "Memory/LinearAllocator.h"
+#include "Math/SimdMath.h"
+#include "UploadQueue.h"
+#include "PipelineState.h"
 #include <unordered_map>
-class RenderQueue;
+#include <vector>
+class JobSystem;
 struct Transform;
+
+// Where one LOD lives inside GpuMesh::ib.
+struct GpuLodRange {
+    UINT firstIndex = 0;
+    UINT indexCount = 0;
+};
+
 struct GpuMesh {
     Microsoft::WRL::ComPtr<ID3D11Buffer> vb;
-    Microsoft::WRL::ComPtr<ID3D11Buffer> ib;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> ib; // all LODs, one after another
     UINT indexCount = 0;
+    std::vector<GpuLodRange> lods;           // lods[0] = full detail
+
+    VertexFormat format = VertexFormat::Float3;
+    UINT stride = 0;
+    DirectX::XMFLOAT3 positionScale{ 1.0f, 1.0f, 1.0f };
+    DirectX::XMFLOAT3 positionOffset{ 0.0f, 0.0f, 0.0f };
 };
-class Renderer {
+// The D3D11 backend. Mesh buffers are created by its UploadQueue, ahead
+// of their first draw and within a per-frame budget, not in DrawMesh.
+// The frame is a RenderGraph: the depth buffer is one of its transient
+// textures, kept in a pool and reused from frame to frame. Draws bind
+// cached pipelines through a StateTracker, which drops redundant binds.
+class Renderer : public RenderBackend, private IUploadTarget, private IRenderGraphTarget {
 public:
     Renderer() = default;
-    ~Renderer();
+    ~Renderer() override;
 
     bool Init(HWND hwnd, uint32_t width, uint32_t height);
-    GpuMesh& GetOrCreateGpuMesh(MeshHandle handle);
-    GpuMesh CreateGpuMesh(const MeshData& cpu);
-    void Resize(uint32_t width, uint32_t height);
-
-    void BeginFrame(float r, float g, float b, float a);
-    void Draw(const RenderQueue& queue);
-    void DrawMesh(MeshHandle mesh, DirectX::XMMATRIX world);
-    void EndFrame();
-    void Shutdown();
-    void SetMeshStorage(MeshStorage* storage) {
+    // nullptr until the mesh is uploaded.
+    const GpuMesh* FindGpuMesh(MeshHandle handle) const;
+    void Resize(uint32_t width, uint32_t height) override;
+
+    void BeginFrame(float r, float g, float b, float a) override;
+    void Draw(const RenderQueue& queue) override;
+    // `mvp` is world * view * proj (Draw builds them for the whole queue at once).
+    // `ranges` (optional) limits the draw to parts of LOD 0, e.g. visible meshlets.
+    // `firstVertex`: take the vertices from this frame's stream (skinned meshes,
+    // see RenderQueue::GetVertices) instead of the mesh's own vertex buffer.
+    void DrawMesh(MeshHandle mesh, const DirectX::XMFLOAT4X4& mvp, uint32_t lod = 0,
+                  const IndexRange* ranges = nullptr, uint32_t rangeCount = 0,
+                  uint32_t firstVertex = RenderItem::NoVertices);
+    // `instanceCount` copies of the mesh in one draw, placed by RenderQueue::GetInstances().
+    void DrawInstances(MeshHandle mesh, const DirectX::XMFLOAT4X4& mvp, uint32_t lod,
+                       uint32_t firstInstance, uint32_t instanceCount);
+    void EndFrame() override;
+    void Shutdown() override;
+    const RendererStats& GetStats() const override { return m_stats; }
+    UploadQueue& GetUploads() override { return m_uploads; }
+    const RenderGraph& GetGraph() const override { return m_graph; }
+    void SetMeshStorage(MeshStorage* storage) override {
         m_meshStorage = storage;
     }
+    void SetCamera(const Camera& camera) override {
+        m_camera = camera;
+    }
+    // Call before Init: missing shaders are then compiled in parallel.
+    void SetJobSystem(JobSystem* jobs) {
+        m_shaderCache.SetJobSystem(jobs);
+    }
 private:
     struct Vertex {
         DirectX::XMFLOAT3 pos;
@@ -37,17 +85,42 @@ private:
 
     struct alignas(16) CB_Matrices {
         DirectX::XMFLOAT4X4 mvp;
+        DirectX::XMFLOAT4 positionScale;  // dequantization of compressed positions
+        DirectX::XMFLOAT4 positionOffset;
     };
 
     bool CreateDeviceAndSwapChain(HWND hwnd, uint32_t width, uint32_t height);
     bool CreateRenderTarget();
-    bool CreateDepthBuffer();
     bool CreateShaders();
     bool CreateCube();
     bool CreateConstantBuffer();
     bool CreateRasterizerState();
+    // Copies per-frame data (skinned vertices, instances) into a dynamic
+    // vertex buffer, recreated bigger when it doesn't fit.
+    bool UploadDynamic(Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer, UINT& capacity,
+                       const void* data, size_t bytes);
+
+    // IUploadTarget: the staging ring is a dynamic buffer written without
+    // overwriting (the ring keeps in-flight parts apart), and copied into
+    // default-usage vertex/index buffers on the GPU.
+    uint8_t* MapStaging(uint64_t capacity) override;
+    void UnmapStaging() override;
+    bool CreateMesh(MeshHandle handle, const MeshData& mesh, uint64_t vertexOffset, uint64_t indexOffset) override;
+
+    // IRenderGraphTarget: physical resources are textures (with the views
+    // their format allows) or buffers in m_graphPool. D3D11 tracks hazards
+    // itself, so a barrier only unbinds what the next pass will read or write.
+    bool PreparePhysical(uint32_t index, const GraphResourceDesc& desc) override;
+    void Barrier(const GraphBarrier& barrier, uint32_t physical) override;
+
+    // Finds or builds the pipeline for `desc` and binds the parts of it that changed.
+    void BindPipeline(const PipelineDesc& desc);
+
+    // The scene pass: the items of `queue`, with the matrices Draw built.
+    void DrawItems(const RenderQueue& queue);
+    // Compiles and runs the frame's graph, once.
+    void RunGraph();
 
-    
 
 private:
     uint32_t m_width = 0;
@@ -58,21 +131,74 @@ private:
     Microsoft::WRL::ComPtr<IDXGISwapChain> m_swapChain;
 
     Microsoft::WRL::ComPtr<ID3D11RenderTargetView> m_rtv;
-    Microsoft::WRL::ComPtr<ID3D11DepthStencilView> m_dsv;
+
+    // One per physical resource of the graph; recreated only when its desc changes.
+    struct GraphTexture {
+        GraphResourceDesc desc;
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+        Microsoft::WRL::ComPtr<ID3D11RenderTargetView> rtv;
+        Microsoft::WRL::ComPtr<ID3D11DepthStencilView> dsv;
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+    };
+    RenderGraph m_graph;
+    std::vector<GraphTexture> m_graphPool;
+    GraphResource m_backBuffer = InvalidGraphResource;
+    GraphResource m_depth = InvalidGraphResource;
+    float m_clearColor[4] = {};
+    // Set by Draw for the scene pass.
+    const Simd::Mat4* m_frameMvps = nullptr;
+    bool m_frameVerticesReady = false;
+    bool m_frameInstancesReady = false;
 
     Microsoft::WRL::ComPtr<ID3D11VertexShader> m_vs;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> m_vsPacked;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> m_vsInstanced;
     Microsoft::WRL::ComPtr<ID3D11PixelShader> m_ps;
-    Microsoft::WRL::ComPtr<ID3D11InputLayout> m_inputLayout;
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> m_inputLayout;          // VertexFormat::Float3
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> m_inputLayoutQuantized; // VertexFormat::Quantized
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> m_inputLayoutPacked;    // VertexFormat::Packed
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> m_inputLayoutInstanced;      // Float3 + RenderInstance
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> m_inputLayoutInstancedUnorm; // Quantized / Packed + RenderInstance
 
     Microsoft::WRL::ComPtr<ID3D11Buffer> m_vertexBuffer;
     Microsoft::WRL::ComPtr<ID3D11Buffer> m_indexBuffer;
     Microsoft::WRL::ComPtr<ID3D11Buffer> m_cbMatrices;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_frameVertices;  // dynamic, rewritten every frame
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_frameInstances; // dynamic, rewritten every frame
+    UINT m_frameVertexBytes = 0;                           // their sizes
+    UINT m_frameInstanceBytes = 0;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_staging;        // UploadQueue's ring
+    uint64_t m_stagingBytes = 0;
+    bool m_stagingFresh = false;                           // not mapped since it was created
     
 
     std::unordered_map<MeshHandle, GpuMesh> m_gpuMeshes;
     MeshStorage* m_meshStorage = nullptr; // injected
+    UploadQueue m_uploads{ *this };
+    Camera m_camera;
+    RendererStats m_stats;
+
+    D3DShaderCompiler m_shaderCompiler;
+    ShaderCache m_shaderCache{ m_shaderCompiler }; // after m_shaderCompiler, it keeps a reference
 
     Microsoft::WRL::ComPtr<ID3D11RasterizerState> m_rasterState;
 
+    // A pipeline as the D3D11 objects above, indexed by PipelineHandle - 1.
+    struct GpuPipeline {
+        ID3D11InputLayout* layout = nullptr;
+        ID3D11VertexShader* vs = nullptr;
+        ID3D11PixelShader* ps = nullptr;
+        D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        ID3D11RasterizerState* raster = nullptr;
+    };
+    PipelineCache m_pipelines;
+    std::vector<GpuPipeline> m_gpuPipelines;
+    StateTracker m_state;
+
+    // Temporary CPU data while building GPU resources, and the frame's
+    // world * view * proj matrices; emptied every BeginFrame.
+    LinearAllocator m_scratch{ 1 << 20, AllocTag::Render };
+
     UINT m_indexCount = 0;
 };
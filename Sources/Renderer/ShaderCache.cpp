@@ -0,0 +1,239 @@
+#include "ShaderCache.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+#include "Profiling/Profiler.h"
+#include "Memory/AllocTracker.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <unordered_set>
+
+namespace {
+
+    // FNV-1a, 64 bit. Not cryptographic, but for "did anything change"
+    // a collision is astronomically unlikely and it is tiny and portable.
+    constexpr uint64_t FnvOffset = 1469598103934665603ull;
+    constexpr uint64_t FnvPrime = 1099511628211ull;
+
+    void HashBytes(uint64_t& h, const void* data, size_t size) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            h ^= p[i];
+            h *= FnvPrime;
+        }
+    }
+
+    // Strings are hashed with their length, so "ab"+"c" != "a"+"bc".
+    void HashString(uint64_t& h, const std::string& s) {
+        uint64_t n = s.size();
+        HashBytes(h, &n, sizeof(n));
+        HashBytes(h, s.data(), s.size());
+    }
+
+    bool ReadFile(const std::string& path, std::string& out) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return false;
+        out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // Collects the names of every `#include "x"` / `#include <x>` in `source`.
+    // Simple on purpose: an include inside an #if block or a block comment is
+    // still followed. That can only make the key depend on one file too many.
+    void FindIncludes(const std::string& source, std::vector<std::string>& names) {
+        size_t pos = 0;
+        while (pos < source.size()) {
+            size_t end = source.find('\n', pos);
+            if (end == std::string::npos) end = source.size();
+
+            size_t i = pos;
+            auto skipSpaces = [&]() { while (i < end && (source[i] == ' ' || source[i] == '\t')) ++i; };
+
+            skipSpaces();
+            if (i < end && source[i] == '#') {
+                ++i;
+                skipSpaces();
+                if (source.compare(i, 7, "include") == 0) {
+                    i += 7;
+                    skipSpaces();
+                    if (i < end && (source[i] == '"' || source[i] == '<')) {
+                        char close = source[i] == '"' ? '"' : '>';
+                        size_t nameEnd = source.find(close, i + 1);
+                        if (nameEnd != std::string::npos && nameEnd < end)
+                            names.push_back(source.substr(i + 1, nameEnd - i - 1));
+                    }
+                }
+            }
+            pos = end + 1;
+        }
+    }
+
+    // Hashes `path` and, recursively, everything it includes.
+    // Includes resolve relative to the including file, like D3D_COMPILE_STANDARD_FILE_INCLUDE.
+    void HashSourceTree(uint64_t& h, const std::filesystem::path& path, std::unordered_set<std::string>& visited) {
+        std::string key = path.lexically_normal().generic_string();
+        if (!visited.insert(key).second)
+            return; // already hashed (or an include cycle)
+
+        HashString(h, key);
+
+        std::string source;
+        if (!ReadFile(key, source)) {
+            // Hash "missing" too: once the file appears the key changes.
+            HashString(h, "<missing>");
+            return;
+        }
+        HashString(h, source);
+
+        std::vector<std::string> includes;
+        FindIncludes(source, includes);
+        for (const std::string& name : includes)
+            HashSourceTree(h, path.parent_path() / name, visited);
+    }
+
+    // Header in front of every blob on disk.
+    // `key` is checked on load, so a renamed or truncated file is never used.
+    struct BlobHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint64_t size;
+    };
+    constexpr uint32_t BlobMagic = 0x43485344; // "DSHC"
+    constexpr uint32_t BlobVersion = 1;
+}
+
+uint64_t ShaderCache::ComputeKey(const ShaderDesc& desc) const
+{
+    uint64_t h = FnvOffset;
+    HashString(h, m_compiler.Identity());
+    HashString(h, desc.entry);
+    HashString(h, desc.profile);
+
+    uint64_t defineCount = desc.defines.size();
+    HashBytes(h, &defineCount, sizeof(defineCount));
+    for (const ShaderDefine& d : desc.defines) {
+        HashString(h, d.name);
+        HashString(h, d.value);
+    }
+
+    std::unordered_set<std::string> visited;
+    HashSourceTree(h, std::filesystem::path(desc.file), visited);
+    return h;
+}
+
+std::string ShaderCache::BlobPath(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return m_directory + "/" + name;
+}
+
+bool ShaderCache::TryMap(uint64_t key, ShaderBytecode& out) const
+{
+    MappedFile file;
+    if (!file.Open(BlobPath(key)))
+        return false;
+
+    if (file.Size() <= sizeof(BlobHeader))
+        return false;
+
+    BlobHeader header;
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (header.magic != BlobMagic || header.version != BlobVersion || header.key != key ||
+        header.size != file.Size() - sizeof(BlobHeader))
+        return false;
+
+    out.m_file = std::move(file);
+    out.m_offset = sizeof(BlobHeader);
+    out.m_owned.clear();
+    return true;
+}
+
+void ShaderCache::Store(uint64_t key, const std::vector<uint8_t>& bytecode) const
+{
+    // Written next to the final name and renamed at the end, so a crash or
+    // a second instance of the game never sees half a file.
+    std::string path = BlobPath(key);
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream f(temp, std::ios::binary | std::ios::trunc);
+        if (!f) return;
+
+        BlobHeader header{ BlobMagic, BlobVersion, key, bytecode.size() };
+        f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        f.write(reinterpret_cast<const char*>(bytecode.data()), std::streamsize(bytecode.size()));
+        if (!f) return;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec)
+        std::filesystem::remove(temp, ec);
+}
+
+bool ShaderCache::Load(const std::vector<ShaderDesc>& descs, std::vector<ShaderBytecode>& out)
+{
+    PROFILE_SCOPE("ShaderCache::Load");
+    AllocScope allocScope(AllocTag::Assets);
+    double start = Clock::Now();
+
+    m_stats = {};
+    m_errors.clear();
+    m_stats.requested = uint32_t(descs.size());
+
+    out.clear();
+    out.resize(descs.size());
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+
+    // 1) Keys + whatever is already on disk.
+    std::vector<uint64_t> keys(descs.size());
+    std::vector<uint32_t> missing;
+    for (uint32_t i = 0; i < descs.size(); ++i) {
+        keys[i] = ComputeKey(descs[i]);
+        if (TryMap(keys[i], out[i]))
+            ++m_stats.hits;
+        else
+            missing.push_back(i);
+    }
+
+    // 2) Compile the rest, all at once. Each job touches only its own slot.
+    std::vector<std::string> errors(missing.size());
+    std::vector<uint8_t> ok(missing.size(), 0);
+
+    auto compile = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t m = begin; m < end; ++m) {
+            uint32_t i = missing[m];
+            PROFILE_SCOPE("CompileShader");
+            ShaderBytecode& bc = out[i];
+            if (!m_compiler.Compile(descs[i], bc.m_owned, errors[m]))
+                continue;
+            Store(keys[i], bc.m_owned);
+            ok[m] = 1;
+        }
+    };
+
+    if (m_jobs)
+        m_jobs->ParallelFor(uint32_t(missing.size()), 1, compile);
+    else
+        compile(0, uint32_t(missing.size()));
+
+    for (size_t m = 0; m < missing.size(); ++m) {
+        if (ok[m]) {
+            ++m_stats.compiled;
+        }
+        else {
+            ++m_stats.failed;
+            m_errors += errors[m];
+            m_errors += '\n';
+        }
+    }
+
+    m_stats.milliseconds = Clock::MillisecondsSince(start);
+    return m_stats.failed == 0;
+}
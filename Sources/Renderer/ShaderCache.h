@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ShaderCompiler.h"
+#include "Platform/MappedFile.h"
+
+class JobSystem;
+
+/*
+ * ShaderCache
+ * Compiling HLSL is slow, and the result only changes when the input does.
+ * So every compiled shader is saved to disk under a key that covers
+ * everything that goes into the compiler:
+ *
+ *     compiler identity + file + every #include it pulls in
+ *     + defines + entry point + profile
+ *
+ * Next launch, the same key means the same bytes: the blob is mapped from
+ * disk (MappedFile) and handed to D3D without compiling anything.
+ * Editing a shader or one of its includes changes the key, so stale blobs
+ * are simply never asked for again.
+ *
+ * Shaders that are missing are compiled together on the JobSystem.
+ */
+
+// Bytecode of one shader: a view into a mapped cache file, or freshly
+// compiled bytes. Valid as long as the object lives.
+class ShaderBytecode {
+public:
+    const void* Data() const { return m_file.IsOpen() ? m_file.Data() + m_offset : m_owned.data(); }
+    size_t Size() const { return m_file.IsOpen() ? m_file.Size() - m_offset : m_owned.size(); }
+    bool Empty() const { return Size() == 0; }
+    bool FromCache() const { return m_file.IsOpen(); }
+
+private:
+    friend class ShaderCache;
+    MappedFile m_file;
+    size_t m_offset = 0;
+    std::vector<uint8_t> m_owned;
+};
+
+struct ShaderCacheStats {
+    uint32_t requested = 0;
+    uint32_t hits = 0;      // mapped from disk
+    uint32_t compiled = 0;  // missing or stale, compiled this time
+    uint32_t failed = 0;
+    double milliseconds = 0.0; // whole Load() call
+};
+
+class ShaderCache {
+public:
+    explicit ShaderCache(IShaderCompiler& compiler, std::string directory = "ShaderCache")
+        : m_compiler(compiler), m_directory(std::move(directory)) {}
+
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+
+    // out[i] receives the bytecode of descs[i].
+    // Returns false if any shader failed to compile, see GetErrors().
+    bool Load(const std::vector<ShaderDesc>& descs, std::vector<ShaderBytecode>& out);
+
+    // The cache key of one desc. Reads the shader file and its includes.
+    uint64_t ComputeKey(const ShaderDesc& desc) const;
+
+    const ShaderCacheStats& GetStats() const { return m_stats; }
+    const std::string& GetErrors() const { return m_errors; }
+
+private:
+    std::string BlobPath(uint64_t key) const;
+    bool TryMap(uint64_t key, ShaderBytecode& out) const;
+    void Store(uint64_t key, const std::vector<uint8_t>& bytecode) const;
+
+private:
+    IShaderCompiler& m_compiler;
+    std::string m_directory;
+    JobSystem* m_jobs = nullptr; // injected, optional
+    ShaderCacheStats m_stats;
+    std::string m_errors;
+};
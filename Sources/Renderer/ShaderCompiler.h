@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One #define passed to the compiler, e.g. { "SKINNED", "1" }.
+struct ShaderDefine {
+    std::string name;
+    std::string value;
+};
+
+// Everything that decides what bytecode comes out of the compiler.
+// Two descs that are equal (and whose files are unchanged) give the same blob.
+struct ShaderDesc {
+    std::string file;     // path to the .hlsl, relative to the working directory
+    std::string entry;    // e.g. "VSMain"
+    std::string profile;  // e.g. "vs_5_0"
+    std::vector<ShaderDefine> defines;
+};
+
+/*
+ * IShaderCompiler
+ * Turns a ShaderDesc into bytecode. The ShaderCache only talks to this
+ * interface, so the cache itself has no D3D code in it and can run
+ * (and be checked) on any platform with a stand-in compiler, like the
+ * one in Tests/ShaderCacheTests.cpp.
+ *
+ * Compile() is called from worker threads, one desc per call,
+ * so implementations must be thread-safe.
+ */
+class IShaderCompiler {
+public:
+    virtual ~IShaderCompiler() = default;
+
+    // Changes whenever the same source would compile to different bytes
+    // (compiler version, flags). Part of every cache key.
+    virtual std::string Identity() const = 0;
+
+    virtual bool Compile(const ShaderDesc& desc, std::vector<uint8_t>& bytecode, std::string& errors) = 0;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <cmath>
 #include "MeshData.h"
 
 inline MeshData CreateTestCube()
@@ -29,3 +30,82 @@ inline MeshData CreateTestCube()
 
     return mesh;
 }
+
+// UV sphere, radius 1. More segments / rings = more triangles:
+// (segments * rings * 2) minus the degenerate ones at the poles.
+inline MeshData CreateTestSphere(uint32_t segments, uint32_t rings)
+{
+    MeshData mesh;
+    if (segments < 3) segments = 3;
+    if (rings < 2) rings = 2;
+
+    const float pi = 3.14159265f;
+    for (uint32_t r = 0; r <= rings; ++r) {
+        const float v = float(r) / float(rings) * pi; // 0 = top, pi = bottom
+        for (uint32_t s = 0; s <= segments; ++s) {
+            // The last column repeats the first exactly, so the UV seam is a
+            // seam (same positions) and not a crack the simplifier could open.
+            const float u = float(s % segments) / float(segments) * 2.0f * pi;
+            mesh.positions.push_back({ std::sin(v) * std::cos(u), std::cos(v), std::sin(v) * std::sin(u) });
+        }
+    }
+
+    const uint32_t row = segments + 1;
+    for (uint32_t r = 0; r < rings; ++r) {
+        for (uint32_t s = 0; s < segments; ++s) {
+            const uint32_t a = r * row + s;
+            const uint32_t b = a + row;
+            if (r != 0)
+                mesh.indices.insert(mesh.indices.end(), { a, a + 1, b });
+            if (r != rings - 1)
+                mesh.indices.insert(mesh.indices.end(), { a + 1, b + 1, b });
+        }
+    }
+    return mesh;
+}
+
+// Skinned tube along +Y from 0 to `height`, bound to a chain of `joints`
+// joints spaced evenly along it (see Animation/TestRig.h). Each ring of
+// vertices follows the two nearest joints, so the tube bends smoothly.
+inline MeshData CreateTestTube(uint32_t segments, uint32_t rings, float height, float radius, uint32_t joints)
+{
+    MeshData mesh;
+    if (segments < 3) segments = 3;
+    if (rings < 1) rings = 1;
+    if (joints < 1) joints = 1;
+    if (joints > 256) joints = 256;
+
+    const float pi = 3.14159265f;
+    const float spacing = height / float(joints);
+    for (uint32_t r = 0; r <= rings; ++r) {
+        const float y = float(r) / float(rings) * height;
+
+        // Joint j sits at y = j * spacing; blend between the one below and the one above.
+        const float f = y / spacing;
+        uint32_t j0 = uint32_t(f);
+        if (j0 > joints - 1) j0 = joints - 1;
+        const uint32_t j1 = j0 + 1 < joints ? j0 + 1 : j0;
+        float w1 = j1 == j0 ? 0.0f : f - float(j0);
+        w1 = w1 * w1 * (3.0f - 2.0f * w1); // smoothstep: no kink at the joints
+
+        for (uint32_t s = 0; s <= segments; ++s) {
+            const float u = float(s) / float(segments) * 2.0f * pi;
+            mesh.positions.push_back({ std::cos(u) * radius, y, std::sin(u) * radius });
+            JointIndices ji;
+            ji.joint[0] = uint8_t(j0);
+            ji.joint[1] = uint8_t(j1);
+            mesh.jointIndices.push_back(ji);
+            mesh.jointWeights.push_back({ 1.0f - w1, w1, 0.0f, 0.0f });
+        }
+    }
+
+    const uint32_t row = segments + 1;
+    for (uint32_t r = 0; r < rings; ++r) {
+        for (uint32_t s = 0; s < segments; ++s) {
+            const uint32_t a = r * row + s;
+            const uint32_t b = a + row;
+            mesh.indices.insert(mesh.indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+        }
+    }
+    return mesh;
+}
@@ -0,0 +1,231 @@
+#include "UploadQueue.h"
+#include "MeshStorage.h"
+#include "Timing/Clock.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+    constexpr uint64_t Align16(uint64_t v) { return (v + 15) & ~uint64_t(15); }
+
+} // namespace
+
+// ---- StagingRing ----
+
+void StagingRing::Reset(uint64_t capacity, uint32_t framesInFlight)
+{
+    m_capacity = capacity & ~uint64_t(15);
+    m_head = m_tail = 0;
+    m_frames.clear();
+    m_framesInFlight = std::max(framesInFlight, 1u);
+}
+
+uint64_t StagingRing::Allocate(uint64_t bytes)
+{
+    bytes = Align16(bytes);
+    if (bytes == 0 || bytes > m_capacity)
+        return Full;
+
+    // Nothing in flight: start again at the beginning rather than skip
+    // to it (which could never fit a block bigger than what is left).
+    if (m_head == m_tail) {
+        m_head = m_tail = 0;
+        std::fill(m_frames.begin(), m_frames.end(), 0);
+    }
+
+    // Never split across the end: skip what is left there instead.
+    const uint64_t offset = m_head % m_capacity;
+    const uint64_t skip = offset + bytes > m_capacity ? m_capacity - offset : 0;
+    if (m_head + skip + bytes - m_tail > m_capacity)
+        return Full;
+
+    m_head += skip;
+    const uint64_t result = m_head % m_capacity;
+    m_head += bytes;
+    return result;
+}
+
+void StagingRing::EndFrame()
+{
+    m_frames.push_back(m_head);
+    if (m_frames.size() > m_framesInFlight) {
+        m_tail = m_frames.front();
+        m_frames.erase(m_frames.begin());
+    }
+}
+
+// ---- UploadQueue ----
+
+void UploadQueue::SetSettings(const Settings& settings)
+{
+    m_settings = settings;
+    m_resizeRing = true;
+}
+
+UploadQueue::Entry& UploadQueue::At(MeshHandle handle)
+{
+    if (handle >= m_entries.size())
+        m_entries.resize(size_t(handle) + 1);
+    return m_entries[handle];
+}
+
+void UploadQueue::Enqueue(MeshHandle handle)
+{
+    Entry& e = At(handle);
+    if (e.queued)
+        return;
+    e.queued = true;
+    e.order = ++m_order;
+    m_pending.push_back(handle);
+}
+
+void UploadQueue::Invalidate(MeshHandle handle)
+{
+    if (handle != InvalidMesh)
+        Enqueue(handle);
+}
+
+void UploadQueue::Request(MeshHandle handle, float distance)
+{
+    if (handle == InvalidMesh)
+        return;
+    Entry& e = At(handle);
+    e.distance = e.usedFrame == m_frame ? std::min(e.distance, distance) : distance;
+    e.usedFrame = m_frame;
+    if (!e.resident)
+        Enqueue(handle);
+}
+
+uint64_t UploadQueue::UploadBytes(const MeshData& mesh)
+{
+    uint64_t indices = 0;
+    for (uint32_t lod = 0; lod < mesh.LodCount(); ++lod)
+        indices += mesh.LodIndices(lod).size();
+    return mesh.vertexStream.bytes.size() + indices * sizeof(uint32_t);
+}
+
+UploadQueue::Result UploadQueue::Upload(MeshHandle handle, const MeshData& mesh, uint64_t bytes)
+{
+    const uint64_t vertexBytes = mesh.vertexStream.bytes.size();
+    const uint64_t offset = m_ring.Allocate(Align16(vertexBytes) + (bytes - vertexBytes));
+    if (offset == StagingRing::Full)
+        return Result::RingFull;
+
+    uint8_t* ring = m_target.MapStaging(m_ring.Capacity());
+    if (!ring)
+        return Result::Failed;
+    std::memcpy(ring + offset, mesh.vertexStream.bytes.data(), vertexBytes);
+    const uint64_t indexOffset = offset + Align16(vertexBytes);
+    uint8_t* out = ring + indexOffset;
+    for (uint32_t lod = 0; lod < mesh.LodCount(); ++lod) {
+        const auto& indices = mesh.LodIndices(lod);
+        std::memcpy(out, indices.data(), indices.size() * sizeof(uint32_t));
+        out += indices.size() * sizeof(uint32_t);
+    }
+    m_target.UnmapStaging();
+    return m_target.CreateMesh(handle, mesh, offset, indexOffset) ? Result::Done : Result::Failed;
+}
+
+void UploadQueue::Update(const MeshStorage& meshes)
+{
+    const Clock::Ticks start = Clock::NowTicks();
+    m_stats.bytes = 0;
+    m_stats.meshes = 0;
+    m_uploaded.clear();
+
+    // New meshes: uploaded ahead of their first draw, oldest first.
+    for (; m_known < meshes.Count(); ++m_known) {
+        const MeshHandle handle = static_cast<MeshHandle>(m_known + 1);
+        if (!IsResident(handle))
+            Enqueue(handle);
+    }
+
+    if (m_ring.Capacity() == 0 || (m_resizeRing && m_ring.Idle())) {
+        m_ring.Reset(std::max<uint64_t>(m_settings.stagingBytes, 16), m_settings.framesInFlight);
+        m_resizeRing = false;
+    }
+
+    // Drawn this frame (nearest first), then drawn before (most recent
+    // first), then never drawn (oldest request first).
+    std::sort(m_pending.begin(), m_pending.end(), [this](MeshHandle a, MeshHandle b) {
+        const Entry& ea = m_entries[a];
+        const Entry& eb = m_entries[b];
+        if (ea.usedFrame != eb.usedFrame) return ea.usedFrame > eb.usedFrame;
+        if (ea.usedFrame != 0 && ea.distance != eb.distance) return ea.distance < eb.distance;
+        return ea.order < eb.order;
+    });
+
+    size_t done = 0;
+    for (; done < m_pending.size(); ++done) {
+        const MeshHandle handle = m_pending[done];
+        const MeshData* mesh = meshes.Get(handle);
+        Entry& e = m_entries[handle];
+        if (!mesh || mesh->vertexStream.bytes.empty() || mesh->indices.empty()) {
+            e.queued = false; // nothing to upload, and nothing to draw
+            continue;
+        }
+
+        // The budget; the first mesh of the frame always goes.
+        const uint64_t bytes = UploadBytes(*mesh);
+        if (m_stats.meshes > 0) {
+            if (m_settings.bytesPerFrame && m_stats.bytes + bytes > m_settings.bytesPerFrame)
+                break;
+            if (m_settings.msPerFrame > 0.0 && Clock::ToMilliseconds(Clock::NowTicks() - start) >= m_settings.msPerFrame)
+                break;
+        }
+
+        // Bigger than the ring: wait until nothing is in flight, then grow it.
+        if (Align16(bytes) + 16 > m_ring.Capacity()) {
+            if (!m_ring.Idle())
+                break;
+            uint64_t capacity = m_ring.Capacity();
+            while (capacity < Align16(bytes) + 16)
+                capacity *= 2;
+            m_ring.Reset(capacity, m_settings.framesInFlight);
+            ++m_stats.ringGrowths;
+        }
+
+        const Result result = Upload(handle, *mesh, bytes);
+        if (result == Result::RingFull) {
+            ++m_stats.ringFull;
+            break;
+        }
+        e.queued = false;
+        if (result == Result::Failed) {
+            ++m_stats.failed; // not retried: Invalidate to try again
+            continue;
+        }
+        e.resident = true;
+        m_uploaded.push_back(handle);
+        m_stats.bytes += bytes;
+        ++m_stats.meshes;
+    }
+
+    // Keep what is still waiting; the order is redone next frame anyway.
+    m_pending.erase(m_pending.begin(), m_pending.begin() + done);
+
+    m_ring.EndFrame();
+    ++m_frame;
+
+    m_stats.pending = static_cast<uint32_t>(m_pending.size());
+    m_stats.pendingBytes = 0;
+    for (MeshHandle handle : m_pending)
+        if (const MeshData* mesh = meshes.Get(handle))
+            m_stats.pendingBytes += UploadBytes(*mesh);
+    m_stats.stagingUsed = m_ring.Used();
+    m_stats.totalBytes += m_stats.bytes;
+    m_stats.totalMeshes += m_stats.meshes;
+    m_stats.milliseconds = Clock::ToMilliseconds(Clock::NowTicks() - start);
+}
+
+void UploadQueue::Clear()
+{
+    m_entries.clear();
+    m_pending.clear();
+    m_uploaded.clear();
+    m_known = 0;
+    m_resizeRing = true;
+    m_ring.Reset(0, m_settings.framesInFlight);
+    m_stats = {};
+}
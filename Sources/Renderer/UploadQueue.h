@@ -0,0 +1,171 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MeshHandle.h"
+
+class MeshStorage;
+struct MeshData;
+
+/*
+ * IUploadTarget
+ * The GPU side of mesh uploads. UploadQueue decides what goes up when and
+ * where in the staging ring it is copied; the backend only provides the
+ * ring's memory and turns staged bytes into buffers. Renderer does this
+ * with a dynamic D3D11 buffer and CopySubresourceRegion, NullRenderer with
+ * a plain array, so the scheduling runs (and is checked) without a GPU.
+ */
+class IUploadTarget {
+public:
+    virtual ~IUploadTarget() = default;
+
+    // The staging ring, `capacity` bytes, writable until UnmapStaging.
+    // A new capacity means a new ring; the old one is no longer in use then.
+    virtual uint8_t* MapStaging(uint64_t capacity) = 0;
+    virtual void UnmapStaging() = 0;
+
+    // Buffers for `mesh` from its staged copy: the vertex stream at
+    // vertexOffset, every LOD's indices back to back at indexOffset.
+    // Replaces the buffers of an earlier upload of the same handle.
+    virtual bool CreateMesh(MeshHandle handle, const MeshData& mesh, uint64_t vertexOffset, uint64_t indexOffset) = 0;
+};
+
+/*
+ * StagingRing
+ * Where uploads are copied before the GPU takes them. Allocations go round
+ * a fixed block of memory; the space of one frame is handed out again only
+ * `framesInFlight` frames later, when the GPU is surely done reading it.
+ * So staging memory is allocated once, not per mesh.
+ */
+class StagingRing {
+public:
+    static constexpr uint64_t Full = ~0ull;
+
+    void Reset(uint64_t capacity, uint32_t framesInFlight);
+
+    // Offset of `bytes` contiguous bytes (16-byte aligned), or Full if the
+    // frames still in flight hold too much of the ring.
+    uint64_t Allocate(uint64_t bytes);
+
+    // Closes this frame's allocations.
+    void EndFrame();
+
+    uint64_t Capacity() const { return m_capacity; }
+    uint64_t Used() const { return m_head - m_tail; } // by frames in flight, and this one
+    bool Idle() const { return m_head == m_tail; }
+
+private:
+    uint64_t m_capacity = 0;
+    uint64_t m_head = 0;            // everything ever allocated, in bytes
+    uint64_t m_tail = 0;            // everything released
+    std::vector<uint64_t> m_frames; // m_head at the end of the last frames, oldest first
+    uint32_t m_framesInFlight = 1;
+};
+
+struct UploadStats {
+    // The last Update
+    uint64_t bytes = 0;         // vertex + index bytes uploaded
+    uint32_t meshes = 0;
+    double milliseconds = 0.0;
+    uint32_t pending = 0;       // queue depth after the update
+    uint64_t pendingBytes = 0;
+    uint64_t stagingUsed = 0;   // ring bytes held by frames in flight
+
+    // Since the start
+    uint64_t totalBytes = 0;
+    uint32_t totalMeshes = 0;
+    uint32_t ringFull = 0;      // updates that stopped because the ring was full
+    uint32_t ringGrowths = 0;   // a mesh bigger than the ring: it grew once idle
+    uint32_t failed = 0;        // the backend couldn't create the buffers
+};
+
+/*
+ * UploadQueue
+ * Creating a mesh's GPU buffers the first time it is drawn makes every new
+ * mesh a hitch, in the middle of drawing, for as many meshes as came into
+ * view at once. Instead, meshes are queued and uploaded ahead of use, a
+ * little every frame:
+ *
+ * - New meshes in MeshStorage are queued by Update on their own (prefetch,
+ *   in the order they were added); Invalidate queues a changed one again.
+ * - Request() is called for every draw, before Update. A mesh that isn't
+ *   resident after Update is skipped this frame (the backend counts it in
+ *   RendererStats::notReady).
+ * - Update() uploads in priority order until the frame's byte or time
+ *   budget is spent: meshes used this frame first, nearest first, then
+ *   the ones used recently, then prefetched ones. The first mesh of a
+ *   frame always goes, however big, so the queue never gets stuck.
+ * - Each upload is copied into the StagingRing and the backend creates the
+ *   buffers from there. A changed mesh keeps its old buffers until then.
+ *
+ * Stats tell how much went up and how much is still waiting, per frame.
+ */
+class UploadQueue {
+public:
+    struct Settings {
+        uint64_t bytesPerFrame = 4ull << 20; // 0 = no limit
+        double msPerFrame = 2.0;             // 0 = no limit
+        uint64_t stagingBytes = 16ull << 20; // the ring; grows for a mesh that doesn't fit
+        uint32_t framesInFlight = 3;         // before a frame's staging space is reused
+    };
+
+    explicit UploadQueue(IUploadTarget& target) : m_target(target) {}
+
+    void SetSettings(const Settings& settings);
+    const Settings& GetSettings() const { return m_settings; }
+
+    // Upload this mesh again (its data changed); it is drawn with the old
+    // buffers until then.
+    void Invalidate(MeshHandle handle);
+
+    // This frame draws `handle`, `distance` away from the camera (anything
+    // that grows with distance will do; the backends pass it squared).
+    // Queues it ahead of everything else if it isn't resident.
+    void Request(MeshHandle handle, float distance);
+
+    // Queues new meshes, then uploads within the budget. Once per frame,
+    // after the Request() calls of the frame.
+    void Update(const MeshStorage& meshes);
+
+    bool IsResident(MeshHandle handle) const {
+        return handle < m_entries.size() && m_entries[handle].resident;
+    }
+
+    // Forgets every upload (the backend dropped its buffers).
+    void Clear();
+
+    const UploadStats& GetStats() const { return m_stats; }
+    const StagingRing& GetRing() const { return m_ring; }
+
+    // Handles uploaded by the last Update, in order.
+    const std::vector<MeshHandle>& GetUploaded() const { return m_uploaded; }
+
+private:
+    struct Entry {
+        bool resident = false;
+        bool queued = false;
+        uint64_t usedFrame = 0;      // last frame it was requested, 0 = never
+        float distance = 0.0f;       // at that frame
+        uint64_t order = 0;          // when it was queued
+    };
+
+    Entry& At(MeshHandle handle);
+    void Enqueue(MeshHandle handle);
+    enum class Result { Done, RingFull, Failed };
+
+    static uint64_t UploadBytes(const MeshData& mesh);
+    Result Upload(MeshHandle handle, const MeshData& mesh, uint64_t bytes);
+
+private:
+    IUploadTarget& m_target;
+    Settings m_settings;
+    StagingRing m_ring;
+    std::vector<Entry> m_entries;       // by MeshHandle
+    std::vector<MeshHandle> m_pending;  // queued, in no particular order
+    std::vector<MeshHandle> m_uploaded;
+    bool m_resizeRing = true;           // settings changed: new ring once idle
+    size_t m_known = 0;                 // meshes in MeshStorage seen so far
+    uint64_t m_frame = 1;
+    uint64_t m_order = 0;
+    UploadStats m_stats;
+};
@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+/*
+ * Vertex formats the renderer understands.
+ *
+ * MeshData keeps full floats (easy to edit, used by CPU systems),
+ * MeshStorage converts them ONCE at import into one of these GPU layouts.
+ *
+ *   Float3     12 bytes  float3 position, no compression
+ *   Quantized   8 bytes  16-bit position, normalized to the mesh bounds
+ *   Packed     20 bytes  16-bit position, octahedral normal + tangent, half UV
+ *
+ * For comparison, float position + normal + tangent + UV is 48 bytes.
+ */
+enum class VertexFormat : uint8_t {
+    Float3,
+    Quantized,
+    Packed,
+};
+
+struct QuantizedVertex {
+    uint16_t position[4]; // UNORM xyz inside the mesh bounds, w unused
+};
+static_assert(sizeof(QuantizedVertex) == 8, "QuantizedVertex must match the input layout");
+
+struct PackedVertex {
+    uint16_t position[4]; // UNORM xyz inside the mesh bounds, w = tangent handedness (0 -> -1, 65535 -> +1)
+    int16_t normal[2];    // SNORM octahedral
+    int16_t tangent[2];   // SNORM octahedral
+    uint16_t uv[2];       // half floats
+};
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex must match the input layout");
+
+// What the conversion saved, per mesh.
+// Bandwidth follows memory: every draw fetches stride * vertices bytes.
+struct VertexStreamStats {
+    uint32_t vertexCount = 0;
+    uint32_t rawStride = 0;    // float32 layout with the same attributes
+    uint32_t packedStride = 0; // what we actually upload
+
+    size_t RawBytes() const { return size_t(rawStride) * vertexCount; }
+    size_t PackedBytes() const { return size_t(packedStride) * vertexCount; }
+    float Savings() const { return rawStride ? 1.0f - float(packedStride) / float(rawStride) : 0.0f; }
+};
+
+// GPU-ready vertex data of one mesh.
+struct VertexStream {
+    VertexFormat format = VertexFormat::Float3;
+    uint32_t stride = 0;
+    std::vector<uint8_t> bytes;
+
+    // Dequantization: position = offset + unorm * scale (identity for Float3).
+    DirectX::XMFLOAT3 positionScale{ 1.0f, 1.0f, 1.0f };
+    DirectX::XMFLOAT3 positionOffset{ 0.0f, 0.0f, 0.0f };
+
+    VertexStreamStats stats;
+};
+
+
+namespace VertexPacking {
+
+    inline uint16_t QuantizeUnorm16(float v, float offset, float scale) {
+        if (scale <= 0.0f) return 0;
+        float t = std::clamp((v - offset) / scale, 0.0f, 1.0f);
+        return static_cast<uint16_t>(t * 65535.0f + 0.5f);
+    }
+
+    inline int16_t QuantizeSnorm16(float v) {
+        v = std::clamp(v, -1.0f, 1.0f);
+        return static_cast<int16_t>(std::lround(v * 32767.0f));
+    }
+
+    // Octahedral encoding: fold the unit sphere onto a square.
+    // Two numbers instead of three, with almost uniform precision.
+    inline void EncodeOctahedral(const DirectX::XMFLOAT3& n, int16_t out[2]) {
+        float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+        if (l1 <= 0.0f) { out[0] = 0; out[1] = 0; return; }
+
+        float x = n.x / l1;
+        float y = n.y / l1;
+        if (n.z < 0.0f) {
+            float fx = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float fy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = fx;
+            y = fy;
+        }
+        out[0] = QuantizeSnorm16(x);
+        out[1] = QuantizeSnorm16(y);
+    }
+
+    // What the input assembler and Simple.hlsl do with the packed values;
+    // the CPU copies exist so the round trip can be checked.
+    inline float DequantizeUnorm16(uint16_t v, float offset, float scale) {
+        return offset + float(v) / 65535.0f * scale;
+    }
+
+    inline DirectX::XMFLOAT3 DecodeOctahedral(const int16_t in[2]) {
+        const float ex = std::max(float(in[0]) / 32767.0f, -1.0f);
+        const float ey = std::max(float(in[1]) / 32767.0f, -1.0f);
+        float x = ex, y = ey;
+        const float z = 1.0f - std::fabs(ex) - std::fabs(ey);
+        const float t = std::clamp(-z, 0.0f, 1.0f);
+        x += x >= 0.0f ? -t : t;
+        y += y >= 0.0f ? -t : t;
+        const float len = std::sqrt(x * x + y * y + z * z);
+        if (len <= 0.0f) return { 0.0f, 0.0f, 1.0f };
+        return { x / len, y / len, z / len };
+    }
+
+    inline uint32_t RawStride(bool normals, bool tangents, bool uvs) {
+        return 12u + (normals ? 12u : 0u) + (tangents ? 16u : 0u) + (uvs ? 8u : 0u);
+    }
+
+    // Bounds of the positions, scale is never negative.
+    inline void ComputeQuantization(const std::vector<DirectX::XMFLOAT3>& positions,
+                                    DirectX::XMFLOAT3& offset, DirectX::XMFLOAT3& scale) {
+        if (positions.empty()) {
+            offset = { 0, 0, 0 };
+            scale = { 1, 1, 1 };
+            return;
+        }
+        DirectX::XMFLOAT3 mn = positions[0], mx = positions[0];
+        for (const auto& p : positions) {
+            mn = { std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z) };
+            mx = { std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z) };
+        }
+        offset = mn;
+        scale = { mx.x - mn.x, mx.y - mn.y, mx.z - mn.z };
+    }
+
+} // namespace VertexPacking
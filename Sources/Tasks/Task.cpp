@@ -0,0 +1,88 @@
+#include "Task.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+
+namespace {
+
+    constexpr size_t MinBlockSize = 128;
+    constexpr int SizeClassCount = 8; // 128 B .. 16 KB, bigger frames use the heap directly
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        std::mutex mutex;
+        FreeBlock* free = nullptr;
+    };
+
+    struct Pool {
+        SizeClass classes[SizeClassCount];
+        std::atomic<uint64_t> heapAllocations{ 0 };
+        std::atomic<uint64_t> live{ 0 };
+    };
+
+    // Blocks are never returned to the heap, so the pool is simply left alive.
+    Pool& GetPool() {
+        static Pool* pool = new Pool();
+        return *pool;
+    }
+
+    int SizeClassOf(size_t size) {
+        size_t block = MinBlockSize;
+        for (int i = 0; i < SizeClassCount; ++i, block <<= 1)
+            if (size <= block)
+                return i;
+        return -1;
+    }
+
+} // namespace
+
+void* TaskFramePool::Allocate(size_t size)
+{
+    Pool& pool = GetPool();
+    pool.live.fetch_add(1, std::memory_order_relaxed);
+
+    const int c = SizeClassOf(size);
+    if (c >= 0) {
+        SizeClass& sc = pool.classes[c];
+        std::lock_guard<std::mutex> lock(sc.mutex);
+        if (FreeBlock* block = sc.free) {
+            sc.free = block->next;
+            return block;
+        }
+    }
+
+    pool.heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(c >= 0 ? MinBlockSize << c : size);
+}
+
+void TaskFramePool::Free(void* frame, size_t size)
+{
+    Pool& pool = GetPool();
+    pool.live.fetch_sub(1, std::memory_order_relaxed);
+
+    const int c = SizeClassOf(size);
+    if (c < 0) {
+        ::operator delete(frame);
+        return;
+    }
+
+    SizeClass& sc = pool.classes[c];
+    std::lock_guard<std::mutex> lock(sc.mutex);
+    auto* block = static_cast<FreeBlock*>(frame);
+    block->next = sc.free;
+    sc.free = block;
+}
+
+uint64_t TaskFramePool::HeapAllocations()
+{
+    return GetPool().heapAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t TaskFramePool::LiveFrames()
+{
+    return GetPool().live.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,182 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+/*
+ * Task<T>
+ * A C++20 coroutine for work that takes longer than one frame, written as
+ * straight-line code instead of a hand-made state machine:
+ *
+ *     Task<> OpenDoor(Core& core) {
+ *         TaskScheduler& tasks = core.getTasks();
+ *         co_await tasks.Delay(1.0);              // 1 second later
+ *         for (int i = 0; i < 60; ++i) {
+ *             MoveDoor(i);
+ *             co_await tasks.NextFrame();         // one step per frame
+ *         }
+ *     }
+ *
+ *     core.getTasks().Spawn(OpenDoor(core));      // starts it
+ *
+ * The awaitables (NextFrame, Delay, SwitchToWorker, SwitchToMainThread,
+ * AssetLoaded) live in TaskScheduler.h.
+ *
+ * A Task does nothing until it is either spawned (TaskScheduler::Spawn,
+ * runs on its own) or awaited by another task (co_await, which then gets
+ * its co_return value):
+ *
+ *     Task<int> CountEnemies();
+ *     int n = co_await CountEnemies();
+ *
+ * Threads: a task keeps running on whatever thread resumed it last, so after
+ * SwitchToWorker() it stays on a worker until it switches back.
+ *
+ * Exceptions thrown inside a task come out of the co_await that waits for it.
+ * A spawned task has nobody to throw to: its exception is dropped and
+ * counted in TaskStats::failed.
+ *
+ * Coroutine frames are allocated from TaskFramePool, so once the game has
+ * been running for a bit, starting tasks and awaiting does not touch the heap.
+ */
+
+class TaskScheduler;
+
+// Free lists of coroutine frames, by size class (128 bytes .. 16 KB).
+// Frames are never given back to the heap, only to the list of their size,
+// so the pool grows to the most tasks alive at once and then stops allocating.
+// Thread-safe: a frame started on the main thread may finish on a worker.
+class TaskFramePool {
+public:
+    static void* Allocate(size_t size);
+    static void Free(void* frame, size_t size);
+
+    static uint64_t HeapAllocations(); // frames that had to come from the heap, ever
+    static uint64_t LiveFrames();      // frames in use right now
+};
+
+namespace TaskDetail {
+
+    struct PromiseBase;
+
+    // Where a finished task goes next: back into the task that awaited it,
+    // or, for a spawned task, nowhere (the frame is destroyed).
+    std::coroutine_handle<> FinishTask(PromiseBase& promise, std::coroutine_handle<> self) noexcept;
+
+    struct PromiseBase {
+        std::coroutine_handle<> continuation; // the task awaiting this one
+        std::exception_ptr exception;
+
+        // Only set for spawned tasks, see TaskScheduler::Spawn.
+        TaskScheduler* scheduler = nullptr;
+        std::coroutine_handle<> self;
+        PromiseBase* prevSpawned = nullptr;
+        PromiseBase* nextSpawned = nullptr;
+
+        static void* operator new(size_t size) { return TaskFramePool::Allocate(size); }
+        static void operator delete(void* frame, size_t size) { TaskFramePool::Free(frame, size); }
+
+        // Lazy: the body starts when spawned or awaited, not when called.
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            template<typename P>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+                return FinishTask(h.promise(), h);
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    template<typename T>
+    struct Promise : PromiseBase {
+        std::optional<T> value;
+
+        template<typename U>
+        void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+
+        T TakeResult() {
+            if (exception) std::rethrow_exception(exception);
+            return std::move(*value);
+        }
+    };
+
+    template<>
+    struct Promise<void> : PromiseBase {
+        void return_void() {}
+
+        void TakeResult() {
+            if (exception) std::rethrow_exception(exception);
+        }
+    };
+
+} // namespace TaskDetail
+
+template<typename T = void>
+class Task {
+public:
+    struct promise_type : TaskDetail::Promise<T> {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            Destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    ~Task() { Destroy(); }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    bool IsValid() const { return bool(m_handle); }
+    bool IsDone() const { return m_handle && m_handle.done(); }
+
+    // Starts the task and suspends the caller until it finished.
+    // The caller then continues on the thread the task finished on.
+    auto operator co_await() noexcept {
+        struct Awaiter {
+            Handle handle;
+            bool await_ready() noexcept { return !handle || handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                handle.promise().continuation = caller;
+                return handle; // runs the task right away, no trip through a queue
+            }
+            T await_resume() {
+                // A moved-from or default Task has no result to give.
+                if (!handle) throw std::logic_error("co_await on an empty Task");
+                return handle.promise().TakeResult();
+            }
+        };
+        return Awaiter{ m_handle };
+    }
+
+    // Gives up ownership of the frame (used by TaskScheduler::Spawn).
+    Handle Release() { return std::exchange(m_handle, {}); }
+
+private:
+    explicit Task(Handle h) : m_handle(h) {}
+
+    void Destroy() {
+        if (m_handle) {
+            m_handle.destroy();
+            m_handle = {};
+        }
+    }
+
+private:
+    Handle m_handle;
+};
@@ -0,0 +1,197 @@
+#include "TaskScheduler.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+#include "Profiling/Profiler.h"
+
+#include <algorithm>
+
+namespace {
+    // std::push_heap builds a max-heap, this turns it into "earliest first".
+    bool WakesLater(const TaskDetail::WaitNode* a, const TaskDetail::WaitNode* b) {
+        return a->wakeTime > b->wakeTime;
+    }
+}
+
+std::coroutine_handle<> TaskDetail::FinishTask(PromiseBase& promise, std::coroutine_handle<> self) noexcept
+{
+    if (promise.continuation)
+        return promise.continuation;
+
+    // Spawned: nobody is waiting, the task cleans up after itself.
+    if (promise.scheduler)
+        promise.scheduler->Finish(promise);
+    self.destroy();
+    return std::noop_coroutine();
+}
+
+// ---- LoadState ----
+
+void LoadState::MarkLoaded(bool failed)
+{
+    TaskDetail::WaitList waiters;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_loaded.load(std::memory_order_relaxed))
+            return;
+        m_failed = failed;
+        m_loaded.store(true, std::memory_order_release);
+        waiters = m_waiters;
+        m_waiters = {};
+    }
+
+    for (TaskDetail::WaitNode* node = waiters.head; node;) {
+        TaskDetail::WaitNode* next = node->next; // PushMain overwrites it
+        m_scheduler.PushMain(node);
+        node = next;
+    }
+}
+
+bool LoadState::AddWaiter(TaskDetail::WaitNode* node)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_loaded.load(std::memory_order_relaxed))
+        return false;
+    m_waiters.Push(node);
+    return true;
+}
+
+// ---- TaskScheduler ----
+
+TaskScheduler::TaskScheduler()
+    : m_mainThread(std::this_thread::get_id())
+{
+    m_timers.reserve(64);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    Shutdown();
+}
+
+void TaskScheduler::Register(TaskDetail::PromiseBase& promise, std::coroutine_handle<> handle)
+{
+    promise.scheduler = this;
+    promise.self = handle;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    promise.prevSpawned = nullptr;
+    promise.nextSpawned = m_spawned;
+    if (m_spawned) m_spawned->prevSpawned = &promise;
+    m_spawned = &promise;
+    ++m_spawnedCount;
+}
+
+void TaskScheduler::Finish(TaskDetail::PromiseBase& promise)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (promise.prevSpawned) promise.prevSpawned->nextSpawned = promise.nextSpawned;
+    else m_spawned = promise.nextSpawned;
+    if (promise.nextSpawned) promise.nextSpawned->prevSpawned = promise.prevSpawned;
+
+    ++m_finishedCount;
+    if (promise.exception)
+        ++m_failedCount;
+}
+
+void TaskScheduler::PushNextFrame(TaskDetail::WaitNode* node)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_nextFrame.Push(node);
+}
+
+void TaskScheduler::PushTimer(TaskDetail::WaitNode* node, double seconds)
+{
+    node->wakeTime = Clock::Now() + seconds;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_timers.push_back(node);
+    std::push_heap(m_timers.begin(), m_timers.end(), WakesLater);
+}
+
+void TaskScheduler::PushMain(TaskDetail::WaitNode* node)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_main.Push(node);
+}
+
+void TaskScheduler::RunOnWorker(std::coroutine_handle<> handle)
+{
+    // A lambda holding one pointer fits in std::function without allocating.
+    m_jobs->Submit([handle] { handle.resume(); });
+}
+
+void TaskScheduler::RunLoad(std::function<void()> load)
+{
+    if (m_jobs) m_jobs->Submit(std::move(load));
+    else load();
+}
+
+void TaskScheduler::WaitForLoad(LoadState& state, TaskDetail::WaitNode* node)
+{
+    // Already loaded, but awaited from a worker: still continue on the main thread.
+    if (!state.AddWaiter(node))
+        PushMain(node);
+}
+
+void TaskScheduler::Pump(double now)
+{
+    PROFILE_SCOPE("Tasks::Pump");
+
+    // Everything due is collected first, so a task that waits again while
+    // being resumed (NextFrame in a loop) goes to the next Pump, not this one.
+    TaskDetail::WaitList ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ready.Append(m_main);
+        ready.Append(m_nextFrame);
+        while (!m_timers.empty() && m_timers.front()->wakeTime <= now) {
+            std::pop_heap(m_timers.begin(), m_timers.end(), WakesLater);
+            ready.Push(m_timers.back());
+            m_timers.pop_back();
+        }
+    }
+
+    uint32_t resumed = 0;
+    for (TaskDetail::WaitNode* node = ready.head; node; ++resumed) {
+        // The node lives in the task's frame and is reused by its next await.
+        TaskDetail::WaitNode* next = node->next;
+        node->handle.resume();
+        node = next;
+    }
+    m_resumedLastPump = resumed;
+}
+
+void TaskScheduler::Shutdown()
+{
+    TaskDetail::PromiseBase* spawned;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        spawned = m_spawned;
+        m_spawned = nullptr;
+        m_main = {};
+        m_nextFrame = {};
+        m_timers.clear();
+    }
+
+    // Destroying a task also destroys the Tasks it was awaiting (they are
+    // locals of its frame), so only the spawned ones need to be destroyed here.
+    while (spawned) {
+        TaskDetail::PromiseBase* next = spawned->nextSpawned;
+        spawned->self.destroy();
+        spawned = next;
+    }
+}
+
+TaskStats TaskScheduler::GetStats() const
+{
+    TaskStats s;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    s.spawned = m_spawnedCount;
+    s.finished = m_finishedCount;
+    s.failed = m_failedCount;
+    s.running = uint32_t(m_spawnedCount - m_finishedCount);
+    s.resumedLastPump = m_resumedLastPump;
+    s.sleeping = uint32_t(m_timers.size());
+    s.frameHeapAllocations = TaskFramePool::HeapAllocations();
+    return s;
+}
@@ -0,0 +1,254 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Task.h"
+
+class JobSystem;
+
+/*
+ * TaskScheduler
+ * Runs Tasks (see Task.h) and provides what they can co_await:
+ *
+ *   co_await tasks.NextFrame();           // continue on the main thread next frame
+ *   co_await tasks.Delay(2.5);            // continue on the main thread 2.5 s later
+ *   co_await tasks.SwitchToWorker();      // continue on a JobSystem worker
+ *   co_await tasks.SwitchToMainThread();  // continue on the main thread (next frame,
+ *                                         // or right away if already on it)
+ *   auto& mesh = co_await tasks.AssetLoaded(*asset); // continue on the main thread
+ *                                         // once LoadAsync finished
+ *
+ * Core calls Pump() once per frame, before the functions from addFunc, and
+ * that is where everything waiting for the main thread is resumed.
+ * Delay counts real seconds (Clock::Now), checked once per frame, so a delay
+ * ends on the first frame at or after its time.
+ *
+ * No allocation per await: a waiting task is queued through a node that lives
+ * in its awaiter, i.e. in its own coroutine frame, and worker hops go through
+ * the job queue, which reuses its storage.
+ */
+
+namespace TaskDetail {
+
+    // One suspended task in one of the queues (intrusive, see above).
+    struct WaitNode {
+        std::coroutine_handle<> handle;
+        WaitNode* next = nullptr;
+        double wakeTime = 0.0; // Delay only
+    };
+
+    // FIFO of WaitNodes, the caller does the locking.
+    struct WaitList {
+        WaitNode* head = nullptr;
+        WaitNode* tail = nullptr;
+
+        void Push(WaitNode* node) {
+            node->next = nullptr;
+            if (tail) tail->next = node;
+            else head = node;
+            tail = node;
+        }
+        void Append(WaitList& other) {
+            if (!other.head) return;
+            if (tail) tail->next = other.head;
+            else head = other.head;
+            tail = other.tail;
+            other = {};
+        }
+    };
+
+} // namespace TaskDetail
+
+// Something that finishes loading on another thread and can be awaited
+// with TaskScheduler::AssetLoaded. Waiting tasks continue on the main thread.
+class LoadState {
+public:
+    explicit LoadState(TaskScheduler& scheduler) : m_scheduler(scheduler) {}
+
+    LoadState(const LoadState&) = delete;
+    LoadState& operator=(const LoadState&) = delete;
+
+    bool IsLoaded() const { return m_loaded.load(std::memory_order_acquire); }
+    bool Failed() const { return m_failed; } // valid once IsLoaded()
+    TaskScheduler& Scheduler() const { return m_scheduler; }
+
+    // Any thread, once. Wakes every task waiting for it.
+    void MarkLoaded(bool failed = false);
+
+private:
+    friend class TaskScheduler;
+    // false if already loaded: nothing to wait for.
+    bool AddWaiter(TaskDetail::WaitNode* node);
+
+private:
+    TaskScheduler& m_scheduler;
+    std::atomic<bool> m_loaded{ false };
+    bool m_failed = false;
+    std::mutex m_mutex;
+    TaskDetail::WaitList m_waiters;
+};
+
+// A LoadState that carries the loaded value, made by TaskScheduler::LoadAsync.
+template<typename T>
+class AsyncAsset : public LoadState {
+public:
+    using LoadState::LoadState;
+
+    // Only valid once IsLoaded() and not Failed().
+    T& Get() { return m_value; }
+    const T& Get() const { return m_value; }
+
+    void SetLoaded(T&& value) {
+        m_value = std::move(value);
+        MarkLoaded();
+    }
+
+private:
+    T m_value{};
+};
+
+struct TaskStats {
+    uint64_t spawned = 0;
+    uint64_t finished = 0;
+    uint64_t failed = 0;        // finished with an exception
+    uint32_t running = 0;       // spawned and not finished yet
+    uint32_t resumedLastPump = 0;
+    uint32_t sleeping = 0;      // in Delay
+    uint64_t frameHeapAllocations = 0; // TaskFramePool::HeapAllocations()
+};
+
+class TaskScheduler {
+public:
+    // The thread that constructs the scheduler is "the main thread".
+    TaskScheduler();
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    // Without a job system SwitchToWorker and LoadAsync run on the caller.
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+
+    // Starts `task` right now, on the calling thread, up to its first co_await.
+    // The scheduler owns it from here on.
+    template<typename T>
+    void Spawn(Task<T>&& task) {
+        auto handle = task.Release();
+        if (!handle) return;
+        Register(handle.promise(), handle);
+        handle.resume();
+    }
+
+    // Main thread, once per frame: resumes the tasks due this frame.
+    void Pump(double now);
+
+    // Destroys every spawned task that has not finished. Call it after the
+    // job system stopped, so no task can be running on a worker.
+    void Shutdown();
+
+    bool IsMainThread() const { return std::this_thread::get_id() == m_mainThread; }
+
+    TaskStats GetStats() const;
+
+    // ---- awaitables ----
+
+    struct NextFrameAwaiter {
+        TaskScheduler& scheduler;
+        TaskDetail::WaitNode node;
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { node.handle = h; scheduler.PushNextFrame(&node); }
+        void await_resume() noexcept {}
+    };
+
+    struct DelayAwaiter {
+        TaskScheduler& scheduler;
+        double seconds;
+        TaskDetail::WaitNode node;
+        bool await_ready() noexcept { return seconds <= 0.0 && scheduler.IsMainThread(); }
+        void await_suspend(std::coroutine_handle<> h) { node.handle = h; scheduler.PushTimer(&node, seconds); }
+        void await_resume() noexcept {}
+    };
+
+    struct WorkerAwaiter {
+        TaskScheduler& scheduler;
+        bool await_ready() noexcept { return scheduler.m_jobs == nullptr; }
+        void await_suspend(std::coroutine_handle<> h) { scheduler.RunOnWorker(h); }
+        void await_resume() noexcept {}
+    };
+
+    struct MainThreadAwaiter {
+        TaskScheduler& scheduler;
+        TaskDetail::WaitNode node;
+        bool await_ready() noexcept { return scheduler.IsMainThread(); }
+        void await_suspend(std::coroutine_handle<> h) { node.handle = h; scheduler.PushMain(&node); }
+        void await_resume() noexcept {}
+    };
+
+    template<typename State>
+    struct AssetAwaiter {
+        State& state;
+        TaskDetail::WaitNode node;
+        bool await_ready() noexcept { return state.IsLoaded() && state.Scheduler().IsMainThread(); }
+        void await_suspend(std::coroutine_handle<> h) { node.handle = h; state.Scheduler().WaitForLoad(state, &node); }
+        decltype(auto) await_resume() noexcept {
+            if constexpr (requires { state.Get(); }) return (state.Get());
+        }
+    };
+
+    NextFrameAwaiter NextFrame() { return { *this, {} }; }
+    DelayAwaiter Delay(double seconds) { return { *this, seconds, {} }; }
+    WorkerAwaiter SwitchToWorker() { return { *this }; }
+    MainThreadAwaiter SwitchToMainThread() { return { *this, {} }; }
+
+    // Returns the asset's value (or nothing for a plain LoadState).
+    template<typename State>
+    AssetAwaiter<State> AssetLoaded(State& state) { return { state, {} }; }
+
+    // Runs `load` (returning a T) on a worker and keeps the result in the
+    // returned asset; await it with AssetLoaded. If `load` throws, the asset
+    // ends up loaded and Failed().
+    template<typename T, typename Fn>
+    std::shared_ptr<AsyncAsset<T>> LoadAsync(Fn&& load) {
+        auto asset = std::make_shared<AsyncAsset<T>>(*this);
+        RunLoad([asset, load = std::forward<Fn>(load)]() mutable {
+            try { asset->SetLoaded(load()); }
+            catch (...) { asset->MarkLoaded(true); }
+        });
+        return asset;
+    }
+
+private:
+    friend class LoadState;
+    friend std::coroutine_handle<> TaskDetail::FinishTask(TaskDetail::PromiseBase&, std::coroutine_handle<>) noexcept;
+
+    void Register(TaskDetail::PromiseBase& promise, std::coroutine_handle<> handle);
+    void Finish(TaskDetail::PromiseBase& promise);
+
+    void PushNextFrame(TaskDetail::WaitNode* node);
+    void PushTimer(TaskDetail::WaitNode* node, double seconds);
+    void PushMain(TaskDetail::WaitNode* node);
+    void RunOnWorker(std::coroutine_handle<> handle);
+    void WaitForLoad(LoadState& state, TaskDetail::WaitNode* node);
+    void RunLoad(std::function<void()> load);
+
+private:
+    JobSystem* m_jobs = nullptr;
+    std::thread::id m_mainThread;
+
+    mutable std::mutex m_mutex; // guards everything below
+    TaskDetail::WaitList m_main;
+    TaskDetail::WaitList m_nextFrame;
+    std::vector<TaskDetail::WaitNode*> m_timers; // min-heap on wakeTime
+    TaskDetail::PromiseBase* m_spawned = nullptr; // list of running spawned tasks
+
+    uint64_t m_spawnedCount = 0;
+    uint64_t m_finishedCount = 0;
+    uint64_t m_failedCount = 0;
+    uint32_t m_resumedLastPump = 0;
+};
@@ -0,0 +1,148 @@
+#include "Tests/Tests.h"
+#include "Memory/AllocTracker.h"
+#include "Memory/LinearAllocator.h"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+
+    uint64_t UserAllocations() {
+        return AllocTracker::GetStats(AllocTag::User).totalCount;
+    }
+
+    bool Aligned(const void* p, size_t alignment) {
+        return (reinterpret_cast<uintptr_t>(p) & (alignment - 1)) == 0;
+    }
+
+    // What a frame of some system might ask for: odd sizes, mixed
+    // alignments, one request bigger than a whole block, and a vector
+    // that grows in the arena.
+    uint32_t Workload(LinearAllocator& arena, TestContext& t) {
+        static const size_t alignments[] = { 1, 2, 4, 8, 16, 64, 256 };
+        bool aligned = true;
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < 200; ++i) {
+            const size_t alignment = alignments[i % 7];
+            const size_t size = 1 + (i * 37) % 300;
+            uint8_t* p = static_cast<uint8_t*>(arena.Allocate(size, alignment));
+            aligned = aligned && Aligned(p, alignment);
+            std::memset(p, int(i), size); // all of it is usable
+        }
+        double* big = arena.AllocateArray<double>(1000);
+        aligned = aligned && Aligned(big, alignof(double));
+        big[999] = 1.0;
+
+        ArenaVector<uint32_t> values{ ArenaAllocator<uint32_t>(arena) };
+        for (uint32_t i = 0; i < 500; ++i)
+            values.push_back(i);
+        for (uint32_t v : values)
+            sum += v;
+        aligned = aligned && Aligned(values.data(), alignof(uint32_t));
+        CHECK(t, aligned);
+        return sum;
+    }
+
+    // Every pointer has the alignment asked for, also the first one in a
+    // fresh block and one wider than the heap's own alignment.
+    void TestAlignment(TestContext& t) {
+        LinearAllocator arena(256, AllocTag::User);
+        bool aligned = true;
+        for (size_t alignment = 1; alignment <= 4096; alignment *= 2) {
+            for (size_t size : { size_t(1), size_t(3), size_t(255), size_t(1000) })
+                aligned = aligned && Aligned(arena.Allocate(size, alignment), alignment);
+        }
+        CHECK(t, aligned);
+        CHECK(t, arena.Used() == 13 * (1 + 3 + 255 + 1000));
+
+        struct alignas(32) Wide { float v[8]; };
+        Wide* wide = arena.AllocateArray<Wide>(3);
+        CHECK(t, Aligned(wide, 32));
+    }
+
+    // Reset merges whatever blocks a frame needed into a single one, at
+    // least as big as the most that was ever in use, so the next frame of
+    // the same work fits in it. A single block is kept as it is.
+    void TestResetMerges(TestContext& t) {
+        LinearAllocator arena(1024, AllocTag::User);
+        CHECK(t, arena.BlockCount() == 0 && arena.Capacity() == 0);
+        arena.Reset(); // nothing to keep
+        CHECK(t, arena.BlockCount() == 0);
+
+        Workload(arena, t);
+        const size_t peak = arena.Capacity();
+        CHECK(t, arena.BlockCount() > 1);
+
+        arena.Reset();
+        CHECK(t, arena.BlockCount() == 1 && arena.Used() == 0);
+        CHECK(t, arena.Capacity() >= peak && arena.Capacity() < 2 * peak);
+
+        Workload(arena, t);
+        CHECK(t, arena.BlockCount() == 1);
+
+        const size_t merged = arena.Capacity();
+        arena.Reset();
+        void* first = arena.Allocate(1);
+        arena.Reset();
+        CHECK(t, arena.Capacity() == merged && arena.BlockCount() == 1 && arena.Allocate(1) == first);
+    }
+
+    // The point of it all: the second time the same work runs, it takes
+    // nothing from the heap. The Reset in between allocates the merged
+    // block once; a FrameAllocator does that once for each of its arenas.
+    void TestSteadyAllocations(TestContext& t) {
+        if (!AllocTracker::Enabled)
+            return;
+        LinearAllocator arena(1024, AllocTag::User);
+        uint64_t before = UserAllocations();
+        const uint32_t sum = Workload(arena, t);
+        CHECK(t, UserAllocations() > before + 1);
+
+        before = UserAllocations();
+        arena.Reset();
+        CHECK(t, UserAllocations() == before + 1);
+        before = UserAllocations();
+        CHECK(t, Workload(arena, t) == sum);
+        CHECK(t, UserAllocations() == before);
+
+        FrameAllocator frames(1024, AllocTag::User);
+        bool steady = true;
+        for (int frame = 0; frame < 10; ++frame) {
+            const uint64_t start = UserAllocations();
+            frames.BeginFrame();
+            const uint64_t work = UserAllocations();
+            Workload(frames.Current(), t);
+            if (frame >= 2) steady = steady && UserAllocations() == work; // each arena's second use
+            if (frame >= 4) steady = steady && work == start;             // both merged already
+        }
+        CHECK(t, steady);
+    }
+
+    // Memory from frame N survives BeginFrame into N + 1 and is reused at
+    // N + 2.
+    void TestFrameLifetime(TestContext& t) {
+        FrameAllocator frames(1024, AllocTag::User);
+        frames.BeginFrame();
+        uint32_t* a = frames.AllocateArray<uint32_t>(16);
+        for (uint32_t i = 0; i < 16; ++i) a[i] = i;
+
+        frames.BeginFrame();
+        uint32_t* b = frames.AllocateArray<uint32_t>(16);
+        for (uint32_t i = 0; i < 16; ++i) b[i] = 100 + i;
+        bool kept = true;
+        for (uint32_t i = 0; i < 16; ++i) kept = kept && a[i] == i;
+        CHECK(t, kept && a != b);
+
+        frames.BeginFrame();
+        CHECK(t, frames.AllocateArray<uint32_t>(16) == a);
+    }
+
+} // namespace
+
+void RunAllocatorTests(TestContext& t)
+{
+    TestAlignment(t);
+    TestResetMerges(t);
+    TestSteadyAllocations(t);
+    TestFrameLifetime(t);
+}
@@ -0,0 +1,122 @@
+#include "Tests/Tests.h"
+#include "Bench/AnimationFixture.h"
+#include "Threading/JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+using namespace AnimationFixture;
+
+namespace {
+
+    // Every skinned item in the queue against the formula, one float at a time.
+    bool SkinningMatches(const Scene& s) {
+        std::vector<uint32_t> characterOf(size_t(s.world.EntityCount()) + 1, ~0u);
+        for (uint32_t c = 0; c < s.system.CharacterCount(); ++c)
+            characterOf[s.system.GetEntity(c)] = c;
+
+        const auto& vertices = s.queue.GetVertices();
+        uint32_t checked = 0;
+        for (const RenderItem& item : s.queue.GetItems()) {
+            if (item.firstVertex == RenderItem::NoVertices)
+                continue;
+            const MeshData& mesh = *s.meshes.Get(item.mesh);
+            const XMFLOAT4X4A* skin = s.system.GetSkinMatrices(characterOf[item.id]);
+            for (size_t v = 0; v < mesh.positions.size(); ++v) {
+                const XMFLOAT3& p = mesh.positions[v];
+                const float w[4] = { mesh.jointWeights[v].x, mesh.jointWeights[v].y, mesh.jointWeights[v].z, mesh.jointWeights[v].w };
+                float r[3] = { 0.0f, 0.0f, 0.0f };
+                for (int k = 0; k < 4; ++k) {
+                    const XMFLOAT4X4& m = skin[mesh.jointIndices[v].joint[k]];
+                    for (int c = 0; c < 3; ++c)
+                        r[c] += w[k] * (p.x * m.m[0][c] + p.y * m.m[1][c] + p.z * m.m[2][c] + m.m[3][c]);
+                }
+                const XMFLOAT3& got = vertices[item.firstVertex + v];
+                if (std::fabs(got.x - r[0]) > 1e-4f || std::fabs(got.y - r[1]) > 1e-4f || std::fabs(got.z - r[2]) > 1e-4f)
+                    return false;
+            }
+            ++checked;
+        }
+        return checked > 0;
+    }
+
+    void TestClipCompression(TestContext& t) {
+        Scene s;
+        BuildScene(s, 1, 32, 8, t.Seed());
+        const ClipError sway = CompareClip(s.sway, *s.animations.GetClip(s.swayClip));
+        const ClipError twist = CompareClip(s.twist, *s.animations.GetClip(s.twistClip));
+        CHECK(t, sway.rotation <= 2e-3f && sway.translation <= 1e-3f);
+        CHECK(t, twist.rotation <= 2e-3f && twist.translation <= 1e-3f);
+    }
+
+    // The SIMD skinning against the formula, and the jobs against one thread.
+    void TestParallelSkinning(TestContext& t) {
+        JobSystem jobs;
+        const uint32_t count = 64;
+        Scene parallel, serial;
+        BuildScene(parallel, count, 32, 8, t.Seed());
+        BuildScene(serial, count, 32, 8, t.Seed());
+
+        AnimationSettings as;
+        as.parallelThreshold = 4; // small crowd, but still exercise the jobs
+        as.charactersPerJob = 3;
+        parallel.system.SetSettings(as);
+        parallel.system.SetJobSystem(&jobs);
+
+        const float dt = 1.0f / 60.0f;
+        for (uint32_t step = 0; step < 20; ++step) {
+            for (Scene* s : { &parallel, &serial }) {
+                s->system.Update(s->world, dt);
+                s->queue.Clear();
+                s->system.Skin(s->world, s->meshes, s->queue, s->view);
+            }
+            CHECK(t, SkinningMatches(parallel));
+
+            // The jobs must give exactly what one thread gives.
+            const uint32_t joints = parallel.system.GetStats().joints;
+            const auto& pv = parallel.queue.GetVertices();
+            const auto& sv = serial.queue.GetVertices();
+            CHECK(t, joints > 0 && joints == serial.system.GetStats().joints);
+            CHECK(t, std::memcmp(parallel.system.GetSkinMatrices(0), serial.system.GetSkinMatrices(0), joints * sizeof(XMFLOAT4X4A)) == 0);
+            CHECK(t, pv.size() == sv.size() && std::memcmp(pv.data(), sv.data(), pv.size() * sizeof(XMFLOAT3)) == 0);
+        }
+    }
+
+    // A mesh skinned by one skeleton, then drawn by a character with fewer
+    // joints than it uses: that character is drawn rigid, not skinned with
+    // matrices past the end of its own.
+    void TestSmallerSkeleton(TestContext& t) {
+        Scene s;
+        BuildScene(s, 2, 32, 8, t.Seed());
+        const float dt = 1.0f / 60.0f;
+        s.system.Update(s.world, dt);
+        s.system.Skin(s.world, s.meshes, s.queue, s.view);
+        CHECK(t, s.system.GetStats().skinned == 2);
+
+        const SkeletonHandle small = s.animations.AddSkeleton(CreateTestChain(8, TubeHeight), "short chain");
+        Animator& a = s.world.GetComponent<Animator>(2);
+        a.skeleton = small;
+        a.clip = a.blendClip = InvalidClip;
+
+        s.system.Update(s.world, dt);
+        s.queue.Clear();
+        s.system.Skin(s.world, s.meshes, s.queue, s.view);
+        CHECK(t, s.system.GetStats().skinned == 1);
+        uint32_t rigid = 0;
+        for (const RenderItem& item : s.queue.GetItems())
+            rigid += item.id == 2 && item.firstVertex == RenderItem::NoVertices ? 1 : 0;
+        CHECK(t, rigid == 1);
+        CHECK(t, SkinningMatches(s));
+    }
+
+} // namespace
+
+void RunAnimationTests(TestContext& t)
+{
+    TestClipCompression(t);
+    TestParallelSkinning(t);
+    TestSmallerSkeleton(t);
+}
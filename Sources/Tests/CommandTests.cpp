@@ -0,0 +1,85 @@
+#include "Tests/Tests.h"
+#include "Bench/CommandFixture.h"
+
+#include <cstring>
+
+using namespace CommandFixture;
+
+namespace {
+
+    template<typename T>
+    bool SamePool(World& a, World& b) {
+        const ComponentPool<T>& pa = a.GetPool<T>();
+        const ComponentPool<T>& pb = b.GetPool<T>();
+        return pa.Size() == pb.Size() &&
+            std::memcmp(pa.Entities().data(), pb.Entities().data(), pa.Size() * sizeof(Entity)) == 0 &&
+            std::memcmp(pa.Data().data(), pb.Data().data(), pa.Size() * sizeof(T)) == 0;
+    }
+
+    // Deferred IDs, remove after add, destroy after both, lower sort key first.
+    void TestPlaybackRules(TestContext& t) {
+        World world;
+        EntityCommands commands;
+        commands.SetJobSystem(nullptr);
+        const Entity existing = world.CreateEntity();
+        world.AddComponent<Transform>(existing);
+        world.AddComponent<Mesh>(existing, Mesh{ 1 });
+
+        EntityCommandBuffer& cmd = commands.Buffer(0);
+        cmd.SetSortKey(5);
+        const Entity kept = cmd.CreateEntity();
+        cmd.AddComponent(kept, Transform{});
+        cmd.AddComponent(kept, Projectile{ { 0.0f, 1.0f, 0.0f }, 0.0f });
+        cmd.RemoveComponent<Projectile>(kept);       // remove wins over add
+        const Entity gone = cmd.CreateEntity();
+        cmd.AddComponent(gone, Transform{});
+        cmd.DestroyEntity(gone);                     // destroy wins over both
+        cmd.RemoveComponent<Transform>(existing);
+        cmd.SetSortKey(1);
+        const Entity first = cmd.CreateEntity();     // lower key: lower ID
+        cmd.AddComponent(first, Mesh{ 7 });
+
+        CHECK(t, EntityCommandBuffer::IsDeferred(kept));
+        CHECK(t, !commands.Empty());
+        commands.Playback(world);
+
+        const Entity k = commands.Resolve(kept), g = commands.Resolve(gone), f = commands.Resolve(first);
+        const EntityCommandStats& st = commands.GetStats();
+        CHECK(t, commands.Empty());
+        CHECK(t, world.EntityCount() == 4 && f == 2 && k == 3 && g == 4);
+        CHECK(t, world.HasComponent<Transform>(k) && !world.HasComponent<Projectile>(k));
+        CHECK(t, !world.HasComponent<Transform>(g));
+        CHECK(t, !world.HasComponent<Transform>(existing) && world.HasComponent<Mesh>(existing));
+        CHECK(t, world.GetComponent<Mesh>(f).handle == 7);
+        CHECK(t, st.creates == 3 && st.adds == 4 && st.removes == 2 && st.destroys == 1);
+    }
+
+    // Several workers against none: must end in the same world, same IDs,
+    // same pool order, same bytes.
+    void TestJobsMatchSerial(TestContext& t) {
+        JobSystem jobs(3);
+        Storm parallel, serial;
+        parallel.seed = serial.seed = t.Seed();
+        parallel.jobs = &jobs;
+        parallel.commands.SetJobSystem(&jobs);
+        Populate(parallel, 20000);
+        Populate(serial, 20000);
+        for (uint32_t f = 0; f < 30; ++f) {
+            for (Storm* s : { &parallel, &serial }) {
+                Record(*s, 3000);
+                s->commands.Playback(s->world);
+            }
+            CHECK(t, parallel.world.EntityCount() == serial.world.EntityCount());
+            CHECK(t, SamePool<Transform>(parallel.world, serial.world));
+            CHECK(t, SamePool<Projectile>(parallel.world, serial.world));
+            CHECK(t, SamePool<Mesh>(parallel.world, serial.world));
+        }
+    }
+
+} // namespace
+
+void RunCommandTests(TestContext& t)
+{
+    TestPlaybackRules(t);
+    TestJobsMatchSerial(t);
+}
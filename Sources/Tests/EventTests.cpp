@@ -0,0 +1,141 @@
+#include "Tests/Tests.h"
+#include "Bench/EventFixture.h"
+#include "Memory/AllocTracker.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace EventFixture;
+
+namespace {
+
+    // Many threads, a channel that starts far too small: every event that
+    // fit is read exactly once, the rest is counted, and it stops dropping.
+    void TestWrites(TestContext& t) {
+        JobSystem jobs;
+        const uint32_t seed = t.Seed();
+        const uint32_t count = 20000;
+        EventBus bus;
+        EventChannel<CollisionEvent>& channel = bus.Register<CollisionEvent>(64);
+        EventReader reader = channel.NewReader();
+        std::vector<uint8_t> seen(count);
+        uint32_t lastWritten = 0;
+
+        for (uint32_t tick = 0; tick < 6; ++tick) {
+            bus.Update();
+            if (tick > 0) {
+                const EventChannelStats& st = channel.GetStats();
+                CHECK(t, st.written == lastWritten && st.written + st.dropped == count);
+            }
+            const uint32_t capacity = channel.GetStats().capacity;
+            WriteTick(channel, &jobs, seed, tick, count);
+
+            const EventBatch<CollisionEvent> batch = channel.Read(reader);
+            lastWritten = batch.Size();
+            std::fill(seen.begin(), seen.end(), 0);
+            CHECK(t, batch.Size() == std::min(count, capacity) && batch.count[0] == 0);
+            bool ok = true;
+            batch.ForEach([&](const CollisionEvent& e) {
+                const CollisionEvent want = MakeEvent(seed, tick, e.id);
+                ok = ok && e.id < count && !seen[e.id] && e.a == want.a && e.b == want.b && e.impulse == want.impulse;
+                if (e.id < count) seen[e.id] = 1;
+            });
+            CHECK(t, ok);
+        }
+        // Grown after the first tick: the last ones kept everything.
+        CHECK(t, lastWritten == count && channel.GetStats().capacity >= count);
+    }
+
+    // Readers that come by every tick, every second and every third tick:
+    // the first two see every event once and in order, the last one counts
+    // what was gone (events live for two ticks).
+    void TestCursors(TestContext& t) {
+        EventBus bus;
+        EventChannel<CollisionEvent>& channel = bus.Register<CollisionEvent>(256);
+        struct Check { EventReader reader; uint32_t every; uint64_t next = 0, seen = 0; bool ok = true; };
+        Check checks[3] = { { channel.NewReader(), 1 }, { channel.NewReader(), 2 }, { channel.NewReader(), 3 } };
+
+        uint32_t total = 0;
+        for (uint32_t tick = 0; tick < 30; ++tick) {
+            bus.Update();
+            const uint32_t count = 50 + (tick * 37) % 100;
+            for (uint32_t i = 0; i < count; ++i)
+                channel.Write(CollisionEvent{ 1, 2, 0.0f, total + i }); // id = sequence number
+            total += count;
+
+            for (Check& c : checks) {
+                if (tick % c.every != c.every - 1)
+                    continue;
+                const uint64_t missedBefore = c.reader.missed;
+                const EventBatch<CollisionEvent> batch = channel.Read(c.reader);
+                c.next += c.reader.missed - missedBefore;
+                batch.ForEach([&](const CollisionEvent& e) {
+                    c.ok = c.ok && e.id == c.next;
+                    ++c.next;
+                    ++c.seen;
+                });
+            }
+        }
+
+        for (const Check& c : checks) {
+            CHECK(t, c.ok);
+            CHECK(t, c.seen + c.reader.missed == c.next);
+        }
+        CHECK(t, checks[0].reader.missed == 0 && checks[1].reader.missed == 0);
+        CHECK(t, checks[2].reader.missed > 0);
+        CHECK(t, checks[0].seen == total && checks[2].next <= total);
+    }
+
+    // Once the channels are big enough, a tick must not allocate at all.
+    void TestSteadyAllocations(TestContext& t) {
+        if (!AllocTracker::Enabled)
+            return;
+        JobSystem jobs;
+        EventBus bus;
+        EventChannel<CollisionEvent>& channel = bus.Register<CollisionEvent>(16);
+        EventReader reader = channel.NewReader();
+        auto tick = [&](uint32_t i) {
+            bus.Update();
+            WriteTick(channel, &jobs, t.Seed(), i, 30000);
+            channel.Read(reader);
+        };
+        for (uint32_t i = 0; i < 8; ++i)
+            tick(i);
+
+        const uint64_t before = AllocTracker::GetStats(AllocTag::ECS).totalCount;
+        for (uint32_t i = 8; i < 40; ++i)
+            tick(i);
+        CHECK(t, AllocTracker::GetStats(AllocTag::ECS).totalCount == before);
+    }
+
+    // Only Register makes a channel; after that, writes through the bus
+    // from many threads all land in it.
+    void TestRegistration(TestContext& t) {
+        struct Unused { uint32_t value; };
+        JobSystem jobs;
+        EventBus bus;
+        CHECK(t, bus.FindChannel<CollisionEvent>() == nullptr);
+        EventChannel<CollisionEvent>& channel = bus.Register<CollisionEvent>(4096);
+        CHECK(t, &bus.Register<CollisionEvent>() == &channel && bus.FindChannel<CollisionEvent>() == &channel);
+        CHECK(t, &bus.Channel<CollisionEvent>() == &channel);
+        CHECK(t, bus.FindChannel<Unused>() == nullptr);
+
+        EventReader reader = channel.NewReader();
+        bus.Update();
+        jobs.ParallelFor(4000, 100, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i)
+                bus.Write(CollisionEvent{ 1, 2, 0.0f, i });
+        });
+        CHECK(t, bus.Read<CollisionEvent>(reader).Size() == 4000);
+        CHECK(t, bus.FindChannel<Unused>() == nullptr);
+    }
+
+} // namespace
+
+void RunEventTests(TestContext& t)
+{
+    TestWrites(t);
+    TestCursors(t);
+    TestSteadyAllocations(t);
+    TestRegistration(t);
+}
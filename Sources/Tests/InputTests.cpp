@@ -0,0 +1,151 @@
+#include "Tests/Tests.h"
+#include "Input/InputState.h"
+#include "Input/InputWriter.h"
+#include "Input/SyntheticInput.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace {
+
+    bool SameEvent(const InputEvent& a, const InputEvent& b) {
+        return a.time == b.time && a.type == b.type && a.code == b.code && a.wheel == b.wheel && a.x == b.x && a.y == b.y;
+    }
+
+    // Applies this tick's events and checks them against the stream of a
+    // generator that never saw a full queue.
+    uint32_t ConsumeChecked(InputState& state, InputQueue& queue, Clock::Ticks until, SyntheticInput& reference, bool& same) {
+        const uint32_t n = state.Consume(queue, until);
+        for (const InputEvent& e : state.Events())
+            same = same && SameEvent(e, reference.Next(e.time));
+        return n;
+    }
+
+    // Emit into a full queue stops short and takes the refused event back:
+    // nothing is lost or reordered, and once the source holds nothing and
+    // the queue is drained, no key or button is left down.
+    void TestFullQueue(TestContext& t) {
+        auto queue = std::make_unique<InputQueue>();
+        SyntheticInput source(t.Seed());
+        SyntheticInput reference(t.Seed());
+        InputState state;
+        bool same = true;
+
+        for (Clock::Ticks tick = 1; tick <= 40; ++tick) {
+            const uint32_t room = InputQueue::GetCapacity() - queue->SizeApprox();
+            CHECK(t, source.Emit(*queue, InputQueue::GetCapacity() + 1000, tick) == room);
+            // Every other tick leaves this tick's events queued, so the next
+            // Emit finds the queue full and must push nothing.
+            ConsumeChecked(state, *queue, tick % 2 ? tick - 1 : tick, reference, same);
+        }
+        while (source.Holding()) {
+            CHECK(t, source.Emit(*queue, 1, 100) == 1);
+            ConsumeChecked(state, *queue, 100, reference, same);
+        }
+        ConsumeChecked(state, *queue, 100, reference, same);
+
+        CHECK(t, same);
+        CHECK(t, queue->Dropped() >= 40 && queue->SizeApprox() == 0);
+        bool anyDown = false;
+        for (uint32_t k = 0; k < InputState::KeyCount; ++k) anyDown |= state.IsKeyDown(k);
+        for (uint32_t b = 0; b < InputState::MouseButtonCount; ++b) anyDown |= state.IsMouseButtonDown(b);
+        CHECK(t, !anyDown);
+    }
+
+    // A producer thread and a consumer ticking at the same time: every
+    // event arrives once, in order.
+    void TestThreads(TestContext& t) {
+        constexpr uint32_t Count = 2000000;
+        auto queue = std::make_unique<InputQueue>();
+        std::atomic<bool> done{ false };
+
+        std::thread producer([&] {
+            SyntheticInput source(t.Seed());
+            uint32_t sent = 0;
+            while (sent < Count) {
+                const uint32_t n = source.Emit(*queue, std::min(16u, Count - sent), sent);
+                sent += n;
+                if (n == 0)
+                    std::this_thread::yield();
+            }
+            done.store(true, std::memory_order_release);
+        });
+
+        SyntheticInput reference(t.Seed());
+        InputState state;
+        uint32_t received = 0;
+        bool same = true;
+        for (;;) {
+            const bool last = done.load(std::memory_order_acquire);
+            const uint32_t consumed = ConsumeChecked(state, *queue, Count, reference, same);
+            received += consumed;
+            if (last && queue->SizeApprox() == 0)
+                break;
+            if (consumed == 0)
+                std::this_thread::yield();
+        }
+        producer.join();
+        CHECK(t, received == Count);
+        CHECK(t, same);
+    }
+
+    InputEvent Event(InputEventType type, uint8_t code, Clock::Ticks time) {
+        InputEvent e;
+        e.type = type;
+        e.code = code;
+        e.time = time;
+        return e;
+    }
+
+    // A KeyUp and a MouseUp dropped by a full queue don't leave their key
+    // and button down: the writer puts a FocusLost in first once there is
+    // room, on the next event or on Flush, whichever comes first.
+    void TestDroppedRelease(TestContext& t) {
+        auto queue = std::make_unique<InputQueue>();
+        InputWriter writer(*queue);
+        InputState state;
+
+        CHECK(t, writer.Push(Event(InputEventType::KeyDown, 'W', 1)));
+        CHECK(t, writer.Push(Event(InputEventType::MouseDown, 0, 1)));
+        while (writer.Push(Event(InputEventType::MouseMove, 0, 2))) {}
+        CHECK(t, !writer.ReleasePending()); // a dropped move is just dropped
+
+        CHECK(t, !writer.Push(Event(InputEventType::KeyUp, 'W', 3)));
+        CHECK(t, !writer.Push(Event(InputEventType::MouseUp, 0, 3)));
+        CHECK(t, writer.ReleasePending());
+        const uint64_t dropped = queue->Dropped();
+        writer.Flush(4); // still full
+        CHECK(t, writer.ReleasePending() && queue->Dropped() == dropped + 1);
+
+        state.Consume(*queue, 10);
+        CHECK(t, state.IsKeyDown('W') && state.IsMouseButtonDown(0)); // the ups never arrived
+
+        // Room again: the next event goes in behind a FocusLost.
+        CHECK(t, writer.Push(Event(InputEventType::KeyDown, 'A', 5)));
+        CHECK(t, !writer.ReleasePending());
+        state.Consume(*queue, 10);
+        CHECK(t, state.Events().size() == 2 && state.Events()[0].type == InputEventType::FocusLost);
+        CHECK(t, !state.IsKeyDown('W') && state.IsKeyReleased('W') && !state.IsMouseButtonDown(0));
+        CHECK(t, state.IsKeyDown('A'));
+
+        // With no further input, Flush delivers it.
+        while (writer.Push(Event(InputEventType::MouseMove, 0, 6))) {}
+        CHECK(t, !writer.Push(Event(InputEventType::KeyUp, 'A', 7)));
+        state.Consume(*queue, 10);
+        CHECK(t, state.IsKeyDown('A'));
+        writer.Flush(8);
+        CHECK(t, !writer.ReleasePending());
+        state.Consume(*queue, 10);
+        CHECK(t, !state.IsKeyDown('A') && state.IsKeyReleased('A'));
+    }
+
+} // namespace
+
+void RunInputTests(TestContext& t)
+{
+    TestFullQueue(t);
+    TestThreads(t);
+    TestDroppedRelease(t);
+}
@@ -0,0 +1,217 @@
+#include "Tests/Tests.h"
+#include "Renderer/MeshSimplify.h"
+#include "Renderer/MeshStorage.h"
+#include "Renderer/StaticMeshes.h"
+#include "World/ECS/Component/Mesh.h"
+#include "World/ECS/Component/Transform.h"
+#include "World/ECS/System/RendererBuilder.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+
+namespace {
+
+    // Every index in range and no triangle with a repeated corner.
+    bool ValidTriangles(const std::vector<uint32_t>& indices, size_t vertexCount) {
+        if (indices.size() % 3) return false;
+        for (size_t k = 0; k < indices.size(); k += 3) {
+            const uint32_t a = indices[k], b = indices[k + 1], c = indices[k + 2];
+            if (a >= vertexCount || b >= vertexCount || c >= vertexCount || a == b || b == c || a == c)
+                return false;
+        }
+        return true;
+    }
+
+    // Signed area in the z = 0 plane; counter-clockwise is positive.
+    double PlanarArea(const std::vector<XMFLOAT3>& positions, const std::vector<uint32_t>& indices) {
+        double area = 0.0;
+        for (size_t k = 0; k < indices.size(); k += 3) {
+            const XMFLOAT3& a = positions[indices[k]];
+            const XMFLOAT3& b = positions[indices[k + 1]];
+            const XMFLOAT3& c = positions[indices[k + 2]];
+            area += 0.5 * ((double(b.x) - a.x) * (double(c.y) - a.y) - (double(c.x) - a.x) * (double(b.y) - a.y));
+        }
+        return area;
+    }
+
+    bool Uses(const std::vector<uint32_t>& indices, uint32_t v) {
+        for (uint32_t i : indices)
+            if (i == v) return true;
+        return false;
+    }
+
+    // Each level has at most `reductionPerLod` of the triangles of the one
+    // before, and its error never goes down. The chain stops at the first
+    // level that cannot reach its target instead of shipping it.
+    void TestTargets(TestContext& t) {
+        MeshData mesh = CreateTestSphere(48, 24);
+        LodSettings settings;
+        GenerateLods(mesh, settings);
+        CHECK(t, mesh.lods.size() >= 3 && mesh.lods.size() <= settings.maxLods);
+
+        size_t previous = mesh.indices.size() / 3;
+        float error = 0.0f;
+        for (const MeshLod& lod : mesh.lods) {
+            const size_t triangles = lod.indices.size() / 3;
+            CHECK(t, triangles <= size_t(previous * settings.reductionPerLod));
+            CHECK(t, triangles >= settings.minTriangles);
+            CHECK(t, ValidTriangles(lod.indices, mesh.positions.size()));
+            CHECK(t, lod.error >= error);
+            previous = triangles;
+            error = lod.error;
+        }
+
+        float simplifiedError = -1.0f;
+        const std::vector<uint32_t> simplified = SimplifyMesh(mesh.positions, mesh.indices, mesh.indices.size() / 4, &simplifiedError);
+        CHECK(t, simplified.size() <= mesh.indices.size() / 4 && !simplified.empty());
+        CHECK(t, ValidTriangles(simplified, mesh.positions.size()));
+        CHECK(t, simplifiedError > 0.0f && simplifiedError < 1.0f);
+    }
+
+    // A flat, open grid of `cells` x `cells` squares whose right half has its
+    // own copy of the middle column, like a UV seam. Returns the seam's
+    // vertices, both copies.
+    MeshData SeamedGrid(uint32_t cells, std::vector<uint32_t>& seam) {
+        MeshData mesh;
+        const uint32_t middle = cells / 2;
+        const uint32_t row = cells + 1;
+        for (uint32_t y = 0; y <= cells; ++y)
+            for (uint32_t x = 0; x <= cells; ++x)
+                mesh.positions.push_back({ float(x), float(y), 0.0f });
+        std::vector<uint32_t> copy(row);
+        for (uint32_t y = 0; y <= cells; ++y) {
+            copy[y] = uint32_t(mesh.positions.size());
+            mesh.positions.push_back({ float(middle), float(y), 0.0f });
+            seam.push_back(y * row + middle);
+            seam.push_back(copy[y]);
+        }
+
+        auto vertex = [&](uint32_t x, uint32_t y, bool right) {
+            return right && x == middle ? copy[y] : y * row + x;
+        };
+        for (uint32_t y = 0; y < cells; ++y) {
+            for (uint32_t x = 0; x < cells; ++x) {
+                const bool right = x >= middle;
+                const uint32_t a = vertex(x, y, right), b = vertex(x + 1, y, right);
+                const uint32_t c = vertex(x + 1, y + 1, right), d = vertex(x, y + 1, right);
+                mesh.indices.insert(mesh.indices.end(), { a, b, c, a, c, d });
+            }
+        }
+        return mesh;
+    }
+
+    // Collapses only move vertices onto existing ones, seam vertices never
+    // move, and the open border keeps its outline: every level covers the
+    // same area and still has both sides of the seam and all four corners.
+    void TestSeamsAndBorders(TestContext& t) {
+        constexpr uint32_t Cells = 16;
+        std::vector<uint32_t> seam;
+        MeshData mesh = SeamedGrid(Cells, seam);
+        const double area = PlanarArea(mesh.positions, mesh.indices);
+        CHECK(t, area == double(Cells * Cells));
+
+        GenerateLods(mesh);
+        CHECK(t, !mesh.lods.empty());
+        const uint32_t corners[] = { 0, Cells, Cells * (Cells + 1), (Cells + 1) * (Cells + 1) - 1 };
+        for (const MeshLod& lod : mesh.lods) {
+            CHECK(t, ValidTriangles(lod.indices, mesh.positions.size()));
+            CHECK(t, std::fabs(PlanarArea(mesh.positions, lod.indices) - area) < 1e-6 * area);
+            bool seamKept = true;
+            for (uint32_t v : seam) seamKept = seamKept && Uses(lod.indices, v);
+            CHECK(t, seamKept);
+            for (uint32_t v : corners) CHECK(t, Uses(lod.indices, v));
+        }
+    }
+
+    // The distance at which `error` projects to `pixels` for a unit sphere.
+    float DistanceFor(float error, float pixels, const Camera& camera, float viewportHeight) {
+        const float pixelsPerUnit = viewportHeight / (2.0f * std::tan(camera.fovY * 0.5f));
+        return 1.0f + pixelsPerUnit * error / pixels;
+    }
+
+    // An entity standing in the band around a threshold keeps whichever LOD
+    // it has; clearly past the threshold it switches, finer at once.
+    void TestHysteresis(TestContext& t) {
+        MeshData mesh;
+        mesh.boundsRadius = 1.0f;
+        mesh.lods = { { {}, 0.01f }, { {}, 0.04f } };
+
+        LodSelector lods;
+        LodSelector::Settings settings;
+        settings.pixelError = 1.0f;
+        settings.hysteresis = 0.25f;
+        lods.SetSettings(settings);
+
+        constexpr float Height = 720.0f;
+        constexpr Entity E = 1;
+        Camera camera;
+        camera.position = { 0.0f, 0.0f, 0.0f };
+        // LOD 1's error projected to `pixels`; LOD 2's is four times that.
+        auto select = [&](float pixels) {
+            lods.BeginFrame(camera, Height);
+            const XMFLOAT3 center = { 0.0f, 0.0f, DistanceFor(0.01f, pixels, camera, Height) };
+            return lods.Select(E, mesh, center, 1.0f);
+        };
+
+        CHECK(t, select(2.0f) == 0);
+        bool held = true;
+        for (int i = 0; i < 10; ++i)
+            held = held && select(i % 2 ? 0.8f : 0.95f) == 0; // inside (0.75, 1]: in the band
+        CHECK(t, held);
+        CHECK(t, select(0.5f) == 1);
+        for (int i = 0; i < 10; ++i)
+            held = held && select(i % 2 ? 0.8f : 0.95f) == 1;
+        CHECK(t, held);
+        CHECK(t, select(1.1f) == 0);
+        CHECK(t, select(0.1f) == 2);
+        CHECK(t, select(0.3f) == 1); // LOD 2 at 1.2 px is visibly wrong
+    }
+
+    // A crowd far away submits at most a quarter of its full-detail
+    // triangles, and fewer than the same crowd up close. stats.triangles is what Core publishes
+    // as the "triangles" frame counter, headless or not.
+    void TestDistantCrowd(TestContext& t) {
+        constexpr uint32_t Side = 10;
+        constexpr float Spacing = 4.0f;
+        World world;
+        MeshStorage meshes;
+        const MeshHandle sphere = meshes.Add(CreateTestSphere(32, 16), "sphere");
+        for (uint32_t i = 0; i < Side * Side; ++i) {
+            const Entity e = world.CreateEntity();
+            Transform tr;
+            tr.position = { float(i % Side) * Spacing, 0.0f, float(i / Side) * Spacing };
+            world.AddComponent<Transform>(e, tr);
+            world.AddComponent<Mesh>(e, Mesh{ sphere });
+        }
+
+        RenderQueue queue;
+        LodSelector lods;
+        ClusterCuller clusters;
+        auto frame = [&](float distance) {
+            Camera camera;
+            camera.target = { Side * Spacing * 0.5f, 0.0f, Side * Spacing * 0.5f };
+            camera.position = { camera.target.x, distance * 0.5f, camera.target.z - distance };
+            BuildRenderQueue(world, queue, meshes, BuildRenderView(camera, 1280.0f, 720.0f), lods, clusters);
+            return queue.GetStats();
+        };
+
+        const RenderStats near = frame(40.0f);
+        const RenderStats far = frame(600.0f);
+        CHECK(t, near.items == Side * Side && far.items == Side * Side);
+        CHECK(t, far.fullDetailTriangles == near.fullDetailTriangles);
+        CHECK(t, near.triangles <= near.fullDetailTriangles);
+        CHECK(t, far.triangles < near.triangles);
+        CHECK(t, far.triangles * 4 <= far.fullDetailTriangles);
+    }
+
+} // namespace
+
+void RunLodTests(TestContext& t)
+{
+    TestTargets(t);
+    TestSeamsAndBorders(t);
+    TestHysteresis(t);
+    TestDistantCrowd(t);
+}
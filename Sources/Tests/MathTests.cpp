@@ -0,0 +1,185 @@
+#include "Tests/Tests.h"
+#include "Bench/MathFixture.h"
+#include "Math/SimdLanes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+using namespace MathFixture;
+
+namespace {
+
+    bool Near(float a, float b) {
+        return std::fabs(a - b) <= 1e-4f * (1.0f + std::fabs(a) + std::fabs(b));
+    }
+
+    bool Near(const Mat4& a, const Mat4& b) {
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                if (!Near(a.m[r][c], b.m[r][c]))
+                    return false;
+        return true;
+    }
+
+    bool Near(const Aabb& a, const Aabb& b) {
+        for (int k = 0; k < 3; ++k)
+            if (!Near(a.min[k], b.min[k]) || !Near(a.max[k], b.max[k]))
+                return false;
+        return a.min[3] == 0.0f && a.max[3] == 0.0f;
+    }
+
+    // The box around the 8 corners, moved one by one: must be `box`.
+    bool MatchesCorners(const Aabb& local, const Mat4& m, const Aabb& box) {
+        float lo[3] = { INFINITY, INFINITY, INFINITY };
+        float hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (int corner = 0; corner < 8; ++corner) {
+            const float p[3] = { corner & 1 ? local.max[0] : local.min[0],
+                                 corner & 2 ? local.max[1] : local.min[1],
+                                 corner & 4 ? local.max[2] : local.min[2] };
+            for (int j = 0; j < 3; ++j) {
+                const float v = p[0] * m.m[0][j] + p[1] * m.m[1][j] + p[2] * m.m[2][j] + m.m[3][j];
+                lo[j] = std::min(lo[j], v);
+                hi[j] = std::max(hi[j], v);
+            }
+        }
+        for (int j = 0; j < 3; ++j)
+            if (!Near(lo[j], box.min[j]) || !Near(hi[j], box.max[j]))
+                return false;
+        return true;
+    }
+
+    // 257: not a multiple of any lane count, so every backend runs its tail.
+    constexpr uint32_t Count = 257;
+
+    // Selected backend = scalar = DirectXMath, in place too.
+    void TestMultiplyMatrices(TestContext& t) {
+        uint32_t rng = t.Seed();
+        const std::vector<Mat4> worlds = RandomWorlds(Count, rng);
+        const Mat4 vp = ViewProj();
+
+        std::vector<Mat4> simd(Count), scalar(Count), inPlace = worlds;
+        Simd::MultiplyMatrices(worlds.data(), vp, simd.data(), Count);
+        Simd::Scalar::MultiplyMatrices(worlds.data(), vp, scalar.data(), Count);
+        Simd::MultiplyMatrices(inPlace.data(), vp, inPlace.data(), Count);
+        XMFLOAT4X4 vpf;
+        std::memcpy(&vpf, &vp, sizeof(vpf));
+        for (uint32_t i = 0; i < Count; ++i) {
+            XMFLOAT4X4 wf;
+            std::memcpy(&wf, &worlds[i], sizeof(wf));
+            const Mat4 dx = ToMat4(XMMatrixMultiply(XMLoadFloat4x4(&wf), XMLoadFloat4x4(&vpf)));
+            CHECK(t, Near(simd[i], scalar[i]));
+            CHECK(t, Near(dx, scalar[i]));
+            CHECK(t, std::memcmp(&simd[i], &inPlace[i], sizeof(Mat4)) == 0);
+        }
+    }
+
+    // Boxes against the scalar kernel and against their corners: the box
+    // must hold all of them and touch each of its faces.
+    void TestTransformAabbs(TestContext& t) {
+        uint32_t rng = t.Seed();
+        const std::vector<Mat4> worlds = RandomWorlds(Count, rng);
+        const std::vector<Aabb> boxes = RandomBoxes(Count, rng);
+
+        std::vector<Aabb> simd(Count), scalar(Count), oneMatrix(Count), inPlace = boxes;
+        Simd::TransformAabbs(boxes.data(), worlds.data(), simd.data(), Count);
+        Simd::Scalar::TransformAabbs(boxes.data(), worlds.data(), scalar.data(), Count);
+        Simd::TransformAabbs(inPlace.data(), worlds.data(), inPlace.data(), Count);
+        Simd::TransformAabbs(boxes.data(), worlds[0], oneMatrix.data(), Count);
+        for (uint32_t i = 0; i < Count; ++i) {
+            CHECK(t, Near(simd[i], scalar[i]));
+            CHECK(t, MatchesCorners(boxes[i], worlds[i], simd[i]));
+            CHECK(t, std::memcmp(&simd[i], &inPlace[i], sizeof(Aabb)) == 0);
+            CHECK(t, MatchesCorners(boxes[i], worlds[0], oneMatrix[i]));
+        }
+    }
+
+    // Short arrays: the tails of the wide loops, and nothing written past `count`.
+    void TestTails(TestContext& t) {
+        uint32_t rng = t.Seed();
+        const std::vector<Mat4> worlds = RandomWorlds(16, rng);
+        const std::vector<Aabb> boxes = RandomBoxes(16, rng);
+        const Mat4 vp = ViewProj();
+        std::vector<Mat4> scalar(16);
+        std::vector<Aabb> scalarBoxes(16);
+        Simd::Scalar::MultiplyMatrices(worlds.data(), vp, scalar.data(), 16);
+        Simd::Scalar::TransformAabbs(boxes.data(), worlds.data(), scalarBoxes.data(), 16);
+
+        for (uint32_t count = 0; count <= 9; ++count) {
+            std::vector<Mat4> m(count + 1);
+            std::vector<Aabb> b(count + 1);
+            Mat4 guard;
+            Aabb boxGuard;
+            std::memset(&guard, 0x7F, sizeof(guard));
+            std::memset(&boxGuard, 0x7F, sizeof(boxGuard));
+            m[count] = guard;
+            b[count] = boxGuard;
+            Simd::MultiplyMatrices(worlds.data(), vp, m.data(), count);
+            Simd::TransformAabbs(boxes.data(), worlds.data(), b.data(), count);
+            for (uint32_t i = 0; i < count; ++i)
+                CHECK(t, Near(m[i], scalar[i]) && Near(b[i], scalarBoxes[i]));
+            CHECK(t, std::memcmp(&m[count], &guard, sizeof(guard)) == 0);
+            CHECK(t, std::memcmp(&b[count], &boxGuard, sizeof(boxGuard)) == 0);
+        }
+    }
+
+    // The SoA lane helpers, lane by lane against plain floats: what the
+    // physics and particle kernels are written with.
+    void TestLanes(TestContext& t) {
+        uint32_t rng = t.Seed();
+        bool same = true;
+        for (int round = 0; round < 64; ++round) {
+            float a[4], b[4], c[4], out[4];
+            for (int k = 0; k < 4; ++k) {
+                a[k] = Bench::RandomFloat(rng) * 20.0f - 10.0f;
+                b[k] = k == round % 4 ? a[k] : Bench::RandomFloat(rng) * 20.0f - 10.0f; // one lane equal
+                c[k] = Bench::RandomFloat(rng) * 2.0f - 1.0f;
+            }
+            const Simd::Float4 va = Simd::Load4(a), vb = Simd::Load4(b), vc = Simd::Load4(c);
+            auto lanes = [&](Simd::Float4 v, auto expected) {
+                Simd::Store4(out, v);
+                for (int k = 0; k < 4; ++k)
+                    same = same && Near(out[k], expected(k));
+            };
+            lanes(Simd::Add(va, vb), [&](int k) { return a[k] + b[k]; });
+            lanes(Simd::Sub(va, vb), [&](int k) { return a[k] - b[k]; });
+            lanes(Simd::Mul(va, vb), [&](int k) { return a[k] * b[k]; });
+            lanes(Simd::MulAdd(va, vb, vc), [&](int k) { return a[k] * b[k] + c[k]; });
+            lanes(Simd::Min(va, vb), [&](int k) { return std::min(a[k], b[k]); });
+            lanes(Simd::Max(va, vb), [&](int k) { return std::max(a[k], b[k]); });
+            lanes(Simd::Abs(va), [&](int k) { return std::fabs(a[k]); });
+            lanes(Simd::Negate(va), [&](int k) { return -a[k]; });
+            lanes(Simd::Splat(c[1]), [&](int) { return c[1]; });
+            lanes(Simd::Set(a[3], b[2], c[1], 7.0f), [&](int k) { return k == 0 ? a[3] : k == 1 ? b[2] : k == 2 ? c[1] : 7.0f; });
+
+            const int less = Simd::Mask(Simd::Less(va, vb));
+            const int greater = Simd::Mask(Simd::Greater(va, vb));
+            const int greaterOrEqual = Simd::Mask(Simd::GreaterOrEqual(va, vb));
+            for (int k = 0; k < 4; ++k) {
+                same = same && ((less >> k & 1) != 0) == (a[k] < b[k]);
+                same = same && ((greater >> k & 1) != 0) == (a[k] > b[k]);
+                same = same && ((greaterOrEqual >> k & 1) != 0) == (a[k] >= b[k]);
+            }
+            lanes(Simd::Select(va, vb, Simd::Less(va, vb)), [&](int k) { return a[k] < b[k] ? b[k] : a[k]; });
+
+            Simd::Float4 r0 = va, r1 = vb, r2 = vc, r3 = Simd::Splat(5.0f);
+            Simd::Transpose(r0, r1, r2, r3);
+            const Simd::Float4 columns[] = { r0, r1, r2, r3 };
+            for (int k = 0; k < 4; ++k)
+                lanes(columns[k], [&](int row) { return row == 0 ? a[k] : row == 1 ? b[k] : row == 2 ? c[k] : 5.0f; });
+        }
+        CHECK(t, same);
+        CHECK(t, Simd::RoundUp4(0) == 0 && Simd::RoundUp4(1) == 4 && Simd::RoundUp4(8) == 8 && Simd::RoundUp4(9) == 12);
+    }
+
+} // namespace
+
+void RunMathTests(TestContext& t)
+{
+    TestMultiplyMatrices(t);
+    TestTransformAabbs(t);
+    TestTails(t);
+    TestLanes(t);
+}
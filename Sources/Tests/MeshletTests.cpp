@@ -0,0 +1,226 @@
+#include "Tests/Tests.h"
+#include "Renderer/ClusterCulling.h"
+#include "Renderer/MeshData.h"
+#include "Renderer/Meshlets.h"
+#include "Renderer/StaticMeshes.h"
+#include "Threading/JobSystem.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+
+namespace {
+
+    using Triangle = std::array<uint32_t, 3>;
+
+    // Rotated so the smallest index comes first: same triangle, same
+    // winding, one spelling.
+    std::vector<Triangle> SortedTriangles(const std::vector<uint32_t>& indices, size_t first, size_t count) {
+        std::vector<Triangle> out;
+        for (size_t k = first; k < first + count; k += 3) {
+            Triangle tri = { indices[k], indices[k + 1], indices[k + 2] };
+            std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+            out.push_back(tri);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    float PlaneDistance(const XMFLOAT4& p, const XMFLOAT3& v) {
+        return p.x * v.x + p.y * v.y + p.z * v.z + p.w;
+    }
+
+    Frustum Look(const XMFLOAT3& from, const XMFLOAT3& at, float fovY) {
+        const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(from.x, from.y, from.z, 1.0f),
+                                               XMVectorSet(at.x, at.y, at.z, 1.0f),
+                                               XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        return BuildFrustum(XMMatrixMultiply(view, XMMatrixPerspectiveFovLH(fovY, 16.0f / 9.0f, 0.1f, 1000.0f)));
+    }
+
+    // A flat grid in the XZ plane, `cells` squares a side, one unit each.
+    MeshData Plane(uint32_t cells) {
+        MeshData mesh;
+        const uint32_t row = cells + 1;
+        for (uint32_t z = 0; z <= cells; ++z)
+            for (uint32_t x = 0; x <= cells; ++x)
+                mesh.positions.push_back({ float(x), 0.0f, float(z) });
+        for (uint32_t z = 0; z < cells; ++z) {
+            for (uint32_t x = 0; x < cells; ++x) {
+                const uint32_t a = z * row + x;
+                mesh.indices.insert(mesh.indices.end(), { a, a + row, a + row + 1, a, a + row + 1, a + 1 });
+            }
+        }
+        return mesh;
+    }
+
+    // Every meshlet fits the GPU limits, its bounding sphere holds its
+    // vertices, and the meshlets tile the reordered index buffer: together
+    // they are every original triangle exactly once.
+    void TestLimitsAndCoverage(TestContext& t) {
+        for (MeshData mesh : { CreateTestSphere(64, 32), Plane(48) }) {
+            const std::vector<Triangle> original = SortedTriangles(mesh.indices, 0, mesh.indices.size());
+            BuildMeshlets(mesh);
+            CHECK(t, !mesh.meshlets.empty());
+
+            bool limits = true, bounds = true, tiled = true;
+            uint32_t next = 0;
+            for (const Meshlet& m : mesh.meshlets) {
+                std::vector<uint32_t> used(mesh.indices.begin() + m.firstIndex, mesh.indices.begin() + m.firstIndex + m.triangleCount * 3);
+                std::sort(used.begin(), used.end());
+                used.erase(std::unique(used.begin(), used.end()), used.end());
+                limits = limits && m.triangleCount >= 1 && m.triangleCount <= MeshletMaxTriangles
+                    && m.vertexCount <= MeshletMaxVertices && used.size() == m.vertexCount;
+
+                for (uint32_t v : used) {
+                    const XMFLOAT3& p = mesh.positions[v];
+                    const float dx = p.x - m.center.x, dy = p.y - m.center.y, dz = p.z - m.center.z;
+                    bounds = bounds && std::sqrt(dx * dx + dy * dy + dz * dz) <= m.radius * 1.0001f + 1e-5f;
+                }
+                tiled = tiled && m.firstIndex == next;
+                next = m.firstIndex + m.triangleCount * 3;
+            }
+            CHECK(t, limits);
+            CHECK(t, bounds);
+            CHECK(t, tiled && next == mesh.indices.size());
+            CHECK(t, SortedTriangles(mesh.indices, 0, mesh.indices.size()) == original);
+        }
+    }
+
+    // Looking down at one corner of a large plane: no meshlet with a vertex
+    // in view is dropped, every meshlet well outside one plane is, and the
+    // visible ranges hold exactly the visible meshlets' triangles.
+    void TestFrustum(TestContext& t) {
+        MeshData mesh = Plane(128);
+        BuildMeshlets(mesh);
+        const Frustum frustum = Look({ 20.0f, 12.0f, 10.0f }, { 24.0f, 0.0f, 20.0f }, XM_PIDIV4);
+
+        ClusterCuller culler;
+        const ClusterCullResult r = culler.Cull(mesh, XMMatrixIdentity(), frustum, { 20.0f, 12.0f, 10.0f });
+        CHECK(t, r.tested == mesh.meshlets.size());
+        CHECK(t, r.visible > 0 && r.visible < r.tested / 2);
+
+        std::vector<uint8_t> drawn(mesh.indices.size() / 3, 0);
+        uint32_t drawnTriangles = 0;
+        for (const IndexRange& range : culler.GetRanges()) {
+            for (uint32_t k = range.firstIndex; k < range.firstIndex + range.indexCount; k += 3)
+                drawn[k / 3] = 1;
+            drawnTriangles += range.indexCount / 3;
+        }
+        CHECK(t, drawnTriangles == r.visibleTriangles);
+
+        bool keepsInside = true, rejectsOutside = true;
+        for (const Meshlet& m : mesh.meshlets) {
+            bool anyInside = false;
+            float farthestBehind = 0.0f; // over planes: how far the nearest vertex is behind it
+            for (const XMFLOAT4& plane : frustum.planes) {
+                float nearest = -1e30f;
+                for (uint32_t k = m.firstIndex; k < m.firstIndex + m.triangleCount * 3; ++k)
+                    nearest = std::max(nearest, PlaneDistance(plane, mesh.positions[mesh.indices[k]]));
+                farthestBehind = std::max(farthestBehind, -nearest);
+            }
+            for (uint32_t k = m.firstIndex; k < m.firstIndex + m.triangleCount * 3 && !anyInside; ++k) {
+                bool inside = true;
+                for (const XMFLOAT4& plane : frustum.planes)
+                    inside = inside && PlaneDistance(plane, mesh.positions[mesh.indices[k]]) >= 0.0f;
+                anyInside = inside;
+            }
+            const bool visible = drawn[m.firstIndex / 3] != 0;
+            if (anyInside) keepsInside = keepsInside && visible;
+            // All vertices more than the diameter behind one plane: so is the sphere.
+            if (farthestBehind > 2.0f * m.radius) rejectsOutside = rejectsOutside && !visible;
+        }
+        CHECK(t, keepsInside);
+        CHECK(t, rejectsOutside);
+
+        // Looking away from the plane: nothing is left.
+        const ClusterCullResult away = culler.Cull(mesh, XMMatrixIdentity(),
+            Look({ 64.0f, 5.0f, -10.0f }, { 64.0f, 5.0f, -20.0f }, XM_PIDIV4), { 64.0f, 5.0f, -10.0f });
+        CHECK(t, away.visible == 0 && culler.GetRanges().empty());
+    }
+
+    // A closed sphere seen from outside, all of it in view: the cone test
+    // drops a good share of the far side and never a meshlet with a triangle
+    // facing the camera. Switched off, everything is drawn.
+    void TestBackface(TestContext& t) {
+        MeshData mesh = CreateTestSphere(96, 48);
+        BuildMeshlets(mesh);
+        const XMFLOAT3 eye = { 0.0f, 1.0f, -8.0f };
+        const Frustum frustum = Look(eye, { 0.0f, 0.0f, 0.0f }, XM_PIDIV4);
+
+        ClusterCuller culler;
+        const ClusterCullResult all = culler.Cull(mesh, XMMatrixIdentity(), frustum, eye);
+        CHECK(t, all.visible == all.tested);
+
+        ClusterCullSettings settings;
+        settings.backface = true;
+        culler.SetSettings(settings);
+        const ClusterCullResult culled = culler.Cull(mesh, XMMatrixIdentity(), frustum, eye);
+        CHECK(t, culled.visible < culled.tested * 3 / 4);
+
+        std::vector<uint8_t> drawn(mesh.indices.size() / 3, 0);
+        for (const IndexRange& range : culler.GetRanges())
+            for (uint32_t k = range.firstIndex; k < range.firstIndex + range.indexCount; k += 3)
+                drawn[k / 3] = 1;
+
+        bool noFrontDropped = true;
+        for (const Meshlet& m : mesh.meshlets) {
+            if (drawn[m.firstIndex / 3]) continue;
+            for (uint32_t k = m.firstIndex; k < m.firstIndex + m.triangleCount * 3; k += 3) {
+                const XMFLOAT3& a = mesh.positions[mesh.indices[k]];
+                const XMFLOAT3& b = mesh.positions[mesh.indices[k + 1]];
+                const XMFLOAT3& c = mesh.positions[mesh.indices[k + 2]];
+                const XMFLOAT3 e1 = { b.x - a.x, b.y - a.y, b.z - a.z }, e2 = { c.x - a.x, c.y - a.y, c.z - a.z };
+                const XMFLOAT3 n = { e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+                // Front facing: the camera is on the side the normal points to.
+                if (n.x * (eye.x - a.x) + n.y * (eye.y - a.y) + n.z * (eye.z - a.z) > 0.0f)
+                    noFrontDropped = false;
+            }
+        }
+        CHECK(t, noFrontDropped);
+    }
+
+    // Enough meshlets for the jobs, the same ranges as one thread.
+    void TestParallelMatchesSerial(TestContext& t) {
+        MeshData mesh = CreateTestSphere(256, 128);
+        BuildMeshlets(mesh);
+        JobSystem jobs(3);
+
+        ClusterCullSettings settings;
+        settings.backface = true;
+        settings.parallelThreshold = 1;
+        settings.meshletsPerJob = 16;
+        ClusterCuller serial, parallel;
+        serial.SetSettings(settings);
+        parallel.SetSettings(settings);
+        parallel.SetJobSystem(&jobs);
+
+        const XMFLOAT3 eyes[] = { { 0.0f, 0.5f, -3.0f }, { 2.5f, 2.0f, 0.5f }, { 0.2f, -4.0f, 0.1f } };
+        for (const XMFLOAT3& eye : eyes) {
+            const Frustum frustum = Look(eye, { 0.3f, 0.0f, 0.0f }, XM_PIDIV4 * 0.5f);
+            const XMMATRIX world = XMMatrixTranslation(0.0f, 0.25f, 0.0f);
+            const ClusterCullResult a = serial.Cull(mesh, world, frustum, eye);
+            const ClusterCullResult b = parallel.Cull(mesh, world, frustum, eye);
+            CHECK(t, mesh.meshlets.size() > settings.meshletsPerJob * 8);
+            CHECK(t, a.visible == b.visible && a.visibleTriangles == b.visibleTriangles);
+            CHECK(t, a.visible > 0 && a.visible < a.tested);
+
+            bool same = serial.GetRanges().size() == parallel.GetRanges().size();
+            for (size_t i = 0; same && i < serial.GetRanges().size(); ++i)
+                same = serial.GetRanges()[i].firstIndex == parallel.GetRanges()[i].firstIndex
+                    && serial.GetRanges()[i].indexCount == parallel.GetRanges()[i].indexCount;
+            CHECK(t, same);
+        }
+    }
+
+} // namespace
+
+void RunMeshletTests(TestContext& t)
+{
+    TestLimitsAndCoverage(t);
+    TestFrustum(t);
+    TestBackface(t);
+    TestParallelMatchesSerial(t);
+}
@@ -0,0 +1,166 @@
+#include "Tests/Tests.h"
+#include "Bench/ParticleFixture.h"
+#include "Threading/JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+using namespace ParticleFixture;
+
+namespace {
+
+    bool Near(float a, float b, float eps) { return std::fabs(a - b) <= eps * std::max(1.0f, std::fabs(b)); }
+
+    // No spread, no deaths: every particle born in the same frame is in the
+    // same place, which the formula gives one float at a time.
+    void TestIntegration(TestContext& t) {
+        Scene s;
+        ParticleEmitterDesc d;
+        d.position = { 1.0f, 2.0f, 3.0f };
+        d.velocity = { 1.5f, 8.0f, -0.5f };
+        d.velocitySpread = 0.0f;
+        d.gravity = { 0.5f, -9.81f, 0.25f };
+        d.drag = 0.3f;
+        d.rate = 0.0f;
+        d.lifetimeMin = d.lifetimeMax = 100.0f;
+        d.mesh = s.meshes.Add(CreateTestCube(), "cube");
+        const EmitterHandle h = s.system.AddEmitter(d);
+
+        // Born in Update f (bursts of 1..7, so the last group of 4 is partial).
+        const uint32_t steps = 40;
+        std::vector<uint32_t> bornAt;
+        for (uint32_t f = 0; f < steps; ++f) {
+            const uint32_t burst = 1 + f % 7;
+            s.system.Burst(h, burst);
+            s.system.Update(Dt);
+            bornAt.insert(bornAt.end(), burst, f);
+        }
+        if (!CHECK(t, s.system.LiveCount(h) == bornAt.size()))
+            return;
+
+        const float damping = 1.0f / (1.0f + d.drag * Dt);
+        for (uint32_t i = 0; i < bornAt.size(); ++i) {
+            float p[3] = { d.position.x, d.position.y, d.position.z };
+            float v[3] = { d.velocity.x, d.velocity.y, d.velocity.z };
+            const float g[3] = { d.gravity.x * Dt, d.gravity.y * Dt, d.gravity.z * Dt };
+            float age = 0.0f;
+            for (uint32_t f = bornAt[i] + 1; f < steps; ++f) {
+                for (int c = 0; c < 3; ++c) {
+                    v[c] = (v[c] + g[c]) * damping;
+                    p[c] += v[c] * Dt;
+                }
+                age += Dt;
+            }
+            const XMFLOAT3 got = s.system.GetParticlePosition(h, i);
+            CHECK(t, Near(got.x, p[0], 1e-5f) && Near(got.y, p[1], 1e-5f) && Near(got.z, p[2], 1e-5f));
+            CHECK(t, Near(s.system.GetParticleAge(h, i), age, 1e-5f));
+        }
+    }
+
+    // One lifetime for all: the ages that should be alive are known exactly.
+    // Particles fly along x at speed 1 from the origin, so x == age shows that
+    // every particle was moved into its hole as a whole.
+    void TestCompaction(TestContext& t) {
+        Scene s;
+        ParticleEmitterDesc d;
+        d.position = { 0.0f, 0.0f, 0.0f };
+        d.velocity = { 1.0f, 0.0f, 0.0f };
+        d.velocitySpread = 0.0f;
+        d.gravity = { 0.0f, 0.0f, 0.0f };
+        d.rate = 0.0f;
+        d.lifetimeMin = d.lifetimeMax = 0.3f;
+        d.mesh = s.meshes.Add(CreateTestCube(), "cube");
+        const EmitterHandle h = s.system.AddEmitter(d);
+        const float invLife = 1.0f / d.lifetimeMin;
+
+        std::vector<float> expected, got;
+        for (uint32_t f = 0; f < 90; ++f) {
+            const uint32_t burst = (f * 7) % 11;
+            s.system.Burst(h, burst);
+            s.system.Update(Dt);
+
+            for (float& age : expected)
+                age += Dt;
+            expected.erase(std::remove_if(expected.begin(), expected.end(),
+                [invLife](float age) { return age * invLife >= 1.0f; }), expected.end());
+            expected.insert(expected.end(), burst, 0.0f);
+
+            got.clear();
+            for (uint32_t i = 0; i < s.system.LiveCount(h); ++i) {
+                const float age = s.system.GetParticleAge(h, i);
+                CHECK(t, Near(s.system.GetParticlePosition(h, i).x, age, 1e-4f));
+                got.push_back(age);
+            }
+            std::vector<float> want = expected;
+            std::sort(want.begin(), want.end());
+            std::sort(got.begin(), got.end());
+            CHECK(t, got == want);
+        }
+    }
+
+    // Every instanced item against the particles of its emitter.
+    bool InstancesMatch(const Scene& s) {
+        const auto& instances = s.queue.GetInstances();
+        size_t item = 0;
+        uint32_t checked = 0;
+        for (EmitterHandle h : s.emitters) {
+            const uint32_t live = s.system.LiveCount(h);
+            if (live == 0)
+                continue;
+            while (item < s.queue.GetItems().size() && s.queue.GetItems()[item].instanceCount == 0)
+                ++item;
+            if (item == s.queue.GetItems().size())
+                return false;
+            const RenderItem& it = s.queue.GetItems()[item++];
+            if (it.instanceCount != live)
+                return false;
+
+            const ParticleEmitterDesc& d = *s.system.GetDesc(h);
+            const float lo = std::min(d.startSize, d.endSize), hi = std::max(d.startSize, d.endSize);
+            for (uint32_t i = 0; i < live; ++i) {
+                const RenderInstance& r = instances[it.firstInstance + i];
+                const XMFLOAT3 p = s.system.GetParticlePosition(h, i);
+                if (r.x != p.x || r.y != p.y || r.z != p.z || r.w < lo - 1e-6f || r.w > hi + 1e-6f)
+                    return false;
+            }
+            ++checked;
+        }
+        return checked > 0;
+    }
+
+    // The jobs must give exactly what one thread gives.
+    void TestParallelUpdate(TestContext& t) {
+        JobSystem jobs;
+        Scene parallel, serial;
+        BuildScene(parallel, 7, 3001, t.Seed());
+        BuildScene(serial, 7, 3001, t.Seed());
+
+        ParticleSettings ps;
+        ps.parallelThreshold = 64; // small emitters, but still exercise the jobs
+        ps.particlesPerJob = 1000;
+        parallel.system.SetSettings(ps);
+        parallel.system.SetJobSystem(&jobs);
+
+        for (uint32_t step = 0; step < 120; ++step) {
+            Frame(parallel);
+            Frame(serial);
+            CHECK(t, InstancesMatch(parallel));
+
+            const auto& pi = parallel.queue.GetInstances();
+            const auto& si = serial.queue.GetInstances();
+            CHECK(t, parallel.system.GetStats().live == serial.system.GetStats().live);
+            CHECK(t, pi.size() == si.size() && std::memcmp(pi.data(), si.data(), pi.size() * sizeof(RenderInstance)) == 0);
+        }
+    }
+
+} // namespace
+
+void RunParticleTests(TestContext& t)
+{
+    TestIntegration(t);
+    TestCompaction(t);
+    TestParallelUpdate(t);
+}
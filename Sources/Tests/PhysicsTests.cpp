@@ -0,0 +1,135 @@
+#include "Tests/Tests.h"
+#include "Bench/PhysicsFixture.h"
+#include "Threading/JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+using namespace PhysicsFixture;
+
+namespace {
+
+    std::vector<Pair> Sorted(const EcsVector<Pair>& pairs) {
+        std::vector<Pair> out(pairs.begin(), pairs.end());
+        std::sort(out.begin(), out.end(), [](const Pair& x, const Pair& y) { return x.a < y.a || (x.a == y.a && x.b < y.b); });
+        return out;
+    }
+
+    bool SamePairs(const std::vector<Pair>& x, const std::vector<Pair>& y) {
+        return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin(),
+            [](const Pair& p, const Pair& q) { return p.a == q.a && p.b == q.b; });
+    }
+
+    // Every pair of boxes that overlap, the slow way.
+    bool PairsMatch(const PhysicsWorld& physics, const std::vector<RigidBodyDesc>& descs) {
+        std::vector<Pair> expected;
+        const uint32_t n = physics.Size();
+        for (uint32_t a = 0; a < n; ++a) {
+            const XMFLOAT3 pa = physics.GetPosition(physics.GetEntity(a));
+            const RigidBodyDesc& da = descs[physics.GetEntity(a)];
+            for (uint32_t b = a + 1; b < n; ++b) {
+                const XMFLOAT3 pb = physics.GetPosition(physics.GetEntity(b));
+                const RigidBodyDesc& db = descs[physics.GetEntity(b)];
+                const float r = da.radius + db.radius;
+                if (std::fabs(pa.x - pb.x) > r || std::fabs(pa.y - pb.y) > r || std::fabs(pa.z - pb.z) > r) continue;
+                if (da.mass == 0.0f && db.mass == 0.0f) continue;
+                expected.push_back({ a, b });
+            }
+        }
+        return SamePairs(Sorted(physics.GetPairs()), expected);
+    }
+
+    // The SIMD integrator against the formula, one body at a time.
+    bool IntegrateMatches(PhysicsWorld& physics, const std::vector<RigidBodyDesc>& descs, float dt) {
+        const PhysicsSettings& s = physics.GetSettings();
+        const uint32_t n = physics.Size();
+        std::vector<XMFLOAT3> p(n), v(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            p[i] = physics.GetPosition(physics.GetEntity(i));
+            v[i] = physics.GetVelocity(physics.GetEntity(i));
+        }
+        physics.Integrate(dt);
+
+        const float damping = 1.0f / (1.0f + s.linearDamping * dt);
+        auto axis = [&](float& pos, float& vel, float g, float lo, float hi, float r, float e) {
+            vel = (vel + g * dt) * damping;
+            pos += vel * dt;
+            if (pos < lo + r) vel = std::fabs(vel) * e;
+            if (pos > hi - r) vel = -std::fabs(vel) * e;
+            pos = std::max(std::min(pos, hi - r), lo + r);
+        };
+        for (uint32_t i = 0; i < n; ++i) {
+            const RigidBodyDesc& d = descs[physics.GetEntity(i)];
+            if (d.mass > 0.0f) {
+                axis(p[i].x, v[i].x, s.gravity.x, s.boundsMin.x, s.boundsMax.x, d.radius, d.restitution);
+                axis(p[i].y, v[i].y, s.gravity.y, s.boundsMin.y, s.boundsMax.y, d.radius, d.restitution);
+                axis(p[i].z, v[i].z, s.gravity.z, s.boundsMin.z, s.boundsMax.z, d.radius, d.restitution);
+            }
+            const XMFLOAT3 gp = physics.GetPosition(physics.GetEntity(i));
+            const XMFLOAT3 gv = physics.GetVelocity(physics.GetEntity(i));
+            auto near = [](float x, float y) { return std::fabs(x - y) <= 1e-4f * (1.0f + std::fabs(y)); };
+            if (!near(gp.x, p[i].x) || !near(gp.y, p[i].y) || !near(gp.z, p[i].z) ||
+                !near(gv.x, v[i].x) || !near(gv.y, v[i].y) || !near(gv.z, v[i].z))
+                return false;
+        }
+        return true;
+    }
+
+    void TestStep(TestContext& t) {
+        JobSystem jobs;
+        const uint32_t count = 2000;
+        uint32_t rng = t.Seed();
+        World world;
+        PhysicsWorld physics;
+        PhysicsSettings s;
+        s.parallelThreshold = 64; // small world, but still exercise the jobs
+        s.bodiesPerJob = 128;
+        s.pairsPerJob = 64;
+        physics.SetSettings(s);
+        physics.SetJobSystem(&jobs);
+        // Bigger spheres than the benchmark's: more pairs per body to check.
+        std::vector<RigidBodyDesc> descs;
+        FillWorld(world, physics, count, 2.0f, 0.1f, rng, &descs);
+
+        const float dt = 1.0f / 60.0f;
+        for (uint32_t step = 0; step < 30; ++step) {
+            CHECK(t, IntegrateMatches(physics, descs, dt));
+            physics.FindPairs();
+            CHECK(t, PairsMatch(physics, descs));
+
+            // The parallel narrowphase must give exactly what one thread gives.
+            physics.FindContacts();
+            const std::vector<Pair> parallel(physics.GetContacts().begin(), physics.GetContacts().end());
+            physics.SetJobSystem(nullptr);
+            physics.FindContacts();
+            physics.SetJobSystem(&jobs);
+            CHECK(t, SamePairs(parallel, std::vector<Pair>(physics.GetContacts().begin(), physics.GetContacts().end())));
+            physics.SolveContacts();
+        }
+
+        // Removing bodies renumbers the last ones; the broadphase must follow.
+        for (Entity e = 1; e <= count; e += 7)
+            physics.RemoveBody(e);
+        physics.Integrate(dt);
+        physics.FindPairs();
+        CHECK(t, PairsMatch(physics, descs));
+
+        physics.WriteTransforms(world);
+        bool written = true;
+        for (uint32_t i = 0; i < physics.Size(); ++i) {
+            const Entity e = physics.GetEntity(i);
+            const XMFLOAT3 p = physics.GetPosition(e);
+            const XMFLOAT3& tp = world.GetComponent<Transform>(e).position;
+            written = written && p.x == tp.x && p.y == tp.y && p.z == tp.z;
+        }
+        CHECK(t, written);
+    }
+
+} // namespace
+
+void RunPhysicsTests(TestContext& t)
+{
+    TestStep(t);
+}
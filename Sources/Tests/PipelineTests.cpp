@@ -0,0 +1,134 @@
+#include "Tests/Tests.h"
+#include "Renderer/MeshStorage.h"
+#include "Renderer/NullRenderer.h"
+#include "Renderer/PipelineState.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/StaticMeshes.h"
+
+#include <set>
+
+using namespace DirectX;
+
+namespace {
+
+    XMFLOAT4X4 At(float x, float z) {
+        XMFLOAT4X4 world;
+        XMStoreFloat4x4(&world, XMMatrixTranslation(x, 0.0f, z));
+        return world;
+    }
+
+    // One frame of `queue` through a fresh-enough renderer.
+    void DrawFrame(NullRenderer& renderer, const RenderQueue& queue) {
+        renderer.BeginFrame(0.0f, 0.0f, 0.0f, 1.0f);
+        renderer.Draw(queue);
+        renderer.EndFrame();
+    }
+
+    struct Scene {
+        MeshStorage meshes;
+        NullRenderer renderer;
+        MeshHandle sphere = InvalidMesh;
+
+        Scene() {
+            sphere = meshes.Add(CreateTestSphere(16, 8), "PipelineSphere");
+            renderer.SetMeshStorage(&meshes);
+            renderer.Resize(1280, 720);
+            Camera camera;
+            camera.position = { 0.0f, 5.0f, -20.0f };
+            camera.target = { 0.0f, 0.0f, 0.0f };
+            renderer.SetCamera(camera);
+        }
+    };
+
+    // The same desc is the same pipeline, and only a new one says so.
+    void TestCache(TestContext& t) {
+        PipelineCache cache;
+        bool created = false;
+        const PipelineDesc packed = PipelineDesc::ForMesh(VertexFormat::Packed, false, false);
+        const PipelineHandle a = cache.Get(packed, &created);
+        CHECK(t, a != InvalidPipeline && created);
+        CHECK(t, cache.Get(packed, &created) == a && !created);
+        CHECK(t, cache.Get(PipelineDesc::ForMesh(VertexFormat::Packed, false, false)) == a);
+
+        // Skinned vertices are Float3 whatever the mesh stores.
+        const PipelineHandle skinned = cache.Get(PipelineDesc::ForMesh(VertexFormat::Packed, true, false), &created);
+        CHECK(t, skinned != a && created);
+        CHECK(t, cache.Get(PipelineDesc::ForMesh(VertexFormat::Float3, false, false)) == skinned);
+        CHECK(t, cache.GetDesc(a).Key() == packed.Key() && cache.Count() == 2);
+
+        cache.Clear();
+        CHECK(t, cache.Count() == 0 && cache.Get(packed, &created) == a && created);
+    }
+
+    // A run of items with the same mesh binds everything once: the rest is
+    // skipped, however long the run. Plain, skinned and instanced items
+    // ask for one pipeline each, the same ones every frame.
+    void TestQueueBinds(TestContext& t) {
+        Scene scene;
+        auto grid = [&](uint32_t count) {
+            RenderQueue queue;
+            for (uint32_t i = 0; i < count; ++i)
+                queue.Submit(At(float(i % 10) * 2.0f - 9.0f, float(i / 10) * 2.0f), scene.sphere, 0);
+            return queue;
+        };
+
+        RenderQueue small = grid(10), large = grid(100);
+        DrawFrame(scene.renderer, small);
+        DrawFrame(scene.renderer, small); // uploaded by now
+        const RendererStats smallStats = scene.renderer.GetStats();
+        DrawFrame(scene.renderer, large);
+        const RendererStats& largeStats = scene.renderer.GetStats();
+        CHECK(t, smallStats.draws == 10 && largeStats.draws == 100 && largeStats.notReady == 0);
+        CHECK(t, largeStats.bindsSkipped > 0 && largeStats.bindsIssued == smallStats.bindsIssued);
+        CHECK(t, largeStats.bindsSkipped - smallStats.bindsSkipped == 90 * 8); // 3 buffers + 5 pipeline slots per draw
+        CHECK(t, scene.renderer.GetPipelines().Count() == 1);
+
+        RenderQueue mixed = grid(20);
+        const uint32_t firstVertex = mixed.AllocateVertices(uint32_t(scene.meshes.Get(scene.sphere)->positions.size()));
+        mixed.SubmitSkinned(At(0.0f, -4.0f), scene.sphere, 0, firstVertex, 1);
+        const uint32_t firstInstance = mixed.AllocateInstances(8);
+        mixed.SubmitInstanced(At(0.0f, 0.0f), scene.sphere, 0, firstInstance, 8);
+        for (uint32_t i = 0; i < 20; ++i)
+            mixed.Submit(At(float(i) - 10.0f, 30.0f), scene.sphere, 0);
+
+        std::set<uint64_t> keys;
+        const VertexFormat format = scene.meshes.Get(scene.sphere)->vertexStream.format;
+        for (const RenderItem& item : mixed.GetItems())
+            keys.insert(PipelineDesc::ForMesh(format, item.firstVertex != RenderItem::NoVertices, item.instanceCount != 0).Key());
+
+        DrawFrame(scene.renderer, mixed);
+        const uint32_t pipelines = scene.renderer.GetPipelines().Count();
+        CHECK(t, pipelines == keys.size() && pipelines == 3);
+        CHECK(t, scene.renderer.GetStats().draws == 42);
+        DrawFrame(scene.renderer, mixed);
+        CHECK(t, scene.renderer.GetPipelines().Count() == pipelines);
+        CHECK(t, scene.renderer.GetStats().bindsSkipped > scene.renderer.GetStats().bindsIssued);
+    }
+
+    // Skinned items without any vertices this frame are left out, not
+    // counted as not ready, and nothing else changes.
+    void TestSkinnedWithoutVertices(TestContext& t) {
+        Scene scene;
+        RenderQueue queue;
+        queue.Submit(At(0.0f, 0.0f), scene.sphere, 0);
+        queue.SubmitSkinned(At(2.0f, 0.0f), scene.sphere, 0, 0, 0);
+        queue.SubmitInstanced(At(4.0f, 0.0f), scene.sphere, 0, 0, 4);
+        DrawFrame(scene.renderer, queue);
+        DrawFrame(scene.renderer, queue);
+        CHECK(t, scene.renderer.GetStats().draws == 1 && scene.renderer.GetStats().notReady == 0);
+        CHECK(t, scene.renderer.GetPipelines().Count() == 1);
+
+        queue.AllocateVertices(4);
+        queue.AllocateInstances(4);
+        DrawFrame(scene.renderer, queue);
+        CHECK(t, scene.renderer.GetStats().draws == 3 && scene.renderer.GetPipelines().Count() == 3);
+    }
+
+} // namespace
+
+void RunPipelineTests(TestContext& t)
+{
+    TestCache(t);
+    TestQueueBinds(t);
+    TestSkinnedWithoutVertices(t);
+}
@@ -0,0 +1,214 @@
+#include "Tests/Tests.h"
+#include "Profiling/EventRing.h"
+#include "Profiling/Profiler.h"
+
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Profiler;
+
+namespace {
+
+    std::string TempPath(const TestContext& t, const char* name) {
+        return (std::filesystem::temp_directory_path() /
+                ("DreivyProfilerTest" + std::to_string(t.Seed()) + name + ".json")).string();
+    }
+
+    std::string ReadFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    // Just enough of a JSON reader to say whether chrome://tracing would
+    // parse the file: values, nesting, string escapes, numbers.
+    class JsonChecker {
+    public:
+        explicit JsonChecker(const std::string& text) : m_s(text) {}
+
+        bool Valid() {
+            if (!Value()) return false;
+            Space();
+            return m_i == m_s.size();
+        }
+
+    private:
+        void Space() { while (m_i < m_s.size() && std::isspace(uint8_t(m_s[m_i]))) ++m_i; }
+        bool Eat(char c) { Space(); if (m_i < m_s.size() && m_s[m_i] == c) { ++m_i; return true; } return false; }
+
+        bool Value() {
+            Space();
+            if (m_i >= m_s.size()) return false;
+            const char c = m_s[m_i];
+            if (c == '{') return Sequence('}', true);
+            if (c == '[') return Sequence(']', false);
+            if (c == '"') return String();
+            if (c == '-' || std::isdigit(uint8_t(c))) return Number();
+            for (const char* word : { "true", "false", "null" }) {
+                if (m_s.compare(m_i, std::strlen(word), word) == 0) { m_i += std::strlen(word); return true; }
+            }
+            return false;
+        }
+
+        bool Sequence(char close, bool object) {
+            ++m_i;
+            if (Eat(close)) return true;
+            do {
+                if (object && !(Space(), String() && Eat(':'))) return false;
+                if (!Value()) return false;
+            } while (Eat(','));
+            return Eat(close);
+        }
+
+        bool String() {
+            if (m_i >= m_s.size() || m_s[m_i] != '"') return false;
+            for (++m_i; m_i < m_s.size(); ++m_i) {
+                const char c = m_s[m_i];
+                if (c == '"') { ++m_i; return true; }
+                if (uint8_t(c) < 0x20) return false;
+                if (c == '\\' && (++m_i >= m_s.size() || std::strchr("\"\\/bfnrtu", m_s[m_i]) == nullptr)) return false;
+            }
+            return false;
+        }
+
+        bool Number() {
+            const size_t start = m_i;
+            if (m_s[m_i] == '-') ++m_i;
+            while (m_i < m_s.size() && (std::isdigit(uint8_t(m_s[m_i])) || std::strchr(".eE+-", m_s[m_i]))) ++m_i;
+            return m_i > start && std::isdigit(uint8_t(m_s[m_i - 1]));
+        }
+
+        const std::string& m_s;
+        size_t m_i = 0;
+    };
+
+    size_t Count(const std::string& text, const std::string& needle) {
+        size_t n = 0;
+        for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) ++n;
+        return n;
+    }
+
+    // Fewer events than slots come back as pushed. A full ring gives the
+    // newest Capacity - 1, oldest first: the slot the owner writes next is
+    // never trusted, it may be half written.
+    void TestRingWrap(TestContext& t) {
+        EventRing<8> ring;
+        std::vector<Event> out;
+        ring.CopyTo(out);
+        CHECK(t, out.empty());
+
+        for (int64_t i = 0; i < 5; ++i) ring.Push({ "e", i, i, 0 });
+        ring.CopyTo(out);
+        CHECK(t, out.size() == 5 && out.front().start == 0 && out.back().start == 4);
+
+        for (int64_t i = 5; i < 21; ++i) ring.Push({ "e", i, i, 0 });
+        out.assign(1, Event{ "kept", -1, -1, 0 }); // appends, never touches what is there
+        ring.CopyTo(out);
+        bool inOrder = out.size() == 8 && out[0].start == -1;
+        for (size_t i = 1; inOrder && i < out.size(); ++i)
+            inOrder = out[i].start == int64_t(13 + i); // 14..20
+        CHECK(t, inOrder);
+    }
+
+    // A writer laps a tiny ring over and over while it is being copied:
+    // every copy is a run of consecutive events, never a slot written
+    // after the copy began.
+    void TestRingLaps(TestContext& t) {
+        EventRing<64> ring;
+        std::atomic<bool> done{ false };
+        std::thread writer([&] {
+            for (int64_t i = 0; i < 2000000; ++i) ring.Push({ "e", i, i, 0 });
+            done = true;
+        });
+
+        uint32_t copies = 0, torn = 0;
+        std::vector<Event> out;
+        while (!done || copies == 0) {
+            out.clear();
+            ring.CopyTo(out);
+            ++copies;
+            for (size_t i = 1; i < out.size(); ++i)
+                if (out[i].start != out[i - 1].start + 1 || out[i].end != out[i].start) ++torn;
+        }
+        writer.join();
+        CHECK(t, copies > 0);
+        CHECK(t, torn == 0);
+
+        out.clear();
+        ring.CopyTo(out);
+        CHECK(t, out.size() == 63 && out.back().start == 1999999);
+    }
+
+    // WriteTrace: valid JSON in the Chrome trace layout, the thread's name
+    // as metadata, zones as complete ("X") events with a duration, frames
+    // as instant events, and names with quotes and backslashes escaped.
+    void TestTraceJson(TestContext& t) {
+        SetThreadName("Tests \"main\"");
+        const char* odd = InternName("Zone \"quoted\" \\ back");
+        {
+            Zone outer("ProfilerTestOuter");
+            { Zone inner(odd); }
+        }
+        MarkFrame();
+
+        const std::string path = TempPath(t, "Trace");
+        CHECK(t, WriteTrace(path));
+        const std::string json = ReadFile(path);
+        CHECK(t, JsonChecker(json).Valid());
+        CHECK(t, json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+        CHECK(t, json.find("\"ph\":\"M\"") != std::string::npos);
+        CHECK(t, json.find("\"args\":{\"name\":\"Tests \\\"main\\\"\"}") != std::string::npos);
+        CHECK(t, json.find("{\"name\":\"ProfilerTestOuter\",\"ph\":\"X\"") != std::string::npos);
+        CHECK(t, json.find("\"name\":\"Zone \\\"quoted\\\" \\\\ back\",\"ph\":\"X\"") != std::string::npos);
+        CHECK(t, json.find("\"args\":{\"depth\":1}") != std::string::npos);
+        CHECK(t, json.find("{\"name\":\"Frame\",\"ph\":\"i\"") != std::string::npos);
+        CHECK(t, Count(json, "\"ph\":\"X\"") == Count(json, "\"dur\":"));
+
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        CHECK(t, !WriteTrace((std::filesystem::temp_directory_path() / "no such dir" / "trace.json").string()));
+    }
+
+    // CaptureFrames starts at the next frame and writes the file once the
+    // frames are done, with only the zones that started in between.
+    void TestCapture(TestContext& t) {
+        const std::string path = TempPath(t, "Capture");
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+
+        { Zone before("ProfilerTestBefore"); }
+        CaptureFrames(path, 2);
+        MarkFrame(); // capture starts
+        { Zone during("ProfilerTestDuring"); }
+        MarkFrame();
+        CHECK(t, !std::filesystem::exists(path));
+        MarkFrame(); // second frame done: written
+        { Zone after("ProfilerTestAfter"); }
+        MarkFrame();
+
+        const std::string json = ReadFile(path);
+        CHECK(t, JsonChecker(json).Valid());
+        CHECK(t, json.find("ProfilerTestDuring") != std::string::npos);
+        CHECK(t, json.find("ProfilerTestBefore") == std::string::npos);
+        CHECK(t, json.find("ProfilerTestAfter") == std::string::npos);
+        CHECK(t, Count(json, "\"name\":\"Frame\"") == 3);
+        std::filesystem::remove(path, ec);
+    }
+
+} // namespace
+
+void RunProfilerTests(TestContext& t)
+{
+    TestRingWrap(t);
+    TestRingLaps(t);
+    TestTraceJson(t);
+    TestCapture(t);
+}
@@ -0,0 +1,130 @@
+#include "Tests/Tests.h"
+#include "Bench/QueryFixture.h"
+#include "Math/SimdMath.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+using namespace QueryFixture;
+
+namespace {
+
+    void CheckAgainstHash(TestContext& t, World& world, const HashWorld& hash) {
+        for (Entity e = 1; e <= world.EntityCount(); ++e)
+            for (int k = 0; k < KindCount; ++k) {
+                bool has = false;
+                WithKind(k, [&](auto c) { has = world.HasComponent<decltype(c)>(e); });
+                CHECK(t, has == hash.Has(e, k));
+                // Velocity's data moves around in its pool; it must still be e's.
+                if (k == KindVelocity && has)
+                    CHECK(t, world.GetComponent<Velocity>(e).x == float(e));
+            }
+
+        EcsVector<Entity> found;
+        for (const QuerySpec& q : Queries()) {
+            std::vector<Entity> expected;
+            for (Entity e = 1; e <= world.EntityCount(); ++e)
+                if (HashMatches(hash, e, q))
+                    expected.push_back(e);
+            world.Query(q.query, found);
+            CHECK(t, found.size() == expected.size() && std::equal(found.begin(), found.end(), expected.begin()));
+        }
+    }
+
+    // Tags are bits only: no pool is made for them, one is for Velocity.
+    void TestTagsHaveNoPool(TestContext& t) {
+        uint32_t rng = t.Seed();
+        World world;
+        HashWorld hash;
+        Populate(world, hash, 4099, rng);
+        CHECK(t, world.PoolAt(ComponentTypeId<Static>()) == nullptr);
+        CHECK(t, world.PoolAt(ComponentTypeId<Hidden>()) == nullptr);
+        CHECK(t, world.PoolAt(ComponentTypeId<Selected>()) == nullptr);
+        CHECK(t, world.FindPool<Velocity>() != nullptr);
+        CheckAgainstHash(t, world, hash);
+    }
+
+    // Random adds, removes and destroys, then a merge the way CellStreamer
+    // does it: Query and HasComponent must keep agreeing with the hash maps.
+    void TestChurnAndMerge(TestContext& t) {
+        uint32_t rng = t.Seed();
+        World world;
+        HashWorld hash;
+        Populate(world, hash, 4099, rng);
+
+        for (uint32_t i = 0; i < 20000; ++i) {
+            const Entity e = 1 + Bench::NextRandom(rng) % world.EntityCount();
+            const int kind = int(Bench::NextRandom(rng) % KindCount);
+            switch (Bench::NextRandom(rng) % 8) {
+            case 0:
+                world.DestroyEntity(e);
+                for (auto& map : hash.byKind)
+                    map.erase(e);
+                break;
+            case 1: case 2: case 3:
+                WithKind(kind, [&](auto c) {
+                    const bool removed = world.RemoveComponent<decltype(c)>(e);
+                    CHECK(t, removed == (hash.byKind[kind].erase(e) != 0));
+                });
+                break;
+            default:
+                WithKind(kind, [&](auto c) {
+                    if constexpr (std::is_same_v<decltype(c), Velocity>)
+                        c.x = float(e);
+                    world.AddComponent(e, c);
+                });
+                hash.byKind[kind].emplace(e, 0);
+                break;
+            }
+        }
+        CheckAgainstHash(t, world, hash);
+
+        World merged;
+        merged.CreateEntities(10);
+        const Entity offset = merged.EntityCount();
+        merged.CreateEntities(world.EntityCount());
+        for (uint32_t id = 0; id < world.PoolSlots(); ++id)
+            if (const IComponentPool* pool = world.PoolAt(id))
+                merged.AppendFrom(world, id, 0, pool->Size(), offset);
+        merged.AppendTagsFrom(world, offset);
+        bool same = true;
+        for (Entity e = 1; e <= world.EntityCount(); ++e)
+            same = same && merged.Signature(e + offset) == world.Signature(e);
+        CHECK(t, same);
+        for (Entity e = 1; e <= offset; ++e)
+            CHECK(t, merged.Signature(e) == 0);
+
+        // AppendFrom sets the same bit from the ID as ComponentBit from the type.
+        CHECK(t, ComponentBitOf(ComponentTypeId<Velocity>()) == ComponentBit<Velocity>());
+        CHECK(t, ComponentBitOf(MaxComponentTypes - 1) == ComponentMask(1) << 63);
+    }
+
+    // The kernel itself: selected backend = scalar, tails included,
+    // nothing written at or past `count`.
+    void TestMatchMasks(TestContext& t) {
+        uint32_t rng = t.Seed();
+        const uint32_t n = 1027;
+        std::vector<uint64_t> masks(n);
+        for (uint64_t& m : masks)
+            m = uint64_t(Bench::NextRandom(rng) & 0xFF) | uint64_t(Bench::NextRandom(rng) & 0x3) << 62;
+        for (uint32_t trial = 0; trial < 64; ++trial) {
+            const uint64_t all = uint64_t(Bench::NextRandom(rng) & 0x13) | (trial & 1 ? 1ull << 63 : 0);
+            const uint64_t none = uint64_t(Bench::NextRandom(rng) & 0x24) | (trial & 2 ? 1ull << 62 : 0);
+            const size_t count = trial < 10 ? trial : n - (trial & 7);
+            std::vector<uint32_t> simd(count + 1, 0xDEADBEEF), scalar(count + 1);
+            const size_t a = Simd::MatchMasks(masks.data(), count, all, none, 7, simd.data());
+            const size_t b = Simd::Scalar::MatchMasks(masks.data(), count, all, none, 7, scalar.data());
+            CHECK(t, a == b && std::equal(simd.begin(), simd.begin() + a, scalar.begin()));
+            CHECK(t, simd[count] == 0xDEADBEEF);
+        }
+    }
+
+} // namespace
+
+void RunQueryTests(TestContext& t)
+{
+    TestTagsHaveNoPool(t);
+    TestChurnAndMerge(t);
+    TestMatchMasks(t);
+}
@@ -0,0 +1,262 @@
+#include "Tests/Tests.h"
+#include "Bench/RenderGraphFixture.h"
+#include "Memory/AllocTracker.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace RenderGraphFixture;
+
+namespace {
+
+    bool SameDesc(const GraphResourceDesc& a, const GraphResourceDesc& b) {
+        return a.kind == b.kind && a.width == b.width && a.height == b.height &&
+            a.format == b.format && a.bytesPerPixel == b.bytesPerPixel && a.bytes == b.bytes;
+    }
+
+    bool SameBarrier(const GraphBarrier& a, const GraphBarrier& b) {
+        return a.resource == b.resource && a.before == b.before && a.after == b.after;
+    }
+
+    // Everything Compile decided, worked out again a different way, and
+    // what the backend saw during Execute.
+    void CheckGraph(TestContext& t, const RenderGraph& g, const RecordingTarget& target) {
+        const auto& passes = g.GetPasses();
+        const auto& uses = g.GetUses();
+        const auto& barriers = g.GetBarriers();
+        const size_t resources = g.ResourceCount();
+
+        // Culling as a fixed point: kept if it has side effects, writes an
+        // import, or writes what a later kept pass reads.
+        std::vector<uint8_t> kept(passes.size(), 0);
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (size_t i = 0; i < passes.size(); ++i) {
+                bool keep = passes[i].sideEffect;
+                for (uint32_t u = passes[i].firstUse; u < passes[i].firstUse + passes[i].useCount && !keep; ++u) {
+                    if (!uses[u].write)
+                        continue;
+                    keep = g.GetResource(uses[u].resource).imported;
+                    for (size_t j = i + 1; j < passes.size() && !keep; ++j) {
+                        if (!kept[j])
+                            continue;
+                        for (uint32_t v = passes[j].firstUse; v < passes[j].firstUse + passes[j].useCount; ++v)
+                            keep = keep || (!uses[v].write && uses[v].resource == uses[u].resource);
+                    }
+                }
+                if (keep && !kept[i]) {
+                    kept[i] = 1;
+                    changed = true;
+                }
+            }
+        }
+        uint32_t culled = 0;
+        for (size_t i = 0; i < passes.size(); ++i) {
+            CHECK(t, passes[i].culled == !kept[i]);
+            culled += kept[i] ? 0 : 1;
+        }
+        CHECK(t, g.GetStats().culled == culled);
+
+        // Lifetimes over the kept passes.
+        std::vector<uint32_t> first(resources, ~0u), last(resources, 0);
+        for (size_t i = 0; i < passes.size(); ++i) {
+            if (!kept[i])
+                continue;
+            for (uint32_t u = passes[i].firstUse; u < passes[i].firstUse + passes[i].useCount; ++u) {
+                const size_t r = uses[u].resource - 1;
+                first[r] = std::min(first[r], uint32_t(i));
+                last[r] = std::max(last[r], uint32_t(i));
+            }
+        }
+
+        // Aliasing: who shares a physical resource must not overlap, and must fit.
+        const auto& physical = g.GetPhysical();
+        uint64_t transientBytes = 0, physicalBytes = 0;
+        for (const GraphResourceDesc& d : physical)
+            physicalBytes += d.Size();
+        for (size_t r = 0; r < resources; ++r) {
+            const RenderGraph::Resource& res = g.GetResource(GraphResource(r + 1));
+            const bool used = first[r] != ~0u;
+            if (res.imported || !used) {
+                CHECK(t, res.physical == ~0u);
+                continue;
+            }
+            transientBytes += res.desc.Size();
+            CHECK(t, res.firstPass == first[r] && res.lastPass == last[r]);
+            if (!CHECK(t, res.physical < physical.size()))
+                continue;
+            const GraphResourceDesc& pd = physical[res.physical];
+            if (res.desc.kind == GraphResourceDesc::Kind::Texture)
+                CHECK(t, SameDesc(pd, res.desc));
+            else
+                CHECK(t, pd.kind == res.desc.kind && pd.bytes >= res.desc.bytes);
+            for (size_t o = r + 1; o < resources; ++o) {
+                const RenderGraph::Resource& other = g.GetResource(GraphResource(o + 1));
+                if (other.physical != res.physical || other.imported || first[o] == ~0u)
+                    continue;
+                CHECK(t, last[r] < first[o] || last[o] < first[r]);
+            }
+        }
+        CHECK(t, g.GetStats().transientBytes == transientBytes && g.GetStats().physicalBytes == physicalBytes);
+        CHECK(t, physicalBytes <= transientBytes);
+
+        // Barriers: every pass sees each resource in the state it asked
+        // for, and no barrier is there without a change.
+        std::vector<ResourceState> state(resources);
+        for (size_t r = 0; r < resources; ++r) {
+            const RenderGraph::Resource& res = g.GetResource(GraphResource(r + 1));
+            state[r] = res.imported ? res.initial : ResourceState::Undefined;
+        }
+        std::vector<GraphBarrier> expected;
+        for (size_t i = 0; i < passes.size(); ++i) {
+            const RenderGraph::Pass& p = passes[i];
+            if (!kept[i])
+                continue;
+            for (uint32_t b = p.firstBarrier; b < p.firstBarrier + p.barrierCount; ++b) {
+                const GraphBarrier& br = barriers[b];
+                bool usedHere = false;
+                for (uint32_t u = p.firstUse; u < p.firstUse + p.useCount; ++u)
+                    usedHere = usedHere || uses[u].resource == br.resource;
+                CHECK(t, usedHere && br.before == state[br.resource - 1] && br.before != br.after);
+                state[br.resource - 1] = br.after;
+                expected.push_back(br);
+            }
+            for (uint32_t u = p.firstUse; u < p.firstUse + p.useCount; ++u)
+                CHECK(t, state[uses[u].resource - 1] == uses[u].state);
+        }
+        for (size_t b = barriers.size() - g.FinalBarriers(); b < barriers.size(); ++b) {
+            const GraphBarrier& br = barriers[b];
+            CHECK(t, g.GetResource(br.resource).imported && br.before == state[br.resource - 1]);
+            state[br.resource - 1] = br.after;
+            expected.push_back(br);
+        }
+        for (size_t r = 0; r < resources; ++r) {
+            const RenderGraph::Resource& res = g.GetResource(GraphResource(r + 1));
+            CHECK(t, !res.imported || state[r] == res.final);
+        }
+        CHECK(t, expected.size() == barriers.size());
+
+        // The backend saw the same.
+        CHECK(t, target.prepared.size() == physical.size());
+        for (size_t p = 0; p < target.prepared.size() && p < physical.size(); ++p)
+            CHECK(t, SameDesc(target.prepared[p], physical[p]));
+        CHECK(t, target.barriers.size() == expected.size());
+        for (size_t b = 0; b < target.barriers.size() && b < expected.size(); ++b)
+            CHECK(t, SameBarrier(target.barriers[b], expected[b]));
+        std::vector<uint32_t> order;
+        for (size_t i = 0; i < passes.size(); ++i)
+            if (kept[i])
+                order.push_back(uint32_t(i));
+        CHECK(t, target.passes == order);
+        for (const RecordingTarget::FirstUse& f : target.firstUses) {
+            const bool firstUse = !g.GetResource(f.resource).imported && first[f.resource - 1] == f.pass;
+            CHECK(t, f.first == firstUse);
+        }
+    }
+
+    // Graphs that must not compile.
+    void TestBrokenGraphs(TestContext& t) {
+        using S = ResourceState;
+        RenderGraph g;
+
+        g.Reset();
+        const GraphResource out = g.Import("Out", Tex(64, 64, RGBA8), S::Present, S::Present);
+        const GraphResource temp = g.CreateTexture("Temp", Tex(64, 64, RGBA8));
+        g.AddPass("ReadsFirst", nullptr).Read(temp).Write(out);
+        CHECK(t, !g.Compile() && !g.GetError().empty());
+
+        g.Reset();
+        const GraphResource out2 = g.Import("Out", Tex(64, 64, RGBA8), S::Present, S::Present);
+        const GraphResource temp2 = g.CreateTexture("Temp", Tex(64, 64, RGBA8));
+        g.AddPass("Writes", nullptr).Write(temp2);
+        g.AddPass("TwoStates", nullptr).Read(temp2).Write(temp2).Write(out2);
+        CHECK(t, !g.Compile());
+
+        g.Reset();
+        g.AddPass("NoSuchResource", nullptr).Write(7);
+        CHECK(t, !g.Compile());
+
+        // A builder used after the next AddPass: the use can't be kept, so
+        // the graph doesn't compile, until Reset.
+        g.Reset();
+        const GraphResource out4 = g.Import("Out", Tex(64, 64, RGBA8), S::Present, S::Present);
+        const GraphResource temp4 = g.CreateTexture("Temp", Tex(64, 64, RGBA8));
+        RenderGraph::PassBuilder late = g.AddPass("Late", nullptr);
+        g.AddPass("Clear", nullptr).Write(out4);
+        late.Write(temp4);
+        CHECK(t, !g.Compile() && g.GetError().find("Late") != std::string::npos);
+        g.Reset();
+        const GraphResource out5 = g.Import("Out", Tex(64, 64, RGBA8), S::Present, S::Present);
+        g.AddPass("Clear", nullptr).Write(out5);
+        CHECK(t, g.Compile());
+
+        // A culled pass may do anything: it is not looked at.
+        g.Reset();
+        const GraphResource out3 = g.Import("Out", Tex(64, 64, RGBA8), S::Present, S::Present);
+        const GraphResource temp3 = g.CreateTexture("Temp", Tex(64, 64, RGBA8));
+        const GraphResource unused = g.CreateTexture("Unused", Tex(64, 64, RGBA8));
+        g.AddPass("Culled", nullptr).Read(temp3).Write(unused);
+        g.AddPass("Clear", nullptr).Write(out3);
+        CHECK(t, g.Compile() && g.GetStats().culled == 1);
+    }
+
+    // The reference frame: the two unread passes are culled, the rest not,
+    // and aliasing saves memory.
+    void TestReferenceFrame(TestContext& t) {
+        RenderGraph graph;
+        RecordingTarget target;
+        BuildReferenceFrame(graph, 1920, 1080, target);
+        CHECK(t, graph.Compile());
+        graph.Execute(target);
+        CheckGraph(t, graph, target);
+        for (const RenderGraph::Pass& p : graph.GetPasses()) {
+            const bool unread = std::string(p.name) == "SSR" || std::string(p.name) == "DebugHeatmap";
+            CHECK(t, p.culled == unread);
+        }
+        CHECK(t, graph.GetStats().physicalBytes < graph.GetStats().transientBytes);
+    }
+
+    void TestRandomGraphs(TestContext& t) {
+        RenderGraph graph;
+        RecordingTarget target;
+        uint32_t rng = t.Seed();
+        for (uint32_t i = 0; i < 500; ++i) {
+            target.Clear();
+            BuildRandomGraph(graph, rng, target);
+            if (!CHECK(t, graph.Compile()))
+                continue;
+            graph.Execute(target);
+            CheckGraph(t, graph, target);
+        }
+    }
+
+    // Once warm, building, compiling and running a frame allocates nothing.
+    void TestWarmFrameAllocations(TestContext& t) {
+        if (!AllocTracker::Enabled)
+            return;
+        RenderGraph graph;
+        RecordingTarget target;
+        AllocScope scope(AllocTag::Render);
+        uint64_t before = 0;
+        for (uint32_t f = 0; f < 20; ++f) {
+            if (f == 4)
+                before = AllocTracker::GetStats(AllocTag::Render).totalCount;
+            target.Clear();
+            BuildReferenceFrame(graph, 1920, 1080, target);
+            graph.Compile();
+            graph.Execute(target);
+        }
+        CHECK(t, AllocTracker::GetStats(AllocTag::Render).totalCount == before);
+        CheckGraph(t, graph, target);
+    }
+
+} // namespace
+
+void RunRenderGraphTests(TestContext& t)
+{
+    TestBrokenGraphs(t);
+    TestReferenceFrame(t);
+    TestRandomGraphs(t);
+    TestWarmFrameAllocations(t);
+}
@@ -0,0 +1,178 @@
+#include "Tests/Tests.h"
+#include "Renderer/ShaderCache.h"
+#include "Threading/JobSystem.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // Stands in for D3DShaderCompiler: the "bytecode" is the desc and the
+    // source text, so a stale blob is told apart from a fresh one, and
+    // every call is counted. An entry named "Broken" fails to compile.
+    class FakeShaderCompiler : public IShaderCompiler {
+    public:
+        std::atomic<uint32_t> calls{ 0 };
+
+        std::string Identity() const override { return "fake-1"; }
+
+        bool Compile(const ShaderDesc& desc, std::vector<uint8_t>& bytecode, std::string& errors) override {
+            ++calls;
+            if (desc.entry == "Broken") {
+                errors = desc.file + ": Broken: no such entry point";
+                return false;
+            }
+            const std::string text = Expected(desc);
+            bytecode.assign(text.begin(), text.end());
+            return true;
+        }
+
+        // What Compile makes of `desc`, include included.
+        static std::string Expected(const ShaderDesc& desc) {
+            std::string text = desc.entry + "/" + desc.profile;
+            for (const ShaderDefine& d : desc.defines)
+                text += " " + d.name + "=" + d.value;
+            text += "\n" + ReadText(desc.file);
+            const std::filesystem::path include = std::filesystem::path(desc.file).parent_path() / "Common.hlsli";
+            if (text.find("#include \"Common.hlsli\"") != std::string::npos)
+                text += ReadText(include.string());
+            return text;
+        }
+
+        static std::string ReadText(const std::string& path) {
+            std::ifstream f(path, std::ios::binary);
+            return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        }
+    };
+
+    void WriteText(const std::filesystem::path& path, const std::string& text) {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        f << text;
+    }
+
+    bool Matches(const ShaderBytecode& bc, const ShaderDesc& desc) {
+        const std::string want = FakeShaderCompiler::Expected(desc);
+        return bc.Size() == want.size() && std::memcmp(bc.Data(), want.data(), want.size()) == 0;
+    }
+
+    bool AllMatch(const std::vector<ShaderBytecode>& out, const std::vector<ShaderDesc>& descs) {
+        bool ok = out.size() == descs.size();
+        for (size_t i = 0; ok && i < descs.size(); ++i)
+            ok = Matches(out[i], descs[i]);
+        return ok;
+    }
+
+    std::string BlobPath(const std::filesystem::path& cache, uint64_t key) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return (cache / name).string();
+    }
+
+    // Cold, warm, an edited include, corrupt blobs and a failing shader, in
+    // a fresh cache directory, with or without workers.
+    void TestCache(TestContext& t, JobSystem* jobs) {
+        const std::filesystem::path root = std::filesystem::temp_directory_path() /
+            ("DreivyShaderCacheTest" + std::to_string(t.Seed()) + (jobs ? "j" : ""));
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+        std::filesystem::create_directories(root / "shaders", ec);
+        const std::filesystem::path cache = root / "cache";
+
+        WriteText(root / "shaders" / "Common.hlsli", "float4 Tint() { return 1; }\n");
+        WriteText(root / "shaders" / "Mesh.hlsl", "#include \"Common.hlsli\"\nfloat4 VSMain() : SV_Position { return Tint(); }\n");
+        WriteText(root / "shaders" / "Sky.hlsl", "float4 PSMain() : SV_Target { return 0; }\n");
+
+        const std::string mesh = (root / "shaders" / "Mesh.hlsl").string();
+        const std::string sky = (root / "shaders" / "Sky.hlsl").string();
+        const std::vector<ShaderDesc> descs = {
+            { mesh, "VSMain", "vs_5_0", {} },
+            { mesh, "VSMain", "vs_5_0", { { "SKINNED", "1" } } },
+            { sky,  "PSMain", "ps_5_0", {} },
+        };
+
+        FakeShaderCompiler compiler;
+        std::vector<ShaderBytecode> out;
+
+        // Cold: everything is compiled and stored.
+        {
+            ShaderCache shaders(compiler, cache.string());
+            shaders.SetJobSystem(jobs);
+            CHECK(t, shaders.Load(descs, out));
+            const ShaderCacheStats& st = shaders.GetStats();
+            CHECK(t, st.requested == 3 && st.compiled == 3 && st.hits == 0 && st.failed == 0);
+            CHECK(t, compiler.calls == 3);
+            CHECK(t, AllMatch(out, descs));
+            CHECK(t, shaders.ComputeKey(descs[0]) != shaders.ComputeKey(descs[1]));
+        }
+
+        // Warm, as on the next launch: all mapped from disk, nothing compiled.
+        {
+            ShaderCache shaders(compiler, cache.string());
+            shaders.SetJobSystem(jobs);
+            CHECK(t, shaders.Load(descs, out));
+            const ShaderCacheStats& st = shaders.GetStats();
+            CHECK(t, st.hits == 3 && st.compiled == 0);
+            CHECK(t, compiler.calls == 3);
+            CHECK(t, AllMatch(out, descs));
+            for (const ShaderBytecode& bc : out)
+                CHECK(t, bc.FromCache());
+        }
+        out.clear(); // unmaps the blobs, so they can be written over
+
+        // An edited include: the two descs of Mesh.hlsl compile again, Sky is a hit.
+        ShaderCache shaders(compiler, cache.string());
+        shaders.SetJobSystem(jobs);
+        WriteText(root / "shaders" / "Common.hlsli", "float4 Tint() { return 0.5; }\n");
+        CHECK(t, shaders.Load(descs, out));
+        CHECK(t, shaders.GetStats().compiled == 2 && shaders.GetStats().hits == 1);
+        CHECK(t, compiler.calls == 5);
+        CHECK(t, AllMatch(out, descs));
+        out.clear();
+
+        // Corrupt blobs: one cut short, one with its header written over.
+        // Neither is used; both compile again and are stored anew.
+        {
+            const std::string cut = BlobPath(cache, shaders.ComputeKey(descs[0]));
+            const std::string over = BlobPath(cache, shaders.ComputeKey(descs[2]));
+            CHECK(t, std::filesystem::exists(cut) && std::filesystem::exists(over));
+            std::filesystem::resize_file(cut, std::filesystem::file_size(cut) - 1, ec);
+            std::fstream f(over, std::ios::binary | std::ios::in | std::ios::out);
+            f.write("garbage!", 8);
+        }
+        CHECK(t, shaders.Load(descs, out));
+        CHECK(t, shaders.GetStats().compiled == 2 && shaders.GetStats().hits == 1);
+        CHECK(t, compiler.calls == 7);
+        CHECK(t, AllMatch(out, descs));
+        CHECK(t, shaders.Load(descs, out));
+        CHECK(t, shaders.GetStats().hits == 3 && compiler.calls == 7);
+        out.clear();
+
+        // A shader that doesn't compile: Load fails, says why, and stores nothing.
+        const std::vector<ShaderDesc> broken = { descs[0], { sky, "Broken", "ps_5_0", {} } };
+        for (int run = 0; run < 2; ++run) {
+            CHECK(t, !shaders.Load(broken, out));
+            const ShaderCacheStats& st = shaders.GetStats();
+            CHECK(t, st.hits == 1 && st.failed == 1 && st.compiled == 0);
+            CHECK(t, shaders.GetErrors().find("Broken") != std::string::npos);
+            CHECK(t, out.size() == 2 && Matches(out[0], descs[0]) && out[1].Empty());
+        }
+        CHECK(t, compiler.calls == 9);
+        out.clear();
+
+        std::filesystem::remove_all(root, ec);
+    }
+
+} // namespace
+
+void RunShaderCacheTests(TestContext& t)
+{
+    TestCache(t, nullptr);
+    JobSystem jobs;
+    TestCache(t, &jobs);
+}
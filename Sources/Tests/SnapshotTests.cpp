@@ -0,0 +1,148 @@
+#include "Tests/Tests.h"
+#include "Bench/BenchUtil.h"
+#include "World/ECS/WorldSnapshot.h"
+#include "World/ECS/Component/Transform.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct Health {
+        float value;
+        uint32_t team;
+    };
+    struct Frozen {};
+
+    std::string TempPath(const TestContext& t, const char* name) {
+        return (std::filesystem::temp_directory_path() /
+                ("DreivySnapshotTest" + std::to_string(t.Seed()) + name + ".dws")).string();
+    }
+
+    void Register(WorldSnapshot& snapshot) {
+        snapshot.RegisterComponent<Transform>("Transform");
+        snapshot.RegisterComponent<Health>("Health");
+        snapshot.RegisterComponent<Frozen>("Frozen");
+    }
+
+    // A file written by hand in the layout of WorldSnapshot.cpp, with one
+    // Health section: so broken ones can be made too.
+    void WriteHealthFile(const std::string& path, uint32_t entityCount, const std::vector<Entity>& entities) {
+        std::string bytes;
+        auto put = [&](const void* p, size_t n) { bytes.append(static_cast<const char*>(p), n); };
+        auto pad = [&] { bytes.append((16 - bytes.size() % 16) % 16, '\0'); };
+        auto put32 = [&](uint32_t v) { put(&v, sizeof(v)); };
+
+        put("DWSN", 4);
+        put32(1);           // version
+        put32(entityCount);
+        put32(0);           // meshes
+        put32(1);           // component types
+        put32(0);
+        const std::string name = "Health";
+        put32(uint32_t(name.size()));
+        put(name.data(), name.size());
+        put32(sizeof(Health));
+        put32(uint32_t(entities.size()));
+        pad();
+        put(entities.data(), entities.size() * sizeof(Entity));
+        pad();
+        for (size_t i = 0; i < entities.size(); ++i) {
+            const Health h{ float(i), uint32_t(i % 2) };
+            put(&h, sizeof(h));
+        }
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+    }
+
+    // Save and load give back the same components, tags included, under
+    // the same IDs; destroyed entities stay empty.
+    void TestRoundTrip(TestContext& t) {
+        World world;
+        uint32_t rng = t.Seed();
+        const uint32_t count = 5000;
+        for (uint32_t i = 0; i < count; ++i) {
+            const Entity e = world.CreateEntity();
+            Transform tr;
+            tr.position = { Bench::RandomFloat(rng), Bench::RandomFloat(rng), Bench::RandomFloat(rng) };
+            world.AddComponent<Transform>(e, tr);
+            if (Bench::NextRandom(rng) % 2)
+                world.AddComponent<Health>(e, Health{ Bench::RandomFloat(rng), i % 4 });
+            if (Bench::NextRandom(rng) % 5 == 0)
+                world.AddComponent<Frozen>(e);
+        }
+        for (Entity e = 7; e <= count; e += 97)
+            world.DestroyEntity(e);
+
+        const std::string path = TempPath(t, "RoundTrip");
+        WorldSnapshot snapshot;
+        Register(snapshot);
+        CHECK(t, snapshot.Save(world, path));
+        // Twice: the tag's scratch from the first save must not leak into the second.
+        CHECK(t, snapshot.Save(world, path));
+
+        World loaded;
+        CHECK(t, snapshot.Load(loaded, path));
+        CHECK(t, loaded.EntityCount() == count);
+        CHECK(t, snapshot.GetStats().componentTypes == 3 && snapshot.GetStats().skippedTypes == 0);
+        bool same = true;
+        for (Entity e = 1; e <= count; ++e) {
+            same = same && loaded.Signature(e) == world.Signature(e);
+            const Transform* a = world.TryGetComponent<Transform>(e);
+            const Transform* b = loaded.TryGetComponent<Transform>(e);
+            same = same && (a == nullptr) == (b == nullptr) &&
+                (!a || std::memcmp(&a->position, &b->position, sizeof(a->position)) == 0);
+            const Health* h = world.TryGetComponent<Health>(e);
+            const Health* g = loaded.TryGetComponent<Health>(e);
+            same = same && (h == nullptr) == (g == nullptr) && (!h || (h->value == g->value && h->team == g->team));
+            same = same && loaded.HasComponent<Frozen>(e) == world.HasComponent<Frozen>(e);
+        }
+        CHECK(t, same);
+
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    // IDs in the file are checked before the world is touched: 0, past the
+    // entity count and twice in one section all fail and leave it as it was.
+    void TestBadEntities(TestContext& t) {
+        WorldSnapshot snapshot;
+        Register(snapshot);
+        const std::string path = TempPath(t, "BadEntities");
+
+        World world;
+        const Entity kept = world.CreateEntity();
+        world.AddComponent<Health>(kept, Health{ 42.0f, 7 });
+
+        WriteHealthFile(path, 10, { 1, 2, 3 });
+        World good;
+        CHECK(t, snapshot.Load(good, path));
+        CHECK(t, good.EntityCount() == 10 && good.GetPool<Health>().Size() == 3);
+
+        const std::vector<std::vector<Entity>> broken = { { 1, 0, 3 }, { 1, 11, 3 }, { 1, 2, 1 }, { 5, 5 } };
+        for (const std::vector<Entity>& entities : broken) {
+            WriteHealthFile(path, 10, entities);
+            CHECK(t, !snapshot.Load(world, path));
+            CHECK(t, !snapshot.GetError().empty());
+            CHECK(t, world.EntityCount() == 1 && world.GetPool<Health>().Size() == 1);
+            CHECK(t, world.GetComponent<Health>(kept).value == 42.0f);
+        }
+
+        // Cut short: fails too.
+        WriteHealthFile(path, 10, { 1, 2, 3 });
+        std::error_code ec;
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4, ec);
+        CHECK(t, !snapshot.Load(world, path) && world.EntityCount() == 1);
+
+        std::filesystem::remove(path, ec);
+    }
+
+} // namespace
+
+void RunSnapshotTests(TestContext& t)
+{
+    TestRoundTrip(t);
+    TestBadEntities(t);
+}
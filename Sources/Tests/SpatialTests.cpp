@@ -0,0 +1,120 @@
+#include "Tests/Tests.h"
+#include "Bench/SpatialFixture.h"
+#include "World/ECS/System/SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace SpatialFixture;
+
+namespace {
+
+    bool RadiusMatches(const SpatialGrid& grid, const World& world, const XMFLOAT3& c, float radius,
+                       std::vector<Entity>& expected, std::vector<Entity>& got) {
+        const ComponentPool<Transform>* pool = world.FindPool<Transform>();
+        expected.clear();
+        for (size_t i = 0; i < pool->Size(); ++i) {
+            const XMFLOAT3& p = pool->Data()[i].position;
+            const float dx = p.x - c.x, dy = p.y - c.y, dz = p.z - c.z;
+            if (dx * dx + dy * dy + dz * dz <= radius * radius)
+                expected.push_back(pool->Entities()[i]);
+        }
+        got.resize(expected.size() + 16);
+        const uint32_t n = grid.QueryRadius(c, radius, got.data(), uint32_t(got.size()));
+        if (n != expected.size()) return false;
+        got.resize(n);
+        std::sort(expected.begin(), expected.end());
+        std::sort(got.begin(), got.end());
+        return got == expected;
+    }
+
+    bool BoxMatches(const SpatialGrid& grid, const World& world, const XMFLOAT3& mn, const XMFLOAT3& mx,
+                    std::vector<Entity>& expected, std::vector<Entity>& got) {
+        const ComponentPool<Transform>* pool = world.FindPool<Transform>();
+        expected.clear();
+        for (size_t i = 0; i < pool->Size(); ++i) {
+            const XMFLOAT3& p = pool->Data()[i].position;
+            if (p.x >= mn.x && p.x <= mx.x && p.y >= mn.y && p.y <= mx.y && p.z >= mn.z && p.z <= mx.z)
+                expected.push_back(pool->Entities()[i]);
+        }
+        got.resize(expected.size() + 16);
+        const uint32_t n = grid.QueryBox(mn, mx, got.data(), uint32_t(got.size()));
+        if (n != expected.size()) return false;
+        got.resize(n);
+        std::sort(expected.begin(), expected.end());
+        std::sort(got.begin(), got.end());
+        return got == expected;
+    }
+
+    // Compares distances, not entities: two agents at the same distance may come in either order.
+    bool NearestMatches(const SpatialGrid& grid, const World& world, const XMFLOAT3& c, uint32_t k, float maxRadius,
+                        std::vector<float>& expected) {
+        const ComponentPool<Transform>* pool = world.FindPool<Transform>();
+        expected.clear();
+        for (size_t i = 0; i < pool->Size(); ++i) {
+            const XMFLOAT3& p = pool->Data()[i].position;
+            const float dx = p.x - c.x, dy = p.y - c.y, dz = p.z - c.z;
+            const float d = dx * dx + dy * dy + dz * dz;
+            if (d <= maxRadius * maxRadius)
+                expected.push_back(d);
+        }
+        std::sort(expected.begin(), expected.end());
+        if (expected.size() > k) expected.resize(k);
+
+        std::vector<Entity> got(k);
+        std::vector<float> dist(k);
+        const uint32_t n = grid.QueryNearest(c, k, maxRadius, got.data(), dist.data());
+        if (n != expected.size()) return false;
+        for (uint32_t i = 0; i < n; ++i)
+            if (dist[i] != expected[i]) return false;
+        return true;
+    }
+
+    // A sample of the queries against a brute-force scan, right after the
+    // first Update and again after the agents moved for a while.
+    void TestQueries(TestContext& t) {
+        const uint32_t n = 20000;
+        const float radius = 4.0f, density = 0.25f;
+        const uint32_t k = 8;
+        const float half = std::sqrt(float(n) / density) * 0.5f;
+
+        JobSystem jobs;
+        World world;
+        std::vector<Agent> agents;
+        uint32_t rng = t.Seed();
+        PlaceAgents(world, agents, n, half, rng);
+
+        SpatialGrid::Settings gridSettings;
+        gridSettings.cellSize = radius;
+        SpatialGrid grid(gridSettings);
+        grid.SetJobSystem(&jobs);
+
+        std::vector<Entity> expected, got;
+        std::vector<float> expectedDist;
+        for (uint32_t round = 0; round < 2; ++round) {
+            for (uint32_t step = 0; step < (round ? 30u : 1u); ++step) {
+                MoveAgents(jobs, world, agents, half, 1.0f / 60.0f);
+                grid.Update(world);
+            }
+            const ComponentPool<Transform>* pool = world.FindPool<Transform>();
+            for (uint32_t q = 0; q < 256; ++q) {
+                const XMFLOAT3 c = pool->Data()[Bench::NextRandom(rng) % n].position;
+                const float r = radius * (0.5f + Bench::RandomFloat(rng) * 2.0f);
+                CHECK(t, RadiusMatches(grid, world, c, r, expected, got));
+                CHECK(t, BoxMatches(grid, world, { c.x - r, c.y - r, c.z - r * 0.5f }, { c.x + r * 0.5f, c.y + r, c.z + r },
+                                    expected, got));
+                CHECK(t, NearestMatches(grid, world, c, k, radius * 3.0f, expectedDist));
+            }
+            // Far outside the agents, and a radius that covers all of them.
+            CHECK(t, RadiusMatches(grid, world, { half * 4.0f, 0.0f, 0.0f }, 1.0f, expected, got));
+            CHECK(t, NearestMatches(grid, world, { 0.0f, 0.0f, 0.0f }, k, half * 4.0f, expectedDist));
+        }
+    }
+
+} // namespace
+
+void RunSpatialTests(TestContext& t)
+{
+    TestQueries(t);
+}
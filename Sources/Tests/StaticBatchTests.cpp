@@ -0,0 +1,176 @@
+#include "Tests/Tests.h"
+#include "Bench/StaticBatchFixture.h"
+#include "Math/TransformUtils.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+using namespace StaticBatchFixture;
+
+namespace {
+
+    bool Near(const XMFLOAT3& a, const XMFLOAT3& b) {
+        const float tolerance = 1e-3f * (1.0f + std::fabs(a.x) + std::fabs(a.y) + std::fabs(a.z));
+        return std::fabs(a.x - b.x) <= tolerance && std::fabs(a.y - b.y) <= tolerance && std::fabs(a.z - b.z) <= tolerance;
+    }
+
+    XMFLOAT3 Cross(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c) {
+        XMFLOAT3 n;
+        XMStoreFloat3(&n, XMVector3Cross(XMLoadFloat3(&b) - XMLoadFloat3(&a), XMLoadFloat3(&c) - XMLoadFloat3(&a)));
+        return n;
+    }
+
+    // Every static entity is in exactly one part, the part is its mesh in
+    // world space, and every triangle still faces the way it did.
+    void CheckBatches(TestContext& t, Scene& s) {
+        const auto& batches = s.batcher.GetBatches();
+        const auto& parts = s.batcher.GetParts();
+        std::vector<uint32_t> seen(size_t(s.world.EntityCount()) + 1, 0);
+
+        for (const StaticBatch& batch : batches) {
+            const MeshData& merged = *s.meshes.Get(batch.mesh);
+            CHECK(t, merged.lods.empty() && merged.meshlets.empty() && merged.indices.size() == batch.indexCount);
+            for (uint32_t p = batch.firstPart; p < batch.firstPart + batch.partCount; ++p) {
+                const StaticBatchPart& part = parts[p];
+                ++seen[part.entity];
+                const StaticMesh* link = s.world.TryGetComponent<StaticMesh>(part.entity);
+                CHECK(t, link && link->batch == batch.mesh);
+
+                const Transform& tr = s.world.GetComponent<Transform>(part.entity);
+                const MeshData& src = *s.meshes.Get(s.world.GetComponent<Mesh>(part.entity).handle);
+                const XMMATRIX wm = BuildWorldMatrix(tr);
+                const XMMATRIX normalMatrix = XMMatrixTranspose(XMMatrixInverse(nullptr, wm));
+                const bool mirrored = tr.scale.x * tr.scale.y * tr.scale.z < 0.0f;
+                bool ok = part.range.indexCount == src.indices.size();
+                for (uint32_t k = 0; ok && k < part.range.indexCount; k += 3) {
+                    XMFLOAT3 expected[3], got[3];
+                    for (uint32_t v = 0; v < 3; ++v) {
+                        XMStoreFloat3(&expected[v], XMVector3TransformCoord(XMLoadFloat3(&src.positions[src.indices[k + v]]), wm));
+                        got[v] = merged.positions[merged.indices[part.range.firstIndex + k + v]];
+                    }
+                    ok = Near(got[0], expected[0]) && Near(got[1], mirrored ? expected[2] : expected[1])
+                        && Near(got[2], mirrored ? expected[1] : expected[2]);
+
+                    // Facing: the merged triangle's normal goes where the source normal goes.
+                    const XMFLOAT3 objectNormal = Cross(src.positions[src.indices[k]], src.positions[src.indices[k + 1]], src.positions[src.indices[k + 2]]);
+                    const XMFLOAT3 mergedNormal = Cross(got[0], got[1], got[2]);
+                    const float facing = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&mergedNormal),
+                        XMVector3TransformNormal(XMLoadFloat3(&objectNormal), normalMatrix)));
+                    ok = ok && facing >= -1e-4f;
+                }
+                CHECK(t, ok);
+            }
+        }
+
+        const ComponentPool<StaticMesh>* statics = s.world.FindPool<StaticMesh>();
+        for (Entity e = 1; e <= s.world.EntityCount(); ++e)
+            CHECK(t, seen[e] == (statics && statics->Has(e) ? 1u : 0u));
+    }
+
+    // How often the queue draws each entity, batched parts included.
+    std::vector<uint8_t> DrawnEntities(const Scene& s) {
+        std::vector<uint8_t> drawn(size_t(s.world.EntityCount()) + 1, 0);
+        const auto& batches = s.batcher.GetBatches();
+        const auto& parts = s.batcher.GetParts();
+        const auto& ranges = s.queue.GetRanges();
+        for (const RenderItem& item : s.queue.GetItems()) {
+            if (item.id != 0) {
+                ++drawn[item.id];
+                continue;
+            }
+            for (const StaticBatch& batch : batches) {
+                if (batch.mesh != item.mesh)
+                    continue;
+                for (uint32_t p = batch.firstPart; p < batch.firstPart + batch.partCount; ++p) {
+                    const IndexRange& r = parts[p].range;
+                    bool covered = item.rangeCount == 0;
+                    for (uint32_t k = 0; !covered && k < item.rangeCount; ++k) {
+                        const IndexRange& q = ranges[item.firstRange + k];
+                        covered = q.firstIndex <= r.firstIndex && r.firstIndex + r.indexCount <= q.firstIndex + q.indexCount;
+                    }
+                    drawn[parts[p].entity] += covered ? 1 : 0;
+                }
+            }
+        }
+        return drawn;
+    }
+
+    // Batching takes every static entity once, draws each of them that was
+    // drawn before, and needs fewer draws for it.
+    void TestBatching(TestContext& t) {
+        Scene scene;
+        BuildScene(scene, 20000, 16, t.Seed()); // the StaticBatchBench defaults
+        const std::vector<View> views = MakeViews(scene.half);
+
+        std::vector<uint32_t> drawsBefore;
+        std::vector<std::vector<uint8_t>> drawnBefore;
+        for (const View& v : views) {
+            DrawFrame(scene, v.view, false);
+            drawsBefore.push_back(scene.renderer.GetStats().draws);
+            drawnBefore.push_back(DrawnEntities(scene));
+        }
+
+        StaticBatcher::Settings settings;
+        settings.cellSize = 32.0f;
+        scene.batcher.SetSettings(settings);
+        CHECK(t, scene.batcher.Build(scene.world, scene.meshes) > 0);
+        CheckBatches(t, scene);
+        CHECK(t, scene.batcher.Build(scene.world, scene.meshes) == 0); // nothing is taken twice
+
+        for (size_t i = 0; i < views.size(); ++i) {
+            DrawFrame(scene, views[i].view, true);
+            const std::vector<uint8_t> drawn = DrawnEntities(scene);
+            uint32_t lost = 0;
+            for (size_t e = 0; e < drawn.size(); ++e)
+                lost += drawnBefore[i][e] && !drawn[e] ? 1 : 0;
+            CHECK(t, lost == 0);
+            CHECK(t, scene.renderer.GetStats().draws < drawsBefore[i]);
+        }
+    }
+
+    // Entities destroyed or made non-static after Build leave their batch:
+    // the destroyed ones aren't drawn at all, the others once, on their own.
+    void TestChangesAfterBuild(TestContext& t) {
+        Scene scene;
+        BuildScene(scene, 4000, 16, t.Seed());
+        CHECK(t, scene.batcher.Build(scene.world, scene.meshes) > 0);
+
+        std::vector<uint8_t> change(size_t(scene.world.EntityCount()) + 1, 0); // 1 destroyed, 2 not static
+        const auto& parts = scene.batcher.GetParts();
+        for (size_t p = 0; p < parts.size(); p += 5) {
+            const Entity e = parts[p].entity;
+            if (p % 2) {
+                scene.world.DestroyEntity(e);
+                change[e] = 1;
+            }
+            else {
+                scene.world.RemoveComponent<StaticMesh>(e);
+                change[e] = 2;
+            }
+        }
+
+        uint32_t drawnAlone = 0;
+        for (const View& v : MakeViews(scene.half)) {
+            DrawFrame(scene, v.view, false);
+            const std::vector<uint8_t> alone = DrawnEntities(scene);
+            DrawFrame(scene, v.view, true);
+            const std::vector<uint8_t> drawn = DrawnEntities(scene);
+            bool ok = true;
+            for (size_t e = 0; e < drawn.size(); ++e) {
+                if (change[e] == 1) ok = ok && drawn[e] == 0;
+                if (change[e] == 2) ok = ok && drawn[e] == alone[e] && drawn[e] <= 1;
+                drawnAlone += change[e] == 2 ? drawn[e] : 0;
+            }
+            CHECK(t, ok);
+        }
+        CHECK(t, drawnAlone > 0);
+    }
+
+} // namespace
+
+void RunStaticBatchTests(TestContext& t)
+{
+    TestBatching(t);
+    TestChangesAfterBuild(t);
+}
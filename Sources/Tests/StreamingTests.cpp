@@ -0,0 +1,152 @@
+#include "Tests/Tests.h"
+#include "Bench/StreamingFixture.h"
+#include "Threading/JobSystem.h"
+
+#include <algorithm>
+
+using namespace DirectX;
+using namespace StreamingFixture;
+
+namespace {
+
+    // The StreamingBench defaults.
+    struct Params {
+        uint32_t entities = 2000;
+        float speed = 4.0f;
+        uint32_t mergeKb = 256;
+        double hitchMs = 2.0;
+        uint32_t seed = 1;
+    };
+
+    // Every resident cell holds exactly what its builder made, under its
+    // own IDs; nothing else is in the world; near cells are all there and
+    // far ones are not.
+    void CheckContents(TestContext& t, const CellStreamer& streamer, const World& world, const XMFLOAT3& camera,
+                       uint32_t seed, uint32_t entities) {
+        const CellStreamer::Settings& st = streamer.GetSettings();
+        World expected;
+        uint64_t cellEntities = 0;
+        streamer.ForEachResident([&](CellCoord c, Entity first, uint32_t count) {
+            expected.Reset();
+            BuildCell(seed, entities, c, expected);
+            bool ok = expected.EntityCount() == count;
+            for (Entity e = 1; ok && e <= count; ++e) {
+                const Entity live = first + e - 1;
+                const Transform* a = world.TryGetComponent<Transform>(live);
+                const Transform* b = expected.TryGetComponent<Transform>(e);
+                const CellMarker* m = world.TryGetComponent<CellMarker>(live);
+                const Prop* p = world.TryGetComponent<Prop>(live);
+                const Prop* q = expected.TryGetComponent<Prop>(e);
+                ok = a && b && a->position.x == b->position.x && a->position.y == b->position.y && a->position.z == b->position.z
+                    && m && m->x == c.x && m->z == c.z && m->index == e - 1
+                    && (p != nullptr) == (q != nullptr) && (!p || (p->mass == q->mass && p->kind == q->kind));
+            }
+            CHECK(t, ok);
+            cellEntities += count;
+
+            const float dx = (float(c.x) + 0.5f) * st.cellSize - camera.x;
+            const float dz = (float(c.z) + 0.5f) * st.cellSize - camera.z;
+            CHECK(t, dx * dx + dz * dz <= st.unloadRadius * st.unloadRadius);
+        });
+
+        // Nothing left over from unloaded cells
+        const ComponentPool<CellMarker>* markers = world.FindPool<CellMarker>();
+        const ComponentPool<Transform>* transforms = world.FindPool<Transform>();
+        const size_t markerCount = markers ? markers->Size() : 0;
+        const size_t transformCount = transforms ? transforms->Size() : 0;
+        CHECK(t, markerCount == cellEntities && transformCount == cellEntities
+            && streamer.GetStats().residentEntities == cellEntities);
+
+        // Every cell within loadRadius is resident.
+        const float r = st.loadRadius;
+        const CellCoord lo = streamer.CellAt(XMFLOAT3(camera.x - r, 0.0f, camera.z - r));
+        const CellCoord hi = streamer.CellAt(XMFLOAT3(camera.x + r, 0.0f, camera.z + r));
+        for (int32_t z = lo.z; z <= hi.z; ++z)
+            for (int32_t x = lo.x; x <= hi.x; ++x) {
+                const float dx = (float(x) + 0.5f) * st.cellSize - camera.x;
+                const float dz = (float(z) + 0.5f) * st.cellSize - camera.z;
+                if (dx * dx + dz * dz <= r * r)
+                    CHECK(t, streamer.IsResident(CellCoord{ x, z }));
+            }
+    }
+
+    // The camera path with tight budgets: no Update goes over them, the
+    // world matches the builder now and then and at the end, and unloaded
+    // ID blocks are handed out again.
+    void CheckPath(TestContext& t, JobSystem* jobs, const Params& s, uint32_t frames) {
+        World world;
+        CellStreamer streamer;
+        CellStreamer::Settings st = StreamSettings(s.mergeKb, s.hitchMs);
+        st.mergeBytesPerFrame = 64 * 1024;
+        st.mergeMsPerFrame = 0.0; // only the byte budget, so runs are repeatable
+        st.unloadEntitiesPerFrame = 1000;
+        st.unloadMsPerFrame = 0.0;
+        streamer.SetSettings(st);
+        streamer.SetJobSystem(jobs);
+        streamer.SetBuilder([seed = s.seed, n = s.entities](CellCoord c, World& out) { BuildCell(seed, n, c, out); });
+
+        uint64_t merged = 0;
+        uint32_t peakResident = 0;
+        for (uint32_t frame = 0; frame < frames; ++frame) {
+            const Clock::Ticks start = Clock::NowTicks();
+            const XMFLOAT3 camera = CameraAt(frame, s.speed);
+            streamer.Update(world, camera);
+            const CellStreamerStats& stats = streamer.GetStats();
+            CHECK(t, stats.mergedBytes <= std::max<uint64_t>(st.mergeBytesPerFrame, sizeof(Transform)));
+            CHECK(t, stats.unloadedEntities <= st.unloadEntitiesPerFrame);
+            merged += stats.mergedEntities;
+
+            if (frame % 150 == 149) {
+                CHECK(t, Settle(streamer, world, camera));
+                CheckContents(t, streamer, world, camera, s.seed, s.entities);
+            }
+            peakResident = std::max(peakResident, streamer.GetStats().residentEntities);
+            if (jobs)
+                Pace(start, 1.0); // give the workers some time, but keep the check short
+        }
+        const XMFLOAT3 last = CameraAt(frames - 1, s.speed);
+        CHECK(t, Settle(streamer, world, last));
+        CheckContents(t, streamer, world, last, s.seed, s.entities);
+
+        // IDs come back: far fewer than were ever merged, a few cells more than were ever resident.
+        const CellStreamerStats& stats = streamer.GetStats();
+        CHECK(t, stats.cellsUnloaded > 0 && stats.idsUsed < merged);
+        CHECK(t, stats.idsUsed <= peakResident + 8 * (s.entities + s.entities / 2));
+    }
+
+    // The camera jumps away while cells are still building or waiting to
+    // merge: they are cancelled, and what was partly merged is removed.
+    void CheckCancel(TestContext& t, JobSystem* jobs, const Params& s) {
+        World world;
+        CellStreamer streamer;
+        CellStreamer::Settings st = StreamSettings(s.mergeKb, s.hitchMs);
+        st.mergeBytesPerFrame = 4 * 1024;
+        st.mergeMsPerFrame = 0.0;
+        streamer.SetSettings(st);
+        streamer.SetJobSystem(jobs);
+        streamer.SetBuilder([seed = s.seed, n = s.entities](CellCoord c, World& out) { BuildCell(seed, n, c, out); });
+
+        const XMFLOAT3 home(0.0f, 0.0f, 0.0f);
+        for (uint32_t i = 0; i < 3; ++i)
+            streamer.Update(world, home);
+        const XMFLOAT3 away(100000.0f, 0.0f, -50000.0f);
+        CHECK(t, Settle(streamer, world, away));
+        CheckContents(t, streamer, world, away, s.seed, s.entities);
+        CHECK(t, streamer.GetStats().buildsCancelled > 0);
+
+        CHECK(t, Settle(streamer, world, home));
+        CheckContents(t, streamer, world, home, s.seed, s.entities);
+    }
+
+} // namespace
+
+void RunStreamingTests(TestContext& t)
+{
+    JobSystem jobs;
+    Params params;
+    params.seed = t.Seed();
+    CheckPath(t, nullptr, params, 600);
+    CheckPath(t, &jobs, params, 600);
+    CheckCancel(t, nullptr, params);
+    CheckCancel(t, &jobs, params);
+}
@@ -0,0 +1,190 @@
+#include "Tests/Tests.h"
+#include "Tasks/Task.h"
+#include "Tasks/TaskScheduler.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    Task<> Sleep(TaskScheduler& tasks, double seconds, std::vector<double>& woke) {
+        co_await tasks.Delay(seconds);
+        woke.push_back(seconds);
+    }
+
+    Task<> CountFrames(TaskScheduler& tasks, int frames, int& count) {
+        for (int i = 0; i < frames; ++i) {
+            ++count;
+            co_await tasks.NextFrame();
+        }
+    }
+
+    Task<int> Throws(TaskScheduler& tasks, bool waitFirst) {
+        if (waitFirst) co_await tasks.NextFrame();
+        throw std::runtime_error("inner");
+        co_return 0;
+    }
+
+    Task<> Catches(TaskScheduler& tasks, bool waitFirst, int& caught) {
+        try {
+            co_await Throws(tasks, waitFirst);
+        }
+        catch (const std::runtime_error&) {
+            ++caught;
+        }
+    }
+
+    Task<> AwaitsEmpty(int& caught) {
+        Task<int> empty;
+        try {
+            co_await empty;
+        }
+        catch (const std::logic_error&) {
+            ++caught;
+        }
+    }
+
+    Task<int> Twice(TaskScheduler& tasks, int v) {
+        co_await tasks.NextFrame();
+        co_return v * 2;
+    }
+
+    Task<> SumOfTwice(TaskScheduler& tasks, int v, int& sum) {
+        sum += co_await Twice(tasks, v);
+    }
+
+    template<typename Asset>
+    Task<> WaitForAsset(TaskScheduler& tasks, Asset& asset, int& value, bool& onMain, bool& failed) {
+        const int& v = co_await tasks.AssetLoaded(asset);
+        failed = asset.Failed();
+        if (!failed) value = v;
+        onMain = tasks.IsMainThread();
+    }
+
+    // Delays wake in order of their end time, not of their start, and only
+    // on the first Pump at or after it.
+    void TestDelayOrder(TestContext& t) {
+        TaskScheduler tasks;
+        std::vector<double> woke;
+        const double start = Clock::Now();
+        for (double seconds : { 0.3, 0.1, 0.2 })
+            tasks.Spawn(Sleep(tasks, seconds, woke));
+        CHECK(t, tasks.GetStats().sleeping == 3);
+
+        tasks.Pump(start + 0.05);
+        CHECK(t, woke.empty());
+        tasks.Pump(start + 0.15);
+        CHECK(t, woke == std::vector<double>{ 0.1 });
+        tasks.Pump(start + 10.0);
+        CHECK(t, (woke == std::vector<double>{ 0.1, 0.2, 0.3 }));
+        CHECK(t, tasks.GetStats().finished == 3 && tasks.GetStats().sleeping == 0);
+
+        // Zero seconds on the main thread does not wait at all.
+        tasks.Spawn(Sleep(tasks, 0.0, woke));
+        CHECK(t, woke.size() == 4);
+    }
+
+    // A NextFrame loop advances exactly once per Pump: a task that waits
+    // again while being resumed goes to the next Pump.
+    void TestNextFrame(TestContext& t) {
+        TaskScheduler tasks;
+        int count = 0;
+        tasks.Spawn(CountFrames(tasks, 5, count));
+        CHECK(t, count == 1);
+        bool once = true;
+        for (int frame = 2; frame <= 5; ++frame) {
+            tasks.Pump(Clock::Now());
+            once = once && count == frame && tasks.GetStats().resumedLastPump == 1;
+        }
+        CHECK(t, once);
+        CHECK(t, tasks.GetStats().running == 1);
+        tasks.Pump(Clock::Now());
+        CHECK(t, count == 5 && tasks.GetStats().running == 0 && tasks.GetStats().finished == 1);
+    }
+
+    // A throwing load ends loaded and Failed, and its waiter still resumes.
+    // A good one on a worker hands its value to a waiter on the main thread.
+    void TestLoadAsync(TestContext& t) {
+        TaskScheduler tasks;
+        auto bad = tasks.LoadAsync<int>([]() -> int { throw std::runtime_error("missing file"); });
+        CHECK(t, bad->IsLoaded() && bad->Failed());
+        int value = 0;
+        bool onMain = false, failed = false;
+        tasks.Spawn(WaitForAsset(tasks, *bad, value, onMain, failed));
+        CHECK(t, failed && onMain && value == 0 && tasks.GetStats().finished == 1);
+
+        JobSystem jobs(2);
+        tasks.SetJobSystem(&jobs);
+        std::atomic<bool> release{ false };
+        auto good = tasks.LoadAsync<int>([&release] {
+            while (!release.load()) std::this_thread::yield();
+            return 42;
+        });
+        tasks.Spawn(WaitForAsset(tasks, *good, value, onMain, failed));
+        CHECK(t, !good->IsLoaded() && tasks.GetStats().running == 1);
+        release = true;
+        while (!good->IsLoaded()) std::this_thread::yield();
+        CHECK(t, value == 0); // loaded, but waiters resume in Pump
+        tasks.Pump(Clock::Now());
+        CHECK(t, value == 42 && onMain && !failed && tasks.GetStats().running == 0);
+    }
+
+    // An exception comes out of the co_await that waits for the task,
+    // right away or frames later. Spawned tasks that throw are counted.
+    void TestExceptions(TestContext& t) {
+        TaskScheduler tasks;
+        int caught = 0;
+        tasks.Spawn(Catches(tasks, false, caught));
+        CHECK(t, caught == 1);
+        tasks.Spawn(Catches(tasks, true, caught));
+        CHECK(t, caught == 1);
+        tasks.Pump(Clock::Now());
+        CHECK(t, caught == 2 && tasks.GetStats().failed == 0);
+
+        tasks.Spawn(Throws(tasks, false));
+        tasks.Spawn(Throws(tasks, true));
+        tasks.Pump(Clock::Now());
+        CHECK(t, tasks.GetStats().failed == 2 && tasks.GetStats().running == 0);
+
+        tasks.Spawn(AwaitsEmpty(caught));
+        CHECK(t, caught == 3);
+    }
+
+    // Frames go back to the pool's free lists: once warm, spawning and
+    // awaiting the same amount of work takes nothing from the heap.
+    void TestFramePool(TestContext& t) {
+        TaskScheduler tasks;
+        auto cycle = [&tasks] {
+            int sum = 0;
+            for (int i = 0; i < 32; ++i)
+                tasks.Spawn(SumOfTwice(tasks, i, sum));
+            tasks.Pump(Clock::Now());
+            return sum;
+        };
+        CHECK(t, cycle() == 992);
+        const uint64_t live = TaskFramePool::LiveFrames();
+        const uint64_t heap = TaskFramePool::HeapAllocations();
+        bool same = true;
+        for (int i = 0; i < 100; ++i)
+            same = same && cycle() == 992;
+        CHECK(t, same);
+        CHECK(t, TaskFramePool::HeapAllocations() == heap);
+        CHECK(t, TaskFramePool::LiveFrames() == live);
+        CHECK(t, tasks.GetStats().frameHeapAllocations == heap);
+    }
+
+} // namespace
+
+void RunTaskTests(TestContext& t)
+{
+    TestDelayOrder(t);
+    TestNextFrame(t);
+    TestLoadAsync(t);
+    TestExceptions(t);
+    TestFramePool(t);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+
+/*
+ * Test
+ * Dreivy.Tests is a console program of plain functions, one per area (the
+ * list is in TestMain.cpp), that CHECK what must hold. A failed CHECK
+ * prints the expression with its file and line and the run goes on, so one
+ * run shows every failure. Nothing here opens a window or a device: the
+ * renderer side is tested through NullRenderer and small stand-ins for the
+ * backend interfaces, so the tests also run on a build machine.
+ */
+class TestContext {
+public:
+    explicit TestContext(uint32_t seed) : m_seed(seed ? seed : 1) {}
+
+    // True if `ok`. A failure prints where it was; after MaxPrinted only counts,
+    // so a check inside a loop over a million items doesn't flood the log.
+    bool Check(bool ok, const char* expression, const char* file, int line) {
+        ++m_checks;
+        if (ok) return true;
+        if (m_failures++ < MaxPrinted)
+            std::fprintf(stderr, "%s(%d): CHECK(%s) failed\n", file, line, expression);
+        return false;
+    }
+
+    // --seed=N on the command line, 1 by default: every random scene is
+    // built from it, so a failure can be reproduced exactly.
+    uint32_t Seed() const { return m_seed; }
+    uint32_t Checks() const { return m_checks; }
+    uint32_t Failures() const { return m_failures; }
+
+private:
+    static constexpr uint32_t MaxPrinted = 20;
+
+    uint32_t m_seed;
+    uint32_t m_checks = 0;
+    uint32_t m_failures = 0;
+};
+
+#define CHECK(t, expression) (t).Check(bool(expression), #expression, __FILE__, __LINE__)
@@ -0,0 +1,90 @@
+#include "Tests/Tests.h"
+#include <cstdlib>
+#include <cstring>
+
+#include "Timing/Clock.h"
+
+/*
+ * Dreivy.Tests.exe [area ...] [--seed=N]
+ * Runs every area, or only the named ones ("math physics").
+ * Exit code: 0 all checks passed, 1 a check failed, 2 bad arguments.
+ */
+namespace {
+
+    struct Suite {
+        const char* name;
+        void (*run)(TestContext&);
+    };
+
+    const Suite Suites[] = {
+        { "math",        RunMathTests },
+        { "query",       RunQueryTests },
+        { "commands",    RunCommandTests },
+        { "events",      RunEventTests },
+        { "spatial",     RunSpatialTests },
+        { "physics",     RunPhysicsTests },
+        { "animation",   RunAnimationTests },
+        { "particles",   RunParticleTests },
+        { "streaming",   RunStreamingTests },
+        { "static",      RunStaticBatchTests },
+        { "upload",      RunUploadTests },
+        { "graph",       RunRenderGraphTests },
+        { "shaders",     RunShaderCacheTests },
+        { "snapshot",    RunSnapshotTests },
+        { "timing",      RunTimingTests },
+        { "input",       RunInputTests },
+        { "lod",         RunLodTests },
+        { "vertex",      RunVertexTests },
+        { "meshlets",    RunMeshletTests },
+        { "profiler",    RunProfilerTests },
+        { "tasks",       RunTaskTests },
+        { "memory",      RunAllocatorTests },
+        { "pipeline",    RunPipelineTests },
+    };
+
+    bool Selected(const Suite& suite, int argc, char** argv) {
+        bool any = false;
+        for (int i = 1; i < argc; ++i) {
+            if (argv[i][0] == '-') continue;
+            any = true;
+            if (std::strcmp(argv[i], suite.name) == 0) return true;
+        }
+        return !any;
+    }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--seed=", 7) == 0) {
+            seed = uint32_t(std::strtoul(argv[i] + 7, nullptr, 10));
+            continue;
+        }
+        if (argv[i][0] == '-') {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+        bool known = false;
+        for (const Suite& s : Suites) known |= std::strcmp(argv[i], s.name) == 0;
+        if (!known) {
+            std::fprintf(stderr, "unknown area %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    uint32_t failed = 0;
+    for (const Suite& suite : Suites) {
+        if (!Selected(suite, argc, argv)) continue;
+
+        TestContext t(seed);
+        const Clock::Ticks start = Clock::NowTicks();
+        suite.run(t);
+        const double ms = Clock::ToMilliseconds(Clock::NowTicks() - start);
+        std::printf("%-10s %6u checks  %4u failed  %8.1f ms\n", suite.name, t.Checks(), t.Failures(), ms);
+        failed += t.Failures() ? 1 : 0;
+    }
+    std::printf("%s\n", failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
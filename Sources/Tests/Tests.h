@@ -0,0 +1,27 @@
+#pragma once
+#include "Tests/Test.h"
+
+// One function per area, each in its own file (MathTests.cpp, ...).
+void RunMathTests(TestContext& t);
+void RunQueryTests(TestContext& t);
+void RunCommandTests(TestContext& t);
+void RunEventTests(TestContext& t);
+void RunSpatialTests(TestContext& t);
+void RunPhysicsTests(TestContext& t);
+void RunAnimationTests(TestContext& t);
+void RunParticleTests(TestContext& t);
+void RunStreamingTests(TestContext& t);
+void RunStaticBatchTests(TestContext& t);
+void RunUploadTests(TestContext& t);
+void RunRenderGraphTests(TestContext& t);
+void RunShaderCacheTests(TestContext& t);
+void RunSnapshotTests(TestContext& t);
+void RunTimingTests(TestContext& t);
+void RunInputTests(TestContext& t);
+void RunLodTests(TestContext& t);
+void RunVertexTests(TestContext& t);
+void RunMeshletTests(TestContext& t);
+void RunProfilerTests(TestContext& t);
+void RunTaskTests(TestContext& t);
+void RunAllocatorTests(TestContext& t);
+void RunPipelineTests(TestContext& t);
@@ -0,0 +1,136 @@
+#include "Tests/Tests.h"
+#include "Timing/FixedTimestep.h"
+#include "Timing/FrameStats.h"
+#include "Timing/LatencyTracker.h"
+#include "Timing/StageTimes.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+    // Nearest rank: every percentile is one of the times.
+    void TestSummarize(TestContext& t) {
+        std::vector<double> ms;
+        for (int i = 100; i >= 1; --i) ms.push_back(double(i));
+        const FrameTimeSummary s = SummarizeTimes(ms);
+        CHECK(t, s.frames == 100 && s.averageMs == 50.5);
+        CHECK(t, s.p50Ms == 50.0 && s.p95Ms == 95.0 && s.p99Ms == 99.0 && s.maxMs == 100.0);
+        CHECK(t, ms.front() == 1.0); // sorted in place
+
+        std::vector<double> one = { 3.0 };
+        const FrameTimeSummary o = SummarizeTimes(one);
+        CHECK(t, o.p50Ms == 3.0 && o.p99Ms == 3.0 && o.maxMs == 3.0);
+        std::vector<double> none;
+        CHECK(t, SummarizeTimes(none).frames == 0);
+    }
+
+    // The window keeps only the last times, and all three users agree.
+    void TestWindows(TestContext& t) {
+        TimeWindow window(4);
+        CHECK(t, window.Count() == 0 && window.Summary().frames == 0 && window.Median() == 0.0);
+        for (int i = 1; i <= 10; ++i) window.Push(double(i));
+        const FrameTimeSummary w = window.Summary();
+        CHECK(t, window.Count() == 4 && w.frames == 4 && w.averageMs == 8.5 && w.maxMs == 10.0);
+        CHECK(t, window.Median() == 9.0);
+
+        FrameStats frames(FrameStatsSettings{ 4, 2.0, 8.0 });
+        StageTimes stages(4);
+        for (int i = 1; i <= 10; ++i) {
+            frames.EndFrame(double(i));
+            stages.Add(FrameStage::Draw, double(i));
+            stages.EndFrame();
+        }
+        const FrameTimeSummary f = frames.GetSummary();
+        const FrameTimeSummary s = stages.GetSummary(FrameStage::Draw);
+        CHECK(t, f.frames == w.frames && f.averageMs == w.averageMs && f.p99Ms == w.p99Ms && f.maxMs == w.maxMs);
+        CHECK(t, s.frames == w.frames && s.averageMs == w.averageMs && s.p50Ms == w.p50Ms && s.maxMs == w.maxMs);
+        CHECK(t, stages.GetSummary(FrameStage::Update).maxMs == 0.0);
+    }
+
+    // A frame far slower than the median of the ones before it is a hitch.
+    void TestHitches(TestContext& t) {
+        FrameStats frames;
+        for (int i = 0; i < 60; ++i) frames.EndFrame(16.0);
+        CHECK(t, frames.HitchCount() == 0);
+        frames.EndFrame(50.0);
+        CHECK(t, frames.HitchCount() == 1 && frames.LastHitchMs() == 50.0 && frames.LastHitchFrame() == 60);
+        frames.EndFrame(20.0);
+        CHECK(t, frames.HitchCount() == 1);
+    }
+
+    // Simulated time, the fraction in the accumulator and the dropped time
+    // always add up to the real time that went in; Alpha stays in [0, 1).
+    void TestFixedTimestep(TestContext& t) {
+        FixedTimestep exact;
+        bool oneEach = true;
+        for (int i = 0; i < 600; ++i)
+            oneEach = oneEach && exact.Advance(1.0 / 60.0) == 1 && exact.Alpha() == 0.0f;
+        CHECK(t, oneEach && exact.TickCount() == 600 && exact.DroppedFrames() == 0);
+
+        // 144 Hz frames on a 60 Hz tick: zero or one tick a frame.
+        FixedTimestep fractional;
+        double real = 0.0;
+        bool accounted = true, alphaInRange = true, atMostOne = true;
+        for (int i = 0; i < 1440; ++i) {
+            atMostOne = atMostOne && fractional.Advance(1.0 / 144.0) <= 1;
+            real += 1.0 / 144.0;
+            const double a = fractional.Alpha();
+            alphaInRange = alphaInRange && a >= 0.0 && a < 1.0;
+            accounted = accounted && std::fabs(fractional.SimulationTime() + a * fractional.StepSeconds() - real) < 1e-7;
+        }
+        CHECK(t, atMostOne);
+        CHECK(t, alphaInRange);
+        CHECK(t, accounted);
+        CHECK(t, fractional.TickCount() >= 599 && fractional.TickCount() <= 600 && fractional.DroppedFrames() == 0);
+
+        // A 10 s stall runs the cap and throws the rest away, once.
+        FixedTimestep stall(FixedTimestepSettings{ 60.0, 5 });
+        stall.Advance(0.5 / 60.0);
+        CHECK(t, stall.Advance(10.0) == 5);
+        CHECK(t, stall.DroppedFrames() == 1 && stall.TickCount() == 5);
+        CHECK(t, stall.Alpha() >= 0.0f && stall.Alpha() < 1.0f);
+        CHECK(t, std::fabs(stall.SimulationTime() + stall.Alpha() * stall.StepSeconds() + stall.DroppedSeconds() - (10.0 + 0.5 / 60.0)) < 1e-6);
+        CHECK(t, stall.Advance(1.0 / 60.0) == 1 && stall.DroppedFrames() == 1);
+
+        // Exactly the cap's worth is not a drop; nothing and negative times are no ticks.
+        FixedTimestep capped(FixedTimestepSettings{ 64.0, 3 });
+        CHECK(t, capped.Advance(3.0 / 64.0) == 3 && capped.DroppedFrames() == 0);
+        CHECK(t, capped.Advance(0.0) == 0 && capped.Advance(-1.0) == 0 && capped.TickCount() == 3);
+    }
+
+    // Only the first input before a present is measured; presents with no
+    // input in between add no sample.
+    void TestLatency(TestContext& t) {
+        LatencyTracker latency;
+        latency.MarkPresent(0.5);
+        CHECK(t, latency.Samples() == 0);
+
+        latency.MarkInput(1.000);
+        latency.MarkInput(1.004);
+        latency.MarkInput(1.010);
+        latency.MarkPresent(1.020);
+        CHECK(t, latency.Samples() == 1 && std::fabs(latency.LastMs() - 20.0) < 1e-9);
+
+        latency.MarkPresent(1.030);
+        CHECK(t, latency.Samples() == 1);
+
+        latency.MarkInput(2.000);
+        latency.MarkPresent(2.040);
+        CHECK(t, latency.Samples() == 2 && std::fabs(latency.LastMs() - 40.0) < 1e-9);
+        CHECK(t, std::fabs(latency.MaxMs() - 40.0) < 1e-9 && std::fabs(latency.AverageMs() - 30.0) < 1e-9);
+
+        latency.Reset();
+        CHECK(t, latency.Samples() == 0 && latency.AverageMs() == 0.0);
+    }
+
+} // namespace
+
+void RunTimingTests(TestContext& t)
+{
+    TestSummarize(t);
+    TestWindows(t);
+    TestHitches(t);
+    TestFixedTimestep(t);
+    TestLatency(t);
+}
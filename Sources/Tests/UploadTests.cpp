@@ -0,0 +1,194 @@
+#include "Tests/Tests.h"
+#include "Bench/UploadFixture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+using namespace UploadFixture;
+
+namespace {
+
+    // An upload target that checks instead of creating buffers: the staged
+    // copy must equal the mesh, and must not be written over while its
+    // frame is in flight.
+    class CheckingTarget : public IUploadTarget {
+    public:
+        uint32_t failures = 0;
+        uint32_t created = 0;
+
+        uint8_t* MapStaging(uint64_t capacity) override {
+            if (m_ring.size() != capacity) {
+                m_ring.assign(size_t(capacity), 0xCD); // a new ring: nothing of the old one is in flight
+                m_staged.clear();
+            }
+            return m_ring.data();
+        }
+        void UnmapStaging() override {}
+
+        bool CreateMesh(MeshHandle, const MeshData& mesh, uint64_t vertexOffset, uint64_t indexOffset) override {
+            std::vector<uint8_t> indices;
+            for (uint32_t lod = 0; lod < mesh.LodCount(); ++lod) {
+                const auto& lodIndices = mesh.LodIndices(lod);
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(lodIndices.data());
+                indices.insert(indices.end(), bytes, bytes + lodIndices.size() * sizeof(uint32_t));
+            }
+            failures += vertexOffset % 16 == 0 && indexOffset % 16 == 0 ? 0 : 1;
+            Stage(vertexOffset, mesh.vertexStream.bytes);
+            Stage(indexOffset, indices);
+            ++created;
+            return true;
+        }
+
+        // After the frame's uploads: what frames in flight staged is intact.
+        void EndFrame(uint32_t framesInFlight) {
+            for (const Staged& s : m_staged)
+                failures += Intact(s.offset, s.bytes) ? 0 : 1;
+            m_staged.erase(std::remove_if(m_staged.begin(), m_staged.end(), [&](const Staged& s) {
+                return s.frame + framesInFlight <= m_frame;
+            }), m_staged.end());
+            ++m_frame;
+        }
+
+    private:
+        struct Staged {
+            uint64_t frame;
+            uint64_t offset;
+            std::vector<uint8_t> bytes;
+        };
+
+        bool Intact(uint64_t offset, const std::vector<uint8_t>& bytes) const {
+            return offset + bytes.size() <= m_ring.size() &&
+                (bytes.empty() || std::memcmp(m_ring.data() + offset, bytes.data(), bytes.size()) == 0);
+        }
+
+        void Stage(uint64_t offset, const std::vector<uint8_t>& bytes) {
+            failures += Intact(offset, bytes) ? 0 : 1;
+            m_staged.push_back({ m_frame, offset, bytes });
+        }
+
+        std::vector<uint8_t> m_ring;
+        std::vector<Staged> m_staged;
+        uint64_t m_frame = 0;
+    };
+
+    // The scheduling rules, frame by frame, on a small ring.
+    void CheckQueue(TestContext& t, const Road& road, uint32_t budgetKb) {
+        MeshStorage meshes;
+        RenderQueue queue;
+        CheckingTarget target;
+        UploadQueue uploads(target);
+        UploadQueue::Settings us;
+        us.bytesPerFrame = uint64_t(budgetKb) << 10;
+        us.msPerFrame = 0.0; // bytes only: the same result on every machine
+        us.stagingBytes = uint64_t(budgetKb) << 11;
+        uploads.SetSettings(us);
+
+        std::vector<MeshHandle> handles;
+        std::vector<MeshHandle> changed;
+        uint32_t reuploaded = 0;
+        std::vector<float> distance;
+        for (uint32_t frame = 0; frame < road.frames; ++frame) {
+            const Camera camera = StepRoad(road, frame, meshes, handles, queue);
+
+            // From a quarter of the way, a few visible rocks change (once
+            // some are resident).
+            if (frame >= road.frames / 4 && changed.empty()) {
+                for (const RenderItem& item : queue.GetItems()) {
+                    if (changed.size() == 4) break;
+                    if (!uploads.IsResident(item.mesh)) continue;
+                    uploads.Invalidate(item.mesh);
+                    changed.push_back(item.mesh);
+                }
+            }
+
+            distance.assign(meshes.Count() + 1, -1.0f);
+            for (const RenderItem& item : queue.GetItems()) {
+                distance[item.mesh] = Distance(item, camera);
+                uploads.Request(item.mesh, distance[item.mesh]);
+            }
+            uploads.Update(meshes);
+            target.EndFrame(us.framesInFlight);
+
+            // In budget, unless one mesh alone is over it.
+            const UploadStats& st = uploads.GetStats();
+            CHECK(t, st.bytes <= us.bytesPerFrame || st.meshes == 1);
+
+            // Visible ones first, nearest first; a prefetch only once every
+            // visible mesh is resident.
+            float last = 0.0f;
+            bool prefetched = false;
+            for (MeshHandle h : uploads.GetUploaded()) {
+                if (std::find(changed.begin(), changed.end(), h) != changed.end())
+                    ++reuploaded;
+                if (distance[h] < 0.0f) {
+                    prefetched = true;
+                    continue;
+                }
+                CHECK(t, !prefetched && distance[h] >= last);
+                last = distance[h];
+            }
+            for (const RenderItem& item : queue.GetItems()) {
+                if (uploads.IsResident(item.mesh)) continue;
+                CHECK(t, !prefetched && distance[item.mesh] >= last);
+            }
+
+            // Changed meshes keep being drawn with their old buffers.
+            for (MeshHandle h : changed)
+                CHECK(t, uploads.IsResident(h));
+        }
+
+        // Then nothing in view: the queue drains on its own.
+        queue.Clear();
+        for (uint32_t frame = 0; frame < 10000 && uploads.GetStats().pending > 0; ++frame) {
+            uploads.Update(meshes);
+            target.EndFrame(us.framesInFlight);
+            for (MeshHandle h : uploads.GetUploaded())
+                if (std::find(changed.begin(), changed.end(), h) != changed.end())
+                    ++reuploaded;
+        }
+
+        const UploadStats& st = uploads.GetStats();
+        for (MeshHandle h : handles)
+            CHECK(t, uploads.IsResident(h));
+        CHECK(t, handles.size() == road.rocks.size());
+        CHECK(t, st.pending == 0 && st.pendingBytes == 0 && st.failed == 0);
+        CHECK(t, !changed.empty() && reuploaded == changed.size());
+        CHECK(t, st.totalMeshes == handles.size() + changed.size() && target.created == st.totalMeshes);
+        const uint64_t bigRock = UploadSize(*meshes.Get(handles[handles.size() / 2]));
+        CHECK(t, bigRock <= us.stagingBytes || st.ringGrowths > 0);
+        CHECK(t, target.failures == 0);
+    }
+
+    // Every item in the queue is either drawn or counted as not ready;
+    // without a budget every mesh goes up before it is drawn.
+    void CheckDrawn(TestContext& t, const Road& road, const UploadQueue::Settings& us, bool unlimited) {
+        uint32_t lost = 0, notReady = 0;
+        DriveRoad(road, us, [&](NullRenderer& renderer, const RenderQueue& queue) {
+            const RendererStats& rs = renderer.GetStats();
+            lost += uint32_t(queue.GetItems().size()) - rs.draws - rs.notReady;
+            notReady += rs.notReady;
+        });
+        CHECK(t, lost == 0);
+        CHECK(t, !unlimited || notReady == 0);
+    }
+
+} // namespace
+
+void RunUploadTests(TestContext& t)
+{
+    // The UploadBench defaults.
+    const Road road = MakeRoad(400, 600, t.Seed());
+    CheckQueue(t, road, 256);
+
+    UploadQueue::Settings budgeted;
+    budgeted.bytesPerFrame = 256ull << 10;
+    budgeted.msPerFrame = 0.0;
+    budgeted.stagingBytes = 2048ull << 10;
+    UploadQueue::Settings unlimited = budgeted;
+    unlimited.bytesPerFrame = 0;
+    unlimited.stagingBytes = 32ull << 20;
+    CheckDrawn(t, road, budgeted, false);
+    CheckDrawn(t, road, unlimited, true);
+}
@@ -0,0 +1,165 @@
+#include "Tests/Tests.h"
+#include "Renderer/MeshStorage.h"
+#include "Renderer/VertexFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+using namespace DirectX;
+using namespace VertexPacking;
+
+namespace {
+
+    // xorshift32, 0..1.
+    float Random(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return float(state >> 8) / float(1u << 24);
+    }
+
+    XMFLOAT3 Normalized(float x, float y, float z) {
+        const float len = std::sqrt(x * x + y * y + z * z);
+        return { x / len, y / len, z / len };
+    }
+
+    float AngleDegrees(const XMFLOAT3& a, const XMFLOAT3& b) {
+        const double dot = double(a.x) * b.x + double(a.y) * b.y + double(a.z) * b.z;
+        return float(std::acos(std::clamp(dot, -1.0, 1.0)) * 180.0 / 3.14159265358979);
+    }
+
+    // Random points in a box of different extents per axis, plus the
+    // corners, which land exactly on 0 and 65535.
+    MeshData RandomMesh(uint32_t count, uint32_t seed) {
+        uint32_t rng = seed ? seed : 1;
+        MeshData mesh;
+        const XMFLOAT3 lo = { -3.0f, 10.0f, -0.25f }, extent = { 6.0f, 250.0f, 0.5f };
+        for (uint32_t i = 0; i < count; ++i) {
+            mesh.positions.push_back({ lo.x + Random(rng) * extent.x, lo.y + Random(rng) * extent.y, lo.z + Random(rng) * extent.z });
+            const XMFLOAT3 n = Normalized(Random(rng) * 2 - 1, Random(rng) * 2 - 1, Random(rng) * 2 - 1);
+            mesh.normals.push_back(n);
+            const XMFLOAT3 tn = Normalized(Random(rng) * 2 - 1, Random(rng) * 2 - 1, Random(rng) * 2 - 1);
+            mesh.tangents.push_back({ tn.x, tn.y, tn.z, i % 2 ? 1.0f : -1.0f });
+            mesh.uvs.push_back({ Random(rng), Random(rng) });
+        }
+        mesh.positions.push_back(lo);
+        mesh.positions.push_back({ lo.x + extent.x, lo.y + extent.y, lo.z + extent.z });
+        // The octahedron's folds and poles are where the encoding is least regular.
+        const XMFLOAT3 edges[] = { { 0, 0, 1 }, { 0, 0, -1 }, { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 },
+                                   Normalized(1, 1, 0), Normalized(-1, 1, -0.001f) };
+        for (uint32_t k = 0; k < 2; ++k) {
+            mesh.normals.push_back(edges[k * 4]);
+            mesh.tangents.push_back({ edges[k * 4 + 2].x, edges[k * 4 + 2].y, edges[k * 4 + 2].z, 1.0f });
+            mesh.uvs.push_back({ 0.0f, 1.0f });
+        }
+        for (const XMFLOAT3& n : edges) {
+            mesh.positions.push_back(lo);
+            mesh.normals.push_back(n);
+            mesh.tangents.push_back({ n.y, n.z, n.x, 1.0f });
+            mesh.uvs.push_back({ 0.0f, 0.0f });
+        }
+        return mesh;
+    }
+
+    // Positions come back within one quantization step (extent / 65535) on
+    // every axis, normals and tangents within a few hundredths of a degree,
+    // and the tangent keeps its handedness.
+    void TestPackedRoundTrip(TestContext& t) {
+        MeshStorage meshes;
+        const MeshData source = RandomMesh(4096, t.Seed());
+        const MeshData& mesh = *meshes.Get(meshes.AddMerged(source));
+        const VertexStream& vs = mesh.vertexStream;
+        CHECK(t, vs.format == VertexFormat::Packed && vs.stride == sizeof(PackedVertex));
+        CHECK(t, vs.bytes.size() == source.positions.size() * sizeof(PackedVertex));
+
+        const float extent[3] = { vs.positionScale.x, vs.positionScale.y, vs.positionScale.z };
+        const float offset[3] = { vs.positionOffset.x, vs.positionOffset.y, vs.positionOffset.z };
+        float worstNormal = 0.0f, worstTangent = 0.0f;
+        bool positions = true, handedness = true;
+        const auto* packed = reinterpret_cast<const PackedVertex*>(vs.bytes.data());
+        for (size_t i = 0; i < source.positions.size(); ++i) {
+            const PackedVertex& v = packed[i];
+            const float p[3] = { source.positions[i].x, source.positions[i].y, source.positions[i].z };
+            for (int a = 0; a < 3; ++a)
+                positions = positions && std::fabs(DequantizeUnorm16(v.position[a], offset[a], extent[a]) - p[a]) <= extent[a] / 65535.0f;
+
+            worstNormal = std::max(worstNormal, AngleDegrees(DecodeOctahedral(v.normal), source.normals[i]));
+            const XMFLOAT4& tn = source.tangents[i];
+            worstTangent = std::max(worstTangent, AngleDegrees(DecodeOctahedral(v.tangent), { tn.x, tn.y, tn.z }));
+            handedness = handedness && (v.position[3] / 65535.0f * 2.0f - 1.0f) == tn.w;
+        }
+        CHECK(t, positions);
+        CHECK(t, worstNormal < 0.05f);
+        CHECK(t, worstTangent < 0.05f);
+        CHECK(t, handedness);
+    }
+
+    // Half-float UVs: 0, 1, negative and tiling values are exact, the rest
+    // within half a step of 11 significant bits. Large values round but
+    // stay finite up to 65504.
+    void TestHalfUvs(TestContext& t) {
+        const float exact[] = { 0.0f, 1.0f, 0.5f, -1.0f, -0.25f, 2.0f, 16.0f, 1024.0f, 65504.0f, -65504.0f };
+        const float rounded[] = { 0.1f, 0.3333f, 0.999f, -0.7f, 3.14159f, 100.01f, 4097.0f, 60000.3f };
+
+        MeshData mesh;
+        for (float u : exact) {
+            mesh.positions.push_back({ u, 0.0f, 0.0f });
+            mesh.uvs.push_back({ u, -u });
+        }
+        for (float u : rounded) {
+            mesh.positions.push_back({ u, 0.0f, 0.0f });
+            mesh.uvs.push_back({ u, -u });
+        }
+
+        MeshStorage meshes;
+        const VertexStream& vs = meshes.Get(meshes.AddMerged(mesh))->vertexStream;
+        CHECK(t, vs.format == VertexFormat::Packed);
+        const auto* packed = reinterpret_cast<const PackedVertex*>(vs.bytes.data());
+        for (size_t i = 0; i < mesh.uvs.size(); ++i) {
+            const float u = PackedVector::XMConvertHalfToFloat(packed[i].uv[0]);
+            const float v = PackedVector::XMConvertHalfToFloat(packed[i].uv[1]);
+            if (i < std::size(exact)) {
+                CHECK(t, u == mesh.uvs[i].x && v == mesh.uvs[i].y);
+            }
+            else {
+                const float tolerance = std::fabs(mesh.uvs[i].x) / 2048.0f;
+                CHECK(t, std::fabs(u - mesh.uvs[i].x) <= tolerance && std::fabs(v - mesh.uvs[i].y) <= tolerance);
+            }
+        }
+    }
+
+    // Without normals, tangents or UVs the stream is position only, 8 bytes
+    // a vertex, with the same precision.
+    void TestQuantizedOnly(TestContext& t) {
+        MeshData mesh = RandomMesh(1024, t.Seed() + 1);
+        mesh.normals.clear();
+        mesh.tangents.clear();
+        mesh.uvs.clear();
+
+        MeshStorage meshes;
+        const VertexStream& vs = meshes.Get(meshes.AddMerged(mesh))->vertexStream;
+        CHECK(t, vs.format == VertexFormat::Quantized && vs.stride == sizeof(QuantizedVertex));
+        CHECK(t, vs.stats.rawStride == 12 && vs.stats.packedStride == 8);
+
+        const auto* packed = reinterpret_cast<const QuantizedVertex*>(vs.bytes.data());
+        bool positions = true;
+        for (size_t i = 0; i < mesh.positions.size(); ++i) {
+            const XMFLOAT3& p = mesh.positions[i];
+            positions = positions
+                && std::fabs(DequantizeUnorm16(packed[i].position[0], vs.positionOffset.x, vs.positionScale.x) - p.x) <= vs.positionScale.x / 65535.0f
+                && std::fabs(DequantizeUnorm16(packed[i].position[1], vs.positionOffset.y, vs.positionScale.y) - p.y) <= vs.positionScale.y / 65535.0f
+                && std::fabs(DequantizeUnorm16(packed[i].position[2], vs.positionOffset.z, vs.positionScale.z) - p.z) <= vs.positionScale.z / 65535.0f;
+        }
+        CHECK(t, positions);
+    }
+
+} // namespace
+
+void RunVertexTests(TestContext& t)
+{
+    TestPackedRoundTrip(t);
+    TestHalfUvs(t);
+    TestQuantizedOnly(t);
+}
@@ -0,0 +1,210 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include "Profiling/Profiler.h"
+#include "Memory/AllocTracker.h"
+
+/*
+ * JobSystem
+ * A plain thread pool shared by the whole engine.
+ *
+ * - Submit(job)            : run a function on some worker, fire and forget
+ * - ParallelFor(n, g, fn)  : split [0, n) into chunks of `g` and run fn(begin, end)
+ *                            on the workers AND the calling thread, returns when all are done
+ *
+ * The calling thread always helps with its own ParallelFor, so calling it
+ * from inside a job can't deadlock, and with 0 workers everything
+ * simply runs on the caller.
+ *
+ * ThreadIndex() is 1..WorkerCount() on the workers and 0 everywhere else,
+ * for per-thread data such as EntityCommands buffers.
+ */
+class JobSystem {
+public:
+    // 0 = one worker per hardware thread, minus the main thread.
+    explicit JobSystem(uint32_t workerCount = 0) {
+        if (workerCount == 0) {
+            unsigned hw = std::thread::hardware_concurrency();
+            workerCount = hw > 1 ? hw - 1 : 1;
+        }
+        m_workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; ++i)
+            m_workers.emplace_back([this, i] {
+                t_threadIndex = i + 1;
+                Profiler::SetThreadName("Worker " + std::to_string(i + 1));
+                WorkerLoop();
+            });
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto& t : m_workers)
+            t.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    uint32_t WorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+    static uint32_t ThreadIndex() { return t_threadIndex; }
+
+    void Submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            PushJob(std::move(job));
+        }
+        m_cv.notify_one();
+    }
+
+    template<typename Fn>
+    void ParallelFor(uint32_t count, uint32_t grain, Fn&& fn) {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+
+        const uint32_t chunks = (count + grain - 1) / grain;
+        if (chunks == 1 || m_workers.empty()) {
+            fn(0u, count);
+            return;
+        }
+
+        // Shared with the helpers. A helper may only get scheduled after
+        // we returned, so this can't live on our stack. It comes from a
+        // free list instead of the heap, and whoever is the last to let go
+        // of it (us or a late helper) puts it back.
+        ForState* state = AcquireForState();
+        state->body = &fn;
+        state->invoke = [](void* body, uint32_t begin, uint32_t end) {
+            (*static_cast<std::remove_reference_t<Fn>*>(body))(begin, end);
+        };
+        state->count = count;
+        state->grain = grain;
+        state->chunks = chunks;
+        state->tag = AllocTracker::CurrentTag();
+
+        const uint32_t helpers = std::min<uint32_t>(chunks - 1, WorkerCount());
+        state->refs.store(helpers + 1, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < helpers; ++i) {
+            // Two pointers: small enough for std::function to store inline.
+            Submit([this, state] {
+                AllocScope scope(state->tag); // helpers allocate on behalf of the caller
+                RunChunks(*state);
+                ReleaseForState(state);
+            });
+        }
+
+        RunChunks(*state);
+
+        // `body` is only touched while chunks are left, and every chunk is
+        // finished once `done` reaches `chunks`, so returning is safe after this.
+        while (state->done.load(std::memory_order_acquire) < chunks)
+            std::this_thread::yield();
+        ReleaseForState(state);
+    }
+
+private:
+    void WorkerLoop() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this] { return m_stop || m_jobCount > 0; });
+                if (m_stop && m_jobCount == 0)
+                    return;
+                job = PopJob();
+            }
+            PROFILE_SCOPE("Job");
+            job();
+        }
+    }
+
+    // The queue is a ring buffer that only grows: once it is big enough,
+    // submitting a small job (like resuming a coroutine) allocates nothing.
+    // Caller holds m_mutex.
+    void PushJob(std::function<void()>&& job) {
+        if (m_jobCount == m_jobs.size()) {
+            std::vector<std::function<void()>> grown(std::max<size_t>(64, m_jobs.size() * 2));
+            for (size_t i = 0; i < m_jobCount; ++i)
+                grown[i] = std::move(m_jobs[(m_jobHead + i) % m_jobs.size()]);
+            m_jobs.swap(grown);
+            m_jobHead = 0;
+        }
+        m_jobs[(m_jobHead + m_jobCount) % m_jobs.size()] = std::move(job);
+        ++m_jobCount;
+    }
+
+    std::function<void()> PopJob() {
+        std::function<void()> job = std::move(m_jobs[m_jobHead]);
+        m_jobs[m_jobHead] = nullptr;
+        m_jobHead = (m_jobHead + 1) % m_jobs.size();
+        --m_jobCount;
+        return job;
+    }
+
+    struct ForState {
+        std::atomic<uint32_t> next{ 0 };
+        std::atomic<uint32_t> done{ 0 };
+        std::atomic<uint32_t> refs{ 0 };
+        void* body = nullptr;
+        void (*invoke)(void* body, uint32_t begin, uint32_t end) = nullptr;
+        uint32_t count = 0;
+        uint32_t grain = 0;
+        uint32_t chunks = 0;
+        AllocTag tag = AllocTag::General;
+    };
+
+    static void RunChunks(ForState& s) {
+        uint32_t c;
+        while ((c = s.next.fetch_add(1, std::memory_order_relaxed)) < s.chunks) {
+            uint32_t begin = c * s.grain;
+            uint32_t end = std::min(begin + s.grain, s.count);
+            s.invoke(s.body, begin, end);
+            s.done.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    ForState* AcquireForState() {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        if (m_freeStates.empty())
+            return m_allStates.emplace_back(std::make_unique<ForState>()).get();
+        ForState* s = m_freeStates.back();
+        m_freeStates.pop_back();
+        s->next.store(0, std::memory_order_relaxed);
+        s->done.store(0, std::memory_order_relaxed);
+        return s;
+    }
+
+    void ReleaseForState(ForState* s) {
+        if (s->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_freeStates.push_back(s);
+    }
+
+private:
+    static inline thread_local uint32_t t_threadIndex = 0;
+
+    std::vector<std::thread> m_workers;
+    std::vector<std::function<void()>> m_jobs; // ring buffer, see PushJob
+    size_t m_jobHead = 0;
+    size_t m_jobCount = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+
+    std::mutex m_stateMutex;
+    std::vector<std::unique_ptr<ForState>> m_allStates; // ParallelFor states ever made
+    std::vector<ForState*> m_freeStates;
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/*
+ * SpscQueue
+ * A fixed-size ring buffer for exactly one producer thread and one consumer
+ * thread, without locks:
+ *
+ *   producer: Push(item)                 (never blocks, returns false when full)
+ *   consumer: Peek() / Pop() or TryPop(item)
+ *
+ * How it works: the producer only writes `m_tail`, the consumer only writes
+ * `m_head`. An item is written first and published by the release store to
+ * `m_tail`; the consumer's acquire load of `m_tail` makes it visible. Each
+ * side also keeps a cached copy of the other side's index, so most calls
+ * don't touch the other thread's cache line at all.
+ *
+ * When the queue is full, Push drops the new item and counts it in
+ * Dropped(): a producer like a window procedure must never wait for the game.
+ *
+ * `Capacity` must be a power of two. T should be small and trivially copyable.
+ */
+template<typename T, uint32_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // ---- producer ----
+
+    bool Push(const T& item) {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == Capacity) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == Capacity) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        m_items[tail & Mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // ---- consumer ----
+
+    // The oldest item, or nullptr if empty. Stays valid until Pop().
+    const T* Peek() {
+        const uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail)
+                return nullptr;
+        }
+        return &m_items[head & Mask];
+    }
+
+    // Only after Peek() returned an item.
+    void Pop() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool TryPop(T& out) {
+        const T* item = Peek();
+        if (!item) return false;
+        out = *item;
+        Pop();
+        return true;
+    }
+
+    // ---- either thread (a snapshot, may be stale right away) ----
+
+    uint32_t SizeApprox() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+    uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    static constexpr uint32_t GetCapacity() { return Capacity; }
+
+private:
+    static constexpr uint32_t Mask = Capacity - 1;
+
+    // Indices count forever and wrap at 2^32, the subtraction above still works.
+    alignas(64) std::atomic<uint32_t> m_head{ 0 }; // consumer
+    uint32_t m_cachedTail = 0;
+
+    alignas(64) std::atomic<uint32_t> m_tail{ 0 }; // producer
+    uint32_t m_cachedHead = 0;
+    std::atomic<uint64_t> m_dropped{ 0 };
+
+    alignas(64) T m_items[Capacity];
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/*
+ * Clock
+ * The one monotonic clock of the engine. Plain C++, so it works on
+ * every platform (on Windows std::chrono::steady_clock is QueryPerformanceCounter).
+ *
+ * - Clock::Now()      : seconds since the clock started, as a double
+ * - Clock::NowTicks() : the same in integer nanoseconds
+ *
+ * Why double: a float has 24 bits of mantissa, so after ~4.5 hours of uptime
+ * it can't tell two times 1 ms apart anymore. A double keeps sub-microsecond
+ * precision for decades.
+ *
+ * "Since the clock started" = since the first call, so the numbers stay small
+ * and readable in logs.
+ */
+namespace Clock {
+
+    using Ticks = int64_t; // nanoseconds
+
+    namespace Detail {
+        inline std::chrono::steady_clock::time_point Start() {
+            static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            return start;
+        }
+    }
+
+    inline Ticks NowTicks() {
+        auto start = Detail::Start();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    inline double ToSeconds(Ticks ticks) { return double(ticks) * 1e-9; }
+    inline double ToMilliseconds(Ticks ticks) { return double(ticks) * 1e-6; }
+
+    inline double Now() { return ToSeconds(NowTicks()); }
+
+    // Milliseconds since `start` (a value from Now()).
+    inline double MillisecondsSince(double start) { return (Now() - start) * 1000.0; }
+
+} // namespace Clock
@@ -0,0 +1,85 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/*
+ * FixedTimestep
+ * Runs the simulation at a fixed rate (e.g. 60 ticks per second),
+ * no matter how fast or slow frames are rendered.
+ *
+ * Every frame, Advance(frameSeconds) adds the real elapsed time to an
+ * accumulator and returns how many whole ticks fit into it. The caller runs
+ * that many simulation ticks. What is left over (less than one tick) stays
+ * in the accumulator for the next frame, and Alpha() tells the renderer how
+ * far we are between the last two ticks (0..1) so it can interpolate.
+ *
+ * If the simulation can't keep up (each tick costs more than a tick's worth
+ * of real time), the accumulator would grow forever and every frame would
+ * run more ticks than the last: the "spiral of death". So at most
+ * `maxStepsPerFrame` ticks are run and the rest of the backlog is dropped.
+ * The game then runs slower than real time instead of freezing.
+ */
+struct FixedTimestepSettings {
+    double ticksPerSecond = 60.0;
+    uint32_t maxStepsPerFrame = 5;
+};
+
+class FixedTimestep {
+public:
+    FixedTimestep() { SetSettings({}); }
+    explicit FixedTimestep(const FixedTimestepSettings& settings) { SetSettings(settings); }
+
+    void SetSettings(const FixedTimestepSettings& settings) {
+        m_settings = settings;
+        if (m_settings.ticksPerSecond <= 0.0) m_settings.ticksPerSecond = 60.0;
+        if (m_settings.maxStepsPerFrame == 0) m_settings.maxStepsPerFrame = 1;
+        m_step = 1.0 / m_settings.ticksPerSecond;
+    }
+
+    // Returns how many ticks to run this frame.
+    uint32_t Advance(double frameSeconds) {
+        if (frameSeconds > 0.0)
+            m_accumulator += frameSeconds;
+
+        uint32_t steps = 0;
+        while (m_accumulator >= m_step && steps < m_settings.maxStepsPerFrame) {
+            m_accumulator -= m_step;
+            ++steps;
+        }
+
+        // Still more than a tick behind: give up on that time.
+        // Keeping the fraction keeps Alpha() smooth.
+        if (m_accumulator >= m_step) {
+            double keep = std::fmod(m_accumulator, m_step);
+            m_droppedSeconds += m_accumulator - keep;
+            m_accumulator = keep;
+            ++m_droppedFrames;
+        }
+
+        m_ticks += steps;
+        return steps;
+    }
+
+    // 0 = draw the previous tick, 1 = draw the latest tick. Never reaches 1:
+    // a remainder just short of a tick would round up to 1.0f in a float.
+    float Alpha() const { return std::min(static_cast<float>(m_accumulator / m_step), std::nextafter(1.0f, 0.0f)); }
+
+    double StepSeconds() const { return m_step; }
+    double SimulationTime() const { return static_cast<double>(m_ticks) * m_step; }
+    uint64_t TickCount() const { return m_ticks; }
+
+    // How often (and how much) the step cap had to throw time away.
+    uint64_t DroppedFrames() const { return m_droppedFrames; }
+    double DroppedSeconds() const { return m_droppedSeconds; }
+
+    const FixedTimestepSettings& GetSettings() const { return m_settings; }
+
+private:
+    FixedTimestepSettings m_settings;
+    double m_step = 1.0 / 60.0;
+    double m_accumulator = 0.0;
+    uint64_t m_ticks = 0;
+    uint64_t m_droppedFrames = 0;
+    double m_droppedSeconds = 0.0;
+};
@@ -0,0 +1,96 @@
+#include "FrameLimiter.h"
+
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+namespace {
+    // The last bit of every wait is done by yielding: timers can't be
+    // trusted to wake up closer than this.
+    constexpr auto SpinMargin = std::chrono::microseconds(500);
+}
+
+FrameLimiter::FrameLimiter()
+{
+#ifdef _WIN32
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    // Older Windows: a normal timer still beats Sleep(), it's just less precise.
+    if (!m_timer)
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+#endif
+}
+
+FrameLimiter::~FrameLimiter()
+{
+#ifdef _WIN32
+    if (m_timer)
+        CloseHandle(static_cast<HANDLE>(m_timer));
+#endif
+}
+
+void FrameLimiter::SetTargetFps(double fps)
+{
+    m_fps = fps > 0.0 ? fps : 0.0;
+    m_period = m_fps > 0.0
+        ? std::chrono::duration_cast<SteadyClock::duration>(std::chrono::duration<double>(1.0 / m_fps))
+        : SteadyClock::duration{};
+    m_started = false;
+}
+
+void FrameLimiter::Wait()
+{
+    m_lastWaitMs = 0.0;
+    m_lastOvershootMs = 0.0;
+    if (m_fps <= 0.0)
+        return;
+
+    SteadyClock::time_point now = SteadyClock::now();
+    if (!m_started) {
+        m_next = now + m_period;
+        m_started = true;
+        return;
+    }
+
+    if (now < m_next) {
+        SleepUntil(m_next);
+        SteadyClock::time_point woke = SteadyClock::now();
+        m_lastWaitMs = std::chrono::duration<double, std::milli>(woke - now).count();
+        m_lastOvershootMs = std::chrono::duration<double, std::milli>(woke - m_next).count();
+        m_next += m_period;
+    }
+    else {
+        // Already late: start a fresh schedule instead of catching up.
+        m_next = now + m_period;
+    }
+}
+
+void FrameLimiter::SleepUntil(SteadyClock::time_point deadline)
+{
+    SteadyClock::time_point coarse = deadline - SpinMargin;
+    SteadyClock::time_point now = SteadyClock::now();
+
+    if (now < coarse) {
+#ifdef _WIN32
+        if (m_timer) {
+            // Negative = relative time, in 100 ns units.
+            LARGE_INTEGER due{};
+            due.QuadPart = -std::chrono::duration_cast<std::chrono::duration<long long, std::ratio<1, 10000000>>>(coarse - now).count();
+            if (SetWaitableTimerEx(static_cast<HANDLE>(m_timer), &due, 0, nullptr, nullptr, nullptr, 0))
+                WaitForSingleObject(static_cast<HANDLE>(m_timer), INFINITE);
+        }
+        else {
+            std::this_thread::sleep_until(coarse);
+        }
+#else
+        std::this_thread::sleep_until(coarse);
+#endif
+    }
+
+    while (SteadyClock::now() < deadline)
+        std::this_thread::yield();
+}
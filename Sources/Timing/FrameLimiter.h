@@ -0,0 +1,53 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/*
+ * FrameLimiter
+ * Caps the frame rate by waiting at the end of every frame until the
+ * next frame is due.
+ *
+ * Spinning in a loop until the time is up is precise but burns a whole
+ * core. A plain Sleep() is cheap but on Windows it wakes up to ~15 ms late.
+ * So we sleep with a high-resolution timer (Windows 10 1803+) for most of
+ * the wait, and only yield for the last fraction of a millisecond.
+ *
+ * Deadlines are spaced exactly one period apart, so small wake-up errors
+ * don't add up. After a long frame the schedule restarts from "now"
+ * instead of rushing several frames out to catch up.
+ */
+class FrameLimiter {
+public:
+    using SteadyClock = std::chrono::steady_clock;
+
+    FrameLimiter();
+    ~FrameLimiter();
+
+    FrameLimiter(const FrameLimiter&) = delete;
+    FrameLimiter& operator=(const FrameLimiter&) = delete;
+
+    // 0 = no limit.
+    void SetTargetFps(double fps);
+    double GetTargetFps() const { return m_fps; }
+
+    // Call once per frame, after Present.
+    void Wait();
+
+    // How long the last Wait() slept and how late it woke up.
+    double LastWaitMs() const { return m_lastWaitMs; }
+    double LastOvershootMs() const { return m_lastOvershootMs; }
+
+private:
+    void SleepUntil(SteadyClock::time_point deadline);
+
+private:
+    double m_fps = 0.0;
+    SteadyClock::duration m_period{};
+    SteadyClock::time_point m_next{};
+    bool m_started = false;
+
+    double m_lastWaitMs = 0.0;
+    double m_lastOvershootMs = 0.0;
+
+    void* m_timer = nullptr; // Windows waitable timer (HANDLE), null elsewhere
+};
@@ -0,0 +1,102 @@
+#include "FrameStats.h"
+#include "Clock.h"
+
+#include <cstdio>
+
+FrameStats::FrameStats(const FrameStatsSettings& settings)
+    : m_settings(settings)
+{
+    if (m_settings.window == 0) m_settings.window = 1;
+    m_times.SetWindow(m_settings.window);
+}
+
+FrameStats::~FrameStats()
+{
+    if (m_dumpFile)
+        std::fclose(m_dumpFile);
+}
+
+CounterId FrameStats::RegisterCounter(const std::string& name, CounterKind kind)
+{
+    for (CounterId i = 0; i < m_counters.size(); ++i)
+        if (m_counters[i].name == name)
+            return i;
+
+    Counter c;
+    c.name = name;
+    c.kind = kind;
+    m_counters.push_back(c);
+    return CounterId(m_counters.size() - 1);
+}
+
+void FrameStats::EndFrame(double frameMs)
+{
+    // Compared against the frames before it, not including itself.
+    const double median = m_times.Median();
+    if (m_times.Count() >= 10 && frameMs >= m_settings.hitchMinMs && frameMs > median * m_settings.hitchFactor) {
+        ++m_hitchCount;
+        m_lastHitchMs = frameMs;
+        m_lastHitchFrame = m_frameCount;
+    }
+
+    m_times.Push(frameMs);
+    ++m_frameCount;
+
+    for (Counter& c : m_counters) {
+        c.last = c.value;
+        if (c.kind == CounterKind::PerFrame)
+            c.value = 0;
+    }
+
+    if (m_dumpFile) {
+        double now = Clock::Now();
+        if (now - m_lastDump >= m_dumpInterval) {
+            Dump(now);
+            m_lastDump = now;
+        }
+    }
+}
+
+FrameTimeSummary FrameStats::GetSummary() const
+{
+    return m_times.Summary();
+}
+
+bool FrameStats::SetDumpFile(const std::string& path, double intervalSeconds)
+{
+    if (m_dumpFile) {
+        std::fclose(m_dumpFile);
+        m_dumpFile = nullptr;
+    }
+    if (path.empty())
+        return true;
+
+    m_dumpFile = std::fopen(path.c_str(), "w");
+    m_dumpInterval = intervalSeconds;
+    m_lastDump = Clock::Now();
+    m_dumpedCounters = ~0u;
+    return m_dumpFile != nullptr;
+}
+
+void FrameStats::Dump(double now)
+{
+    // A new header whenever counters were registered since the last one,
+    // so every line can be read with the header above it.
+    if (m_dumpedCounters != m_counters.size()) {
+        std::fprintf(m_dumpFile, "time_s,frames,avg_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches");
+        for (const Counter& c : m_counters)
+            std::fprintf(m_dumpFile, ",%s", c.name.c_str());
+        std::fprintf(m_dumpFile, "\n");
+        m_dumpedCounters = uint32_t(m_counters.size());
+    }
+
+    FrameTimeSummary s = GetSummary();
+    std::fprintf(m_dumpFile, "%.3f,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%llu",
+        now, static_cast<unsigned long long>(m_frameCount),
+        s.averageMs, s.p50Ms, s.p95Ms, s.p99Ms, s.maxMs,
+        static_cast<unsigned long long>(m_hitchCount));
+    for (const Counter& c : m_counters)
+        std::fprintf(m_dumpFile, ",%llu", static_cast<unsigned long long>(c.last));
+    std::fprintf(m_dumpFile, "\n");
+    std::fflush(m_dumpFile);
+}
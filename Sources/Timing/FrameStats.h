@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "TimeWindow.h"
+
+/*
+ * FrameStats
+ * Frame times and per-frame counters, kept in one place so they can be
+ * read by code (GetSummary, GetCounter) or written to a file every few seconds.
+ *
+ * Frame times
+ *   The last `window` frame times are kept in a TimeWindow. The summary
+ *   reports percentiles instead of only the average: a game at "60 fps
+ *   average" that stalls for 50 ms every second feels bad, and only
+ *   p99 / max show that.
+ *
+ * Hitches
+ *   A frame is a hitch when it takes `hitchFactor` times longer than the
+ *   median of the window (and at least `hitchMinMs`), i.e. a visible stutter
+ *   compared to the frames around it.
+ *
+ * Counters
+ *   Named integers registered once (RegisterCounter) and then updated by id,
+ *   so the per-frame cost is an array write:
+ *     PerFrame : starts at 0 every frame (draws, bytes uploaded)
+ *     Gauge    : keeps its value until set again (entities alive)
+ */
+struct FrameStatsSettings {
+    uint32_t window = 300;     // frames kept for percentiles (5 s at 60 fps)
+    double hitchFactor = 2.0;
+    double hitchMinMs = 8.0;
+};
+
+enum class CounterKind {
+    PerFrame,
+    Gauge
+};
+
+using CounterId = uint32_t;
+
+class FrameStats {
+public:
+    explicit FrameStats(const FrameStatsSettings& settings = {});
+    ~FrameStats();
+
+    FrameStats(const FrameStats&) = delete;
+    FrameStats& operator=(const FrameStats&) = delete;
+
+    // Registering the same name twice returns the same id.
+    CounterId RegisterCounter(const std::string& name, CounterKind kind = CounterKind::PerFrame);
+
+    void Add(CounterId id, uint64_t value = 1) { m_counters[id].value += value; }
+    void Set(CounterId id, uint64_t value) { m_counters[id].value = value; }
+
+    // Value at the end of the last finished frame.
+    uint64_t GetCounter(CounterId id) const { return m_counters[id].last; }
+    const std::string& GetCounterName(CounterId id) const { return m_counters[id].name; }
+    uint32_t CounterCount() const { return uint32_t(m_counters.size()); }
+
+    // Closes the current frame. `frameMs` is how long it took.
+    void EndFrame(double frameMs);
+
+    FrameTimeSummary GetSummary() const;
+
+    uint64_t FrameCount() const { return m_frameCount; }
+    uint64_t HitchCount() const { return m_hitchCount; }
+    double LastHitchMs() const { return m_lastHitchMs; }
+    uint64_t LastHitchFrame() const { return m_lastHitchFrame; }
+
+    // Appends one CSV line (summary + every counter) to `path` every
+    // `intervalSeconds`. The file is started fresh. Empty path = off.
+    bool SetDumpFile(const std::string& path, double intervalSeconds = 5.0);
+
+private:
+    struct Counter {
+        std::string name;
+        CounterKind kind = CounterKind::PerFrame;
+        uint64_t value = 0; // this frame
+        uint64_t last = 0;  // last finished frame
+    };
+
+    void Dump(double now);
+
+private:
+    FrameStatsSettings m_settings;
+
+    TimeWindow m_times;
+
+    uint64_t m_frameCount = 0;
+    uint64_t m_hitchCount = 0;
+    double m_lastHitchMs = 0.0;
+    uint64_t m_lastHitchFrame = 0;
+
+    std::vector<Counter> m_counters;
+
+    std::FILE* m_dumpFile = nullptr;
+    double m_dumpInterval = 0.0;
+    double m_lastDump = 0.0;
+    uint32_t m_dumpedCounters = ~0u; // how many counters the last CSV header had
+};
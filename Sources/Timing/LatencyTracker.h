@@ -0,0 +1,54 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+/*
+ * LatencyTracker
+ * Input-to-present latency: how long it takes from the moment the engine
+ * receives an input message until a frame that could react to it has
+ * been handed to Present.
+ *
+ *   MarkInput(t)   : an input message arrived (only the first one since the
+ *                    last present counts, it has waited the longest)
+ *   MarkPresent(t) : Present returned, close the sample
+ *
+ * Times are in seconds from any monotonic clock, as long as both calls use
+ * the same one. The OS queue before our message pump is not included.
+ */
+class LatencyTracker {
+public:
+    void MarkInput(double seconds) {
+        if (!m_pending) {
+            m_pending = true;
+            m_inputTime = seconds;
+        }
+    }
+
+    void MarkPresent(double seconds) {
+        if (!m_pending)
+            return;
+        m_pending = false;
+
+        double ms = (seconds - m_inputTime) * 1000.0;
+        m_lastMs = ms;
+        m_maxMs = std::max(m_maxMs, ms);
+        m_sumMs += ms;
+        ++m_samples;
+    }
+
+    double LastMs() const { return m_lastMs; }
+    double MaxMs() const { return m_maxMs; }
+    double AverageMs() const { return m_samples ? m_sumMs / double(m_samples) : 0.0; }
+    uint64_t Samples() const { return m_samples; }
+
+    void Reset() { *this = {}; }
+
+private:
+    bool m_pending = false;
+    double m_inputTime = 0.0;
+
+    double m_lastMs = 0.0;
+    double m_maxMs = 0.0;
+    double m_sumMs = 0.0;
+    uint64_t m_samples = 0;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include "TimeWindow.h"
+
+// The parts of Core's frame, in order.
+enum class FrameStage : uint8_t {
+    Tasks,      // TaskScheduler::Pump
+    Update,     // input + the functions from addFunc, every tick of the frame
+    BuildQueue, // BuildRenderQueue: culling, LODs
+    Draw,       // the backend consuming the queue
+    Present,    // EndFrame
+    Frame,      // everything, including the frame limiter
+    Count
+};
+
+/*
+ * StageTimes
+ * How long each FrameStage took, for the last `window` frames.
+ * Core fills it every frame (a handful of clock reads), the summary gives
+ * mean and percentiles per stage like FrameStats does for whole frames
+ * (the same TimeWindow).
+ *
+ * Times of one stage are summed within a frame: with a fixed timestep,
+ * Update is all ticks of the frame together.
+ */
+class StageTimes {
+public:
+    explicit StageTimes(uint32_t window = 600) { SetWindow(window); }
+
+    static const char* Name(FrameStage stage) {
+        static const char* const names[] = { "tasks", "update", "build_queue", "draw", "present", "frame" };
+        return names[size_t(stage)];
+    }
+
+    // Forgets everything recorded so far.
+    void SetWindow(uint32_t frames) {
+        for (TimeWindow& t : m_times)
+            t.SetWindow(frames);
+        std::fill(std::begin(m_current), std::end(m_current), 0.0);
+    }
+
+    void Add(FrameStage stage, double ms) { m_current[size_t(stage)] += ms; }
+
+    void EndFrame() {
+        for (size_t s = 0; s < size_t(FrameStage::Count); ++s) {
+            m_times[s].Push(m_current[s]);
+            m_current[s] = 0.0;
+        }
+    }
+
+    FrameTimeSummary GetSummary(FrameStage stage) const { return m_times[size_t(stage)].Summary(); }
+
+private:
+    TimeWindow m_times[size_t(FrameStage::Count)];
+    double m_current[size_t(FrameStage::Count)]{}; // this frame so far
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+struct FrameTimeSummary {
+    uint32_t frames = 0;   // in the window
+    double averageMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+// Mean and percentiles of `ms` (sorts it). Percentiles are nearest rank:
+// the smallest time that p% of the times don't exceed, always one of them.
+inline FrameTimeSummary SummarizeTimes(std::vector<double>& ms) {
+    FrameTimeSummary s;
+    s.frames = uint32_t(ms.size());
+    if (ms.empty()) return s;
+    std::sort(ms.begin(), ms.end());
+
+    auto percentile = [&](double p) {
+        const size_t rank = std::clamp<size_t>(size_t(p * double(ms.size()) + 0.999999), 1, ms.size());
+        return ms[rank - 1];
+    };
+
+    double sum = 0.0;
+    for (double t : ms) sum += t;
+
+    s.averageMs = sum / double(ms.size());
+    s.p50Ms = percentile(0.50);
+    s.p95Ms = percentile(0.95);
+    s.p99Ms = percentile(0.99);
+    s.maxMs = ms.back();
+    return s;
+}
+
+/*
+ * TimeWindow
+ * The last `window` times in a ring buffer, summarized on demand with
+ * SummarizeTimes. FrameStats keeps one for whole frames, StageTimes one
+ * per stage; benchmarks that keep every time call SummarizeTimes directly.
+ * Push never allocates; Summary and Median sort a copy in a scratch
+ * buffer that is reserved up front.
+ */
+class TimeWindow {
+public:
+    explicit TimeWindow(uint32_t window = 1) { SetWindow(window); }
+
+    // Forgets everything pushed so far.
+    void SetWindow(uint32_t window) {
+        m_times.assign(window ? window : 1, 0.0);
+        m_sorted.reserve(m_times.size());
+        m_next = 0;
+        m_filled = 0;
+    }
+
+    void Push(double ms) {
+        m_times[m_next] = ms;
+        m_next = (m_next + 1) % uint32_t(m_times.size());
+        m_filled = std::min(m_filled + 1, uint32_t(m_times.size()));
+    }
+
+    // How many times are in the window (up to its size).
+    uint32_t Count() const { return m_filled; }
+
+    FrameTimeSummary Summary() const {
+        m_sorted.assign(m_times.begin(), m_times.begin() + m_filled);
+        return SummarizeTimes(m_sorted);
+    }
+
+    double Median() const {
+        if (m_filled == 0) return 0.0;
+        m_sorted.assign(m_times.begin(), m_times.begin() + m_filled);
+        auto mid = m_sorted.begin() + m_filled / 2;
+        std::nth_element(m_sorted.begin(), mid, m_sorted.end());
+        return *mid;
+    }
+
+private:
+    std::vector<double> m_times;
+    mutable std::vector<double> m_sorted; // scratch
+    uint32_t m_next = 0;
+    uint32_t m_filled = 0;
+};
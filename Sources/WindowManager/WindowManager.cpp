@@ -1,4 +1,6 @@
 #include "WindowManager.h"
+#include "Input/InputWriter.h"
+#include <algorithm>
 #include <vector>
 #include <cstring>
 #include <stdexcept>
@@ -20,23 +22,14 @@ struct WindowData {
     bool mouseCaptured = false;
     bool initialized = false;
 
-    static constexpr uint32_t KEY_COUNT = 256;
-    static constexpr uint32_t MOUSE_BUTTON_COUNT = 3;
-
-    bool keys[KEY_COUNT]{};
-    bool prevKeys[KEY_COUNT]{};
-    bool mouseButtons[MOUSE_BUTTON_COUNT]{};
-    bool prevMouseButtons[MOUSE_BUTTON_COUNT]{};
-
-    int32_t mouseX = 0, mouseY = 0;
-    int32_t prevMouseX = 0, prevMouseY = 0;
+    // Last cursor position, stamped on every input event.
+    int16_t mouseX = 0, mouseY = 0;
 
     ResizeCallback onResize;
     CloseCallback onClose;
-    InputCallback onInput;
-    MouseMoveCallback onMouseMove;
-    MouseButtonCallback onMouseButton;
-    KeyCallback onKey;
+
+    InputQueue input;
+    InputWriter inputWriter{ input };
 };
 
 
@@ -153,9 +146,6 @@ LRESULT CALLBACK WindowManager::StaticWndProc(HWND hwnd, UINT msg, WPARAM wp, LP
 }
 
 LRESULT WindowManager::HandleMessage(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) {
-    if (m_data->onInput)
-        m_data->onInput(msg, wp, lp);
-
     switch (msg) {
     case WM_CLOSE:
         if (!m_data->onClose || m_data->onClose())
@@ -169,6 +159,8 @@ LRESULT WindowManager::HandleMessage(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
 
     case WM_ACTIVATE:
         m_data->active = (LOWORD(wp) != WA_INACTIVE);
+        if (!m_data->active)
+            PushInput(InputEventType::FocusLost);
         return 0;
 
     case WM_SIZE:
@@ -178,18 +170,25 @@ LRESULT WindowManager::HandleMessage(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
             m_data->onResize(m_data->clientWidth, m_data->clientHeight);
         return 0;
 
-    case WM_KEYDOWN: ProcessKey((uint32_t)wp, true); break;
-    case WM_KEYUP:   ProcessKey((uint32_t)wp, false); break;
+    // Input: record and move on, nothing else runs in here.
+    case WM_KEYDOWN: if (wp < 256) PushInput(InputEventType::KeyDown, uint8_t(wp)); break;
+    case WM_KEYUP:   if (wp < 256) PushInput(InputEventType::KeyUp, uint8_t(wp)); break;
 
-    case WM_LBUTTONDOWN: ProcessMouseButton(0, true); break;
-    case WM_LBUTTONUP:   ProcessMouseButton(0, false); break;
-    case WM_RBUTTONDOWN: ProcessMouseButton(1, true); break;
-    case WM_RBUTTONUP:   ProcessMouseButton(1, false); break;
-    case WM_MBUTTONDOWN: ProcessMouseButton(2, true); break;
-    case WM_MBUTTONUP:   ProcessMouseButton(2, false); break;
+    case WM_LBUTTONDOWN: PushInput(InputEventType::MouseDown, 0); break;
+    case WM_LBUTTONUP:   PushInput(InputEventType::MouseUp, 0); break;
+    case WM_RBUTTONDOWN: PushInput(InputEventType::MouseDown, 1); break;
+    case WM_RBUTTONUP:   PushInput(InputEventType::MouseUp, 1); break;
+    case WM_MBUTTONDOWN: PushInput(InputEventType::MouseDown, 2); break;
+    case WM_MBUTTONUP:   PushInput(InputEventType::MouseUp, 2); break;
 
     case WM_MOUSEMOVE:
-        ProcessMouseMove(GET_X_LPARAM(lp), GET_Y_LPARAM(lp));
+        m_data->mouseX = int16_t(std::clamp(GET_X_LPARAM(lp), -32768, 32767));
+        m_data->mouseY = int16_t(std::clamp(GET_Y_LPARAM(lp), -32768, 32767));
+        PushInput(InputEventType::MouseMove);
+        break;
+
+    case WM_MOUSEWHEEL:
+        PushInput(InputEventType::MouseWheel, 0, int16_t(GET_WHEEL_DELTA_WPARAM(wp)));
         break;
     }
 
@@ -197,33 +196,20 @@ LRESULT WindowManager::HandleMessage(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
 }
 
 
-void WindowManager::ProcessKey(uint32_t key, bool pressed) {
-    if (key >= WindowData::KEY_COUNT) return;
-    m_data->keys[key] = pressed;
-    if (m_data->onKey) m_data->onKey(key, pressed);
-}
-
-void WindowManager::ProcessMouseButton(uint32_t b, bool pressed) {
-    if (b >= WindowData::MOUSE_BUTTON_COUNT) return;
-    m_data->mouseButtons[b] = pressed;
-    if (m_data->onMouseButton) m_data->onMouseButton(b, pressed);
-}
-
-void WindowManager::ProcessMouseMove(int32_t x, int32_t y) {
-    m_data->prevMouseX = m_data->mouseX;
-    m_data->prevMouseY = m_data->mouseY;
-    m_data->mouseX = x;
-    m_data->mouseY = y;
-
-    if (m_data->onMouseMove)
-        m_data->onMouseMove(x, y, x - m_data->prevMouseX, y - m_data->prevMouseY);
+void WindowManager::PushInput(InputEventType type, uint8_t code, int16_t wheel) {
+    InputEvent e;
+    e.time = Clock::NowTicks();
+    e.type = type;
+    e.code = code;
+    e.wheel = wheel;
+    e.x = m_data->mouseX;
+    e.y = m_data->mouseY;
+    m_data->inputWriter.Push(e); // full = dropped and counted, never blocks
 }
 
 
 bool WindowManager::ProcessMessages() {
-    memcpy(m_data->prevKeys, m_data->keys, sizeof(m_data->keys));
-    memcpy(m_data->prevMouseButtons, m_data->mouseButtons, sizeof(m_data->mouseButtons));
-
+    m_data->inputWriter.Flush(Clock::NowTicks()); // a release dropped last frame
     MSG msg{};
     while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
         if (msg.message == WM_QUIT)
@@ -261,22 +247,7 @@ void WindowManager::SetMouseCapture(bool c) {
 
 void WindowManager::SetResizeCallback(ResizeCallback cb) { m_data->onResize = cb; }
 void WindowManager::SetCloseCallback(CloseCallback cb) { m_data->onClose = cb; }
-void WindowManager::SetInputCallback(InputCallback cb) { m_data->onInput = cb; }
-void WindowManager::SetMouseMoveCallback(MouseMoveCallback cb) { m_data->onMouseMove = cb; }
-void WindowManager::SetMouseButtonCallback(MouseButtonCallback cb) { m_data->onMouseButton = cb; }
-void WindowManager::SetKeyCallback(KeyCallback cb) { m_data->onKey = cb; }
-
-
-bool WindowManager::IsKeyDown(uint32_t k) const { return m_data->keys[k]; }
-bool WindowManager::IsKeyPressed(uint32_t k) const {
-    return m_data->keys[k] && !m_data->prevKeys[k];
-}
-bool WindowManager::IsKeyReleased(uint32_t k) const {
-    return !m_data->keys[k] && m_data->prevKeys[k];
-}
-bool WindowManager::IsMouseButtonDown(uint32_t b) const {
-    return m_data->mouseButtons[b];
-}
+InputQueue& WindowManager::GetInputQueue() { return m_data->input; }
 
 
 std::wstring WindowManager::StringToWide(const std::string& s) {
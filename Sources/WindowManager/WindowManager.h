@@ -4,14 +4,11 @@
 #include <functional>
 #include <string>
 #include <cstdint>
+#include "Input/InputEvent.h"
 
 
 using ResizeCallback = std::function<void(uint32_t, uint32_t)>;
 using CloseCallback = std::function<bool()>;
-using InputCallback = std::function<void(UINT, WPARAM, LPARAM)>;
-using MouseMoveCallback = std::function<void(int32_t, int32_t, int32_t, int32_t)>;
-using MouseButtonCallback = std::function<void(int32_t, bool)>;
-using KeyCallback = std::function<void(uint32_t, bool)>;
 
 struct WindowData;
 
@@ -72,18 +69,11 @@ public:
     
     void SetResizeCallback(ResizeCallback cb);
     void SetCloseCallback(CloseCallback cb);
-    void SetInputCallback(InputCallback cb);
-    void SetMouseMoveCallback(MouseMoveCallback cb);
-    void SetMouseButtonCallback(MouseButtonCallback cb);
-    void SetKeyCallback(KeyCallback cb);
 
-   
-    bool IsKeyDown(uint32_t key) const;
-    bool IsKeyPressed(uint32_t key) const;
-    bool IsKeyReleased(uint32_t key) const;
-    bool IsMouseButtonDown(uint32_t button) const;
-    void GetMousePosition(int32_t& x, int32_t& y) const;
-    void SetMousePosition(int32_t x, int32_t y);
+    // Keyboard and mouse: the window procedure only pushes timestamped
+    // events here, the game reads them per tick (see Input/InputState.h).
+    // The window is the producer, whoever consumes must be the only consumer.
+    InputQueue& GetInputQueue();
 
 
     static std::wstring StringToWide(const std::string& str);
@@ -100,9 +90,7 @@ private:
     static LRESULT CALLBACK StaticWndProc(HWND, UINT, WPARAM, LPARAM);
     LRESULT HandleMessage(HWND, UINT, WPARAM, LPARAM);
 
-    void ProcessKey(uint32_t key, bool pressed);
-    void ProcessMouseButton(uint32_t button, bool pressed);
-    void ProcessMouseMove(int32_t x, int32_t y);
+    void PushInput(InputEventType type, uint8_t code = 0, int16_t wheel = 0);
 
 private:
     std::unique_ptr<WindowData> m_data;
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Animation/AnimationStorage.h"
+
+// Plays a clip (optionally blended with a second one) on a skeleton.
+// The entity also needs a Transform and a Mesh with skin weights,
+// see Animation/AnimationSystem.h.
+struct Animator {
+    SkeletonHandle skeleton = InvalidSkeleton;
+    ClipHandle clip = InvalidClip;
+    ClipHandle blendClip = InvalidClip; // optional
+    float blendWeight = 0.0f;           // 0 = only `clip`, 1 = only `blendClip`
+    float time = 0.0f;                  // seconds, advanced by AnimationSystem::Update
+    float speed = 1.0f;
+    bool loop = true;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Renderer/MeshHandle.h"
+
+// An entity that never moves, so StaticBatcher may merge its Mesh with
+// those of its neighbours (see World/ECS/System/StaticBatcher.h).
+// `batch` is set by StaticBatcher::Build: the merged mesh the entity is
+// drawn with from then on; BuildRenderQueue skips its own Mesh.
+struct StaticMesh {
+    MeshHandle batch = InvalidMesh;
+};
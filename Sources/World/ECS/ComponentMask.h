@@ -0,0 +1,48 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include "ComponentPool.h"
+
+// Which components an entity has, one bit per ComponentTypeId.
+using ComponentMask = uint64_t;
+static_assert(MaxComponentTypes <= sizeof(ComponentMask) * 8, "a ComponentTypeId must fit in a ComponentMask");
+
+// An empty struct is a tag: a marker like "static" or "selected". It has
+// no data, so World keeps it only as a bit in the entity's signature.
+template<typename T>
+constexpr bool IsTagComponent = std::is_empty_v<T>;
+
+// The bit of type `typeId`, for code that has the ID but not the type.
+// ComponentTypeId never hands out one past the mask; anything else is 0.
+inline ComponentMask ComponentBitOf(uint32_t typeId) {
+    assert(typeId < MaxComponentTypes && "not a ComponentTypeId");
+    return typeId < MaxComponentTypes ? ComponentMask(1) << typeId : 0;
+}
+
+template<typename T>
+ComponentMask ComponentBit() {
+    return ComponentBitOf(ComponentTypeId<T>());
+}
+
+template<typename... T>
+ComponentMask ComponentMaskOf() {
+    return (ComponentMask(0) | ... | ComponentBit<T>());
+}
+
+// Entities that have every component of `all` and none of `none`:
+//
+//   world.Query(ComponentQuery().With<Static, Mesh>().Without<Hidden>(), entities);
+struct ComponentQuery {
+    ComponentMask all = 0;
+    ComponentMask none = 0;
+
+    template<typename... T>
+    ComponentQuery& With() { all |= ComponentMaskOf<T...>(); return *this; }
+    template<typename... T>
+    ComponentQuery& Without() { none |= ComponentMaskOf<T...>(); return *this; }
+
+    bool Matches(ComponentMask signature) const {
+        return (signature & all) == all && (signature & none) == 0;
+    }
+};
@@ -0,0 +1,197 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Memory/AllocTracker.h"
+
+using Entity = uint32_t;
+
+// Every ECS array is charged to AllocTag::ECS, see Memory/AllocTracker.h
+template<typename T>
+using EcsVector = std::vector<T, TaggedAllocator<T, AllocTag::ECS>>;
+
+/*
+ * ComponentPool<T>
+ * All components of one type, stored as a "sparse set":
+ *
+ *   m_sparse[entity]   -> index + 1 into the dense arrays (0 = no component)
+ *   m_entities[index]  -> which entity owns m_data[index]
+ *   m_data[index]      -> the component itself
+ *
+ * Lookups are one array read (no hashing), and m_data is one tightly
+ * packed array, so systems can walk it front to back and snapshots
+ * can copy it with a single memcpy.
+ *
+ * Remove() moves the last component into the hole, so removing is O(1)
+ * too but changes the order of the dense arrays.
+ *
+ * NOTE: adding a component may grow m_data, so references returned by
+ * Get() are only valid until the next Add() or Remove() of the same type.
+ */
+class IComponentPool {
+public:
+    virtual ~IComponentPool() = default;
+    virtual void Clear() = 0;
+    virtual size_t Size() const = 0;
+    virtual bool Remove(Entity e) = 0; // false if `e` had no component here
+    virtual size_t ComponentSize() const = 0;
+    virtual Entity EntityAt(size_t index) const = 0; // owner of the index-th component
+
+    // For copying between Worlds without knowing T (see World::AppendFrom):
+    // an empty pool of the same type, and components [begin, end) of this
+    // pool added to `dst` (which has the same type), entity e as e + offset.
+    virtual std::unique_ptr<IComponentPool> NewEmpty() const = 0;
+    virtual void AppendTo(IComponentPool& dst, size_t begin, size_t end, Entity offset) const = 0;
+};
+
+template<typename T>
+class ComponentPool : public IComponentPool {
+public:
+    T& Add(Entity e, const T& component) {
+        if (e >= m_sparse.size())
+            m_sparse.resize(size_t(e) + 1, 0);
+
+        uint32_t slot = m_sparse[e];
+        if (slot != 0) {
+            m_data[slot - 1] = component;
+            return m_data[slot - 1];
+        }
+
+        m_entities.push_back(e);
+        m_data.push_back(component);
+        m_sparse[e] = uint32_t(m_data.size());
+        return m_data.back();
+    }
+
+    // Many at once: the arrays grow once instead of once per doubling.
+    // data[i] is the component of entities[i].
+    void AddMany(const Entity* entities, const T* const* data, size_t count) {
+        Entity maxEntity = 0;
+        for (size_t i = 0; i < count; ++i)
+            maxEntity = entities[i] > maxEntity ? entities[i] : maxEntity;
+        if (maxEntity >= m_sparse.size())
+            m_sparse.resize(size_t(maxEntity) + 1, 0);
+        // Still doubling: reserving exactly size + count would reallocate
+        // on every call.
+        const size_t needed = m_data.size() + count;
+        if (needed > m_data.capacity()) {
+            const size_t capacity = needed > m_data.capacity() * 2 ? needed : m_data.capacity() * 2;
+            m_entities.reserve(capacity);
+            m_data.reserve(capacity);
+        }
+        for (size_t i = 0; i < count; ++i)
+            Add(entities[i], *data[i]);
+    }
+
+    bool Remove(Entity e) override {
+        if (!Has(e))
+            return false;
+        const uint32_t slot = m_sparse[e] - 1;
+        const uint32_t last = uint32_t(m_data.size()) - 1;
+        if (slot != last) {
+            m_data[slot] = std::move(m_data[last]);
+            m_entities[slot] = m_entities[last];
+            m_sparse[m_entities[slot]] = slot + 1;
+        }
+        m_data.pop_back();
+        m_entities.pop_back();
+        m_sparse[e] = 0;
+        return true;
+    }
+
+    bool Has(Entity e) const {
+        return e < m_sparse.size() && m_sparse[e] != 0;
+    }
+
+    T* TryGet(Entity e) {
+        return Has(e) ? &m_data[m_sparse[e] - 1] : nullptr;
+    }
+
+    const T* TryGet(Entity e) const {
+        return Has(e) ? &m_data[m_sparse[e] - 1] : nullptr;
+    }
+
+    // Dense arrays, in insertion order until something is removed.
+    // Entities()[i] owns Data()[i].
+    const EcsVector<Entity>& Entities() const { return m_entities; }
+    EcsVector<T>& Data() { return m_data; }
+    const EcsVector<T>& Data() const { return m_data; }
+
+    size_t Size() const override { return m_data.size(); }
+    size_t ComponentSize() const override { return sizeof(T); }
+    Entity EntityAt(size_t index) const override { return m_entities[index]; }
+
+    std::unique_ptr<IComponentPool> NewEmpty() const override {
+        return std::make_unique<ComponentPool<T>>();
+    }
+
+    void AppendTo(IComponentPool& dst, size_t begin, size_t end, Entity offset) const override {
+        ComponentPool<T>& to = static_cast<ComponentPool<T>&>(dst);
+        const size_t needed = to.m_data.size() + (end - begin);
+        if (needed > to.m_data.capacity()) {
+            const size_t capacity = needed > to.m_data.capacity() * 2 ? needed : to.m_data.capacity() * 2;
+            to.m_entities.reserve(capacity);
+            to.m_data.reserve(capacity);
+        }
+        for (size_t i = begin; i < end; ++i)
+            to.Add(m_entities[i] + offset, m_data[i]);
+    }
+
+    void Clear() override {
+        m_sparse.clear();
+        m_entities.clear();
+        m_data.clear();
+    }
+
+    // Replaces the whole pool with `count` components in one go.
+    // Used by WorldSnapshot: two memcpys and one pass to rebuild the lookup,
+    // instead of `count` separate Add() calls.
+    void Assign(const Entity* entities, const T* data, size_t count, Entity maxEntity) {
+        static_assert(std::is_trivially_copyable_v<T>, "bulk copy needs a trivially copyable component");
+
+        m_entities.resize(count);
+        m_data.resize(count);
+        if (count) {
+            std::memcpy(m_entities.data(), entities, count * sizeof(Entity));
+            std::memcpy(static_cast<void*>(m_data.data()), data, count * sizeof(T));
+        }
+
+        m_sparse.assign(size_t(maxEntity) + 1, 0);
+        for (size_t i = 0; i < count; ++i) {
+            assert(m_entities[i] <= maxEntity && m_sparse[m_entities[i]] == 0); // in range, once
+            m_sparse[m_entities[i]] = uint32_t(i + 1);
+        }
+    }
+
+private:
+    EcsVector<uint32_t> m_sparse;
+    EcsVector<Entity> m_entities;
+    EcsVector<T> m_data;
+};
+
+// Entity signatures have one bit per component type (ComponentMask.h).
+constexpr uint32_t MaxComponentTypes = 64;
+
+// A small number per component type, handed out on first use.
+// Only valid for this run of the program: never write it to disk.
+// A type past MaxComponentTypes would share another type's signature bit,
+// so it throws, in release builds too.
+inline uint32_t NextComponentTypeId() {
+    static std::atomic<uint32_t> next{ 0 };
+    const uint32_t id = next++;
+    if (id >= MaxComponentTypes)
+        throw std::length_error("more component types than ComponentMask has bits");
+    return id;
+}
+
+template<typename T>
+uint32_t ComponentTypeId() {
+    static const uint32_t id = NextComponentTypeId();
+    return id;
+}
@@ -0,0 +1,152 @@
+#include "EntityCommands.h"
+#include "Entity/Entity.h"
+#include "Threading/JobSystem.h"
+
+#include <algorithm>
+
+void EntityCommands::Resize(uint32_t buffers)
+{
+    AllocScope scope(AllocTag::ECS);
+    assert(buffers <= EntityCommandBuffer::MaxBuffers);
+    buffers = std::min(buffers, EntityCommandBuffer::MaxBuffers);
+    m_buffers.resize(buffers);
+    m_created.resize(buffers);
+    for (uint32_t i = 0; i < buffers; ++i)
+        m_buffers[i].m_index = i;
+}
+
+void EntityCommands::SetJobSystem(JobSystem* jobs)
+{
+    Resize(jobs ? jobs->WorkerCount() + 1 : 1);
+}
+
+EntityCommandBuffer& EntityCommands::ForThisThread()
+{
+    const uint32_t index = JobSystem::ThreadIndex();
+    assert(index < m_buffers.size() && "EntityCommands::SetJobSystem with the JobSystem that runs this");
+    return m_buffers[index < m_buffers.size() ? index : 0];
+}
+
+bool EntityCommands::Empty() const
+{
+    for (const EntityCommandBuffer& b : m_buffers)
+        if (!b.Empty())
+            return false;
+    return true;
+}
+
+Entity EntityCommands::Resolve(Entity e) const
+{
+    if (!EntityCommandBuffer::IsDeferred(e))
+        return e;
+    const uint32_t buffer = (e & ~EntityCommandBuffer::DeferredBit) >> EntityCommandBuffer::IndexShift;
+    const uint32_t local = e & (EntityCommandBuffer::MaxCreated - 1);
+    if (buffer >= m_created.size() || local >= m_created[buffer].size())
+        return InvalidEntity;
+    return m_created[buffer][local];
+}
+
+void EntityCommands::Playback(World& world)
+{
+    AllocScope scope(AllocTag::ECS);
+    m_stats = {};
+
+    // 1. One list of everything, in a fixed order.
+    m_order.clear();
+    for (uint32_t b = 0; b < m_buffers.size(); ++b) {
+        const EntityCommandBuffer& buffer = m_buffers[b];
+        m_created[b].clear();
+        if (buffer.Empty())
+            continue;
+        ++m_stats.buffers;
+        for (uint32_t i = 0; i < buffer.m_commands.size(); ++i)
+            m_order.push_back({ buffer.m_commands[i].key, b, i });
+    }
+    if (m_order.empty())
+        return;
+
+    // Recording order within a buffer mostly follows the key already, so
+    // this is close to a merge; (buffer, index) only break ties.
+    std::sort(m_order.begin(), m_order.end(), [](const Ref& a, const Ref& b) {
+        if (a.key != b.key) return a.key < b.key;
+        if (a.buffer != b.buffer) return a.buffer < b.buffer;
+        return a.index < b.index;
+    });
+
+    auto command = [this](const Ref& r) -> const Command& { return m_buffers[r.buffer].m_commands[r.index]; };
+
+    // 2. Creates: IDs in sorted order, as one block.
+    for (const Ref& r : m_order)
+        if (command(r).op == Op::Create)
+            ++m_stats.creates;
+    Entity next = world.CreateEntities(m_stats.creates);
+    for (uint32_t b = 0; b < m_buffers.size(); ++b)
+        m_created[b].resize(m_buffers[b].m_created, InvalidEntity);
+    for (const Ref& r : m_order) {
+        const Command& c = command(r);
+        if (c.op == Op::Create)
+            m_created[r.buffer][c.entity & (EntityCommandBuffer::MaxCreated - 1)] = next++;
+    }
+
+    // 3. Adds, one batch per component type. Bucketed by type ID (a
+    // counting sort), which keeps the sorted order within every type.
+    m_typeStart.assign(m_typeStart.size(), 0);
+    uint32_t adds = 0;
+    for (const Ref& r : m_order) {
+        const Command& c = command(r);
+        if (c.op != Op::Add)
+            continue;
+        if (c.type->typeId + 1 >= m_typeStart.size())
+            m_typeStart.resize(size_t(c.type->typeId) + 2, 0);
+        ++m_typeStart[c.type->typeId + 1];
+        ++adds;
+    }
+    for (size_t t = 1; t < m_typeStart.size(); ++t)
+        m_typeStart[t] += m_typeStart[t - 1];
+    m_adds.resize(adds);
+    for (const Ref& r : m_order) {
+        const Command& c = command(r);
+        if (c.op == Op::Add)
+            m_adds[m_typeStart[c.type->typeId]++] = r;
+    }
+    for (size_t begin = 0; begin < m_adds.size();) {
+        const ComponentOps* type = command(m_adds[begin]).type; // one ComponentOps per type
+        m_batchEntities.clear();
+        m_batchData.clear();
+        size_t end = begin;
+        for (; end < m_adds.size() && command(m_adds[end]).type == type; ++end) {
+            const Command& c = command(m_adds[end]);
+            const Entity e = Resolve(c.entity);
+            if (e == InvalidEntity)
+                continue;
+            m_batchEntities.push_back(e);
+            m_batchData.push_back(&m_buffers[m_adds[end].buffer].m_data[c.data]);
+        }
+        type->addMany(world, m_batchEntities.data(), m_batchData.data(), m_batchEntities.size());
+        m_stats.adds += static_cast<uint32_t>(m_batchEntities.size());
+        begin = end;
+    }
+
+    // 4. Removes, then destroys.
+    for (const Ref& r : m_order) {
+        const Command& c = command(r);
+        if (c.op != Op::Remove)
+            continue;
+        if (const Entity e = Resolve(c.entity)) {
+            c.type->remove(world, e);
+            ++m_stats.removes;
+        }
+    }
+    for (const Ref& r : m_order) {
+        const Command& c = command(r);
+        if (c.op != Op::Destroy)
+            continue;
+        if (const Entity e = Resolve(c.entity)) {
+            world.DestroyEntity(e);
+            ++m_stats.destroys;
+        }
+    }
+
+    for (EntityCommandBuffer& b : m_buffers)
+        b.Reset();
+}
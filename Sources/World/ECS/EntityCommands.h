@@ -0,0 +1,196 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "World.h"
+
+class JobSystem;
+
+// What EntityCommands needs to know about a component type it has never seen.
+struct ComponentOps {
+    uint32_t typeId;
+    // data[i] is the component for entities[i]
+    void (*addMany)(World& world, const Entity* entities, const void* const* data, size_t count);
+    void (*remove)(World& world, Entity e);
+};
+
+template<typename T>
+const ComponentOps* ComponentOpsFor() {
+    static const ComponentOps ops{
+        ComponentTypeId<T>(),
+        [](World& world, const Entity* entities, const void* const* data, size_t count) {
+            world.AddComponents<T>(entities, reinterpret_cast<const T* const*>(data), count);
+        },
+        [](World& world, Entity e) { world.RemoveComponent<T>(e); }
+    };
+    return &ops;
+}
+
+struct EntityCommandStats {
+    uint32_t creates = 0;  // in the last Playback
+    uint32_t destroys = 0;
+    uint32_t adds = 0;
+    uint32_t removes = 0;
+    uint32_t buffers = 0;  // that had anything in them
+};
+
+/*
+ * EntityCommandBuffer
+ * The commands of one thread, see EntityCommands. Recording only touches
+ * this buffer, so it needs no locks and doesn't look at the World at all.
+ *
+ * CreateEntity can't hand out a real ID yet (other threads create entities
+ * too, and the IDs must not depend on who was first). It returns a
+ * "deferred" entity instead, which is only good for commands in the same
+ * EntityCommands; Playback replaces it with the real one.
+ */
+class EntityCommandBuffer {
+public:
+    // Commands recorded from now on are played back in the order of this
+    // key. Use something that doesn't depend on the thread, like the
+    // `begin` of the ParallelFor chunk.
+    void SetSortKey(uint32_t key) { m_key = key; }
+
+    Entity CreateEntity() {
+        assert(m_created < MaxCreated);
+        const Entity e = DeferredBit | (m_index << IndexShift) | m_created++;
+        m_commands.push_back({ m_key, Op::Create, nullptr, e, 0 });
+        return e;
+    }
+
+    void DestroyEntity(Entity e) {
+        m_commands.push_back({ m_key, Op::Destroy, nullptr, e, 0 });
+    }
+
+    // The component is copied now; later changes to `component` don't count.
+    template<typename T>
+    void AddComponent(Entity e, const T& component = {}) {
+        static_assert(std::is_trivially_copyable_v<T>, "commands keep components as raw bytes");
+        static_assert(alignof(T) <= alignof(Block), "component needs more than 16-byte alignment");
+        const uint32_t offset = static_cast<uint32_t>(m_data.size());
+        m_data.resize(m_data.size() + (sizeof(T) + sizeof(Block) - 1) / sizeof(Block));
+        std::memcpy(static_cast<void*>(&m_data[offset]), &component, sizeof(T));
+        m_commands.push_back({ m_key, Op::Add, ComponentOpsFor<T>(), e, offset });
+    }
+
+    template<typename T>
+    void RemoveComponent(Entity e) {
+        m_commands.push_back({ m_key, Op::Remove, ComponentOpsFor<T>(), e, 0 });
+    }
+
+    size_t Size() const { return m_commands.size(); }
+    bool Empty() const { return m_commands.empty(); }
+
+    static constexpr Entity DeferredBit = 0x80000000u;
+    static bool IsDeferred(Entity e) { return (e & DeferredBit) != 0; }
+
+private:
+    friend class EntityCommands;
+
+    static constexpr uint32_t IndexShift = 24;     // bits 24..30: which buffer
+    static constexpr uint32_t MaxBuffers = 128;
+    static constexpr uint32_t MaxCreated = 1u << IndexShift; // bits 0..23: which CreateEntity
+
+    enum class Op : uint8_t { Create, Add, Remove, Destroy };
+
+    struct Command {
+        uint32_t key;
+        Op op;
+        const ComponentOps* type; // Add / Remove
+        Entity entity;            // may be deferred
+        uint32_t data;            // Add: first block in m_data
+    };
+
+    struct alignas(16) Block {
+        unsigned char bytes[16];
+    };
+
+    void Reset() {
+        m_commands.clear();
+        m_data.clear();
+        m_created = 0;
+        m_key = 0;
+    }
+
+    uint32_t m_index = 0; // in EntityCommands
+    uint32_t m_key = 0;
+    uint32_t m_created = 0;
+    EcsVector<Command> m_commands;
+    EcsVector<Block> m_data;  // component bytes, 16-byte aligned
+};
+
+/*
+ * EntityCommands
+ * Create / destroy entities and add / remove components from jobs.
+ *
+ * World isn't thread-safe: AddComponent may grow a pool while another
+ * thread walks it. So a system running on the job system records what it
+ * wants into the buffer of its thread instead:
+ *
+ *   jobs.ParallelFor(n, grain, [&](uint32_t begin, uint32_t end) {
+ *       EntityCommandBuffer& cmd = commands.ForThisThread();
+ *       cmd.SetSortKey(begin);
+ *       Entity bullet = cmd.CreateEntity();
+ *       cmd.AddComponent(bullet, Transform{ ... });
+ *   });
+ *   commands.Playback(world);   // later, when nothing iterates the world
+ *
+ * Playback sorts all commands by (sort key, buffer, order of recording).
+ * With keys from the chunk, every chunk's commands stay together and in
+ * order, whichever thread ran it, so the same frame gives the same entity
+ * IDs and the same pool order on any number of threads.
+ *
+ * Then it applies them in four passes: all creates (one block of IDs),
+ * all adds (grouped by component type, one AddMany per type: each pool
+ * grows once), all removes, all destroys. So within one Playback a remove
+ * wins over an add of the same component, and a destroy wins over both.
+ */
+class EntityCommands {
+public:
+    EntityCommands() { Resize(1); }
+
+    // One buffer per worker plus one for every other thread (index 0).
+    void SetJobSystem(JobSystem* jobs);
+
+    // By JobSystem::ThreadIndex(). Threads outside the JobSystem all share
+    // buffer 0: only one of them may record at a time.
+    EntityCommandBuffer& ForThisThread();
+    EntityCommandBuffer& Buffer(uint32_t index) { return m_buffers[index]; }
+    uint32_t BufferCount() const { return static_cast<uint32_t>(m_buffers.size()); }
+
+    bool Empty() const;
+    // Applies every command to `world` and empties the buffers.
+    void Playback(World& world);
+
+    // The real ID of an entity from CreateEntity, after the Playback that
+    // created it (and until the next one). Real IDs are returned as they are.
+    Entity Resolve(Entity e) const;
+
+    const EntityCommandStats& GetStats() const { return m_stats; }
+
+private:
+    using Command = EntityCommandBuffer::Command;
+    using Op = EntityCommandBuffer::Op;
+
+    struct Ref {
+        uint32_t key;
+        uint32_t buffer;
+        uint32_t index; // in the buffer
+    };
+
+    void Resize(uint32_t buffers);
+
+private:
+    EcsVector<EntityCommandBuffer> m_buffers;
+    EcsVector<EcsVector<Entity>> m_created; // per buffer: deferred -> real, of the last Playback
+
+    // Playback scratch, kept so a steady frame allocates nothing
+    EcsVector<Ref> m_order;
+    EcsVector<Ref> m_adds;
+    EcsVector<uint32_t> m_typeStart; // per component type ID, for bucketing m_adds
+    EcsVector<Entity> m_batchEntities;
+    EcsVector<const void*> m_batchData;
+
+    EntityCommandStats m_stats;
+};
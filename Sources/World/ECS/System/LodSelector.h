@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <DirectXMath.h>
+#include "Renderer/Camera.h"
+#include "Renderer/MeshData.h"
+
+using Entity = uint32_t;
+
+/*
+ * LodSelector
+ * Picks which LOD of a mesh an entity should use this frame.
+ *
+ * Every LOD knows how far (in mesh units) it may deviate from the original.
+ * We project that error onto the screen: if it is smaller than
+ * `pixelError` pixels, nobody can see the difference, so the coarser LOD is fine.
+ *
+ * Hysteresis: going to a coarser LOD needs the error to be clearly below
+ * the limit (pixelError * (1 - hysteresis)). Otherwise an entity standing
+ * right at the threshold would switch LODs every frame and "pop".
+ */
+class LodSelector {
+public:
+    struct Settings {
+        float pixelError = 1.0f;  // max visible error on screen, in pixels
+        float hysteresis = 0.25f; // 0..1, size of the "no switching" band
+    };
+
+    void SetSettings(const Settings& s) { m_settings = s; }
+    const Settings& GetSettings() const { return m_settings; }
+
+    // Call once per frame before Select().
+    void BeginFrame(const Camera& camera, float viewportHeight) {
+        m_cameraPos = camera.position;
+        m_nearZ = camera.nearZ;
+        // World units -> pixels at distance 1.
+        m_pixelsPerUnit = viewportHeight / (2.0f * std::tan(camera.fovY * 0.5f));
+    }
+
+    // `center` is the bounding-sphere center in world space,
+    // `scale` the largest axis scale of the entity.
+    uint32_t Select(Entity e, const MeshData& mesh, const DirectX::XMFLOAT3& center, float scale) {
+        const uint32_t count = mesh.LodCount();
+        if (e >= m_current.size())
+            m_current.resize(size_t(e) + 1, 0);
+        if (count == 1) {
+            m_current[e] = 0;
+            return 0;
+        }
+
+        float dx = center.x - m_cameraPos.x;
+        float dy = center.y - m_cameraPos.y;
+        float dz = center.z - m_cameraPos.z;
+        float distance = std::sqrt(dx * dx + dy * dy + dz * dz) - mesh.boundsRadius * scale;
+        float pixelsPerUnit = m_pixelsPerUnit * scale / std::max(distance, m_nearZ);
+
+        // Coarsest LOD whose projected error is still below the limit.
+        uint32_t desired = 0;
+        for (uint32_t lod = 1; lod < count; ++lod) {
+            if (mesh.LodError(lod) * pixelsPerUnit > m_settings.pixelError) break;
+            desired = lod;
+        }
+
+        uint32_t current = std::min<uint32_t>(m_current[e], count - 1);
+        if (desired > current) {
+            // Coarser: only as far as the error is clearly below the limit.
+            const float strictLimit = m_settings.pixelError * (1.0f - m_settings.hysteresis);
+            uint32_t next = current;
+            for (uint32_t lod = current + 1; lod <= desired; ++lod) {
+                if (mesh.LodError(lod) * pixelsPerUnit > strictLimit) break;
+                next = lod;
+            }
+            current = next;
+        }
+        else {
+            // Finer: the current LOD is already visibly wrong, switch right away.
+            current = desired;
+        }
+
+        m_current[e] = uint8_t(current);
+        return current;
+    }
+
+private:
+    Settings m_settings;
+    DirectX::XMFLOAT3 m_cameraPos{ 0.0f, 0.0f, 0.0f };
+    float m_nearZ = 0.1f;
+    float m_pixelsPerUnit = 1.0f;
+    std::vector<uint8_t> m_current; // last LOD per entity, indexed by Entity
+};
@@ -3,10 +3,34 @@
 #include "../World.h"
 #include "Renderer/RenderQueue.h"
 #include "world/ecs/component/mesh.h"
+#include "World/ECS/Component/Animator.h"
+#include "World/ECS/Component/StaticMesh.h"
 #include <windows.h>
 #include "Math/TransformUtils.h"
-inline void BuildRenderQueue(World& world, RenderQueue& queue) {
+#include "Math/Frustum.h"
+#include "Renderer/MeshStorage.h"
+#include "Renderer/Camera.h"
+#include "Renderer/ClusterCulling.h"
+#include "LodSelector.h"
+#include "TransformHistory.h"
+#include <algorithm>
+#include <cmath>
+
+// `history` + `alpha`: draw transforms blended between the last two
+// simulation ticks (fixed timestep mode). nullptr = draw them as they are.
+inline void BuildRenderQueue(World& world, RenderQueue& queue, const MeshStorage& meshes,
+                             const RenderView& view, LodSelector& lods, ClusterCuller& clusters,
+                             const TransformHistory* history = nullptr, float alpha = 1.0f) {
     queue.Clear();
+    lods.BeginFrame(view.camera, view.height);
+
+    const Frustum frustum = BuildFrustum(XMLoadFloat4x4(&view.viewProj));
+    const XMFLOAT3 cameraPos = view.camera.position;
+    // Animated entities are skinned and submitted by AnimationSystem::Skin.
+    const ComponentPool<Animator>* animated = world.FindPool<Animator>();
+    // Merged static entities are drawn with their batch, see StaticBatcher.
+    const ComponentPool<StaticMesh>* statics = world.FindPool<StaticMesh>();
+
     /**
     * The last entity ID equals EntityCount(),
     * so iteration must use <=, not <.
@@ -17,26 +41,56 @@ inline void BuildRenderQueue(World& world, RenderQueue& queue) {
 
     for (Entity e = 1; e <= world.EntityCount(); ++e) {
 
-        Transform* t = world.TryGetComponent<Transform>(e);
+        Transform* current = world.TryGetComponent<Transform>(e);
         Mesh* m = world.TryGetComponent<Mesh>(e);
-        if (!t || !m || m->handle == InvalidMesh)
+        if (!current || !m || m->handle == InvalidMesh)
             continue;
+        if (animated && animated->Has(e))
+            continue;
+        if (statics) {
+            const StaticMesh* s = statics->TryGet(e);
+            if (s && s->batch != InvalidMesh)
+                continue;
+        }
 
-       
-
-        
-
-       
+        const MeshData* data = meshes.Get(m->handle);
+        if (!data)
+            continue;
 
-       
+        const Transform t = history ? history->Blend(e, *current, alpha) : *current;
+        XMMATRIX wm = BuildWorldMatrix(t);
 
-        XMMATRIX wm = BuildWorldMatrix(*t);
+        // Whole object first: a sphere test is much cheaper than anything below.
+        XMFLOAT3 center;
+        XMStoreFloat3(&center, XMVector3Transform(XMLoadFloat3(&data->boundsCenter), wm));
+        float scale = std::max({ std::fabs(t.scale.x), std::fabs(t.scale.y), std::fabs(t.scale.z) });
+        if (!SphereInFrustum(frustum, center, data->boundsRadius * scale))
+            continue;
 
         XMFLOAT4X4 world;
         XMStoreFloat4x4(&world, wm);
 
-        queue.Submit(world, m->handle, e);
-        OutputDebugStringA(("Submitting entity " + std::to_string(e) + "\n").c_str());
+        const uint64_t fullTriangles = data->indices.size() / 3;
+        uint32_t lod = lods.Select(e, *data, center, scale);
+
+        // Meshlets only exist for LOD 0. Culling them is worth it once
+        // there is more than one: only the visible pieces get drawn.
+        if (lod == 0 && data->meshlets.size() > 1) {
+            ClusterCullResult r = clusters.Cull(*data, wm, frustum, cameraPos);
+            queue.AddClusters(r.tested, r.visible);
+            if (r.visible == 0)
+                continue;
 
+            const auto& ranges = clusters.GetRanges();
+            if (r.visible == r.tested)
+                queue.Submit(world, m->handle, e, 0);
+            else
+                queue.SubmitRanges(world, m->handle, e, ranges.data(), uint32_t(ranges.size()));
+            queue.AddTriangles(r.visibleTriangles, fullTriangles);
+        }
+        else {
+            queue.Submit(world, m->handle, e, lod);
+            queue.AddTriangles(data->LodIndices(lod).size() / 3, fullTriangles);
+        }
     }
 }
@@ -0,0 +1,318 @@
+#include "SpatialGrid.h"
+#include "Threading/JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace {
+    // Without outDistSq, QueryNearest keeps the distances on the stack.
+    constexpr uint32_t MaxLocalNearest = 64;
+}
+
+void SpatialGrid::SetSettings(const Settings& settings)
+{
+    m_settings = settings;
+    if (m_settings.cellSize <= 0.0f) m_settings.cellSize = 1.0f;
+    if (m_settings.entitiesPerJob == 0) m_settings.entitiesPerJob = 1;
+    if (m_settings.queriesPerJob == 0) m_settings.queriesPerJob = 1;
+    m_invCellSize = 1.0f / m_settings.cellSize;
+    m_dirty = true;
+}
+
+void SpatialGrid::Clear()
+{
+    m_count = 0;
+    m_dirty = true;
+    m_stats.entities = 0;
+}
+
+uint32_t SpatialGrid::BucketOf(uint64_t key) const
+{
+    // Fibonacci hashing: neighbouring cells land in unrelated buckets.
+    return uint32_t((key * 0x9E3779B97F4A7C15ull) >> (64 - m_bucketBits));
+}
+
+SpatialGrid::CellRange SpatialGrid::RangeOf(const XMFLOAT3& min, const XMFLOAT3& max) const
+{
+    CellRange r;
+    r.min[0] = CellCoord(min.x); r.max[0] = CellCoord(max.x);
+    r.min[1] = CellCoord(min.y); r.max[1] = CellCoord(max.y);
+    r.min[2] = CellCoord(min.z); r.max[2] = CellCoord(max.z);
+    return r;
+}
+
+template<typename Fn>
+void SpatialGrid::ForEachSlot(const CellRange& range, Fn&& fn) const
+{
+    // A huge shape touches more cells than there are entities:
+    // looking at every entity once is cheaper then.
+    if (range.Cells() > m_count) {
+        for (uint32_t slot = 0; slot < m_count; ++slot)
+            fn(slot);
+        return;
+    }
+
+    for (int32_t x = range.min[0]; x <= range.max[0]; ++x)
+        for (int32_t y = range.min[1]; y <= range.max[1]; ++y)
+            for (int32_t z = range.min[2]; z <= range.max[2]; ++z)
+                ForEachSlotInCell(GridKey(x, y, z), fn);
+}
+
+template<typename Fn>
+void SpatialGrid::ForEachSlotInCell(uint64_t key, Fn&& fn) const
+{
+    const uint32_t b = BucketOf(key);
+    if (!(m_occupied[b >> 6] & (uint64_t(1) << (b & 63))))
+        return;
+    for (uint32_t slot = m_start[b], end = m_start[b + 1]; slot < end; ++slot)
+        if (m_slots[slot].key == key)
+            fn(slot);
+}
+
+// ---- Update ----
+
+void SpatialGrid::Update(const World& world)
+{
+    const ComponentPool<Transform>* pool = world.FindPool<Transform>();
+    const uint32_t n = pool ? uint32_t(pool->Size()) : 0;
+    const Entity* entities = n ? pool->Entities().data() : nullptr;
+    const Transform* data = n ? pool->Data().data() : nullptr;
+
+    // At least one bucket per entity keeps buckets short. Only grows, so a
+    // count going up and down doesn't re-sort every time.
+    uint32_t bits = std::max(m_bucketBits, 6u);
+    while (bits < 31 && (uint64_t(1) << bits) < uint64_t(n))
+        ++bits;
+    if (bits != m_bucketBits || n != m_count) {
+        m_bucketBits = bits;
+        m_dirty = true;
+    }
+
+    m_newKeys.resize(n);
+
+    // One pass computes every entity's cell and, if the layout can stay,
+    // copies the new positions into their slots.
+    uint32_t changes = 0;
+    if (m_jobs && n >= m_settings.parallelThreshold) {
+        std::atomic<uint32_t> total{ 0 };
+        m_jobs->ParallelFor(n, m_settings.entitiesPerJob, [&](uint32_t begin, uint32_t end) {
+            const uint32_t c = Refresh(entities, data, begin, end);
+            if (c) total.fetch_add(c, std::memory_order_relaxed);
+        });
+        changes = total.load(std::memory_order_relaxed);
+    }
+    else {
+        changes = Refresh(entities, data, 0, n);
+    }
+
+    m_stats.entities = n;
+    m_stats.buckets = 1u << m_bucketBits;
+    if (m_dirty || changes) {
+        m_stats.cellChanges = m_dirty ? n : changes;
+        Rebuild(entities, data);
+        ++m_stats.rebuilds;
+    }
+    else {
+        m_stats.cellChanges = 0;
+        ++m_stats.refreshes;
+    }
+}
+
+// Returns how many entities of [begin, end) left their cell (or moved in the pool).
+uint32_t SpatialGrid::Refresh(const Entity* entities, const Transform* data, uint32_t begin, uint32_t end)
+{
+    uint32_t changes = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        const XMFLOAT3& p = data[i].position;
+        const uint64_t key = GridKey(CellCoord(p.x), CellCoord(p.y), CellCoord(p.z));
+        m_newKeys[i] = key;
+        if (m_dirty)
+            continue;
+
+        Slot& slot = m_slots[m_slotOf[i]];
+        if (slot.key != key || slot.entity != entities[i]) {
+            ++changes;
+            continue;
+        }
+        slot.x = p.x;
+        slot.y = p.y;
+        slot.z = p.z;
+    }
+    return changes;
+}
+
+// Counting sort by bucket: count, prefix sum, scatter.
+void SpatialGrid::Rebuild(const Entity* entities, const Transform* data)
+{
+    const uint32_t n = uint32_t(m_newKeys.size());
+    const uint32_t buckets = 1u << m_bucketBits;
+
+    m_start.assign(size_t(buckets) + 1, 0);
+    for (uint32_t i = 0; i < n; ++i)
+        ++m_start[BucketOf(m_newKeys[i]) + 1];
+    for (uint32_t b = 0; b < buckets; ++b)
+        m_start[b + 1] += m_start[b];
+
+    m_occupied.assign((size_t(buckets) + 63) / 64, 0);
+    for (uint32_t b = 0; b < buckets; ++b)
+        if (m_start[b + 1] != m_start[b])
+            m_occupied[b >> 6] |= uint64_t(1) << (b & 63);
+
+    m_cursor.assign(m_start.begin(), m_start.end() - 1);
+    m_slots.resize(n);
+    m_slotOf.resize(n);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        const uint64_t key = m_newKeys[i];
+        const uint32_t slot = m_cursor[BucketOf(key)]++;
+        const XMFLOAT3& p = data[i].position;
+        m_slots[slot] = { p.x, p.y, p.z, entities[i], key };
+        m_slotOf[i] = slot;
+    }
+
+    m_count = n;
+    m_dirty = false;
+}
+
+// ---- Queries ----
+
+uint32_t SpatialGrid::QueryRadius(const XMFLOAT3& c, float radius, Entity* out, uint32_t capacity) const
+{
+    if (m_count == 0 || radius < 0.0f) return 0;
+
+    const float r2 = radius * radius;
+    uint32_t found = 0;
+    ForEachSlot(RangeOf({ c.x - radius, c.y - radius, c.z - radius }, { c.x + radius, c.y + radius, c.z + radius }),
+        [&](uint32_t slot) {
+            const Slot& s = m_slots[slot];
+            const float dx = s.x - c.x, dy = s.y - c.y, dz = s.z - c.z;
+            if (dx * dx + dy * dy + dz * dz > r2) return;
+            if (found < capacity) out[found] = s.entity;
+            ++found;
+        });
+    return found;
+}
+
+uint32_t SpatialGrid::QueryBox(const XMFLOAT3& min, const XMFLOAT3& max, Entity* out, uint32_t capacity) const
+{
+    if (m_count == 0 || min.x > max.x || min.y > max.y || min.z > max.z) return 0;
+
+    uint32_t found = 0;
+    ForEachSlot(RangeOf(min, max), [&](uint32_t slot) {
+        const Slot& s = m_slots[slot];
+        if (s.x < min.x || s.x > max.x || s.y < min.y || s.y > max.y || s.z < min.z || s.z > max.z) return;
+        if (found < capacity) out[found] = s.entity;
+        ++found;
+    });
+    return found;
+}
+
+uint32_t SpatialGrid::QueryNearest(const XMFLOAT3& c, uint32_t k, float maxRadius, Entity* out, float* outDistSq) const
+{
+    float local[MaxLocalNearest];
+    float* dist = outDistSq;
+    if (!dist) {
+        dist = local;
+        k = std::min(k, MaxLocalNearest);
+    }
+    if (m_count == 0 || k == 0 || maxRadius < 0.0f) return 0;
+
+    // out / dist stay sorted by distance; a new entity is inserted in place.
+    // Fine for the small k of neighbour searches.
+    const float r2 = maxRadius * maxRadius;
+    uint32_t found = 0;
+    auto consider = [&](uint32_t slot) {
+        const Slot& s = m_slots[slot];
+        const float dx = s.x - c.x, dy = s.y - c.y, dz = s.z - c.z;
+        const float d = dx * dx + dy * dy + dz * dz;
+        if (d > r2 || (found == k && d >= dist[k - 1])) return;
+        uint32_t pos = found < k ? found++ : k - 1;
+        while (pos > 0 && dist[pos - 1] > d) {
+            dist[pos] = dist[pos - 1];
+            out[pos] = out[pos - 1];
+            --pos;
+        }
+        dist[pos] = d;
+        out[pos] = s.entity;
+    };
+
+    const CellRange range = RangeOf({ c.x - maxRadius, c.y - maxRadius, c.z - maxRadius },
+                                    { c.x + maxRadius, c.y + maxRadius, c.z + maxRadius });
+    if (range.Cells() > m_count) {
+        ForEachSlot(range, consider); // visits everything once
+        return found;
+    }
+
+    // Rings of cells around the center's cell, nearest first. Everything in
+    // ring r + 1 is at least r cells away, so once the k found so far are
+    // all closer than that, the search is over.
+    const int32_t cell[3] = { CellCoord(c.x), CellCoord(c.y), CellCoord(c.z) };
+    int32_t rings = 0;
+    for (int a = 0; a < 3; ++a)
+        rings = std::max({ rings, cell[a] - range.min[a], range.max[a] - cell[a] });
+
+    auto visitCell = [&](int32_t x, int32_t y, int32_t z) {
+        if (x < range.min[0] || x > range.max[0] || y < range.min[1] || y > range.max[1] ||
+            z < range.min[2] || z > range.max[2]) return;
+        ForEachSlotInCell(GridKey(x, y, z), consider);
+    };
+
+    for (int32_t r = 0; r <= rings; ++r) {
+        for (int32_t dz = -r; dz <= r; ++dz)
+            for (int32_t dy = -r; dy <= r; ++dy) {
+                if (dz == -r || dz == r || dy == -r || dy == r) {
+                    for (int32_t dx = -r; dx <= r; ++dx)
+                        visitCell(cell[0] + dx, cell[1] + dy, cell[2] + dz);
+                }
+                else {
+                    // Inside the ring's cube only the two x faces are new.
+                    visitCell(cell[0] - r, cell[1] + dy, cell[2] + dz);
+                    if (r > 0) visitCell(cell[0] + r, cell[1] + dy, cell[2] + dz);
+                }
+            }
+
+        const float reach = float(r) * m_settings.cellSize;
+        if (found == k && dist[k - 1] <= reach * reach)
+            break;
+    }
+    return found;
+}
+
+// ---- Batches ----
+
+void SpatialGrid::QueryRadiusBatch(const XMFLOAT3* centers, uint32_t count, float radius,
+                                   Entity* results, uint32_t stride, uint32_t* counts) const
+{
+    auto run = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+            counts[i] = QueryRadius(centers[i], radius, results + size_t(i) * stride, stride);
+    };
+    if (m_jobs) m_jobs->ParallelFor(count, m_settings.queriesPerJob, run);
+    else run(0, count);
+}
+
+void SpatialGrid::QueryBoxBatch(const XMFLOAT3* mins, const XMFLOAT3* maxs, uint32_t count,
+                                Entity* results, uint32_t stride, uint32_t* counts) const
+{
+    auto run = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+            counts[i] = QueryBox(mins[i], maxs[i], results + size_t(i) * stride, stride);
+    };
+    if (m_jobs) m_jobs->ParallelFor(count, m_settings.queriesPerJob, run);
+    else run(0, count);
+}
+
+void SpatialGrid::QueryNearestBatch(const XMFLOAT3* centers, uint32_t count, uint32_t k, float maxRadius,
+                                    Entity* results, float* distSq, uint32_t* counts) const
+{
+    auto run = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+            counts[i] = QueryNearest(centers[i], k, maxRadius, results + size_t(i) * k,
+                                     distSq ? distSq + size_t(i) * k : nullptr);
+    };
+    if (m_jobs) m_jobs->ParallelFor(count, m_settings.queriesPerJob, run);
+    else run(0, count);
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdint>
+#include <DirectXMath.h>
+#include "../World.h"
+#include "Math/GridKey.h"
+#include "World/ECS/Component/Transform.h"
+
+class JobSystem;
+
+struct SpatialGridStats {
+    uint32_t entities = 0;     // indexed by the last Update
+    uint32_t buckets = 0;
+    uint32_t cellChanges = 0;  // entities that moved to another cell in the last Update
+    uint64_t rebuilds = 0;     // Updates that re-sorted everything
+    uint64_t refreshes = 0;    // Updates that only copied positions
+};
+
+/*
+ * SpatialGrid
+ * "Which entities are near this point?" without looking at every Transform.
+ *
+ * Space is cut into cubes of `cellSize`. Each cell is hashed into a bucket,
+ * and every entity with a Transform is stored in the bucket of its cell:
+ *
+ *   m_start[b] .. m_start[b + 1]  -> the slots of bucket b
+ *   m_slots[slot]                 -> position, entity, which cell exactly
+ *
+ * So a query only visits the cells its shape overlaps. Hashing (instead of
+ * one big 3D array) means the world has no bounds and empty space costs
+ * nothing. Two cells can share a bucket; the cell key in the slot tells
+ * them apart.
+ *
+ * Queries are mostly waiting for memory, so a slot keeps everything a query
+ * reads in one place (one cache line for a small bucket), and a bit per
+ * bucket (m_occupied, small enough to stay in cache) answers "is anything
+ * here?" for the many empty cells without touching the big arrays.
+ *
+ * Update
+ *   Call once per simulation tick (Core does when the grid is enabled, see
+ *   Core::enableSpatialGrid). It reads the Transform pool and re-sorts by bucket
+ *   (a counting sort, O(N)). If no entity left its cell since the last
+ *   Update, only the positions are copied, in parallel.
+ *
+ * Queries
+ *   Read-only, so any number of threads may query at the same time, as
+ *   long as nobody calls Update meanwhile. They never allocate: results go
+ *   into buffers given by the caller. The return value is how many entities
+ *   matched; only the first `capacity` of them are written (like snprintf).
+ *   Radius and box results are in no particular order, nearest ones are
+ *   sorted by distance. An entity's own position matches too, so "my 8
+ *   nearest neighbours" asks for 9 and skips itself.
+ *
+ *   The *Batch versions run many queries over the JobSystem; query i writes
+ *   to results[i * stride ...] and counts[i].
+ */
+class SpatialGrid {
+public:
+    struct Settings {
+        float cellSize = 4.0f;             // about the usual query radius
+        uint32_t parallelThreshold = 4096; // fewer entities: Update stays on this thread
+        uint32_t entitiesPerJob = 4096;
+        uint32_t queriesPerJob = 64;
+    };
+
+    SpatialGrid() = default;
+    explicit SpatialGrid(const Settings& settings) { SetSettings(settings); }
+
+    void SetSettings(const Settings& settings); // a new cell size re-sorts on the next Update
+    const Settings& GetSettings() const { return m_settings; }
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+
+    void Update(const World& world);
+    void Clear();
+
+    uint32_t QueryRadius(const DirectX::XMFLOAT3& center, float radius, Entity* out, uint32_t capacity) const;
+    uint32_t QueryBox(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max, Entity* out, uint32_t capacity) const;
+    // Up to k entities within maxRadius, closest first; returns how many.
+    // outDistSq gets their squared distances; without it k is capped at 64.
+    uint32_t QueryNearest(const DirectX::XMFLOAT3& center, uint32_t k, float maxRadius,
+                          Entity* out, float* outDistSq = nullptr) const;
+
+    void QueryRadiusBatch(const DirectX::XMFLOAT3* centers, uint32_t count, float radius,
+                          Entity* results, uint32_t stride, uint32_t* counts) const;
+    void QueryBoxBatch(const DirectX::XMFLOAT3* mins, const DirectX::XMFLOAT3* maxs, uint32_t count,
+                       Entity* results, uint32_t stride, uint32_t* counts) const;
+    // results and distSq (optional) hold k entries per query.
+    void QueryNearestBatch(const DirectX::XMFLOAT3* centers, uint32_t count, uint32_t k, float maxRadius,
+                           Entity* results, float* distSq, uint32_t* counts) const;
+
+    uint32_t Size() const { return m_count; }
+    const SpatialGridStats& GetStats() const { return m_stats; }
+
+private:
+    struct Slot {
+        float x, y, z;
+        Entity entity;
+        uint64_t key; // packed cell coordinates
+    };
+
+    struct CellRange {
+        int32_t min[3];
+        int32_t max[3];
+        uint64_t Cells() const {
+            return uint64_t(max[0] - min[0] + 1) * uint64_t(max[1] - min[1] + 1) * uint64_t(max[2] - min[2] + 1);
+        }
+    };
+
+    int32_t CellCoord(float v) const { return GridCoord(v, m_invCellSize); }
+    uint32_t BucketOf(uint64_t key) const;
+    CellRange RangeOf(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max) const;
+
+    // Calls fn(slot) for every slot in the cells of `range` (or all slots,
+    // when the range covers more cells than there are entities).
+    template<typename Fn>
+    void ForEachSlot(const CellRange& range, Fn&& fn) const;
+    template<typename Fn>
+    void ForEachSlotInCell(uint64_t key, Fn&& fn) const;
+
+    uint32_t Refresh(const Entity* entities, const Transform* data, uint32_t begin, uint32_t end);
+    void Rebuild(const Entity* entities, const Transform* data);
+
+private:
+    Settings m_settings;
+    float m_invCellSize = 1.0f / 4.0f;
+    JobSystem* m_jobs = nullptr; // optional
+
+    uint32_t m_count = 0;
+    uint32_t m_bucketBits = 0;
+    bool m_dirty = true; // next Update must re-sort
+
+    EcsVector<uint32_t> m_start;    // per bucket + 1, prefix sums
+    EcsVector<uint64_t> m_occupied; // a bit per bucket: has slots
+    EcsVector<uint32_t> m_cursor;   // scratch for the counting sort
+    EcsVector<Slot> m_slots;
+
+    EcsVector<uint64_t> m_newKeys; // per pool index, this Update
+    EcsVector<uint32_t> m_slotOf;  // per pool index: slot from the last sort
+
+    SpatialGridStats m_stats;
+};
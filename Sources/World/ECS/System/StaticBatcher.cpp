@@ -0,0 +1,267 @@
+#include "StaticBatcher.h"
+#include "World/ECS/Component/Animator.h"
+#include "World/ECS/Component/Mesh.h"
+#include "World/ECS/Component/StaticMesh.h"
+#include "World/ECS/Component/Transform.h"
+#include "Renderer/MeshStorage.h"
+#include "Math/Frustum.h"
+#include "Math/TransformUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+
+namespace {
+
+    enum LayoutBits : uint8_t { HasNormals = 1, HasTangents = 2, HasUvs = 4 };
+
+    // Which optional attributes a mesh has, the way MeshStorage decides
+    // them: meshes of one batch must agree, or the merged mesh would get
+    // another vertex format (and shader) than its parts.
+    uint8_t LayoutOf(const MeshData& mesh) {
+        const size_t n = mesh.positions.size();
+        uint8_t layout = 0;
+        if (n && mesh.normals.size() == n) layout |= HasNormals;
+        if (n && mesh.tangents.size() == n) layout |= HasTangents;
+        if (n && mesh.uvs.size() == n) layout |= HasUvs;
+        return layout;
+    }
+
+    // Spreads the low 10 bits of v over every other bit.
+    uint32_t Spread(uint32_t v) {
+        v &= 0x3FF;
+        v = (v | (v << 16)) & 0x030000FF;
+        v = (v | (v << 8)) & 0x0300F00F;
+        v = (v | (v << 4)) & 0x030C30C3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    struct Entry {
+        Entity entity;
+        MeshHandle mesh;
+        int32_t cellX, cellZ;
+        uint8_t layout;
+        uint32_t order;      // Z-order of the position within the cell
+        XMFLOAT4X4 world;
+        XMFLOAT3 center;     // bounding sphere, world space
+        float radius;
+    };
+
+    bool SameGroup(const Entry& a, const Entry& b) {
+        return a.cellX == b.cellX && a.cellZ == b.cellZ && a.layout == b.layout;
+    }
+
+} // namespace
+
+uint32_t StaticBatcher::Build(World& world, MeshStorage& meshes)
+{
+    AllocScope scope(AllocTag::Render);
+    ComponentPool<StaticMesh>* statics = world.FindPool<StaticMesh>();
+    if (!statics)
+        return 0;
+    const ComponentPool<Animator>* animated = world.FindPool<Animator>();
+    const float cellSize = m_settings.cellSize > 0.0f ? m_settings.cellSize : 1.0f;
+
+    // ---- what can be merged, and where it is ----
+    std::vector<Entry> entries;
+    entries.reserve(statics->Size());
+    for (size_t i = 0; i < statics->Size(); ++i) {
+        const Entity e = statics->Entities()[i];
+        if (statics->Data()[i].batch != InvalidMesh)
+            continue; // already in a batch
+        const Transform* t = world.TryGetComponent<Transform>(e);
+        const Mesh* m = world.TryGetComponent<Mesh>(e);
+        if (!t || !m || (animated && animated->Has(e)))
+            continue;
+        const MeshData* data = meshes.Get(m->handle);
+        if (!data || data->positions.empty() || data->indices.empty() || data->IsSkinned())
+            continue;
+
+        Entry entry;
+        entry.entity = e;
+        entry.mesh = m->handle;
+        entry.layout = LayoutOf(*data);
+        const XMMATRIX wm = BuildWorldMatrix(*t);
+        XMStoreFloat4x4(&entry.world, wm);
+        XMStoreFloat3(&entry.center, XMVector3TransformCoord(XMLoadFloat3(&data->boundsCenter), wm));
+        entry.radius = data->boundsRadius * std::max({ std::fabs(t->scale.x), std::fabs(t->scale.y), std::fabs(t->scale.z) });
+
+        const float cx = entry.center.x / cellSize;
+        const float cz = entry.center.z / cellSize;
+        entry.cellX = int32_t(std::floor(cx));
+        entry.cellZ = int32_t(std::floor(cz));
+        entry.order = Spread(uint32_t((cx - float(entry.cellX)) * 1023.0f)) |
+                      (Spread(uint32_t((cz - float(entry.cellZ)) * 1023.0f)) << 1);
+        entries.push_back(entry);
+    }
+
+    // Groups next to each other, near entities next to each other within
+    // a group; the entity ID makes the order independent of the pool order.
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.cellZ != b.cellZ) return a.cellZ < b.cellZ;
+        if (a.cellX != b.cellX) return a.cellX < b.cellX;
+        if (a.layout != b.layout) return a.layout < b.layout;
+        if (a.order != b.order) return a.order < b.order;
+        return a.entity < b.entity;
+    });
+
+    // ---- one merged mesh per group (or several, see maxVertices) ----
+    uint32_t merged = 0;
+    MeshData batchMesh;
+    size_t groupBegin = 0;
+    while (groupBegin < entries.size()) {
+        size_t groupEnd = groupBegin + 1;
+        while (groupEnd < entries.size() && SameGroup(entries[groupBegin], entries[groupEnd]))
+            ++groupEnd;
+        if (groupEnd - groupBegin < std::max(m_settings.minEntities, 1u)) {
+            m_stats.leftAlone += uint32_t(groupEnd - groupBegin);
+            groupBegin = groupEnd;
+            continue;
+        }
+
+        size_t i = groupBegin;
+        while (i < groupEnd) {
+            batchMesh = MeshData{};
+            StaticBatch batch;
+            batch.cellX = entries[i].cellX;
+            batch.cellZ = entries[i].cellZ;
+            batch.firstPart = static_cast<uint32_t>(m_parts.size());
+            const uint8_t layout = entries[i].layout;
+
+            size_t end = i;
+            for (; end < groupEnd; ++end) {
+                const Entry& entry = entries[end];
+                const MeshData& src = *meshes.Get(entry.mesh);
+                const size_t base = batchMesh.positions.size();
+                if (end > i && base + src.positions.size() > m_settings.maxVertices)
+                    break;
+
+                // Into world space. Normals and tangents go with the inverse
+                // transpose, so non-uniform scale doesn't bend them.
+                const XMMATRIX wm = XMLoadFloat4x4(&entry.world);
+                const XMMATRIX normalMatrix = XMMatrixTranspose(XMMatrixInverse(nullptr, wm));
+                const bool mirrored = XMVectorGetX(XMMatrixDeterminant(wm)) < 0.0f;
+                for (const XMFLOAT3& p : src.positions) {
+                    XMFLOAT3 out;
+                    XMStoreFloat3(&out, XMVector3TransformCoord(XMLoadFloat3(&p), wm));
+                    batchMesh.positions.push_back(out);
+                }
+                if (layout & HasNormals)
+                    for (const XMFLOAT3& n : src.normals) {
+                        XMFLOAT3 out;
+                        XMStoreFloat3(&out, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&n), normalMatrix)));
+                        batchMesh.normals.push_back(out);
+                    }
+                if (layout & HasTangents)
+                    for (const XMFLOAT4& t : src.tangents) {
+                        XMFLOAT4 out;
+                        XMStoreFloat4(&out, XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(t.x, t.y, t.z, 0.0f), wm)));
+                        out.w = mirrored ? -t.w : t.w;
+                        batchMesh.tangents.push_back(out);
+                    }
+                if (layout & HasUvs)
+                    batchMesh.uvs.insert(batchMesh.uvs.end(), src.uvs.begin(), src.uvs.end());
+
+                // A mirroring transform turns triangles inside out: flip the winding back.
+                StaticBatchPart part;
+                part.range.firstIndex = static_cast<uint32_t>(batchMesh.indices.size());
+                part.range.indexCount = static_cast<uint32_t>(src.indices.size() / 3 * 3);
+                for (size_t k = 0; k + 2 < src.indices.size(); k += 3) {
+                    const uint32_t a = uint32_t(base) + src.indices[k];
+                    const uint32_t b = uint32_t(base) + src.indices[k + 1];
+                    const uint32_t c = uint32_t(base) + src.indices[k + 2];
+                    batchMesh.indices.insert(batchMesh.indices.end(), { a, mirrored ? c : b, mirrored ? b : c });
+                }
+                part.center = entry.center;
+                part.radius = entry.radius;
+                part.entity = entry.entity;
+                m_parts.push_back(part);
+            }
+
+            // Bounds around all parts
+            XMFLOAT3 mn = m_parts[batch.firstPart].center, mx = mn;
+            for (size_t p = batch.firstPart; p < m_parts.size(); ++p) {
+                const StaticBatchPart& part = m_parts[p];
+                mn = { std::min(mn.x, part.center.x - part.radius), std::min(mn.y, part.center.y - part.radius), std::min(mn.z, part.center.z - part.radius) };
+                mx = { std::max(mx.x, part.center.x + part.radius), std::max(mx.y, part.center.y + part.radius), std::max(mx.z, part.center.z + part.radius) };
+            }
+            batch.center = { (mn.x + mx.x) * 0.5f, (mn.y + mx.y) * 0.5f, (mn.z + mx.z) * 0.5f };
+            for (size_t p = batch.firstPart; p < m_parts.size(); ++p) {
+                const StaticBatchPart& part = m_parts[p];
+                const float dx = part.center.x - batch.center.x;
+                const float dy = part.center.y - batch.center.y;
+                const float dz = part.center.z - batch.center.z;
+                batch.radius = std::max(batch.radius, std::sqrt(dx * dx + dy * dy + dz * dz) + part.radius);
+            }
+
+            batch.partCount = static_cast<uint32_t>(m_parts.size()) - batch.firstPart;
+            batch.indexCount = static_cast<uint32_t>(batchMesh.indices.size());
+            batch.mesh = meshes.AddMerged(batchMesh, "StaticBatch " + std::to_string(batch.cellX) + "," +
+                std::to_string(batch.cellZ) + "#" + std::to_string(m_batches.size()));
+            for (size_t k = i; k < end; ++k)
+                statics->TryGet(entries[k].entity)->batch = batch.mesh;
+
+            m_stats.vertices += batchMesh.positions.size();
+            m_stats.indices += batchMesh.indices.size();
+            merged += batch.partCount;
+            m_batches.push_back(batch);
+            i = end;
+        }
+        groupBegin = groupEnd;
+    }
+
+    m_stats.entities += merged;
+    m_stats.batches = static_cast<uint32_t>(m_batches.size());
+    return merged;
+}
+
+void StaticBatcher::Submit(const World& world, RenderQueue& queue, const RenderView& view)
+{
+    m_stats.batchesVisible = m_stats.partsVisible = m_stats.ranges = 0;
+    const ComponentPool<StaticMesh>* statics = world.FindPool<StaticMesh>();
+    if (m_batches.empty() || !statics)
+        return;
+
+    const Frustum frustum = BuildFrustum(XMLoadFloat4x4(&view.viewProj));
+    XMFLOAT4X4 identity;
+    XMStoreFloat4x4(&identity, XMMatrixIdentity());
+
+    for (const StaticBatch& batch : m_batches) {
+        if (!SphereInFrustum(frustum, batch.center, batch.radius))
+            continue;
+
+        // Visible parts; a part that starts where the last one ended
+        // extends its range instead of adding a draw.
+        m_ranges.clear();
+        uint64_t indices = 0;
+        for (uint32_t p = batch.firstPart; p < batch.firstPart + batch.partCount; ++p) {
+            const StaticBatchPart& part = m_parts[p];
+            if (!SphereInFrustum(frustum, part.center, part.radius))
+                continue;
+            // Destroyed or no longer static since Build.
+            const StaticMesh* link = statics->TryGet(part.entity);
+            if (!link || link->batch != batch.mesh)
+                continue;
+            if (!m_ranges.empty() && m_ranges.back().firstIndex + m_ranges.back().indexCount == part.range.firstIndex)
+                m_ranges.back().indexCount += part.range.indexCount;
+            else
+                m_ranges.push_back(part.range);
+            indices += part.range.indexCount;
+            ++m_stats.partsVisible;
+        }
+        if (m_ranges.empty())
+            continue;
+
+        if (indices == batch.indexCount)
+            queue.Submit(identity, batch.mesh, 0);
+        else
+            queue.SubmitRanges(identity, batch.mesh, 0, m_ranges.data(), static_cast<uint32_t>(m_ranges.size()));
+        queue.AddTriangles(indices / 3, batch.indexCount / 3);
+        ++m_stats.batchesVisible;
+        m_stats.ranges += static_cast<uint32_t>(m_ranges.size());
+    }
+}
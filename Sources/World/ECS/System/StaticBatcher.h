@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <DirectXMath.h>
+#include "../World.h"
+#include "Renderer/MeshHandle.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/Camera.h"
+
+class MeshStorage;
+
+// One entity inside a batch: its indices and where it is.
+struct StaticBatchPart {
+    IndexRange range;               // in the batch mesh's indices
+    DirectX::XMFLOAT3 center{ 0.0f, 0.0f, 0.0f }; // bounding sphere, world space
+    float radius = 0.0f;
+    Entity entity = 0;
+};
+
+// One merged mesh: the static entities of one cell that share a vertex
+// layout (so the same shader and input layout).
+struct StaticBatch {
+    MeshHandle mesh = InvalidMesh;
+    int32_t cellX = 0, cellZ = 0;
+    uint32_t firstPart = 0;         // in StaticBatcher::GetParts()
+    uint32_t partCount = 0;
+    uint32_t indexCount = 0;        // of the whole mesh
+    DirectX::XMFLOAT3 center{ 0.0f, 0.0f, 0.0f }; // around all parts, world space
+    float radius = 0.0f;
+};
+
+struct StaticBatchStats {
+    // Build
+    uint32_t entities = 0;      // merged into batches
+    uint32_t leftAlone = 0;     // static, but alone in their group: drawn as before
+    uint32_t batches = 0;
+    uint64_t vertices = 0;
+    uint64_t indices = 0;
+
+    // The last Submit
+    uint32_t batchesVisible = 0;
+    uint32_t partsVisible = 0;
+    uint32_t ranges = 0;        // draws: neighbouring visible parts share one
+};
+
+/*
+ * StaticBatcher
+ * Many static props use different small meshes, so instancing doesn't help,
+ * and each one would cost its own draw (constants, buffers, layout, shader).
+ *
+ * Build() runs once, at level load. It takes every entity with a
+ * StaticMesh, a Mesh and a Transform and groups them by cell (`cellSize`
+ * on the XZ plane) and by vertex layout (which attributes the mesh has;
+ * that decides the shader). The meshes of a group are transformed into
+ * world space and appended into one new mesh in MeshStorage (AddMerged),
+ * so the whole group is one vertex and one index buffer, drawn with an
+ * identity world matrix.
+ *
+ * Every entity keeps its own index range (a "part") and bounding sphere,
+ * so Submit() can still cull per entity: parts outside the frustum are
+ * dropped, and neighbouring visible parts are drawn as one range. Parts
+ * are ordered along a Z-order curve within the cell, so things that are
+ * close together are usually visible together and end up in one draw.
+ *
+ * Submit() also checks each visible part's entity against the world: one
+ * that was destroyed, or lost its StaticMesh, after Build is not drawn
+ * with the batch any more (without a StaticMesh, BuildRenderQueue draws
+ * it on its own again). Its vertices stay in the merged mesh.
+ *
+ * What is lost: per-entity LODs and meshlet culling (parts are always
+ * LOD 0), and moving the entities (their Transform is read once; call
+ * Build again for new entities, it never takes one twice). The merged
+ * meshes stay in MeshStorage, which can't remove meshes: don't rebuild
+ * every frame.
+ */
+class StaticBatcher {
+public:
+    struct Settings {
+        float cellSize = 32.0f;
+        uint32_t maxVertices = 1u << 16; // per batch; a bigger group gets several
+        uint32_t minEntities = 2;        // smaller groups aren't worth merging
+    };
+
+    void SetSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& GetSettings() const { return m_settings; }
+
+    // Merges the static entities that aren't in a batch yet; returns how many.
+    uint32_t Build(World& world, MeshStorage& meshes);
+
+    // Culls and submits every batch, see RenderQueue::SubmitRanges. Parts
+    // whose entity is no longer in their batch in `world` are left out.
+    void Submit(const World& world, RenderQueue& queue, const RenderView& view);
+
+    const RenderVector<StaticBatch>& GetBatches() const { return m_batches; }
+    const RenderVector<StaticBatchPart>& GetParts() const { return m_parts; }
+    const StaticBatchStats& GetStats() const { return m_stats; }
+
+private:
+    Settings m_settings;
+    RenderVector<StaticBatch> m_batches;
+    RenderVector<StaticBatchPart> m_parts;
+    RenderVector<IndexRange> m_ranges; // Submit scratch
+    StaticBatchStats m_stats;
+};
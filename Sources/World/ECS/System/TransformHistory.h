@@ -0,0 +1,83 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include "../World.h"
+#include "World/ECS/Component/Transform.h"
+
+/*
+ * TransformHistory
+ * Remembers every Transform as it was before the latest simulation tick,
+ * so the renderer can draw a blend of the last two ticks.
+ *
+ * With a fixed timestep the simulation runs at e.g. 60 Hz while frames
+ * come at any rate. Drawing only the latest tick makes motion stutter
+ * (some frames show the same tick twice, others skip one). Drawing
+ *     previous + (current - previous) * alpha
+ * with alpha from FixedTimestep::Alpha() moves things smoothly, at the cost
+ * of showing the world at most one tick late.
+ *
+ * Entities created during the latest tick have no previous state and are
+ * drawn as they are.
+ */
+class TransformHistory {
+public:
+    // Call right before every simulation tick.
+    void Capture(const World& world) {
+        ++m_stamp;
+        const ComponentPool<Transform>* pool = world.FindPool<Transform>();
+        if (!pool) return;
+
+        const size_t size = size_t(world.EntityCount()) + 1;
+        if (m_previous.size() < size) {
+            m_previous.resize(size);
+            m_stamps.resize(size, 0);
+        }
+
+        const auto& entities = pool->Entities();
+        const auto& data = pool->Data();
+        for (size_t i = 0; i < entities.size(); ++i) {
+            m_previous[entities[i]] = data[i];
+            m_stamps[entities[i]] = m_stamp;
+        }
+    }
+
+    // The transform to draw for `e` at `alpha` (0 = previous tick, 1 = current).
+    Transform Blend(Entity e, const Transform& current, float alpha) const {
+        if (e >= m_stamps.size() || m_stamps[e] != m_stamp || alpha >= 1.0f)
+            return current;
+
+        const Transform& prev = m_previous[e];
+        Transform t;
+        t.position = Lerp(prev.position, current.position, alpha);
+        t.scale = Lerp(prev.scale, current.scale, alpha);
+        t.rotation = {
+            LerpAngle(prev.rotation.x, current.rotation.x, alpha),
+            LerpAngle(prev.rotation.y, current.rotation.y, alpha),
+            LerpAngle(prev.rotation.z, current.rotation.z, alpha)
+        };
+        return t;
+    }
+
+    void Clear() {
+        m_previous.clear();
+        m_stamps.clear();
+        m_stamp = 0;
+    }
+
+private:
+    static XMFLOAT3 Lerp(const XMFLOAT3& a, const XMFLOAT3& b, float t) {
+        return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t };
+    }
+
+    // Angles in radians. Takes the short way round, so 350 -> 10 degrees
+    // goes through 0 and not backwards through 180.
+    static float LerpAngle(float a, float b, float t) {
+        float d = std::remainder(b - a, XM_2PI);
+        return a + d * t;
+    }
+
+private:
+    EcsVector<Transform> m_previous; // indexed by entity
+    EcsVector<uint32_t> m_stamps;    // == m_stamp if m_previous[e] is from the last Capture
+    uint32_t m_stamp = 0;
+};
@@ -1,49 +1,254 @@
 #pragma once
+#include <algorithm>
+#include <bit>
 #include <vector>
-#include <unordered_map>
+#include <memory>
 #include <cassert>
+#include "ComponentPool.h"
+#include "ComponentMask.h"
+#include "Math/SimdMath.h"
 
 using Entity = uint32_t;
 
+/*
+ * World
+ * Entities are plain IDs 1, 2, 3, ... handed out in order and never
+ * reused: destroying an entity removes its components, the ID stays
+ * taken. EntityCount() is therefore the highest ID so far. (CellStreamer
+ * is the exception: it reuses the ID blocks of the cells it unloaded.)
+ *
+ * None of this is thread-safe. Systems that want to create or destroy
+ * entities from jobs record that in an EntityCommands instead, which is
+ * played back here later (see EntityCommands.h).
+ *
+ * Every entity also has a signature: a ComponentMask with the bit of each
+ * component it has. HasComponent is one array read, and Query() finds the
+ * entities with some components and without others by sweeping the
+ * signatures with SIMD (Simd::MatchMasks) instead of probing pools:
+ *
+ *   world.Query(ComponentQuery().With<Static>().Without<Hidden>(), entities);
+ *
+ * Tags (empty structs, see IsTagComponent) exist only as that bit: no pool,
+ * no storage per entity. So adding and removing components has to go
+ * through World, never straight to a pool, or the signatures go stale.
+ */
 class World {
 public:
     Entity CreateEntity() {
-        return ++m_next;
+        ++m_next;
+        m_signatures.resize(size_t(m_next) + 1, 0);
+        return m_next;
+    }
+
+    // `count` new IDs in a row; returns the first.
+    Entity CreateEntities(uint32_t count) {
+        const Entity first = m_next + 1;
+        m_next += count;
+        m_signatures.resize(size_t(m_next) + 1, 0);
+        return first;
+    }
+
+    // Removes every component of `e`.
+    void DestroyEntity(Entity e) {
+        if (e >= m_signatures.size())
+            return;
+        // Only the pools its signature names, not every pool.
+        for (ComponentMask bits = m_signatures[e]; bits; bits &= bits - 1) {
+            const uint32_t id = uint32_t(std::countr_zero(bits));
+            if (id < m_pools.size() && m_pools[id])
+                m_pools[id]->Remove(e);
+        }
+        m_signatures[e] = 0;
     }
 
     template<typename T>
     void AddComponent(Entity e, T component = {}) {
-        GetStorage<T>()[e] = component;
+        if constexpr (!IsTagComponent<T>)
+            GetPool<T>().Add(e, component);
+        SetBits(e, BitOf<T>());
+    }
+
+    // Many at once (EntityCommands): data[i] is the component of entities[i].
+    template<typename T>
+    void AddComponents(const Entity* entities, const T* const* data, size_t count) {
+        if constexpr (!IsTagComponent<T>)
+            GetPool<T>().AddMany(entities, data, count);
+        const ComponentMask bit = BitOf<T>();
+        for (size_t i = 0; i < count; ++i)
+            SetBits(entities[i], bit);
+    }
+
+    // Replaces every component of type T (WorldSnapshot): entities[i] gets data[i].
+    template<typename T>
+    void AssignComponents(const Entity* entities, const T* data, size_t count) {
+        const ComponentMask bit = BitOf<T>();
+        for (ComponentMask& signature : m_signatures)
+            signature &= ~bit;
+        if constexpr (!IsTagComponent<T>)
+            GetPool<T>().Assign(entities, data, count, m_next);
+        for (size_t i = 0; i < count; ++i)
+            SetBits(entities[i], bit);
+    }
+
+    template<typename T>
+    bool RemoveComponent(Entity e) {
+        const ComponentMask bit = ComponentBit<T>();
+        if (!(Signature(e) & bit))
+            return false;
+        if constexpr (!IsTagComponent<T>)
+            FindPool<T>()->Remove(e);
+        m_signatures[e] &= ~bit;
+        return true;
     }
     Entity EntityCount() const {
         return m_next;
     }
     template<typename T>
     bool HasComponent(Entity e) const {
-        const auto& storage = GetStorage<T>();
-        return storage.find(e) != storage.end();
+        return (Signature(e) & ComponentBit<T>()) != 0;
+    }
+
+    // The bits of every component `e` has, tags included.
+    ComponentMask Signature(Entity e) const {
+        return e < m_signatures.size() ? m_signatures[e] : 0;
+    }
+    // Indexed by entity; [0] (InvalidEntity) is always 0.
+    const EcsVector<ComponentMask>& Signatures() const { return m_signatures; }
+
+    // Every entity that matches `query`, in ID order. Returns how many.
+    // `out` is cleared first; keep it around to not allocate every time.
+    size_t Query(const ComponentQuery& query, EcsVector<Entity>& out) const {
+        // In chunks through a buffer on the stack: `out` grows by the
+        // matches only, not by every entity there is.
+        constexpr size_t Chunk = 1024;
+        Entity found[Chunk];
+        out.clear();
+        for (size_t begin = 1; begin < m_signatures.size(); begin += Chunk) {
+            const size_t count = std::min(Chunk, m_signatures.size() - begin);
+            const size_t n = Simd::MatchMasks(m_signatures.data() + begin, count, query.all, query.none,
+                                              uint32_t(begin), found);
+            out.insert(out.end(), found, found + n);
+        }
+        return out.size();
     }
 
     template<typename T>
     T& GetComponent(Entity e) {
-        auto& storage = GetStorage<T>();
-        assert(storage.find(e) != storage.end());
-        return storage[e];
+        static_assert(!IsTagComponent<T>, "a tag has no data: use HasComponent");
+        T* c = GetPool<T>().TryGet(e);
+        assert(c);
+        return *c;
     }
 
     template<typename T>
     T* TryGetComponent(Entity e) {
-        auto& storage = GetStorage<T>();
-        auto it = storage.find(e);
-        return it != storage.end() ? &it->second : nullptr;
+        static_assert(!IsTagComponent<T>, "a tag has no data: use HasComponent");
+        return GetPool<T>().TryGet(e);
+    }
+
+    template<typename T>
+    const T* TryGetComponent(Entity e) const {
+        static_assert(!IsTagComponent<T>, "a tag has no data: use HasComponent");
+        const ComponentPool<T>* pool = FindPool<T>();
+        return pool ? pool->TryGet(e) : nullptr;
+    }
+
+    // Every component of type T, created on first use. Tags have none.
+    // Each World has its own pools, so two worlds never share components.
+    template<typename T>
+    ComponentPool<T>& GetPool() {
+        static_assert(!IsTagComponent<T>, "tags are only bits in the signature, they have no pool");
+        const uint32_t id = ComponentTypeId<T>();
+        if (id >= m_pools.size())
+            m_pools.resize(size_t(id) + 1);
+        if (!m_pools[id]) {
+            AllocScope scope(AllocTag::ECS);
+            m_pools[id] = std::make_unique<ComponentPool<T>>();
+        }
+        return static_cast<ComponentPool<T>&>(*m_pools[id]);
+    }
+
+    // nullptr if nothing of type T was ever added.
+    template<typename T>
+    const ComponentPool<T>* FindPool() const {
+        static_assert(!IsTagComponent<T>, "tags are only bits in the signature, they have no pool");
+        const uint32_t id = ComponentTypeId<T>();
+        if (id >= m_pools.size() || !m_pools[id])
+            return nullptr;
+        return static_cast<const ComponentPool<T>*>(m_pools[id].get());
+    }
+
+    template<typename T>
+    ComponentPool<T>* FindPool() {
+        return const_cast<ComponentPool<T>*>(static_cast<const World*>(this)->FindPool<T>());
+    }
+
+    // Pools by ComponentTypeId, for code that doesn't know the types
+    // (nullptr where nothing of that type was ever added).
+    uint32_t PoolSlots() const { return static_cast<uint32_t>(m_pools.size()); }
+    const IComponentPool* PoolAt(uint32_t typeId) const {
+        return typeId < m_pools.size() ? m_pools[typeId].get() : nullptr;
+    }
+
+    // Adds components [begin, end) of src's pool `typeId` here, entity e of
+    // `src` becoming e + offset. Used to merge a World built elsewhere.
+    void AppendFrom(const World& src, uint32_t typeId, size_t begin, size_t end, Entity offset) {
+        const IComponentPool* from = src.PoolAt(typeId);
+        if (!from || begin >= end)
+            return;
+        if (typeId >= m_pools.size())
+            m_pools.resize(size_t(typeId) + 1);
+        if (!m_pools[typeId]) {
+            AllocScope scope(AllocTag::ECS);
+            m_pools[typeId] = from->NewEmpty();
+        }
+        from->AppendTo(*m_pools[typeId], begin, end, offset);
+        const ComponentMask bit = ComponentBitOf(typeId);
+        for (size_t i = begin; i < end; ++i)
+            SetBits(from->EntityAt(i) + offset, bit);
+    }
+
+    // The tags of src's entities, entity e of `src` becoming e + offset.
+    // AppendFrom copies pools, and tags have none.
+    void AppendTagsFrom(const World& src, Entity offset) {
+        const ComponentMask tags = src.m_tagMask;
+        if (!tags)
+            return;
+        for (Entity e = 1; e < src.m_signatures.size(); ++e)
+            if (const ComponentMask bits = src.m_signatures[e] & tags)
+                SetBits(e + offset, bits);
+        m_tagMask |= tags;
+    }
+
+    // Drops every component and restarts entity IDs after `entityCount`.
+    // Used when a snapshot replaces the whole world.
+    void Reset(Entity entityCount = 0) {
+        for (auto& pool : m_pools)
+            if (pool) pool->Clear();
+        m_next = entityCount;
+        m_signatures.assign(size_t(entityCount) + 1, 0);
     }
 
 private:
+    void SetBits(Entity e, ComponentMask bits) {
+        // Entities whose IDs were handed out elsewhere (CellStreamer reuses
+        // blocks) may be past the end.
+        if (e >= m_signatures.size())
+            m_signatures.resize(size_t(e) + 1, 0);
+        m_signatures[e] |= bits;
+    }
+
     template<typename T>
-    std::unordered_map<Entity, T>& GetStorage() const {
-        static std::unordered_map<Entity, T> storage;
-        return storage;
+    ComponentMask BitOf() {
+        const ComponentMask bit = ComponentBit<T>();
+        if constexpr (IsTagComponent<T>)
+            m_tagMask |= bit;
+        return bit;
     }
 
+private:
+    EcsVector<std::unique_ptr<IComponentPool>> m_pools; // indexed by ComponentTypeId<T>()
+    EcsVector<ComponentMask> m_signatures;              // indexed by entity
+    ComponentMask m_tagMask = 0;                        // bits that are tags, see AppendTagsFrom
     Entity m_next = 0;
 };
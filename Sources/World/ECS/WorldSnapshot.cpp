@@ -0,0 +1,260 @@
+#include "WorldSnapshot.h"
+#include "Entity/Entity.h"
+#include "Renderer/MeshStorage.h"
+#include "Platform/MappedFile.h"
+#include "Timing/Clock.h"
+#include "Profiling/Profiler.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+    constexpr char SnapshotMagic[4] = { 'D', 'W', 'S', 'N' };
+    constexpr uint32_t SnapshotVersion = 1;
+
+    // Component arrays start on this boundary in the file. The mapping itself
+    // is page aligned, so the arrays can be read in place like normal arrays.
+    constexpr size_t SectionAlignment = 16;
+
+    struct SnapshotHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t entityCount;   // World::EntityCount(), IDs are 1..entityCount
+        uint32_t meshCount;     // entries in the mesh table
+        uint32_t typeCount;     // component sections
+        uint32_t reserved;
+    };
+
+    // Reads the file front to back and refuses to go past its end,
+    // so a truncated or corrupted file fails instead of crashing.
+    class Reader {
+    public:
+        Reader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+        bool Read(void* out, size_t bytes) {
+            if (!Skip(bytes)) return false;
+            std::memcpy(out, m_data + m_pos - bytes, bytes);
+            return true;
+        }
+
+        template<typename T>
+        bool Read(T& out) { return Read(&out, sizeof(T)); }
+
+        bool ReadString(std::string& out) {
+            uint32_t length = 0;
+            if (!Read(length) || length > m_size - m_pos) return false;
+            out.assign(reinterpret_cast<const char*>(m_data + m_pos), length);
+            m_pos += length;
+            return true;
+        }
+
+        bool Align(size_t alignment) {
+            size_t padding = (alignment - m_pos % alignment) % alignment;
+            return Skip(padding);
+        }
+
+        // Hands out a pointer into the file instead of copying.
+        const uint8_t* View(size_t bytes) {
+            if (!Skip(bytes)) return nullptr;
+            return m_data + m_pos - bytes;
+        }
+
+    private:
+        bool Skip(size_t bytes) {
+            if (bytes > m_size - m_pos) return false;
+            m_pos += bytes;
+            return true;
+        }
+
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_pos = 0;
+    };
+
+    void WriteString(std::ofstream& f, const std::string& s) {
+        uint32_t length = uint32_t(s.size());
+        f.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        f.write(s.data(), std::streamsize(s.size()));
+    }
+
+    void WritePadding(std::ofstream& f, size_t alignment) {
+        static const char zeros[SectionAlignment] = {};
+        size_t pos = size_t(f.tellp());
+        f.write(zeros, std::streamsize((alignment - pos % alignment) % alignment));
+    }
+}
+
+bool WorldSnapshot::Save(const World& world, const std::string& path)
+{
+    PROFILE_SCOPE("WorldSnapshot::Save");
+    double start = Clock::Now();
+    m_stats = {};
+    m_error.clear();
+
+    // Written next to the final name and renamed at the end,
+    // so an old snapshot is never replaced by half a new one.
+    const std::string temp = path + ".tmp";
+    {
+        std::ofstream f(temp, std::ios::binary | std::ios::trunc);
+        if (!f) return Fail("can't open " + temp);
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SnapshotMagic, sizeof(header.magic));
+        header.version = SnapshotVersion;
+        header.entityCount = world.EntityCount();
+        header.meshCount = m_meshes ? uint32_t(m_meshes->Count()) : 0;
+        header.typeCount = uint32_t(m_types.size());
+        f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (MeshHandle h = 1; h <= header.meshCount; ++h) {
+            f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            WriteString(f, m_meshes->GetName(h));
+        }
+
+        for (const ComponentType& type : m_types) {
+            const Entity* entities = nullptr;
+            const void* data = nullptr;
+            size_t count = 0;
+            type.save(world, m_tagged, entities, data, count);
+
+            uint32_t size = type.size;
+            uint32_t count32 = uint32_t(count);
+            WriteString(f, type.name);
+            f.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            f.write(reinterpret_cast<const char*>(&count32), sizeof(count32));
+            WritePadding(f, SectionAlignment);
+            if (count) {
+                f.write(reinterpret_cast<const char*>(entities), std::streamsize(count * sizeof(Entity)));
+                WritePadding(f, SectionAlignment);
+                f.write(static_cast<const char*>(data), std::streamsize(count * size));
+            }
+            m_stats.components += count;
+        }
+
+        m_stats.bytes = uint64_t(f.tellp());
+        if (!f) return Fail("write to " + temp + " failed");
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return Fail("can't replace " + path);
+    }
+
+    m_stats.entities = world.EntityCount();
+    m_stats.componentTypes = uint32_t(m_types.size());
+    m_stats.milliseconds = Clock::MillisecondsSince(start);
+    return true;
+}
+
+bool WorldSnapshot::Load(World& world, const std::string& path)
+{
+    PROFILE_SCOPE("WorldSnapshot::Load");
+    double start = Clock::Now();
+    m_stats = {};
+    m_error.clear();
+
+    MappedFile file;
+    if (!file.Open(path))
+        return Fail("can't open " + path);
+
+    Reader in(file.Data(), file.Size());
+
+    SnapshotHeader header{};
+    if (!in.Read(header) || std::memcmp(header.magic, SnapshotMagic, sizeof(header.magic)) != 0)
+        return Fail(path + " is not a world snapshot");
+    if (header.version != SnapshotVersion)
+        return Fail(path + " has snapshot version " + std::to_string(header.version) +
+                    ", expected " + std::to_string(SnapshotVersion));
+
+    // 1) Mesh table -> remap from saved handles to the handles of this run.
+    SnapshotContext ctx;
+    ctx.hasMeshTable = m_meshes != nullptr && header.meshCount > 0;
+    ctx.meshRemap.assign(size_t(header.meshCount) + 1, InvalidMesh);
+    for (uint32_t i = 0; i < header.meshCount; ++i) {
+        MeshHandle saved = InvalidMesh;
+        std::string name;
+        if (!in.Read(saved) || !in.ReadString(name))
+            return Fail(path + " is truncated (mesh table)");
+        if (!m_meshes || saved > header.meshCount)
+            continue;
+
+        // Unnamed meshes can only be trusted to keep their position.
+        if (name.empty())
+            ctx.meshRemap[saved] = saved <= m_meshes->Count() ? saved : InvalidMesh;
+        else
+            ctx.meshRemap[saved] = m_meshes->Find(name);
+        if (ctx.meshRemap[saved] == InvalidMesh)
+            ++m_stats.missingMeshes;
+    }
+
+    // 2) Check every section before touching the world, so a bad file
+    //    can't leave it half loaded.
+    struct Section {
+        const ComponentType* type;
+        const Entity* entities;
+        const void* data;
+        size_t count;
+    };
+    std::vector<Section> sections;
+    m_seen.assign(size_t(header.entityCount) + 1, 0);
+
+    for (uint32_t t = 0; t < header.typeCount; ++t) {
+        std::string name;
+        uint32_t size = 0, count = 0;
+        if (!in.ReadString(name) || !in.Read(size) || !in.Read(count) || !in.Align(SectionAlignment))
+            return Fail(path + " is truncated (component header)");
+
+        const Entity* entities = nullptr;
+        const uint8_t* data = nullptr;
+        if (count) {
+            entities = reinterpret_cast<const Entity*>(in.View(size_t(count) * sizeof(Entity)));
+            data = in.Align(SectionAlignment) ? in.View(size_t(count) * size) : nullptr;
+        }
+        if (count && (!entities || !data))
+            return Fail(path + " is truncated (component '" + name + "')");
+
+        const ComponentType* type = nullptr;
+        for (const ComponentType& c : m_types)
+            if (c.name == name) type = &c;
+
+        if (!type) {
+            ++m_stats.skippedTypes;
+            continue;
+        }
+        if (type->size != size)
+            return Fail("component '" + name + "' is " + std::to_string(size) + " bytes in " + path +
+                        " but " + std::to_string(type->size) + " bytes now");
+
+        // Entities are stored as they are, so they can't be trusted blindly:
+        // each one in range, and at most once per section.
+        const uint32_t stamp = t + 1;
+        for (uint32_t i = 0; i < count; ++i) {
+            Entity e = entities[i];
+            if (e == InvalidEntity || e > header.entityCount)
+                return Fail("component '" + name + "' references entity " + std::to_string(e) +
+                            " outside of 1.." + std::to_string(header.entityCount));
+            if (m_seen[e] == stamp)
+                return Fail("component '" + name + "' lists entity " + std::to_string(e) + " twice");
+            m_seen[e] = stamp;
+        }
+
+        sections.push_back({ type, entities, data, count });
+    }
+
+    // 3) Bulk copy. Types that are registered but absent from the file end up empty.
+    world.Reset(header.entityCount);
+    for (const Section& s : sections) {
+        s.type->load(world, s.entities, s.data, s.count, ctx);
+        m_stats.components += s.count;
+    }
+
+    m_stats.entities = header.entityCount;
+    m_stats.componentTypes = uint32_t(sections.size());
+    m_stats.bytes = file.Size();
+    m_stats.milliseconds = Clock::MillisecondsSince(start);
+    return true;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "World.h"
+#include "Component/Mesh.h"
+
+class MeshStorage;
+
+/*
+ * WorldSnapshot
+ * Saves a whole World to one binary file and loads it back.
+ *
+ * Scenes are normally built in code by addInitFunc callbacks. With a
+ * snapshot the finished world can be written once and then loaded on
+ * the next start, which is mostly a few big memcpys:
+ *
+ *   header | mesh table | for every component type: entities[] + data[]
+ *
+ * Component types are stored by the name they were registered with, not by
+ * their ComponentTypeId (that number depends on the order of first use and
+ * can differ between runs). Types in the file that are not registered are
+ * skipped. A registered type whose size changed makes the load fail, because
+ * the bytes would no longer mean the same thing.
+ *
+ * MeshHandles are just positions in the MeshStorage and can change when
+ * meshes are added in a different order. So the file also stores the name
+ * of every mesh (MeshStorage::Add(mesh, name)), and on load every handle is
+ * mapped to the mesh with the same name. See RemapMeshHandles below.
+ *
+ * Only trivially copyable components can be registered (no std::string etc.),
+ * since they are written and read as raw bytes. Tags are stored as their
+ * entities only, with a size of 0.
+ *
+ * The entity IDs in a file are checked before anything is loaded: an ID
+ * of 0 or above the saved entity count, or one listed twice for the same
+ * component, fails the load (a pool can't hold an entity twice).
+ */
+
+// What a component type may need to fix up after its bytes were copied in.
+struct SnapshotContext {
+    std::vector<MeshHandle> meshRemap; // [handle in the file] -> handle now
+    bool hasMeshTable = false;
+
+    MeshHandle RemapMesh(MeshHandle saved) const {
+        if (!hasMeshTable) return saved;
+        return saved < meshRemap.size() ? meshRemap[saved] : InvalidMesh;
+    }
+};
+
+struct SnapshotStats {
+    uint32_t entities = 0;
+    uint32_t componentTypes = 0;  // loaded or saved
+    uint32_t skippedTypes = 0;    // in the file but not registered
+    uint32_t missingMeshes = 0;   // saved mesh names that are not in the MeshStorage
+    uint64_t components = 0;
+    uint64_t bytes = 0;           // file size
+    double milliseconds = 0.0;
+};
+
+class WorldSnapshot {
+public:
+    template<typename T>
+    using AfterLoadFn = void (*)(T* items, size_t count, const SnapshotContext& ctx);
+
+    // `name` is what identifies the type inside the file, keep it stable.
+    template<typename T>
+    void RegisterComponent(const std::string& name, AfterLoadFn<T> afterLoad = nullptr) {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot components are copied as raw bytes");
+
+        ComponentType type;
+        type.name = name;
+        type.size = IsTagComponent<T> ? 0 : sizeof(T);
+        type.save = [](const World& world, EcsVector<Entity>& tagged,
+                       const Entity*& entities, const void*& data, size_t& count) {
+            entities = nullptr; data = nullptr; count = 0;
+            if constexpr (IsTagComponent<T>) {
+                // No pool to point at: the tagged entities, gathered into `tagged`.
+                count = world.Query(ComponentQuery().With<T>(), tagged);
+                entities = tagged.data();
+                data = tagged.data(); // 0 bytes each
+            }
+            else if (const ComponentPool<T>* pool = world.FindPool<T>()) {
+                entities = pool->Entities().data();
+                data = pool->Data().data();
+                count = pool->Size();
+            }
+        };
+        type.load = [afterLoad](World& world, const Entity* entities, const void* data, size_t count,
+                                const SnapshotContext& ctx) {
+            world.AssignComponents<T>(entities, static_cast<const T*>(data), count);
+            if constexpr (!IsTagComponent<T>) {
+                if (afterLoad && count)
+                    afterLoad(world.GetPool<T>().Data().data(), count, ctx);
+            }
+        };
+        m_types.push_back(std::move(type));
+    }
+
+    // Needed to save mesh names and to remap MeshHandles on load.
+    void SetMeshStorage(const MeshStorage* meshes) { m_meshes = meshes; }
+
+    bool Save(const World& world, const std::string& path);
+
+    // Replaces everything in `world`. On failure `world` is left untouched.
+    bool Load(World& world, const std::string& path);
+
+    const SnapshotStats& GetStats() const { return m_stats; }
+    const std::string& GetError() const { return m_error; }
+
+private:
+    struct ComponentType {
+        std::string name;
+        uint32_t size = 0;
+        std::function<void(const World&, EcsVector<Entity>&, const Entity*&, const void*&, size_t&)> save;
+        std::function<void(World&, const Entity*, const void*, size_t, const SnapshotContext&)> load;
+    };
+
+    bool Fail(const std::string& error) {
+        m_error = error;
+        return false;
+    }
+
+private:
+    std::vector<ComponentType> m_types;
+    const MeshStorage* m_meshes = nullptr; // injected, optional
+    EcsVector<Entity> m_tagged;            // Save: the entities of one tag
+    std::vector<uint32_t> m_seen;          // Load: per entity, the last section it was in
+    SnapshotStats m_stats;
+    std::string m_error;
+};
+
+// AfterLoad for Mesh: points every handle at the mesh with the same name.
+inline void RemapMeshHandles(Mesh* items, size_t count, const SnapshotContext& ctx) {
+    for (size_t i = 0; i < count; ++i)
+        items[i].handle = ctx.RemapMesh(items[i].handle);
+}
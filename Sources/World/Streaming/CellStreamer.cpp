@@ -0,0 +1,394 @@
+#include "CellStreamer.h"
+#include "Threading/JobSystem.h"
+#include "Timing/Clock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace DirectX;
+
+CellStreamer::~CellStreamer()
+{
+    for (Cell& cell : m_cells)
+        cell.cancel.store(true, std::memory_order_relaxed);
+    // The jobs hold pointers into m_cells.
+    while (m_inFlight.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+}
+
+CellCoord CellStreamer::CellAt(const XMFLOAT3& position) const
+{
+    return CellCoord{ int32_t(std::floor(position.x / m_settings.cellSize)),
+                      int32_t(std::floor(position.z / m_settings.cellSize)) };
+}
+
+XMFLOAT3 CellStreamer::CellOrigin(CellCoord cell) const
+{
+    return XMFLOAT3(float(cell.x) * m_settings.cellSize, 0.0f, float(cell.z) * m_settings.cellSize);
+}
+
+float CellStreamer::DistanceSq(CellCoord cell, const XMFLOAT3& camera) const
+{
+    const float dx = (float(cell.x) + 0.5f) * m_settings.cellSize - camera.x;
+    const float dz = (float(cell.z) + 0.5f) * m_settings.cellSize - camera.z;
+    return dx * dx + dz * dz;
+}
+
+bool CellStreamer::IsResident(CellCoord cell) const
+{
+    Entity first;
+    uint32_t count;
+    return GetCellEntities(cell, first, count);
+}
+
+bool CellStreamer::GetCellEntities(CellCoord cell, Entity& first, uint32_t& count) const
+{
+    auto it = m_lookup.find(Key(cell));
+    if (it == m_lookup.end() || m_cells[it->second].state != CellState::Resident)
+        return false;
+    first = m_cells[it->second].first;
+    count = m_cells[it->second].count;
+    return true;
+}
+
+void CellStreamer::Update(World& world, const XMFLOAT3& camera)
+{
+    const Clock::Ticks start = Clock::NowTicks();
+
+    // Blocks unloaded in the last Update may be used from now on.
+    for (const Block& freed : m_freedThisUpdate) {
+        auto it = std::lower_bound(m_freeBlocks.begin(), m_freeBlocks.end(), freed.first,
+            [](const Block& b, Entity first) { return b.first < first; });
+        it = m_freeBlocks.insert(it, freed);
+        if (it + 1 != m_freeBlocks.end() && it->first + it->count == (it + 1)->first) {
+            it->count += (it + 1)->count;
+            m_freeBlocks.erase(it + 1);
+        }
+        if (it != m_freeBlocks.begin() && (it - 1)->first + (it - 1)->count == it->first) {
+            (it - 1)->count += it->count;
+            m_freeBlocks.erase(it);
+        }
+    }
+    m_freedThisUpdate.clear();
+
+    m_stats.mergedEntities = m_stats.mergedComponents = m_stats.unloadedEntities = 0;
+    m_stats.mergedBytes = 0;
+    m_stats.mergeMs = m_stats.unloadMs = 0.0;
+
+    ReleaseFarCells(camera);
+    FinishBuilds();
+    RequestCells(camera);
+    FinishBuilds(); // again for builds that ran inline (no JobSystem)
+    Merge(world);
+    Unload(world);
+    CountStates();
+
+    m_stats.updateMs = Clock::ToMilliseconds(Clock::NowTicks() - start);
+    m_stats.maxUpdateMs = std::max(m_stats.maxUpdateMs, m_stats.updateMs);
+    if (m_stats.updateMs > m_settings.hitchMs)
+        ++m_stats.hitches;
+}
+
+void CellStreamer::ReleaseFarCells(const XMFLOAT3& camera)
+{
+    const float unloadSq = m_settings.unloadRadius * m_settings.unloadRadius;
+    for (Cell& cell : m_cells) {
+        if (cell.state == CellState::Free || cell.state == CellState::Unloading || cell.cancelled)
+            continue;
+        if (DistanceSq(cell.coord, camera) > unloadSq)
+            StartUnload(cell);
+    }
+}
+
+void CellStreamer::RequestCells(const XMFLOAT3& camera)
+{
+    if (m_stats.building >= m_settings.maxBuilding || !m_builder)
+        return;
+
+    // Every cell whose center is within loadRadius and that isn't wanted yet.
+    const float radius = m_settings.loadRadius;
+    const float loadSq = radius * radius;
+    const CellCoord lo = CellAt(XMFLOAT3(camera.x - radius, 0.0f, camera.z - radius));
+    const CellCoord hi = CellAt(XMFLOAT3(camera.x + radius, 0.0f, camera.z + radius));
+    m_candidates.clear();
+    for (int32_t z = lo.z; z <= hi.z; ++z)
+        for (int32_t x = lo.x; x <= hi.x; ++x) {
+            const CellCoord c{ x, z };
+            const float d = DistanceSq(c, camera);
+            if (d <= loadSq && m_lookup.find(Key(c)) == m_lookup.end())
+                m_candidates.push_back({ c, d });
+        }
+
+    // Nearest first; ties by coordinate, so the order doesn't depend on anything else.
+    std::sort(m_candidates.begin(), m_candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.distSq != b.distSq) return a.distSq < b.distSq;
+        return a.coord.z != b.coord.z ? a.coord.z < b.coord.z : a.coord.x < b.coord.x;
+    });
+
+    for (const Candidate& candidate : m_candidates) {
+        if (m_stats.building >= m_settings.maxBuilding)
+            break;
+        uint32_t index;
+        if (!m_freeCells.empty()) {
+            index = m_freeCells.back();
+            m_freeCells.pop_back();
+        } else {
+            index = static_cast<uint32_t>(m_cells.size());
+            m_cells.emplace_back().index = index;
+        }
+        Cell& cell = m_cells[index];
+        cell.coord = candidate.coord;
+        cell.order = m_nextOrder++;
+        m_lookup[Key(candidate.coord)] = index;
+        StartBuild(cell);
+    }
+}
+
+std::unique_ptr<World> CellStreamer::TakeStaging()
+{
+    std::unique_ptr<World> staging;
+    if (!m_freeStaging.empty()) {
+        staging = std::move(m_freeStaging.back());
+        m_freeStaging.pop_back();
+        staging->Reset(); // keeps the pools and their memory
+    } else {
+        AllocScope scope(AllocTag::ECS);
+        staging = std::make_unique<World>();
+    }
+    return staging;
+}
+
+void CellStreamer::StartBuild(Cell& cell)
+{
+    cell.state = CellState::Building;
+    cell.cancelled = false;
+    cell.cancel.store(false, std::memory_order_relaxed);
+    cell.built.store(false, std::memory_order_relaxed);
+    cell.staging = TakeStaging();
+    ++m_stats.building;
+
+    if (!m_jobs) {
+        m_builder(cell.coord, *cell.staging);
+        cell.built.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    m_inFlight.fetch_add(1, std::memory_order_relaxed);
+    Cell* job = &cell;
+    m_jobs->Submit([this, job] {
+        if (!job->cancel.load(std::memory_order_relaxed)) {
+            PROFILE_SCOPE("CellStreamer::Build");
+            AllocScope scope(AllocTag::ECS);
+            m_builder(job->coord, *job->staging);
+        }
+        job->built.store(true, std::memory_order_release);
+        m_inFlight.fetch_sub(1, std::memory_order_release);
+    });
+}
+
+void CellStreamer::FinishBuilds()
+{
+    for (Cell& cell : m_cells) {
+        if (cell.state != CellState::Building || !cell.built.load(std::memory_order_acquire))
+            continue;
+        --m_stats.building;
+        if (cell.cancelled) {
+            ++m_stats.buildsCancelled;
+            FreeCell(cell);
+            continue;
+        }
+
+        const World& staging = *cell.staging;
+        cell.count = staging.EntityCount();
+        cell.bytes = 0;
+        for (uint32_t t = 0; t < staging.PoolSlots(); ++t)
+            if (const IComponentPool* pool = staging.PoolAt(t))
+                cell.bytes += pool->Size() * pool->ComponentSize();
+        cell.first = 0;
+        cell.mergeType = 0;
+        cell.mergeIndex = 0;
+        cell.state = CellState::Merging;
+    }
+}
+
+void CellStreamer::Merge(World& world)
+{
+    const Clock::Ticks start = Clock::NowTicks();
+    const uint64_t byteBudget = m_settings.mergeBytesPerFrame;
+    const double msBudget = m_settings.mergeMsPerFrame;
+    const uint32_t chunk = std::max(m_settings.componentsPerChunk, 1u);
+    bool mergedAny = false;
+
+    for (;;) {
+        // Cells are merged one at a time, in the order they were asked for
+        // (nearest first), whatever order their builds finished in.
+        Cell* cell = nullptr;
+        for (Cell& c : m_cells)
+            if (c.state == CellState::Merging && (!cell || c.order < cell->order))
+                cell = &c;
+        if (!cell)
+            break;
+
+        if (cell->first == 0 && cell->count > 0)
+            cell->first = AllocateBlock(world, cell->count);
+        const World& src = *cell->staging;
+        const Entity offset = cell->first - 1;
+
+        while (cell->mergeType < src.PoolSlots()) {
+            const IComponentPool* pool = src.PoolAt(cell->mergeType);
+            const size_t size = pool ? pool->Size() : 0;
+            if (cell->mergeIndex >= size) {
+                ++cell->mergeType;
+                cell->mergeIndex = 0;
+                continue;
+            }
+
+            // Out of budget? Only once something was merged, so every
+            // Update makes progress even with a tiny budget.
+            const size_t componentSize = pool->ComponentSize();
+            size_t count = std::min<size_t>(chunk, size - cell->mergeIndex);
+            if (mergedAny) {
+                if (msBudget > 0.0 && Clock::ToMilliseconds(Clock::NowTicks() - start) >= msBudget)
+                    goto outOfBudget;
+                if (byteBudget > 0) {
+                    const uint64_t left = byteBudget > m_stats.mergedBytes ? byteBudget - m_stats.mergedBytes : 0;
+                    if (left < componentSize)
+                        goto outOfBudget;
+                    count = std::min<size_t>(count, size_t(left / componentSize));
+                }
+            } else if (byteBudget > 0) {
+                count = std::min<size_t>(count, std::max<size_t>(size_t(byteBudget / componentSize), 1));
+            }
+
+            world.AppendFrom(src, cell->mergeType, cell->mergeIndex, cell->mergeIndex + count, offset);
+            cell->mergeIndex += count;
+            m_stats.mergedComponents += static_cast<uint32_t>(count);
+            m_stats.mergedBytes += count * componentSize;
+            mergedAny = true;
+        }
+
+        // All pools copied, tags (bits only, no pool) last: the cell is live.
+        world.AppendTagsFrom(src, offset);
+        cell->state = CellState::Resident;
+        m_freeStaging.push_back(std::move(cell->staging));
+        m_stats.mergedEntities += cell->count;
+        m_stats.residentEntities += cell->count;
+        m_stats.residentBytes += cell->bytes;
+        ++m_stats.cellsLoaded;
+    }
+outOfBudget:
+    m_stats.mergeMs = Clock::ToMilliseconds(Clock::NowTicks() - start);
+}
+
+void CellStreamer::StartUnload(Cell& cell)
+{
+    m_lookup.erase(Key(cell.coord));
+    switch (cell.state) {
+    case CellState::Building:
+        // The job still uses the cell; FinishBuilds frees it when it's done.
+        cell.cancelled = true;
+        cell.cancel.store(true, std::memory_order_relaxed);
+        return;
+    case CellState::Merging:
+        ++m_stats.buildsCancelled;
+        m_freeStaging.push_back(std::move(cell.staging));
+        if (cell.first == 0) { // nothing merged yet
+            FreeCell(cell);
+            return;
+        }
+        break;
+    case CellState::Resident:
+        m_stats.residentEntities -= cell.count;
+        m_stats.residentBytes -= cell.bytes;
+        break;
+    default:
+        return;
+    }
+    cell.state = CellState::Unloading;
+    cell.unloadNext = cell.first;
+}
+
+void CellStreamer::Unload(World& world)
+{
+    const Clock::Ticks start = Clock::NowTicks();
+    const uint32_t entityBudget = m_settings.unloadEntitiesPerFrame;
+    const double msBudget = m_settings.unloadMsPerFrame;
+    uint32_t unloaded = 0;
+
+    for (Cell& cell : m_cells) {
+        if (cell.state != CellState::Unloading)
+            continue;
+        const Entity end = cell.first + cell.count;
+        while (cell.unloadNext < end) {
+            if (unloaded > 0) {
+                if (entityBudget > 0 && unloaded >= entityBudget)
+                    goto outOfBudget;
+                // The clock isn't free either: look at it every 64 entities.
+                if (msBudget > 0.0 && unloaded % 64 == 0 && Clock::ToMilliseconds(Clock::NowTicks() - start) >= msBudget)
+                    goto outOfBudget;
+            }
+            world.DestroyEntity(cell.unloadNext++);
+            ++unloaded;
+        }
+        FreeBlock(cell.first, cell.count);
+        FreeCell(cell);
+        ++m_stats.cellsUnloaded;
+    }
+outOfBudget:
+    m_stats.unloadedEntities = unloaded;
+    m_stats.unloadMs = Clock::ToMilliseconds(Clock::NowTicks() - start);
+}
+
+void CellStreamer::FreeCell(Cell& cell)
+{
+    if (cell.staging)
+        m_freeStaging.push_back(std::move(cell.staging));
+    cell.state = CellState::Free;
+    cell.cancelled = false;
+    cell.first = 0;
+    cell.count = 0;
+    cell.bytes = 0;
+    m_freeCells.push_back(cell.index);
+}
+
+Entity CellStreamer::AllocateBlock(World& world, uint32_t count)
+{
+    // First fit among the unloaded blocks, else new IDs.
+    for (size_t i = 0; i < m_freeBlocks.size(); ++i) {
+        Block& b = m_freeBlocks[i];
+        if (b.count < count)
+            continue;
+        const Entity first = b.first;
+        b.first += count;
+        b.count -= count;
+        if (b.count == 0)
+            m_freeBlocks.erase(m_freeBlocks.begin() + i);
+        return first;
+    }
+    const Entity first = world.CreateEntities(count);
+    m_stats.idsUsed = std::max(m_stats.idsUsed, first + count - 1);
+    return first;
+}
+
+void CellStreamer::FreeBlock(Entity first, uint32_t count)
+{
+    if (count > 0)
+        m_freedThisUpdate.push_back({ first, count });
+}
+
+void CellStreamer::CountStates()
+{
+    m_stats.resident = m_stats.waiting = m_stats.merging = m_stats.unloading = 0;
+    for (const Cell& cell : m_cells) {
+        switch (cell.state) {
+        case CellState::Resident: ++m_stats.resident; break;
+        case CellState::Unloading: ++m_stats.unloading; break;
+        case CellState::Merging:
+            if (cell.first == 0 && cell.mergeIndex == 0 && cell.mergeType == 0) ++m_stats.waiting;
+            else ++m_stats.merging;
+            break;
+        default: break;
+        }
+    }
+}
@@ -0,0 +1,217 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <DirectXMath.h>
+#include "World/ECS/World.h"
+
+class JobSystem;
+
+// A cell of the streaming grid, on the XZ plane (height doesn't count).
+struct CellCoord {
+    int32_t x = 0;
+    int32_t z = 0;
+
+    bool operator==(const CellCoord& o) const { return x == o.x && z == o.z; }
+    bool operator!=(const CellCoord& o) const { return !(*this == o); }
+};
+
+// Fills `out` (an empty World) with the entities of one cell: create them
+// with out.CreateEntity() and add components as usual. Runs on a worker,
+// so it must not touch the live World or anything else that isn't
+// thread-safe. Components are copied around as they are, so they must be
+// trivially copyable (or at least copyable without surprises).
+using CellBuilder = std::function<void(CellCoord cell, World& out)>;
+
+struct CellStreamerStats {
+    // Cells by state, after the last Update
+    uint32_t resident = 0;   // fully in the live World
+    uint32_t building = 0;   // queued or running on a worker
+    uint32_t waiting = 0;    // built, not merged yet
+    uint32_t merging = 0;    // partly merged
+    uint32_t unloading = 0;  // partly destroyed
+
+    // The last Update
+    uint32_t mergedEntities = 0;
+    uint32_t mergedComponents = 0;
+    uint64_t mergedBytes = 0;
+    uint32_t unloadedEntities = 0;
+    double mergeMs = 0.0;
+    double unloadMs = 0.0;
+    double updateMs = 0.0;   // all of Update, what streaming cost the main thread
+
+    // Since the start
+    uint64_t cellsLoaded = 0;     // merged completely
+    uint64_t cellsUnloaded = 0;
+    uint64_t buildsCancelled = 0; // no longer wanted before they were merged
+    double maxUpdateMs = 0.0;
+    uint64_t hitches = 0;         // Updates that took longer than Settings::hitchMs
+
+    uint64_t residentBytes = 0;   // components of resident cells
+    uint32_t residentEntities = 0;
+    Entity idsUsed = 0;           // highest entity ID the streamer ever handed out
+};
+
+/*
+ * CellStreamer
+ * Keeps the part of a large world that is near the camera in the live
+ * World, and drops the rest.
+ *
+ * The world is cut into square cells of `cellSize` on the XZ plane. Every
+ * Update, cells whose center is within `loadRadius` of the camera are
+ * wanted, and resident cells farther than `unloadRadius` are dropped.
+ * unloadRadius is larger than loadRadius, so walking back and forth over
+ * a cell border doesn't load and unload the same cells every frame.
+ *
+ * Loading a cell
+ *   1. Build: the CellBuilder runs on a worker and fills a World of its
+ *      own (a "staging" World, reused between cells). Nearest cells are
+ *      started first, at most `maxBuilding` at a time.
+ *   2. Merge: on the main thread, in Update, the staging World's pools are
+ *      appended to the live World's pools, one chunk of components after
+ *      another, until `mergeBytesPerFrame` or `mergeMsPerFrame` are used
+ *      up. A big cell therefore takes a few frames instead of one long
+ *      hitch, and while it does, its entities can have some of their
+ *      components but not all yet (pools are merged one after another).
+ *
+ *   The cell's entities get a block of IDs in a row: staging entity e
+ *   becomes first + e - 1. So merging is a plain copy with an offset, and
+ *   unloading knows exactly which entities were the cell's.
+ *
+ * Unloading a cell
+ *   Its entities are destroyed, `unloadEntitiesPerFrame` (and at most
+ *   `unloadMsPerFrame`) per Update. Then its ID block can be used by the
+ *   next cell, from the next Update on (not the same one, so systems that
+ *   compare with last tick, like TransformHistory, never see a new entity
+ *   under an old ID within one tick). World IDs otherwise only grow; reusing
+ *   the blocks keeps IDs, and so the pools' sparse arrays, bounded by what
+ *   is resident at most, not by how far the camera traveled.
+ *
+ *   So: don't keep the Entity of a streamed entity in another cell or a
+ *   system across the unload of its cell.
+ *
+ * A cell that is no longer wanted while it is still building is cancelled:
+ * its build is skipped if it hasn't started, or its result thrown away.
+ * Without a JobSystem, builds run in Update on the calling thread.
+ *
+ * Update must be called where nobody else uses the World (Core does it
+ * at the start of the tick, see Core::enableStreaming).
+ */
+class CellStreamer {
+public:
+    struct Settings {
+        float cellSize = 64.0f;
+        float loadRadius = 192.0f;
+        float unloadRadius = 256.0f;   // > loadRadius
+        uint32_t maxBuilding = 4;      // builds queued or running at once
+
+        // Per Update. 0 = no limit. At least one chunk is always merged and
+        // at least one entity unloaded, so streaming never stalls.
+        uint64_t mergeBytesPerFrame = 1u << 20;
+        double mergeMsPerFrame = 1.0;
+        uint32_t unloadEntitiesPerFrame = 4096;
+        double unloadMsPerFrame = 1.0;
+        uint32_t componentsPerChunk = 1024; // budgets are checked after every chunk
+
+        double hitchMs = 4.0; // an Update longer than this counts as a hitch
+    };
+
+    CellStreamer() = default;
+    ~CellStreamer(); // waits for builds still running
+    CellStreamer(const CellStreamer&) = delete;
+    CellStreamer& operator=(const CellStreamer&) = delete;
+
+    // Set both before the first Update.
+    void SetBuilder(CellBuilder builder) { m_builder = std::move(builder); }
+    void SetSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& GetSettings() const { return m_settings; }
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+
+    void Update(World& world, const DirectX::XMFLOAT3& camera);
+
+    CellCoord CellAt(const DirectX::XMFLOAT3& position) const;
+    // The corner of the cell with the smallest x and z (y = 0).
+    DirectX::XMFLOAT3 CellOrigin(CellCoord cell) const;
+
+    // The cell is completely in the live World (not building, merging or
+    // unloading); if so, its entities are first .. first + count - 1.
+    bool IsResident(CellCoord cell) const;
+    bool GetCellEntities(CellCoord cell, Entity& first, uint32_t& count) const;
+
+    template<typename Fn> // fn(CellCoord, Entity first, uint32_t count)
+    void ForEachResident(Fn&& fn) const {
+        for (const Cell& c : m_cells)
+            if (c.state == CellState::Resident)
+                fn(c.coord, c.first, c.count);
+    }
+
+    const CellStreamerStats& GetStats() const { return m_stats; }
+
+private:
+    enum class CellState : uint8_t { Free, Building, Merging, Resident, Unloading };
+
+    struct Cell {
+        uint32_t index = 0;     // in m_cells
+        CellCoord coord;
+        CellState state = CellState::Free;
+        bool cancelled = false;          // main thread: no longer wanted while building
+        std::atomic<bool> cancel{ false };  // read by the build job
+        std::atomic<bool> built{ false };   // set by the build job when done
+        std::unique_ptr<World> staging;
+
+        Entity first = 0;       // ID block in the live World, 0 = none yet
+        uint32_t count = 0;
+        uint64_t bytes = 0;     // of all components
+        uint32_t mergeType = 0; // merge cursor: pool (ComponentTypeId) ...
+        size_t mergeIndex = 0;  // ... and component within it
+        Entity unloadNext = 0;  // unload cursor
+        uint64_t order = 0;     // when it was asked for, merges go in this order
+    };
+
+    struct Block {
+        Entity first;
+        uint32_t count;
+    };
+
+    static uint64_t Key(CellCoord c) {
+        return (uint64_t(uint32_t(c.x)) << 32) | uint32_t(c.z);
+    }
+    float DistanceSq(CellCoord cell, const DirectX::XMFLOAT3& camera) const;
+
+    void RequestCells(const DirectX::XMFLOAT3& camera);
+    void ReleaseFarCells(const DirectX::XMFLOAT3& camera);
+    void StartBuild(Cell& cell);
+    void FinishBuilds();
+    void Merge(World& world);
+    void Unload(World& world);
+    void StartUnload(Cell& cell);
+    void FreeCell(Cell& cell);
+    void CountStates();
+
+    Entity AllocateBlock(World& world, uint32_t count);
+    void FreeBlock(Entity first, uint32_t count);
+    std::unique_ptr<World> TakeStaging();
+
+private:
+    Settings m_settings;
+    CellBuilder m_builder;
+    JobSystem* m_jobs = nullptr;
+
+    std::deque<Cell> m_cells;       // never shrinks, so build jobs can hold a Cell*
+    EcsVector<uint32_t> m_freeCells;
+    std::unordered_map<uint64_t, uint32_t> m_lookup; // Key(coord) -> index in m_cells, wanted cells only
+    std::atomic<uint32_t> m_inFlight{ 0 };
+    uint64_t m_nextOrder = 0;
+
+    EcsVector<std::unique_ptr<World>> m_freeStaging;
+    EcsVector<Block> m_freeBlocks;  // sorted by first, neighbours merged
+    EcsVector<Block> m_freedThisUpdate;
+
+    struct Candidate { CellCoord coord; float distSq; };
+    EcsVector<Candidate> m_candidates; // scratch
+
+    CellStreamerStats m_stats;
+};
@@ -6,15 +6,50 @@
 #include <World/ECS/Component/Transform.h>
 
 #include <Math/Time.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 
 // renderer-side
 #include <Renderer/MeshStorage.h>
 #include <Renderer/StaticMeshes.h>
 
+#include <Bench/Benchmarks.h>
+#include <Animation/TestRig.h>
+#include <World/ECS/Component/Animator.h>
+
 Entity g_cube = InvalidEntity;
 Entity g_cube2 = InvalidEntity;
 
 MeshHandle g_cubeMesh = InvalidMesh;
+
+// A coroutine (see Tasks/Task.h): waits, builds a mesh off the main thread,
+// then circles its cube every frame, all without a state machine.
+Task<> orbitingCube(Core& core)
+{
+    TaskScheduler& tasks = core.getTasks();
+    co_await tasks.Delay(2.0);
+
+    auto cube = tasks.LoadAsync<MeshData>([] { return CreateTestCube(); });
+    MeshData& data = co_await tasks.AssetLoaded(*cube); // back on the main thread
+    if (cube->Failed()) co_return;
+
+    World* world = core.getWorld();
+    Entity e = world->CreateEntity();
+    world->AddComponent<Transform>(e);
+    world->AddComponent<Mesh>(e);
+    world->GetComponent<Mesh>(e).handle = core.getMeshStorage()->Add(data, "OrbitCube");
+
+    for (;;) {
+        if (auto* t = world->TryGetComponent<Transform>(e)) {
+            float a = float(Time::time);
+            t->position = { std::cos(a) * 2.5f, 1.5f, std::sin(a) * 2.5f };
+            t->scale = { 0.5f, 0.5f, 0.5f };
+        }
+        co_await tasks.NextFrame();
+    }
+}
+
 void setupScene(Core& core)
 {
     World* world = core.getWorld();
@@ -22,7 +57,7 @@ void setupScene(Core& core)
 
 
     MeshData cube = CreateTestCube();
-    g_cubeMesh = core.getMeshStorage()->Add(cube); 
+    g_cubeMesh = core.getMeshStorage()->Add(cube, "TestCube");
 
    
     g_cube = world->CreateEntity();
@@ -49,6 +84,34 @@ void setupScene(Core& core)
     t2.scale = { 1.0f, 1.0f, 1.0f };
 
     world->GetComponent<Mesh>(g_cube2).handle = g_cubeMesh;
+
+    // A skinned tube swaying behind the cubes, see Animation/AnimationSystem.h
+    const Skeleton chain = CreateTestChain(8, 3.0f);
+    Animator animator;
+    animator.skeleton = core.getAnimations().AddSkeleton(chain, "TestChain");
+    animator.clip = core.getAnimations().AddClip(CreateTestSway(chain, { 0.0f, 0.0f, 1.0f }, 0.3f, 2.0f), "TestSway");
+    Entity tube = world->CreateEntity();
+    Transform tubeTransform;
+    tubeTransform.position = { -2.0f, -1.5f, 2.0f };
+    world->AddComponent<Transform>(tube, tubeTransform);
+    world->AddComponent<Mesh>(tube, Mesh{ core.getMeshStorage()->Add(CreateTestTube(12, 24, 3.0f, 0.25f, 8), "TestTube") });
+    world->AddComponent<Animator>(tube, animator);
+
+    // A fountain of small cubes next to the tube, see Particles/ParticleSystem.h
+    ParticleEmitterDesc fountain;
+    fountain.position = { 2.5f, -1.5f, 2.0f };
+    fountain.velocity = { 0.0f, 5.0f, 0.0f };
+    fountain.velocitySpread = 1.0f;
+    fountain.rate = 400.0f;
+    fountain.lifetimeMin = 1.0f;
+    fountain.lifetimeMax = 1.5f;
+    fountain.startSize = 0.05f;
+    fountain.endSize = 0.0f;
+    fountain.capacity = 1024;
+    fountain.mesh = g_cubeMesh;
+    core.getParticles().AddEmitter(fountain);
+
+    core.getTasks().Spawn(orbitingCube(core));
 }
 
 
@@ -58,25 +121,46 @@ void updateGame(Core& core)
     if (!world) return;
 
     if (auto* t = world->TryGetComponent<Transform>(g_cube2)) {
-        t->position.x = sinf(Time::time) * 3.0f;
-        t->position.y = sinf(Time::time) * 3.0f;
+        float s = float(std::sin(Time::time));
+        t->position.x = s * 3.0f;
+        t->position.y = s * 3.0f;
     }
 }
 
 int WINAPI WinMain(
     HINSTANCE,
     HINSTANCE,
-    LPSTR,
+    LPSTR cmdLine,
     int
 ) {
+    // --bench, --bench-*: a benchmark instead of the game, see Bench/Benchmarks.h
+    if (cmdLine && std::strstr(cmdLine, "--bench"))
+        return RunBenchmark(cmdLine);
+
     auto core = std::make_unique<Core>();
 
-    core->addInitFunc(setupScene)
-        .addFunc(updateGame);
+    // --zero-alloc-test: after a 5 s warmup, fail on the first frame that
+    // allocates (exit code 1). Needs a build with allocation tracking.
+    const bool zeroAllocTest = cmdLine && std::strstr(cmdLine, "--zero-alloc-test");
+    if (zeroAllocTest)
+        core->enableAllocationCheck(5.0, 600);
+
+    LoopSettings loop;
+    loop.fixedTimestep = true;          // updateGame runs at 60 Hz
+    loop.timestep.ticksPerSecond = 60.0;
+    loop.maxFps = 240.0;
+
+    // --mesh-report: one line per mesh in the vertex memory report.
+    core->setMeshMemoryReport(cmdLine && std::strstr(cmdLine, "--mesh-report"));
+
+    core->setLoopSettings(loop)
+        .addInitFunc(setupScene, "setupScene")
+        .addFunc(updateGame, "updateGame");
 
     core->Init();
+    core->getFrameStats().SetDumpFile("FrameStats.csv", 5.0); // p50/p95/p99 + counters every 5 s
     core->Run();
     core->Shutdown();
 
-    return 0;
+    return (zeroAllocTest && core->allocationCheckFailed()) ? 1 : 0;
 }
@@ -1,6 +1,8 @@
 cbuffer CB_Matrices : register(b0)
 {
     row_major float4x4 mvp;
+    float4 positionScale;   // compressed positions: pos = offset + unorm * scale
+    float4 positionOffset;  // (scale = 1, offset = 0 for float positions)
 };
 
 struct VS_IN
@@ -8,17 +10,76 @@ struct VS_IN
     float3 pos : POSITION;
 };
 
+// Matches PackedVertex in VertexFormat.h
+struct VS_IN_PACKED
+{
+    float4 pos     : POSITION;  // UNORM, w = tangent handedness (0 / 1)
+    float2 normal  : NORMAL;    // SNORM octahedral
+    float2 tangent : TANGENT;   // SNORM octahedral
+    float2 uv      : TEXCOORD0; // half
+};
+
+// Instanced: the mesh position, plus one RenderInstance per copy
+struct VS_IN_INSTANCED
+{
+    float3 pos      : POSITION;
+    float4 instance : INSTANCE;  // xyz = position, w = uniform scale
+};
+
 struct VS_OUT
 {
     float4 pos : SV_POSITION;
 };
 
+struct VS_OUT_PACKED
+{
+    float4 pos     : SV_POSITION;
+    float3 normal  : NORMAL;
+    float4 tangent : TANGENT;
+    float2 uv      : TEXCOORD0;
+};
+
+float3 DecodeOctahedral(float2 e)
+{
+    float3 n = float3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += n.xy >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
 VS_OUT VSMain(VS_IN i)
 {
     VS_OUT o;
 
+    float3 pos = positionOffset.xyz + i.pos * positionScale.xyz;
+
     // row-major: vector * matrix
-    o.pos = mul(float4(i.pos, 1.0f), mvp);
+    o.pos = mul(float4(pos, 1.0f), mvp);
+
+    return o;
+}
+
+VS_OUT_PACKED VSMainPacked(VS_IN_PACKED i)
+{
+    VS_OUT_PACKED o;
+
+    float3 pos = positionOffset.xyz + i.pos.xyz * positionScale.xyz;
+    o.pos = mul(float4(pos, 1.0f), mvp);
+
+    o.normal = DecodeOctahedral(i.normal);
+    o.tangent = float4(DecodeOctahedral(i.tangent), i.pos.w * 2.0f - 1.0f);
+    o.uv = i.uv;
+
+    return o;
+}
+
+VS_OUT VSMainInstanced(VS_IN_INSTANCED i)
+{
+    VS_OUT o;
+
+    float3 pos = positionOffset.xyz + i.pos * positionScale.xyz;
+    pos = i.instance.xyz + pos * i.instance.w;
+    o.pos = mul(float4(pos, 1.0f), mvp);
 
     return o;
 }